@@ -13,7 +13,7 @@ typedef struct 										// defined in dcf77.h
 } Time_Date_Format;
 */
 
-#define DCF77Pin 0
+#define DCF77Pin 0									// INT0, the module output must be on an external interrupt pin
 
 char	DayW[8][4] = {"   ","Mon","Tue","Wed","Thu","Fri","Sat","Sun"};
 u8	PrevSec = 0;
@@ -7,7 +7,7 @@
     Wiring:
     Receiver    Pinguino
     GND         GND
-    DATA0       A0
+    DATA0       D0 (INT0)
     DATA1       NC
     VCC         5V
     ------------------------------------------------------------------
@@ -20,25 +20,28 @@
     Note : c is speed of light, f is frequency and vf is velocity factor 
     ------------------------------------------------------------------*/
 
-#define RXPIN 0                  // RF Receiver pin = Digital pin 0
-#define BUFSIZE 10
+#define RXINT 0                  // RF Receiver on external interrupt INT0
+#define BUFSIZE 32
+
+u8 buffer[BUFSIZE];
 
 void setup()
 {
     pinMode(USERLED, OUTPUT);
-    RF433MHz.init(RXPIN, 1200);
+    RF433MHz.init(RXINT, 1200);
     Serial.begin(9600);
+    RF433MHz.beginReceiveBytes(BUFSIZE, buffer);
 }
 
 void loop()
 {
-    u8 i, receivedSize = 0;
-    RF433MHz.beginReceive();
-    if (RF433MHz.receiveComplete()) 
+    u8 i, receivedSize;
+
+    if (RF433MHz.receiveComplete())
     {
         // Do something with the data in 'buffer' here before you start receiving to the same buffer again
-        receivedSize = buffer[0];
-        for (i=1; i<receivedSize; i++)
+        receivedSize = RF433MHz.getLength();
+        for (i = 0; i < receivedSize && i < BUFSIZE; i++)
             Serial.write(buffer[i]);
 
         RF433MHz.beginReceiveBytes(BUFSIZE, buffer);
@@ -35,7 +35,7 @@ void setup()
 void loop()
 {
     RF433MHz.print("PINGUINO\r\n");
-    RF433MHz.write(string, 6);
+    RF433MHz.writeBytes(string, 6);
     toggle(USERLED);
     delay(1000);                           // Variable delay
     /*
@@ -2,15 +2,7 @@
 // Régis Blanchot 2010
 // Modified by avrin 2013
 // Adapted to soft serial by A. Gentric - Aug 2014
-#define SWBAUDRATE 9600// or 57600, 38400, 19200, 9600, 4800
-// other baudrates 115200 2400 1200 were tried but did not work perfectly 
-#define _SW_PORT     _PORTB           // Transmit pin port and pin
-#define TXDpin      4    // or 0, 2, 6
-#define RXDpin      5    // or 1, 3, 7
-#define SW_PORT_TXDpin      PORTBbits.RB4    // or 0, 2, 6
-#define SW_TRIS_TXDD        TRISBbits.TRISB4 // or 0, 2, 6
-#define SW_PORT_RXDpin      PORTBbits.RB5    // or 1, 3, 7
-#define SW_TRIS_RXDD        TRISBbits.TRISB5 // or 1, 3, 7
+// Tx on pin 4, Rx on pin 5 (any digital pin)
 
 // For 8bit PICs. long int -> %ld or %lu
 
@@ -22,10 +14,7 @@ float f = 3.14159265;
 
 void setup()
 {
-    SW_TRIS_TXDD = 0;
-    SW_PORT_TXDpin = 1;
-
-    SW_TRIS_RXDD = 1;
+    SwSerial.begin(9600, 4, 5);
 
 	SwSerial.printf("\r\n");
 	SwSerial.printf("**************************\r\n");
@@ -50,12 +39,12 @@ void setup()
 	SwSerial.printf("\r\n");
 
 	SwSerial.printf("Press Any Key ...\r\n");
-	c = SwSerial.read();
+	c = SwSerial.getKey();
 	SwSerial.printf("You pressed Key %c\r\n", c);
 	SwSerial.printf("\r\n");
 
 	SwSerial.printf("Press Any Key to continue ...\r\n");
-	c = SwSerial.read();
+	c = SwSerial.getKey();
 }
 
 void loop()
@@ -12,6 +12,7 @@
     // 25 feb. 2012 [jp.mandon@gmail.com] added support for PIC32_PINGUINO_220
     // 17 mar. 2012 [hgmvanbeek@gmail.com] added support for PIC32_PINGUINO_MICRO
     // 19 may. 2012 [jp.mandon@gmail.com] added support for PINGUINO32MX250 and PINGUINO32MX220
+    // 19 oct. 2026 added continuous timer-triggered scan acquisition (ANALOGSTREAM)
     ----------------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -209,4 +210,333 @@ u16 analogRead(u8 pin)
     return (ADC1BUF0 + (8 * (AD1CON2bits.BUFS & 0x01)));
 }
 
+/*  --------------------------------------------------------------------
+    Continuous acquisition
+    --------------------------------------------------------------------
+    The ADC scans all the attached inputs (AD1CSSL), each conversion
+    being triggered by a Timer3 period match so the sample rate is fixed
+    and jitter-free whatever the main loop is doing.
+    The ADC interrupt fires once the 16-word result buffer holds
+    ANALOGSTREAM_K frames (all channels converted K times), the results
+    are summed per channel (oversampling), decimated and pushed into the
+    per-channel ring buffers. A user callback is called every
+    ANALOGBLOCKSIZE frames.
+    The inputs are converted by ascending ANx number whatever the order
+    they were attached in, so are the channels of a frame.
+
+    Usage :
+        Analog.attach(A0);
+        Analog.attach(A1);
+        Analog.onBlock(myCallback);
+        Analog.start(1000, 4);      // 1 kHz per channel, 4x oversampling
+        ...
+        while (Analog.available())
+            Analog.readFrame(frame);
+    ------------------------------------------------------------------*/
+
+#ifdef ANALOGSTREAM
+
+#define __ANALOGSTREAM__
+
+#include <interrupt.c>              // IntConfigureSystem(), ...
+#include <system.c>                 // GetPeripheralClock()
+
+#ifndef ANALOGMAXCHANNELS
+#define ANALOGMAXCHANNELS   4       // max. nb of scanned inputs
+#endif
+#ifndef ANALOGBUFFERSIZE
+#define ANALOGBUFFERSIZE    128     // frames per ring buffer (power of 2)
+#endif
+#if ANALOGMAXCHANNELS > 16
+#error "The ADC can't scan more than 16 inputs"
+#endif
+#ifndef ANALOGBLOCKSIZE
+#define ANALOGBLOCKSIZE     32      // frames per callback (divides ANALOGBUFFERSIZE)
+#endif
+
+typedef void (*analog_callback_t) (u16);   // called with the offset of the block
+
+typedef struct
+{
+    u8  nbchannels;                 // scanned inputs
+    u8  channel[ANALOGMAXCHANNELS]; // ANx of each input, in scan order
+    u8  oversample;                 // conversions summed per output sample
+    u8  shift;                      // right shift applied to the sum
+    u8  count;                      // conversions summed so far
+    u32 acc[ANALOGMAXCHANNELS];     // running sums
+    volatile u16 head;              // next frame to write
+    volatile u16 tail;              // next frame to read
+    volatile u32 overrun;           // frames lost because the ring was full
+    u16 data[ANALOGMAXCHANNELS][ANALOGBUFFERSIZE];
+    analog_callback_t callback;
+} analog_stream_t;
+
+analog_stream_t gAnalog;
+
+const u16 gAnalogPrescaler[8] = { 1, 2, 4, 8, 16, 32, 64, 256 };
+
+/*  --------------------------------------------------------------------
+    Analog_push
+    --------------------------------------------------------------------
+    @descr:     sum n raw conversions stored in scan order, and push a
+                frame into the ring buffers each time "oversample"
+                conversions of every channel have been summed
+                doesn't touch any register and can be tested on a host
+    @param:     s = stream
+                raw = conversion results (ch0, ch1, ..., ch0, ch1, ...)
+                n = nb of conversions, multiple of the nb of channels
+    ------------------------------------------------------------------*/
+
+void Analog_push(analog_stream_t *s, const u16 *raw, u8 n)
+{
+    u8 i, c;
+    u16 head;
+
+    for (i = 0; i < n; i += s->nbchannels)
+    {
+        for (c = 0; c < s->nbchannels; c++)
+            s->acc[c] += raw[i + c];
+
+        if (++s->count < s->oversample)
+            continue;
+
+        s->count = 0;
+        head = s->head;
+
+        if (((head + 1) & (ANALOGBUFFERSIZE - 1)) == s->tail)
+        {
+            s->overrun++;
+        }
+        else
+        {
+            for (c = 0; c < s->nbchannels; c++)
+                s->data[c][head] = s->acc[c] >> s->shift;
+
+            head = (head + 1) & (ANALOGBUFFERSIZE - 1);
+            s->head = head;
+
+            if (s->callback && (head % ANALOGBLOCKSIZE) == 0)
+                s->callback((head - ANALOGBLOCKSIZE) & (ANALOGBUFFERSIZE - 1));
+        }
+
+        for (c = 0; c < s->nbchannels; c++)
+            s->acc[c] = 0;
+    }
+}
+
+/*  --------------------------------------------------------------------
+    Analog_insert
+    --------------------------------------------------------------------
+    @descr:     add ANx to the scan list, which is kept sorted because
+                the ADC scans the inputs in ascending order (CSCNA)
+                doesn't touch any register and can be tested on a host
+    @return:    index of the channel in the frames, 255 if full
+    ------------------------------------------------------------------*/
+
+u8 Analog_insert(analog_stream_t *s, u8 an)
+{
+    u8 i, n = s->nbchannels;
+
+    for (i = 0; i < n; i++)
+    {
+        if (s->channel[i] == an)
+            return i;               // already scanned
+        if (s->channel[i] > an)
+            break;
+    }
+
+    if (n >= ANALOGMAXCHANNELS)
+        return 255;
+
+    for (; n > i; n--)
+        s->channel[n] = s->channel[n - 1];
+    s->channel[i] = an;
+    s->nbchannels++;
+
+    return i;
+}
+
+/*  --------------------------------------------------------------------
+    Analog_attach
+    --------------------------------------------------------------------
+    @descr:     add an analog pin to the scan list, a pin already
+                attached is not added twice
+                the frames hold the channels by ascending ANx number,
+                attaching a lower ANx moves the following ones up, use
+                Analog_index() once all the pins have been attached
+    @return:    index of the channel in the frames or 255 if full
+    ------------------------------------------------------------------*/
+
+u8 Analog_attach(u8 pin)
+{
+    u8 i = Analog_insert(&gAnalog, __bufmask[pin] / 4);
+
+    if (i != 255 && IsDigital(pin))
+        SetAnalog(pin);
+
+    return i;
+}
+
+/*  --------------------------------------------------------------------
+    Analog_index
+    --------------------------------------------------------------------
+    @return:    index of the pin in the frames or 255 if not attached
+    ------------------------------------------------------------------*/
+
+u8 Analog_index(u8 pin)
+{
+    u8 i, an = __bufmask[pin] / 4;
+
+    for (i = 0; i < gAnalog.nbchannels; i++)
+        if (gAnalog.channel[i] == an)
+            return i;
+
+    return 255;
+}
+
+/*  --------------------------------------------------------------------
+    Analog_onBlock
+    --------------------------------------------------------------------
+    @descr:     function called from the ADC interrupt every
+                ANALOGBLOCKSIZE frames, the block of channel c starts
+                at Analog_block(c, offset)
+    ------------------------------------------------------------------*/
+
+void Analog_onBlock(analog_callback_t func)
+{
+    gAnalog.callback = func;
+}
+
+#define Analog_block(c, offset)     (&gAnalog.data[c][offset])
+#define Analog_available()          ((gAnalog.head - gAnalog.tail) & (ANALOGBUFFERSIZE - 1))
+
+/*  --------------------------------------------------------------------
+    Analog_readFrame
+    --------------------------------------------------------------------
+    @descr:     copy the oldest frame (one sample per channel)
+    @return:    false if no frame is available
+    ------------------------------------------------------------------*/
+
+u8 Analog_readFrame(u16 *frame)
+{
+    u8 c;
+    u16 tail = gAnalog.tail;
+
+    if (tail == gAnalog.head)
+        return false;
+
+    for (c = 0; c < gAnalog.nbchannels; c++)
+        frame[c] = gAnalog.data[c][tail];
+
+    gAnalog.tail = (tail + 1) & (ANALOGBUFFERSIZE - 1);
+    return true;
+}
+
+/*  --------------------------------------------------------------------
+    Analog_start
+    --------------------------------------------------------------------
+    @descr:     start the continuous acquisition
+    @param:     rate = output frames per second
+                oversample = conversions summed per output sample
+                (1 to 16, 4 gives 11-bit, 16 gives 12-bit results)
+    ------------------------------------------------------------------*/
+
+void Analog_start(u32 rate, u8 oversample)
+{
+    u8 c, k, tckps = 0;
+    u16 cssl = 0;
+    u32 period;
+    u8 n = gAnalog.nbchannels;
+
+    if (n == 0)
+        return;
+
+    if (oversample < 1)  oversample = 1;
+    if (oversample > 16) oversample = 16;
+
+    // 4^n conversions give n extra bits : keep 10 + n bits of the sum
+    gAnalog.oversample = oversample;
+    gAnalog.shift = 0;
+    for (k = 1; k < oversample; k <<= 2)
+        gAnalog.shift++;
+
+    gAnalog.count = 0;
+    gAnalog.head = gAnalog.tail = 0;
+    for (c = 0; c < n; c++)
+    {
+        gAnalog.acc[c] = 0;
+        cssl |= 1 << gAnalog.channel[c];
+    }
+
+    // nb of complete frames held in the 16-word buffer per interrupt
+    k = 16 / n;
+    if (k > oversample) k = oversample;
+
+    // one conversion per Timer3 match : n channels x oversample per frame
+    period = GetPeripheralClock() / (rate * n * oversample);
+    while ((period / gAnalogPrescaler[tckps]) > 0x10000 && tckps < 7)
+        tckps++;
+    period /= gAnalogPrescaler[tckps];
+
+    AD1CON1 = 0;                    // ADC off
+    T3CON = 0;
+
+    // Tad = 2 * (ADCS + 1) * Tpb must be at least 200 ns
+    AD1CSSL = cssl;                 // inputs to scan
+    AD1CON2 = (1 << 10) |           // CSCNA : scan inputs
+              ((n * k - 1) << 2);   // SMPI : interrupt every n*k conversions
+    AD1CON3 = GetPeripheralClock() / 10000000;
+    AD1CON1 = (0b010 << 5) |        // SSRC : Timer3 period match starts conversion
+              (1 << 2);             // ASAM : sampling starts after conversion
+
+    IntConfigureSystem(INT_SYSTEM_CONFIG_MULT_VECTOR);
+    IntSetVectorPriority(INT_ADC1_CONVERT_DONE_VECTOR, 5, 3);
+    IntClearFlag(INT_ADC1_CONVERT_DONE);
+    IntEnable(INT_ADC1_CONVERT_DONE);
+
+    TMR3 = 0;
+    PR3 = period - 1;
+    AD1CON1bits.ADON = 1;
+    T3CON = 0x8000 | (tckps << 4);  // start Timer3
+}
+
+/*  --------------------------------------------------------------------
+    Analog_stop
+    ------------------------------------------------------------------*/
+
+void Analog_stop()
+{
+    T3CON = 0;
+    IntDisable(INT_ADC1_CONVERT_DONE);
+    AD1CON1 = 0;
+    analog_init();                  // back to single conversion mode
+}
+
+/*  --------------------------------------------------------------------
+    ADC Interrupt
+    --------------------------------------------------------------------
+    ADC1BUF0 to ADC1BUFF are 16 registers spaced by 16 bytes
+    ------------------------------------------------------------------*/
+
+void ADCInterrupt()
+{
+    u16 raw[16];
+    u8 i, n;
+    volatile u32 *buf = (volatile u32 *)&ADC1BUF0;
+
+    if (IntGetFlag(INT_ADC1_CONVERT_DONE))
+    {
+        n = AD1CON2bits.SMPI + 1;
+        for (i = 0; i < n; i++)
+            raw[i] = buf[i * 4];
+
+        // the flag can only be cleared once the buffer has been read
+        IntClearFlag(INT_ADC1_CONVERT_DONE);
+
+        Analog_push(&gAnalog, raw, n);
+    }
+}
+
+#endif /* ANALOGSTREAM */
+
 #endif
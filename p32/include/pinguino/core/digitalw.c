@@ -20,6 +20,8 @@
     [29-03-12][hgmvanbeek@gmail.com][extended PIC32-PINGUINO-MICRO pinning]
     [13-05-12][jp.mandon@gmail.com][extended PINGUINO32MX250 and PINGUINO32MX22 pinning]
     [02-12-13][rblanchot@gmail.com][updated toggle function]
+    [19-10-26][Pinguino team][high, low, toggle and digitalread are folded
+               to a single register access when the pin is a constant]
     ----------------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -408,8 +410,18 @@ void digitalwrite(int pin, int state)
 */
 //#endif
 
-//#if defined(DIGITALHIGH)
-void high(int pin)
+/*  --------------------------------------------------------------------
+    high, low, toggle and digitalread
+    --------------------------------------------------------------------
+    The switch is written once, in an always inline function. When the
+    pin is a compile time constant (a number or a macro like USERLED),
+    gcc folds port[pin] and mask[pin] and high(USERLED) is a single
+    LATxSET = mask store. Otherwise the function is called as before.
+    ------------------------------------------------------------------*/
+
+#define DIGITAL_INLINE  static inline __attribute__((always_inline))
+
+DIGITAL_INLINE void digital_high(int pin)
 {
     switch (port[pin])
     {
@@ -432,10 +444,8 @@ void high(int pin)
         #endif
     }
 }
-//#endif
 
-//#if defined(DIGITALLOW)
-void low(int pin)
+DIGITAL_INLINE void digital_low(int pin)
 {
     switch (port[pin])
     {
@@ -458,45 +468,31 @@ void low(int pin)
         #endif
     }
 }
-//#endif
 
-//#if defined(DIGITALREAD)
-u8 digitalread(int pin)
+DIGITAL_INLINE u8 digital_read(int pin)
 {
     switch (port[pin])
     {
         #if !defined(__32MX440F256H__) && !defined(__32MX795F512H__)
             case pA: return((PORTA & mask[pin])!=0);
-                break;
         #endif
         case pB: return((PORTB & mask[pin])!=0);
-                break;
         #if !defined(__32MX220F032B__) && !defined(__32MX250F128B__) && !defined(__32MX270F256B__)
             case pC: return((PORTC & mask[pin])!=0);
-                    break;
         #endif
         #if !defined(__32MX220F032D__) && !defined(__32MX220F032B__) && \
             !defined(__32MX250F128B__) && !defined(__32MX270F256B__)
             case pD: return((PORTD & mask[pin])!=0);
-                    break;
             case pE: return((PORTE & mask[pin])!=0);
-                    break;
             case pF: return((PORTF & mask[pin])!=0);
-                    break;
             case pG: return((PORTG & mask[pin])!=0);
-                    break;
         #endif
-        default: return 255;
     }
     return 255;
 }
-//#endif
 
-//#if defined(TOGGLE)
-void toggle(int pin)
+DIGITAL_INLINE void digital_toggle(int pin)
 {
-    //digitalwrite(pin, digitalread(pin)^1);
-
     switch (port[pin])
     {
         #if !defined(__32MX440F256H__) && !defined(__32MX795F512H__)
@@ -518,6 +514,48 @@ void toggle(int pin)
         #endif
     }
 }
+
+// (name) keeps the macros below from expanding
+
+//#if defined(DIGITALHIGH)
+void (high)(int pin)
+{
+    digital_high(pin);
+}
 //#endif
 
+//#if defined(DIGITALLOW)
+void (low)(int pin)
+{
+    digital_low(pin);
+}
+//#endif
+
+//#if defined(DIGITALREAD)
+u8 (digitalread)(int pin)
+{
+    return digital_read(pin);
+}
+//#endif
+
+//#if defined(TOGGLE)
+void (toggle)(int pin)
+{
+    digital_toggle(pin);
+}
+//#endif
+
+#define high(pin)           (__builtin_constant_p(pin) ? digital_high(pin) : (high)(pin))
+#define low(pin)            (__builtin_constant_p(pin) ? digital_low(pin) : (low)(pin))
+#define digitalread(pin)    (__builtin_constant_p(pin) ? digital_read(pin) : (digitalread)(pin))
+#ifndef __cplusplus         // Led::toggle()
+#define toggle(pin)         (__builtin_constant_p(pin) ? digital_toggle(pin) : (toggle)(pin))
+#endif
+
+// same names as the 8-bit ones, the above is already as fast
+#define digitalwritefast(pin, state)    digitalwrite(pin, state)
+#define digitalreadfast(pin)            digitalread(pin)
+#define togglefast(pin)                 toggle(pin)
+#define pinmodefast(pin, state)         pinmode(pin, state)
+
 #endif    /* __DIGITALW_C */
@@ -0,0 +1,166 @@
+/*  --------------------------------------------------------------------
+    FILE:           intx.c
+    PROJECT:        pinguino 32
+    PURPOSE:        external interrupts INT0 to INT4 shared by the libraries
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    The libraries which time the edges of a line (DHT sensors, DCF77,
+    433MHz receiver) don't define Int0Interrupt() to Int4Interrupt()
+    themselves, they attach a callback to a line with IntxAttach().
+    A line is given to one callback at a time, IntxAttach() returns
+    false if it is already attached, or if the sketch has it with
+    OnChangePinX() or its own IntnInterrupt() (INTnINT is defined).
+
+    The edge is inverted at each interrupt, the callback is called
+    with the line number and the level after the edge (1 = rising).
+
+    Each library keyword which ends up here must define a flag seen
+    by isrwrapper.c (see INTXDISPATCH) so that the weak handlers are
+    left out.
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    ------------------------------------------------------------------*/
+
+#ifndef __INTX_C
+#define __INTX_C
+
+#include <p32xxxx.h>
+#include <typedef.h>
+#include <const.h>
+#include <interrupt.c>
+
+#define INTX_LINES      5
+
+typedef void (*intx_callback) (u8, u8); // line, level after the edge
+
+intx_callback gIntx[INTX_LINES];
+
+const u8 IntxIrq[INTX_LINES] = {
+    INT_EXTERNAL0, INT_EXTERNAL1, INT_EXTERNAL2, INT_EXTERNAL3, INT_EXTERNAL4 };
+const u8 IntxVector[INTX_LINES] = {
+    INT_EXTERNAL0_VECTOR, INT_EXTERNAL1_VECTOR, INT_EXTERNAL2_VECTOR,
+    INT_EXTERNAL3_VECTOR, INT_EXTERNAL4_VECTOR };
+
+// lines kept by OnChangePinX() or the sketch
+#if defined(INT0INT)
+    #define INTX_OWNED0     1
+#else
+    #define INTX_OWNED0     0
+#endif
+#if defined(INT1INT)
+    #define INTX_OWNED1     (1 << 1)
+#else
+    #define INTX_OWNED1     0
+#endif
+#if defined(INT2INT)
+    #define INTX_OWNED2     (1 << 2)
+#else
+    #define INTX_OWNED2     0
+#endif
+#if defined(INT3INT)
+    #define INTX_OWNED3     (1 << 3)
+#else
+    #define INTX_OWNED3     0
+#endif
+#if defined(INT4INT)
+    #define INTX_OWNED4     (1 << 4)
+#else
+    #define INTX_OWNED4     0
+#endif
+
+#define INTX_OWNED      (INTX_OWNED0 | INTX_OWNED1 | INTX_OWNED2 | \
+                         INTX_OWNED3 | INTX_OWNED4)
+
+/*  --------------------------------------------------------------------
+    IntxAttach
+    --------------------------------------------------------------------
+    @param:     line    0 to 4
+                func    called at each edge
+                edge    first edge, INT_RISING_EDGE or INT_FALLING_EDGE
+    @return:    false if the line is not free
+    ------------------------------------------------------------------*/
+
+u8 IntxAttach(u8 line, intx_callback func, u8 edge)
+{
+    if (line >= INTX_LINES || (INTX_OWNED & (1 << line)) || gIntx[line] != NULL)
+        return false;
+
+    gIntx[line] = func;
+
+    IntConfigureSystem(INT_SYSTEM_CONFIG_MULT_VECTOR);
+    IntSetVectorPriority(IntxVector[line], 7, 3);
+    if (edge == INT_RISING_EDGE)
+        INTCONSET = 1 << line;
+    else
+        INTCONCLR = 1 << line;
+    IntClearFlag(IntxIrq[line]);
+    IntEnable(IntxIrq[line]);
+    return true;
+}
+
+/*  --------------------------------------------------------------------
+    IntxDetach
+    --------------------------------------------------------------------
+    @param:     line    0 to 4, given back to the other libraries
+    ------------------------------------------------------------------*/
+
+void IntxDetach(u8 line)
+{
+    if (line >= INTX_LINES || (INTX_OWNED & (1 << line)))
+        return;
+
+    IntDisable(IntxIrq[line]);
+    IntClearFlag(IntxIrq[line]);
+    gIntx[line] = NULL;
+}
+
+/*  --------------------------------------------------------------------
+    Interrupts
+    ------------------------------------------------------------------*/
+
+void IntxDispatch(u8 line)
+{
+    u8 level;
+
+    if (!IntGetFlag(IntxIrq[line]))
+        return;
+
+    level = (INTCON >> line) & 1;           // edge just seen
+    INTCONINV = 1 << line;                  // wait for the opposite one
+    IntClearFlag(IntxIrq[line]);
+    if (gIntx[line] != NULL)
+        gIntx[line](line, level);
+}
+
+#if !defined(INT0INT)
+void Int0Interrupt() { IntxDispatch(0); }
+#endif
+#if !defined(INT1INT)
+void Int1Interrupt() { IntxDispatch(1); }
+#endif
+#if !defined(INT2INT)
+void Int2Interrupt() { IntxDispatch(2); }
+#endif
+#if !defined(INT3INT)
+void Int3Interrupt() { IntxDispatch(3); }
+#endif
+#if !defined(INT4INT)
+void Int4Interrupt() { IntxDispatch(4); }
+#endif
+
+#endif // __INTX_C
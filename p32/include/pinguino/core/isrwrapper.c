@@ -123,9 +123,8 @@
 
     /**************************************************************************/
 
-    // TODO : MOVE DCF77 FROM TIMER1 TO TIMER?
     #if !defined(TMR1INTUSER) && !defined(TMR1INT)   && \
-        !defined(__MILLIS__)  && !defined(__DCF77__) && !defined(__SWPWM__)
+        !defined(__MILLIS__)  && !defined(SWPWMINT)
     void Timer1Interrupt(void) { Nop(); }
     #endif
 
@@ -144,29 +143,36 @@
     void Timer4Interrupt(void) { Nop(); }
     #endif
 
-    #if !defined(TMR5INTUSER) && !defined(TMR5INT) //&& !defined(__DCF77__) TODO
+    #if !defined(TMR5INTUSER) && !defined(TMR5INT) && \
+        !defined(ONEWIREASYNC)
     void Timer5Interrupt(void) { Nop(); }
     #endif
 
     /**************************************************************************/
+
+    // libraries of which the external interrupts go through intx.c
+    #if defined(KS_DHTASYNC) || defined(DCF77INT) || defined(DCF77RTCC) || \
+        defined(RF433MHZRECEIVER)
+    #define INTXDISPATCH
+    #endif
     
-    #if !defined(INT0INT)
+    #if !defined(INT0INT) && !defined(INTXDISPATCH)
     void Int0Interrupt(void) { Nop(); }
     #endif
     
-    #if !defined(INT1INT)
+    #if !defined(INT1INT) && !defined(INTXDISPATCH)
     void Int1Interrupt(void) { Nop(); }
     #endif
     
-    #if !defined(INT2INT)
+    #if !defined(INT2INT) && !defined(INTXDISPATCH)
     void Int2Interrupt(void) { Nop(); }
     #endif
     
-    #if !defined(INT3INT)
+    #if !defined(INT3INT) && !defined(INTXDISPATCH)
     void Int3Interrupt(void) { Nop(); }
     #endif
     
-    #if !defined(INT4INT)
+    #if !defined(INT4INT) && !defined(INTXDISPATCH)
     void Int4Interrupt(void) { Nop(); }
     #endif
 
@@ -255,6 +261,15 @@
     void USBInterrupt(void) { Nop(); }
     #endif
 
+    #if !defined(ANALOGSTREAM)
+    void ADCInterrupt(void) { Nop(); }
+    #endif
+
+    // pmp.c has the handler, PMPDMA or ITDB02DMA include it
+    #if !defined(PMPDMA) && !defined(ITDB02DMA)
+    void DMA0Interrupt(void) { Nop(); }
+    #endif
+
 #endif
 
 #endif // ISRWRAPPER_C
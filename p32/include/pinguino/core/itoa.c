@@ -4,10 +4,16 @@
 	PURPOSE:		converts integer, long or unsigned long to ascii
 	PROGRAMER:		regis blanchot <rblanchot@gmail.com>
 	FIRST RELEASE:	05 nov. 2010
-	LAST RELEASE:	29 oct. 2011
+	LAST RELEASE:	19 oct. 2026
+	----------------------------------------------------------------------------
+	19 oct. 2026 - string == 0 now returns a static buffer instead of a
+	               malloc'ed one (never freed). The buffer is shared by the
+	               3 functions and is overwritten by the next call.
 	--------------------------------------------------------------------------*/
 
-#include <stdlib.h>
+#define ITOA_BUFFER_LEN	34		// 32 binary digits + sign + '\0'
+
+char itoa_buffer[ITOA_BUFFER_LEN];
 
 #define HEXA	16
 #define DECIMAL	10
@@ -42,7 +48,7 @@ char * itoa(int value, char *string, int base)
 	}
 
 	if (string == 0)
-		string = (char *)malloc((tp-tmp)+sign+1);
+		string = itoa_buffer;
 	sp = string;
 
 	if (sign)
@@ -82,7 +88,7 @@ char * ltoa(long value, char *string, int base)
 	}
 
 	if (string == 0)
-		string = (char *)malloc((tp-tmp)+sign+1);
+		string = itoa_buffer;
 	sp = string;
 
 	if (sign)
@@ -114,9 +120,8 @@ char * ultoa(unsigned long value, char *string, int base)
 			*tp++ = i + 'a' - 10;
 	}
 
-    //*** ERROR ***
-	//if (string == NULL)
-	//	string = (char *)malloc((tp-tmp)+1);
+	if (string == 0)
+		string = itoa_buffer;
 
 	sp = string;
 	while (tp > tmp)
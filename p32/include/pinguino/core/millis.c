@@ -11,6 +11,7 @@
     17 Apr. 2010 Regis Blanchot added millis=f(pbclk)
     26 Feb. 2013 malagas fixed tmr2 value to refresh on each interrupt for MX2X0 boards and micros() function
     15 Jan. 2015 Regis Blanchot fixed PIC32MX2xx support
+    19 Oct. 2026 built on the 64-bit timebase (CP0 Count), added elapsed()
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -36,26 +37,21 @@
 
 #include <system.c>
 #include <interrupt.c>
-
-/**
- * variables accessed by the ISR must be be declared as "volatile"
- * to prevent caching.
- */
-
-volatile u32 _millis = 0;
-volatile u32 _micros;
+#include <timebase.c>
 
 /*  --------------------------------------------------------------------
-    Init. Timer1 to overload every 1 ms
+    Init. Timer1 to keep the timebase up to date
     --------------------------------------------------------------------
-    TIMER1 increments on every PBCLK clock cycle
-    Freq. = Nb cycles / sec
-    Nb cycles / 1ms = Freq / 1000
-    prescaler = 1:8 (PR1 is a 16-bit number)
+    CP0 Count increments every 2 SYSCLK cycles and wraps every 107 s
+    at 80 MHz, Timer1 overflows every 65536 * 256 PBCLK cycles (0.2 s
+    at 80 MHz) to count the wraps.
+    prescaler = 1:256, PR1 = 0xFFFF
     ------------------------------------------------------------------*/
 
 void millis_init(void)
 {
+        timebase_init(GetSystemClock() / 2);
+
         IntConfigureSystem(INT_SYSTEM_CONFIG_MULT_VECTOR);
         IntSetVectorPriority(INT_TIMER1_VECTOR, 7, 3);
         IntClearFlag(INT_TIMER1);
@@ -63,24 +59,29 @@ void millis_init(void)
 
         T1CON = 0;
         TMR1 = 0;
-        PR1 = GetPeripheralClock() / 1000 / 8;
-        // start TIMER1, prescaler = 1:8
-        T1CONSET = 0x8010;
-        _millis = 0;
+        PR1 = 0xFFFF;
+        // start TIMER1, prescaler = 1:256
+        T1CONSET = 0x8030;
 }
 
-#define millis()    (_millis)
-/*
-static inline u32 millis()
+/*  --------------------------------------------------------------------
+    ms and us since millis_init(), they wrap after 49 days and 71 min.
+    Always compare differences : (millis() - start) >= timeout
+    ------------------------------------------------------------------*/
+
+u32 millis()
 {
-    return (_millis);
+    return (u32)timebase_ms(timebase_ticks());
 }
-*/
 
 u32 micros()
 {
-    _micros = 1000 * _millis + (1000 * TMR1) / PR1;
-    return (_micros);
+    return (u32)timebase_us(timebase_ticks());
+}
+
+u32 elapsed(u32 start)
+{
+    return millis() - start;
 }
 
 /*  ----------------------------------------------------------------------------
@@ -90,13 +91,8 @@ u32 micros()
 
 void Timer1Interrupt()
 {
-    // is this an TIMER1 interrupt ?
-    //if (IntGetFlag(INT_TIMER1))
-    //{
-        //IntClearFlag(INT_TIMER1);
-        IFS0CLR = 1 << INT_TIMER1;
-        _millis++;
-    //}
+    IFS0CLR = 1 << INT_TIMER1;
+    timebase_update();
 }
 
 #endif /* __MILLIS__ */
@@ -33,19 +33,25 @@
 
 // this function is used to allocate space on the heap
 // ( called by malloc )
+// nbbytes is a number of bytes, not of int (fixed 19 oct. 2026) and the
+// heap can't grow beyond _min_heap_size, malloc then returns NULL.
+// For long running programs prefer the fixed-size blocks of pool.c.
 
-int *heap_ptr;
+char *heap_ptr;
 extern int _heap;
+extern int _min_heap_size;
 
 int *sbrk(int nbbytes)
 {
-	int *base;
+	char *base;
 	
 	if (!heap_ptr)
-		heap_ptr=(int *)&_heap;	// _heap is defined in the linker script
+		heap_ptr=(char *)&_heap;	// _heap is defined in the linker script
 	base=heap_ptr;					// on Pinguino32 heap is 8192 bytes 
+	if (heap_ptr + nbbytes > (char *)&_heap + (int)&_min_heap_size)
+		return (int *)-1;			// out of memory
 	heap_ptr += nbbytes;
-	return base;
+	return (int *)base;
 }
 
 // open
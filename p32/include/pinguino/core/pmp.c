@@ -10,6 +10,8 @@
 
     Apr  07 2012  - Regis Blanchot - initial release
     Mar  20 2014  - Regis Blanchot - complete rewrite
+    Oct  19 2026  - PMP_writeBlock() and PMP_fill() move the data with
+                    DMA channel 0 (PMPDMA) while the CPU goes on
 
     --------------------------------------------------------------------
     TODO :
@@ -38,6 +40,7 @@
 #include <typedef.h>
 #include <pin.h>
 #include <macro.h>
+#include <const.h>              // NULL
 #include <delay.c>
 #include <interrupt.c>
 #include <pmp.h>
@@ -53,6 +56,12 @@ u8  _pmp_waitB    = 4;                  //  4 x Tpb
 u8  _pmp_waitM    = 16;                 // 16 x Tpb
 u8  _pmp_waitE    = 4;                  //  4 x Tpb
 
+#ifdef PMPDMA
+volatile u32 _pmp_dma_left = 0;         // bytes still to be sent
+const u8 *_pmp_dma_src;                 // next block, NULL to fill
+u8  _pmp_dma_fill[PMP_DMABLOCK];        // value to fill with, bus order
+#endif
+
 /*	--------------------------------------------------------------------
     ---------- PMP_setMode(u8 mode)
     --------------------------------------------------------------------
@@ -180,6 +189,165 @@ void PMP_setWaitStates(u8 beg, u8 mid, u8 end)
     _pmp_waitE = end-1;
 }
 
+#ifdef PMPDMA
+
+/*	--------------------------------------------------------------------
+    DMA transfers
+    --------------------------------------------------------------------
+    DMA channel 0 writes PMDIN each time the PMP ends a cycle (IRQM=01,
+    the PMP interrupt itself stays disabled), one byte in 8-bit mode,
+    one word in 16-bit mode. A transfer is cut into blocks of
+    PMP_DMABLOCK bytes, the DMA interrupt loads the next one, so the
+    CPU is free while the port is busy. Fills send the same block,
+    made of the value, again and again.
+    The source can be in RAM or in flash. Don't change it before the
+    end of the transfer (PMP_dmaBusy() / PMP_dmaWait()).
+    ------------------------------------------------------------------*/
+
+void PMP_dmaNext()
+{
+    u32 n = _pmp_dma_left;
+
+    if (n > PMP_DMABLOCK)
+        n = PMP_DMABLOCK;
+
+    if (_pmp_dma_src)
+    {
+        DCH0SSA = KVA_TO_PA(_pmp_dma_src);
+        _pmp_dma_src += n;
+    }
+    else
+        DCH0SSA = KVA_TO_PA(_pmp_dma_fill);
+
+    // DCH0SSIZ is 16-bit on MX1xx, MX2xx and MX470, 0 means 65536,
+    // it's 8-bit on the others, 0 means 256
+    #if defined(__32MX220F032B__) || defined(__32MX220F032D__) || \
+        defined(__32MX250F128B__) || defined(__32MX270F256B__) || \
+        defined(__32MX470F512H__)
+    DCH0SSIZ = n;
+    #else
+    DCH0SSIZ = n & 0xFF;
+    #endif
+    _pmp_dma_left -= n;
+
+    DCH0INTCLR = 0xFF;                  // clear all channel flags
+    PMP_wait();
+    DCH0CONSET = 1 << 7;                // CHEN
+    DCH0ECONSET = 1 << 7;               // CFORCE, first cell of the block
+}
+
+void PMP_dmaInit()
+{
+    u8 cell = (_pmp_width == PMP_MODE_16BIT) ? 2 : 1;
+
+    DMACONSET = 1 << 15;                // DMA controller on
+    DCH0CON = 3;                        // highest priority, no auto-enable
+    DCH0ECON = (_PMP_IRQ << 8) | (1 << 4); // start on PMP IRQ (SIRQEN)
+    DCH0DSA = KVA_TO_PA(&PMDIN);
+    DCH0DSIZ = cell;
+    DCH0CSIZ = cell;
+    DCH0INTCLR = 0x00FF00FF;
+    DCH0INTSET = 1 << 19;               // CHBCIE, block done interrupt
+
+    #if defined(_IPC10_DMA0IP_POSITION)
+    IPC10bits.DMA0IP = 5;
+    IPC10bits.DMA0IS = 3;
+    #else
+    IPC9bits.DMA0IP = 5;
+    IPC9bits.DMA0IS = 3;
+    #endif
+
+    IntClearFlag(_DMA0_IRQ);
+    IntEnable(_DMA0_IRQ);
+}
+
+/*	--------------------------------------------------------------------
+    DMA channel 0 interrupt (block transfer done)
+    ------------------------------------------------------------------*/
+
+void DMA0Interrupt()
+{
+    DCH0INTCLR = 1 << 3;                // CHBCIF
+    IntClearFlag(_DMA0_IRQ);
+    IntClearFlag(_PMP_IRQ);
+
+    // channel still enabled : a new transfer has already been started
+    if (_pmp_dma_left && !(DCH0CON & (1 << 7)))
+        PMP_dmaNext();
+}
+
+/*	--------------------------------------------------------------------
+    ---------- PMP_dmaBusy()
+    --------------------------------------------------------------------
+    @descr		1 while a DMA transfer is running
+    ------------------------------------------------------------------*/
+
+u8 PMP_dmaBusy()
+{
+    return (_pmp_dma_left || (DCH0CON & (1 << 7))) ? 1 : 0;
+}
+
+void PMP_dmaWait()
+{
+    while (PMP_dmaBusy());
+    PMP_wait();
+}
+
+/*	--------------------------------------------------------------------
+    ---------- PMP_writeBlock(const void *src, u32 len)
+    --------------------------------------------------------------------
+    @descr		send len bytes, returns at once
+    @param		src:    bytes in bus order (high byte first in 8-bit
+                        mode for 16-bit values), RAM or flash
+                len:    number of bytes, even in 16-bit mode
+    ------------------------------------------------------------------*/
+
+void PMP_writeBlock(const void *src, u32 len)
+{
+    PMP_dmaWait();
+    if (len == 0)
+        return;
+    _pmp_dma_src = (const u8 *)src;
+    _pmp_dma_left = len;
+    PMP_dmaNext();
+}
+
+/*	--------------------------------------------------------------------
+    ---------- PMP_fill(u16 value, u32 count)
+    --------------------------------------------------------------------
+    @descr		send the 16-bit value count times, returns at once
+                (high byte then low byte in 8-bit mode)
+    ------------------------------------------------------------------*/
+
+void PMP_fill(u16 value, u32 count)
+{
+    u16 i;
+
+    PMP_dmaWait();
+    if (count == 0)
+        return;
+
+    for (i = 0; i < PMP_DMABLOCK; i += 2)
+    {
+        if (_pmp_width == PMP_MODE_16BIT)
+        {
+            _pmp_dma_fill[i]   = value;
+            _pmp_dma_fill[i+1] = value >> 8;
+        }
+        else
+        {
+            _pmp_dma_fill[i]   = value >> 8;
+            _pmp_dma_fill[i+1] = value;
+        }
+    }
+
+    _pmp_dma_src = NULL;
+    _pmp_dma_left = count * 2;
+    PMP_dmaNext();
+}
+
+#endif /* PMPDMA */
+
 /*	--------------------------------------------------------------------
     ---------- PMP_init()
     --------------------------------------------------------------------
@@ -205,7 +373,12 @@ void PMP_init()
     /// 3. Configure Mode
 
     // Enable Interrupt Request mode: IRQM<1:0> bits (PMMODE<14:13>).
+    // With DMA every end of cycle requests the next transfer
+    #ifdef PMPDMA
+    PMMODEbits.IRQM = PMP_MODE_CY_IRQ;
+    #else
     PMMODEbits.IRQM = PMP_MODE_IRQ_OFF;
+    #endif
 
     // Select auto address increment: INCM<1:0> bits (PMMODE<12:11>).
     if (_pmp_mode==PMP_MODE_ESLAVE || _pmp_mode==PMP_MODE_SLAVE)
@@ -330,6 +503,10 @@ void PMP_init()
     // 6.3. Enable the PMP interrupt by setting the interrupt enable bit, PMPIE = 1.
     //IntEnable(INT_PARALLEL_MASTER_PORT);
     
+    #ifdef PMPDMA
+    PMP_dmaInit();
+    #endif
+
     /// 7. Enable the PMP master port
     //PMCONbits.PMPEN = 1; // enable PMP
     PMCONSET = 0x8000;//Bit(15);
@@ -350,6 +527,9 @@ void PMP_init()
 
 void PMP_write(u16 value)
 {
+    #ifdef PMPDMA
+    PMP_dmaWait();
+    #endif
     PMP_wait();         // wait for PMP to be available
     PMDIN = value;
 }
@@ -367,6 +547,9 @@ u16 PMP_read()
     
     //PMP_wait();         // wait for PMP to be available
     //dummy = PMDIN;      // init read cycle, dummy read
+    #ifdef PMPDMA
+    PMP_dmaWait();
+    #endif
     PMP_wait();         // wait for PMP to be available
     return (PMDIN);
 }
@@ -380,6 +563,9 @@ u16 PMP_read()
 
 void PMP_sendAddress(u16 addr)
 {
+    #ifdef PMPDMA
+    PMP_dmaWait();
+    #endif
     PMP_wait();     // wait for PMP to be available
     PMADDR = addr;
 }
@@ -9,6 +9,7 @@
     CHANGELOG : 
 
     Apr  07 2012  - initial release
+    Oct  19 2026  - DMA transfers (PMPDMA)
     ----------------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -105,6 +106,18 @@
 #define PMENB                       1<<12    // Master 1 (arbitrary value)
 #define PMBE                        1<<11    // Master 1 (arbitrary value)
 
+/** --------------------------------------------------------------------
+    DMA transfers (PMPDMA defined in the pdl file)
+    ------------------------------------------------------------------*/
+
+// bytes moved by the DMA channel between two interrupts
+// (256 is the largest size every PIC32MX DMA channel can take)
+#define PMP_DMABLOCK                256
+
+#ifndef KVA_TO_PA
+#define KVA_TO_PA(v)                ((u32)(v) & 0x1FFFFFFF)
+#endif
+
 /** --------------------------------------------------------------------
     Prototypes
     ------------------------------------------------------------------*/
@@ -121,5 +134,11 @@ void PMP_init();
 void PMP_sendAddress(u16);
 void PMP_write(u16);
 u16  PMP_read();
+#ifdef PMPDMA
+void PMP_writeBlock(const void *, u32);
+void PMP_fill(u16, u32);
+u8   PMP_dmaBusy();
+void PMP_dmaWait();
+#endif
 
 #endif /* __PMP_H */
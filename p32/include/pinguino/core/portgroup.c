@@ -0,0 +1,210 @@
+/*  --------------------------------------------------------------------
+    FILE:           portgroup.c
+    PROJECT:        pinguino
+    PURPOSE:        write or read several pins of the same port at once
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    A group is made of up to 16 pins of the same port, given in any
+    order. Bit i of the value written or read is the i-th pin. The port
+    and bits are looked up once by portgroup_init(), then each write is
+    a single LATxINV store (only the pins which change are flipped, the
+    other pins of the port are never written), each read a single read
+    of PORTx. When the pins are consecutive bits in ascending order the
+    value is only shifted.
+
+        u8 data[4] = { 4, 5, 6, 7 };
+        PortGroup bus;
+        if (portgroup_init(&bus, data, 4))
+        {
+            portgroup_mode(&bus, OUTPUT);
+            portgroup_write(&bus, 0x0A);    // pins 5 and 7 high
+        }
+
+    Libraries which keep their pins in variables (lcdlib, ...) can use
+    a group instead of a digitalwrite() per pin and fall back to the
+    latter when portgroup_init() fails.
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    ------------------------------------------------------------------*/
+
+#ifndef __PORTGROUP_C
+#define __PORTGROUP_C
+
+#include <p32xxxx.h>
+#include <typedef.h>
+#include <digitalw.c>           // port[], mask[]
+
+typedef struct
+{
+    volatile u32 *tris;         // TRISx, then PORTx (+4) and LATx (+8)
+    u16 mask;                   // bits of the group in the port
+    u8  shift;                  // bit number of the first pin
+    u8  packed;                 // consecutive bits, ascending order
+    u8  n;                      // number of pins
+    u16 bit[16];                // bit of each pin in the port
+} PortGroup;
+
+// x, xCLR, xSET and xINV registers
+#define PORTGROUP_CLR           1
+#define PORTGROUP_SET           2
+#define PORTGROUP_INV           3
+
+// TRIS, PORT and LAT are 0x10 bytes apart on every PIC32MX
+#define PORTGROUP_PORT          4
+#define PORTGROUP_LAT           8
+
+volatile u32 * const gPortGroupTris[7] =
+{
+    #if !defined(__32MX440F256H__) && !defined(__32MX795F512H__)
+    (volatile u32 *)&TRISA,
+    #else
+    NULL,
+    #endif
+
+    (volatile u32 *)&TRISB,
+
+    #if !defined(__32MX220F032B__) && !defined(__32MX250F128B__) && !defined(__32MX270F256B__)
+    (volatile u32 *)&TRISC,
+    #else
+    NULL,
+    #endif
+
+    #if !defined(__32MX220F032D__) && !defined(__32MX220F032B__) && \
+        !defined(__32MX250F128B__) && !defined(__32MX270F256B__)
+    (volatile u32 *)&TRISD,
+    (volatile u32 *)&TRISE,
+    (volatile u32 *)&TRISF,
+    (volatile u32 *)&TRISG
+    #else
+    NULL, NULL, NULL, NULL
+    #endif
+};
+
+/*  --------------------------------------------------------------------
+    portgroup_init
+    --------------------------------------------------------------------
+    @param:     g       group to fill
+                pins    Pinguino pin numbers, bit 0 first
+                n       number of pins, 1 to 16
+    @return:    1 if all the pins belong to the same port, else 0
+    ------------------------------------------------------------------*/
+
+u8 portgroup_init(PortGroup *g, const u8 *pins, u8 n)
+{
+    u8 i;
+    u32 m;
+
+    if (n == 0 || n > 16)
+        return 0;
+
+    g->tris = gPortGroupTris[port[pins[0]]];
+    if (g->tris == NULL)
+        return 0;
+
+    g->mask = 0;
+    g->n = n;
+    g->packed = 1;
+
+    for (i = 0; i < n; i++)
+    {
+        m = mask[pins[i]];
+        if (port[pins[i]] != port[pins[0]] || m > 0xFFFF || (g->mask & m))
+            return 0;
+        g->bit[i] = m;
+        g->mask |= m;
+        if (m != ((u32)g->bit[0] << i))
+            g->packed = 0;
+    }
+
+    for (g->shift = 0; !(g->bit[0] & (1 << g->shift)); g->shift++);
+
+    return 1;
+}
+
+/*  --------------------------------------------------------------------
+    portgroup_bits
+    --------------------------------------------------------------------
+    @return:    bits of the port for the value
+    ------------------------------------------------------------------*/
+
+u16 portgroup_bits(PortGroup *g, u16 value)
+{
+    u8 i;
+    u16 bits = 0;
+
+    if (g->packed)
+        return (value << g->shift) & g->mask;
+
+    for (i = 0; i < g->n; i++)
+    {
+        if (value & 1)
+            bits |= g->bit[i];
+        value >>= 1;
+    }
+    return bits;
+}
+
+/*  --------------------------------------------------------------------
+    portgroup_write
+    --------------------------------------------------------------------
+    @descr:     bit i of value to the i-th pin
+    ------------------------------------------------------------------*/
+
+void portgroup_write(PortGroup *g, u16 value)
+{
+    volatile u32 *lat = g->tris + PORTGROUP_LAT;
+
+    lat[PORTGROUP_INV] = (lat[0] ^ portgroup_bits(g, value)) & g->mask;
+}
+
+/*  --------------------------------------------------------------------
+    portgroup_read
+    --------------------------------------------------------------------
+    @return:    state of the i-th pin in bit i
+    ------------------------------------------------------------------*/
+
+u16 portgroup_read(PortGroup *g)
+{
+    u32 r = g->tris[PORTGROUP_PORT];
+    u16 value = 0;
+    u8 i;
+
+    if (g->packed)
+        return (r & g->mask) >> g->shift;
+
+    for (i = g->n; i > 0; i--)
+    {
+        value <<= 1;
+        if (r & g->bit[i - 1])
+            value |= 1;
+    }
+    return value;
+}
+
+/*  --------------------------------------------------------------------
+    portgroup_mode
+    --------------------------------------------------------------------
+    @descr:     all the pins as INPUT or OUTPUT with one TRISx access
+    ------------------------------------------------------------------*/
+
+void portgroup_mode(PortGroup *g, u8 state)
+{
+    g->tris[state ? PORTGROUP_SET : PORTGROUP_CLR] = g->mask;
+}
+
+#endif /* __PORTGROUP_C */
@@ -13,6 +13,7 @@
     11 Jun. 2013 MM OERR Gestion on UART 1
     29 Jan. 2015 R. Blanchot - Cleaned up SerialxInterrupt for PIC32MXxx family
     21 Jun. 2016 R. Blanchot - Added new print functions
+    19 Oct. 2026 SerialPrintf fills the TX FIFO with runs of chars
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -716,6 +717,77 @@ void SerialUART6WriteChar(u8 c)
 }
 #endif
 
+#ifdef SERIALPRINTF
+/*	--------------------------------------------------------------------
+    SerialUARTxWrite : write len chars on the UARTx
+    --------------------------------------------------------------------
+    Chars are pushed as long as the TX FIFO is not full (UTXBF), so the
+    CPU only waits when the FIFO has no room left, not after each char.
+    ------------------------------------------------------------------*/
+
+void SerialUART1Write(const u8 *buf, u16 len)
+{
+    while (len--)
+    {
+        while (U1STAbits.UTXBF);		// wait for room in the FIFO
+        U1TXREG = *buf++;
+    }
+}
+
+void SerialUART2Write(const u8 *buf, u16 len)
+{
+    while (len--)
+    {
+        while (U2STAbits.UTXBF);
+        U2TXREG = *buf++;
+    }
+}
+
+#ifdef ENABLE_UART3
+void SerialUART3Write(const u8 *buf, u16 len)
+{
+    while (len--)
+    {
+        while (U2ASTAbits.UTXBF);
+        U2ATXREG = *buf++;
+    }
+}
+#endif
+
+#ifdef ENABLE_UART4
+void SerialUART4Write(const u8 *buf, u16 len)
+{
+    while (len--)
+    {
+        while (U1BSTAbits.UTXBF);
+        U1BTXREG = *buf++;
+    }
+}
+#endif
+
+#ifdef ENABLE_UART5
+void SerialUART5Write(const u8 *buf, u16 len)
+{
+    while (len--)
+    {
+        while (U3BSTAbits.UTXBF);
+        U3BTXREG = *buf++;
+    }
+}
+#endif
+
+#ifdef ENABLE_UART6
+void SerialUART6Write(const u8 *buf, u16 len)
+{
+    while (len--)
+    {
+        while (U2BSTAbits.UTXBF);
+        U2BTXREG = *buf++;
+    }
+}
+#endif
+#endif /* SERIALPRINTF */
+
 /***********************************************************************
  * Write a char on Serial port
  **********************************************************************/
@@ -888,24 +960,24 @@ void SerialPrintf(u8 port, u8 *fmt, ...)
     
     switch (port)
     {
-        case UART1: pprintf(SerialUART1WriteChar, fmt, args); break;
+        case UART1: pprintfw(SerialUART1Write, fmt, args); break;
         
-        case UART2: pprintf(SerialUART2WriteChar, fmt, args); break;
+        case UART2: pprintfw(SerialUART2Write, fmt, args); break;
         
         #ifdef ENABLE_UART3
-        case UART3: pprintf(SerialUART3WriteChar, fmt, args); break;
+        case UART3: pprintfw(SerialUART3Write, fmt, args); break;
         #endif
         
         #ifdef ENABLE_UART4
-        case UART4: pprintf(SerialUART4WriteChar, fmt, args); break;
+        case UART4: pprintfw(SerialUART4Write, fmt, args); break;
         #endif
         
         #ifdef ENABLE_UART5
-        case UART5: pprintf(SerialUART5WriteChar, fmt, args); break;
+        case UART5: pprintfw(SerialUART5Write, fmt, args); break;
         #endif
         
         #ifdef ENABLE_UART6
-        case UART6: pprintf(SerialUART6WriteChar, fmt, args); break;
+        case UART6: pprintfw(SerialUART6Write, fmt, args); break;
         #endif
     }
     
@@ -22,6 +22,14 @@
     22 Jan. 2016 - rblanchot  - removed setPin(), extended begin() with vargs
     20 Jun. 2016 - rblanchot  - fixed SPI_select and SPI_deselect for PIC32_PINGUINO_OTG
     29 Nov. 2017 - rblanchot  - fixed SPI_select and SPI_deselect for PIC32_PINGUINO
+    19 Oct. 2026 - Pinguino team - SPI SOFTWARE pins are resolved to their
+                                registers once in SPI_begin, unrolled byte
+                                engine for the 4 modes and both bit orders,
+                                SDI is sampled (full duplex)
+    19 Oct. 2026 - Pinguino team - added SPI_writeBlock, SPI_readBlock and
+                                SPI_transferBlock
+    19 Oct. 2026 - Pinguino team - SPI SOFTWARE clock follows
+                                SPI_setClockDivider and SPI_setClock
      ----------------------------------------------------------------------------
     TODO :
     * SLAVE MODE support
@@ -51,6 +59,146 @@
 #include <system.c>
 #include <interrupt.c>
 #include <digitalw.c>           // digitalwrite
+#include <portgroup.c>          // gPortGroupTris
+#include <mips.h>               // ReadCoreTimer
+
+/**
+ *  SPI SOFTWARE engine
+ *  SDO, SCK and SDI are resolved to their LATxSET/LATxCLR and PORTx
+ *  registers by SPI_begin, a bit is then a few stores and a load.
+ *  There is one unrolled byte function per clock phase and bit order,
+ *  the clock polarity only swaps the lead and trail registers.
+ *
+ *  SPI_MODEx follow the CKP and CKE bits of the hardware modules, as
+ *  CKE = 1 means data out on the active to idle edge, CPHA = !CKE :
+ *
+ *  Mode        CKP CKE CPOL CPHA
+ *  SPI_MODE0   0   0   0    1    SDO set on the rising edge, SDI sampled on the falling one
+ *  SPI_MODE1   0   1   0    0    SDO set before the rising edge, SDI sampled on it
+ *  SPI_MODE2   1   0   1    1    SDO set on the falling edge, SDI sampled on the rising one
+ *  SPI_MODE3   1   1   1    0    SDO set before the falling edge, SDI sampled on it
+ *
+ *  so SPI_MODE1 is the usual SPI mode 0 and the default.
+ *
+ *  The clock runs as fast as the stores go until SPI_setClockDivider
+ *  or SPI_setClock is called for SPISW. Then each edge waits for half
+ *  a period of the hardware modules' clock, counted on the core timer
+ *  from the start of the byte, so the time spent in the stores is
+ *  not added to it.
+ */
+
+// registers of the pins which don't exist, writes go nowhere
+volatile u32 SPISW_nowhere[PORTGROUP_LAT + 4];
+
+#define SPISW_OUT(b)    if (out & (b)) *sdoset = sdo; else *sdoclr = sdo;
+#define SPISW_IN(b)     if (*sdiport & sdi) in |= (b);
+
+// half a period since the previous edge
+#define SPISW_WAIT      while (ReadCoreTimer() - t < half); t += half;
+#define SPISW_NOWAIT
+
+// CPHA = 0 : data out before the first edge and sampled on it
+#define SPISW_BIT0(b, W)    SPISW_OUT(b) W *lead = sck; SPISW_IN(b) W *trail = sck;
+
+// CPHA = 1 : data out on the first edge and sampled on the second
+#define SPISW_BIT1(b, W)    W *lead = sck; SPISW_OUT(b) W *trail = sck; SPISW_IN(b)
+
+// the last half period keeps SCK idle before the next byte or SS
+#define SPISW_BYTE(name, BIT, W, b0, b1, b2, b3, b4, b5, b6, b7)    \
+u8 name(u8 out)                                                     \
+{                                                                   \
+    volatile u32 *sdoset = SPISoft.sdoset;                          \
+    volatile u32 *sdoclr = SPISoft.sdoclr;                          \
+    volatile u32 *lead   = SPISoft.lead;                            \
+    volatile u32 *trail  = SPISoft.trail;                           \
+    volatile u32 *sdiport = SPISoft.sdi;                            \
+    u32 sdo = SPISoft.sdomask;                                      \
+    u32 sck = SPISoft.sckmask;                                      \
+    u32 sdi = SPISoft.sdimask;                                      \
+    u32 half = SPISoft.half;                                        \
+    u32 t = ReadCoreTimer();                                        \
+    u8 in = 0;                                                      \
+    (void)half; (void)t;                                            \
+    BIT(b0, W) BIT(b1, W) BIT(b2, W) BIT(b3, W)                     \
+    BIT(b4, W) BIT(b5, W) BIT(b6, W) BIT(b7, W)                     \
+    W                                                               \
+    return in;                                                      \
+}
+
+SPISW_BYTE(SPISW_transfer0M, SPISW_BIT0, SPISW_NOWAIT, 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01)
+SPISW_BYTE(SPISW_transfer0L, SPISW_BIT0, SPISW_NOWAIT, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80)
+SPISW_BYTE(SPISW_transfer1M, SPISW_BIT1, SPISW_NOWAIT, 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01)
+SPISW_BYTE(SPISW_transfer1L, SPISW_BIT1, SPISW_NOWAIT, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80)
+
+SPISW_BYTE(SPISW_timed0M, SPISW_BIT0, SPISW_WAIT, 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01)
+SPISW_BYTE(SPISW_timed0L, SPISW_BIT0, SPISW_WAIT, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80)
+SPISW_BYTE(SPISW_timed1M, SPISW_BIT1, SPISW_WAIT, 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01)
+SPISW_BYTE(SPISW_timed1L, SPISW_BIT1, SPISW_WAIT, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80)
+
+/**
+ *  Returns the registers of a pin, TRISx first
+ */
+
+volatile u32 * SPISW_pin(u8 pin, u32 *m)
+{
+    volatile u32 *tris = gPortGroupTris[port[pin]];
+
+    if (tris == NULL)
+    {
+        *m = 0;
+        return SPISW_nowhere;
+    }
+    *m = mask[pin];
+    return tris;
+}
+
+/**
+ *  Selects the byte engine and puts SCK at its idle level.
+ *  Called each time the pins, the mode, the bit order or the clock
+ *  change.
+ */
+
+void SPISW_setup()
+{
+    volatile u32 *lat;
+    u8 cpha = !(SPI[SPISW].mode & 1);   // CPHA = !CKE
+
+    lat = SPISoft.sck + PORTGROUP_LAT;
+
+    if (SPI[SPISW].mode & 2)            // CPOL = 1, SCK idle high
+    {
+        SPISoft.lead  = lat + PORTGROUP_CLR;
+        SPISoft.trail = lat + PORTGROUP_SET;
+    }
+    else                                // CPOL = 0, SCK idle low
+    {
+        SPISoft.lead  = lat + PORTGROUP_SET;
+        SPISoft.trail = lat + PORTGROUP_CLR;
+    }
+    *SPISoft.trail = SPISoft.sckmask;
+
+    if (SPISoft.half == 0 && SPI[SPISW].bitorder == SPI_MSBFIRST)
+        SPISoft.transfer = cpha ? SPISW_transfer1M : SPISW_transfer0M;
+    else if (SPISoft.half == 0)
+        SPISoft.transfer = cpha ? SPISW_transfer1L : SPISW_transfer0L;
+    else if (SPI[SPISW].bitorder == SPI_MSBFIRST)
+        SPISoft.transfer = cpha ? SPISW_timed1M : SPISW_timed0M;
+    else
+        SPISoft.transfer = cpha ? SPISW_timed1L : SPISW_timed0L;
+}
+
+/**
+ *  Half a period of Fpb / (2 * (divider + 1)) in core timer ticks,
+ *  the core timer runs at SYSCLK / 2
+ */
+
+void SPISW_setClock()
+{
+    u32 ratio = GetSystemClock() / GetPeripheralClock();
+
+    SPISoft.half = (SPI[SPISW].divider + 1) * ratio / 2;
+    SPISW_setup();
+}
 
 /**
  *  This function init the SPI module to default values
@@ -69,6 +217,14 @@ void SPI_init()
         SPI[i].bitorder = SPI_MSBFIRST;
         SPI[i].phase    = SPI_STANDARD_SPEED_MODE;
     }
+
+    // SPI SOFTWARE pins go nowhere until SPI_begin
+    SPISoft.sdoset = SPISW_nowhere;
+    SPISoft.sdoclr = SPISW_nowhere;
+    SPISoft.sdi    = SPISW_nowhere;
+    SPISoft.sck    = SPISW_nowhere;
+    SPISoft.half   = 0;             // as fast as possible
+    SPISW_setup();
 }
 
 /**
@@ -167,6 +323,8 @@ void SPI_deselect(u8 module)
 void SPI_setBitOrder(u8 module, u8 bitorder)
 {
     SPI[module].bitorder = bitorder;
+    if (module == SPISW)
+        SPISW_setup();
     //SPI_begin();
 }
 
@@ -186,6 +344,8 @@ void SPI_setBitOrder(u8 module, u8 bitorder)
 void SPI_setDataMode(u8 module, u8 mode)
 {
     SPI[module].mode = mode;
+    if (module == SPISW)
+        SPISW_setup();
     //SPI_begin();
 }
 //#endif
@@ -214,11 +374,12 @@ void SPI_setMode(u8 module, u8 role)
 u32 SPI_setClock(u8 module, u32 Fspi)
 {
     u32 Fpb = GetPeripheralClock();
+    u32 Freal;
     
     if (Fspi > (Fpb / 2))
     {
         SPI[module].divider = 0;        // use the maximum baud rate possible
-        return (Fpb / 2);               // and return the real speed
+        Freal = Fpb / 2;                // and return the real speed
     }
     else
     {
@@ -228,15 +389,19 @@ u32 SPI_setClock(u8 module, u32 Fspi)
         if (SPI[module].divider > 511)
         {
             SPI[module].divider = 511;  // use the minimum baud rate possible
-            return (Fpb / 1024);        // and return the real speed
+            Freal = Fpb / 1024;         // and return the real speed
         }
         else                            // ** fix for bug identified by dk=KiloOne
         {
             // return the real speed
-            return ( Fpb / ( 2 * SPI[module].divider + 1));
+            Freal = Fpb / ( 2 * SPI[module].divider + 1);
         }
     }
 
+    if (module == SPISW)
+        SPISW_setClock();
+
+    return Freal;
     //SPI_begin();
 }
 
@@ -259,6 +424,9 @@ void SPI_setClockDivider(u8 module, u32 divider)
         SPI[module].divider = 511;
     else
         SPI[module].divider = divider / 2 - 1;
+
+    if (module == SPISW)
+        SPISW_setClock();
 }
 //#endif
 
@@ -356,6 +524,7 @@ void SPI_close(u8 module)
 void SPI_begin(u8 module, ...)
 {
     va_list args;
+    volatile u32 *lat;
     
     va_start(args, module); // args points on the argument after module
 
@@ -376,6 +545,13 @@ void SPI_begin(u8 module, ...)
             pinmode(SPI[SPISW].sdi, INPUT);
             pinmode(SPI[SPISW].sck, OUTPUT);
             pinmode(SPI[SPISW].cs,  OUTPUT);
+            // Resolves them to their registers
+            lat = SPISW_pin(SPI[SPISW].sdo, &SPISoft.sdomask) + PORTGROUP_LAT;
+            SPISoft.sdoset = lat + PORTGROUP_SET;
+            SPISoft.sdoclr = lat + PORTGROUP_CLR;
+            SPISoft.sdi = SPISW_pin(SPI[SPISW].sdi, &SPISoft.sdimask) + PORTGROUP_PORT;
+            SPISoft.sck = SPISW_pin(SPI[SPISW].sck, &SPISoft.sckmask);
+            SPISW_setup();
             break;
             
         #if !defined(__32MX440F256H__)
@@ -704,30 +880,10 @@ void SPI_begin(u8 module, ...)
  
 u8 SPI_write(u8 module, u8 dataout)
 {
-    u8 i;
-    u8 bitMask;
-
     switch(module)
     {
         case SPISW:
-            for (i = 0; i < 8; i++)
-            {
-                // MSB first
-                if (SPI[module].bitorder == SPI_MSBFIRST)
-                    bitMask = 0x80 >> i;
-
-                // LSB first
-                else
-                    bitMask = 1 << i;
-
-                // Send bit
-                digitalwrite(SPI[module].sdo, (dataout & bitMask) ? 1 : 0);
-
-                // pulse
-                high(SPI[module].sck);
-                low(SPI[module].sck);
-            }
-            return dataout;
+            return SPISoft.transfer(dataout);
 
         #if !defined(__32MX440F256H__)
 
@@ -763,6 +919,49 @@ u8 SPI_write(u8 module, u8 dataout)
 // send dummy byte to capture the response
 #define SPI_read(module) SPI_write(module, 0xFF)
 
+/**
+ * Block transfers, on every module.
+ * The SPI SOFTWARE engine is looked up once for the whole block.
+ * SPI_readBlock sends 0xFF bytes, SPI_transferBlock is full duplex,
+ * out and in may be the same buffer.
+ **/
+
+void SPI_transferBlock(u8 module, const u8 *out, u8 *in, u32 length)
+{
+    u8 (*transfer)(u8) = SPISoft.transfer;
+
+    if (module == SPISW)
+        while (length--)
+            *in++ = transfer(*out++);
+    else
+        while (length--)
+            *in++ = SPI_write(module, *out++);
+}
+
+void SPI_writeBlock(u8 module, const u8 *buffer, u32 length)
+{
+    u8 (*transfer)(u8) = SPISoft.transfer;
+
+    if (module == SPISW)
+        while (length--)
+            transfer(*buffer++);
+    else
+        while (length--)
+            SPI_write(module, *buffer++);
+}
+
+void SPI_readBlock(u8 module, u8 *buffer, u32 length)
+{
+    u8 (*transfer)(u8) = SPISoft.transfer;
+
+    if (module == SPISW)
+        while (length--)
+            *buffer++ = transfer(0xFF);
+    else
+        while (length--)
+            *buffer++ = SPI_read(module);
+}
+
 /**
  * SPI1Interrupt
  **/
@@ -9,6 +9,8 @@
     CHANGELOG : 
     15 Apr 2015 - rblanchot  -  created from spi.c
     15 Apr 2015 - rblanchot  -  added SPI structure
+    19 Oct 2026 - Pinguino team - added software SPI pins structure
+                                  and block transfer functions
     ----------------------------------------------------------------------------
     TODO :
     ----------------------------------------------------------------------------
@@ -92,6 +94,22 @@ typedef struct
     u8  cs;
 } spi_t;
 
+// Software SPI pins, resolved once by SPI_begin(SPISW, ...)
+typedef struct
+{
+    volatile u32 *sdoset;       // LATxSET and LATxCLR of SDO
+    volatile u32 *sdoclr;
+    volatile u32 *lead;         // LATxSET or LATxCLR of SCK, first edge
+    volatile u32 *trail;        // the other one, back to the idle level
+    volatile u32 *sdi;          // PORTx of SDI
+    volatile u32 *sck;          // TRISx of SCK
+    u32 sdomask;
+    u32 sckmask;
+    u32 sdimask;
+    u32 half;                   // core timer ticks per half period, 0 = no wait
+    u8 (*transfer)(u8);         // byte engine for the mode, bit order and clock
+} spisw_t;
+
 // Prototypes
 void SPI_init();
 void SPI_select(u8 module);
@@ -105,6 +123,9 @@ void SPI_close(u8 module);
 void SPI_begin(u8 module, ...);
 u8 SPI_write(u8 module, u8 data_out);
 u8 SPI_read(u8 module);
+void SPI_writeBlock(u8 module, const u8 *buffer, u32 length);
+void SPI_readBlock(u8 module, u8 *buffer, u32 length);
+void SPI_transferBlock(u8 module, const u8 *out, u8 *in, u32 length);
 
 // Globals
 #if defined(__32MX795F512L__) || defined(__32MX795F512H__)
@@ -114,5 +135,6 @@ u8 SPI_read(u8 module);
 #endif
 
 spi_t SPI[NUMOFSPI];
+spisw_t SPISoft;
 
 #endif	/* __SPI_H */
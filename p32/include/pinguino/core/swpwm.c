@@ -6,6 +6,14 @@
     --------------------------------------------------------------------
     Changelog :
     21 Sep. 2016 - Régis Blanchot - first PIC32 release
+    19 Oct. 2026 - bit-angle modulation (BAM) engine :
+                   per-port set/clear masks are compiled when a duty cycle
+                   changes, Timer1 fires only 8 times per PWM period and
+                   only writes LATxCLR/LATxSET, masks are double-buffered
+                   and swapped at the beginning of a period (no glitch),
+                   every pin of the board can be used as a PWM output
+                 - staged duty cycles, SWPWM_commit() hands a whole set
+                   of them to the ISR at once
     --------------------------------------------------------------------
     To do :
     --------------------------------------------------------------------
@@ -29,39 +37,162 @@
 
 #include <p32xxxx.h>                // sfr's
 #include <typedef.h>                // u8, u16, u32, ...
-#include <macro.h>                  // BitSet(), ...
+#include <const.h>                  // NULL
+#include <macro.h>                  // noInterrupts(), ...
 #include <interrupt.h>
 #include <interrupt.c>              // IntConfigureSystem(), ...
-#include <digitalw.c>               // high(), low(), ...
+#include <digitalw.c>               // output(), port[], mask[], ...
 #include <system.c>                 // GetPeripheralClock()
 
+/*  --------------------------------------------------------------------
+    Bit-Angle Modulation
+    --------------------------------------------------------------------
+    An 8-bit duty cycle D is split into its 8 bits. The PWM period is
+    divided into 8 slots, slot n lasting 2^n time units (255 units in
+    total). During slot n every pin whose duty cycle has bit n set is
+    driven high, the others are driven low. The average on-time is then
+    exactly D/255 of the period.
+
+    For each port and each slot we store the mask of the pins to set,
+    so the interrupt routine only writes LATxCLR and LATxSET once per
+    used port and per slot, whatever the number of PWM pins is.
+    ------------------------------------------------------------------*/
+
 // Uncomment this line if using a Common Anode LED
 //#define COMMON_ANODE
-#define NBSWPWMPIN              8
+#define NBSWPWMPIN              (sizeof(mask) / sizeof(mask[0]))
 #define SWPWMRES                255 // PWM resolution
+#define SWPWMNBPORT             7   // PORTA to PORTG
+#define SWPWMNBSLOT             8   // 8-bit resolution = 8 bit-slots
+#define SWPWMMINUNIT            64  // min. Timer1 ticks for the 1st slot
+
+typedef struct
+{
+    u32 active[SWPWMNBPORT];                // pins driven by the engine
+    u32 set[SWPWMNBPORT][SWPWMNBSLOT];      // pins high during slot n
+} swpwm_bank_t;
+
+typedef struct
+{
+    swpwm_bank_t work;                      // updated by the user
+    swpwm_bank_t bank[2];                   // double-buffer read by the ISR
+    volatile u8 current;                    // bank used by the ISR
+    volatile u8 pending;                    // swap at next period
+    volatile u8 slot;                       // next bit-slot
+    u16 unit;                               // Timer1 ticks for slot 0
+} swpwm_t;
 
+swpwm_t gSWPWM;
 volatile u8 gDutyCycle[NBSWPWMPIN];
-volatile u8 gCounter=0;
-volatile u8 gPinNum=0;
-volatile u8 gPinActivated=0;
-u32 gPrescaler[] = {1, 8, 64, 256};
+const u32 gPrescaler[] = {1, 8, 64, 256};
+
+// LATxCLR register of each port, LATxSET is the next register
+
+volatile u32 * const gSWPWMLat[SWPWMNBPORT] =
+{
+    #if !defined(__32MX440F256H__) && !defined(__32MX795F512H__)
+    (volatile u32 *)&LATACLR,
+    #else
+    NULL,
+    #endif
+
+    (volatile u32 *)&LATBCLR,
+
+    #if !defined(__32MX220F032B__) && !defined(__32MX250F128B__) && !defined(__32MX270F256B__)
+    (volatile u32 *)&LATCCLR,
+    #else
+    NULL,
+    #endif
+
+    #if !defined(__32MX220F032D__) && !defined(__32MX220F032B__) && \
+        !defined(__32MX250F128B__) && !defined(__32MX270F256B__)
+    (volatile u32 *)&LATDCLR,
+    (volatile u32 *)&LATECLR,
+    (volatile u32 *)&LATFCLR,
+    (volatile u32 *)&LATGCLR
+    #else
+    NULL, NULL, NULL, NULL
+    #endif
+};
+
+/*  --------------------------------------------------------------------
+    SWPWM_compile
+    --------------------------------------------------------------------
+    @descr:     update the bit-slot masks of one pin
+                doesn't touch any register and can be tested on a host
+    @param:     b = masks to update
+                p = port index (pA .. pG)
+                m = pin mask in this port
+                duty = 8-bit duty cycle
+    ------------------------------------------------------------------*/
+
+void SWPWM_compile(swpwm_bank_t *b, u8 p, u32 m, u8 duty)
+{
+    u8 n;
+
+    b->active[p] |= m;
+
+    for (n = 0; n < SWPWMNBSLOT; n++)
+    {
+        if (duty & (1 << n))
+            b->set[p][n] |= m;
+        else
+            b->set[p][n] &= ~m;
+    }
+}
+
+/*  --------------------------------------------------------------------
+    SWPWM_commit
+    --------------------------------------------------------------------
+    @descr:     copy the working masks into the bank not used by the ISR
+                the ISR will switch to it at the beginning of next period,
+                so all the duty cycles staged since the last commit
+                start on the same period
+    ------------------------------------------------------------------*/
+
+void SWPWM_commit()
+{
+    // prevent the ISR from swapping while we fill the free bank
+    gSWPWM.pending = 0;
+    gSWPWM.bank[gSWPWM.current ^ 1] = gSWPWM.work;
+    gSWPWM.pending = 1;
+}
 
 /*  --------------------------------------------------------------------
     SWPWM_setFrequency
     --------------------------------------------------------------------
-    @descr:     calculate Timer1 prescaler and period to get the frequency
+    @descr:     calculate Timer1 prescaler and time unit to get the frequency
+                the longest slot (128 units) must fit in the 16-bit PR1
     @param:     frequency in hertz
-    @return:    value of PR1
+    @return:    number of Timer1 ticks per time unit
     ------------------------------------------------------------------*/
 
 u16 SWPWM_setFrequency(u32 freq)
 {
-    u32 tckps = 2;                  // prescaler select bits
-    u32 Fpb=GetPeripheralClock();   // TMR1 increments on every PBCLK clock cycle
-    u32 period = (freq * 0x10000 * gPrescaler[tckps] ) / Fpb;
-    
+    u32 tckps = 0;                  // prescaler select bits
+    u32 Fpb = GetPeripheralClock(); // TMR1 increments on every PBCLK clock cycle
+    u32 unit;
+
+    for (;;)
+    {
+        unit = Fpb / (freq * SWPWMRES * gPrescaler[tckps]);
+        if ((unit << (SWPWMNBSLOT - 1)) <= 0xFFFF || tckps == 3)
+            break;
+        tckps++;
+    }
+
+    if ((unit << (SWPWMNBSLOT - 1)) > 0xFFFF)
+        unit = 0xFFFF >> (SWPWMNBSLOT - 1);
+
+    // the shortest slot must be longer than the ISR itself
+    if (unit * gPrescaler[tckps] < SWPWMMINUNIT)
+        unit = (SWPWMMINUNIT + gPrescaler[tckps] - 1) / gPrescaler[tckps];
+
     noInterrupts();                 // Disable global interrupts
-    
+
+    gSWPWM.unit = unit;
+    gSWPWM.slot = 0;
+
     // Configure interrupt
     IntConfigureSystem(INT_SYSTEM_CONFIG_MULT_VECTOR);
     IntSetVectorPriority(INT_TIMER1_VECTOR, 7, 3);
@@ -71,32 +202,51 @@ u16 SWPWM_setFrequency(u32 freq)
     // Configure Timer1
     T1CON = tckps << 4;             // set prescaler (bit 5-4)
     TMR1 = 0;                       // clear timer register
-    PR1 = period/NBSWPWMPIN;        // load period register (divided by nb of pins)
+    PR1 = unit - 1;                 // 1st slot
     T1CONSET = 0x8000;              // start timer 1
 
     interrupts();                   // Enable global interrupts
 
-    return PR1;
+    return unit;
 }
 
 /*  --------------------------------------------------------------------
-    PWM_setDutyCycle
+    SWPWM_stageDutyCycle
     --------------------------------------------------------------------
-    Set dutycycle with 8-bits resolution, allowing 256 PWM steps.
-    @param pin:		PortB pin (0 to 7)
+    Prepare a new duty cycle, the output doesn't change before the
+    next SWPWM_commit(). Several pins (the 3 colors of a RGB led for
+    ex.) can then be changed on the same PWM period.
+    @param pin:		any digital pin
     @param duty:	8-bit duty cycle
     ------------------------------------------------------------------*/
 
-void SWPWM_setDutyCycle(u8 pin, u8 duty)
+void SWPWM_stageDutyCycle(u8 pin, u8 duty)
 {
+    if (pin >= NBSWPWMPIN || gSWPWMLat[port[pin]] == NULL)
+        return;
+
     // Configure pins as output
     output(pin);
-    
-    // Declare pin as activated
-    BitSet(gPinActivated, pin);
 
     // Set duty cycle
     gDutyCycle[pin] = duty;
+
+    // Compile the new masks, the ISR doesn't read them yet
+    SWPWM_compile(&gSWPWM.work, port[pin], mask[pin], duty);
+}
+
+/*  --------------------------------------------------------------------
+    PWM_setDutyCycle
+    --------------------------------------------------------------------
+    Set dutycycle with 8-bits resolution, allowing 256 PWM steps.
+    @param pin:		any digital pin
+    @param duty:	8-bit duty cycle
+    ------------------------------------------------------------------*/
+
+void SWPWM_setDutyCycle(u8 pin, u8 duty)
+{
+    SWPWM_stageDutyCycle(pin, duty);
+    SWPWM_commit();
 }
 
 /*  --------------------------------------------------------------------
@@ -124,24 +274,50 @@ void SWPWM_setPercentDutyCycle(u8 pin, u8 percent)
     SWPWM_setDutyCycle(pin, duty);
 }
 
-// Compute output level by comparing each register with the gCounter
-// The associated pin is made LOW or HIGH according to the result of comparison
-// For speed reason we used LAT registers rather than digitalWrite function
+/*  --------------------------------------------------------------------
+    Interrupt routine
+    --------------------------------------------------------------------
+    Start a new bit-slot : each used port gets one LATxCLR and one
+    LATxSET write, then PR1 is loaded with the length of the slot.
+    TMR1 is reset by the hardware on period match so the slot lengths
+    don't depend on the ISR latency.
+    ------------------------------------------------------------------*/
 
-//void swpwm_interrupt()
 void Timer1Interrupt()
 {
-    u8 pin;
-    
+    u8 p, slot;
+    u32 set;
+    volatile u32 *lat;
+    swpwm_bank_t *b;
+
     if (IntGetFlag(INT_TIMER1))
     {
         IntClearFlag(INT_TIMER1);
-        gCounter++;
-        gCounter &= SWPWMRES;
-        //
-        for (pin=0; pin<NBSWPWMPIN; pin++)
-            if (gPinActivated & (1<<pin))
-                ( gCounter < gDutyCycle[pin] ) ? high(pin) : low(pin);
+
+        slot = gSWPWM.slot;
+
+        // new masks are only taken into account at the beginning of a period
+        if (slot == 0 && gSWPWM.pending)
+        {
+            gSWPWM.current ^= 1;
+            gSWPWM.pending = 0;
+        }
+
+        b = &gSWPWM.bank[gSWPWM.current];
+
+        for (p = 0; p < SWPWMNBPORT; p++)
+        {
+            if (b->active[p])
+            {
+                lat = gSWPWMLat[p];
+                set = b->set[p][slot];
+                lat[0] = b->active[p] & ~set;   // LATxCLR
+                lat[1] = set;                   // LATxSET
+            }
+        }
+
+        PR1 = (gSWPWM.unit << slot) - 1;
+        gSWPWM.slot = (slot + 1) & (SWPWMNBSLOT - 1);
     }
 }
 
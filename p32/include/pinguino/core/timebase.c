@@ -0,0 +1,162 @@
+/*  --------------------------------------------------------------------
+    FILE:           timebase.c
+    PROJECT:        pinguino
+    PURPOSE:        64-bit monotonic timebase
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    The 32-bit CP0 Count register counts at half the CPU rate and
+    wraps every 107 s at 80 MHz. It is extended to 64 bits with the
+    number of wraps, kept up to date by timebase_update() which must
+    be called (from a timer interrupt) at least once per wrap.
+
+    timebase_update() is the only writer. It writes the new (wraps,
+    last count) pair in the unused one of two slots then switches the
+    sequence number to it, so that a reader always finds a complete
+    pair, even when it interrupts the writer. A reader interrupted by
+    the writer sees the sequence number change and reads again.
+
+    Ticks are converted to us or ms with a 64 x 64 bits multiply by
+    2^64 / ticks per unit, computed once by timebase_init(), instead
+    of a 64-bit division.
+
+    CP0 Count must not be written (SetCP0Count) once started.
+
+    #define TIMEBASE_COUNT() to something else than CP0 Count to test
+    it on a host.
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    ------------------------------------------------------------------*/
+
+#ifndef __TIMEBASE_C
+#define __TIMEBASE_C
+
+#include <typedef.h>
+
+#ifndef TIMEBASE_COUNT
+#include <system.c>
+#define TIMEBASE_COUNT()        GetCP0Count()
+#endif
+
+typedef struct
+{
+    u32 high;                           // wraps of the counter
+    u32 last;                           // counter at the last update
+} timebase_slot_t;
+
+static volatile timebase_slot_t _timebase_slot[2];
+static volatile u32 _timebase_seq;      // slot in use is seq & 1
+
+static u64 _timebase_us;                // 2^64 us / tick
+static u64 _timebase_ms;                // 2^64 ms / tick
+
+/*  --------------------------------------------------------------------
+    timebase_scale
+    --------------------------------------------------------------------
+    @return:    2^64 * unit / freq, freq > unit
+    ------------------------------------------------------------------*/
+
+static u64 timebase_scale(u32 unit, u32 freq)
+{
+    u64 n = (u64)unit << 32;
+
+    return ((n / freq) << 32) + (((n % freq) << 32) / freq);
+}
+
+/*  --------------------------------------------------------------------
+    timebase_mulhi
+    --------------------------------------------------------------------
+    @return:    the high 64 bits of the 128-bit product a * b
+    ------------------------------------------------------------------*/
+
+static u64 timebase_mulhi(u64 a, u64 b)
+{
+    u32 a0 = (u32)a, a1 = (u32)(a >> 32);
+    u32 b0 = (u32)b, b1 = (u32)(b >> 32);
+    u64 p00 = (u64)a0 * b0;
+    u64 p01 = (u64)a0 * b1;
+    u64 p10 = (u64)a1 * b0;
+    u64 p11 = (u64)a1 * b1;
+    u64 mid = (p00 >> 32) + (u32)p01 + (u32)p10;
+
+    return p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+/*  --------------------------------------------------------------------
+    timebase_init
+    --------------------------------------------------------------------
+    @param:     freq    counter frequency (Hz)
+    ------------------------------------------------------------------*/
+
+void timebase_init(u32 freq)
+{
+    _timebase_us = timebase_scale(1000000UL, freq);
+    _timebase_ms = timebase_scale(1000UL, freq);
+
+    _timebase_slot[0].high = 0;
+    _timebase_slot[0].last = TIMEBASE_COUNT();
+    _timebase_seq = 0;
+}
+
+/*  --------------------------------------------------------------------
+    timebase_update
+    --------------------------------------------------------------------
+    @descr:     to be called at least once per counter wrap
+    ------------------------------------------------------------------*/
+
+void timebase_update(void)
+{
+    u32 seq = _timebase_seq;
+    u32 now = TIMEBASE_COUNT();
+    u32 high = _timebase_slot[seq & 1].high;
+
+    if (now < _timebase_slot[seq & 1].last)
+        high++;
+
+    _timebase_slot[(seq + 1) & 1].high = high;
+    _timebase_slot[(seq + 1) & 1].last = now;
+    _timebase_seq = seq + 1;
+}
+
+/*  --------------------------------------------------------------------
+    timebase_ticks
+    --------------------------------------------------------------------
+    @return:    64-bit counter, never goes backwards
+    ------------------------------------------------------------------*/
+
+u64 timebase_ticks(void)
+{
+    u32 seq, high, last, now;
+
+    do {
+        seq  = _timebase_seq;
+        high = _timebase_slot[seq & 1].high;
+        last = _timebase_slot[seq & 1].last;
+        now  = TIMEBASE_COUNT();
+    } while (seq != _timebase_seq);
+
+    // wrapped since the last update
+    if (now < last)
+        high++;
+
+    return ((u64)high << 32) | now;
+}
+
+#define timebase_us(ticks)      timebase_mulhi((ticks), _timebase_us)
+#define timebase_ms(ticks)      timebase_mulhi((ticks), _timebase_ms)
+
+#endif /* __TIMEBASE_C */
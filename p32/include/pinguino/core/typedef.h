@@ -60,6 +60,7 @@
     } t24;
 
     typedef void (*funcout) (u8);   // type of void funcout(u8)
+    typedef void (*funcwrite) (const u8 *, u16); // type of void funcwrite(const u8 *, u16)
 
 /*  --------------------------------------------------------------------
     gcc types
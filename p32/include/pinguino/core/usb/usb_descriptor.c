@@ -42,9 +42,9 @@ const USB_DEVICE_DESCRIPTOR usb_device =
     sizeof(USB_DEVICE_DESCRIPTOR),              // Size of this descriptor in bytes
     USB_DESCRIPTOR_DEVICE,                      // Device descriptor type
     0x0200,                                     // USB Spec Release Number in BCD format (0x0100 for USB 1.0, 0x0110 for USB1.1, 0x0200 for USB2.0)
-    BULK_DEVICE,                                // Class Code-->00
-    0xFF,                                       // Subclass code
-    0xFF,                                       // Protocol code
+    0x00,                                       // Class Code (in the interface descriptor)
+    0x00,                                       // Subclass code
+    0x00,                                       // Protocol code
     USB_EP0_BUFF_SIZE,                          // Max packet size for EP0
     VENDORID,                                   // Vendor ID, microchip=0x04D8, generic=0x05f9, test=0x067b
     PRODUCTID,                                  // Product ID 0x00A für CDC, generic=0xffff, test=0x2303
@@ -61,52 +61,44 @@ const USB_DEVICE_DESCRIPTOR usb_device =
                                     sizeof(USB_ENDPOINT_DESCRIPTOR) + \
                                     sizeof(USB_ENDPOINT_DESCRIPTOR) )
 
-const u8 usb_config1_descriptor = 
+const u8 usb_config1_descriptor[] =
 {
     // Configuration Descriptor Header
-    {
-        sizeof(USB_CONFIGURATION_DESCRIPTOR),   // Size of this descriptor in bytes
-        USB_DESCRIPTOR_CONFIGURATION,           // CONFIGURATION descriptor type
-        CONFIGURATION_TOTAL_LENGTH, 0x00,       // Total length of data for this configuration
-        BULK_EP_NUM,                            // Number of interfaces in this configuration
-        1,                                      // Index value of this configuration
-        0,                                      // Configuration string index
-        USB_CFG_DSC_SELF_PWR,                   // Attributes
-        125                                     // Maximum Power Consumption in 2mA units
-    },
+    sizeof(USB_CONFIGURATION_DESCRIPTOR),       // Size of this descriptor in bytes
+    USB_DESCRIPTOR_CONFIGURATION,               // CONFIGURATION descriptor type
+    CONFIGURATION_TOTAL_LENGTH, 0x00,           // Total length of data for this configuration
+    BULK_INT_NUM,                               // Number of interfaces in this configuration
+    1,                                          // Index value of this configuration
+    0,                                          // Configuration string index
+    USB_CFG_DSC_SELF_PWR,                       // Attributes
+    125,                                        // Maximum Power Consumption in 2mA units
 
     // Data Interface Descriptor with in and out EPs
-    {
-        sizeof(USB_INTERFACE_DESCRIPTOR),       // Size of this descriptor in bytes
-        USB_DESCRIPTOR_INTERFACE,               // Interface descriptor type
-        0,                                      // Interface Number
-        0,                                      // Alternate Setting Number
-        NB_ENDPOINTS,                           // Number of endpoints in this interface
-        0xff,                                   // Class code
-        0xff,                                   // TODO: Subclass code
-        0xff,                                   // TODO: Protocol code
-        0                                       // Index of String Descriptor Describing this interface-->2
-    },
+    sizeof(USB_INTERFACE_DESCRIPTOR),           // Size of this descriptor in bytes
+    USB_DESCRIPTOR_INTERFACE,                   // Interface descriptor type
+    0,                                          // Interface Number
+    0,                                          // Alternate Setting Number
+    2,                                          // Number of endpoints in this interface
+    0xff,                                       // Class code
+    0xff,                                       // TODO: Subclass code
+    0xff,                                       // TODO: Protocol code
+    0,                                          // Index of String Descriptor Describing this interface-->2
 
     // Endpoint 1 Out
-    {
-        sizeof(USB_ENDPOINT_DESCRIPTOR),        // Size of Descriptor
-        USB_DESCRIPTOR_ENDPOINT,                // Descriptor Type
-        _EP_OUT + 0x01,                         // Endpoint Address
-        BULK_TRANSFER,                          // Attribute = Bulk Transfer
-        EP1_BUFFER_SIZE,                        // Packet Size
-        0x00                                    // Poll Intervall
-    },
+    sizeof(USB_ENDPOINT_DESCRIPTOR),            // Size of Descriptor
+    USB_DESCRIPTOR_ENDPOINT,                    // Descriptor Type
+    _EP_OUT | USB_BULK_DATA_EP,                 // Endpoint Address
+    _BULK,                                      // Attribute = Bulk Transfer
+    BULK_BULK_OUT_SIZE, 0x00,                   // Packet Size
+    0x00,                                       // Poll Intervall
 
     // Endpoint 1 IN
-    {
-        sizeof(USB_ENDPOINT_DESCRIPTOR),        // Size of Descriptor
-        USB_DESCRIPTOR_ENDPOINT,                // Descriptor Type
-        _EP_IN + 0x01,                          // Endpoint Address
-        BULK_TRANSFER,                          // Attribute = Bulk Transfer
-        EP1_BUFFER_SIZE,                        // Packet Size
-        0x00                                    // Poll Intervall
-    }
+    sizeof(USB_ENDPOINT_DESCRIPTOR),            // Size of Descriptor
+    USB_DESCRIPTOR_ENDPOINT,                    // Descriptor Type
+    _EP_IN | USB_BULK_DATA_EP,                  // Endpoint Address
+    _BULK,                                      // Attribute = Bulk Transfer
+    BULK_BULK_IN_SIZE, 0x00,                    // Packet Size
+    0x00                                        // Poll Intervall
 };
 
 #endif /* __USBBULK__ */
@@ -649,11 +649,22 @@ void usb_device_tasks(void)
              // 1. EP0 SETUP
              // 2. EP0 OUT
              // 3. EP0 IN
-             // It ignores all other types (i.e. EP1, EP2, etc.)
+             // The other endpoints (EP1, EP2, etc.) go to their class
+             // driver if it needs it (BULK), or are ignored.
 
             // U1STAT provides endpoint information
             ustat_saved = U1STAT;
 
+            // ENDPT<3:0> = U1STAT<7:4>, a class endpoint
+            if (ustat_saved & 0xF0)
+            {
+                #if defined(__USBBULK__)
+                usb_bulk_transfer_complete(ustat_saved);
+                #endif
+                U1IR |= _U1IR_TRNIF_MASK;
+                return;
+            }
+
             //usb_ctrl_ep_service();
             // If the last packet was a EP0 OUT packet
             if ((ustat_saved & USTAT_EP0_PP_MASK) == USTAT_EP0_OUT)
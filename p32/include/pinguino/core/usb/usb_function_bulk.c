@@ -1,5 +1,25 @@
 /**
     All BULK functions should go here
+
+    19 Oct. 2026 - streaming with the even/odd (ping-pong) BDs
+
+    IN (device to host)
+    Buffers of any length are queued as they are (no copy), the
+    engine splits them in max-packet transactions and keeps both
+    IN BDs armed, the next buffer starts in the free BD while the
+    last packet of the previous one is still on the bus. The
+    callback is called from the USB interrupt when all the packets
+    of a buffer have been sent, the buffer can be reused then.
+    A buffer whose length is a multiple of 64 ends with a zero
+    length packet, except when sent with BULKstream().
+
+    OUT (host to device)
+    BULK_RXQUEUE packet buffers, both OUT BDs are kept armed while
+    a buffer is free. When they are all filled the host is NAKed
+    until the application releases one.
+
+    The BDs are only used through usb_transfer_one_packet() and
+    usb_handle_busy() so this engine can be tested on a host.
 **/
 
 #ifndef USB_BULK_C_
@@ -9,95 +29,312 @@
 #include <usb/usb_device.h>
 #include <usb/usb_function_bulk.h>
 
+// Protects the queues from the USB interrupt
+#ifndef BULK_LOCK
+    #if defined(__USBINTERRUPT__)
+    #define BULK_LOCK()                 IntDisable(_USB_IRQ)
+    #define BULK_UNLOCK()               IntEnable(_USB_IRQ)
+    #else
+    #define BULK_LOCK()
+    #define BULK_UNLOCK()
+    #endif
+#endif
+
 volatile u8 bulk_data_rx[BULK_BULK_OUT_SIZE];
 volatile u8 bulk_data_tx[BULK_BULK_IN_SIZE];
 
-#define BULKavailable() (!EP_OUT_BD(USB_BULK_DATA_EP_NUM).Stat.UOWN) && (EP_OUT_BD(USB_BULK_DATA_EP_NUM).Cnt > 0)
+typedef struct
+{
+    u8 *buffer;
+    u32 length;
+    u32 armed;                          // bytes given to the BDs
+    u32 sent;                           // bytes acknowledged by the host
+    u8  zlp;                            // ends with a zero length packet
+    u8  last;                           // last packet is in a BD
+    bulk_callback callback;
+} bulk_transfer_t;
+
+// IN : transfers queue and the 2 BDs in flight (oldest first)
+static bulk_transfer_t bulk_tx[BULK_TXQUEUE];
+static volatile u8 bulk_tx_head;        // next free slot (application)
+static volatile u8 bulk_tx_tail;        // oldest transfer (interrupt)
+static u8 bulk_tx_arm;                  // transfer being split in packets
+static USB_HANDLE bulk_tx_bd[2];
+static u8 bulk_tx_bdlen[2];
+static u8 bulk_tx_bdlast[2];            // last packet of its transfer
+static u8 bulk_tx_bdfirst;
+static u8 bulk_tx_bdcount;
+
+// OUT : tail <= head <= arm, buffers from tail to head are filled
+static u8 bulk_rx_buffer[BULK_RXQUEUE][BULK_BULK_OUT_SIZE] __attribute__ ((aligned (4)));
+static u8 bulk_rx_length[BULK_RXQUEUE];
+static USB_HANDLE bulk_rx_bd[BULK_RXQUEUE];
+static volatile u8 bulk_rx_head;        // next buffer to be filled
+static volatile u8 bulk_rx_tail;        // oldest filled buffer
+static u8 bulk_rx_arm;                  // next buffer to give to a BD
+
+// BULKputs copies in bulk_data_tx
+static volatile u8 bulk_puts_busy;
+
+#define BULKavailable()                 ((u8)(bulk_rx_head - bulk_rx_tail))
+
+/**
+    Arms the free IN BDs with the next packets
+**/
+
+static void bulk_tx_fill(void)
+{
+    bulk_transfer_t *t;
+    u32 n;
+    u8 i;
+
+    while (bulk_tx_bdcount < 2 && bulk_tx_arm != bulk_tx_head)
+    {
+        t = &bulk_tx[bulk_tx_arm & (BULK_TXQUEUE - 1)];
+
+        n = t->length - t->armed;
+        if (n > BULK_BULK_IN_SIZE)
+            n = BULK_BULK_IN_SIZE;
+
+        // short packet, or full one with no ZLP to follow
+        if (n < BULK_BULK_IN_SIZE || (t->armed + n == t->length && !t->zlp))
+            t->last = 1;
+
+        i = (bulk_tx_bdfirst + bulk_tx_bdcount) & 1;
+        bulk_tx_bd[i] = usb_tx_one_packet(USB_BULK_DATA_EP, t->buffer + t->armed, n);
+        bulk_tx_bdlen[i] = n;
+        bulk_tx_bdlast[i] = t->last;
+        bulk_tx_bdcount++;
+        t->armed += n;
+
+        if (t->last)
+            bulk_tx_arm++;
+    }
+}
+
+/**
+    Retires the IN packets sent, calls back the transfers done
+**/
+
+static void bulk_tx_service(void)
+{
+    bulk_transfer_t *t;
+    u8 last;
+
+    while (bulk_tx_bdcount && !usb_handle_busy(bulk_tx_bd[bulk_tx_bdfirst]))
+    {
+        t = &bulk_tx[bulk_tx_tail & (BULK_TXQUEUE - 1)];
+        t->sent += bulk_tx_bdlen[bulk_tx_bdfirst];
+        last = bulk_tx_bdlast[bulk_tx_bdfirst];
+        bulk_tx_bdfirst ^= 1;
+        bulk_tx_bdcount--;
+
+        // the BD of the last packet, not the byte count : a ZLP
+        // adds nothing and would call back one packet too early
+        if (last)
+        {
+            bulk_tx_tail++;
+            if (t->callback)
+                t->callback(t->buffer, t->length);
+        }
+    }
+
+    bulk_tx_fill();
+}
+
+/**
+    Collects the OUT packets received, arms the free buffers
+**/
+
+static void bulk_rx_service(void)
+{
+    u8 i;
+
+    while (bulk_rx_head != bulk_rx_arm)
+    {
+        i = bulk_rx_head & (BULK_RXQUEUE - 1);
+        if (usb_handle_busy(bulk_rx_bd[i]))
+            break;
+        bulk_rx_length[i] = bulk_rx_bd[i]->CNT;
+        bulk_rx_head++;
+    }
+
+    while ((u8)(bulk_rx_arm - bulk_rx_head) < 2 &&
+           (u8)(bulk_rx_arm - bulk_rx_tail) < BULK_RXQUEUE)
+    {
+        i = bulk_rx_arm & (BULK_RXQUEUE - 1);
+        bulk_rx_bd[i] = usb_rx_one_packet(USB_BULK_DATA_EP, bulk_rx_buffer[i], BULK_BULK_OUT_SIZE);
+        bulk_rx_arm++;
+    }
+}
+
+/**
+    Called by the USB stack when a transaction on the data endpoint
+    is complete (U1STAT DIR bit tells which way)
+**/
+
+void usb_bulk_transfer_complete(u8 ustat)
+{
+    if (ustat & 0x08)
+        bulk_tx_service();
+    else
+        bulk_rx_service();
+}
 
 /**
     Initialize
 **/
 
-void bulk_init_endpoint(void)
+void usb_bulk_init_endpoint(void)
+{
+    bulk_tx_head = bulk_tx_tail = bulk_tx_arm = 0;
+    bulk_tx_bdfirst = bulk_tx_bdcount = 0;
+    bulk_rx_head = bulk_rx_tail = bulk_rx_arm = 0;
+    bulk_puts_busy = 0;
+
+    usb_enable_endpoint(USB_BULK_DATA_EP, USB_IN_ENABLED | USB_OUT_ENABLED |
+                                          USB_HANDSHAKE_ENABLED | USB_DISALLOW_SETUP);
+
+    bulk_rx_service();
+}
+
+/**
+    Queues a buffer to send, the buffer must stay untouched until
+    the callback (can be NULL) is called
+    @param zlp  1 to end with a zero length packet if needed
+    @return 1 if queued, 0 if the queue is full or USB not ready
+**/
+
+static u8 bulk_submit(u8 *buffer, u32 length, bulk_callback callback, u8 zlp)
+{
+    bulk_transfer_t *t;
+
+    if (usb_device_state != CONFIGURED_STATE)
+        return 0;
+
+    if ((u8)(bulk_tx_head - bulk_tx_tail) == BULK_TXQUEUE)
+        return 0;
+
+    if (length == 0 && !zlp)
+        return 0;
+
+    t = &bulk_tx[bulk_tx_head & (BULK_TXQUEUE - 1)];
+    t->buffer = buffer;
+    t->length = length;
+    t->armed = 0;
+    t->sent = 0;
+    t->zlp = zlp;
+    t->last = 0;
+    t->callback = callback;
+
+    BULK_LOCK();
+    bulk_tx_head++;
+    bulk_tx_fill();
+    BULK_UNLOCK();
+
+    return 1;
+}
+
+u8 BULKsend(u8 *buffer, u32 length, bulk_callback callback)
+{
+    return bulk_submit(buffer, length, callback, 1);
+}
+
+u8 BULKstream(u8 *buffer, u32 length, bulk_callback callback)
 {
-    // BULK Data EP is IN and OUT EP
-    USB_BULK_DATA_EP_UEP = EP_OUT_IN | HSHK_EN;
-
-    // now build EP
-    EP_OUT_BD(USB_BULK_DATA_EP_NUM).Cnt = sizeof(bulk_data_rx);
-    EP_OUT_BD(USB_BULK_DATA_EP_NUM).ADDR = &bulk_data_rx;
-    // USB owns buffer
-    EP_OUT_BD(USB_BULK_DATA_EP_NUM).Stat.uc = BDS_UOWN | BDS_DTSEN;
-
-    EP_IN_BD(USB_BULK_DATA_EP_NUM).ADDR = &bulk_data_tx;
-    // CPU owns buffer
-    EP_IN_BD(USB_BULK_DATA_EP_NUM).Stat.uc = BDS_DTS ;
+    return bulk_submit(buffer, length, callback, 0);
+}
+
+/**
+    Number of buffers queued and not sent yet
+**/
+
+u8 BULKpending(void)
+{
+    return (u8)(bulk_tx_head - bulk_tx_tail);
+}
+
+/**
+    Oldest packet received, NULL if none
+    It stays in the queue until BULKrelease() is called
+**/
+
+u8 *BULKreceive(u8 *length)
+{
+    u8 i;
+
+    if (bulk_rx_tail == bulk_rx_head)
+        return NULL;
+
+    i = bulk_rx_tail & (BULK_RXQUEUE - 1);
+    *length = bulk_rx_length[i];
+    return bulk_rx_buffer[i];
+}
+
+void BULKrelease(void)
+{
+    if (bulk_rx_tail == bulk_rx_head)
+        return;
+
+    BULK_LOCK();
+    bulk_rx_tail++;
+    bulk_rx_service();
+    BULK_UNLOCK();
 }
 
 /**
     Function to read a string from USB
-    @param buffer Buffer for reading data
-    @param lenght Number of bytes to be read
+    @param buffer Buffer for reading data (64 bytes)
     @return number of bytes acutally read
 **/
 
 u8 BULKgets(char *buffer)
 {
-    u8 i=0;
-    u8 length=64;
+    u8 *packet;
+    u8 i, length;
 
-    if (deviceState != CONFIGURED)
+    packet = BULKreceive(&length);
+    if (packet == NULL)
         return 0;
 
-    // Only Process if we own the buffer aka not own by SIE
-    if (!EP_OUT_BD(USB_BULK_DATA_EP_NUM).Stat.UOWN)
-    {
-        // check how much bytes came
-        if (length > EP_OUT_BD(USB_BULK_DATA_EP_NUM).Cnt)
-            length = EP_OUT_BD(USB_BULK_DATA_EP_NUM).Cnt;
-            
-        for (i=0; i < EP_OUT_BD(USB_BULK_DATA_EP_NUM).Cnt; i++)
-            buffer[i] = bulk_data_rx[i];
-
-        // clear BDT Stat bits beside DTS and then togle DTS
-        EP_OUT_BD(USB_BULK_DATA_EP_NUM).Stat.uc &= 0x40;
-        EP_OUT_BD(USB_BULK_DATA_EP_NUM).Stat.DTS = !EP_OUT_BD(USB_BULK_DATA_EP_NUM).Stat.DTS;
-        // reset buffer count and handle controll of buffer to USB
-        EP_OUT_BD(USB_BULK_DATA_EP_NUM).Cnt = sizeof(bulk_data_rx);
-        EP_OUT_BD(USB_BULK_DATA_EP_NUM).Stat.uc |= BDS_UOWN | BDS_DTSEN;
-    }
-    // return number of bytes read
-    return i;
+    for (i = 0; i < length; i++)
+        buffer[i] = packet[i];
+
+    BULKrelease();
+    return length;
 }
 
 /**
     Function writes string to USB
-    atm not more than MAX_SIZE is allowed
-    if more is needed transfer must be split up
+    not more than BULK_BULK_IN_SIZE bytes, copied in bulk_data_tx
+    @return number of bytes written, 0 if the previous ones are not
+    sent yet
 **/
 
+static void bulk_puts_done(u8 *buffer, u32 length)
+{
+    bulk_puts_busy = 0;
+}
+
 u8 BULKputs(char *buffer, u8 length)
 {
-    u8 i=0;
+    u8 i;
 
-    if (deviceState != CONFIGURED) return 0;
+    if (bulk_puts_busy)
+        return 0;
+
+    if (length > BULK_BULK_IN_SIZE)
+        length = BULK_BULK_IN_SIZE;
+    for (i = 0; i < length; i++)
+        bulk_data_tx[i] = buffer[i];
 
-    if (!EP_IN_BD(USB_BULK_DATA_EP_NUM).Stat.UOWN)
+    bulk_puts_busy = 1;
+    if (!BULKsend((u8*)bulk_data_tx, length, bulk_puts_done))
     {
-        if (length > BULK_BULK_IN_SIZE)
-            length = BULK_BULK_IN_SIZE;
-        for (i=0; i < length; i++)
-            bulk_data_tx[i] = buffer[i];
-
-        // Set counter to num bytes ready for send
-        EP_IN_BD(USB_BULK_DATA_EP_NUM).Cnt = i;
-        // clear BDT Stat bits beside DTS and then togle DTS
-        EP_IN_BD(USB_BULK_DATA_EP_NUM).Stat.uc &= 0x40;
-        EP_IN_BD(USB_BULK_DATA_EP_NUM).Stat.DTS = !EP_IN_BD(USB_BULK_DATA_EP_NUM).Stat.DTS;
-        // reset Buffer to original state
-        EP_IN_BD(USB_BULK_DATA_EP_NUM).Stat.uc |= BDS_UOWN | BDS_DTSEN;
+        bulk_puts_busy = 0;
+        return 0;
     }
-    return i;
+    return length;
 }
 
 //#endif /* USB_USE_BULK */
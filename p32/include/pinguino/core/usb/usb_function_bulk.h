@@ -22,6 +22,17 @@
 #define BULK_IN_EP_SIZE                 8
 #define BULK_BULK_IN_SIZE               64
 #define BULK_BULK_OUT_SIZE              64
+#define USB_BULK_DATA_EP                1
+
+// Buffers queued to be sent (power of 2)
+#ifndef BULK_TXQUEUE
+#define BULK_TXQUEUE                    4
+#endif
+
+// Packets received and not read yet (power of 2, 2 at least)
+#ifndef BULK_RXQUEUE
+#define BULK_RXQUEUE                    4
+#endif
 
 /*
  * USB directions
@@ -56,11 +67,23 @@
 
 //#ifdef USB_USE_BULK
 // BULK specific buffers
-extern volatile byte bulk_data_rx[BULK_BULK_OUT_SIZE];
-extern volatile byte bulk_data_tx[BULK_BULK_IN_SIZE];
+extern volatile u8 bulk_data_rx[BULK_BULK_OUT_SIZE];
+extern volatile u8 bulk_data_tx[BULK_BULK_IN_SIZE];
+
+// Called from the USB interrupt when a buffer has been sent
+typedef void (*bulk_callback)(u8 *buffer, u32 length);
 
 //void usb_bulk_check_request(void);
 void usb_bulk_init_endpoint(void);
+void usb_bulk_transfer_complete(u8 ustat);
+
+u8 BULKsend(u8 *buffer, u32 length, bulk_callback callback);
+u8 BULKstream(u8 *buffer, u32 length, bulk_callback callback);
+u8 BULKpending(void);
+u8 *BULKreceive(u8 *length);
+void BULKrelease(void);
+u8 BULKgets(char *buffer);
+u8 BULKputs(char *buffer, u8 length);
 //#endif
 
 #endif /* USB_BULK_H_ */
@@ -1,13 +1,15 @@
 // Bulk module for Pinguino
 // André Gentric 2013
 // Régis Blanchot 2016
+// 19 Oct. 2026 - streaming API (BULK_send, BULK_stream, BULK_receive)
+//                on the ping-pong BDs, cf. usb/usb_function_bulk.c
 
 #ifndef __USBBULK__
 #define __USBBULK__
 
 // Version
 #define BULK_MAJOR_VER 0
-#define BULK_MINOR_VER 1
+#define BULK_MINOR_VER 2
 
 /***********************************************************************
  ** Config. ************************************************************
@@ -40,6 +42,9 @@
 #include <system.c>
 //#include <delay.c>
 
+// Interrupts
+#include <interrupt.c>
+
 // Printf
 #if defined(BULKPRINTF)
 #include <printFormated.c>
@@ -71,6 +76,18 @@
 
 #define EP1_BUFFER_SIZE         64//added 24-8-13
 #define BULK_available()        (BULKavailable())
+#define BULK_send(b, l, f)      (BULKsend(b, l, f))
+#define BULK_stream(b, l, f)    (BULKstream(b, l, f))
+#define BULK_pending()          (BULKpending())
+#define BULK_receive(l)         (BULKreceive(l))
+#define BULK_release()          (BULKrelease())
+
+// Lets the USB stack run while waiting in polling mode
+#if defined(__USBPOLLING__)
+#define BULK_WAIT()             usb_device_tasks()
+#else
+#define BULK_WAIT()
+#endif
 
 void BULK_begin()
 {
@@ -87,33 +104,57 @@ void BULK_begin()
 }
 
 /***********************************************************************
- * Send a char to the USB.
- * Return a number of free bytes in transmit buffer.
+ * Send a buffer of any length (in RAM) to the USB.
+ * Wait until it has been sent, return the number of bytes sent.
  **********************************************************************/
- 
-u8 BULK_write(u8 *txpointer, u8 length)
+
+static volatile u8 bulk_write_busy;
+
+static void bulk_write_done(u8 *buffer, u32 length)
 {
-    return(BULKputs(txpointer,length));
+    bulk_write_busy = 0;
 }
 
-void BULK_printChar(char c)
+u32 BULK_write(u8 *txpointer, u32 length)
 {
-    /*
-    if (bulk_trf_state == BULK_TX_READY)
+    bulk_write_busy = 1;
+    while (!BULKsend(txpointer, length, bulk_write_done))
     {
-        bulk_tx_len = 1;
-        bulk_trf_state = BULK_TX_BUSY;
-        bulk_data_tx[0] = c;
+        if (usb_device_state != CONFIGURED_STATE)
+            return 0;
+        BULK_WAIT();
     }
-    */
-    while (bulk_trf_state != BULK_TX_READY)
-        bulk_tx_service();
 
-    bulk_tx_len = 1;
-    bulk_trf_state = BULK_TX_BUSY;
-    bulk_data_tx[0] = c;
+    while (bulk_write_busy)
+    {
+        if (usb_device_state != CONFIGURED_STATE)
+            return 0;
+        BULK_WAIT();
+    }
+    return length;
+}
+
+/***********************************************************************
+ * Copy a string (RAM or flash) to the USB, 64 bytes at a time.
+ **********************************************************************/
+
+static void bulk_puts_all(const char *string, u32 length)
+{
+    u8 n;
+
+    while (length && usb_device_state == CONFIGURED_STATE)
+    {
+        n = BULKputs((char *)string, length > BULK_BULK_IN_SIZE ? BULK_BULK_IN_SIZE : length);
+        string += n;
+        length -= n;
+        if (!n)
+            BULK_WAIT();
+    }
+}
 
-    //return sizeof(bulk_data_tx) - bulk_tx_len;
+void BULK_printChar(char c)
+{
+    bulk_puts_all(&c, 1);
 }
 
 /***********************************************************************
@@ -127,20 +168,7 @@ void BULK_printChar(char c)
 #if defined(BULKWRITE) || defined(BULKPRINT) || defined(BULKPRINTLN) || defined(BULKPRINTF)
 void BULK_print(const char *string)
 {
-    /*
-    if (bulk_trf_state == BULK_TX_READY)
-    {
-        bulk_tx_len = strlen(string);
-        bulk_trf_state = BULK_TX_BUSY;
-        *bulk_data_tx = *string;
-    }
-    */
-    while (bulk_trf_state != BULK_TX_READY)
-        bulk_tx_service();
-
-    bulk_tx_len = strlen(string);
-    bulk_trf_state = BULK_TX_BUSY;
-    *bulk_data_tx = *string;
+    bulk_puts_all(string, strlen(string));
 }
 #endif
 
@@ -199,6 +227,9 @@ void BULK_printf(const char *fmt, ...)
     u8 length;
     va_list	args;
 
+    while (bulk_puts_busy)
+        BULK_WAIT();
+
     va_start(args, fmt);
     length = psprintf2(bulk_data_tx, fmt, args);
     BULKputs(bulk_data_tx,length);
@@ -224,7 +255,8 @@ u8 BULK_getkey(void)
 {
     u8 buffer[_BULKBUFFERLENGTH_];   // always get a full packet
 
-    while (!BULKgets(buffer));
+    while (!BULKgets(buffer))
+        BULK_WAIT();
     return (buffer[0]);             // return only the first character
 }
 #endif
@@ -263,18 +263,34 @@ void CDC_printFloat(float number, u8 digits)
  **********************************************************************/
 
 #if defined(CDCPRINTF)
-void CDC_printf(const char *fmt, ...)
+/*
+ * span sink of the formatter, each run of chars (up to PRINTF_SINK_LEN,
+ * the size of a packet) is sent as soon as the previous one is gone
+ */
+void cdc_printSpan(const u8 *s, u16 n)
 {
-    va_list	args;
+    u16 len;
 
-    va_start(args, fmt);
+    while (n)
+    {
+        while (cdc_trf_state != CDC_TX_READY)
+            cdc_tx_service();
 
-    while (cdc_trf_state != CDC_TX_READY)
-        cdc_tx_service();
+        len = (n > sizeof(cdc_data_tx)) ? sizeof(cdc_data_tx) : n;
+        memcpy(cdc_data_tx, s, len);
+        cdc_trf_state = CDC_TX_BUSY;
+        cdc_tx_len = len;
+        s += len;
+        n -= len;
+    }
+}
 
-    cdc_trf_state = CDC_TX_BUSY;
-    cdc_tx_len = psprintf2(&cdc_data_tx, fmt, args);
+void CDC_printf(const char *fmt, ...)
+{
+    va_list	args;
 
+    va_start(args, fmt);
+    pprintfw(cdc_printSpan, fmt, args);
     va_end(args);
 }
 #endif
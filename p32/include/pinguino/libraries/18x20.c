@@ -38,6 +38,14 @@
                                     Updated DS18B20.function() to DS18x20.function()
                                     Completed 18B20 and 18S20 reading
                                     Updated DS18x20Wait() to a non-blocking loop
+    19 Oct 2026                     Removed the bus reset sent between Match ROM
+                                    and the function command (it deselected the device)
+                                    Family code taken from the cached ROM code
+                                    CRC computed with the OneWireCRC8 table
+                                    Added DS18x20ReadAll() : one parallel conversion
+                                    (Skip ROM + Convert T) for all the sensors found
+                                    Added DS18x20StartSweep() / DS18x20Service() :
+                                    the same sweep on the non-blocking 1-wire engine
     --------------------------------------------------------------------
     TODO :
     * DS1822 support
@@ -83,7 +91,7 @@
     ---------- GLOBAL VARIABLES
     ------------------------------------------------------------------*/
 
-    u8 DS18X20ROM[MAX_SENSORS_NUM][8];  // table of found ROM codes
+    u8 DS18X20ROM[MAX_SENSORS_NUM+1][8];// found ROM codes (index 1 to gNumROMs)
     u8 gROMCODE[8];                      // ROM Bit
     u8 gSCRATCHPAD[9];                   // Scratchpad
     u8 gLastDiscrep = 0;                // last discrepancy
@@ -92,25 +100,6 @@
     u8 gDowCRC = 0;
     u8 gFamily = 0;
     
-    /*
-    const u8 dscrc_table[] = {
-        0, 94,188,226, 97, 63,221,131,194,156,126, 32,163,253, 31, 65,
-        157,195, 33,127,252,162, 64, 30, 95, 1,227,189, 62, 96,130,220,
-        35,125,159,193, 66, 28,254,160,225,191, 93, 3,128,222, 60, 98,
-        190,224, 2, 92,223,129, 99, 61,124, 34,192,158, 29, 67,161,255,
-        70, 24,250,164, 39,121,155,197,132,218, 56,102,229,187, 89, 7,
-        219,133,103, 57,186,228, 6, 88, 25, 71,165,251,120, 38,196,154,
-        101, 59,217,135, 4, 90,184,230,167,249, 27, 69,198,152,122, 36,
-        248,166, 68, 26,153,199, 37,123, 58,100,134,216, 91, 5,231,185,
-        140,210, 48,110,237,179, 81, 15, 78, 16,242,172, 47,113,147,205,
-        17, 79,173,243,112, 46,204,146,211,141,111, 49,178,236, 14, 80,
-        175,241, 19, 77,206,144,114, 44,109, 51,209,143, 12, 82,176,238,
-        50,108,142,208, 83, 13,239,177,240,174, 76, 18,145,207, 45,115,
-        202,148,118, 40,171,245, 23, 73, 8, 86,180,234,105, 55,213,139,
-        87, 9,235,181, 54,104,138,212,149,203, 41,119,244,170, 72, 22,
-        233,183, 85, 11,136,214, 52,106, 43,117,151,201, 74, 20,246,168,
-        116, 42,200,150, 21, 75,169,247,182,232, 10, 84,215,137,107, 53};
-    */
 
 /*  --------------------------------------------------------------------
     ---------- DS18x20Wait()
@@ -206,13 +195,8 @@
 
         // Talk to a particular device
         else
-        {
             if (!DS18x20MatchRom(bus, index))
                 return false;
-            // Exit if no device is present
-            if (OneWireReset(bus))
-                return false;
-        }
 
         // Send Command
         OneWireWriteByte(bus, CONVERT_T);
@@ -235,6 +219,10 @@
 
     u8 DS18x20ReadMeasure(u8 bus, u8 index, DS18x20_Temperature * t)
     {
+        // The family code is the first byte of the ROM code
+        if (index != SKIPROM && index <= gNumROMs)
+            gFamily = DS18X20ROM[index][0];
+
         #ifdef DS18X20DEBUG
         Serial_printf("Fam. = 0x%X\r\n", gFamily);
         #endif
@@ -279,6 +267,41 @@
         return (DS18x20ReadMeasure(bus, index, t));
     }
 
+/*  --------------------------------------------------------------------
+    ---------- DS18x20ReadAll()
+    --------------------------------------------------------------------
+    * Description:  starts the conversion of all the sensors at once
+                    (Skip ROM + Convert T), waits for the end of the
+                    conversion then reads every sensor found by
+                    DS18x20Find()
+    * Arguments:    bus = pin number where the 1-wire bus is connected.
+                    t = DS18x20DeviceCount() temperatures,
+                    t[0] is sensor #1
+    * Note          a sweep lasts one conversion time (750 ms at 12-bit)
+                    whatever the number of sensors
+    * Returns       number of sensors successfully read
+    ------------------------------------------------------------------*/
+
+    #ifdef DS18x20READALL
+    u8 DS18x20ReadAll(u8 bus, DS18x20_Temperature * t)
+    {
+        u8 i, n = 0;
+
+        // All the sensors convert in parallel
+        if (!DS18x20StartMeasure(bus, SKIPROM))
+            return 0;
+
+        // Wait while the 1-wire bus is busy
+        DS18x20Wait(bus);
+
+        for (i = 1; i <= gNumROMs; i++)
+            if (DS18x20ReadMeasure(bus, i, &t[i - 1]))
+                n++;
+
+        return n;
+    }
+    #endif // DS18x20READALL
+
 /*  --------------------------------------------------------------------
     ---------- DS18x20ReadFahrenheit()
     --------------------------------------------------------------------
@@ -337,13 +360,8 @@
 
         // Talk to a particular device
         else
-        {
             if (!DS18x20MatchRom(bus, index))
                 return false;
-            // Exit if no device is present
-            if (OneWireReset(bus))
-                return false;
-        }
 
         // Send Command
         OneWireWriteByte(bus, cmd);
@@ -433,65 +451,70 @@
     }
 
 /*  --------------------------------------------------------------------
-    ---------- DS18B20ReadMeasure()
+    ---------- DS18B20Decode() / DS18B20ReadMeasure()
     --------------------------------------------------------------------
     * Description:  reads the DS18B20 device on the 1-wire bus
+                    Decode() only converts a scratchpad already read
     * Arguments:    bus = pin number where the 1-wire bus is connected.
                     index = index of the sensor or SKIPROM
                     t = temperature pointer
     * Return:       the temperature previously acquired
     ------------------------------------------------------------------*/
 
-    u8 DS18B20ReadMeasure(u8 bus, u8 index, DS18x20_Temperature * t)
+    u8 DS18B20Decode(const u8 *scratchpad, DS18x20_Temperature * t)
     {
         u8  temp_lsb, temp_msb;
         u16 temp;
 
-        if (DS18x20ReadMemory(bus, index, READ_SCRATCHPAD, gSCRATCHPAD))
-        {
-            temp_lsb = gSCRATCHPAD[0];  // byte 0 of scratchpad : temperature lsb
-            temp_msb = gSCRATCHPAD[1];  // byte 1 of scratchpad : temperature msb
-
-            // Calculation
-            // -----------------------------------------------------
-            //  Temperature Register Format
-            //          BIT7    BIT6    BIT5    BIT4    BIT3    BIT2    BIT1    BIT0
-            //  LSB     2^3     2^2     2^1     2^0     2^-1    2^-2    2^-3    2^-4
-            //          BIT15   BIT14   BIT13   BIT12   BIT11   BIT10   BIT9    BIT8
-            //  MSB     S   S       S       S       S       2^6     2^5     2^4
-            //  S = SIGN
-
-            // combine msb & lsb into 16 bit variable
-            temp = (temp_msb << 8) + temp_lsb;
-            
-            // test if sign is set, i.e. negative
-            if (temp_msb & 0b11111000)
-            {
-                t->sign = 1;
-                temp = (temp ^ 0xFFFF) + 1;	// 2's complement conversion
-            }
-            else
-            {
-                t->sign = 0;
-            }
+        temp_lsb = scratchpad[0];  // byte 0 of scratchpad : temperature lsb
+        temp_msb = scratchpad[1];  // byte 1 of scratchpad : temperature msb
 
-            // fractional part is removed, leaving only integer part
-            t->integer = (temp >> 4) & 0x7F;
-            t->fraction = (temp & 0x0F) * 625;
-            // two digits after decimal 
-            //t->fraction /= 100;
-            #ifdef DS18X20DEBUG
-            Serial_printf("Temp. = %02d.%02d\176C\r\n", t->integer, t->fraction);
-            #endif
-            return true;
+        // Calculation
+        // -----------------------------------------------------
+        //  Temperature Register Format
+        //          BIT7    BIT6    BIT5    BIT4    BIT3    BIT2    BIT1    BIT0
+        //  LSB     2^3     2^2     2^1     2^0     2^-1    2^-2    2^-3    2^-4
+        //          BIT15   BIT14   BIT13   BIT12   BIT11   BIT10   BIT9    BIT8
+        //  MSB     S   S       S       S       S       2^6     2^5     2^4
+        //  S = SIGN
+
+        // combine msb & lsb into 16 bit variable
+        temp = (temp_msb << 8) + temp_lsb;
+        
+        // test if sign is set, i.e. negative
+        if (temp_msb & 0b11111000)
+        {
+            t->sign = 1;
+            temp = (temp ^ 0xFFFF) + 1;	// 2's complement conversion
         }
+        else
+        {
+            t->sign = 0;
+        }
+
+        // fractional part is removed, leaving only integer part
+        t->integer = (temp >> 4) & 0x7F;
+        t->fraction = (temp & 0x0F) * 625;
+        // two digits after decimal 
+        //t->fraction /= 100;
+        #ifdef DS18X20DEBUG
+        Serial_printf("Temp. = %02d.%02d\176C\r\n", t->integer, t->fraction);
+        #endif
+        return true;
+    }
+
+    u8 DS18B20ReadMeasure(u8 bus, u8 index, DS18x20_Temperature * t)
+    {
+        if (DS18x20ReadMemory(bus, index, READ_SCRATCHPAD, gSCRATCHPAD))
+            return DS18B20Decode(gSCRATCHPAD, t);
         return false;
     }
 
 /*  --------------------------------------------------------------------
-    ---------- DS18S20ReadMeasure()
+    ---------- DS18S20Decode() / DS18S20ReadMeasure()
     --------------------------------------------------------------------
     * Description:  reads the DS18S20 device on the 1-wire bus
+                    Decode() only converts a scratchpad already read
     * Arguments:    bus = pin number where the 1-wire bus is connected.
                     index = index of the sensor or SKIPROM
                     t = temperature pointer
@@ -510,71 +533,74 @@
     * Returns:      the temperature previously acquired
     ------------------------------------------------------------------*/
 
-    u8 DS18S20ReadMeasure(u8 bus, u8 index, DS18x20_Temperature * t)
+    u8 DS18S20Decode(const u8 *scratchpad, DS18x20_Temperature * t)
     {
         u8  temp_lsb, temp_msb;
         u8  count_remain, count_per_c;
         u16 temp;
 
-        if (DS18x20ReadMemory(bus, index, READ_SCRATCHPAD, gSCRATCHPAD))
-        {
-            temp_lsb = gSCRATCHPAD[0];       // byte 0 of scratchpad : temperature lsb
-            temp_msb = gSCRATCHPAD[1];       // byte 1 of scratchpad : temperature msb
-            count_remain = gSCRATCHPAD[6];
-            count_per_c = gSCRATCHPAD[7];
-
-            temp = temp_msb;
-            temp = (temp << 8) + temp_lsb;  // combine msb & lsb into 16 bit variable
-                    
-            if (temp_msb & 0b11111111)      // test if sign is set, i.e. negative
-            {
-                t->sign = 1;
-                temp = (temp ^ 0xFFFF) + 1; // 2's complement conversion
-            }
-            else
-            {
-                t->sign = 0;
-            }
-            
-            /*
-            CALCULATING STANDARD RESOLUTION: 9bit resolution in 0.5 step per degree
-            */
-            //t->integer = (temp >> 1) & 0x00FF;	// fractional part is removed, leaving only integer part
-            //t->fraction = (temp & 0x01) * 50;
-            
-            /*
-            CALCULATING EXTENDED RESOLUTION:
-            
-                                            (Count_per_C - Count_Remain)
-            Temperature = temp_read - 0.25 + ---------------------------
-                                                    Count_per_C
+        temp_lsb = scratchpad[0];       // byte 0 of scratchpad : temperature lsb
+        temp_msb = scratchpad[1];       // byte 1 of scratchpad : temperature msb
+        count_remain = scratchpad[6];
+        count_per_c = scratchpad[7];
 
-            Where temp_read is the value from the temp_MSB and temp_LSB with
-            the least significant bit removed (the 0.5C bit).
-            
-            *** Smart calculation
-            Source: http://myarduinotoy.blogspot.it/2013/02/12bit-result-from-ds18s20.html
-            Let's implement it with integers to calculate the 1/16 of the Celsius degree value, 
-            this is the integer result we get from any other device.
-            
-            1) Truncating the 0.5 bit - use a simple & mask: raw & 0xFFFE
-            2) Convert to 12 bit value (1/16 of °C) - shift left: (raw & 0xFFFE)<<3
-            3) Subtracting 0.25 (1/4 °C of 1/16) or 0.25/0.0625 = 4: ((raw & 0xFFFE)<<3)-4
-            4) Add the count (count per c - count remain), count per c is constant of 16, 
-               and no need to dived by 16 since we are calculating to the 1/16 of °C: +16 - COUNT_REMAIN
-
-            Full expression: ((rawTemperature & 0xFFFE) << 3) - 4 + 16 - scratchPad[COUNT_REMAIN]
-            We can simplify it to: ((rawTemperature & 0xFFFE) << 3) + 12 - scratchPad[COUNT_REMAIN]
-            */
-            temp = ((temp & 0xFFFE) << 3) + 12 - count_remain;
-
-            // fractional part is removed, leaving only integer part
-            t->integer = (temp >> 4) & 0x00FF;
-            t->fraction = (temp & 0x0F) * 625;
-            // two digits after decimal 
-            //t->fraction /= 100;
-            return true;
+        temp = temp_msb;
+        temp = (temp << 8) + temp_lsb;  // combine msb & lsb into 16 bit variable
+                
+        if (temp_msb & 0b11111111)      // test if sign is set, i.e. negative
+        {
+            t->sign = 1;
+            temp = (temp ^ 0xFFFF) + 1; // 2's complement conversion
+        }
+        else
+        {
+            t->sign = 0;
         }
+        
+        /*
+        CALCULATING STANDARD RESOLUTION: 9bit resolution in 0.5 step per degree
+        */
+        //t->integer = (temp >> 1) & 0x00FF;	// fractional part is removed, leaving only integer part
+        //t->fraction = (temp & 0x01) * 50;
+        
+        /*
+        CALCULATING EXTENDED RESOLUTION:
+        
+                                        (Count_per_C - Count_Remain)
+        Temperature = temp_read - 0.25 + ---------------------------
+                                                Count_per_C
+
+        Where temp_read is the value from the temp_MSB and temp_LSB with
+        the least significant bit removed (the 0.5C bit).
+        
+        *** Smart calculation
+        Source: http://myarduinotoy.blogspot.it/2013/02/12bit-result-from-ds18s20.html
+        Let's implement it with integers to calculate the 1/16 of the Celsius degree value, 
+        this is the integer result we get from any other device.
+        
+        1) Truncating the 0.5 bit - use a simple & mask: raw & 0xFFFE
+        2) Convert to 12 bit value (1/16 of °C) - shift left: (raw & 0xFFFE)<<3
+        3) Subtracting 0.25 (1/4 °C of 1/16) or 0.25/0.0625 = 4: ((raw & 0xFFFE)<<3)-4
+        4) Add the count (count per c - count remain), count per c is constant of 16, 
+           and no need to dived by 16 since we are calculating to the 1/16 of °C: +16 - COUNT_REMAIN
+
+        Full expression: ((rawTemperature & 0xFFFE) << 3) - 4 + 16 - scratchPad[COUNT_REMAIN]
+        We can simplify it to: ((rawTemperature & 0xFFFE) << 3) + 12 - scratchPad[COUNT_REMAIN]
+        */
+        temp = ((temp & 0xFFFE) << 3) + 12 - count_remain;
+
+        // fractional part is removed, leaving only integer part
+        t->integer = (temp >> 4) & 0x00FF;
+        t->fraction = (temp & 0x0F) * 625;
+        // two digits after decimal 
+        //t->fraction /= 100;
+        return true;
+    }
+
+    u8 DS18S20ReadMeasure(u8 bus, u8 index, DS18x20_Temperature * t)
+    {
+        if (DS18x20ReadMemory(bus, index, READ_SCRATCHPAD, gSCRATCHPAD))
+            return DS18S20Decode(gSCRATCHPAD, t);
         return false;
     }
 
@@ -849,18 +875,135 @@
 
     void DS18x20CRC(u8 x)
     {
-        u8 i = (x ^ gDowCRC) & 0xff;
+        // 1rst method, the table is shared with 1wire.c
+        gDowCRC = OneWireCRC8Update(gDowCRC, x);
+    }
 
-        gDowCRC = 0;
+#if defined(ONEWIREASYNC)
+
+/*  --------------------------------------------------------------------
+    ---------- Non-blocking sweep
+    --------------------------------------------------------------------
+    DS18x20StartSweep() queues a Skip ROM + Convert T for all the
+    sensors, DS18x20Service() (to call from loop) queues one Match ROM
+    + Read Scratchpad per sensor once the conversion time has elapsed
+    and calls back func(index, &temperature, ok) for each of them,
+    the temperature is NULL when ok is false (no answer or bad CRC).
+    The bus is clocked by Timer5 (see 1wire.c), the main loop is never
+    blocked and the callback runs from the main loop.
+    DS18x20Find() must have been called previously.
+    ------------------------------------------------------------------*/
+
+    #include <string.h>                 // memcpy
+    #include <millis.c>
+
+    #define DS18x20_IDLE        0
+    #define DS18x20_CONVERTING  1
+    #define DS18x20_READING     2
+
+    typedef void (*DS18x20Callback)(u8, DS18x20_Temperature *, u8);
 
-        if (i & 0x01) gDowCRC ^= 0x5e;
-        if (i & 0x02) gDowCRC ^= 0xbc;
-        if (i & 0x04) gDowCRC ^= 0x61;
-        if (i & 0x08) gDowCRC ^= 0xc2;
-        if (i & 0x10) gDowCRC ^= 0x9d;
-        if (i & 0x20) gDowCRC ^= 0x23;
-        if (i & 0x40) gDowCRC ^= 0x46;
-        if (i & 0x80) gDowCRC ^= 0x8c;
+    u8  gDS18x20State = DS18x20_IDLE;
+    u8  gDS18x20Next;                   // next sensor to report
+    u16 gDS18x20ConvTime = 750;         // ms, 12-bit resolution
+    u32 gDS18x20Start;
+    DS18x20Callback gDS18x20Callback = NULL;
+
+    const u8 DS18x20ConvertCmd[2] = { SKIPROM, CONVERT_T };
+    u8 gDS18x20Cmd[MAX_SENSORS_NUM+1][10];  // MATCHROM + ROM + READ_SCRATCHPAD
+    u8 gDS18x20Pad[MAX_SENSORS_NUM+1][9];   // scratchpads
+    onewire_xfer_t gDS18x20Xfer[MAX_SENSORS_NUM+1]; // [0] is Convert T
+
+    // Conversion time : 94, 188, 375 or 750 ms (9 to 12-bit)
+    #define DS18x20SetConversionTime(ms)    (gDS18x20ConvTime = (ms))
+    #define DS18x20SweepBusy()              (gDS18x20State != DS18x20_IDLE)
+
+    u8 DS18x20StartSweep(u8 bus, DS18x20Callback func)
+    {
+        onewire_xfer_t *x = &gDS18x20Xfer[0];
+
+        if (gDS18x20State != DS18x20_IDLE)
+            return false;
+
+        gDS18x20Callback = func;
+
+        x->bus   = bus;
+        x->reset = 1;
+        x->tx    = DS18x20ConvertCmd;
+        x->txlen = 2;
+        x->rx    = NULL;
+        x->rxlen = 0;
+        x->done  = NULL;
+        OneWireAsyncStart(x);
+
+        gDS18x20Start = millis();
+        gDS18x20State = DS18x20_CONVERTING;
+        return true;
+    }
+
+    void DS18x20Service()
+    {
+        onewire_xfer_t *x;
+        DS18x20_Temperature t;
+        u8 i, ok;
+
+        if (gDS18x20State == DS18x20_CONVERTING)
+        {
+            x = &gDS18x20Xfer[0];
+            if (x->status == OW_BUSY)
+                return;
+            if (x->status == OW_NODEVICE)
+            {
+                gDS18x20State = DS18x20_IDLE;
+                return;
+            }
+            if (millis() - gDS18x20Start < gDS18x20ConvTime)
+                return;
+
+            // Conversions are over, queue all the reads at once
+            for (i = 1; i <= gNumROMs; i++)
+            {
+                x = &gDS18x20Xfer[i];
+                gDS18x20Cmd[i][0] = MATCHROM;
+                memcpy(&gDS18x20Cmd[i][1], DS18X20ROM[i], 8);
+                gDS18x20Cmd[i][9] = READ_SCRATCHPAD;
+                x->bus   = gDS18x20Xfer[0].bus;
+                x->reset = 1;
+                x->tx    = gDS18x20Cmd[i];
+                x->txlen = 10;
+                x->rx    = gDS18x20Pad[i];
+                x->rxlen = 9;
+                x->done  = NULL;
+                OneWireAsyncStart(x);
+            }
+            gDS18x20Next = 1;
+            gDS18x20State = DS18x20_READING;
+        }
+
+        if (gDS18x20State == DS18x20_READING)
+        {
+            // Report the completed reads in order
+            while (gDS18x20Next <= gNumROMs &&
+                   gDS18x20Xfer[gDS18x20Next].status != OW_BUSY)
+            {
+                i = gDS18x20Next++;
+                ok = (gDS18x20Xfer[i].status == OW_DONE) &&
+                     (OneWireCRC8(0, gDS18x20Pad[i], 9) == 0);
+                if (ok)
+                {
+                    if (DS18X20ROM[i][0] == FAMILY_CODE_DS18S20)
+                        DS18S20Decode(gDS18x20Pad[i], &t);
+                    else
+                        DS18B20Decode(gDS18x20Pad[i], &t);
+                }
+                if (gDS18x20Callback)
+                    gDS18x20Callback(i, ok ? &t : NULL, ok);
+            }
+            if (gDS18x20Next > gNumROMs)
+                gDS18x20State = DS18x20_IDLE;
+        }
     }
 
+#endif // ONEWIREASYNC
+
 #endif /* __DS18x20_C */
@@ -33,7 +33,7 @@
         u16 fraction;                   // fractional part
     } DS18x20_Temperature;
 
-    #define MAX_SENSORS_NUM 10
+    #define MAX_SENSORS_NUM 32
 
     /// DS18x20 ROM COMMANDS
     #define SEARCHROM           0xF0    //
@@ -70,9 +70,12 @@
     u8 DS18x20ReadMeasure(u8, u8, DS18x20_Temperature *);
     u8 DS18B20ReadMeasure(u8, u8, DS18x20_Temperature *);
     u8 DS18S20ReadMeasure(u8, u8, DS18x20_Temperature *);
+    u8 DS18B20Decode(const u8 *, DS18x20_Temperature *);
+    u8 DS18S20Decode(const u8 *, DS18x20_Temperature *);
     ///-----------------------------------------------------------------
     u8 DS18x20Read(u8, u8, DS18x20_Temperature *);
     u8 DS18x20ReadFahrenheit(u8, u8, DS18x20_Temperature *);
+    u8 DS18x20ReadAll(u8, DS18x20_Temperature *);
     u8 DS18x20MatchRom(u8, u8);
     u8 DS18x20ReadRom(u8, u8, u8 *);
     u8 DS18x20ReadFamilyCode(u8, u8);
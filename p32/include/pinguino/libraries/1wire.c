@@ -16,6 +16,8 @@
                                     used Maxim's official timings
     29 Mar 2017 Régis Blanchot      reported interrupt management to delay functions
                                     updated timings to work with SDCC and XC8
+    19 Oct 2026                     added table-driven CRC8 (OneWireCRC8)
+                                    added non-blocking Timer5 engine (ONEWIREASYNC)
     ----------------------------------------------------------------------------
     TODO :
     ----------------------------------------------------------------------------
@@ -75,6 +77,43 @@
     void OneWireWriteBit(u8, u8);
     u8 OneWireReadByte(u8);
     void OneWireWriteByte(u8, u8);
+    u8 OneWireCRC8(u8, const u8 *, u8);
+
+/*  ----------------------------------------------------------------------------
+    ---------- Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1)
+    ----------------------------------------------------------------------------
+    One table lookup per byte instead of one shift/xor per bit.
+    OneWireCRC8Update(crc, x) updates a running CRC with the byte x,
+    OneWireCRC8(crc, buf, len) runs it on a whole buffer.
+    A ROM code or a scratchpad followed by its CRC byte gives 0.
+    --------------------------------------------------------------------------*/
+
+    const u8 OneWireCRC8Table[256] = {
+          0, 94,188,226, 97, 63,221,131,194,156,126, 32,163,253, 31, 65,
+        157,195, 33,127,252,162, 64, 30, 95,  1,227,189, 62, 96,130,220,
+         35,125,159,193, 66, 28,254,160,225,191, 93,  3,128,222, 60, 98,
+        190,224,  2, 92,223,129, 99, 61,124, 34,192,158, 29, 67,161,255,
+         70, 24,250,164, 39,121,155,197,132,218, 56,102,229,187, 89,  7,
+        219,133,103, 57,186,228,  6, 88, 25, 71,165,251,120, 38,196,154,
+        101, 59,217,135,  4, 90,184,230,167,249, 27, 69,198,152,122, 36,
+        248,166, 68, 26,153,199, 37,123, 58,100,134,216, 91,  5,231,185,
+        140,210, 48,110,237,179, 81, 15, 78, 16,242,172, 47,113,147,205,
+         17, 79,173,243,112, 46,204,146,211,141,111, 49,178,236, 14, 80,
+        175,241, 19, 77,206,144,114, 44,109, 51,209,143, 12, 82,176,238,
+         50,108,142,208, 83, 13,239,177,240,174, 76, 18,145,207, 45,115,
+        202,148,118, 40,171,245, 23, 73,  8, 86,180,234,105, 55,213,139,
+         87,  9,235,181, 54,104,138,212,149,203, 41,119,244,170, 72, 22,
+        233,183, 85, 11,136,214, 52,106, 43,117,151,201, 74, 20,246,168,
+        116, 42,200,150, 21, 75,169,247,182,232, 10, 84,215,137,107, 53};
+
+    #define OneWireCRC8Update(crc, x)   (OneWireCRC8Table[(u8)((crc) ^ (x))])
+
+    u8 OneWireCRC8(u8 crc, const u8 *buf, u8 len)
+    {
+        while (len--)
+            crc = OneWireCRC8Update(crc, *buf++);
+        return crc;
+    }
 
 /*  ----------------------------------------------------------------------------
     ---------- Force the DQ line to a logic low
@@ -249,4 +288,288 @@
             OneWireWriteBit(DQpin, (bitMask & val)?1:0 );
     }
 
+/*  ----------------------------------------------------------------------------
+    ---------- Non-blocking engine (PIC32 only)
+    ----------------------------------------------------------------------------
+    #define ONEWIREASYNC to use it.
+    Transfers (reset + bytes to send + bytes to receive) are queued and
+    clocked out by Timer5 : every timeslot is cut into phases (pull low,
+    release, sample, recovery) and the next phase is scheduled with PR5,
+    so the CPU is only busy a few microseconds per phase instead of the
+    whole 70us slot.
+    Timer5 restarts when the line changes, each delay is counted from
+    the edge, not from the previous match, so the interrupt latency
+    doesn't add up. A read slot is sampled 3 + 7us after its falling
+    edge, well within the 15us the slave holds the line.
+    OneWireAsyncStep() is the whole protocol : it only sees the line level
+    and returns what to do next, so it can run against a simulated bus.
+    The done() callback of a transfer is called from the interrupt.
+    --------------------------------------------------------------------------*/
+
+#if defined(ONEWIREASYNC) && defined(__PIC32MX__)
+
+    #include <const.h>              // NULL
+    #include <interrupt.c>
+    #include <system.c>             // GetPeripheralClock()
+
+    // Transfer status
+    #define OW_IDLE         0
+    #define OW_BUSY         1
+    #define OW_DONE         2
+    #define OW_NODEVICE     3
+
+    // Step actions
+    #define OW_RELEASE      0
+    #define OW_LOW          1
+    #define OW_STOP         2       // queue is empty
+
+    // Phases of a timeslot
+    #define OW_PH_START     0
+    #define OW_PH_RSTHIGH   1       // reset pulse is over
+    #define OW_PH_PRESENCE  2       // sample the presence pulse
+    #define OW_PH_RELEASE   3       // end of a short low pulse
+    #define OW_PH_SAMPLE    4       // sample a read slot
+    #define OW_PH_RECOVER   5       // end of a write 0 slot
+
+    typedef struct _onewire_xfer_t onewire_xfer_t;
+
+    struct _onewire_xfer_t
+    {
+        u8 bus;                     // DQ pin
+        u8 reset;                   // start with a reset pulse
+        const u8 *tx;               // bytes to send
+        u8 txlen;
+        u8 *rx;                     // received bytes
+        u8 rxlen;
+        volatile u8 status;         // OW_IDLE, OW_BUSY, ...
+        void (*done)(onewire_xfer_t *);
+        onewire_xfer_t *next;
+    };
+
+    typedef struct
+    {
+        onewire_xfer_t *head;       // transfer in progress
+        onewire_xfer_t *tail;
+        u16 slot;                   // current timeslot in the transfer
+        u8 phase;
+        u8 bit;                     // level to send in the current slot
+    } onewire_engine_t;
+
+    volatile onewire_engine_t gOneWire = { NULL, NULL, 0, OW_PH_START, 0 };
+
+    // Phase durations in Timer5 ticks (see OneWireAsyncInit)
+    u16 gOneWireTicks[9];
+
+    #define OW_T_A      0           // write 1 low time
+    #define OW_T_C      1           // write 0 low time
+    #define OW_T_D      2           // write 0 recovery
+    #define OW_T_E      3           // release to sample
+    #define OW_T_F      4           // sample to end of slot
+    #define OW_T_H      5           // reset low time
+    #define OW_T_I      6           // release to presence sample
+    #define OW_T_J      7           // presence sample to end of reset
+    #define OW_T_R      8           // read low time
+
+/*  ----------------------------------------------------------------------------
+    ---------- OneWireAsyncStep
+    ----------------------------------------------------------------------------
+    * level : line level sampled when the previous delay expired
+    * low   : returned action (OW_LOW, OW_RELEASE or OW_STOP)
+    * returns the index of the next delay in gOneWireTicks[]
+    --------------------------------------------------------------------------*/
+
+    u8 OneWireAsyncStep(u8 level, u8 *low)
+    {
+        volatile onewire_engine_t *e = &gOneWire;
+        onewire_xfer_t *x = e->head;
+        u16 nbits, n;
+
+        switch (e->phase)
+        {
+            case OW_PH_RSTHIGH:
+                e->phase = OW_PH_PRESENCE;
+                *low = OW_RELEASE;
+                return OW_T_I;
+
+            case OW_PH_PRESENCE:
+                if (level)              // nobody answered
+                {
+                    x->status = OW_NODEVICE;
+                    e->slot = 0xFFFF;   // abort
+                }
+                else
+                    e->slot++;
+                e->phase = OW_PH_START;
+                *low = OW_RELEASE;
+                return OW_T_J;
+
+            case OW_PH_RELEASE:
+                e->phase = OW_PH_SAMPLE;
+                *low = OW_RELEASE;
+                return OW_T_E;
+
+            case OW_PH_SAMPLE:
+                // store the bit if this slot is a read slot
+                n = e->slot - x->reset - x->txlen * 8;
+                if (n < x->rxlen * 8)
+                {
+                    if (level)
+                        x->rx[n >> 3] |=  (1 << (n & 7));
+                    else
+                        x->rx[n >> 3] &= ~(1 << (n & 7));
+                }
+                e->slot++;
+                e->phase = OW_PH_START;
+                *low = OW_RELEASE;
+                return OW_T_F;
+
+            case OW_PH_RECOVER:
+                e->slot++;
+                e->phase = OW_PH_START;
+                *low = OW_RELEASE;
+                return OW_T_D;
+        }
+
+        // OW_PH_START : begin the next timeslot
+        nbits = x->reset + (x->txlen + x->rxlen) * 8;
+        if (e->slot >= nbits)
+        {
+            // transfer complete, call back and move to the next one
+            if (x->status == OW_BUSY)
+                x->status = OW_DONE;
+            e->head = x->next;
+            e->slot = 0;
+            if (x->done)
+                x->done(x);
+            x = e->head;
+            if (x == NULL)
+            {
+                e->tail = NULL;
+                *low = OW_STOP;
+                return OW_T_D;
+            }
+            nbits = x->reset + (x->txlen + x->rxlen) * 8;
+        }
+
+        *low = OW_LOW;
+
+        if (x->reset && e->slot == 0)
+        {
+            e->phase = OW_PH_RSTHIGH;
+            return OW_T_H;
+        }
+
+        // write slots first, then read slots (a read slot is a write 1
+        // with a shorter low time)
+        n = e->slot - x->reset;
+        e->phase = OW_PH_RELEASE;
+        if (n >= x->txlen * 8)
+            return OW_T_R;
+
+        if (!(x->tx[n >> 3] & (1 << (n & 7))))
+        {
+            e->phase = OW_PH_RECOVER;
+            return OW_T_C;
+        }
+        return OW_T_A;
+    }
+
+/*  ----------------------------------------------------------------------------
+    ---------- Timer5 : convert the standard timings to ticks (1:8 prescaler)
+    --------------------------------------------------------------------------*/
+
+    void OneWireAsyncInit()
+    {
+        u32 mhz = GetPeripheralClock() / 8 / 1000000;
+
+        gOneWireTicks[OW_T_A] = 6 * mhz;
+        gOneWireTicks[OW_T_C] = 60 * mhz;
+        gOneWireTicks[OW_T_D] = 10 * mhz;
+        gOneWireTicks[OW_T_E] = 7 * mhz;
+        gOneWireTicks[OW_T_F] = 55 * mhz;
+        gOneWireTicks[OW_T_H] = 480 * mhz;
+        gOneWireTicks[OW_T_I] = 70 * mhz;
+        gOneWireTicks[OW_T_J] = 410 * mhz;
+        gOneWireTicks[OW_T_R] = 3 * mhz;
+
+        IntConfigureSystem(INT_SYSTEM_CONFIG_MULT_VECTOR);
+        T5CON = 0x0030;                 // stopped, 1:8 prescaler
+        IntSetVectorPriority(INT_TIMER5_VECTOR, 7, 3);
+        IntClearFlag(INT_TIMER5);
+        IntEnable(INT_TIMER5);
+    }
+
+/*  ----------------------------------------------------------------------------
+    ---------- OneWireAsyncStart
+    ----------------------------------------------------------------------------
+    * Queue a transfer, the bus starts at once if it was idle.
+    * The transfer and its buffers must stay valid until x->status is
+      no more OW_BUSY.
+    --------------------------------------------------------------------------*/
+
+    void OneWireAsyncStart(onewire_xfer_t *x)
+    {
+        u32 status;
+
+        if (gOneWireTicks[OW_T_H] == 0)
+            OneWireAsyncInit();
+
+        x->status = OW_BUSY;
+        x->next = NULL;
+        digitalwrite(x->bus, LOW);      // output latch stays low
+
+        status = DisableInterrupt();
+        if (gOneWire.tail)
+        {
+            gOneWire.tail->next = x;
+            gOneWire.tail = x;
+        }
+        else
+        {
+            gOneWire.head = x;
+            gOneWire.tail = x;
+            gOneWire.slot = 0;
+            gOneWire.phase = OW_PH_START;
+            TMR5 = 0;
+            PR5 = 1;                    // first step as soon as possible
+            T5CONSET = 0x8000;
+        }
+        if (status & 1)
+            EnableInterrupt();
+    }
+
+    #define OneWireAsyncBusy()      (gOneWire.head != NULL)
+
+/*  ----------------------------------------------------------------------------
+    ---------- Timer5 interrupt
+    --------------------------------------------------------------------------*/
+
+    void Timer5Interrupt()
+    {
+        u8 pin, level, low, t;
+
+        if (IntGetFlag(INT_TIMER5))
+        {
+            IntClearFlag(INT_TIMER5);
+            pin = gOneWire.head->bus;
+            level = digitalread(pin);
+            t = OneWireAsyncStep(level, &low);
+
+            if (low == OW_STOP)
+                T5CONCLR = 0x8000;
+            else
+            {
+                PR5 = gOneWireTicks[t];
+                pin = gOneWire.head->bus;
+                if (low == OW_LOW)
+                    output(pin);        // latch is low
+                else
+                    input(pin);         // pull-up
+                TMR5 = 0;               // next delay starts at the edge
+            }
+        }
+    }
+
+#endif // ONEWIREASYNC
+
 #endif
@@ -66,6 +66,7 @@
 #define MPU9250_I2C_MST_STATUS      0x36
 #define MPU9250_INT_PIN_CFG         0x37
 #define MPU9250_INT_ENABLE          0x38
+#define MPU9250_INT_STATUS          0x3A
 #define MPU9250_ACCEL_XOUT_H        0x3B
 #define MPU9250_ACCEL_XOUT_L        0x3C
 #define MPU9250_ACCEL_YOUT_H        0x3D
@@ -189,6 +190,14 @@
 #define BIT_INT_ANYRD_2CLEAR       0x10
 #define BIT_RAW_RDY_EN             0x01
 #define BIT_I2C_IF_DIS             0x10
+#define BIT_FIFO_OFLOW_INT         0x10
+#define BIT_FIFO_EN                0x40
+#define BIT_I2C_MST_EN             0x20
+#define BIT_FIFO_RST               0x04
+#define BIT_FIFO_TEMP              0x80
+#define BIT_FIFO_GYRO              0x70
+#define BIT_FIFO_ACCEL             0x08
+#define BIT_FIFO_SLV0              0x01
  
 #define READ_FLAG                  0x80
  
@@ -210,6 +219,60 @@
  
 #define Magnetometer_Sensitivity_Scale_Factor ((float)0.15f)    
 
+/* ---- Streaming mode ------------------------------------------------------ */
+
+#ifdef MPU9250STREAM
+
+// bytes per FIFO frame : accel (6) + gyro (6) + AK8963 HXL..ST2 (7)
+#define MPU9250_FRAME              19
+
+#ifndef MPU9250RINGSIZE                     // samples, must be a power of 2
+    #if defined(__PIC32MX__)
+    #define MPU9250RINGSIZE        32
+    #else
+    #define MPU9250RINGSIZE        4
+    #endif
+#endif
+
+#ifndef MPU9250BATCH                        // frames per burst read (<= 13)
+    #if defined(__PIC32MX__)
+    #define MPU9250BATCH           8
+    #else
+    #define MPU9250BATCH           2
+    #endif
+#endif
+
+// Q16.16 fixed-point sample
+typedef struct
+{
+    s32 acc[3];                             // g
+    s32 gyro[3];                            // degrees/s
+    s32 mag[3];                             // uT
+} MPU9250_sample_t;
+
+typedef struct
+{
+    MPU9250_sample_t ring[MPU9250RINGSIZE];
+    volatile u8 head;                       // written by MPU9250_service
+    volatile u8 tail;                       // written by MPU9250_readSample
+    volatile u8 ready;                      // INT pin edges since last read
+    u16 overruns;                           // lost samples
+    s16 accBias[3];                         // LSB
+    s32 accScale;                           // Q16.16 per LSB
+    s32 gyroScale;
+    s32 magScale[3];
+    s32 mag[3];                             // last valid magnetometer sample
+} MPU9250_stream_t;
+
+u8   MPU9250_parse(MPU9250_stream_t *s, const u8 *buf, u16 len);
+u8   MPU9250_service(int module);
+void MPU9250_stream(int module, u8 divider, u8 irq);
+u8   MPU9250_available(int module);
+u8   MPU9250_readSample(MPU9250_sample_t *dest);
+#define MPU9250_overruns()  (gMPU9250Stream.overruns)
+
+#endif // MPU9250STREAM
+
 // PROTOTYPES 
 
 u8   MPU9250_write8(int module, u8 reg, u8 val);
@@ -11,6 +11,8 @@
     04 Feb. 2016 - Régis Blanchot - added Pinguino SPI library support
     22 Oct. 2016 - Régis Blanchot - fixed graphics functions
     23 Mar. 2017 - Régis Blanchot - fixed PIC18F RAM limitations
+    19 Oct. 2026 - lines, rectangles and scroll done a byte at a time
+                   by raster.c, added PCD8544_blit
     --------------------------------------------------------------------
     TODO:
     * Backlight management
@@ -50,6 +52,7 @@
 #include <string.h>             // memset, memcpy
 //#endif
 #include <PCD8544.h>
+#include <raster.c>             // 1bpp buffer drawing
 #include <spi.c>                // SPI harware and software functions
 #include <spi.h>
 
@@ -85,6 +88,7 @@
 
 // Graphics
 #ifdef PCD8544GRAPHICS
+#define GRAPHICSHVLINES
 #include <graphics.c>           // graphic routines
 #endif
 
@@ -105,6 +109,9 @@ u8 row5[PCD8544_DISPLAY_WIDTH];
 // Buffers pointers
 u8* PCD8544_buffer[PCD8544_DISPLAY_ROWS] = { row0, row1, row2, row3, row4, row5 };
 
+// Buffers as seen by the drawing functions
+raster_t PCD8544_raster;
+
 ///	--------------------------------------------------------------------
 /// Core functions
 ///	--------------------------------------------------------------------
@@ -224,6 +231,8 @@ void PCD8544_init(int module, ...)
     PCD8544[PCD8544_SPI].pixel.y       = 0;
     PCD8544[PCD8544_SPI].pixel.x       = 0;
 
+    raster_init(&PCD8544_raster, PCD8544_buffer, PCD8544_DISPLAY_WIDTH, PCD8544_DISPLAY_HEIGHT, 0);
+
     // Push out PCD8544_buffer to the Display
     // Will show the Pinguino logo
     //PCD8544_refresh(module);
@@ -261,19 +270,7 @@ void PCD8544_refresh(u8 module)
 
 void PCD8544_clearScreen(u8 module)
 {
-    u8 row, x;
-    
-    for (row = 0; row < PCD8544_DISPLAY_ROWS; row++)
-    {
-        //#ifdef __SDCC
-        //memset(&PCD8544_buffer[row], 0, PCD8544_DISPLAY_WIDTH);
-        for (x = 0; x < PCD8544_DISPLAY_WIDTH; x++)
-            PCD8544_buffer[row][x] = 0;
-            //*(PCD8544_buffer[row])++ = 0;
-        //#else  
-        //memset(PCD8544_buffer[row], 0, PCD8544_DISPLAY_WIDTH);
-        //#endif
-    }
+    raster_clear(&PCD8544_raster);
     
     // home position
     PCD8544[module].pixel.x = 0;
@@ -320,36 +317,10 @@ void PCD8544_setContrast(u8 module, u8 val)
 // The display is 16 rows tall.
 void PCD8544_scrollUp(u8 module)
 {
-    u8 row, x;
     u8 bytes = ((PCD8544[module].font.height + 7) / 8);
-    u8 lastline = PCD8544_DISPLAY_ROWS - bytes;
     
-    // Copy line i+1 in line i
-    //void *memcpy(void *dest, const void *src, size_t n)
-    for (row=0; row<lastline; row++)
-    {
-        #ifdef __SDCC
-        //memcpy(&PCD8544_buffer[row], &PCD8544_buffer[row+1], PCD8544_DISPLAY_WIDTH);
-        for (x = 0; x < PCD8544_DISPLAY_WIDTH; x++)
-            PCD8544_buffer[row][x] = PCD8544_buffer[row+1][x];
-            //*(PCD8544_buffer[row])++ = *(PCD8544_buffer[row+1])++;
-        #else
-        memcpy(PCD8544_buffer[row], PCD8544_buffer[row+1], PCD8544_DISPLAY_WIDTH);
-        #endif
-    }
-    // Clear the last lines
-    //void *memset(void *str, int c, size_t n)
-    for (row=lastline; row<PCD8544_DISPLAY_ROWS; row++)
-    {
-        #ifdef __SDCC
-        //memset(&PCD8544_buffer[row], 0, PCD8544_DISPLAY_WIDTH);
-        for (x = 0; x < PCD8544_DISPLAY_WIDTH; x++)
-            PCD8544_buffer[row][x] = 0;
-            //*(PCD8544_buffer[row])++ = 0;
-        #else
-        memset(PCD8544_buffer[row], 0, PCD8544_DISPLAY_WIDTH);
-        #endif
-    }
+    // Copy line i+bytes in line i and clear the last lines
+    raster_scroll(&PCD8544_raster, 8 * bytes);
     PCD8544[module].pixel.y = PCD8544[module].pixel.y - (8 * bytes);
 }
 
@@ -572,32 +543,17 @@ void PCD8544_printf(u8 module, const u8 *fmt, ...)
 
 void PCD8544_drawPixel(u8 module, u8 x, u8 y)
 {
-    //if (x >= PCD8544[module].screen.width)  return;
-    //if (y >= PCD8544[module].screen.height) return;
-
-    //PCD8544_buffer[x + (y >> 3) * PCD8544[module].screen.width] |=  1 << (y % 8);
-    //#ifdef __SDCC
-    //*(PCD8544_buffer[y >> 3] + x) |= 1 << (y % 8);
-    //#else
-    PCD8544_buffer[y >> 3][x] |= 1 << (y % 8);
-    //#endif
-} 
+    // nothing drawn out of the screen
+    raster_setPixel(&PCD8544_raster, x, y, RASTER_SET);
+}
 
 //Clear Pixel on the buffer
 //Also called from printChar
 
 void PCD8544_clearPixel(u8 module, u8 x, u8 y)
 {
-    //if (x >= PCD8544[module].screen.width)  return;
-    //if (y >= PCD8544[module].screen.height) return;
-
-    //PCD8544_buffer[x + (y >> 3) * PCD8544[module].screen.width] &=  ~(1 << (y % 8));
-    //#ifdef __SDCC
-    //*(PCD8544_buffer[y >> 3] + x) &= ~(1 << (y % 8));
-    //#else
-    PCD8544_buffer[y >> 3][x] &= ~(1 << (y % 8));
-    //#endif
-} 
+    raster_setPixel(&PCD8544_raster, x, y, RASTER_CLEAR);
+}
 
 
 #ifdef PCD8544GRAPHICS
@@ -606,10 +562,32 @@ void PCD8544_clearPixel(u8 module, u8 x, u8 y)
 // *********************************************************************
 void drawPixel(u16 x, u16 y)
 {
-    PCD8544_drawPixel(PCD8544_SPI, (u8)x, (u8)y);
+    raster_setPixel(&PCD8544_raster, (s16)x, (s16)y, RASTER_SET);
 }
 // *********************************************************************
 
+// defined as extern in graphics.c (GRAPHICSHVLINES)
+// graphics.c lines leave out their end point (see drawLine), the
+// generic drawHLine and drawVLine draw w - 1 and h - 1 pixels
+void drawHLine(u16 x, u16 y, u16 w)
+{
+    raster_drawHLine(&PCD8544_raster, (s16)x, (s16)y, (s16)w - 1, RASTER_SET);
+}
+
+void drawVLine(u16 x, u16 y, u16 h)
+{
+    raster_drawVLine(&PCD8544_raster, (s16)x, (s16)y, (s16)h - 1, RASTER_SET);
+}
+
+// columns x1 to x2, rows y1 to y2 - 2, like the generic fillRect
+// made of drawVLine(x, y1, y2 - y1)
+void fillRect(u16 x1, u16 y1, u16 x2, u16 y2)
+{
+    if (x1 > x2) swap(x1, x2);
+    if (y1 > y2) swap(y1, y2);
+    raster_fillRect(&PCD8544_raster, (s16)x1, (s16)y1, x2 - x1 + 1, (s16)(y2 - y1) - 1, RASTER_SET);
+}
+
 /*
 u8 PCD8544_getPixel(u8 module, u8 x, u8 y)
 {
@@ -662,6 +640,13 @@ void PCD8544_fillRoundRect(u8 module, u8 x1, u8 y1, u8 x2, u8 y2)
     fillRoundRect(x1, y1, x2, y2);
 }
 
+// Bitmap in the fonts format (one byte per column, bit 0 on top)
+// rop : RASTER_COPY, RASTER_OR, RASTER_AND or RASTER_XOR
+void PCD8544_blit(u8 module, const u8 *bitmap, u16 x, u16 y, u8 w, u8 h, u8 rop)
+{
+    raster_blit(&PCD8544_raster, (s16)x, (s16)y, bitmap, w, h, rop);
+}
+
 #ifdef  _PCD8544_USE_BITMAP
 void PCD8544_drawBitmap(u8 module1, u8 module2, const u8* filename, u16 x, u16 y)
 {
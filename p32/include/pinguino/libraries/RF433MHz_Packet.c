@@ -0,0 +1,387 @@
+/*  --------------------------------------------------------------------
+    FILE:           RF433MHz_Packet.c
+    PROJECT:        pinguino
+    PURPOSE:        Packet framing and edge decoder for the 433MHz modules
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    A packet is sent as Manchester code (bit 1 = LO,HI, bit 0 = HI,LO),
+    each byte MSB first :
+
+    [preamble][0][sync][len][payload ...][crc high][crc low][1][1]
+
+    * preamble : RF433MHZ_PREAMBLE 1's, all transitions are one half bit
+      apart, so the receiver AGC can settle and the bit time be measured.
+    * 0 : start bit, gives the first transition a full bit apart.
+    * sync : RF433MHZ_SYNCBYTE, or RF433MHZ_SYNCFEC when each of the
+      following bytes is sent as 2 extended Hamming(8,4) code words
+      (a wrong bit per code word is corrected, 2 are detected).
+    * len : number of payload bytes (RF433MHZ_MAXPAYLOAD at most).
+    * crc : CRC-16/CCITT (0x1021, init 0xFFFF) of len and payload.
+
+    The receiver only needs the time stamp of each edge of the data
+    line, given by an external interrupt and a free running timer :
+    * two edges less than half a half bit apart are a spike and are
+      dropped. When the first one comes on time (a half bit or a bit
+      after the last edge) it's kept and the spike is the next two.
+    * in the preamble the half bit time is measured on the short
+      intervals, the first long one after RF433MHZ_LOCK short ones is
+      the start bit.
+    * then a short interval gives a bit every two, a long one gives
+      a bit of the opposite value, anything else aborts the packet.
+      The half bit time keeps following the transmitter clock.
+    * bytes are stored as received, the FEC and CRC are only checked
+      in the main loop by RF433MHz_packetRead().
+
+    Doesn't touch any register and can be tested on a host.
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    ------------------------------------------------------------------*/
+
+#ifndef __RF433MHZ_PACKET_C
+#define __RF433MHZ_PACKET_C
+
+#include <typedef.h>
+#include <RF433MHz.h>
+
+const u8 RF433MHz_hammingEncode[16] = {
+    0x00, 0x87, 0x99, 0x1E, 0xAA, 0x2D, 0x33, 0xB4,
+    0x4B, 0xCC, 0xD2, 0x55, 0xE1, 0x66, 0x78, 0xFF };
+
+// nibble of the nearest code word, 0xFF if 2 bits (or more) are wrong
+const u8 RF433MHz_hammingDecode[256] = {
+    0x00, 0x00, 0x00, 0xFF, 0x00, 0xFF, 0xFF, 0x01, 0x00, 0xFF, 0xFF, 0x08, 0xFF, 0x05, 0x03, 0xFF,
+    0x00, 0xFF, 0xFF, 0x06, 0xFF, 0x0B, 0x03, 0xFF, 0xFF, 0x02, 0x03, 0xFF, 0x03, 0xFF, 0x03, 0x03,
+    0x00, 0xFF, 0xFF, 0x06, 0xFF, 0x05, 0x0D, 0xFF, 0xFF, 0x05, 0x04, 0xFF, 0x05, 0x05, 0xFF, 0x05,
+    0xFF, 0x06, 0x06, 0x06, 0x07, 0xFF, 0xFF, 0x06, 0x0E, 0xFF, 0xFF, 0x06, 0xFF, 0x05, 0x03, 0xFF,
+    0x00, 0xFF, 0xFF, 0x08, 0xFF, 0x0B, 0x0D, 0xFF, 0xFF, 0x08, 0x08, 0x08, 0x09, 0xFF, 0xFF, 0x08,
+    0xFF, 0x0B, 0x0A, 0xFF, 0x0B, 0x0B, 0xFF, 0x0B, 0x0E, 0xFF, 0xFF, 0x08, 0xFF, 0x0B, 0x03, 0xFF,
+    0xFF, 0x0C, 0x0D, 0xFF, 0x0D, 0xFF, 0x0D, 0x0D, 0x0E, 0xFF, 0xFF, 0x08, 0xFF, 0x05, 0x0D, 0xFF,
+    0x0E, 0xFF, 0xFF, 0x06, 0xFF, 0x0B, 0x0D, 0xFF, 0x0E, 0x0E, 0x0E, 0xFF, 0x0E, 0xFF, 0xFF, 0x0F,
+    0x00, 0xFF, 0xFF, 0x01, 0xFF, 0x01, 0x01, 0x01, 0xFF, 0x02, 0x04, 0xFF, 0x09, 0xFF, 0xFF, 0x01,
+    0xFF, 0x02, 0x0A, 0xFF, 0x07, 0xFF, 0xFF, 0x01, 0x02, 0x02, 0xFF, 0x02, 0xFF, 0x02, 0x03, 0xFF,
+    0xFF, 0x0C, 0x04, 0xFF, 0x07, 0xFF, 0xFF, 0x01, 0x04, 0xFF, 0x04, 0x04, 0xFF, 0x05, 0x04, 0xFF,
+    0x07, 0xFF, 0xFF, 0x06, 0x07, 0x07, 0x07, 0xFF, 0xFF, 0x02, 0x04, 0xFF, 0x07, 0xFF, 0xFF, 0x0F,
+    0xFF, 0x0C, 0x0A, 0xFF, 0x09, 0xFF, 0xFF, 0x01, 0x09, 0xFF, 0xFF, 0x08, 0x09, 0x09, 0x09, 0xFF,
+    0x0A, 0xFF, 0x0A, 0x0A, 0xFF, 0x0B, 0x0A, 0xFF, 0xFF, 0x02, 0x0A, 0xFF, 0x09, 0xFF, 0xFF, 0x0F,
+    0x0C, 0x0C, 0xFF, 0x0C, 0xFF, 0x0C, 0x0D, 0xFF, 0xFF, 0x0C, 0x04, 0xFF, 0x09, 0xFF, 0xFF, 0x0F,
+    0xFF, 0x0C, 0x0A, 0xFF, 0x07, 0xFF, 0xFF, 0x0F, 0x0E, 0xFF, 0xFF, 0x0F, 0xFF, 0x0F, 0x0F, 0x0F };
+
+// CRC-16/CCITT of a nibble
+const u16 RF433MHz_crcTable[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF };
+
+/*  --------------------------------------------------------------------
+    RF433MHz_crc16
+    --------------------------------------------------------------------
+    @descr:     add a byte to a CRC-16/CCITT, 2 table lookups
+    ------------------------------------------------------------------*/
+
+u16 RF433MHz_crc16(u16 crc, u8 b)
+{
+    crc = (crc << 4) ^ RF433MHz_crcTable[(crc >> 12) ^ (b >> 4)];
+    crc = (crc << 4) ^ RF433MHz_crcTable[(crc >> 12) ^ (b & 0x0F)];
+    return crc;
+}
+
+/*  --------------------------------------------------------------------
+    RF433MHz_packetBuild
+    --------------------------------------------------------------------
+    @descr:     build the bytes sent after the sync byte
+    @param:     frame   at least RF433MHZ_MAXFRAME bytes
+                data    payload
+                len     payload length (truncated to RF433MHZ_MAXPAYLOAD)
+                fec     send each byte as 2 Hamming code words
+    @return:    number of bytes in frame
+    ------------------------------------------------------------------*/
+
+u8 RF433MHz_packetBuild(u8 *frame, const u8 *data, u8 len, u8 fec)
+{
+    u8 i, n, b;
+    u16 crc = 0xFFFF;
+
+    if (len > RF433MHZ_MAXPAYLOAD)
+        len = RF433MHZ_MAXPAYLOAD;
+
+    // plain bytes first, then expanded in place from the end
+    frame[0] = len;
+    for (i = 0; i < len; i++)
+        frame[i + 1] = data[i];
+    for (i = 0; i <= len; i++)
+        crc = RF433MHz_crc16(crc, frame[i]);
+    frame[len + 1] = crc >> 8;
+    frame[len + 2] = crc & 0xFF;
+    n = len + 3;
+
+    if (fec)
+    {
+        i = n;
+        while (i--)
+        {
+            b = frame[i];
+            frame[2 * i]     = RF433MHz_hammingEncode[b >> 4];
+            frame[2 * i + 1] = RF433MHz_hammingEncode[b & 0x0F];
+        }
+        n = 2 * n;
+    }
+
+    return n;
+}
+
+/*  --------------------------------------------------------------------
+    Receiver
+    ------------------------------------------------------------------*/
+
+void RF433MHz_packetHunt(RF433MHz_packet_t *p)
+{
+    p->state  = RF433MHZ_HUNT;
+    p->shorts = 0;
+    p->t      = p->nominal;
+}
+
+/*  --------------------------------------------------------------------
+    RF433MHz_packetInit
+    --------------------------------------------------------------------
+    @param:     halfbit     half bit time in time stamp ticks
+    ------------------------------------------------------------------*/
+
+void RF433MHz_packetInit(RF433MHz_packet_t *p, u16 halfbit)
+{
+    p->nominal = halfbit;
+    p->pending = 0;
+    RF433MHz_packetHunt(p);
+}
+
+void RF433MHz_packetByte(RF433MHz_packet_t *p, u8 b)
+{
+    u8 len;
+
+    if (p->state == RF433MHZ_SYNC)
+    {
+        if (b == RF433MHZ_SYNCBYTE)
+            p->fec = 0;
+        else if (b == RF433MHZ_SYNCFEC)
+            p->fec = 1;
+        else
+        {
+            RF433MHz_packetHunt(p);
+            return;
+        }
+        p->state = RF433MHZ_DATA;
+        p->count = 0;
+        p->total = RF433MHZ_MAXFRAME;
+        return;
+    }
+
+    p->frame[p->count++] = b;
+
+    // length known, the packet size too
+    if (p->count == (p->fec ? 2 : 1))
+    {
+        if (p->fec)
+            len = (RF433MHz_hammingDecode[p->frame[0]] << 4) |
+                   RF433MHz_hammingDecode[p->frame[1]];
+        else
+            len = b;
+
+        if (len > RF433MHZ_MAXPAYLOAD)
+        {
+            RF433MHz_packetHunt(p);
+            return;
+        }
+        p->total = p->fec ? 2 * (len + 3) : len + 3;
+    }
+
+    if (p->count == p->total)
+        p->state = RF433MHZ_DONE;
+}
+
+void RF433MHz_packetBit(RF433MHz_packet_t *p, u8 bit)
+{
+    p->shift = (p->shift << 1) | bit;
+    if (++p->nbits == 8)
+    {
+        p->nbits = 0;
+        RF433MHz_packetByte(p, p->shift);
+    }
+}
+
+/*  --------------------------------------------------------------------
+    RF433MHz_packetInterval
+    --------------------------------------------------------------------
+    @descr:     time between two accepted edges
+    ------------------------------------------------------------------*/
+
+void RF433MHz_packetInterval(RF433MHz_packet_t *p, u16 d)
+{
+    u16 t = p->t;
+    u8 isShort, isLong;
+
+    isShort = (d >= (t >> 1)) && (d < t + (t >> 1));
+    isLong  = !isShort && (d >= t + (t >> 1)) && (d < 2 * t + (t >> 1));
+
+    if (p->state == RF433MHZ_HUNT)
+    {
+        if (isShort)
+        {
+            // follow the transmitter bit time
+            p->t = t + (s16)(d - t) / 4;
+            if (p->shorts < 255)
+                p->shorts++;
+        }
+        else if (isLong && p->shorts >= RF433MHZ_LOCK)
+        {
+            // start bit, we are now in the middle of a 0
+            p->state = RF433MHZ_SYNC;
+            p->mid   = 1;
+            p->bit   = 0;
+            p->shift = 0;
+            p->nbits = 0;
+        }
+        else
+        {
+            RF433MHz_packetHunt(p);
+        }
+        return;
+    }
+
+    if (isShort)
+    {
+        p->t = t + (s16)(d - t) / 8;
+        if (p->mid)
+            p->mid = 0;
+        else
+        {
+            // boundary passed, same bit again
+            p->mid = 1;
+            RF433MHz_packetBit(p, p->bit);
+        }
+    }
+    else if (isLong && p->mid)
+    {
+        p->t = t + (s16)((d >> 1) - t) / 8;
+        p->bit = !p->bit;
+        RF433MHz_packetBit(p, p->bit);
+    }
+    else
+    {
+        RF433MHz_packetHunt(p);
+    }
+}
+
+/*  --------------------------------------------------------------------
+    RF433MHz_packetEdge
+    --------------------------------------------------------------------
+    @descr:     called on each edge of the data line
+    @param:     now     time stamp, a free running 16-bit timer
+    ------------------------------------------------------------------*/
+
+void RF433MHz_packetEdge(RF433MHz_packet_t *p, u16 now)
+{
+    u16 d, half = p->t >> 1;
+
+    if (p->state >= RF433MHZ_DONE)
+        return;
+
+    if (p->pending == 2)
+    {
+        // end of the spike which followed the pending edge
+        if ((u16)(now - p->spike) < half)
+        {
+            p->pending = 1;
+            return;
+        }
+        // two real edges too close, the interval will be wrong
+        p->pending = 0;
+    }
+
+    else if (p->pending)
+    {
+        if ((u16)(now - p->edge) < half)
+        {
+            // the pending edge is where an edge is expected,
+            // so the spike is starting now, else it was the spike
+            d = p->edge - p->last;
+            if (d > 2 * p->t - half)
+                d -= p->t;
+            if (d > p->t - (half >> 1) && d < p->t + (half >> 1))
+            {
+                p->spike = now;
+                p->pending = 2;
+            }
+            else
+            {
+                p->pending = 0;
+            }
+            return;
+        }
+        RF433MHz_packetInterval(p, p->edge - p->last);
+        p->last = p->edge;
+    }
+
+    p->edge = now;
+    p->pending = 1;
+}
+
+/*  --------------------------------------------------------------------
+    RF433MHz_packetRead
+    --------------------------------------------------------------------
+    @descr:     check a complete packet and copy its payload
+    @param:     data    where to copy the payload
+                max     size of data
+    @return:    payload length, RF433MHZ_ERROR if the packet is not
+                complete or is wrong
+    ------------------------------------------------------------------*/
+
+u8 RF433MHz_packetRead(RF433MHz_packet_t *p, u8 *data, u8 max)
+{
+    u8 i, n, hi, lo;
+    u16 crc = 0xFFFF;
+
+    if (p->state != RF433MHZ_DONE)
+        return RF433MHZ_ERROR;
+
+    n = p->total;
+    if (p->fec)
+    {
+        n = n / 2;
+        for (i = 0; i < n; i++)
+        {
+            hi = RF433MHz_hammingDecode[p->frame[2 * i]];
+            lo = RF433MHz_hammingDecode[p->frame[2 * i + 1]];
+            if ((hi | lo) == 0xFF)
+                return RF433MHZ_ERROR;
+            p->frame[i] = (hi << 4) | lo;
+        }
+        p->fec = 0;
+        p->total = n;
+    }
+
+    for (i = 0; i < n - 2; i++)
+        crc = RF433MHz_crc16(crc, p->frame[i]);
+    if (p->frame[n - 2] != (crc >> 8) || p->frame[n - 1] != (crc & 0xFF))
+        return RF433MHZ_ERROR;
+
+    n = p->frame[0];
+    for (i = 0; i < n && i < max; i++)
+        data[i] = p->frame[i + 1];
+
+    return n;
+}
+
+#endif // __RF433MHZ_PACKET_C
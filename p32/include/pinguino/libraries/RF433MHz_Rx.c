@@ -6,15 +6,28 @@
     --------------------------------------------------------------------
     CHANGELOG:
     2018-01-31 - Régis Blanchot -   first release
+    19 Oct. 2026 - the data line is wired to an external interrupt and
+                   each edge is time stamped by a free running timer,
+                   packets are decoded by RF433MHz_Packet.c
+                 - packets have a length and a CRC, optional FEC
+                 - RF433MHz_getLength()
+                 - Timer3 on PIC18F, millis() keeps Timer0
+                 - the external interrupt goes through intx.c
     --------------------------------------------------------------------
-    TODO:
-    * use repairing codes perhabs ?
-    * Cf. http://en.wikipedia.org/wiki/Hamming_code
-      format of the message including checksum and ID
-        
-    [0][1][2][3][4][5][6][7][8][9][a][b][c][d][e][f]
-    [        ID        ][ checksum ][                 data                 ]            
-    checksum = ID xor data[7:4] xor data[3:0] xor 0b0011
+    The receiver data line must be wired to an external interrupt pin :
+    * PIC32   : INT0 to INT4
+    * PIC18F  : INT0 to INT2 (pins 0 to 2 on most boards)
+    * PIC16F  : INT only
+    The line is taken with IntxAttach(), nothing is received if another
+    library has it.
+    Time stamps are given by a timer running free, never reloaded :
+    * PIC32   : the core timer / 32
+    * PIC18F  : Timer3, Fosc/4 with a 1:8 prescaler. Timer0 is left to
+      millis(), Timer1 to the servos and pulseIn(), Timer2 to PWM and
+      the software serial port, OnTimer3, IRremote and the stepper
+      library can't be used with the receiver.
+    * PIC16F  : Timer1 at Fosc/4, shared with millis() which doesn't
+      reload it either, bauds must be 230 or more at 48 MHz.
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -34,321 +47,213 @@
 #ifndef __RF433MHZ_RX_C
 #define __RF433MHZ_RX_C
 
-#define __RF433MHZRX__      // used in main.c to trig the RF433MHZ interrupt 
+#define __RF433MHZRX__      // used in main.c to enable the interrupts
+#ifndef RF433MHZRECEIVER
 #define RF433MHZRECEIVER
-
+#endif
 
 #if defined(RF433MHZRECEIVER) && defined(RF433MHZTRANSMITTER)
 #error "I CAN'T BE RECEIVER AND TRANSMITTER AT THE SAME TIME"
 #endif
 
+#if defined(__16F1459) || defined(__16F1708)
+#if defined(TMR1INT) || defined(__IRREMOTE__) || defined(__STEPPER__) || \
+    defined(__SERVO__) || defined(__PULSE__)
+#error "RF433MHz receiver : Timer1 is already used"
+#endif
+#elif !defined(__PIC32MX__)
+#if defined(TMR3INT) || defined(TMR3CCP) || defined(__IRREMOTE__) || \
+    defined(__STEPPER__)
+#error "RF433MHz receiver : Timer3 is already used"
+#endif
+#endif
+
 #ifndef __PIC32MX__
 #include <compiler.h>
-#include <digitalw.c>
-#include <digitalr.c>
-#include <digitalp.c>
-#include <delayus.c>
-#include <delayms.c>
+#include <interrupt.h>
 #else
-#include <digitalw.c>
-#include <delay.c>
+#include <system.c>             // GetSystemClock
+#include <mips.h>               // ReadCoreTimer
 #endif
 
+#include <intx.c>               // IntxAttach
+
 #include <typedef.h>
 #include <macro.h>
-#include <stdarg.h>
 #include <RF433MHz.h>
-#include <manchester.c>
+#include <RF433MHz_Packet.c>
 
 RF433MHZ_t RF433MHZ;
 
-void RF433MHz_init(u8 pin, u8 bauds)
+/*  --------------------------------------------------------------------
+    External interrupt
+    ------------------------------------------------------------------*/
+
+/*
+ * intx.c callback, each edge is time stamped
+ */
+
+void RF433MHz_interrupt(u8 line, u8 level)
 {
-    // RX a digital pin as input
-    RF433MHZ.RxPin = pin;
-    pinmode(pin, INPUT); 
-
-    // Baud rate is defined as the number of symbols sent or received per second
-    RF433MHZ.bauds = bauds;
-    
-    // The configuration register TMR1 is setup to generate an interrupt
-    // period equal to twice the desired Manchester Encoded bit rate.
-    // half_bit_interval_us = 500000 / bauds;
-    // pb_interval_us = 1000000 / (_cpu_clock_ / 4);
-    // nb_cycles = half_bit_interval_us / pb_interval_us; 
-    // nb_cycles = (500000 / bauds) / (1000000 / (_cpu_clock_ / 4)); 
-    // nb_cycles = (500000 / bauds) / (4000000 / _cpu_clock_); 
-    // nb_cycles = (500000 * _cpu_clock_) / (bauds * 4000000); 
-    //nb_cycles = _cpu_clock_ / (8 * bauds); 
-    RF433MHZ.period.w = 0xFFFF - (_cpu_clock_ / (8*bauds));
-    
-    // Disable global interrupts
-    noInterrupts();
-    
-    // Interrupt config.
-    #if defined(__16F1459) || defined(__16F1708)
+    #if defined(__PIC32MX__)
 
-    T1CON = 0b00000001;         // T1_SOURCE_FOSCDIV4 | T1_PS_1_1;
-    T1GCONbits.TMR1GE = 0;      // Ignore T1DIG effection 
-    TMR1H = RF433MHZ.period.h8;
-    TMR1L = RF433MHZ.period.l8;
-    PIR1bits.TMR1IF = 0;
-    PIE1bits.TMR1IE = 1;
+    // core timer / 32, about 1 us at 80 MHz
+    u16 now = ReadCoreTimer() >> 5;
+
+    #elif defined(__16F1459) || defined(__16F1708)
+
+    t16 now;
+    u8 h;
+
+    do {                                    // no latch on TMR1H
+        h = TMR1H;
+        now.l8 = TMR1L;
+        now.h8 = TMR1H;
+    } while (now.h8 != h);
 
     #else
 
-    T0CON = 0b00001000;         // T0_OFF | T0_16BIT | T0_SOURCE_INT | T0_PS_OFF;
-    TMR0H = RF433MHZ.period.h8;
-    TMR0L = RF433MHZ.period.l8;
-    INTCON2bits.TMR0IP = 1;     // INT_HIGH_PRIORITY;
-    INTCONbits.TMR0IF  = 0;
-    INTCONbits.TMR0IE  = 1;     // INT_ENABLE;
-    T0CONbits.TMR0ON   = 1;
+    t16 now;
+
+    now.l8 = TMR3L;                         // latches TMR3H
+    now.h8 = TMR3H;
 
     #endif
 
-    // Enable global interrupts
-    interrupts();
-
-    // Init
-    RF433MHZ.rx_sample = 0;
-    RF433MHZ.rx_last_sample = 0;
-    RF433MHZ.rx_count = 0;
-    RF433MHZ.rx_sync_count = 0;
-    RF433MHZ.rx_mode = RX_MODE_IDLE;
-    // The received manchester 32 bits
-    RF433MHZ.rx_manBits = 0;
-    // The number of received manchester bits
-    RF433MHZ.rx_numMB = 0;
-    RF433MHZ.rx_curByte = 0;
-    RF433MHZ.rx_maxBytes = 2;
-    RF433MHZ.rx_data = RF433MHZ.rx_default_data;
-}
+    (void)line;
+    (void)level;
 
-void RF433MHz_beginReceiveBytes(u8 *data, u8 maxBytes)
-{
-    RF433MHZ.rx_maxBytes = maxBytes;
-    RF433MHZ.rx_data = data;
-    RF433MHZ.rx_mode = RX_MODE_PRE;
+    #if defined(__PIC32MX__)
+    RF433MHz_packetEdge(&RF433MHZ.rx, now);
+    #else
+    RF433MHz_packetEdge(&RF433MHZ.rx, now.w);
+    #endif
 }
 
-void RF433MHz_beginReceive(void)
-{
-    RF433MHZ.rx_maxBytes = 2;
-    RF433MHZ.rx_data = RF433MHZ.rx_default_data;
-    RF433MHZ.rx_mode = RX_MODE_PRE;
-}
+/*  --------------------------------------------------------------------
+    RF433MHz_init
+    --------------------------------------------------------------------
+    @param:     line    external interrupt the receiver is wired to
+                bauds   data bits per second (the transmitter's ones)
+    ------------------------------------------------------------------*/
 
-u8 RF433MHz_receiveComplete(void)
+void RF433MHz_init(u8 line, u16 bauds)
 {
-    return (RF433MHZ.rx_mode == RX_MODE_MSG);
-}
+    RF433MHZ.length = 0;
+    RF433MHZ.maxBytes = 2;
+    RF433MHZ.data = RF433MHZ.default_data;
+
+    // half bit time in time stamp ticks
+    #if defined(__PIC32MX__)
+    RF433MHz_packetInit(&RF433MHZ.rx, GetSystemClock() / 128 / bauds);
+    #elif defined(__16F1459) || defined(__16F1708)
+    RF433MHz_packetInit(&RF433MHZ.rx, _cpu_clock_ / 8 / bauds);
+    #else
+    RF433MHz_packetInit(&RF433MHZ.rx, _cpu_clock_ / 64 / bauds);
+    #endif
+    RF433MHZ.rx.state = RF433MHZ_IDLE;
 
-u16 RF433MHz_getMessage(void)
-{
-    return (((u16)RF433MHZ.rx_data[0]) << 8) | (u16)RF433MHZ.rx_data[1];
-}
+    // initialized again : give the previous line back first
+    if (RF433MHZ.line < INTX_LINES && gIntx[RF433MHZ.line] == RF433MHz_interrupt)
+        IntxDetach(RF433MHZ.line);
+    RF433MHZ.line = INTX_LINES;
 
-void RF433MHz_stopReceive(void)
-{
-    RF433MHZ.rx_mode = RX_MODE_IDLE;
-}
+    if (line >= INTX_LINES)
+        return;
 
-void rf433mhz_interrupt()
-{
-    volatile u8 rx_sample_0=0;
-    volatile u8 rx_sample_1=0;
-    volatile u8 transition;
- 
     #if defined(__16F1459) || defined(__16F1708)
-    
-    if (PIR1bits.TMR1IF)
+
+    if (!T1CONbits.TMR1ON)                  // not started by millis()
     {
-        PIR1bits.TMR1IF = 0;
-        TMR1H = RF433MHZ.period.h8;
-        TMR1L = RF433MHZ.period.l8;
+        T1CON = 0b00000000;                 // Fosc/4, 1:1
+        T1GCONbits.TMR1GE = 0;
+        T1CONbits.TMR1ON = 1;
+    }
 
-    #else
+    #elif !defined(__PIC32MX__)
+
+    #if defined(__18f26j50) || defined(__18f46j50) || \
+        defined(__18f26j53) || defined(__18f46j53) || \
+        defined(__18f27j53) || defined(__18f47j53) || \
+        defined(__18f25k50) || defined(__18f45k50)
+    T3GCONbits.TMR3GE = 0;                  // no gate
+    #endif
+    T3CON = T3_16BIT | T3_PS_1_8 | T3_SOURCE_FOSCDIV4 | T3_ON;
+    PIE2bits.TMR3IE = 0;                    // free running
 
-    if (INTCONbits.TMR0IF)
+    switch (line)
     {
-        INTCONbits.TMR0IF = 0;
-        TMR0H = RF433MHZ.period.h8;//0xD1;
-        TMR0L = RF433MHZ.period.l8;//0x1F;
+        case 0: TRISBbits.TRISB0 = INPUT; break;
+        case 1: TRISBbits.TRISB1 = INPUT; break;
+        case 2: TRISBbits.TRISB2 = INPUT; break;
+    }
 
     #endif
 
-        if (RF433MHZ.rx_mode < RX_MODE_MSG) //receiving something
-        {
-            // Increment counter
-            RF433MHZ.rx_count += 8;
-            
-            // Check for value change
-            //rx_sample = digitalRead(RxPin);
-            // caoxp@github, 
-            // add filter.
-            // sample twice, only the same means a change.
-            rx_sample_0 = 0;
-            rx_sample_1 = digitalread(RF433MHZ.RxPin);
-            if (rx_sample_1 == rx_sample_0)
-                RF433MHZ.rx_sample = rx_sample_1;
-            rx_sample_0 = rx_sample_1;
-
-            //check sample transition
-            transition = (RF433MHZ.rx_sample != RF433MHZ.rx_last_sample);
-        
-            if (RF433MHZ.rx_mode == RX_MODE_PRE)
-            {
-                // Wait for first transition to HIGH
-                if (transition && (RF433MHZ.rx_sample == 1))
-                {
-                    RF433MHZ.rx_count = 0;
-                    RF433MHZ.rx_sync_count = 0;
-                    RF433MHZ.rx_mode = RX_MODE_SYNC;
-                }
-            }
-            else if (RF433MHZ.rx_mode == RX_MODE_SYNC)
-            {
-                // Initial sync block
-                if (transition)
-                {
-                    if (( (RF433MHZ.rx_sync_count < (SYNC_PULSE_MIN * 2) ) || (RF433MHZ.rx_last_sample == 1) ) &&
-                        ( (RF433MHZ.rx_count < MinCount) || (RF433MHZ.rx_count > MaxCount)))
-                    {
-                        // First 20 bits and all 1 bits are expected to be regular
-                        // Transition was too slow/fast
-                        RF433MHZ.rx_mode = RX_MODE_PRE;
-                    }
-                    else if ((RF433MHZ.rx_last_sample == 0) &&
-                            ((RF433MHZ.rx_count < MinCount) || (RF433MHZ.rx_count > MaxLongCount)))
-                    {
-                        // 0 bits after the 20th bit are allowed to be a double bit
-                        // Transition was too slow/fast
-                        RF433MHZ.rx_mode = RX_MODE_PRE;
-                    }
-                    else
-                    {
-                        RF433MHZ.rx_sync_count++;
-                        
-                        if ((RF433MHZ.rx_last_sample == 0) &&
-                           (RF433MHZ.rx_sync_count >= (SYNC_PULSE_MIN * 2) ) &&
-                           (RF433MHZ.rx_count >= MinLongCount))
-                        {
-                            // We have seen at least 10 regular transitions
-                            // Lock sequence ends with unencoded bits 01
-                            // This is encoded and TX as HI,LO,LO,HI
-                            // We have seen a long low - we are now locked!
-                            RF433MHZ.rx_mode    = RX_MODE_DATA;
-                            RF433MHZ.rx_manBits = 0;
-                            RF433MHZ.rx_numMB   = 0;
-                            RF433MHZ.rx_curByte = 0;
-                        }
-                        else if (RF433MHZ.rx_sync_count >= (SYNC_PULSE_MAX * 2) )
-                        {
-                            RF433MHZ.rx_mode = RX_MODE_PRE;
-                        }
-                        RF433MHZ.rx_count = 0;
-                    }
-                }
-            }
-            else if (RF433MHZ.rx_mode == RX_MODE_DATA)
-            {
-                // Receive data
-                if (transition)
-                {
-                    if ((RF433MHZ.rx_count < MinCount) || (RF433MHZ.rx_count > MaxLongCount))
-                    {
-                        // wrong signal lenght, discard the message
-                        RF433MHZ.rx_mode = RX_MODE_PRE;
-                    }
-                    else
-                    {
-                        if (RF433MHZ.rx_count >= MinLongCount) // was the previous bit a double bit?
-                        {
-                            RF433MHz_addManchesterBit(&RF433MHZ.rx_manBits, &RF433MHZ.rx_numMB, &RF433MHZ.rx_curByte, RF433MHZ.rx_data, RF433MHZ.rx_last_sample);
-                        }
-                        if ((RF433MHZ.rx_sample == 1) && (RF433MHZ.rx_curByte >= RF433MHZ.rx_maxBytes))
-                        {
-                            RF433MHZ.rx_mode = RX_MODE_MSG;
-                        }
-                        else
-                        {
-                            // Add the current bit
-                            RF433MHz_addManchesterBit(&RF433MHZ.rx_manBits, &RF433MHZ.rx_numMB, &RF433MHZ.rx_curByte, RF433MHZ.rx_data, RF433MHZ.rx_sample);
-                            RF433MHZ.rx_count = 0;
-                        }
-                    }
-                }
-            }
-            
-            // Get ready for next loop
-            RF433MHZ.rx_last_sample = RF433MHZ.rx_sample;
-        }
-    }
+    // first edge is rising
+    if (IntxAttach(line, RF433MHz_interrupt, INT_RISING_EDGE))
+        RF433MHZ.line = line;
 }
 
-#endif // RF433MHZRECEIVER
+/*  --------------------------------------------------------------------
+    Packet reception
+    --------------------------------------------------------------------
+    The payload is copied to the user buffer by receiveComplete(),
+    once its CRC is right. Until beginReceive() is called again the
+    interrupt ignores the data line.
+    ------------------------------------------------------------------*/
 
-/*
-//decode 8 bit payload and 4 bit ID from the message, return true if checksum is correct, otherwise false
-u8 RF433MHz_decodeMessage(u16 m, u8 id, u8 data)
+void RF433MHz_beginReceiveBytes(u8 maxBytes, u8 *data)
 {
-    u8 ch, ech;
-    
-    //extract components
-    data = (m & 0xFF);
-    id = (m >> 12);
-    ch = (m >> 8) & 0b1111; //checksum received
-    //calculate checksum
-    ech = (id ^ data ^ (data >> 4) ^ 0b0011) & 0b1111; //checksum expected
-    return ch == ech;
+    RF433MHZ.maxBytes = maxBytes;
+    RF433MHZ.data = data;
+    RF433MHz_packetHunt(&RF433MHZ.rx);
 }
 
-//encode 8 bit payload, 4 bit ID and 4 bit checksum into 16 bit
-u16 RF433MHz_encodeMessage(u8 id, u8 data)
+void RF433MHz_beginReceive(void)
 {
-    u8 chsum = (id ^ data ^ (data >> 4) ^ 0b0011) & 0b1111;
-    u16 m = ((id) << 12) | (chsum << 8) | (data);
-    return m;
+    // keep on receiving a packet already started
+    if (RF433MHZ.rx.state < RF433MHZ_DONE)
+        return;
+    RF433MHz_beginReceiveBytes(2, RF433MHZ.default_data);
 }
-*/
 
-// called from the interrupt routine
-void RF433MHz_addManchesterBit(u16 *manBits, u8 *numMB, u8 *curByte, u8 *data, u8 newBit)
+u8 RF433MHz_receiveComplete(void)
 {
-    u8 newData, i;
-    
-    // Makes space for the new bit
-    (*manBits) <<= 1;
-    // Add the new bit
-    (*manBits) |= newBit;
-    // Increment counter
-    (*numMB)++;
-
-    if (*numMB == 16)
+    u8 len;
+
+    if (RF433MHZ.rx.state == RF433MHZ_MSG)
+        return 1;
+
+    if (RF433MHZ.rx.state != RF433MHZ_DONE)
+        return 0;
+
+    // the interrupt doesn't touch the packet any more
+    len = RF433MHz_packetRead(&RF433MHZ.rx, RF433MHZ.data, RF433MHZ.maxBytes);
+    if (len == RF433MHZ_ERROR)
     {
-        newData = 0;
-        for (i = 0; i < 8; i++)
-        {
-            // ManBits holds 16 bits of manchester data
-            // 1 = LO,HI
-            // 0 = HI,LO
-            // We can decode each bit by looking at the bottom bit of each pair.
-            newData <<= 1;
-            newData |= (*manBits & 1); // store the one
-            *manBits = *manBits >> 2; //get next data bit
-        }
-        data[*curByte] = newData ^ DECOUPLING_MASK;
-        (*curByte)++;
-
-        // added by caoxp @ https://github.com/caoxp
-        // compatible with unfixed-length data, with the data length defined by the first byte.
-        // at a maximum of 255 total data length.
-        if ((*curByte) == 1)
-            RF433MHZ.rx_maxBytes = data[0];
-        
-        *numMB = 0;
+        RF433MHz_packetHunt(&RF433MHZ.rx);
+        return 0;
     }
+
+    RF433MHZ.length = len;
+    RF433MHZ.rx.state = RF433MHZ_MSG;
+    return 1;
+}
+
+u8 RF433MHz_getLength(void)
+{
+    return RF433MHZ.length;
+}
+
+u16 RF433MHz_getMessage(void)
+{
+    return (((u16)RF433MHZ.data[0]) << 8) | (u16)RF433MHZ.data[1];
+}
+
+void RF433MHz_stopReceive(void)
+{
+    RF433MHZ.rx.state = RF433MHZ_IDLE;
 }
 
 #endif // __RF433MHZ_RX_C
@@ -22,6 +22,8 @@
     12 Dec. 2016 - Régis Blanchot - fixed SPI part
     13 Dec. 2016 - Régis Blanchot - fixed Low RAM PIC support
     22 Nov. 2017 - Régis Blanchot - fixed printCenter to support different fonts
+    19 Oct. 2026 - drawing done a byte at a time by raster.c,
+                   added SSD1306_blit
     ------------------------------------------------------------------------
     TODO:
     * Manage screen's size in SSD1306_init
@@ -77,6 +79,7 @@ BS2     0       1       1       0       0
 #include <stdarg.h>
 #include <string.h>         // memset, memcpy
 #include <SSD1306.h>
+#include <raster.c>         // 1bpp buffer drawing
 
 #if !defined(__PIC32MX__)
 #include <digitalw.c>
@@ -127,6 +130,7 @@ BS2     0       1       1       0       0
     #ifdef SSD1306DRAWBITMAP
     #define DRAWBITMAP
     #endif
+    #define GRAPHICSHVLINES
     #include <graphics.c>
 #endif
 
@@ -157,6 +161,9 @@ u8 *SSD1306_buffer[SSD1306_DISPLAY_ROWS] = {
     #endif
 };
 
+// Buffers as seen by the drawing functions
+raster_t SSD1306_raster;
+
 // Pins
 #if   defined(SSD1306USEI2C1)  || defined(SSD1306USEI2C2)
     u8 SSD1306_I2CADDR;
@@ -440,6 +447,8 @@ void SSD1306_init(u8 module, ...)
     SSD1306.screen.width  = SSD1306_DISPLAY_WIDTH;
     SSD1306.screen.height = SSD1306_DISPLAY_HEIGHT;
 
+    raster_init(&SSD1306_raster, SSD1306_buffer, SSD1306_DISPLAY_WIDTH, SSD1306_DISPLAY_HEIGHT, 0);
+
     /** reset device
     When pRST input is low, the chip is initialized with the following status:
         1. Display is OFF.
@@ -553,16 +562,7 @@ void SSD1306_refresh(u8 module)
 
 void SSD1306_clearScreen(u8 module)
 {
-    u8 i, j;
-
-    for (i=0; i<SSD1306_DISPLAY_ROWS; i++)
-    {
-        #if defined(__PIC32MX__) || defined(__XC8__)
-        memset( SSD1306_buffer[i], 0, SSD1306_DISPLAY_WIDTH);
-        #else  
-        memset(&SSD1306_buffer[i], 0, SSD1306_DISPLAY_WIDTH);
-        #endif
-    }
+    raster_clear(&SSD1306_raster);
 
     SSD1306.pixel.x = 0;
     SSD1306.pixel.y = 0;
@@ -651,27 +651,10 @@ void SSD1306_startVerticalAndHorizontalScroll(u8 module, u8 direction, u8 start,
 // The display is 16 rows tall.
 void SSD1306_scrollUp(u8 module)
 {
-    u8 i;
     u8 bytes = ((SSD1306.font.height + 7) / 8);
-    u8 lastline = SSD1306_DISPLAY_ROWS - bytes;
-
-    // Copy line y in Line y-1
-    //void *memcpy(void *dest, const void *src, size_t n)
-    for (i=0; i<lastline; i++)
-        #if defined(__PIC32MX__) || defined(__XC8__)
-        memcpy( SSD1306_buffer[i], SSD1306_buffer[i + 1], SSD1306_DISPLAY_WIDTH);
-        #else
-        memcpy(&SSD1306_buffer[i], SSD1306_buffer[i + 1], SSD1306_DISPLAY_WIDTH);
-        #endif
-
-    // Clear the last lines
-    //void *memset(void *str, int c, size_t n)
-    for (i=lastline; i<SSD1306_DISPLAY_ROWS; i++)
-        #if defined(__PIC32MX__) || defined(__XC8__)
-        memset( SSD1306_buffer[i], 0, SSD1306_DISPLAY_WIDTH);
-        #else
-        memset(&SSD1306_buffer[i], 0, SSD1306_DISPLAY_WIDTH);
-        #endif
+
+    // Copy line y in Line y-1 and clear the last lines
+    raster_scroll(&SSD1306_raster, 8 * bytes);
     
     SSD1306.pixel.y = SSD1306.pixel.y - (8 * bytes);
 }
@@ -932,22 +915,12 @@ void SSD1306_printf(u8 module, const u8 *fmt, ...)
 
 void SSD1306_drawPixel(u8 module, u8 x, u8 y)
 {
-    if (x < SSD1306_DISPLAY_WIDTH && y < SSD1306_DISPLAY_HEIGHT)
-        #ifdef __SDCC
-        *(SSD1306_buffer[y >> 3] + x) |= 1 << (y % SSD1306_DISPLAY_ROWS);
-        #else
-        SSD1306_buffer[y >> 3][x] |= 1 << (y % SSD1306_DISPLAY_ROWS);
-        #endif
+    raster_setPixel(&SSD1306_raster, x, y, RASTER_SET);
 }
 
 void SSD1306_clearPixel(u8 module, u8 x, u8 y)
 {
-    if (x < SSD1306_DISPLAY_WIDTH && y < SSD1306_DISPLAY_HEIGHT)
-        #ifdef __SDCC
-        *(SSD1306_buffer[y >> 3] + x) &= ~(1 << (y % SSD1306_DISPLAY_ROWS));
-        #else
-        SSD1306_buffer[y >> 3][x] &= ~(1 << (y % SSD1306_DISPLAY_ROWS));
-        #endif
+    raster_setPixel(&SSD1306_raster, x, y, RASTER_CLEAR);
 }
 
 /*  --------------------------------------------------------------------
@@ -992,13 +965,28 @@ u8 SSD1306_getColor(u8 module, u8 x, u8 y)
 
 void drawPixel(u16 x, u16 y)
 {
-    //SSD1306_drawPixel(SSD1306_INTF, (u8)x, (u8)y);
-    if (x < SSD1306_DISPLAY_WIDTH && y < SSD1306_DISPLAY_HEIGHT)
-        #ifdef __SDCC
-        *(SSD1306_buffer[y >> 3] + x) |= 1 << (y % SSD1306_DISPLAY_ROWS);
-        #else
-        SSD1306_buffer[y >> 3][x] |= 1 << (y % SSD1306_DISPLAY_ROWS);
-        #endif
+    raster_setPixel(&SSD1306_raster, (s16)x, (s16)y, RASTER_SET);
+}
+
+// graphics.c lines leave out their end point (see drawLine), the
+// generic drawHLine and drawVLine draw w - 1 and h - 1 pixels
+void drawHLine(u16 x, u16 y, u16 w)
+{
+    raster_drawHLine(&SSD1306_raster, (s16)x, (s16)y, (s16)w - 1, RASTER_SET);
+}
+
+void drawVLine(u16 x, u16 y, u16 h)
+{
+    raster_drawVLine(&SSD1306_raster, (s16)x, (s16)y, (s16)h - 1, RASTER_SET);
+}
+
+// columns x1 to x2, rows y1 to y2 - 2, like the generic fillRect
+// made of drawVLine(x, y1, y2 - y1)
+void fillRect(u16 x1, u16 y1, u16 x2, u16 y2)
+{
+    if (x1 > x2) swap(x1, x2);
+    if (y1 > y2) swap(y1, y2);
+    raster_fillRect(&SSD1306_raster, (s16)x1, (s16)y1, x2 - x1 + 1, (s16)(y2 - y1) - 1, RASTER_SET);
 }
 
 void SSD1306_drawLine(u8 module, u16 x0, u16 y0, u16 x1, u16 y1)
@@ -1043,6 +1031,21 @@ void SSD1306_fillCircle(u8 module, u16 x, u16 y, u16 radius)
     fillCircle(x, y, radius);
 }
 
+/*  --------------------------------------------------------------------
+    DESCRIPTION:
+        Draws a w x h bitmap (same format as the fonts : one byte per
+        column, bit 0 on top, a row of 8 pixels after the other)
+    PARAMETERS:
+        rop : RASTER_COPY, RASTER_OR, RASTER_AND or RASTER_XOR
+    RETURNS:
+    REMARKS:
+    ------------------------------------------------------------------*/
+
+void SSD1306_blit(u8 module, const u8 *bitmap, u16 x, u16 y, u8 w, u8 h, u8 rop)
+{
+    raster_blit(&SSD1306_raster, (s16)x, (s16)y, bitmap, w, h, rop);
+}
+
 #ifdef SSD1306DRAWBITMAP
 void SSD1306_drawBitmap(u8 module1, u16 module2, const u8* filename, u16 x, u16 y)
 {
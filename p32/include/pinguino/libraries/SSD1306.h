@@ -253,6 +253,7 @@ void SSD1306_drawRect(u8, u16, u16, u16, u16);
 void SSD1306_drawRoundRect(u8, u16, u16, u16, u16);
 void SSD1306_fillRect(u8, u16, u16, u16, u16);
 void SSD1306_fillRoundRect(u8 , u16, u16, u16, u16);
+void SSD1306_blit(u8, const u8 *, u16, u16, u8, u8, u8);
 void SSD1306_drawBitmap(u8, u16, u16, u16, u16, u16*);
 
 /**	--------------------------------------------------------------------
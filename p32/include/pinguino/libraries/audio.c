@@ -12,9 +12,13 @@
     * 17 Feb. 2015  Régis Blanchot - renamed library to audio.c
     * 17 Feb. 2015  Régis Blanchot - added Audio.staccato() and Audio.legato()
     * 24 Feb. 2015  Régis Blanchot - Pinguino 32 version
+    * 19 Oct. 2026  polyphonic wavetable engine :
+                    the TIMER2 ISR only pops precomputed duty cycles from
+                    a ring buffer filled by Audio_render() in the main loop,
+                    N voices with ADSR envelopes, DTMF, 8/16-bit PCM WAV
+                    streaming from SD card (AUDIOWAV)
     TODO:
-    * DTMF (dual-tone multi-frequency)
-    * Wav decoder
+    * Resampling of WAV files which rate differs from the engine's one
     READINGS :
     * http://www.romanblack.com/one_sec.htm#BDA 
     * http://www.electricdruid.net/index.php?page=info.dds
@@ -51,9 +55,21 @@
     #include <system.c>         // getPeripheralClock
     #include <interrupt.c>      // interrupts routines
     #endif
+
+    #ifdef AUDIOWAV
+    #include <string.h>         // memcmp
+    #define SDOPEN
+    #define SDCLOSE
+    #define SDMOUNT
+    #define SDREAD
+    #include <sd/tff.h>
+    #include <sd/diskio.c>
+    #endif
     
-    // PWM mode
+    // PWM mode (audio.h has the PIC32 one)
+    #ifndef __PIC32MX__
     #define PWMMODE         0b00001100
+    #endif
 
     // PWM registers pointers
     #ifndef __PIC32MX__
@@ -67,25 +83,86 @@
 
     // Global variables
     volatile u16 gPeriodPlus1;  // u32 ?
-    volatile u16 gPhase = 0;    // 16-bit accumulator
-    volatile u16 gFreq1Inc = 0;
-    volatile u16 gFreq2Inc = 0;
-             u16 gSampleRate;  // u32 ?
+             u32 gSampleRate;
              u8  gStaccato = true;
 
-    // Waveform table
-    const u8 sine64[64] = {
-        50,54,59,64,68,73,77,81,85,88,91,93,95,97,98,99,99,99,98,97,95,
-        93,91,88,85,81,77,73,68,64,59,54,50,45,40,35,31,26,22,18,14,11,
-        8,6,4,2,1,0,0,0,1,2,4,6,8,11,14,18,22,26,31,35,40,45 };
+    // Ring buffer of PWM duty cycles
+    // written by Audio_render(), read by the TIMER2 ISR
+    u16 gAudioBuffer[AUDIOBUFFERSIZE];
+    volatile u16 gAudioHead = 0;        // next sample to write
+    volatile u16 gAudioTail = 0;        // next sample to play
+    volatile u32 gAudioUnderrun = 0;    // nb of ISR without sample
+
+    audio_voice_t gAudioVoice[AUDIOVOICES];
+
+    // Waveform table (Q15)
+    const s16 sine256[256] = {
+             0,   804,  1608,  2410,  3212,  4011,  4808,  5602,
+          6393,  7179,  7962,  8739,  9512, 10278, 11039, 11793,
+         12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+         18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+         23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+         27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+         30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+         32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+         32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+         32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571,
+         30273, 29956, 29621, 29268, 28898, 28510, 28105, 27683,
+         27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+         23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868,
+         18204, 17530, 16846, 16151, 15446, 14732, 14010, 13279,
+         12539, 11793, 11039, 10278,  9512,  8739,  7962,  7179,
+          6393,  5602,  4808,  4011,  3212,  2410,  1608,   804,
+             0,  -804, -1608, -2410, -3212, -4011, -4808, -5602,
+         -6393, -7179, -7962, -8739, -9512,-10278,-11039,-11793,
+        -12539,-13279,-14010,-14732,-15446,-16151,-16846,-17530,
+        -18204,-18868,-19519,-20159,-20787,-21403,-22005,-22594,
+        -23170,-23731,-24279,-24811,-25329,-25832,-26319,-26790,
+        -27245,-27683,-28105,-28510,-28898,-29268,-29621,-29956,
+        -30273,-30571,-30852,-31113,-31356,-31580,-31785,-31971,
+        -32137,-32285,-32412,-32521,-32609,-32678,-32728,-32757,
+        -32767,-32757,-32728,-32678,-32609,-32521,-32412,-32285,
+        -32137,-31971,-31785,-31580,-31356,-31113,-30852,-30571,
+        -30273,-29956,-29621,-29268,-28898,-28510,-28105,-27683,
+        -27245,-26790,-26319,-25832,-25329,-24811,-24279,-23731,
+        -23170,-22594,-22005,-21403,-20787,-20159,-19519,-18868,
+        -18204,-17530,-16846,-16151,-15446,-14732,-14010,-13279,
+        -12539,-11793,-11039,-10278, -9512, -8739, -7962, -7179,
+         -6393, -5602, -4808, -4011, -3212, -2410, -1608,  -804 };
 
     const u32 gPrescaler[8] = { 1, 2, 4, 8, 16, 32, 64, 256 };
 
+    #ifdef AUDIODTMF
+    // DTMF keypad : rows (low group) and columns (high group) frequencies
+    const u8  gDTMFKeys[16]  = "123A456B789C*0#D";
+    const u16 gDTMFRow[4]    = { 697,  770,  852,  941 };
+    const u16 gDTMFCol[4]    = { 1209, 1336, 1477, 1633 };
+    #endif
+
+    #ifdef AUDIOWAV
+    FIL gAudioWavFile;
+    u8  gAudioWavSpi;
+    u8  gAudioWavBits;                  // 8 or 16
+    u8  gAudioWavChannels;              // 1 or 2
+    u32 gAudioWavRemain = 0;            // nb of bytes left to play
+    u8  gAudioWavBuffer[AUDIOCHUNK * 4];
+    #endif
+
     // Prototypes
-    void Audio_init(u16 samplerate);
-    void Audio_tone(u8 pin, u16 freq, u16 duration);
-    void Audio_DTMF(u8 pin, u16 freq1, u16 freq2, u16 duration);
+    void Audio_init(u32 samplerate);
+    void Audio_attach(u8 pin);
+    void Audio_tone(u8 pin, u32 freq, u32 duration);
+    void Audio_dualTone(u8 pin, u32 freq1, u32 freq2, u32 duration);
+    void Audio_DTMF(u8 pin, u8 key, u32 duration);
     void Audio_noTone(u8 pin);
+    void Audio_noteOn(u8 voice, u32 freq, u32 duration);
+    void Audio_noteOff(u8 voice);
+    void Audio_setEnvelope(u8 voice, u16 attack, u16 decay, u8 sustain, u16 release);
+    u8   Audio_setWaveform(u8 voice, const s16 *table, u8 bits);
+    void Audio_setVolume(u8 voice, u8 volume);
+    u8   Audio_isPlaying(u8 voice);
+    void Audio_mix(audio_voice_t *voice, u8 nbvoices, s16 *out, u16 n);
+    void Audio_render();
 
 /*  --------------------------------------------------------------------
     Audio_init
@@ -103,6 +180,7 @@
     void Audio_init(u32 samplerate)
     {
         u32 tckps = 0;
+        u8 i;
 
         gSampleRate = samplerate;
 
@@ -120,52 +198,17 @@
 
         if (tckps == 8) tckps = 7; // divided per 256
 
-/*
-        
-        if (gPeriodPlus1 < (resolution * 1))
+        // Default voices : sine wave, full volume, no envelope
+        for (i = 0; i < AUDIOVOICES; i++)
         {
-            prescaler = 0b000;                  // prescaler is 1
+            gAudioVoice[i].state = AUDIO_OFF;
+            gAudioVoice[i].volume = 255;
+            Audio_setWaveform(i, sine256, 8);
+            Audio_setEnvelope(i, 0, 0, 100, 0);
         }
-        else if (gPeriodPlus1 < (resolution * 2))
-        {
-            gPeriodPlus1 = gPeriodPlus1 >> 1;   // divided by 2
-            prescaler = 0b001;                  // prescaler is 2
-        }
-        else if (gPeriodPlus1 < (resolution * 4))
-        {
-            gPeriodPlus1 = gPeriodPlus1 >> 2;   // divided by 4
-            prescaler = 0b010;                  // prescaler is 4
-        }
-        else if (gPeriodPlus1 < (resolution * 8))
-        {
-            gPeriodPlus1 = gPeriodPlus1 >> 3;   // divided by 8
-            prescaler = 0b011;                  // prescaler is 8
-        }
-        else if (gPeriodPlus1 < (resolution * 16))
-        {
-            gPeriodPlus1 = gPeriodPlus1 >> 4;   // divided by 16
-            prescaler = 0b100;                  // prescaler is 16
-        }
-        else if (gPeriodPlus1 < (resolution * 32))
-        {
-            gPeriodPlus1 = gPeriodPlus1 >> 5;   // divided by 32
-            prescaler = 0b101;                  // prescaler is 32
-        }
-        else if (gPeriodPlus1 < (resolution * 64))
-        {
-            gPeriodPlus1 = gPeriodPlus1 >> 6;   // divided by 64
-            prescaler = 0b110;                  // prescaler is 64
-        }
-        else if (gPeriodPlus1 < (resolution * 256))
-        {
-            gPeriodPlus1 = gPeriodPlus1 >> 8;   // divided by 256
-            prescaler = 0b111;                  // prescaler is 256
-        }
-        else
-        {
-            return;                             // period is too high
-        }
-*/
+
+        // Empty buffer
+        gAudioHead = gAudioTail = 0;
 
         // TIMER2 interrupt configuration
         IntConfigureSystem(INT_SYSTEM_CONFIG_MULT_VECTOR);
@@ -176,27 +219,17 @@
         // Timer configuration
         PR2   = gPeriodPlus1 - 1;               // TIMER2 period
         TMR2  = 0;
-        //T2CON = 0x8000 | (prescaler<<4);        // Set prescaler and enable TIMER2
-        T2CON = 0x8000 | (tckps<<4);        // Set prescaler and enable TIMER2
+        T2CON = 0x8000 | (tckps<<4);            // Set prescaler and enable TIMER2
     }
 
 /*  --------------------------------------------------------------------
-    Audio_tone
+    Audio_attach
     --------------------------------------------------------------------
-    Play sound with a certain frequency for a certain duration
-    @param pin:         pin number where buzzer or loudspeaker is connected
-    @param freq:        note frequency
-    @param duration:    Duration in ms
-    @return:            none
-    @usage:             Audio.tone(PWM4, 440, 100); // LA 440Hz for 100 ms
-    
-    Note : When the output compare module is enabled, the I/O pin direction is
-    controlled by the compare module. The compare module returns the I/O pin
-    control back to the appropriate pin LAT and TRIS control bits when it is
-    disabled.
+    @descr :    select the output compare module the sound is sent to
+    @param :    pin number where buzzer or loudspeaker is connected
     ------------------------------------------------------------------*/
 
-    void Audio_tone(u8 pin, u32 freq, u32 duration)
+    void Audio_attach(u8 pin)
     {
         switch (pin)
         {
@@ -307,11 +340,355 @@
 
             #endif
         }
+    }
 
-        // 16-bit accumulator's increment value.
+/*  --------------------------------------------------------------------
+    Audio_setWaveform
+    --------------------------------------------------------------------
+    @param voice:       voice number (0 .. AUDIOVOICES-1)
+    @param table:       signed 16-bit (Q15) samples of one period
+    @param bits:        log2 of the table size (sine256 is 8)
+    @return:            false if the table size is not 2 .. 2^AUDIOTABLEBITS,
+                        the voice keeps its previous waveform
+    ------------------------------------------------------------------*/
+
+    u8 Audio_setWaveform(u8 voice, const s16 *table, u8 bits)
+    {
+        audio_voice_t *v = &gAudioVoice[voice];
+
+        // the index mask is 16-bit, and the interpolation needs 15
+        // phase bits below the index
+        if (bits < 1 || bits > AUDIOTABLEBITS)
+            return false;
+
+        v->table = table;
+        v->shift = 32 - bits;
+        v->mask  = (1 << bits) - 1;
+        return true;
+    }
+
+/*  --------------------------------------------------------------------
+    Audio_setEnvelope
+    --------------------------------------------------------------------
+    @param voice:       voice number (0 .. AUDIOVOICES-1)
+    @param attack:      time to reach the full level (ms)
+    @param decay:       time to fall to the sustain level (ms)
+    @param sustain:     sustain level (% of the full level)
+    @param release:     time to fall to zero once the note is off (ms)
+    ------------------------------------------------------------------*/
+
+    void Audio_setEnvelope(u8 voice, u16 attack, u16 decay, u8 sustain, u16 release)
+    {
+        audio_voice_t *v = &gAudioVoice[voice];
+
+        if (sustain > 100) sustain = 100;
+
+        v->attack  = attack;
+        v->decay   = decay;
+        v->sustain = ((u32)sustain << 16) / 100;
+        v->release = release;
+    }
+
+/*  --------------------------------------------------------------------
+    Audio_setVolume
+    --------------------------------------------------------------------
+    @param voice:       voice number (0 .. AUDIOVOICES-1)
+    @param volume:      0 (mute) .. 255 (full)
+    ------------------------------------------------------------------*/
+
+    void Audio_setVolume(u8 voice, u8 volume)
+    {
+        gAudioVoice[voice].volume = volume;
+    }
+
+/*  --------------------------------------------------------------------
+    Envelope step : increment per sample to cover a full range in ms
+    ------------------------------------------------------------------*/
+
+    u32 Audio_envStep(u16 ms)
+    {
+        u32 samples = (u64)ms * gSampleRate / 1000;
+
+        return samples ? (AUDIO_ENVMAX / samples) : AUDIO_ENVMAX;
+    }
+
+/*  --------------------------------------------------------------------
+    Audio_noteOn
+    --------------------------------------------------------------------
+    @param voice:       voice number (0 .. AUDIOVOICES-1)
+    @param freq:        note frequency
+    @param duration:    duration in ms before the release (0 = until
+                        Audio_noteOff)
+    ------------------------------------------------------------------*/
+
+    void Audio_noteOn(u8 voice, u32 freq, u32 duration)
+    {
+        audio_voice_t *v = &gAudioVoice[voice];
+        u64 remain = (u64)duration * gSampleRate / 1000;
+
+        // 32-bit phase accumulator's increment value = 2^32 * freq / rate
         // the accumulator will go back to zero after (gSampleRate/freq) ticks
-        gPhase = 0;
-        gFreq1Inc = 65536 * freq / gSampleRate;
+        v->phase   = 0;
+        v->inc     = ((u64)freq << 32) / gSampleRate;
+        v->remain  = (remain > 0xFFFFFFFF) ? 0xFFFFFFFF : remain;
+        v->astep   = Audio_envStep(v->attack);
+        v->dstep   = Audio_envStep(v->decay);
+        v->rstep   = Audio_envStep(v->release);
+        v->env     = 0;
+        v->state   = AUDIO_ATTACK;
+    }
+
+/*  --------------------------------------------------------------------
+    Audio_noteOff
+    --------------------------------------------------------------------
+    @param voice:       voice number (0 .. AUDIOVOICES-1)
+    ------------------------------------------------------------------*/
+
+    void Audio_noteOff(u8 voice)
+    {
+        if (gAudioVoice[voice].state != AUDIO_OFF)
+            gAudioVoice[voice].state = AUDIO_RELEASE;
+    }
+
+/*  --------------------------------------------------------------------
+    Audio_isPlaying
+    --------------------------------------------------------------------
+    @return:            true if the voice is still sounding
+    ------------------------------------------------------------------*/
+
+    u8 Audio_isPlaying(u8 voice)
+    {
+        return (gAudioVoice[voice].state != AUDIO_OFF);
+    }
+
+/*  --------------------------------------------------------------------
+    Audio_mix
+    --------------------------------------------------------------------
+    @descr :    mix n signed 16-bit samples of all the voices
+                the voices are summed and saturated, a single voice
+                plays at its full amplitude
+                doesn't touch any register and can be tested on a host
+    @param :    voice = array of voices
+                nbvoices = nb of voices
+                out = signed 16-bit output samples
+                n = nb of samples to compute
+    ------------------------------------------------------------------*/
+
+    void Audio_mix(audio_voice_t *voice, u8 nbvoices, s16 *out, u16 n)
+    {
+        audio_voice_t *v;
+        s32 acc, s;
+        u32 idx;
+        u16 i;
+        u8 j;
+
+        for (i = 0; i < n; i++)
+        {
+            acc = 0;
+
+            for (j = 0, v = voice; j < nbvoices; j++, v++)
+            {
+                if (v->state == AUDIO_OFF)
+                    continue;
+
+                // Envelope
+                switch (v->state)
+                {
+                    case AUDIO_ATTACK:
+                        v->env += v->astep;
+                        if (v->env >= AUDIO_ENVMAX)
+                        {
+                            v->env = AUDIO_ENVMAX;
+                            v->state = AUDIO_DECAY;
+                        }
+                        break;
+
+                    case AUDIO_DECAY:
+                        if (v->env > v->sustain + v->dstep)
+                            v->env -= v->dstep;
+                        else
+                        {
+                            v->env = v->sustain;
+                            v->state = AUDIO_SUSTAIN;
+                        }
+                        break;
+
+                    case AUDIO_RELEASE:
+                        if (v->env > v->rstep)
+                            v->env -= v->rstep;
+                        else
+                        {
+                            v->env = 0;
+                            v->state = AUDIO_OFF;
+                        }
+                        break;
+
+                    default:
+                        break;
+                }
+
+                if (v->state != AUDIO_RELEASE && v->remain && --v->remain == 0)
+                    v->state = AUDIO_RELEASE;
+
+                // Wavetable lookup
+                idx = v->phase >> v->shift;
+                s = v->table[idx];
+                #ifdef AUDIOINTERPOLATE
+                // linear interpolation with the next 15 bits of the phase
+                s += ((v->table[(idx + 1) & v->mask] - s) *
+                      (s32)((v->phase >> (v->shift - 15)) & 0x7FFF)) >> 15;
+                #endif
+                v->phase += v->inc;
+
+                // Envelope (Q16) and volume (Q8)
+                s = (s * (s32)(v->env >> 1)) >> 15;
+                acc += (s * v->volume) >> 8;
+            }
+
+            if (acc > 32767)
+                acc = 32767;
+            else if (acc < -32768)
+                acc = -32768;
+            out[i] = acc;
+        }
+    }
+
+/*  --------------------------------------------------------------------
+    Audio_readWav
+    --------------------------------------------------------------------
+    @descr :    add n samples of the WAV file being played to the mix
+    ------------------------------------------------------------------*/
+
+    #ifdef AUDIOWAV
+
+    void Audio_readWav(s16 *out, u16 n)
+    {
+        u16 i, br, size;
+        s32 s;
+        u8 *p = gAudioWavBuffer;
+        u8 bytes = (gAudioWavBits >> 3) * gAudioWavChannels;
+
+        size = n * bytes;
+        if (size > gAudioWavRemain)
+            size = gAudioWavRemain;
+
+        if (f_read(gAudioWavSpi, &gAudioWavFile, gAudioWavBuffer, size, &br) != FR_OK)
+            br = 0;
+
+        gAudioWavRemain = (br < size) ? 0 : gAudioWavRemain - br;
+        n = br / bytes;
+
+        for (i = 0; i < n; i++, p += bytes)
+        {
+            // 8-bit PCM is unsigned, 16-bit PCM is signed little-endian
+            // only the left channel of a stereo file is played
+            if (gAudioWavBits == 8)
+                s = ((s16)p[0] - 128) << 8;
+            else
+                s = (s16)(p[0] | (p[1] << 8));
+
+            s += out[i];
+            if (s >  32767) s =  32767;
+            if (s < -32768) s = -32768;
+            out[i] = s;
+        }
+
+        if (gAudioWavRemain == 0)
+            f_close(gAudioWavSpi, &gAudioWavFile);
+    }
+
+    #endif
+
+/*  --------------------------------------------------------------------
+    Audio_render
+    --------------------------------------------------------------------
+    @descr :    fill the ring buffer with new samples
+                must be called often enough from the main loop :
+                AUDIOBUFFERSIZE samples last 11.6 ms at CDQUALITY
+    ------------------------------------------------------------------*/
+
+    void Audio_render()
+    {
+        s16 mix[AUDIOCHUNK];
+        u16 head, room, n, i;
+        u32 period = gPeriodPlus1;
+
+        head = gAudioHead;
+        room = (gAudioTail - head - 1) & (AUDIOBUFFERSIZE - 1);
+
+        while (room)
+        {
+            n = (room > AUDIOCHUNK) ? AUDIOCHUNK : room;
+
+            Audio_mix(gAudioVoice, AUDIOVOICES, mix, n);
+
+            #ifdef AUDIOWAV
+            if (gAudioWavRemain)
+                Audio_readWav(mix, n);
+            #endif
+
+            // signed 16-bit sample to duty cycle (0 .. period-1)
+            for (i = 0; i < n; i++)
+            {
+                gAudioBuffer[head] = ((u32)(mix[i] + 32768) * period) >> 16;
+                head = (head + 1) & (AUDIOBUFFERSIZE - 1);
+            }
+
+            gAudioHead = head;
+            room -= n;
+        }
+    }
+
+/*  --------------------------------------------------------------------
+    Wait until all the voices are off and the buffer is empty
+    ------------------------------------------------------------------*/
+
+    void Audio_play()
+    {
+        u8 i, busy;
+
+        do {
+            Audio_render();
+            busy = 0;
+            for (i = 0; i < AUDIOVOICES; i++)
+                busy |= Audio_isPlaying(i);
+        } while (busy);
+
+        // let the ISR play the last samples
+        while (gAudioHead != gAudioTail);
+
+        if (gStaccato)
+            #ifndef __PIC32MX__
+            *pCCPxCON = 0;      // staccato
+            #else
+            *pOCxCON = 0;       // staccato (PWMx Off)
+            #endif
+    }
+
+/*  --------------------------------------------------------------------
+    Audio_tone
+    --------------------------------------------------------------------
+    Play sound with a certain frequency for a certain duration
+    @param pin:         pin number where buzzer or loudspeaker is connected
+    @param freq:        note frequency
+    @param duration:    Duration in ms
+    @return:            none
+    @usage:             Audio.tone(PWM4, 440, 100); // LA 440Hz for 100 ms
+    
+    Note : When the output compare module is enabled, the I/O pin direction is
+    controlled by the compare module. The compare module returns the I/O pin
+    control back to the appropriate pin LAT and TRIS control bits when it is
+    disabled.
+    ------------------------------------------------------------------*/
+
+    void Audio_tone(u8 pin, u32 freq, u32 duration)
+    {
+        if (duration == 0)
+            return;
+
+        Audio_attach(pin);
+        Audio_noteOn(0, freq, duration);
+        Audio_render();
 
         #ifndef __PIC32MX__
         *pCCPxCON = PWMMODE;
@@ -322,14 +699,7 @@
         *pOCxCON = PWMMODE;
         #endif
 
-        Delayms(duration);
-        
-        if (gStaccato)
-            #ifndef __PIC32MX__
-            *pCCPxCON = 0;      // staccato
-            #else
-            *pOCxCON = 0;      // staccato (PWMx Off)
-            #endif
+        Audio_play();
     }
 
 /*  --------------------------------------------------------------------
@@ -351,145 +721,100 @@
 
     void Audio_dualTone(u8 pin, u32 freq1, u32 freq2, u32 duration)
     {
-        switch (pin)
-        {
-            ///*********************************************************
-            #if defined(PIC32_PINGUINO_220)
-            ///*********************************************************
-            
-            case  2: pOCxCON = (u16*)&OC3CON; pOCxR = (u16*)&OC3R; pOCxRS = (u16*)&OC3RS; break;
-            case  3: pOCxCON = (u16*)&OC4CON; pOCxR = (u16*)&OC4R; pOCxRS = (u16*)&OC4RS; break;
-            case 11: pOCxCON = (u16*)&OC2CON; pOCxR = (u16*)&OC2R; pOCxRS = (u16*)&OC2RS; break;
-            case 12: pOCxCON = (u16*)&OC5CON; pOCxR = (u16*)&OC5R; pOCxRS = (u16*)&OC5RS; break;
-            case 13: pOCxCON = (u16*)&OC1CON; pOCxR = (u16*)&OC1R; pOCxRS = (u16*)&OC1RS; break;
+        if (duration == 0)
+            return;
 
-            ///*********************************************************
-            #elif defined(PINGUINO32MX220) || \
-                  defined(PINGUINO32MX250) || \
-                  defined(PINGUINO32MX270)
-            ///*********************************************************
-        
-            case  1: pOCxCON = (u16*)&OC3CON; pOCxR = (u16*)&OC3R; pOCxRS = (u16*)&OC3RS; break;
-            case  2: pOCxCON = (u16*)&OC4CON; pOCxR = (u16*)&OC4R; pOCxRS = (u16*)&OC4RS; break;
-            case  6: pOCxCON = (u16*)&OC2CON; pOCxR = (u16*)&OC2R; pOCxRS = (u16*)&OC2RS; break;
-            case  7: pOCxCON = (u16*)&OC5CON; pOCxR = (u16*)&OC5R; pOCxRS = (u16*)&OC5RS; break;
-            case  8: pOCxCON = (u16*)&OC1CON; pOCxR = (u16*)&OC1R; pOCxRS = (u16*)&OC1RS; break;
-    
-            ///*********************************************************
-            #elif defined(PIC32_PINGUINO_MICRO)
-            ///*********************************************************
-
-            case 10: pOCxCON = (u16*)&OC2CON; pOCxR = (u16*)&OC2R; pOCxRS = (u16*)&OC2RS; break;
-            case 11: pOCxCON = (u16*)&OC3CON; pOCxR = (u16*)&OC3R; pOCxRS = (u16*)&OC3RS; break;
-            case 12: pOCxCON = (u16*)&OC4CON; pOCxR = (u16*)&OC4R; pOCxRS = (u16*)&OC4RS; break;
-            case 13: pOCxCON = (u16*)&OC5CON; pOCxR = (u16*)&OC5R; pOCxRS = (u16*)&OC5RS; break;
-
-            ///*********************************************************
-            #elif defined(PIC32_PINGUINO) || \
-                  defined(PIC32_PINGUINO_OTG)
-            ///*********************************************************
-
-            case  2: pOCxCON = (u16*)&OC1CON; pOCxR = (u16*)&OC1R; pOCxRS = (u16*)&OC1RS; break;
-            case  1: pOCxCON = (u16*)&OC4CON; pOCxR = (u16*)&OC4R; pOCxRS = (u16*)&OC4RS; break;
-            case  0: pOCxCON = (u16*)&OC3CON; pOCxR = (u16*)&OC3R; pOCxRS = (u16*)&OC3RS; break;
-
-            ///*********************************************************
-            #elif defined(EMPEROR460) || \
-                  defined(EMPEROR795)
-            ///*********************************************************
+        Audio_attach(pin);
+        Audio_noteOn(0, freq1, duration);
+        Audio_noteOn(1, freq2, duration);
+        Audio_render();
 
-            case  0:
-            case 72: pOCxCON = (u16*)&OC1CON; pOCxR = (u16*)&OC1R; pOCxRS = (u16*)&OC1RS; break;
-            case  1:
-            case 69: pOCxCON = (u16*)&OC2CON; pOCxR = (u16*)&OC2R; pOCxRS = (u16*)&OC2RS; break;
-            case  2:
-            case 68: pOCxCON = (u16*)&OC3CON; pOCxR = (u16*)&OC3R; pOCxRS = (u16*)&OC3RS; break;
-            case  3:
-            case 67: pOCxCON = (u16*)&OC4CON; pOCxR = (u16*)&OC4R; pOCxRS = (u16*)&OC4RS; break;
-            case  4:
-            case 66: pOCxCON = (u16*)&OC5CON; pOCxR = (u16*)&OC5R; pOCxRS = (u16*)&OC5RS; break;
-
-            ///*********************************************************
-            #elif defined(UBW32_460) || \
-                  defined(UBW32_795) || \
-                  defined(PIC32_PINGUINO_T795)
-            ///*********************************************************
+        #ifndef __PIC32MX__
+        *pCCPxCON = PWMMODE;
+        pinmode(pin, OUTPUT);   // PWM pin as OUTPUT
+        PIE1bits.TMR2IE = 1;    // enable interrupt
+        #else
+        // PWM On, PWM pin as OUTPUT
+        *pOCxCON = PWMMODE;
+        #endif
 
-            case  0:
-            case 24:
-            case 40: pOCxCON = (u16*)&OC1CON; pOCxR = (u16*)&OC1R; pOCxRS = (u16*)&OC1RS; break;
-            case  1:
-            case  9:
-            case 43: pOCxCON = (u16*)&OC2CON; pOCxR = (u16*)&OC2R; pOCxRS = (u16*)&OC2RS; break;
-            case  2:
-            case  8:
-            case 44: pOCxCON = (u16*)&OC3CON; pOCxR = (u16*)&OC3R; pOCxRS = (u16*)&OC3RS; break;
-            case  3:
-            case  7:
-            case 45: pOCxCON = (u16*)&OC4CON; pOCxR = (u16*)&OC4R; pOCxRS = (u16*)&OC4RS; break;
-            case  4:
-            case 25:
-            case 60: pOCxCON = (u16*)&OC5CON; pOCxR = (u16*)&OC5R; pOCxRS = (u16*)&OC5RS; break;
+        Audio_play();
+    }
 
-            ///*********************************************************
-            #elif defined(__16F1459)
-            ///*********************************************************
-            
-            case PWM1 : pCCPxCON = &PWM1CON;  pCCPRxL = &PWM1DCL;  break;
-            case PWM2 : pCCPxCON = &PWM2CON;  pCCPRxL = &PWM2DCL;  break;
+/*  --------------------------------------------------------------------
+    Audio_DTMF
+    --------------------------------------------------------------------
+    Play the dual-tone of a telephone keypad key
+    @param pin:         pin number where buzzer or loudspeaker is connected
+    @param key:         '0'..'9', '*', '#', 'A'..'D'
+    @param duration:    Duration in ms
+    ------------------------------------------------------------------*/
 
-            ///*********************************************************
-            #elif defined(__18f26j53) || defined(__18f46j53) || \
-                  defined(__18f27j53) || defined(__18f47j53)
-            ///*********************************************************
+    void Audio_DTMF(u8 pin, u8 key, u32 duration)
+    {
+        u8 i;
 
+        for (i = 0; i < 16; i++)
+            if (gDTMFKeys[i] == key)
+                Audio_dualTone(pin, gDTMFRow[i >> 2], gDTMFCol[i & 3], duration);
+    }
 
-            case PWM1 : pCCPxCON = &CCP4CON;  pCCPRxL = &CCPR4L;  break;
-            case PWM2 : pCCPxCON = &CCP5CON;  pCCPRxL = &CCPR5L;  break;
-            case PWM3 : pCCPxCON = &CCP6CON;  pCCPRxL = &CCPR6L;  break;
-            case PWM4 : pCCPxCON = &CCP7CON;  pCCPRxL = &CCPR7L;  break;
-            case PWM5 : pCCPxCON = &CCP8CON;  pCCPRxL = &CCPR8L;  break;
-            case PWM6 : pCCPxCON = &CCP9CON;  pCCPRxL = &CCPR9L;  break;
-            case PWM7 : pCCPxCON = &CCP10CON; pCCPRxL = &CCPR10L; break;
+    #endif // AUDIODTMF
 
-            ///*********************************************************
-            #else
-            ///*********************************************************
+/*  --------------------------------------------------------------------
+    Audio_playWav
+    --------------------------------------------------------------------
+    Stream a PCM WAV file from the SD card
+    The file is mixed with the voices by Audio_render(), the sample
+    rate of the engine is changed to the one of the file.
+    @param pin:         pin number where buzzer or loudspeaker is connected
+    @param spi:         spi module where the SD card is connected
+    @param filename:    path + name of the file (ex : snd/intro.wav)
+    @return:            true if the file could be started
+    ------------------------------------------------------------------*/
 
-            case PWM1 : pCCPxCON = &CCP1CON;  pCCPRxL = &CCPR1L;  break;
-            case PWM2 : pCCPxCON = &CCP2CON;  pCCPRxL = &CCPR2L;  break;
+    #ifdef AUDIOWAV
 
-            #endif
+    u8 Audio_playWav(u8 pin, u8 spi, const char *filename)
+    {
+        Wav_File_Header hdr;
+        u16 br;
+
+        if (f_open(spi, &gAudioWavFile, filename, FA_READ) != FR_OK)
+            return false;
+
+        // canonical 44-byte header only (no extra chunk before "data")
+        if (f_read(spi, &gAudioWavFile, &hdr, sizeof(hdr), &br) != FR_OK ||
+            br != sizeof(hdr)                       ||
+            memcmp(hdr.RIFF, "RIFF", 4)             ||
+            memcmp(hdr.WAVE, "WAVE", 4)             ||
+            memcmp(hdr.Subchunk2ID, "data", 4)      ||
+            hdr.AudioFormat != 1                    ||
+            hdr.NumOfChan < 1 || hdr.NumOfChan > 2  ||
+            (hdr.bitsPerSample != 8 && hdr.bitsPerSample != 16))
+        {
+            f_close(spi, &gAudioWavFile);
+            return false;
         }
 
-        // 16-bit accumulator's increment value.
-        // the accumulator will go back to zero after (gSampleRate/freq) ticks
-        gPhase = 0;
-        // 16-bit accumulator's increment value = 65536 / (gSampleRate/freq)
-        gFreq1Inc = 65536 * freq1 / gSampleRate;
-        gFreq2Inc = 65536 * freq2 / gSampleRate;
+        if (hdr.SamplesPerSec != gSampleRate)
+            Audio_init(hdr.SamplesPerSec);
 
-        #ifndef __PIC32MX__
-        *pCCPxCON = PWMMODE;
-        pinmode(pin, OUTPUT);   // PWM pin as OUTPUT
-        PIE1bits.TMR2IE = 1;    // enable interrupt
-        #else
-        // PWM On, PWM pin as OUTPUT
-        //IntEnable(_TIMER_2_IRQ);  // Enable TIMER2 interrupt
+        gAudioWavSpi      = spi;
+        gAudioWavBits     = hdr.bitsPerSample;
+        gAudioWavChannels = hdr.NumOfChan;
+        gAudioWavRemain   = hdr.Subchunk2Size;
+
+        Audio_attach(pin);
+        Audio_render();
         *pOCxCON = PWMMODE;
-	#endif
 
-        Delayms(duration);
-        
-        if (gStaccato)
-            #ifndef __PIC32MX__
-            *pCCPxCON = 0;      // staccato
-            #else
-            *pOCxCON = 0;      // staccato
-	    #endif
+        return true;
     }
 
-    #endif // AUDIODTMF
+    #define Audio_isPlayingWav()    (gAudioWavRemain != 0)
+
+    #endif // AUDIOWAV
 
 /*  --------------------------------------------------------------------
     Audio_noTone
@@ -504,16 +829,14 @@
 
     void Audio_noTone(u8 pin)
     {
+        u8 i;
+
         // We don't stop TIMER2 interrupt here
         // because user can use more than one PWM at a time
-        /*
-	#ifndef __PIC32MX__
-        pinmode(pin, INPUT);    // PWM pin as INPUT
-        PIE1bits.TMR2IE = 0;    // disable interrupt 
-        #else
-        IntDisable(_TIMER_2_IRQ); // Disable TIMER2 interrupt
-        #endif
-        */
+        for (i = 0; i < AUDIOVOICES; i++)
+            gAudioVoice[i].state = AUDIO_OFF;
+        gAudioHead = gAudioTail;
+
         TMR2  = 0;
 
         switch (pin)            // PWM mode disable
@@ -657,31 +980,31 @@
 
     The TyIF interrupt flag is asserted at each PWM period boundary.
 
-    The new PWM value must be computed in less than the PWM cycle gPeriodPlus1.
+    The new PWM value must be loaded in less than the PWM cycle gPeriodPlus1.
     If sample rate = CDQUALITY    -> Tpwm =  22 us (1/44100 sec.)
     If sample rate = TAPEQUALITY  -> Tpwm =  45 us
     If sample rate = RADIOQUALITY -> Tpwm =  90 us
     If sample rate = TELQUALITY   -> Tpwm = 113 us
 
-    To generate a single clean tone we load the duty cycle register
-    according to a pure sinusoid
+    All the samples are computed in advance by Audio_render() so the
+    ISR only pops the next duty cycle from the ring buffer. On underrun
+    the previous duty cycle is kept.
     ------------------------------------------------------------------*/
 
 void Timer2Interrupt(void)
 {
+    u16 tail = gAudioTail;
+
     // Enable interrupt again
-    //IntClearFlag(_TIMER_2_IRQ);
     IFS0CLR = 1 << _TIMER_2_IRQ;
 
-    // Increment the 16-bit phase accumulator
-    // It will automatically goes back to zero once it reaches 0xFFFF
-    gPhase += gFreq1Inc;
-    
-    // Generates a new PWM output
-    //*pOCxCON = 0;           // PWM Off
-    //*pOCxR  = sine64[ gPhase & 0x3F ] * gPeriodPlus1 / 100;
-    *pOCxRS = sine64[ gPhase & 0x3F ] * gPeriodPlus1 / 100;
-    //*pOCxCON = PWMMODE;     // PWM On
+    if (tail != gAudioHead)
+    {
+        *pOCxRS = gAudioBuffer[tail];
+        gAudioTail = (tail + 1) & (AUDIOBUFFERSIZE - 1);
+    }
+    else
+        gAudioUnderrun++;
 }
 
 #endif // __AUDIO_C
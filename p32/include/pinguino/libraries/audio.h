@@ -51,6 +51,25 @@
     #define RADIOQUALITY    11025
     #define TELQUALITY      8820
 
+    // Engine
+    #ifndef AUDIOVOICES
+    #define AUDIOVOICES     4           // nb of simultaneous voices
+    #endif
+    #ifndef AUDIOBUFFERSIZE
+    #define AUDIOBUFFERSIZE 512         // ring buffer size (power of 2)
+    #endif
+    #define AUDIOCHUNK      32          // samples mixed per Audio_mix call
+    //#define AUDIOINTERPOLATE          // linear interpolation of wavetables
+    #define AUDIOTABLEBITS  16          // largest wavetable is 2^16 samples
+
+    // Envelope states
+    #define AUDIO_OFF       0
+    #define AUDIO_ATTACK    1
+    #define AUDIO_DECAY     2
+    #define AUDIO_SUSTAIN   3
+    #define AUDIO_RELEASE   4
+    #define AUDIO_ENVMAX    0x10000     // full level (Q16)
+
     // Notes
     #define NOTE_B0  31
     #define NOTE_C1  33                 // 1rst octave
@@ -171,5 +190,26 @@
             u32         Subchunk2Size;  // Sampled data length
     } Wav_File_Header;
 
+    // Voice
+    typedef struct
+    {
+            const s16  *table;          // one period of the waveform (Q15)
+            u8          shift;          // 32 - log2(table size)
+            u16         mask;           // table size - 1
+            u32         phase;          // 32-bit phase accumulator
+            u32         inc;            // 2^32 * freq / sample rate
+            u32         remain;         // nb of samples before the release
+            u8          state;          // AUDIO_OFF, AUDIO_ATTACK, ...
+            u8          volume;         // 0 .. 255
+            u32         env;            // current level (Q16)
+            u32         astep;          // attack increment per sample
+            u32         dstep;          // decay decrement per sample
+            u32         rstep;          // release decrement per sample
+            u32         sustain;        // sustain level (Q16)
+            u16         attack;         // attack time (ms)
+            u16         decay;          // decay time (ms)
+            u16         release;        // release time (ms)
+    } audio_voice_t;
+
 #endif // __AUDIO_H
 
@@ -4,7 +4,9 @@
     PURPOSE:		BGB203 basic functions
     PROGRAMER:		regis blabnchot <rblanchot@gmail.com>
     FIRST RELEASE:	28 Oct. 2011
-    LAST RELEASE:	07 Oct. 2015
+    LAST RELEASE:	19 Oct. 2026
+    ----------------------------------------------------------------------------
+    19 Oct. 2026 - responses are read into a static buffer (no more malloc)
     ----------------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -30,7 +32,6 @@
 #define SERIALPRINTFLOAT
 #define SERIALPRINTF
 
-#include <stdlib.h>				// malloc, ...
 #include <stdarg.h>				// variable args
 #include <string.h>				// strlen, ...
 #include <typedef.h>			// u8, u32, ... definitions
@@ -42,6 +43,13 @@
 
 #define BT_DELAY		10		// Delay (ms) before sending a new command to the BT module
 #define CRLF			"/r/n"	// <CR><LF>
+#ifndef BT_BUFFERSIZE
+#define BT_BUFFERSIZE	128		// max. length of a module response
+#endif
+
+// BT_RESPONSE fields point into this buffer, they are valid until the
+// next BT_getResponse call
+u8 BT_buffer[BT_BUFFERSIZE];
 
 // BT return codes
 typedef enum
@@ -74,7 +82,7 @@ u8 *BT_getBuffer(u8 uart_port, u8 *buffer)
     do {
         c = SerialRead(uart_port);			// return 255 (-1) if no reception
         if (c != 255) buffer[i++] = c;
-    } while (c != 255);// && (i < 80) );
+    } while ((c != 255) && (i < BT_BUFFERSIZE - 1));
     // C string must be null-terminated
     //BT_BUFFER[i] = '\0';
     buffer[i] = '\0';
@@ -113,11 +121,10 @@ BT_STATUS BT_getStatusCode(u8 * status)
 BT_RESPONSE BT_getResponse(u8 uart_port)
 {
     BT_RESPONSE response;
-    //u8 *buffer;
-    u8 *buffer = (u8*) malloc(128);
+    u8 *buffer;
 
     // get a complete response from the module
-    buffer = BT_getBuffer(uart_port, buffer);
+    buffer = BT_getBuffer(uart_port, BT_buffer);
     //CDCprintf("buffer=[%s]", buffer);
 
     response.command = NULL;
@@ -289,7 +296,7 @@ BT_RESPONSE BT_setAutoConnection(u8 uart_port)
 BT_RESPONSE BT_setUARTSpeed(u8 uart_port, u32 baud_rate)
 {
     //char *string = NULL;
-    char string[6];
+    char string[11];                    // up to 10 digits + '\0'
 
     // Change UART settings (baud rate, data bits, stop bits, parity, stop bits, flow control)
     // Enable RTS/CTS, DTR/DSR Flow control
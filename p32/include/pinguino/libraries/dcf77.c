@@ -5,16 +5,21 @@
     PROGRAMMER:	    Henk van Beek hgmvanbeek@gmail.com
     ----------------------------------------------------------------------------
     CHANGELOG
-    * 20 mar. 2012 - H. van Beek - First release	
+    * 20 mar. 2012 - H. van Beek - First release
     * 29 jun. 2012 - R. Blanchot - Adapted for 8-bit Pinguino
     * 30 jun. 2012 - R. Blanchot - Changed Timer1 for Timer3 to avoid conflict
                                    when used in combination with internal RTCC module
     * 20 Feb. 2015 - R. Blanchot - Modified the Timer1 interrupt
     * 03 Mar. 2015 - R. Blanchot - Added support to all Periph. freq.
+    * 19 Oct. 2026 - Edge timestamp decoder, no more sampling timer
+                   - pulses classified with a dead band, glitches ignored
+                   - phase locked on the second marks
+                   - a minute is accepted after parity, range and
+                     previous frame checks
+                   - RTCC set on each accepted minute (DCF77.startRTCC)
+                   - external interrupt through intx.c
+                   - a glitch after the end of a pulse doesn't widen it
 
-    ----------------------------------------------------------------------------
-    TODO :
-    * load RTCC with DCF77 Time and Date
     ----------------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -30,12 +35,35 @@
     License along with this library; if not, write to the Free Software
     Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
     ----------------------------------------------------------------------------
-    Based on a Timer ISR which interrupts every 20 ms a clock/date record
-    "RTClock" is keeping time, day of the week and date.
-    When for a full minute a signal is received from the dcf77 module,
-    without errors, kept in a identical record "DCF77", the record "RTClock"
-    is updated.
-    The pulsetrain of 59 bits is buffered into Buff1 and Buff2.
+    The DCF77 module output goes high at the start of each second for
+    100 ms (bit 0) or 200 ms (bit 1). There is no pulse at second 59,
+    so the 2 s gap marks the start of the next minute.
+
+    The output is wired to an external interrupt (INT0..INT4 on PIC32,
+    INT0..INT2 on PIC18F), shared with the other libraries through
+    intx.c. The interrupt fires on each edge and gives DCF77_edge() the
+    new level and a time stamp in ms. Nothing is sampled periodically.
+
+    DCF77_edge() doesn't touch any register and can be fed with recorded
+    edges on a host :
+    * a rising edge is a second mark only if it comes 1 s (or 2 s) after
+      the previous one, +/- DCF77_JITTER ms. Any other rising edge is a
+      glitch and is ignored.
+    * the pulse width is the time from the second mark to the last
+      falling edge in the next DCF77_WINDOW ms, so a short drop out
+      inside a pulse doesn't split it. Once the line has been low for
+      DCF77_DROPOUT ms the pulse is over, a later glitch in the window
+      doesn't widen it.
+    * widths between DCF77_ZEROMAX and DCF77_ONEMIN (or out of range)
+      give an unknown bit rather than a guess.
+    * a minute is accepted when its 59 bits are all known, markers,
+      parities and BCD ranges are right, and it is the minute after the
+      previous decoded frame.
+
+    The "RTClock" record then follows the accepted minutes and is
+    incremented at each second mark. On chips with a RTCC module (all
+    PIC32, PIC18FxxJ5x) DCF77_startRTCC() also sets the RTCC at the start
+    of each accepted minute, so it keeps time when the signal is lost.
    --------------------------------------------------------------------------*/
 
 #ifndef _DCF77_C_
@@ -48,14 +76,39 @@
 #include <dcf77.h>
 #include <bcd.c>
 
+#include <intx.c>               // IntxAttach
+
 #ifndef __PIC32MX__
-#include <digitalp.c>           // pinMode
-#include <digitalr.c>           // digitalread
+#include <compiler.h>
 #include <interrupt.h>
+#ifndef __MILLIS__
+#define __MILLIS__              // main.c starts the millis timer
+#endif
+#include <millis.c>             // time stamps
 #else
-#include <digitalw.c>           // pinMode, digitalread
-#include <interrupt.c>
-#include <system.c>             // getPeripheralClock
+#include <system.c>             // GetSystemClock
+#include <mips.h>               // ReadCoreTimer
+#endif
+
+/*
+ * DCF77.startRTCC() : the RTCC is set on each accepted minute
+ * The sketch has to start the RTCC (and its 32 kHz crystal) first.
+ */
+
+#if defined(DCF77RTCC)
+    #if !defined(__PIC32MX__) && \
+        !defined(__18f26j50) && !defined(__18f46j50) && \
+        !defined(__18f27j53) && !defined(__18f47j53)
+    #error "Your Pinguino doesn't have a RTCC module"
+    #endif
+    #ifndef __PIC32MX__
+    #define RTCCSETTIME
+    #define RTCCSETDATE
+    #define RTCCSETTIMEDATE
+    #include <rtcc1.c>
+    #else
+    #include <rtcc.c>
+    #endif
 #endif
 
 #ifdef DCF77_DEBUG                    // NB: Turn debugging on or off from the IDE
@@ -63,74 +116,52 @@
     #include <debug.c>
 #endif
 
-/*
-    Timer Configuration
-    ex. 1 tick every TMR_OVERLOAD = 20ms
-    The timer clock prescale (TCKPS) is 1:8
-    The TMR Count register increments on every FOSC/4 cycle
-    FOSC/4 = 48/4 = 12 MHz => TMR inc. every 8*1/12 MHZ = 2/3 us
-    20 ms = 20.000 us => 20.000 / (2 / 3) = 20 * 1500 = 30.000 cycles = 0x7530
-*/
-
-#define TMR_OVERLOAD  20          // max. 43 ms
-#define TMR_PRELOAD   (TMR_OVERLOAD * 1500)
-#define TMR_PRELOADH  high8(TMR_PRELOAD)
-#define TMR_PRELOADL   low8(TMR_PRELOAD)
-#define TMR_ONESEC    ((1000/TMR_OVERLOAD) - 1)
-
 /*******************************************************************************
-* if a puls is longer than 150 ms it is a "1", otherwise it is a "0".
+* Pulse classification (ms)
 *******************************************************************************/
 
-#define DCF_Discr_150ms (150 / TMR_OVERLOAD)
-
-/*******************************************************************************
- * if during 1500 ms no puls has arrived means a start of a new pulstrain.
-*******************************************************************************/
+#define DCF77_MINPULSE  40      // shorter pulses are glitches
+#define DCF77_ZEROMAX   140     // nominal 100 ms
+#define DCF77_ONEMIN    160     // nominal 200 ms
+#define DCF77_ONEMAX    260
+#define DCF77_WINDOW    300     // falling edges later than this are glitches
+#define DCF77_DROPOUT   30      // longer lows end the pulse
+#define DCF77_JITTER    60      // tolerance on the second marks
 
-#define DCF_Sync_1500ms (1500 / TMR_OVERLOAD)
+#define DCF77_UNKNOWN   0xFF    // bit or bit position unknown
 
 /*******************************************************************************
 * Global variables
 *******************************************************************************/
 
-u8  SignalPin, PrevSignal, BuffPntr, Nosync;
-volatile u8 Cntr_sec;
-u16 PrevFlank;
-u32 Buff1, Buff2;
-volatile u32 Cntr_tmr;
+u8  Nosync;
+u32 Buff1, Buff2;               // bits 0 to 31, 32 to 58
+u32 Err1, Err2;                 // unknown bits
 
-/*******************************************************************************
- * Appends a received bit at the DCF code chain
- * signal : 0 or 1
- ******************************************************************************/
+u32 gDCF77Mark;                 // time of the last second mark
+u16 gDCF77Width;                // width of the current pulse, 0 if none
+u8  gDCF77Ended;                // the pulse is over, later falls are glitches
+u8  gDCF77Bit;                  // next bit, DCF77_UNKNOWN before a minute mark
+u8  gDCF77Locked;               // second marks in phase
+u8  gDCF77Valid;                // gDCF77Prev holds a decoded frame
+volatile u8 gDCF77New;          // a minute has been accepted
+u8  gDCF77RTCC;                 // set the RTCC on each accepted minute
+Time_Date_Format gDCF77Prev;    // last decoded frame
 
-void DCF77_appendSignal(u8 signal)
-{
-    /*
-    //serial1printf("BuffPntr: %02d  ", BuffPntr);
-    if ((signal > 0) && (BuffPntr < 32))
-        Buff1 = Buff1 | (1 << BuffPntr);
-        
-    if ((signal > 0) && (BuffPntr > 31))
-        Buff2 = Buff2 | (1 << (BuffPntr - 32));
-    //serial1printf("Append Buff: %08x %08x  \r\n", DCF77.Buff1, DCF77.Buff2);
-    */
-
-    if (signal)
-    {
-        if (BuffPntr < 32) Buff1 = Buff1 | (1 << BuffPntr);
-        if (BuffPntr > 31) Buff2 = Buff2 | (1 << (BuffPntr - 32));
-    }
-    
-    BuffPntr++;
+/***********************************************************************
+* Copies a record (SDCC can't assign structures)
+***********************************************************************/
 
-    if (BuffPntr > 59)
-    {
-        BuffPntr = 0;
-        Buff1 	 = 0;
-        Buff2 	 = 0;
-    }
+void DCF77_copy(Time_Date_Format *dst, Time_Date_Format *src)
+{
+    dst->seconds    = src->seconds;
+    dst->minutes    = src->minutes;
+    dst->hours      = src->hours;
+    dst->dayofweek  = src->dayofweek;
+    dst->dayofmonth = src->dayofmonth;
+    dst->month      = src->month;
+    dst->year       = src->year;
+    dst->nosync     = src->nosync;
 }
 
 /***********************************************************************
@@ -139,150 +170,230 @@ void DCF77_appendSignal(u8 signal)
 
 u8 Parity_Even (u32 Bits)
 {
-    u8 i, p = 0;
+    u8 p = 0;
 
-    for (i = 0; i < 32; i++)
-        if ((Bits & (1 << i)) > 0)
-            p = !p;
+    while (Bits)
+    {
+        p ^= (u8)Bits & 1;
+        Bits >>= 1;
+    }
 
     return p;
 }
 
 /***********************************************************************
- * Decodes DCF code after the 59 minute gap
- **********************************************************************/
- 
-void Decode_Buffer(void)
+* BCD field to binary, DCF77_UNKNOWN if it isn't a valid BCD number
+* between min and max
+***********************************************************************/
+
+u8 DCF77_bcd(u32 Code, u8 min, u8 max)
 {
-    u32 Code;
-    u8  Par, Par1, Par2, Par3;
+    u8 v = (u8)Code;
 
-    //Disp_Input_Binary(Buff1, Buff2);
+    if ((v & 0x0F) > 9)
+        return DCF77_UNKNOWN;
 
-    if (BuffPntr == 59)
-    {
-        // Minutes
-        Code = (Buff1 >> 21) & 0x7F;
-        Par  = Parity_Even(Code);
-        Par1 = (Buff1 >> 28) & 1;
-        //serial1printf("Par= %d Par1= %d\r\n", Par, Par1);
-        if (Par == Par1)
-        {
-            Par1 = 11;
-            DCF77.minutes = bcd2bin(Code);
-            //serial1printf("mm= %02d \r\n", DCF77.mm);
-        }
+    v = bcd2bin(v);
 
-        // Hours
-        Code = ((Buff1 >> 29) & 0x7) | ((Buff2 & 0x7) << 3);
-        Par = Parity_Even(Code);
-        Par2 = (Buff2 >> 3) & 1;
-        //serial1printf("Par= %d Par2= %d\r\n", Par, Par2);
-        if (Par == Par2)
-        {
-            Par2 = 12;
-            DCF77.hours = bcd2bin(Code);
-            //serial1printf("hh= %02d \r\n", DCF77.hh);
-        }
+    if (v < min || v > max)
+        return DCF77_UNKNOWN;
 
-        Code = (Buff2 >> 4) & 0x3FFFFF;
-        Par = Parity_Even(Code);
-        Par3 = (Buff2 >> 26) & 1;
-        //serial1printf("Par= %d Par3= %d\r\n", Par, Par3);
-        if (Par == Par3)
-        {
-            Par3 = 13;
-            Code = (Buff2 >> 10) & 0x7;
-            DCF77.dayofweek = bcd2bin(Code);
-            //serial1printf("dw= %02d \r\n", DCF77.dw);
-
-            Code = (Buff2 >> 4) & 0x3F;
-            DCF77.dayofmonth = bcd2bin(Code);
-            //serial1printf("da= %02d \r\n", DCF77.da);
-
-            Code = (Buff2 >> 13) & 0x1F;
-            DCF77.month = bcd2bin(Code);
-            //serial1printf("mo= %02d \r\n", DCF77.mo);
-
-            Code = (Buff2 >> 18) & 0xFF;
-            DCF77.year = bcd2bin(Code);
-            //serial1printf("yr= %02d \r\n", DCF77.yr);
-        }
-        //Part = Par1 + Par2 + Par3;
-        //serial1printf("Part= %d\r\n", Part);
-        if (Par1 + Par2 + Par3 == 36)
-        {
-            DCF77.seconds = 0;
-            Nosync   = 0;
-            //serial1printf("Tim=  %d:%02d \r\n", DCF77.hh, DCF77.mm);
-            //serial1printf("Dat=: %02d-%02d-%02d  %1d\r\n", DCF77.da, DCF77.mo, DCF77.yr, DCF77.dw);
-
-            #ifndef __PIC32MX__
-            RTClock.seconds = DCF77.seconds;
-            RTClock.minutes = DCF77.minutes;
-            RTClock.hours = DCF77.hours;
-            RTClock.dayofweek = DCF77.dayofweek;
-            RTClock.dayofmonth = DCF77.dayofmonth;
-            RTClock.month = DCF77.month;
-            RTClock.year = DCF77.year;
-            RTClock.nosync = DCF77.nosync;		// nosync shows minutes
-            #else
-            RTClock = DCF77;
-            #endif
-        }
-    }
-    
-    // Reset Inputbuffer
-    BuffPntr    = 0;
-    Buff1 		= 0;
-    Buff2 		= 0;
+    return v;
+}
+
+/***********************************************************************
+* Next minute of a record
+***********************************************************************/
+
+void DCF77_nextMinute(Time_Date_Format *t)
+{
+    const u8 Mnth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    u8 last;
+
+    if (++t->minutes < 60)
+        return;
+    t->minutes = 0;
+
+    if (++t->hours < 24)
+        return;
+    t->hours = 0;
+
+    if (++t->dayofweek > 7)
+        t->dayofweek = 1;
+
+    last = Mnth[t->month - 1];
+    if (t->month == 2 && (t->year & 3) == 0)
+        last = 29;
+
+    if (++t->dayofmonth <= last)
+        return;
+    t->dayofmonth = 1;
+
+    if (++t->month <= 12)
+        return;
+    t->month = 1;
+
+    if (++t->year > 99)
+        t->year = 0;
+}
+
+/***********************************************************************
+* Same minute in both records
+***********************************************************************/
+
+u8 DCF77_sameMinute(Time_Date_Format *a, Time_Date_Format *b)
+{
+    return a->minutes    == b->minutes    &&
+           a->hours      == b->hours      &&
+           a->dayofweek  == b->dayofweek  &&
+           a->dayofmonth == b->dayofmonth &&
+           a->month      == b->month      &&
+           a->year       == b->year;
 }
 
 /***********************************************************************
- * Called every 20 ms by ISR
- * Builds DCF code by calling DCF77_appendsignal
+* Loads the RTCC with the minute which has just started
+***********************************************************************/
+
+#if defined(DCF77RTCC)
+void DCF77_syncRTCC(void)
+{
+    rtccTime t;
+    rtccDate d;
+
+    t.l = 0;
+    t.seconds    = 0;
+    t.minutes    = bin2bcd(DCF77.minutes);
+    t.hours      = bin2bcd(DCF77.hours);
+
+    d.dayofweek  = bin2bcd(DCF77.dayofweek % 7);   // RTCC sunday is 0
+    d.dayofmonth = bin2bcd(DCF77.dayofmonth);
+    d.month      = bin2bcd(DCF77.month);
+    d.year       = bin2bcd(DCF77.year);
+
+    if (gDCF77RTCC)
+        RTCC_SetTimeDate(t.l, d.l);
+}
+#else
+#define DCF77_syncRTCC()
+#endif
+
+/***********************************************************************
+ * Decodes the 59 bits received, called at the minute mark
+ * The minute is accepted if it follows the previous decoded frame.
  **********************************************************************/
- 
-void DCF77_scanSignal(void)
+
+void DCF77_decode(void)
 {
-    u16 LengthPulse;
-    u16 CurrFlank;
-    u8  CurrSignal;
+    Time_Date_Format t;
+    u8 known = gDCF77Valid;
+
+    // the previous frame is one minute older now
+    if (known)
+        DCF77_nextMinute(&gDCF77Prev);
+
+    if (gDCF77Bit != 59 || Err1 || Err2)
+        return;
+
+    // start of minute always 0, start of time always 1
+    if ((Buff1 & 1) || !(Buff1 & (1UL << 20)))
+        return;
+
+    // minutes + P1, hours + P2, date + P3
+    if (Parity_Even((Buff1 >> 21) & 0xFF) ||
+        Parity_Even(((Buff1 >> 29) & 0x7) | ((Buff2 & 0xF) << 3)) ||
+        Parity_Even((Buff2 >> 4) & 0x7FFFFF))
+        return;
+
+    t.seconds    = 0;
+    t.nosync     = 0;
+    t.minutes    = DCF77_bcd((Buff1 >> 21) & 0x7F, 0, 59);
+    t.hours      = DCF77_bcd(((Buff1 >> 29) & 0x7) | ((Buff2 & 0x7) << 3), 0, 23);
+    t.dayofmonth = DCF77_bcd((Buff2 >>  4) & 0x3F, 1, 31);
+    t.dayofweek  = DCF77_bcd((Buff2 >> 10) & 0x07, 1, 7);
+    t.month      = DCF77_bcd((Buff2 >> 13) & 0x1F, 1, 12);
+    t.year       = DCF77_bcd((Buff2 >> 18) & 0xFF, 0, 99);
+
+    if (t.minutes == DCF77_UNKNOWN || t.hours == DCF77_UNKNOWN ||
+        t.dayofmonth == DCF77_UNKNOWN || t.dayofweek == DCF77_UNKNOWN ||
+        t.month == DCF77_UNKNOWN || t.year == DCF77_UNKNOWN)
+        return;
+
+    // a single frame could still be wrong in an even number of bits
+    known = known && DCF77_sameMinute(&t, &gDCF77Prev);
+
+    DCF77_copy(&gDCF77Prev, &t);
+    gDCF77Valid = 1;
+
+    if (!known)
+        return;
+
+    DCF77_copy(&DCF77, &t);
+    DCF77_copy(&RTClock, &t);
+    Nosync = 0;
+    gDCF77New = 1;
+    DCF77_syncRTCC();
+}
 
-    CurrSignal = digitalread(SignalPin);
-    if (CurrSignal != PrevSignal)
+/***********************************************************************
+ * Appends a received bit at the DCF code chain
+ * signal : 0, 1 or DCF77_UNKNOWN
+ ******************************************************************************/
+
+void DCF77_appendSignal(u8 signal)
+{
+    u32 mask;
+
+    if (gDCF77Bit >= 59)
     {
-        if (CurrSignal == 1)
-        {
-            //digitalwrite(USERLED, HIGH);
-            /* At a raising flank */
-            CurrFlank = Cntr_tmr;
-            if ((CurrFlank - PrevFlank) > DCF_Sync_1500ms)
-                Decode_Buffer();
-            PrevFlank = CurrFlank;
-        }
-        else
-        {
-            //digitalwrite(USERLED, LOW);
-            /* At a falling flank */
-            LengthPulse = Cntr_tmr - PrevFlank;
-            if (LengthPulse < DCF_Discr_150ms)
-                DCF77_appendSignal(0);
-            else
-                DCF77_appendSignal(1);
-        }
-        PrevSignal = CurrSignal;
+        // no minute mark where it should be
+        gDCF77Bit = DCF77_UNKNOWN;
+        return;
+    }
+
+    if (gDCF77Bit < 32)
+        mask = 1UL << gDCF77Bit;
+    else
+        mask = 1UL << (gDCF77Bit - 32);
+
+    if (signal == 1)
+    {
+        if (gDCF77Bit < 32) Buff1 |= mask;
+        else                Buff2 |= mask;
     }
+
+    else if (signal == DCF77_UNKNOWN)
+    {
+        if (gDCF77Bit < 32) Err1 |= mask;
+        else                Err2 |= mask;
+    }
+
+    gDCF77Bit++;
 }
 
 /***********************************************************************
-* Update Time/Date record (every second by ISR)
+ * Bit carried by a pulse
+ **********************************************************************/
+
+u8 DCF77_classify(u16 width)
+{
+    if (width < DCF77_MINPULSE)
+        return DCF77_UNKNOWN;
+    if (width <= DCF77_ZEROMAX)
+        return 0;
+    if (width < DCF77_ONEMIN)
+        return DCF77_UNKNOWN;
+    if (width <= DCF77_ONEMAX)
+        return 1;
+    return DCF77_UNKNOWN;
+}
+
+/***********************************************************************
+* Update Time/Date record (every second)
 ***********************************************************************/
 
 void Update_Time (void)
 {
-    const u8 Mnth[12] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-
     if (RTClock.seconds == 0)
         RTClock.nosync = Nosync;
 
@@ -290,133 +401,235 @@ void Update_Time (void)
 
     if (RTClock.seconds > 59)
     {
-        Nosync++;
+        if (Nosync < 255)
+            Nosync++;
         RTClock.seconds = 0;
+        DCF77_nextMinute(&RTClock);
+    }
+}
+
+/***********************************************************************
+ * Called on each edge of the DCF77 signal
+ * level : level after the edge
+ * ms    : time stamp in ms, only differences are used
+ **********************************************************************/
 
-        RTClock.minutes++;							// Minutes
-        if (RTClock.minutes > 59)
+void DCF77_edge(u8 level, u32 ms)
+{
+    u32 gap = ms - gDCF77Mark;
+    u8  seconds;
+
+    if (!level)
+    {
+        // end of pulse
+        if (gap <= DCF77_WINDOW && !gDCF77Ended)
+            gDCF77Width = (u16)gap;
+        return;
+    }
+
+    if (gap < 1000 - DCF77_JITTER)
+    {
+        // glitch, after a drop out the pulse goes on
+        if (gDCF77Width && gap - gDCF77Width >= DCF77_DROPOUT)
+            gDCF77Ended = 1;
+        return;
+    }
+
+    if (gap <= 1000 + DCF77_JITTER)
+        seconds = 1;
+    else if (gap >= 2000 - DCF77_JITTER && gap <= 2000 + DCF77_JITTER)
+        seconds = 2;
+    else
+        seconds = 0;
+
+    gDCF77Mark = ms;
+
+    if (seconds == 0)
+    {
+        // out of phase, wait for the next second mark
+        gDCF77Locked = 0;
+        gDCF77Bit    = DCF77_UNKNOWN;
+        gDCF77Width  = 0;
+        gDCF77Ended  = 0;
+        return;
+    }
+
+    if (gDCF77Locked)
+    {
+        // the pulse which started at the previous mark
+        if (gDCF77Bit != DCF77_UNKNOWN)
+            DCF77_appendSignal(DCF77_classify(gDCF77Width));
+
+        Update_Time();
+
+        if (seconds == 2)
         {
-            RTClock.minutes = 0;
+            // the second without pulse, RTClock is overwritten if the
+            // minute is accepted
+            Update_Time();
 
-            RTClock.hours++;						// Hours
-            if (RTClock.hours > 23)
+            // minute mark if bits 0 to 58 are in, else a missed pulse
+            if (gDCF77Bit == DCF77_UNKNOWN || gDCF77Bit == 59)
             {
-                RTClock.hours = 0;
-
-                RTClock.dayofweek++;				// Day of Week
-                if (RTClock.dayofweek > 7)
-                    RTClock.dayofweek = 1;
-
-                RTClock.dayofmonth++;				// Date
-                if (RTClock.dayofmonth > Mnth[RTClock.month-1])
-                {
-                    RTClock.dayofmonth = 1;
-
-                    RTClock.month++;				// Month
-                    if (RTClock.month > 12)
-                    {
-                        RTClock.month = 1;
-
-                        RTClock.year++;				// Year
-                        if (RTClock.year > 99)
-                            RTClock.year = 0;
-                    }
-                }
+                DCF77_decode();
+                gDCF77Bit = 0;
+                Buff1 = Buff2 = 0;
+                Err1  = Err2  = 0;
             }
+            else
+                DCF77_appendSignal(DCF77_UNKNOWN);
         }
     }
+
+    else if (seconds == 2)
+    {
+        // first minute mark
+        gDCF77Bit = 0;
+        Buff1 = Buff2 = 0;
+        Err1  = Err2  = 0;
+    }
+
+    gDCF77Locked = 1;
+    gDCF77Width  = 0;
+    gDCF77Ended  = 0;
 }
 
 /***********************************************************************
-* Initialize the DCF77 library.
+* Returns 1 once after each accepted minute
+***********************************************************************/
+
+u8 DCF77_available(void)
+{
+    if (gDCF77New)
+    {
+        gDCF77New = 0;
+        return 1;
+    }
+    return 0;
+}
+
+/***********************************************************************
+* Reset the decoder
 ***********************************************************************/
 
-void DCF77_start(u8 dcfPin)
+void DCF77_reset(void)
 {
-    SignalPin  = dcfPin;
-    pinmode(SignalPin, INPUT);
-
-    PrevSignal	= 0;
-    PrevFlank	= 0;
-    BuffPntr	= 0;
-    Buff1		= 0;
-    Buff2		= 0;
-    Nosync		= 1;
-
-    /*  Timer1 Configuration to overload every 20ms
-     *  The timer clock prescale (TCKPS) is set to 1:64
-     *  The TMR1 Count register increments on every PBCLK clock cycle
-     *  20 ms = 20000 us
-     */
-
-    PR1 = 20000 * GetPeripheralClock() / 1000000 / 64;
-    TMR1     = 0;						// clear timer register
-
-    IntConfigureSystem(INT_SYSTEM_CONFIG_MULT_VECTOR);
-    IPC1SET  = 7;						// select interrupt priority and sub-priority
-    IFS0CLR  = 1 << INT_TIMER1_VECTOR;	// clear interrupt flag
-    IEC0SET  = 1 << INT_TIMER1_VECTOR;	// enable timer 1 interrupt
-    T1CON    = 0x8020;					// start timer 1, prescaler 1:64, internal peripheral clock
+    gDCF77Mark   = 0;
+    gDCF77Width  = 0;
+    gDCF77Ended  = 0;
+    gDCF77Bit    = DCF77_UNKNOWN;
+    gDCF77Locked = 0;
+    gDCF77Valid  = 0;
+    gDCF77New    = 0;
+    gDCF77RTCC   = 0;
+    Buff1 = Buff2 = 0;
+    Err1  = Err2  = 0;
+    Nosync = 1;
 }
 
 /*******************************************************************************
-* Timer 1 interrupt (Vector 4)
+* External interrupt
 *******************************************************************************/
-#if 0
-// Put the ISR_wrapper in the good place
-void ISR_wrapper_vector_4(void) __attribute__ ((section (".vector_4")));
 
-// ISR_wrapper will call the DCF77_timer1Interrupt()
-void ISR_wrapper_vector_4(void) { Timer1Interrupt(); }
+u8 gDCF77Line = INTX_LINES;     // external interrupt the module is wired to
 
-// Tmr1Interrupt is declared as an interrupt routine
-void Timer1Interrupt(void) __attribute__ ((interrupt));
-#endif
+#if defined(__PIC32MX__)
+
+u32 gDCF77Ticks;                // core timer at gDCF77Ms
+u32 gDCF77Ms;
+u32 gDCF77Unit;                 // core timer ticks per ms
 
-void Timer1Interrupt()
+/*
+ * ms time stamp from the core timer, which wraps too soon (about 100 s)
+ * to be used directly
+ */
+
+u32 DCF77_millis(void)
 {
-    // is this an TMR1 interrupt ?
-    if (IntGetFlag(INT_TIMER1))
-    {
-        // Update time every second
-        Cntr_tmr++;
-        Cntr_sec++;
+    u32 n = (ReadCoreTimer() - gDCF77Ticks) / gDCF77Unit;
 
-        if (Cntr_sec > TMR_ONESEC)
-        {
-            Cntr_sec = 0;
-            Update_Time();
-        }
+    gDCF77Ticks += n * gDCF77Unit;
+    gDCF77Ms += n;
+    return gDCF77Ms;
+}
 
-        DCF77_scanSignal();
-        IntClearFlag(INT_TIMER1);
-    }
+#else
+
+#define DCF77_millis()          millis()
+
+#endif
+
+/*
+ * intx.c callback, level is the level after the edge
+ */
+
+void DCF77_interrupt(u8 line, u8 level)
+{
+    (void)line;
+    DCF77_edge(level, DCF77_millis());
 }
 
 /***********************************************************************
- * Displays the DCF code chain
- **********************************************************************/
- 
-void Disp_Input_Binary(u32 Bits1, u32 Bits2)
+* Initialize the DCF77 library.
+* line : external interrupt the module is wired to
+*        PIC18F : 0 to 2 (pins 0 to 2 on most boards)
+*        PIC32  : 0 to 4
+*        nothing is received if another library has the line
+***********************************************************************/
+
+void DCF77_start(u8 line)
 {
-    u8 BitC;
+    DCF77_reset();
 
-    serial1printf("Bits= %08x %08x \r\n", Bits1, Bits2);
-    for (BitC = 32; BitC > 0; BitC--)
-    {
-        if ((Bits2 & (1 << (BitC-1))) > 0)
-            serial1write('1');
-        else
-            serial1write('0');
-    }
-    for (BitC = 32; BitC > 0; BitC--)
+    RTClock.seconds = 0;
+    RTClock.minutes = 0;
+    RTClock.hours = 0;
+    RTClock.dayofweek = 1;
+    RTClock.dayofmonth = 1;
+    RTClock.month = 1;
+    RTClock.year = 0;
+    RTClock.nosync = 1;
+
+    // started again : give the previous line back first
+    if (gDCF77Line < INTX_LINES && gIntx[gDCF77Line] == DCF77_interrupt)
+        IntxDetach(gDCF77Line);
+    gDCF77Line = INTX_LINES;
+
+    if (line >= INTX_LINES)
+        return;
+
+    #if defined(__PIC32MX__)
+
+    gDCF77Unit  = GetSystemClock() / 2000;  // core timer runs at SYSCLK/2
+    gDCF77Ticks = ReadCoreTimer();
+    gDCF77Ms    = 0;
+
+    #elif !defined(__16F1459) && !defined(__16F1708)
+
+    switch (line)
     {
-        if ((Bits1 & (1 << (BitC-1))) > 0)
-            serial1write('1');
-        else
-            serial1write('0');
+        case 0: TRISBbits.TRISB0 = INPUT; break;
+        case 1: TRISBbits.TRISB1 = INPUT; break;
+        case 2: TRISBbits.TRISB2 = INPUT; break;
     }
-    serial1println("  ");
+
+    #endif
+
+    // first edge is rising
+    if (IntxAttach(line, DCF77_interrupt, INT_RISING_EDGE))
+        gDCF77Line = line;
+}
+
+/***********************************************************************
+* Same as DCF77_start, the RTCC is also set on each accepted minute
+***********************************************************************/
+
+#if defined(DCF77RTCC)
+void DCF77_startRTCC(u8 line)
+{
+    DCF77_start(line);
+    gDCF77RTCC = 1;
 }
+#endif
 
 #endif
@@ -23,3 +23,9 @@ Time_Date_Format RTClock, DCF77;
 *******************************************************************************/
 
 void DCF77_start(u8);
+void DCF77_edge(u8, u32);
+u8 DCF77_available(void);
+void DCF77_reset(void);
+#if defined(DCF77RTCC)
+void DCF77_startRTCC(u8);
+#endif
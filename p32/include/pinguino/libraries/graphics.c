@@ -10,6 +10,8 @@
     Jan 29 2016 - RB - added drawBitmap (from SD)
     Nov 15 2016 - RB - added drawTriangle, fillTriangle
                        added drawVBarGraph, drawHBarGraph
+    Oct 19 2026 - fillCircle and fillTriangle draw horizontal lines
+                  added GRAPHICSHVLINES
     --------------------------------------------------------------------
     TODO :
     --------------------------------------------------------------------
@@ -63,6 +65,14 @@
 extern void drawPixel(u16, u16);
 extern void setColor(u8, u8, u8);
 
+// Displays which can draw them faster than pixel by pixel
+// (e.g. with raster.c) define GRAPHICSHVLINES and provide them
+#ifdef GRAPHICSHVLINES
+extern void drawVLine(u16, u16, u16);
+extern void drawHLine(u16, u16, u16);
+extern void fillRect(u16, u16, u16, u16);
+#endif
+
 /*  --------------------------------------------------------------------
     Fonctions
     ------------------------------------------------------------------*/
@@ -121,6 +131,7 @@ void drawLine(u16 x0, u16 y0, u16 x1, u16 y1)
     }
 }
 
+#ifndef GRAPHICSHVLINES
 void drawVLine(u16 x, u16 y, u16 h)
 {
     drawLine(x, y, x, y+h-1);
@@ -130,6 +141,7 @@ void drawHLine(u16 x, u16 y, u16 w)
 {
     drawLine(x, y, x+w-1, y);
 }
+#endif
 
 void drawTriangle(u8 x1, u8 y1, u8 x2, u8 y2, u8 x3, u8 y3)
 {
@@ -178,7 +190,7 @@ void fillTriangle(u8 x1, u8 y1, u8 x2, u8 y2, u8 x3, u8 y3)
         sx2= m3*(sl-y1)+x1;
         if(sx1>sx2)
             swap(sx1,sx2);
-        drawLine(sx1, sl, sx2, sl);
+        drawHLine(sx1, sl, sx2-sx1+1);
     }
     
     for(sl=y2;sl<=y3;sl++)
@@ -187,7 +199,7 @@ void fillTriangle(u8 x1, u8 y1, u8 x2, u8 y2, u8 x3, u8 y3)
         sx2= m3*(sl-y1)+x1;
         if(sx1>sx2)
             swap(sx1,sx2);
-        drawLine(sx1, sl, sx2, sl);
+        drawHLine(sx1, sl, sx2-sx1+1);
     }
 }
 
@@ -243,6 +255,7 @@ void drawRoundRect(u16 x1, u16 y1, u16 x2, u16 y2)
     }
 }
 
+#ifndef GRAPHICSHVLINES
 void fillRect(u16 x1, u16 y1, u16 x2, u16 y2)
 {
     u16 tmp, i;
@@ -279,6 +292,7 @@ void fillRect(u16 x1, u16 y1, u16 x2, u16 y2)
         }
     }
 }
+#endif
 
 void fillRoundRect(u16 x1, u16 y1, u16 x2, u16 y2)
 {
@@ -354,13 +368,19 @@ void drawCircle(u16 x, u16 y, u16 radius)
     }
 }
 
+// one horizontal line per row, x1 is the half width of the row y1,
+// drawHLine leaves out its last pixel
 void fillCircle(u16 x, u16 y, u16 radius)
 {
-    s16 x1, y1;
-    for (y1 = -radius; y1 <= radius; y1++) 
-        for (x1 = -radius; x1 <= radius; x1++) 
-            if (x1 * x1 + y1 * y1 <= radius * radius) 
-                drawPixel(x + x1, y + y1);
+    s16 x1 = radius, y1;
+    for (y1 = 0; y1 <= radius; y1++)
+    {
+        while (x1 * x1 + y1 * y1 > radius * radius)
+            x1--;
+        drawHLine(x - x1, y + y1, 2 * x1 + 2);
+        if (y1)
+            drawHLine(x - x1, y - y1, 2 * x1 + 2);
+    }
 }
 
 void drawHBarGraph(u8 x, u8 y, int width, int height, u8 border, int minval, int maxval, int curval)
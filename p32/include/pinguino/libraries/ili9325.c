@@ -6,6 +6,11 @@
     FIRST RELEASE:	1 Apr. 2012
     LAST RELEASE:	7 Dec. 2013
     ----------------------------------------------------------------------------
+    CHANGELOG :
+    19 Oct. 2026 - PIC32 : Parallel Master Port bus, fills, tiles and
+                   bitmaps sent by DMA while the CPU goes on (PMPDMA)
+                 - ILI9325_writeTile(), ILI9325_wait()
+    ----------------------------------------------------------------------------
     TODO : 
     ----------------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
@@ -33,10 +38,238 @@
 #ifndef DISPLAY_FONT
 #include <fonts/font12x8.h>         // default font
 #endif
+#ifdef __PIC32MX__
+#include <delay.c>
+#else
 #include <delayms.c>
+#endif
 #include <graphics.c>
 #include <digitalw.c>
 #include <printFormated.c>
+#ifdef __PMP__
+#include <system.c>                 // GetPeripheralClock
+#include <pmp.c>
+
+u8  _ili9325_waitW;                     // write strobe, Tpb
+u8  _ili9325_waitR;                     // read strobe, Tpb
+u8  _ili9325_tile = 0;                  // GRAM window set to a tile
+u16 _ili9325_buffer[2][ILI9325_CHUNK];  // ILI9325_drawBitmap()
+u8  _ili9325_buf = 0;                   // buffer sent last
+#endif
+
+#ifdef __PMP__
+
+///	--------------------------------------------------------------------
+/// Parallel Master Port bus
+///	--------------------------------------------------------------------
+
+/*	--------------------------------------------------------------------
+    DESCRIPTION:
+        Configure the PMP for the LCD
+    PARAMETERS:
+    RETURNS:
+    REMARKS:
+        i80/8-bit, master mode 2, RS on PMA0, PMADDR is only used
+        to select the register (RS = 0) or the data (RS = 1).
+        The GRAM address counter of the ILI9325 is incremented by the
+        controller itself after each pixel, so a window is written
+        as a flat stream of data, which the DMA channel can send.
+        Write strobe >= 50 ns, read strobe as long as possible.
+    ------------------------------------------------------------------*/
+
+void ILI9325_initBus()
+{
+    _ili9325_waitW = GetPeripheralClock() / 20000000 + 1;
+    _ili9325_waitR = GetPeripheralClock() / 6666666 + 1;
+    if (_ili9325_waitR > 16)
+        _ili9325_waitR = 16;
+
+    PMP_setMode(PMP_MODE_MASTER2);
+    PMP_setWidth(8);
+    PMP_setAddress(RS);
+    PMP_setControl(PMWR | PMRD | CS);
+    PMP_setPolarity(PMP_ACTIVE_LOW);
+    PMP_autoIncrement(0);
+    PMP_setMux(PMP_MUX_OFF);
+    PMP_setWaitStates(1, _ili9325_waitW, 2);
+    PMP_init();
+}
+
+void ILI9325_writeRegister(u16 index)
+{
+    PMP_sendAddress(CS);                // RS = 0
+    PMP_write(index >> 8);
+    PMP_write(index & 0xFF);
+}
+
+void ILI9325_writeData(u16 data15)
+{
+    PMP_sendAddress(CS | RS);           // RS = 1
+    PMP_write(data15 >> 8);
+    PMP_write(data15 & 0xFF);
+}
+
+void ILI9325_write(u16 index, u16 data15)
+{
+    ILI9325_writeRegister(index);
+    ILI9325_writeData(data15);
+}
+
+/*	--------------------------------------------------------------------
+    DESCRIPTION:
+        Read from a register or the GRAM
+    PARAMETERS:
+    RETURNS:
+    REMARKS:
+        PMDIN returns the data of the previous read cycle, the first
+        read is a dummy one. The last read starts one more cycle.
+    ------------------------------------------------------------------*/
+
+u16 ILI9325_readData()
+{
+    word_t d;
+
+    PMP_sendAddress(CS | RS);
+    PMMODEbits.WAITM = _ili9325_waitR - 1;
+    PMP_read();
+    d.h8 = PMP_read();
+    d.l8 = PMP_read();
+    PMP_wait();
+    PMMODEbits.WAITM = _ili9325_waitW - 1;
+
+    return d.w;
+}
+
+u16 ILI9325_read(u16 index)
+{
+    ILI9325_writeRegister(index);
+    return ILI9325_readData();
+}
+
+/*	--------------------------------------------------------------------
+    DESCRIPTION:
+        Send the same color n times to the GRAM
+    PARAMETERS:
+    RETURNS:
+    REMARKS:
+        With PMPDMA the function returns at once, the next access
+        to the LCD waits for the end of the transfer.
+    ------------------------------------------------------------------*/
+
+void ILI9325_writeColor(u16 color, u32 n)
+{
+    ILI9325_writeRegister(WriteDatatoGRAM);
+    PMP_sendAddress(CS | RS);
+
+    #ifdef PMPDMA
+    PMP_fill(color, n);
+    #else
+    while (n--)
+    {
+        PMP_write(color >> 8);
+        PMP_write(color & 0xFF);
+    }
+    #endif
+}
+
+/*	--------------------------------------------------------------------
+    DESCRIPTION:
+        Set the GRAM window back to the screen after a tile
+    PARAMETERS:
+    RETURNS:
+    REMARKS:
+    ------------------------------------------------------------------*/
+
+void ILI9325_restoreWindow()
+{
+    if (!_ili9325_tile)
+        return;
+    _ili9325_tile = 0;
+
+    ILI9325_write(HorizontalRAMStartAddressPosition, ILI9325.screen.startx);
+    ILI9325_write(HorizontalRAMEndAddressPosition, ILI9325.screen.endx);
+    ILI9325_write(VerticalRAMStartAddressPosition, ILI9325.screen.starty);
+    ILI9325_write(VerticalRAMEndAddressPosition, ILI9325.screen.endy);
+}
+
+/*	--------------------------------------------------------------------
+    DESCRIPTION:
+        Set the GRAM window to a tile and get ready to write it
+    PARAMETERS:
+        x, y : GRAM (portrait) coordinates of the upper left pixel
+        w, h : size of the tile
+    RETURNS:
+    REMARKS:
+        The w * h colors follow with RS = 1
+    ------------------------------------------------------------------*/
+
+void ILI9325_setTile(u16 x, u16 y, u16 w, u16 h)
+{
+    _ili9325_tile = 1;
+    ILI9325_write(HorizontalRAMStartAddressPosition, x);
+    ILI9325_write(HorizontalRAMEndAddressPosition, x + w - 1);
+    ILI9325_write(VerticalRAMStartAddressPosition, y);
+    ILI9325_write(VerticalRAMEndAddressPosition, y + h - 1);
+    ILI9325_write(GRAMHorizontalAddressSet, x);
+    ILI9325_write(GRAMVerticalAddressSet, y);
+
+    ILI9325_writeRegister(WriteDatatoGRAM);
+    PMP_sendAddress(CS | RS);
+}
+
+/*	--------------------------------------------------------------------
+    DESCRIPTION:
+        Send a tile of w x h pixels to the GRAM
+    PARAMETERS:
+        x, y : GRAM (portrait) coordinates of the upper left pixel
+        w, h : size of the tile
+        tile : w * h colors, row after row, in bus order
+               (see ILI9325_TILE())
+    RETURNS:
+    REMARKS:
+        With PMPDMA the function returns as soon as the transfer is
+        started. The tile must not be changed until ILI9325_wait()
+        returns, meanwhile the next tile can be drawn in another
+        buffer.
+    ------------------------------------------------------------------*/
+
+void ILI9325_writeTile(u16 x, u16 y, u16 w, u16 h, const u16 *tile)
+{
+    u32 n = (u32)w * h;
+
+    if (n == 0)
+        return;
+
+    ILI9325_setTile(x, y, w, h);
+
+    #ifdef PMPDMA
+    PMP_writeBlock(tile, n * 2);
+    #else
+    {
+        const u8 *p = (const u8 *)tile;
+        n *= 2;
+        while (n--)
+            PMP_write(*p++);
+    }
+    #endif
+}
+
+/*	--------------------------------------------------------------------
+    DESCRIPTION:
+        Wait for the end of a DMA transfer
+    PARAMETERS:
+    RETURNS:
+    REMARKS:
+    ------------------------------------------------------------------*/
+
+void ILI9325_wait()
+{
+    #ifdef PMPDMA
+    PMP_dmaWait();
+    #endif
+}
+
+#else
 
 ///	--------------------------------------------------------------------
 /// Write functions
@@ -190,6 +423,45 @@ u16 ILI9325_read(u8 index)
     return ILI9325_readData();
 }
 
+/*	--------------------------------------------------------------------
+    DESCRIPTION:
+        Send the same color n times to the GRAM
+    PARAMETERS:
+    RETURNS:
+    REMARKS:
+    ------------------------------------------------------------------*/
+
+void ILI9325_writeColor(u16 color, u32 n)
+{
+    word_t c;
+
+    c.w = color;
+
+    ILI9325_writeRegister(WriteDatatoGRAM);		// write GRAM
+
+    //LowCS;  // Enable LCD
+    HighRS;	// Disable Register Selection Signal
+    HighRD; // Disable Read Mode
+    HighWR; // Disable Write Mode
+
+    while (n--)
+    {
+        DATA = c.h8;
+
+        LowWR;	// Enable Write
+        HighWR;	// Disable Write
+        
+        DATA = c.l8;
+
+        LowWR;	// Enable Write
+        HighWR;	// Disable Write
+    }
+
+    //HighCS;                                 	// Disable LCD
+}
+
+#endif /* __PMP__ */
+
 /*	--------------------------------------------------------------------
     DESCRIPTION:
         Returns the 16-bit (4-hexdigit) controller code
@@ -230,6 +502,24 @@ void ILI9325_init()
     ILI9325.font.width    = ILI9325_getFontWidth();
     ILI9325.font.height   = ILI9325_getFontHeight();
 
+    #ifdef __PMP__
+
+    ///---------- PMP and Reset LCD Driver
+
+    ILI9325_initBus();
+
+    #ifdef ILI9325_RST
+    pinmode(ILI9325_RST, OUTPUT);
+    digitalwrite(ILI9325_RST, HIGH);
+    Delayms(5);     // 1ms min.
+    digitalwrite(ILI9325_RST, LOW);
+    Delayms(2);     // no min.
+    digitalwrite(ILI9325_RST, HIGH);
+    #endif
+    Delayms(100);   // 50ms min.
+
+    #else
+
     ///---------- IO's Output by default
 
     dDATA = OUTPUT;
@@ -257,6 +547,8 @@ void ILI9325_init()
 
     LowCS;	// Enable LCD -> not needed if CS is connected to GND
 
+    #endif
+
     ///---------- Start Initial Sequence
 
     //---------- Start internal oscillator
@@ -492,6 +784,10 @@ void ILI9325_setCursor(u16 x, u16 y)
         ILI9325.cursor.y = y;
     }
     
+    #ifdef __PMP__
+    ILI9325_restoreWindow();
+    #endif
+
     //LowCS;	// Enable LCD
     ILI9325_write(GRAMHorizontalAddressSet, ILI9325.cursor.x);
     ILI9325_write(GRAMVerticalAddressSet, ILI9325.cursor.y);
@@ -600,11 +896,6 @@ void ILI9325_setWindow(u16 x1, u16 y1, u16 x2, u16 y2)
 
 void ILI9325_clearScreen()
 {
-    word_t c;
-    u32 j=76800;                                // 240*320
-    
-    c.w = ILI9325.bcolor.c;						// current background color
-
     ILI9325_setCursor(0, 0);
 
     /*
@@ -613,27 +904,7 @@ void ILI9325_clearScreen()
     else // if (ILI9325.orientation == LANDSCAPE)
         ILI9325_setWindow(0, 0, 319, 239);
     */
-    ILI9325_writeRegister(WriteDatatoGRAM);		// write GRAM
-
-     //LowCS;  // Enable LCD
-    HighRS;	// Disable Register Selection Signal
-    HighRD; // Disable Read Mode
-    HighWR; // Disable Write Mode
-
-    while (j--)
-    {
-        DATA = c.h8;
-
-        LowWR;	// Enable Write
-        HighWR;	// Disable Write
-        
-        DATA = c.l8;
-
-        LowWR;	// Enable Write
-        HighWR;	// Disable Write
-    }
-
-    //HighCS;                                 	// Disable LCD
+    ILI9325_writeColor(ILI9325.bcolor.c, 76800);    // 240*320
 }
 
 /*	--------------------------------------------------------------------
@@ -646,33 +917,8 @@ void ILI9325_clearScreen()
 
 void ILI9325_clearWindow(u16 x1, u16 y1, u16 x2, u16 y2)
 {
-    word_t c;
-    u32 j=((x2-x1+1)*(y2-y1+1));                // height * width
-    
-    c.w = ILI9325.bcolor.c;						// current background color
-
     ILI9325_setCursor(x1, y1);
-    ILI9325_writeRegister(WriteDatatoGRAM);		// write GRAM
-
-    //LowCS;									    // Enable LCD
-    HighRS;	// Disable Register Selection Signal
-    HighRD; // Disable Read Mode
-    HighWR; // Disable Write Mode
-
-    while (j--)
-    {
-        DATA = c.h8;
-
-        LowWR;	// Enable Write
-        HighWR;	// Disable Write
-
-        DATA = c.l8;
-
-        LowWR;	// Enable Write
-        HighWR;	// Disable Write
-    }
-
-    //HighCS;                                 	// Disable LCD
+    ILI9325_writeColor(ILI9325.bcolor.c, (u32)(x2-x1+1)*(y2-y1+1));
 }
 
 /*	--------------------------------------------------------------------
@@ -806,6 +1052,10 @@ void ILI9325_printChar(u8 c, u16 x, u16 y)
     u8  i, j, by;
     u16 offset; 
 
+    #ifdef __PMP__
+    ILI9325_restoreWindow();
+    #endif
+
     //LowCS;									    // Enable LCD
     offset = ((c-32) * ILI9325.font.height);    // 32 first characters are not included in the font
     ILI9325_write(GRAMHorizontalAddressSet, x);	// setCursor
@@ -977,9 +1227,62 @@ void ILI9325_drawLine(u16 x0, u16 y0, u16 x1, u16 y1)
     drawLine(x0, y0, x1, y1);
 }
 
+#ifdef __PMP__
+
+/*	--------------------------------------------------------------------
+    DESCRIPTION:
+        Draw a w x h rgb565 bitmap at x,y
+    PARAMETERS:
+    RETURNS:
+    REMARKS:
+        Colors are swapped to the bus order in one buffer while the
+        other one is sent by DMA, the function returns while the last
+        chunk is being sent.
+    ------------------------------------------------------------------*/
+
+void ILI9325_drawBitmap(u16 x, u16 y, u16 w, u16 h, const u16 *bitmap)
+{
+    u32 n = (u32)w * h;
+    u16 i, k, *buffer;
+
+    if (n == 0)
+        return;
+
+    while (n)
+    {
+        // the other buffer may still be sent
+        _ili9325_buf ^= 1;
+        buffer = _ili9325_buffer[_ili9325_buf];
+
+        k = (n > ILI9325_CHUNK) ? ILI9325_CHUNK : n;
+        for (i = 0; i < k; i++)
+            buffer[i] = ILI9325_TILE(bitmap[i]);
+
+        // the whole bitmap follows in the same GRAM window
+        if (n == (u32)w * h)
+            ILI9325_setTile(x, y, w, h);
+
+        #ifdef PMPDMA
+        PMP_writeBlock(buffer, k * 2);
+        #else
+        for (i = 0; i < k; i++)
+        {
+            PMP_write(buffer[i] & 0xFF);
+            PMP_write(buffer[i] >> 8);
+        }
+        #endif
+        bitmap += k;
+        n -= k;
+    }
+}
+
+#else
+
 void ILI9325_drawBitmap(u16 x, u16 y, u16 w, u16 h, u16* bitmap)
 {
     drawBitmap(x, y, w, h, bitmap);
 }
 
+#endif
+
 #endif /* __ILI9325_C */
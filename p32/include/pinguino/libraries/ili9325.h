@@ -6,6 +6,10 @@
     FIRST RELEASE:	2 Sep. 2012
     LAST RELEASE:	7 Dec. 2013
     ----------------------------------------------------------------------------
+    CHANGELOG :
+    19 Oct. 2026 - PIC32 drives the LCD with the Parallel Master Port,
+                   fills and tiles are sent by DMA (PMPDMA)
+    ----------------------------------------------------------------------------
     TODO : 
     ----------------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
@@ -349,6 +353,27 @@
 
     #endif
 
+#elif defined(__PIC32MX__)
+
+    /// i80/8-bit bus on the Parallel Master Port, PMD0-7 = D0-D7
+    /// PMA0 = RS, PMWR = WR, PMRD = RD, PMCS1 = CS
+    /// RST can be wired to the board's reset or to the pin given
+    /// by ILI9325_RST
+
+    #ifndef __PMP__
+    #define __PMP__
+    #include <pmp.h>
+    #endif
+
+    #define RS          PMA0
+    #define CS          PMCS1
+
+    // color in bus order (high byte first) for ILI9325_writeTile()
+    #define ILI9325_TILE(c)     ((u16)(((c) << 8) | (((c) >> 8) & 0xFF)))
+
+    // pixels sent at once by ILI9325_drawBitmap()
+    #define ILI9325_CHUNK       (PMP_DMABLOCK / 2)
+
 #endif
 
 /**	--------------------------------------------------------------------
@@ -364,6 +389,9 @@
     void ILI9325_write(u16, u16);
     u16  ILI9325_readData();
     u16  ILI9325_read(u16);
+    void ILI9325_initBus();
+    void ILI9325_restoreWindow();
+    void ILI9325_setTile(u16, u16, u16, u16);
     
     #else
     
@@ -392,6 +420,13 @@
     void ILI9325_drawPixel(u16, u16);
     u16  ILI9325_readPixel(u16, u16);
     void ILI9325_clearScreen();
+    void ILI9325_clearWindow(u16, u16, u16, u16);
+    void ILI9325_writeColor(u16, u32);
+    #ifdef __PMP__
+    void ILI9325_writeTile(u16, u16, u16, u16, const u16 *);
+    void ILI9325_drawBitmap(u16, u16, u16, u16, const u16 *);
+    void ILI9325_wait();
+    #endif
     void ILI9325_scroll(u16);
     void ILI9325_init();
     void ILI9325_enterSleep();
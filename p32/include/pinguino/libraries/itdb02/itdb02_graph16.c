@@ -64,6 +64,15 @@
 #include <integer_math.c>
 #include <string.h>
 #include <delay.c>
+#ifdef ITDB02DMA
+#define PMPDMA                  // drawTile() and waitTile() are used
+#include <pmp.c>                // DMA0Interrupt
+#endif
+#ifdef ITDB02PMP
+#include <system.c>             // GetPeripheralClock
+#include <digitalw.c>
+#include <pmp.c>
+#endif
 
 #include <itdb02/SmallFont.c>
 
@@ -115,6 +124,15 @@ void pinguinoDATADIR(int data){
 }
 #endif
 
+#ifdef ITDB02PMP
+
+void LCD_Writ_Bus(int data)
+{
+  PMP_write(data);                      // the PMP makes the WR strobe
+}
+
+#else
+
 void LCD_Writ_Bus(int data)
 {
   LCD_DATA_BUS = data;
@@ -125,6 +143,21 @@ void LCD_Writ_Bus(int data)
   fastWriteHigh(LCD_WR);*/
 }
 
+#endif
+
+//Write the same data n times, RS must be high
+//With ITDB02PMP and ITDB02DMA the DMA channel sends it and the function
+//returns at once, the next command waits for the end of the transfer
+void LCD_Fill(int color, unsigned long n)
+{
+#if defined(ITDB02PMP) && defined(PMPDMA)
+  PMP_fill(color, n);
+#else
+  while (n--)
+    LCD_Writ_Bus(color);
+#endif
+}
+
 void LCD_Write_COM(int data){   
   fastWriteLow(LCD_RS);
   LCD_Writ_Bus(data);
@@ -138,6 +171,28 @@ void LCD_Write_DATA(int data){
 void InitLCD(char orientation){
   orient=orientation;
   
+#ifdef ITDB02PMP
+  //16-bit master mode 2, write strobe >= 50 ns
+  PMP_setMode(PMP_MODE_MASTER2);
+  PMP_setWidth(16);
+  PMP_setAddress(LCD_RS);
+  PMP_setControl(PMWR | PMRD | PMCS1);
+  PMP_setPolarity(PMP_ACTIVE_LOW);
+  PMP_autoIncrement(0);
+  PMP_setMux(PMP_MUX_OFF);
+  PMP_setWaitStates(1, GetPeripheralClock() / 20000000 + 1, 2);
+  PMP_init();
+
+  #ifdef ITDB02_RST
+  pinmode(ITDB02_RST, OUTPUT);
+  digitalwrite(ITDB02_RST, HIGH);
+  Delayms(5); 
+  digitalwrite(ITDB02_RST, LOW);
+  Delayms(5);
+  digitalwrite(ITDB02_RST, HIGH);
+  Delayms(5);
+  #endif
+#else
   LCD_DATA_DIR = 0x0000;  //Output for All pins on DATA BUS
 
   //Pin Mode for Control Pins!
@@ -152,6 +207,7 @@ void InitLCD(char orientation){
   Delayms(5);
   fastWriteHigh(LCD_REST);
   Delayms(5);
+#endif
 
   fastWriteLow(LCD_CS);  
   //************* Start Initial Sequence **********//
@@ -514,8 +570,6 @@ void fillCircle(int x, int y, int radius){
 }
 
 void clrScr(){
-	unsigned long i;
-	
 	fastWriteLow(LCD_CS);
 	if (orient==PORTRAIT)
 		setXY(0,0,239,319);
@@ -523,15 +577,11 @@ void clrScr(){
 		setXY(0,0,319,239);
     
     fastWriteHigh(LCD_RS);
-	for (i=0; i<76800; i++){
-		LCD_Writ_Bus(0);
-	}
+	LCD_Fill(0, 76800);
 	fastWriteHigh(LCD_CS);
 }
 
 void fillScr(char r, char g, char b){
-	long i;
-	
 	fastWriteLow(LCD_CS); 
 	if (orient==PORTRAIT)
 		setXY(0,0,239,319);
@@ -539,10 +589,7 @@ void fillScr(char r, char g, char b){
 		setXY(0,0,319,239);
         
     fastWriteHigh(LCD_RS);    
-	for (i=0; i<76800; i++)	{
-		//setPixel(r, g, b);
-        LCD_Writ_Bus(((r & 0xF8)<<8) + ((g & 0xFC)<<3) + ((b & 0xF8)>>3));
-	}
+	LCD_Fill(((r & 0xF8)<<8) + ((g & 0xFC)<<3) + ((b & 0xF8)>>3), 76800);
 	fastWriteHigh(LCD_CS); 
 }
 
@@ -1125,6 +1172,33 @@ void drawBitmap(int x, int y, int sx, int sy, unsigned int* data, int scale)
 	}
 }
 
+//Draw sx x sy rgb565 pixels at x, y (portrait)
+//With ITDB02PMP and ITDB02DMA the function returns as soon as the DMA
+//transfer is started, data must not be changed before waitTile()
+//returns, meanwhile the next tile can be drawn in another buffer
+void drawTile(int x, int y, int sx, int sy, const unsigned short* data)
+{
+	unsigned long n = (unsigned long)sx * sy;
+
+	fastWriteLow(LCD_CS);
+	setXY(x, y, x+sx-1, y+sy-1);
+	fastWriteHigh(LCD_RS);
+#if defined(ITDB02PMP) && defined(PMPDMA)
+	PMP_writeBlock(data, n * 2);
+#else
+	while (n--)
+		LCD_Writ_Bus(*data++);
+#endif
+	fastWriteHigh(LCD_CS);
+}
+
+void waitTile()
+{
+#if defined(ITDB02PMP) && defined(PMPDMA)
+	PMP_dmaWait();
+#endif
+}
+
 void drawBitmapR(int x, int y, int sx, int sy, unsigned int* data, int deg, int rox, int roy){
     unsigned int col;
     int tx, ty, newx, newy;
@@ -50,6 +50,8 @@
              2.6.1 - Jun  09 2011 - Support ITDB02 16bit bus version, PORTD on PIC32 has 16 pins! ;-)
              4.1   - Jun  11 2011 - Ported Arduino 4.1 upgrades
              4.1.1 - Jun  16 2011 - Added more speed-ups as C macros for pixel drive
+             4.2   - Oct  19 2026 - Parallel Master Port bus (ITDB02PMP), fills and
+                                    drawTile() sent by DMA (ITDB02DMA)
 */
 
 
@@ -80,6 +82,41 @@
 #define ASPECT_4x3	0
 #define ASPECT_16x9	1
 
+//16-bit bus on the Parallel Master Port (PIC32MX with PMD<15:0>)
+//PMD0-15 = DB0-DB15, PMA0 = RS, PMWR = WR, PMRD = RD, PMCS1 = CS
+//RESET on the pin given by ITDB02_RST or on the board's reset
+//The PMP makes the WR strobe and the CS, PMADDR only selects RS
+#if defined(ITDB02PMP)
+
+#include <pmp.h>
+
+#define LCD_RS 			PMA0
+#define LCD_WR 			0
+#define LCD_CS 			0
+#define LCD_REST 		0
+#define LCD_COM_ADDR	(PMCS1)
+#define LCD_DATA_ADDR	(PMCS1 | PMA0)
+
+#define fastWriteHigh(_pin_) (((_pin_) & LCD_RS) ? PMP_sendAddress(LCD_DATA_ADDR) : (void)0)
+#define fastWriteLow(_pin_) (((_pin_) & LCD_RS) ? PMP_sendAddress(LCD_COM_ADDR) : (void)0)
+#define fastSetOutputMode(_pin_)
+#define fastDelay()
+
+#define fastSetPixel(_r_,_g_,_b_) { \
+    fastWriteHigh(LCD_RS); \
+    PMP_write(((_r_ & 0xF8)<<8) + ((_g_ & 0xFC)<<3) + ((_b_ & 0xF8)>>3)); \
+}
+#define fastWriteData(_data_) { \
+    fastWriteHigh(LCD_RS); \
+    PMP_write(_data_); \
+}
+#define fastWriteCom(_data_) { \
+    fastWriteLow(LCD_RS); \
+    PMP_write(_data_); \
+}
+
+#else
+
 //Pinguino32X, UBW32, EMPEROR and Minimum boards
 #if defined(UBW32_460) || defined(UBW32_795) || defined(EMPEROR460) || defined(EMPEROR795)
 
@@ -154,6 +191,8 @@
     fastDelay(); \
 }
 
+#endif /* ITDB02PMP */
+
 struct _current_font
 {
 	uint8_t* font;
@@ -188,6 +227,8 @@ void printNumF(double num, char dec, int x, int y);
 void fontSize(char size);
 void drawBitmap(int x, int y, int sx, int sy, unsigned int* data, int scale);
 void drawBitmapR(int x, int y, int sx, int sy, unsigned int* data, int deg, int rox, int roy);
+void drawTile(int x, int y, int sx, int sy, const unsigned short* data);
+void waitTile();
 
 //private
 unsigned char fcolorr,fcolorg,fcolorb;
@@ -197,6 +238,7 @@ unsigned char fsize;
 void LCD_Writ_Bus(int data);
 void LCD_Write_COM(int data);
 void LCD_Write_DATA(int data);
+void LCD_Fill(int color, unsigned long n);
 //void main_W_com_data(int com1,int dat1);
 void setPixel(int r,int g,int b);
 void drawHLine(int x, int y, int l);
@@ -40,4 +40,11 @@ char Keypad_getKey();
 void Keypad_setDebounceTime(u16);
 void Keypad_setHoldTime(u16);
 
+#if defined(KEYPADSCAN)
+u8 Keypad_startScan(u8);
+void Keypad_scan();
+u8 Keypad_getEvent();
+u8 Keypad_isPressed(char);
+#endif
+
 #endif // KEYPAD_H
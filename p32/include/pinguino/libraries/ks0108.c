@@ -9,6 +9,9 @@
     * 20??-??-??    Marcus Fazzi (anunakin@ieee.org) - Pinguino 32 pPort
     * 2016-10-17    Rgis Blanchot - Added use of Print libraries
     * 2016-11-24    Rgis Blanchot - Complete re-write
+    * 2026-10-19    KS0108BUFFER : pixels are drawn in a RAM shadow
+                    of the display, GLCD_refresh() sends the changed
+                    columns of each page with one address per run
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -80,6 +83,28 @@
 
 u8 gStartLine;
 
+#ifdef KS0108BUFFER
+// RAM shadow of the display, 1 buffer per page
+// NB : PIC18F RAM bank holds 256 bytes only,
+// too small to stock the whole buffer (8 x 128 = 1024 bytes)
+u8 page0[KS0108_DISPLAY_WIDTH];
+u8 page1[KS0108_DISPLAY_WIDTH];
+u8 page2[KS0108_DISPLAY_WIDTH];
+u8 page3[KS0108_DISPLAY_WIDTH];
+u8 page4[KS0108_DISPLAY_WIDTH];
+u8 page5[KS0108_DISPLAY_WIDTH];
+u8 page6[KS0108_DISPLAY_WIDTH];
+u8 page7[KS0108_DISPLAY_WIDTH];
+
+// Buffers pointers
+u8* KS0108_buffer[KS0108_PAGES] = { page0, page1, page2, page3,
+                                    page4, page5, page6, page7 };
+
+// First and last changed column of each page, first > last if none
+u8 KS0108_dirtyFirst[KS0108_PAGES];
+u8 KS0108_dirtyLast[KS0108_PAGES];
+#endif
+
 /*  --------------------------------------------------------------------
     GLCD_enable
     ------------------------------------------------------------------*/
@@ -358,6 +383,33 @@ void GLCD_write(u8 b, u8 x, u8 line)
     GLCD_send(b);
 }
 
+/*  --------------------------------------------------------------------
+    GLCD_load / GLCD_store
+    --------------------------------------------------------------------
+    Read or write a byte of the display memory, in the RAM shadow
+    with KS0108BUFFER (no bus cycle), on the display otherwise
+    ------------------------------------------------------------------*/
+
+#ifdef KS0108BUFFER
+
+#define GLCD_load(x, line)      (KS0108_buffer[line][x])
+
+void GLCD_store(u8 b, u8 x, u8 line)
+{
+    KS0108_buffer[line][x] = b;
+    if (x < KS0108_dirtyFirst[line])
+        KS0108_dirtyFirst[line] = x;
+    if (x > KS0108_dirtyLast[line])
+        KS0108_dirtyLast[line] = x;
+}
+
+#else
+
+#define GLCD_load(x, line)      GLCD_readData(x, line)
+#define GLCD_store(b, x, line)  GLCD_write(b, x, line)
+
+#endif
+
 void GLCD_writeData(u8 b)
 {
     u8 dat;
@@ -365,20 +417,26 @@ void GLCD_writeData(u8 b)
     u8 line = KS0108.pixel.y >> 3;
     u8 yOffset = KS0108.pixel.y % 8;
 
+    if (x >= KS0108_DISPLAY_WIDTH)
+        return;
+
     if (yOffset == 0)                   // No offset,
     {                                   // The byte is on 1 line
-        GLCD_write(b, x, line);
+        GLCD_store(b, x, line);
         KS0108.pixel.x++;
     }
     else                                // Offset is positive
     {                                   // The byte is on 2 lines
         // first line
-        dat = GLCD_readData(x, line);
-        GLCD_write(dat | (b << yOffset), x, line);
+        dat = GLCD_load(x, line);
+        GLCD_store(dat | (b << yOffset), x, line);
 
         // second line
-        dat = GLCD_readData(x, line + 1);
-        GLCD_write(dat | (b >> (8 - yOffset)), x, line + 1);
+        if (line < KS0108_PAGES - 1)
+        {
+            dat = GLCD_load(x, line + 1);
+            GLCD_store(dat | (b >> (8 - yOffset)), x, line + 1);
+        }
 
         // Back to the first line, one byte further
         //GLCD_set(x + 1, line);
@@ -397,6 +455,13 @@ void GLCD_clearline(u8 line)
 {
     u8 x;
 
+    #ifdef KS0108BUFFER
+    for (x = 0; x < KS0108_DISPLAY_WIDTH; x++)
+        KS0108_buffer[line][x] = KS0108.screen.bcolor;
+    KS0108_dirtyFirst[line] = 0;
+    KS0108_dirtyLast[line] = KS0108_DISPLAY_WIDTH - 1;
+    #else
+
     GLCD_dataOut();
     GLCD_low(KS0108.pin.rw);            // Write
     GLCD_high(KS0108.pin.cs1);          // Select chip 1
@@ -408,6 +473,7 @@ void GLCD_clearline(u8 line)
     GLCD_high(KS0108.pin.rs);           // Data
     for (x = 0; x < 64; x++)            // Clear all the 64 pixels
         GLCD_send(KS0108.screen.bcolor);
+    #endif
 }
 
 /*  --------------------------------------------------------------------
@@ -445,9 +511,60 @@ void GLCD_clearScreen()
     GLCD_send(KS0108_SET_ADD|0);
     KS0108.pixel.y = 0;
     KS0108.pixel.x = 0;
-    
+
+    // the shadow is the same as the display
+    #ifdef KS0108BUFFER
+    for (y = 0; y < KS0108_PAGES; y++)
+    {
+        for (x = 0; x < KS0108_DISPLAY_WIDTH; x++)
+            KS0108_buffer[y][x] = KS0108.screen.bcolor;
+        KS0108_dirtyFirst[y] = KS0108_DISPLAY_WIDTH;
+        KS0108_dirtyLast[y] = 0;
+    }
+    #endif
 }
 
+/*  --------------------------------------------------------------------
+    GLCD_refresh
+    --------------------------------------------------------------------
+    Send the changed part of the RAM shadow to the display.
+    The column address is incremented by the controller after each
+    byte, so each page needs one SET_PAGE/SET_ADD per chip only.
+    ------------------------------------------------------------------*/
+
+#ifdef KS0108BUFFER
+void GLCD_refresh()
+{
+    u8 line, x, last, end;
+    u8 *buffer;
+
+    for (line = 0; line < KS0108_PAGES; line++)
+    {
+        x = KS0108_dirtyFirst[line];
+        end = KS0108_dirtyLast[line];
+        if (x > end)
+            continue;                   // nothing has changed
+        buffer = KS0108_buffer[line];
+
+        while (x <= end)
+        {
+            // a run doesn't go further than the chip
+            last = x | (KS0108_CHIP_WIDTH - 1);
+            if (last > end)
+                last = end;
+
+            GLCD_set(x, line);          // chip, page and column
+            GLCD_high(KS0108.pin.rs);   // Data
+            for (; x <= last; x++)
+                GLCD_send(buffer[x]);
+        }
+
+        KS0108_dirtyFirst[line] = KS0108_DISPLAY_WIDTH;
+        KS0108_dirtyLast[line] = 0;
+    }
+}
+#endif
+
 /*  --------------------------------------------------------------------
     GLCD_setColor
     --------------------------------------------------------------------
@@ -581,8 +698,8 @@ void GLCD_scrollUp()
         {
             for (x=0; x<128; x++)
             {
-                d = GLCD_readData(x, line + 1);
-                GLCD_write(d, x, line);
+                d = GLCD_load(x, line + 1);
+                GLCD_store(d, x, line);
             }
         }
     }
@@ -821,13 +938,13 @@ void GLCD_drawPixel(u8 x, u8 y)
 {
     u8 d, line;
 
-    if (x > KS0108.screen.width || y > KS0108.screen.height)
+    if (x >= KS0108.screen.width || y >= KS0108.screen.height)
         return;
 
     line = y >> 3;
     
-    // Read data from display memory
-    d = GLCD_readData(x, line); 
+    // Read data from display memory (or from the RAM shadow)
+    d = GLCD_load(x, line);
     
     // Set or clear dot
     if (KS0108.screen.color == KS0108_WHITE)
@@ -835,14 +952,16 @@ void GLCD_drawPixel(u8 x, u8 y)
     else
         d &= ~(1 << (y % 8));
 
-    // Write data back to display
-    GLCD_write(d, x, line);
+    // Write data back to display (or to the RAM shadow)
+    GLCD_store(d, x, line);
 }
 
 // defined as extern void drawPixel(u16 x, u16 y); in graphics.c
 void drawPixel(u16 x, u16 y)
 {
-    GLCD_drawPixel((u8)x, (u8)y);
+    // off-screen values mustn't wrap to the left or top once cast
+    if (x < KS0108.screen.width && y < KS0108.screen.height)
+        GLCD_drawPixel((u8)x, (u8)y);
 }
 
 void GLCD_drawLine(u8 x1, u8 y1, u8 x2, u8 y2)
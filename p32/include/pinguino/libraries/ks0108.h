@@ -9,6 +9,8 @@
     * 2016-10-17    Régis Blanchot - Added use of Print libraries
     * 2016-11-24    Régis Blanchot - Complete re-write
     * 2016-12-05    Régis Blanchot - moved font indices to const.h
+    * 2026-10-19    RAM shadow of the display (KS0108BUFFER), changes
+                    are sent by GLCD_refresh()
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -42,6 +44,7 @@
 #define KS0108_DISPLAY_WIDTH    128
 #define KS0108_DISPLAY_HEIGHT   64
 #define KS0108_TABSIZE          4
+#define KS0108_PAGES            8   // 8-pixel high lines
 
 //Panel controller chips
 #define KS0108_CHIP_WIDTH       64  // pixels per chip 
@@ -175,6 +178,7 @@ void GLCD_writeData(u8);
 u8   GLCD_readData(u8, u8);
 void GLCD_setStartLine(u8);
 void GLCD_goto(u8, u8);
+void GLCD_refresh();
 
 void GLCD_init(u8, u8, u8, u8, u8, u8, u8, u8, u8, u8, u8, u8, u8, u8);
 //void GLCD_home();
@@ -1,13 +1,58 @@
 #ifndef __KS_DHT_C
 #define __KS_DHT_C
 
+#include <typedef.h>
+#include <const.h>
+#include <macro.h>
 #include <digitalw.c>
+#ifndef __PIC32MX__
+#include <digitalp.c>
+#include <digitalr.c>
+#else
+#include <delay.c>
+#include <mips.h>	 // DisableInterrupt()
+#endif
 /*	-----------------------------------------------------------------------
 Pinguino library; DHT22 1wire humidity/temperature sensor
 Code base:  Forum Post by mirasu 
 http://forum.pinguino.cc/showthread.php?tid=3911
+--------------------------------------------------------------------------
+19 Oct 2026	the DHT answer is recorded as a list of edge timestamps
+		and decoded afterwards (KS_DHTDecode) : a bit is 1 when its
+		high level lasts longer than 7/8 of the low level before it,
+		so the result no more depends on loop timings.
+		DHT11 support, sign-magnitude negative temperatures.
+		PIC32 : KS_DHTStart() / KS_DHTService() capture the edges
+		with the external interrupts INT0 to INT4 (one sensor per
+		line, all of them at the same time).
+19 Oct 2026	the external interrupts are taken through intx.c, which
+		gives each line to one library at a time.
+		8-bit : the same interrupt capture replaces the polling
+		loop, KS_DHTRead() no more masks the interrupts for the
+		5 ms of the answer, the sensor must be on INT0 to INT2.
 --------------------------------------------------------------------------*/
-#define wt	5000	 //Timeout
+#define wt	5000	 //Timeout (loops without any edge)
+
+#define KS_DHT11	11
+#define KS_DHT22	22
+
+// response low, response high, then 40 x (low, high)
+// edge[0] is the falling edge of the response
+#define KS_DHTEDGES	83
+
+// timestamp of an edge, only the differences are used
+#ifndef KS_DHTTIME
+#ifdef __PIC32MX__
+#define KS_DHTTIME	u16	 // core timer, low 16 bits
+#else
+#define KS_DHTTIME	u8	 // millis() timer / 16, 1.3 us at 48 MHz
+#endif
+#endif
+
+// 8-bit : KS_DHTRead() uses the interrupt capture
+#if !defined(__PIC32MX__) && !defined(KS_DHTASYNC)
+#define KS_DHTASYNC
+#endif
 
 typedef struct
 {
@@ -18,78 +63,337 @@ u8 dht_error; //global error
 } KS_DHT_Data;
 
 /// PROTOTYPES
-u8 KS_DHTRead(u8,KS_DHT_Data *); 
+u8 KS_DHTRead(u8,KS_DHT_Data *);
+u8 KS_DHTDecode(const KS_DHTTIME *, u8, u8 *);
+void KS_DHTConvert(const u8 *, u8, KS_DHT_Data *);
+
+/*	-----------------------------------------------------------------------
+---------- KS_DHTDecode()
+-----------------------------------------------------------------------
+* Description:	turns the recorded edges into the 5 data bytes
+* Arguments:
+edge = KS_DHTEDGES timestamps, any unit, wrapping allowed
+n = number of edges recorded
+dat = 5 bytes
+return errorcode or 0
+--------------------------------------------------------------------*/
+u8 KS_DHTDecode(const KS_DHTTIME * edge, u8 n, u8 * dat)
+{
+KS_DHTTIME tlow, thigh;
+u8 i, k;
+
+if (n == 0) {return 2;}	 // No response
+if (n < 3) {return 3;}	 // Truncated response signal
+if (n < KS_DHTEDGES) {return 5;}	 // Truncated data
+
+edge += 2;	 // falling edge of the first bit
+for(i=0;i<5;i++)
+{
+dat[i] = 0;
+for(k=0;k<8;k++)
+{
+tlow  = edge[1] - edge[0];	 // 50 us
+thigh = edge[2] - edge[1];	 // 26-28 us -> 0, 70 us -> 1
+if (tlow == 0 || thigh == 0) {return 6;}
+dat[i] <<= 1;
+if (thigh > tlow - (tlow >> 3))	 // 0 : ~0.55 x low, 1 : ~1.4 x low
+dat[i] |= 1;
+edge += 2;
+}
+}
+
+if ((u8)(dat[0]+dat[1]+dat[2]+dat[3]) != dat[4]) // Checksum
+{
+return 7;
+}
+return 0;
+}
+
+/*	-----------------------------------------------------------------------
+---------- KS_DHTConvert()
+-----------------------------------------------------------------------
+* Description:	converts the data bytes to humidity and temperature
+* Arguments:
+dat = 5 bytes from KS_DHTDecode
+type = KS_DHT11 or KS_DHT22
+dh = data record
+--------------------------------------------------------------------*/
+void KS_DHTConvert(const u8 * dat, u8 type, KS_DHT_Data * dh)
+{
+if (type == KS_DHT11)
+{
+// integer and decimal parts, sign in bit 7 of the decimal part
+dh->sign = (dat[3] & 0x80) ? 1 : 0;
+dh->hum  = dat[0] + dat[1] / 10.0;
+dh->temp = dat[2] + (dat[3] & 0x7F) / 10.0;
+}
+else
+{
+// 0.1 unit, sign in bit 7 of the msb (not 2's complement)
+dh->sign = (dat[2] & 0x80) ? 1 : 0;
+dh->hum  = ((dat[0] << 8) + dat[1]) / 10.0;
+dh->temp = (((dat[2] & 0x7F) << 8) + dat[3]) / 10.0;
+}
+}
+
+#if defined(__PIC32MX__)
+
+/*	-----------------------------------------------------------------------
+---------- KS_DHTRecord()
+-----------------------------------------------------------------------
+* Description:	records the edges of the DHT answer, the time unit is
+		one loop so only the ratio of the pulses is meaningful
+* Arguments:
+dhpin = pin number, must be released (input)
+edge = KS_DHTEDGES timestamps
+return number of edges recorded
+--------------------------------------------------------------------*/
+u8 KS_DHTRecord(u8 dhpin, KS_DHTTIME * edge)
+{
+u16 t = 0, timeout = wt;
+u8 level = HIGH, n = 0;
+u32 dht_status = DisableInterrupt();
+
+while (n < KS_DHTEDGES && timeout)
+{
+if (digitalread(dhpin) != level)
+{
+edge[n++] = t;
+level ^= 1;
+timeout = wt;
+}
+t++;
+timeout--;
+}
+
+if (dht_status & 1) EnableInterrupt();
+return n;
+}
 
 /*	-----------------------------------------------------------------------
 ---------- KS_DHTRead()
 -----------------------------------------------------------------------
-* Description:	reads the dht22 device via 1-wire bus 
-* Arguments:	
+* Description:	reads the dht22 device via 1-wire bus
+* Arguments:
 dhpin = pin number where one wire bus is connected.
 dh = data record
 return errorcode or 0
 --------------------------------------------------------------------*/
 u8 KS_DHTRead(u8 dhpin,KS_DHT_Data * dh)
 {
-u16 timeout;
-double h,t;
-u8 DHTDAT[5]={0};
-u8 DHTCHECKSUM;
-u8 i,j;
-u8 dhtbyte=0;
+KS_DHTTIME edge[KS_DHTEDGES];
+u8 DHTDAT[5];
+u8 n;
 
-h=0;
-t=0;
 if (digitalread(dhpin)==LOW) {return 1;}	 // Bus not free
-pinmode(dhpin,OUTPUT); 
-digitalwrite(dhpin,LOW);	 // MCU start signal (>=500us) 
+pinmode(dhpin,OUTPUT);
+digitalwrite(dhpin,LOW);	 // MCU start signal (>=500us)
 Delayms(1);
 //Request Data
 pinmode(dhpin,INPUT);
-timeout = wt; 
-while(digitalread(dhpin)) {timeout--;if (timeout==0) {return 2;}}	 // Wait for DHTs response (20-40us)
-timeout = wt;
-while(!digitalread(dhpin)) {timeout--;if (timeout==0) {return 3;}}	 // Response signal (80us)
-timeout = wt;	
-while(digitalread(dhpin)) {timeout--;if (timeout==0) {return 4;}}	 // Preparation for sending data (80us)
-//Read Data
-for(i=0;i<5;i++)
+n = KS_DHTRecord(dhpin, edge);
+
+dh->dht_error = KS_DHTDecode(edge, n, DHTDAT);
+if (dh->dht_error) {return dh->dht_error;}
+
+KS_DHTConvert(DHTDAT, KS_DHT22, dh);
+return 0;
+}
+
+#endif // __PIC32MX__
+
+/*	-----------------------------------------------------------------------
+---------- Interrupt driven capture
+-----------------------------------------------------------------------
+#define KS_DHTASYNC to use it on PIC32, always used on 8-bit.
+A sensor is wired to one of the external interrupts (INT0 to INT4 on
+PIC32, INT0 to INT2 on PIC18F, INT on PIC16F) and is identified by
+the number of this line. The line is taken from intx.c for the time
+of the answer only, so it can be shared with the other libraries.
+Every edge is timestamped in the interrupt, the decoding is done later
+in KS_DHTService(), so several sensors can be read at the same time.
+
+Usage :
+    KS_DHTStart(0, 7, KS_DHT22);	// INT0 is on pin 7
+    ...
+    KS_DHTService();			// in loop()
+    if (KS_DHTAvailable(0))
+        error = KS_DHTGet(0, &dh);
+--------------------------------------------------------------------*/
+
+#if defined(KS_DHTASYNC)
+
+#include <intx.c>
+#include <millis.c>
+
+#define KS_DHTLINES	INTX_LINES
+
+#define KS_DHT_IDLE	0
+#define KS_DHT_START	1	 // start signal in progress
+#define KS_DHT_CAPTURE	2	 // recording the answer
+#define KS_DHT_DONE	3	 // result available
+
+typedef struct
 {
-for(j=1;j<=8;j++)
+u8 pin;
+u8 type;
+volatile u8 state;
+volatile u8 n;	 // edges recorded
+u32 t0;	 // ms
+u8 bytes[5];
+u8 error;
+volatile KS_DHTTIME edge[KS_DHTEDGES];
+} KS_DHT_Sensor;
+
+KS_DHT_Sensor gDHT[KS_DHTLINES];
+
+#define KS_DHTAvailable(line)	(gDHT[line].state == KS_DHT_DONE)
+
+/*	-----------------------------------------------------------------------
+---------- KS_DHTEdge()
+-----------------------------------------------------------------------
+* Description:	intx.c callback, timestamps an edge of the answer
+--------------------------------------------------------------------*/
+void KS_DHTEdge(u8 line, u8 level)
 {
-timeout = wt;
-while(digitalread(dhpin)==LOW) {timeout--;if (timeout==0) {return 5;}}	 // Start to transmit 1-Bit (50 us)
-Delayus(30);
-dhtbyte <<= 1;
-if (digitalread(dhpin))	 // Hi > 30us (70 us) -> Bit=1	
+KS_DHT_Sensor *s = &gDHT[line];
+#if defined(__PIC32MX__)
+KS_DHTTIME now = ReadCoreTimer();
+#else
+KS_DHTTIME now;
+t16 tmr;
+TIMEBASE_READ(tmr);	 // Fosc/4, free running for millis()
+now = tmr.w >> 4;
+#endif
+
+(void)level;
+if (s->state == KS_DHT_CAPTURE && s->n < KS_DHTEDGES)
+s->edge[s->n++] = now;
+}
+
+/*	-----------------------------------------------------------------------
+---------- KS_DHTStart()
+-----------------------------------------------------------------------
+* Arguments:
+line = external interrupt the sensor is wired to
+dhpin = pin number of this interrupt
+type = KS_DHT11 or KS_DHT22
+return false if the line is busy or the bus is not free
+--------------------------------------------------------------------*/
+u8 KS_DHTStart(u8 line, u8 dhpin, u8 type)
 {
-dhtbyte |= 1;
-timeout = wt;
-while(digitalread(dhpin)) {timeout--;if (timeout==0) {return 6;}}	
-}	 // Hi < 30us (26-28 us) -> Bit=0	
+KS_DHT_Sensor *s;
+
+if (line >= KS_DHTLINES) {return false;}
+s = &gDHT[line];
+if (s->state == KS_DHT_START || s->state == KS_DHT_CAPTURE)
+{return false;}
+if (digitalread(dhpin)==LOW) {return false;}	 // Bus not free
+
+s->pin = dhpin;
+s->type = type;
+s->n = 0;
+digitalwrite(dhpin, LOW);	 // MCU start signal (1ms DHT22, 18ms DHT11)
+pinmode(dhpin, OUTPUT);
+// the line is held low until KS_DHTService() releases it, the
+// first edge to catch is the falling edge of the response
+if (!IntxAttach(line, KS_DHTEdge, INT_FALLING_EDGE))
+{
+pinmode(dhpin, INPUT);
+return false;	 // line used by another library
 }
-DHTDAT[i] = dhtbyte;
+s->t0 = millis();
+s->state = KS_DHT_START;
+return true;
 }
 
-DHTCHECKSUM = DHTDAT[0]+DHTDAT[1]+DHTDAT[2]+DHTDAT[3];
-if (DHTCHECKSUM != DHTDAT[4]) // Checksum	
+/*	-----------------------------------------------------------------------
+---------- KS_DHTService()
+-----------------------------------------------------------------------
+* Description:	ends the start signals, decodes the completed answers,
+		to call as often as possible
+--------------------------------------------------------------------*/
+void KS_DHTService()
+{
+KS_DHT_Sensor *s;
+u8 line;
+
+for (line = 0; line < KS_DHTLINES; line++)
 {
-return 7;	
-}	
-dh->sign = 0; 
+s = &gDHT[line];
 
-if (DHTDAT[2] & 0b11111000)	// test if sign is set, i.e. negative
-{	
-dh->sign = 1;
-DHTDAT[2] = (DHTDAT[2] ^ 0xFFFF) + 1;	// 2's complement conversion
+if (s->state == KS_DHT_START)
+{
+// +1 ms as millis() may have changed just after the start
+if (millis() - s->t0 < (s->type == KS_DHT11 ? 19 : 2))
+continue;
+s->state = KS_DHT_CAPTURE;
+s->t0 = millis();
+pinmode(s->pin, INPUT);	 // Request Data
 }
 
-h=(DHTDAT[0]<<8)+DHTDAT[1];
-t=(DHTDAT[2]<<8)+DHTDAT[3];
-dh->hum=h/10;
-dh->temp=t/10;
-return 0;
+else if (s->state == KS_DHT_CAPTURE)
+{
+// the whole answer lasts about 5 ms
+if (s->n < KS_DHTEDGES && millis() - s->t0 < 10)
+continue;
+IntxDetach(line);	 // no more writer
+s->error = KS_DHTDecode((const KS_DHTTIME *)s->edge, s->n, s->bytes);
+s->state = KS_DHT_DONE;
 }
+}
+}
+
+/*	-----------------------------------------------------------------------
+---------- KS_DHTGet()
+-----------------------------------------------------------------------
+* Description:	gets the result of the last reading of a line
+return errorcode or 0
+--------------------------------------------------------------------*/
+u8 KS_DHTGet(u8 line, KS_DHT_Data * dh)
+{
+KS_DHT_Sensor *s = &gDHT[line];
+
+s->state = KS_DHT_IDLE;
+dh->dht_error = s->error;
+if (s->error == 0)
+KS_DHTConvert(s->bytes, s->type, dh);
+return s->error;
+}
+
+#if !defined(__PIC32MX__)
 
+/*	-----------------------------------------------------------------------
+---------- KS_DHTRead()
+-----------------------------------------------------------------------
+* Description:	reads a dht22 with the interrupt capture, waits for
+		the answer with the interrupts enabled
+* Arguments:
+dhpin = pin number, 0 to 2 (INT0 to INT2) on PIC18F boards,
+	the INT pin on PIC16F
+dh = data record
+return errorcode or 0
+--------------------------------------------------------------------*/
+u8 KS_DHTRead(u8 dhpin,KS_DHT_Data * dh)
+{
+#if defined(__16F1459) || defined(__16F1708)
+u8 line = 0;
+#else
+u8 line = dhpin;
 #endif
 
+if (!KS_DHTStart(line, dhpin, KS_DHT22))
+{
+dh->dht_error = 1;	 // Bus not free or not an interrupt pin
+return 1;
+}
+while (!KS_DHTAvailable(line))
+KS_DHTService();
+return KS_DHTGet(line, dh);
+}
+
+#endif // !__PIC32MX__
+
+#endif // KS_DHTASYNC
+
+#endif
@@ -13,6 +13,10 @@
     26 May 2012 - M. Harper changed to deal more consistently with single line displays
                   as included in P32 lcdlib.c at x.3 r363.
                   (changes identified by dated comments in code)
+    19 Oct 2026 - data bits written with one port access when the data pins
+                  belong to the same port (portgroup.c)
+                - busy flag polling when the RW pin is connected (LCDRW)
+                - RAM shadow with background diff refresh (LCDSHADOW)
     --------------------------------------------------------------------
     LiquidCrystal original Arduino site: 
             http://www.arduino.cc/en/Tutorial/LiquidCrystal by David A. Mellis
@@ -33,11 +37,21 @@
 #include <delayus.c>            // Delayus
 #include <digitalw.c>           // digitalwrite
 #include <digitalp.c>           // pinmode
+#if defined(LCDRW)
+#include <digitalr.c>           // digitalread
+#endif
 #else
 #include <delay.c>              // Delayms
 #include <digitalw.c>           // digitalwrite
 #endif
 
+// Shadow
+#if defined(LCDSHADOW)
+    #include <lcdshadow.c>
+    lcdshadow_t gLCDShadow;
+    volatile u8 gLCDShadowPaused;   // the sketch is using the bus
+#endif
+
 // Printf
 #if defined(LCDPRINTF)
     #include <printFormated.c>
@@ -69,15 +83,17 @@ void lcd_pulseEnable(void)
     digitalwrite(_enable_pin, HIGH);
     Delayus(1);    // enable pulse must be >450ns
     digitalwrite(_enable_pin, LOW);
-    Delayus(50);   // commands need > 37us to settle
 }
 
 /** Write using 4bits mode */
 void lcd_write4bits(u8 value)
 {
     u8 i;
-    for (i = 4; i < 8; i++)
-        digitalwrite(_data_pins[i], (value >> (i-4)) & 0x01);
+    if (_data_grouped)
+        portgroup_write(&_data_group, value & 0x0F);
+    else
+        for (i = 4; i < 8; i++)
+            digitalwrite(_data_pins[i], (value >> (i-4)) & 0x01);
     lcd_pulseEnable();
 }
 
@@ -85,14 +101,73 @@ void lcd_write4bits(u8 value)
 void lcd_write8bits(u8 value)
 {
     u8 i;
-    for (i = 0; i < 8; i++)
-        digitalwrite(_data_pins[i], (value >> i) & 0x01);
+    if (_data_grouped)
+        portgroup_write(&_data_group, value);
+    else
+        for (i = 0; i < 8; i++)
+            digitalwrite(_data_pins[i], (value >> i) & 0x01);
     lcd_pulseEnable();
 }
 
-/** Send data to LCD 8 or 4 bits */
-void lcd_send(u8 value, u8 mode)
+/*  --------------------------------------------------------------------
+    lcd_waitBusy
+    --------------------------------------------------------------------
+    @descr:     wait until the LCD has executed the last instruction
+                by polling its busy flag (DB7) instead of waiting for
+                the worst case execution time
+    ------------------------------------------------------------------*/
+
+#if defined(LCDRW)
+void lcd_waitBusy(void)
 {
+    u8 i, first = (_displayfunction & LCD_8BITMODE) ? 0 : 4;
+    u8 busy;
+    u16 timeout = 1000;                 // a few ms, never hang
+
+    if (_data_grouped)
+        portgroup_mode(&_data_group, INPUT);
+    else
+        for (i = first; i < 8; i++)
+            pinmode(_data_pins[i], INPUT);
+
+    digitalwrite(_rs_pin, LOW);
+    digitalwrite(_rw_pin, HIGH);
+
+    do {
+        digitalwrite(_enable_pin, HIGH);
+        Delayus(1);                     // data output delay > 360ns
+        busy = digitalread(_data_pins[7]);
+        digitalwrite(_enable_pin, LOW);
+
+        // 4-bit mode : the address counter (low nibble) has to be read too
+        if (first)
+        {
+            Delayus(1);
+            digitalwrite(_enable_pin, HIGH);
+            Delayus(1);
+            digitalwrite(_enable_pin, LOW);
+        }
+        Delayus(1);
+    } while (busy && --timeout);
+
+    digitalwrite(_rw_pin, LOW);
+
+    if (_data_grouped)
+        portgroup_mode(&_data_group, OUTPUT);
+    else
+        for (i = first; i < 8; i++)
+            pinmode(_data_pins[i], OUTPUT);
+}
+#endif
+
+/** Send data to LCD 8 or 4 bits, without waiting for its execution */
+void lcd_transfer(u8 value, u8 mode)
+{
+    #if defined(LCDRW)
+    if (_busyflag)
+        lcd_waitBusy();
+    #endif
+
     digitalwrite(_rs_pin, mode);
   
     if (_displayfunction & LCD_8BITMODE)
@@ -106,11 +181,49 @@ void lcd_send(u8 value, u8 mode)
     }
 }
 
+/** Send data to LCD 8 or 4 bits */
+void lcd_send(u8 value, u8 mode)
+{
+    lcd_transfer(value, mode);
+    #if defined(LCDRW)
+    if (!_busyflag)
+    #endif
+    Delayus(50);   // commands need > 37us to settle
+}
+
 /** Write a control command on LCD */
+#if defined(LCDSHADOW)
+void lcd_step(void);
+
+// once lcd_shadow() is called, the command is queued and sent by the
+// next lcd_refresh(), between two characters
+void lcd_command(u8 value)
+{
+    if (gLCDShadow.cells == 0)
+    {
+        lcd_send(value, LOW);
+        return;
+    }
+
+    // queue full : lcd_refresh() is called from loop(), or less often
+    // than commands are issued, make room ourselves
+    while (!lcdshadow_command(&gLCDShadow, value))
+    {
+        gLCDShadowPaused = true;
+        lcd_step();
+        Delayus(50);
+        gLCDShadowPaused = false;
+    }
+}
+#else
 #define lcd_command(value)  lcd_send(value, LOW)
+#endif
 
 /** Setup line x column on LCD */
 #ifdef LCDSETCURSOR
+#if defined(LCDSHADOW)
+#define lcd_setCursor(col, row) lcdshadow_setCursor(&gLCDShadow, col, row)
+#else
 void lcd_setCursor(u8 col, u8 row)
 {
     u8 row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
@@ -134,11 +247,16 @@ void lcd_setCursor(u8 col, u8 row)
     lcd_command(LCD_SETDDRAMADDR | (col + row_offsets[row]));
 }
 #endif
+#endif
 
 /** Write a data character on LCD */
 void lcd_write(u8 c)
 {
+    #if defined(LCDSHADOW)
+    lcdshadow_write(&gLCDShadow, c);
+    #else
     lcd_send(c, HIGH);
+    #endif
 }
 
 /** Print a string on LCD */
@@ -152,13 +270,20 @@ void lcd_print(char *string)
 
 /** Write formated string on LCD **/
 #ifdef LCDPRINTF
+// span sink of the formatter, one call per run of chars
+void lcd_writeSpan(const u8 *s, u16 n)
+{
+    while (n--)
+        lcd_write(*s++);
+}
+
 //  added 28/01/2011 rblanchot@gmail.com
 void lcd_printf(char *fmt, ...)
 {
     va_list args;
 
     va_start(args, fmt);
-    pprintf(lcd_write, fmt, args);
+    pprintfw(lcd_writeSpan, fmt, args);
     va_end(args);
 }
 #endif
@@ -187,8 +312,15 @@ void lcd_printFloat(float number, u8 digits)
 #ifdef LCDHOME
 void lcd_home()
 {
+    #if defined(LCDSHADOW)
+    lcdshadow_home(&gLCDShadow);
+    #else
     lcd_command(LCD_RETURNHOME);
+    #if defined(LCDRW)
+    if (!_busyflag)
+    #endif
     Delayms(5);                     // Wait for more than 4.1 ms
+    #endif
 }
 #endif
 
@@ -196,11 +328,70 @@ void lcd_home()
 #ifdef LCDCLEAR
 void lcd_clear()
 {
+    #if defined(LCDSHADOW)
+    lcdshadow_clear(&gLCDShadow);   // only the non-blank cells will be sent
+    #else
     lcd_command(LCD_CLEARDISPLAY);  // clear display, set cursor position to zero
+    #if defined(LCDRW)
+    if (!_busyflag)
+    #endif
     Delayms(5);                     // Wait for more than 4.1 ms
+    #endif
 }
 #endif
 
+/*  --------------------------------------------------------------------
+    lcd_shadow
+    --------------------------------------------------------------------
+    @descr:     from now on, the print functions, lcd_setCursor,
+                lcd_home and lcd_clear only write into a RAM copy of the
+                display, the other commands are queued. lcd_refresh()
+                sends the changed characters.
+                usage :
+                    lcd_pins(...);
+                    lcd_begin(4, 0);
+                    lcd_shadow(20, 4);
+                    OnTimer2(lcd_refresh, INT_MILLISEC, 1);
+    @param:     cols, rows = display size
+    ------------------------------------------------------------------*/
+
+#if defined(LCDSHADOW)
+
+void lcd_shadow(u8 cols, u8 rows)
+{
+    lcdshadow_init(&gLCDShadow, cols, rows);
+}
+
+/** Send the next changed byte, the LCD executes it before the next call */
+void lcd_step(void)
+{
+    u8 op, value;
+
+    gLCDShadow.follow = (_displaycontrol & (LCD_CURSORON | LCD_BLINKON)) != 0;
+
+    op = lcdshadow_step(&gLCDShadow, &value);
+    if (op != LCDSHADOW_NONE)
+        lcd_transfer(value, (op == LCDSHADOW_DATA) ? HIGH : LOW);
+}
+
+/*  --------------------------------------------------------------------
+    lcd_refresh
+    --------------------------------------------------------------------
+    @descr:     send one changed byte to the LCD, the time to the next
+                call is the instruction execution time (> 37us), so
+                that nothing waits. Call it from a timer interrupt, or
+                from loop() at least 50us apart.
+                A 20x4 display is redrawn in about 90 ticks.
+    ------------------------------------------------------------------*/
+
+void lcd_refresh(void)
+{
+    if (!gLCDShadowPaused)
+        lcd_step();
+}
+
+#endif
+
 /** Turn the display on/off (quickly) */
 #ifdef LCDNODISPLAY
 void lcd_noDisplay()
@@ -318,6 +509,12 @@ void lcd_begin(u8 lines, u8 dotsize)
 
     Delayms(15);                    // Wait more than 15 ms after VDD rises to 4.5V
 
+    // the commands below are sent at once, lcd_shadow() comes after
+    #if defined(LCDSHADOW)
+    gLCDShadow.cells = 0;
+    gLCDShadow.ncmd = 0;
+    #endif
+
     // Now we pull both RS and R/W low to begin commands
     digitalwrite(_rs_pin, LOW);
     digitalwrite(_enable_pin, LOW);
@@ -358,6 +555,7 @@ void lcd_begin(u8 lines, u8 dotsize)
 
         // finally, set to 8-bit interface
         lcd_write4bits(0x02); 
+        Delayus(50);
     }
 
     // finally, set # lines, font size, etc.
@@ -375,8 +573,31 @@ void lcd_begin(u8 lines, u8 dotsize)
     _displaymode = LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT;
     // set the entry mode
     lcd_command(LCD_ENTRYMODESET | _displaymode);
+
+    // the busy flag can be read once the interface is set
+    #if defined(LCDRW)
+    _busyflag = true;
+    #endif
 }
 
+/*  --------------------------------------------------------------------
+    lcd_pinRW
+    --------------------------------------------------------------------
+    @descr:     RW pin, if connected, to poll the busy flag instead of
+                waiting for the worst case execution time of each
+                instruction. Must be called before lcd_begin().
+    ------------------------------------------------------------------*/
+
+#if defined(LCDRW)
+void lcd_pinRW(u8 rw)
+{
+    _rw_pin = rw;
+    _busyflag = false;
+    pinmode(_rw_pin, OUTPUT);
+    digitalwrite(_rw_pin, LOW);
+}
+#endif
+
 /** Init LCD 
  * mode 	=> 1 => 4 bits // 0 => 8 bits
  * rs , rw, enable
@@ -409,6 +630,7 @@ void lcd_pins(u8 rs, u8 enable, u8 d0, u8 d1, u8 d2, u8 d3, u8 d4, u8 d5, u8 d6,
         _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
         for (i = 4; i < 8; i++)
             pinmode(_data_pins[i], OUTPUT);
+        _data_grouped = portgroup_init(&_data_group, &_data_pins[4], 4);
     }
 
     // 8-bit mode
@@ -417,6 +639,7 @@ void lcd_pins(u8 rs, u8 enable, u8 d0, u8 d1, u8 d2, u8 d3, u8 d4, u8 d5, u8 d6,
         _displayfunction = LCD_8BITMODE | LCD_1LINE | LCD_5x8DOTS;
         for (i = 0; i < 8; i++)
             pinmode(_data_pins[i], OUTPUT);
+        _data_grouped = portgroup_init(&_data_group, _data_pins, 8);
     }
 }
 
@@ -0,0 +1,333 @@
+/*  --------------------------------------------------------------------
+    FILE:           lcdshadow.c
+    PROJECT:        pinguino
+    PURPOSE:        RAM shadow of a HD44780 DDRAM with diff refresh
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    Text is written into a RAM copy of the display (lcdshadow_write)
+    which only takes a few cycles per character. Each written cell
+    whose content changes is flagged dirty.
+    lcdshadow_step() then gives the driver the next byte to send :
+    a Set DDRAM Address command when the LCD address counter isn't
+    already on the next dirty cell, or the character of that cell.
+    The driver calls it once per timer tick, so that only the changed
+    cells are ever sent and the sketch never waits for the display.
+    Other commands (display control, entry mode, ...) are queued with
+    lcdshadow_command() and sent first, between two characters.
+
+    Assumes the default left to right entry mode (address counter
+    incremented after each character).
+    Doesn't touch any register and can be tested on a host.
+
+    #define LCDSHADOW_CELLS to the number of characters of the display
+    if it's not 80 (20x4, 40x2) to save RAM.
+    #define LCDSHADOW_COMMANDS to queue more than 4 commands per tick.
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    ------------------------------------------------------------------*/
+
+#ifndef __LCDSHADOW_C__
+#define __LCDSHADOW_C__
+
+#include <typedef.h>
+
+#if defined(__PIC32MX__)
+#include <mips.h>               // DisableInterrupt(), EnableInterrupt()
+#endif
+
+#ifndef LCDSHADOW_CELLS
+#define LCDSHADOW_CELLS         80
+#endif
+
+#ifndef LCDSHADOW_COMMANDS
+#define LCDSHADOW_COMMANDS      4
+#endif
+
+// lcdshadow_step() results
+#define LCDSHADOW_NONE          0       // display is up to date
+#define LCDSHADOW_ADDR          1       // value is a command
+#define LCDSHADOW_DATA          2       // value is a character
+#define LCDSHADOW_COMMAND       3       // value is a queued command
+
+#define LCDSHADOW_SETDDRAMADDR  0x80
+
+/*  --------------------------------------------------------------------
+    Critical sections
+    --------------------------------------------------------------------
+    The shadow is written by the sketch and read by the refresh
+    routine, which can run from an interrupt.
+    ------------------------------------------------------------------*/
+
+#if defined(__PIC32MX__)
+    #define LCDSHADOW_LOCK()    u32 lcdshadow_status = DisableInterrupt()
+    #define LCDSHADOW_UNLOCK()  if (lcdshadow_status & 1) EnableInterrupt()
+#else
+    #define LCDSHADOW_LOCK()    u8 lcdshadow_status = INTCONbits.GIE; INTCONbits.GIE = 0
+    #define LCDSHADOW_UNLOCK()  INTCONbits.GIE = lcdshadow_status
+#endif
+
+typedef struct
+{
+    u8 cols;
+    u8 rows;
+    u8 cells;                   // cols * rows
+    u8 cursor;                  // next cell written by lcdshadow_write
+    u8 next;                    // next cell checked by lcdshadow_step
+    u8 addr;                    // LCD address counter, 0xFF if unknown
+    u8 follow;                  // park the LCD cursor on the shadow cursor
+    u8 ncmd;                    // commands waiting in cmd[]
+    u8 cmd[LCDSHADOW_COMMANDS];
+    u8 ram[LCDSHADOW_CELLS];
+    u8 dirty[(LCDSHADOW_CELLS + 7) / 8];
+} lcdshadow_t;
+
+#define lcdshadow_isDirty(s, n) ((s)->dirty[(n) >> 3] & (1 << ((n) & 7)))
+#define lcdshadow_home(s)       ((s)->cursor = 0)
+#define lcdshadow_forget(s)     ((s)->addr = 0xFF)
+
+/*  --------------------------------------------------------------------
+    lcdshadow_ddram
+    --------------------------------------------------------------------
+    @return:    DDRAM address of a cell
+                rows start at 0x00, 0x40, cols and 0x40 + cols
+    ------------------------------------------------------------------*/
+
+u8 lcdshadow_ddram(lcdshadow_t *s, u8 cell)
+{
+    u8 row = 0;
+
+    while (cell >= s->cols)
+    {
+        cell -= s->cols;
+        row++;
+    }
+
+    if (row & 1)
+        cell += 0x40;
+    if (row & 2)
+        cell += s->cols;
+
+    return cell;
+}
+
+/*  --------------------------------------------------------------------
+    lcdshadow_init
+    --------------------------------------------------------------------
+    @descr:     fill the shadow with spaces, as the display is after
+                a Clear Display command
+    ------------------------------------------------------------------*/
+
+void lcdshadow_init(lcdshadow_t *s, u8 cols, u8 rows)
+{
+    u8 n;
+
+    if (cols * rows > LCDSHADOW_CELLS)
+        rows = LCDSHADOW_CELLS / cols;
+
+    s->cols   = cols;
+    s->rows   = rows;
+    s->cells  = cols * rows;
+    s->cursor = 0;
+    s->next   = 0;
+    s->addr   = 0xFF;
+    s->follow = 0;
+    s->ncmd   = 0;
+
+    for (n = 0; n < s->cells; n++)
+        s->ram[n] = ' ';
+    for (n = 0; n < sizeof(s->dirty); n++)
+        s->dirty[n] = 0;
+}
+
+/*  --------------------------------------------------------------------
+    lcdshadow_invalidate
+    --------------------------------------------------------------------
+    @descr:     send the whole shadow again at next refresh
+                (e.g. after the display has been reset)
+    ------------------------------------------------------------------*/
+
+void lcdshadow_invalidate(lcdshadow_t *s)
+{
+    u8 n;
+    LCDSHADOW_LOCK();
+
+    for (n = 0; n < s->cells; n++)
+        s->dirty[n >> 3] |= 1 << (n & 7);
+    s->addr = 0xFF;
+
+    LCDSHADOW_UNLOCK();
+}
+
+/*  --------------------------------------------------------------------
+    lcdshadow_setCursor
+    ------------------------------------------------------------------*/
+
+void lcdshadow_setCursor(lcdshadow_t *s, u8 col, u8 row)
+{
+    if (col >= s->cols)
+        col = s->cols - 1;
+    if (row >= s->rows)
+        row = s->rows - 1;
+
+    s->cursor = row * s->cols + col;
+}
+
+/*  --------------------------------------------------------------------
+    lcdshadow_write
+    --------------------------------------------------------------------
+    @descr:     write a character at the cursor position and move the
+                cursor to the next cell (wraps to the first one)
+    ------------------------------------------------------------------*/
+
+void lcdshadow_write(lcdshadow_t *s, u8 c)
+{
+    u8 n = s->cursor;
+
+    if (s->ram[n] != c)
+    {
+        LCDSHADOW_LOCK();
+        s->ram[n] = c;
+        s->dirty[n >> 3] |= 1 << (n & 7);
+        LCDSHADOW_UNLOCK();
+    }
+
+    if (++n >= s->cells)
+        n = 0;
+    s->cursor = n;
+}
+
+/*  --------------------------------------------------------------------
+    lcdshadow_clear
+    --------------------------------------------------------------------
+    @descr:     fill the shadow with spaces and home the cursor, only
+                the cells which were not blank will be sent
+    ------------------------------------------------------------------*/
+
+void lcdshadow_clear(lcdshadow_t *s)
+{
+    u8 n;
+
+    s->cursor = 0;
+    for (n = 0; n < s->cells; n++)
+        lcdshadow_write(s, ' ');
+}
+
+/*  --------------------------------------------------------------------
+    lcdshadow_command
+    --------------------------------------------------------------------
+    @descr:     queue a command, sent by the next lcdshadow_step()
+    @return:    false if the queue is full
+    ------------------------------------------------------------------*/
+
+u8 lcdshadow_command(lcdshadow_t *s, u8 value)
+{
+    u8 queued = false;
+    LCDSHADOW_LOCK();
+
+    if (s->ncmd < LCDSHADOW_COMMANDS)
+    {
+        s->cmd[s->ncmd++] = value;
+        queued = true;
+    }
+
+    LCDSHADOW_UNLOCK();
+    return queued;
+}
+
+/*  --------------------------------------------------------------------
+    lcdshadow_step
+    --------------------------------------------------------------------
+    @descr:     find the next byte to send to the display
+    @param:     s       shadow
+                value   byte to send (command or character)
+    @return:    LCDSHADOW_NONE, LCDSHADOW_ADDR, LCDSHADOW_DATA or
+                LCDSHADOW_COMMAND
+    ------------------------------------------------------------------*/
+
+u8 lcdshadow_step(lcdshadow_t *s, u8 *value)
+{
+    u8 n, cell = s->next, a;
+
+    // queued commands first, they may move the address counter
+    if (s->ncmd)
+    {
+        LCDSHADOW_LOCK();
+        *value = s->cmd[0];
+        for (n = 1; n < s->ncmd; n++)
+            s->cmd[n - 1] = s->cmd[n];
+        s->ncmd--;
+        LCDSHADOW_UNLOCK();
+        s->addr = 0xFF;
+        return LCDSHADOW_COMMAND;
+    }
+
+    // a skip over the last, incomplete, byte counts for 8 cells
+    for (n = 0; n < s->cells + 8; n++)
+    {
+        // skip 8 clean cells at once
+        if ((cell & 7) == 0 && s->dirty[cell >> 3] == 0)
+        {
+            n += 7;
+            cell += 8;
+        }
+
+        else if (lcdshadow_isDirty(s, cell))
+        {
+            a = lcdshadow_ddram(s, cell);
+            s->next = cell;
+
+            if (a != s->addr)
+            {
+                s->addr = a;
+                *value = LCDSHADOW_SETDDRAMADDR | a;
+                return LCDSHADOW_ADDR;
+            }
+
+            s->dirty[cell >> 3] &= ~(1 << (cell & 7));
+            s->addr = a + 1;
+            if (++s->next >= s->cells)
+                s->next = 0;
+            *value = s->ram[cell];
+            return LCDSHADOW_DATA;
+        }
+
+        else
+        {
+            cell++;
+        }
+
+        if (cell >= s->cells)
+            cell = 0;
+    }
+
+    // up to date, put the visible cursor where the sketch left it
+    if (s->follow)
+    {
+        a = lcdshadow_ddram(s, s->cursor);
+        if (a != s->addr)
+        {
+            s->addr = a;
+            *value = LCDSHADOW_SETDDRAMADDR | a;
+            return LCDSHADOW_ADDR;
+        }
+    }
+
+    return LCDSHADOW_NONE;
+}
+
+#endif /* __LCDSHADOW_C__ */
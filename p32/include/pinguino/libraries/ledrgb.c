@@ -68,15 +68,17 @@ void LedRGB_setRGBColor(u8 RGBLed, u8 r, u8 g, u8 b)
         b = 255 - b;
     }
 
+    // the 3 colors change on the same PWM period
     #ifdef SMOOTH_MODE
-    SWPWM_setDutyCycle(gRGBPin[RGBLed][0], SWPWM_LUT[r >> 2]);
-    SWPWM_setDutyCycle(gRGBPin[RGBLed][1], SWPWM_LUT[r >> 2]);
-    SWPWM_setDutyCycle(gRGBPin[RGBLed][2], SWPWM_LUT[r >> 2]);
+    SWPWM_stageDutyCycle(gRGBPin[RGBLed][0], SWPWM_LUT[r >> 2]);
+    SWPWM_stageDutyCycle(gRGBPin[RGBLed][1], SWPWM_LUT[r >> 2]);
+    SWPWM_stageDutyCycle(gRGBPin[RGBLed][2], SWPWM_LUT[r >> 2]);
     #else
-    SWPWM_setDutyCycle(gRGBPin[RGBLed][0], r);
-    SWPWM_setDutyCycle(gRGBPin[RGBLed][1], g);
-    SWPWM_setDutyCycle(gRGBPin[RGBLed][2], b);
+    SWPWM_stageDutyCycle(gRGBPin[RGBLed][0], r);
+    SWPWM_stageDutyCycle(gRGBPin[RGBLed][1], g);
+    SWPWM_stageDutyCycle(gRGBPin[RGBLed][2], b);
     #endif
+    SWPWM_commit();
 }
 
 void LedRGB_setHexColor(u8 RGBLed, u32 hexColor)
@@ -5,6 +5,9 @@
 /* Ecrit par : Daniel Lacroix (all rights reserved) */
 /*                                                  */
 /* Used in Pinguino Project with Author Permissions */
+/*                                                  */
+/* 19 Oct. 2026 : les elements sont pris dans un    */
+/* pool de taille fixe (LISTNODES) au lieu du tas   */
 /****************************************************/
 
 #ifndef __LIST_C__
@@ -14,23 +17,53 @@
 #include <const.h>
 #include <stdlib.h>
 #include <list.h>
+#include <pool.c>
 #include <stdio.h>
 #include <pinguinoserial1.c>
 
-/*****************************************************/
-/* Rajoute en tete de la liste pList l'element data. */
-/* Renvoie le nouveau point d'entree de la liste.    */
-List *list_prepend(List *pList, void * data)
+/* Nombre maximum d'elements de liste (toutes listes confondues) */
+#ifndef LISTNODES
+  #ifdef __PIC32MX__
+  #define LISTNODES 64
+  #else
+  #define LISTNODES 16
+  #endif
+#endif
+
+POOL_DECLARE(gListPool, sizeof(List), LISTNODES);
+
+/********************************************************/
+/* Alloue un element de liste. Renvoie NULL si le pool  */
+/* est epuise (le tas n'est jamais utilise).            */
+List *list_node_alloc()
 { List *vList;
 
-  /* on alloue la memoire pour le nouvel element */
-  if((vList = (List *)malloc(sizeof(List))) == NULL)
+  if(gListPool.mem == NULL)
+    POOL_INIT(gListPool, sizeof(List));
+
+  if((vList = (List *)pool_alloc(&gListPool)) == NULL)
   {
 	#ifdef DEBUG
-	serial1printf("malloc failed\n");
+	serial1printf("list pool empty\n");
 	#endif
-	exit(1);
   }
+  return(vList);
+}
+/********************************************************/
+
+/* Rend un element de liste au pool */
+#define list_node_free(pList) pool_free(&gListPool, pList)
+
+/*****************************************************/
+/* Rajoute en tete de la liste pList l'element data. */
+/* Renvoie le nouveau point d'entree de la liste.    */
+List *list_prepend(List *pList, void * data)
+{ List *vList;
+
+  /* on prend un element dans le pool */
+  /* si le pool est vide, la liste reste intacte */
+  if((vList = list_node_alloc()) == NULL)
+    return(pList);
 
   if(pList == NULL)
   { /* la liste est vide */
@@ -55,14 +88,10 @@ List *list_prepend(List *pList, void * data)
 List *list_append(List *pList, void * data)
 { List *vList;
 
-  /* on alloue la memoire pour le nouvelle element */
-  if((vList = (List *)malloc(sizeof(List))) == NULL)
-  {
-	#ifdef DEBUG
-	serial1printf("malloc failed\n ");
-	#endif
-	exit(1);
-  }
+  /* on prend un element dans le pool */
+  /* si le pool est vide, la liste reste intacte */
+  if((vList = list_node_alloc()) == NULL)
+    return(pList);
 
   if(pList == NULL)
   { /* la liste est vide */
@@ -91,7 +120,7 @@ void list_free(List *pList)
   while(!list_is_end(pList,vListMove))
   {
     vListMoveNext = list_next(pList,vListMove);
-    free(vListMove);
+    list_node_free(vListMove);
     vListMove = vListMoveNext;
   }
 }
@@ -107,7 +136,7 @@ void list_free_full(List *pList, void (* free_func)(void * data))
   {
     vListMoveNext = list_next(pList,vListMove);
     free_func(vListMove->data);
-    free(vListMove);
+    list_node_free(vListMove);
     vListMove = vListMoveNext;
   }
 }
@@ -123,7 +152,7 @@ void list_free_full_simple(List *pList)
   {
     vListMoveNext = list_next(pList,vListMove);
     if(vListMove->data != NULL) free(vListMove->data);
-    free(vListMove);
+    list_node_free(vListMove);
     vListMove = vListMoveNext;
   }
 }
@@ -162,7 +191,7 @@ List *list_free_item(List *pList, void * data)
     /* si il n'y a que notre element dans la liste */
     if(vListMove->next == vListMove)
     { /* on libere l'element */
-      free(vListMove);
+      list_node_free(vListMove);
       /* on renvoie une liste vide */
       return(NULL);
     } else {
@@ -172,7 +201,7 @@ List *list_free_item(List *pList, void * data)
       vListMove->prev->next = vListMoveNext;
       vListMoveNext->prev = vListMove->prev;
       /* on libere l'element a liberer */
-      free(vListMove);
+      list_node_free(vListMove);
       if(pList == vListMove)
       {
         /* l'element a supprimer etait le premier, c'est */
@@ -210,7 +239,7 @@ List *list_free_item_with_check(List *pList, void * data, boolean *done)
     /* si il n'y a que notre element dans la liste */
     if(vListMove->next == vListMove)
     { /* on libere l'element */
-      free(vListMove);
+      list_node_free(vListMove);
       /* on renvoie une liste vide */
       return(NULL);
     } else {
@@ -220,7 +249,7 @@ List *list_free_item_with_check(List *pList, void * data, boolean *done)
       vListMove->prev->next = vListMoveNext;
       vListMoveNext->prev = vListMove->prev;
       /* on libere l'element a liberer */
-      free(vListMove);
+      list_node_free(vListMove);
       if(pList == vListMove)
       {
         /* l'element a supprimer etait le premier, c'est */
@@ -272,14 +301,10 @@ List *list_insert_after_item(List *pList, void * before, void * data)
 { List *vList;
   List *vListMove;
 
-  /* on alloue la memoire pour le nouvelle element */
-  if((vList = (List *)malloc(sizeof(List))) == NULL)
-  {
-	#ifdef DEBUG
-	serial1printf("malloc failed\n");
-	#endif
-	exit(1);
-  }
+  /* on prend un element dans le pool */
+  /* si le pool est vide, la liste reste intacte */
+  if((vList = list_node_alloc()) == NULL)
+    return(pList);
 
   vListMove = pList;
   while(!list_is_end(pList,vListMove) && (vListMove->data != before))
@@ -348,14 +373,14 @@ List *list_pop(List *pList, void * *data)
   {
     *data = pList->data;
     /* on libere l'element */
-    free(pList);
+    list_node_free(pList);
     /* on renvoie une liste vide */
     return(NULL);
   } else {
     *data = pList->prev->data;
     vListPrev = pList->prev->prev;
     vListPrev->next = pList;
-    free(pList->prev);
+    list_node_free(pList->prev);
     pList->prev = vListPrev;
     return(pList);
   }
@@ -406,7 +431,7 @@ List *list_free_chunk(List *pList, List *pToFree)
   /* si il n'y a que notre element dans la liste */
   if(pToFree->next == pToFree)
   { /* on libere l'element */
-    free(pToFree);
+    list_node_free(pToFree);
     /* on renvoie une liste vide */
     return(NULL);
   } else {
@@ -416,7 +441,7 @@ List *list_free_chunk(List *pList, List *pToFree)
     pToFree->prev->next = vListNext;
     vListNext->prev = pToFree->prev;
     /* on libere l'element a liberer */
-    free(pToFree);
+    list_node_free(pToFree);
     if(pList == pToFree)
     {
       /* l'element a supprimer etait le premier, c'est */
@@ -478,14 +503,10 @@ List *list_insert_sorted(List *pList,int (* cmp_func)(void * p1, void * p2), voi
     (cmp_func(list_data(vListMove),data) < 0);
     vListMove = list_move_next(pList,vListMove));
 
-  /* on alloue la memoire pour le nouvelle element */
-  if((vList = (List *)malloc(sizeof(List))) == NULL)
-  {
-	#ifdef DEBUG
-	serial1printf("malloc failed\n");
-	#endif
-	exit(1);
-  }
+  /* on prend un element dans le pool */
+  /* si le pool est vide, la liste reste intacte */
+  if((vList = list_node_alloc()) == NULL)
+    return(pList);
 
   if(list_is_empty(pList))
   { /* si la liste est vide */
@@ -561,4 +582,43 @@ List *list_find_full(List *pList, void * your_data,
 }
 /*********************************************************************************/
 
+/**************************************************/
+/* Listes intrusives                              */
+/* Rajoute pNode en tete de la liste pHead        */
+void ilist_prepend(ListNode *pHead, ListNode *pNode)
+{
+  pNode->next = pHead->next;
+  pNode->prev = pHead;
+  pHead->next->prev = pNode;
+  pHead->next = pNode;
+}
+
+/* Rajoute pNode en queue de la liste pHead       */
+void ilist_append(ListNode *pHead, ListNode *pNode)
+{
+  pNode->next = pHead;
+  pNode->prev = pHead->prev;
+  pHead->prev->next = pNode;
+  pHead->prev = pNode;
+}
+
+/* Retire pNode de la liste qui le contient       */
+void ilist_remove(ListNode *pNode)
+{
+  pNode->prev->next = pNode->next;
+  pNode->next->prev = pNode->prev;
+  pNode->next = pNode->prev = pNode;
+}
+
+/* Retire et renvoie le premier element de pHead  */
+ListNode *ilist_pop_first(ListNode *pHead)
+{ ListNode *vNode;
+
+  if(ilist_is_empty(pHead)) return(NULL);
+  vNode = pHead->next;
+  ilist_remove(vNode);
+  return(vNode);
+}
+/**************************************************/
+
 #endif
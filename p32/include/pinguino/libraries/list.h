@@ -11,6 +11,7 @@
 #define __LIST_H__
 
 #include <typedef.h>
+#include <stddef.h>  /* offsetof */
 
 /* pour les listes chainees */
 typedef struct _List List;
@@ -178,6 +179,55 @@ List *list_find(List *pList, void * data);
 List *list_find_full(List *pList, void * your_data,
   boolean (* find_func)(void * data, void * your_data));
 
+/************************************************************************/
+/* Listes intrusives : le chainage (ListNode) est inclus dans la        */
+/* structure de l'utilisateur, aucune allocation n'est donc necessaire. */
+/* La tete (ListNode) est une sentinelle : la liste est circulaire et   */
+/* head.prev pointe toujours sur le dernier element.                    */
+/*                                                                      */
+/*   typedef struct { u8 id; ListNode node; } Item;                     */
+/*   ListNode head; Item a;                                             */
+/*   ilist_init(&head);                                                 */
+/*   ilist_append(&head, &a.node);                                      */
+/*   Item *p = ilist_entry(ilist_first(&head), Item, node);             */
+/************************************************************************/
+
+typedef struct _ListNode ListNode;
+
+struct _ListNode {
+  ListNode *next;
+  ListNode *prev;
+};
+
+/* Initialise la tete de liste pHead (liste vide). */
+/* void ilist_init(ListNode *pHead);               */
+#define ilist_init(pHead) ((pHead)->next = (pHead)->prev = (pHead))
+
+/* Renvoie TRUE si la liste pHead est vide. */
+#define ilist_is_empty(pHead) ((pHead)->next == (pHead))
+
+/* Renvoie le premier (dernier) element, NULL si la liste est vide. */
+#define ilist_first(pHead) (ilist_is_empty(pHead) ? NULL : (pHead)->next)
+#define ilist_last(pHead)  (ilist_is_empty(pHead) ? NULL : (pHead)->prev)
+
+/* Renvoie l'element qui suit pNode, NULL a la fin de la liste pHead. */
+#define ilist_next(pHead,pNode) ((pNode)->next == (pHead) ? NULL : (pNode)->next)
+
+/* Renvoie la structure de type type qui contient le ListNode pNode */
+/* dans son champ member.                                           */
+#define ilist_entry(pNode,type,member) \
+ ((type *)((u8 *)(pNode) - offsetof(type, member)))
+
+/* Rajoute pNode en tete (en queue) de la liste pHead. O(1). */
+void ilist_prepend(ListNode *pHead, ListNode *pNode);
+void ilist_append(ListNode *pHead, ListNode *pNode);
+
+/* Retire pNode de la liste qui le contient. O(1). */
+void ilist_remove(ListNode *pNode);
+
+/* Retire et renvoie le premier element, NULL si la liste est vide. */
+ListNode *ilist_pop_first(ListNode *pHead);
+
 #endif /* __LIST_H__ */
 
 
@@ -8,6 +8,8 @@
     --------------------------------------------------------------------
     CHANGELOG:
     12 Apr. 2017 -  Régis Blanchot - first release
+    19 Oct. 2026 -  table driven encoding and decoding
+                    Manchester_nibbler returns 0xFF for any illegal code
     --------------------------------------------------------------------
     TODO:
     --------------------------------------------------------------------
@@ -36,7 +38,7 @@
     synchronous bit stream. In this technique, the actual binary data to
     be transmitted over the cable or RF link are not sent as a sequence
     of logic 1's and 0's as in RS-232 (known technically as Non Return
-    to Zero (NRZ)). Instead, the bits are translated u16o a slightly
+    to Zero (NRZ)). Instead, the bits are translated into a slightly
     different format that has a number of advantages over using straight
     binary encoding (ie NRZ).
 
@@ -45,14 +47,15 @@
     2. Error detection is simple to implement
 
     In general, when transmitting serial data to a radio receiver, a DC
-    component of zero must be mau16ained (over a finite time). This is
-    so the demodulator in the receiver can properly u16erpret
+    component of zero must be maintained (over a finite time). This is
+    so the demodulator in the receiver can properly interpret
     (discriminate) the received data as 1's and 0's. Manchester encoding
     allows us to do this.
 
-    Manchester encoding follows the rules:
-    1. If the original data is a Logic 0, the Manchester code is: 0 to 1 (upward transition at bit centre)
-    2. If the original data is a Logic 1, the Manchester code is: 1 to 0 (downward transition at bit centre)
+    Manchester encoding follows the rules (IEEE 802.3 convention, the
+    one of the tables below and of RF433MHz) :
+    1. If the original data is a Logic 1, the Manchester code is: 0 to 1 (upward transition at bit centre)
+    2. If the original data is a Logic 0, the Manchester code is: 1 to 0 (downward transition at bit centre)
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -79,9 +82,38 @@ u8 Manchester_nibbler(u8);
 u8 Manchester_decode(u8*);
 void Manchester_encode (u8, u8*);
 
-//u8   RF433MHz_decodeMessage(u16 m, u8 &id, u8 &data); //decode 8 bit payload and 4 bit ID from the message, return 1 of checksum is correct, otherwise 0
-//u16  RF433MHz_encodeMessage(u8 id, u8 data); //encode 8 bit payload, 4 bit ID and 4 bit checksum into 16 bit
+/*  --------------------------------------------------------------------
+    Lookup tables
+    --------------------------------------------------------------------
+    Each data bit gives a pair of bits, 01 for a 1 and 10 for a 0, the
+    least significant data bit in the least significant pair.
+    Sent most significant bit first, a 1 is a low to high transition
+    at bit centre.
+    ------------------------------------------------------------------*/
 
+// nibble -> encoded byte
+const u8 Manchester_encodeTable[16] = {
+    0xAA, 0xA9, 0xA6, 0xA5, 0x9A, 0x99, 0x96, 0x95,
+    0x6A, 0x69, 0x66, 0x65, 0x5A, 0x59, 0x56, 0x55 };
+
+// encoded byte -> nibble, 0xFF if the byte holds an illegal pair
+const u8 Manchester_decodeTable[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0x0E, 0xFF, 0xFF, 0x0D, 0x0C, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0B, 0x0A, 0xFF, 0xFF, 0x09, 0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x06, 0xFF, 0xFF, 0x05, 0x04, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x03, 0x02, 0xFF, 0xFF, 0x01, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
 
 /*  --------------------------------------------------------------------
     Encode
@@ -93,24 +125,8 @@ void Manchester_encode (u8, u8*);
 
 void Manchester_encode(u8 txbyte, u8* encoded)
 {
-    u16 i, j, b, me;
-
-    b = txbyte;
-
-    for (i = 0; i<2; i++)
-    {
-        me = 0; // manchester encoded txbyte
-        for(j = 0; j<4; j++)
-        {
-            me >>=2;
-            if (b&1) 
-                me |= 0b01000000; // 1->0
-            else
-                me |= 0b10000000; // 0->1
-            b >>= 1;
-        }
-        encoded[i] = me;
-    }
+    encoded[0] = Manchester_encodeTable[txbyte & 0x0F];
+    encoded[1] = Manchester_encodeTable[txbyte >> 4];
 }
 
 /*  --------------------------------------------------------------------
@@ -122,37 +138,34 @@ void Manchester_encode(u8 txbyte, u8* encoded)
 
 u8 Manchester_decode(u8* received)
 {
-    return ( (Manchester_nibbler(received[1])*16)^(Manchester_nibbler(received[0])) );
+    return (Manchester_decodeTable[received[1]] << 4) |
+           (Manchester_decodeTable[received[0]] & 0x0F);
+}
+
+/*  --------------------------------------------------------------------
+    Check
+    --------------------------------------------------------------------
+    u8* encoded     an array of two bytes that represent the manchester
+                    encoded byte.
+    @return         1 if both bytes only hold legal pairs
+    ------------------------------------------------------------------*/
+
+u8 Manchester_check(u8* received)
+{
+    return (Manchester_decodeTable[received[0]] |
+            Manchester_decodeTable[received[1]]) != 0xFF;
 }
 
 /*  --------------------------------------------------------------------
     Nibbler
     --------------------------------------------------------------------
     u8 encoded      byte to decode.
+    @return         decoded nibble or 0xFF if illegal
     ------------------------------------------------------------------*/
 
 u8 Manchester_nibbler(u8 encoded)
 {
-    u8 i, dec, enc, pattern;
-
-    enc = encoded;
-    if (enc == 0xF0)
-        return 0xF0;
-
-    dec = 0;
-    for(i = 0; i<4; i++) 
-    {
-        dec >>=1;
-        pattern = enc & 0b11;
-        if (pattern == 0b01)
-            BitSet(dec, 3);
-        else if(pattern == 0b10)
-            BitClear(dec, 3);
-        else // illegal code
-            return 0xFF;
-        enc >>=2;
-    }
-    return dec;
+    return Manchester_decodeTable[encoded];
 }
 
 #endif // __MANCHESTER_C
@@ -11,6 +11,9 @@
     10 Nov. 2010 - Régis Blanchot - first release
     08 Feb. 2016 - Régis Blanchot - excluded float support (%f) for the 16F1459
     28 Nov. 2016 - Régis Blanchot - updated to have the same file for P8 and P32
+    19 Oct. 2026 - integer-only float formatter (%f), correctly rounded
+                   up to 9 (P32) or 7 (P8) digits, fixed-point (%q) support,
+                   span sink (pprintfw) to send whole runs of chars
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -42,7 +45,29 @@
 #define UPPERCASE       'A'
 #define LOWERCASE       'a'
 
+#ifdef __PIC32MX__
+#define PRINTF_SINK_LEN 64      // chars sent at once to a funcwrite sink
+#else
+#define PRINTF_SINK_LEN 16
+#endif
+
 funcout pputchar;               // void pputchar(u8)
+funcwrite pwrite;               // void pwrite(const u8 *, u16)
+u8 psink[PRINTF_SINK_LEN];      // pending chars for pwrite
+u8 psinklen = 0;
+
+/*  --------------------------------------------------------------------
+    pflush = send the pending chars to the span sink
+    ------------------------------------------------------------------*/
+
+void pflush()
+{
+    if (psinklen)
+    {
+        pwrite(psink, psinklen);
+        psinklen = 0;
+    }
+}
 
 /*  --------------------------------------------------------------------
     pprintc = pinguino print char
@@ -55,6 +80,12 @@ void pprintc(u8 **str, u8 c)
         **str = c;
         ++(*str);
     }
+    else if (pwrite)
+    {
+        psink[psinklen++] = c;
+        if (psinklen == PRINTF_SINK_LEN)
+            pflush();
+    }
     else
     {
         pputchar(c);
@@ -200,41 +231,95 @@ u8 pprinti(u8 **out, u32 i, u8 islong, u8 base, u8 sign, u8 width, u8 pad, u8 se
 
 #if !defined(__16F1459) && !defined(__18f13k50) && !defined(__18f14k50)
 /*  --------------------------------------------------------------------
-    pprintfl = pinguino print float
+    Integer-only decimal formatting
     --------------------------------------------------------------------
-    The IEEE 754 standard specifies a binary32 (float) as having:
-        Sign bit: 1 bit
-        Exponent width: 8 bits
-        Significand precision: 24 bits (23 explicitly stored)
+    The fractional part of a number is held as an unsigned binary
+    fraction of PRINTF_FBITS bits. Multiplying it by 10 moves the next
+    decimal digit into the upper bits without overflow, so no floating
+    point operation is needed.
+    A float below 1 has up to 149 fractional bits. P32 keeps 60 of them,
+    the lost ones can't change the 9th digit. P8 has no 64-bit type and
+    28 bits are not enough, the fractional digits of a float are computed
+    from the exact product mantissa x 10^precision instead (see
+    pprintfl). Both round half to even like printf.
+    ------------------------------------------------------------------*/
+
+#ifdef __PIC32MX__
+typedef u64 pint_t;
+typedef u64 pfrac_t;
+#define PRINTF_FBITS    60
+#define PRINTF_MAXPREC  9
+#else
+typedef u32 pint_t;
+typedef u32 pfrac_t;
+#define PRINTF_FBITS    28
+#define PRINTF_MAXPREC  7       // 10^7 < 2^24, see pprintfl
+const u32 ppow10[PRINTF_MAXPREC + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+#endif
+#define PRINTF_FLT_LEN  32      // sign + 20 digits + '.' + 9 digits + '\0'
+
+// fractional bits of %q numbers
+#ifdef FIXEDPT_FBITS
+#define PRINTF_QBITS    FIXEDPT_FBITS
+#else
+#define PRINTF_QBITS    16
+#endif
+
+/*  --------------------------------------------------------------------
+    pprintdigits = pinguino print integer part and decimal digits
     --------------------------------------------------------------------
-    out        : pointer to output function
-    value      : floating point value
+    neg        : 1 if the number is negative
+    int_part   : integer part
+    digit      : fractional digits (0 to 9), already rounded
     width      : number of Zeros or Spaces
     pad        : PAD_RIGHT or PAD_ZERO
-    separator  : thousands separator (1=ON, 0=OFF)
-    precision  : number of digits after comma (from 0 to 6)
+    precision  : number of digits after the decimal point
     return     : string's length
     ------------------------------------------------------------------*/
 
-#ifndef __PIC32MX__
-u8 pprintfl(u8 **out, float value, u8 width, u8 pad, u8 separator, u8 precision)
-#else
-u8 pprintfl(u8 **out, double value, u8 width, u8 pad, u8 separator, u8 precision)
-#endif
+u8 pprintdigits(u8 **out, u8 neg, pint_t int_part, const u8 *digit, u8 width, u8 pad, u8 precision)
 {
-    u8 i, toPrint;
-    u32 int_part;
-    float frac_part, rounding;
-
-    u8 buffer[PRINTF_BUF_LEN], *string = buffer;
-    u8 tmp[PRINTF_BUF_LEN], *s = tmp;
-    u8 count = 0, m = 0;
-    u8 length = PRINTF_BUF_LEN - 1;
-    
-    // Handle negative numbers
+    u8 buffer[PRINTF_FLT_LEN];
+    u8 *string = buffer + PRINTF_FLT_LEN - 1;
+    u8 i, count = 0;
+    u32 chunk;
+
+    // The string is more easily written backwards
     // -----------------------------------------------------------------
-    
-    if (value < 0.0)
+
+    *string = '\0';
+
+    for (i = precision; i > 0; i--)
+        *--string = digit[i - 1] + '0';
+
+    if (precision)
+        *--string = '.';
+
+    // 9 digits at a time so that only 32-bit divisions are used
+    do
+    {
+        #ifdef __PIC32MX__
+        if (int_part > 999999999)
+        {
+            chunk = int_part % 1000000000;
+            int_part /= 1000000000;
+            for (i = 0; i < 9; i++)
+            {
+                *--string = chunk % 10 + '0';
+                chunk /= 10;
+            }
+            continue;
+        }
+        #endif
+        chunk = int_part;
+        int_part = 0;
+        do {
+            *--string = chunk % 10 + '0';
+            chunk /= 10;
+        } while (chunk);
+    } while (int_part);
+
+    if (neg)
     {
         if (width && (pad & PAD_ZERO))
         {
@@ -244,260 +329,247 @@ u8 pprintfl(u8 **out, double value, u8 width, u8 pad, u8 separator, u8 precision
         }
         else
         {
-            *string++ = '-';
-            length--;
+            *--string = '-';
         }
-        value = -value;
     }
 
-    // Round correctly so that print(1.999, 2) prints as "2.00"
-    // -----------------------------------------------------------------
-    /*
-    rounding = 0.5;
-    for (i=0; i<precision; ++i)
-        rounding /= 10.0;
-    value += rounding;
-    */
-    // Extract the integer part of the number and print it  
+    return count + pprints(out, string, width, pad);
+}
+
+/*  --------------------------------------------------------------------
+    pprintdec = pinguino print decimal number
+    --------------------------------------------------------------------
+    neg        : 1 if the number is negative
+    int_part   : integer part
+    frac_part  : fractional part (PRINTF_FBITS-bit binary fraction)
+    width      : number of Zeros or Spaces
+    pad        : PAD_RIGHT or PAD_ZERO
+    precision  : number of digits after the decimal point
+    return     : string's length
+    ------------------------------------------------------------------*/
+
+u8 pprintdec(u8 **out, u8 neg, pint_t int_part, pfrac_t frac_part, u8 width, u8 pad, u8 precision)
+{
+    u8 digit[PRINTF_MAXPREC];
+    u8 i, odd;
+    pfrac_t half = (pfrac_t)1 << (PRINTF_FBITS - 1);
+
+    if (precision > PRINTF_MAXPREC)
+        precision = PRINTF_MAXPREC;
+
+    // Extract the fractional digits one at a time
     // -----------------------------------------------------------------
-    
-    int_part  = (u32)value;
-    frac_part = value - (float)int_part;
 
-    // the string is more easily written backwards
-    while (int_part)
+    for (i = 0; i < precision; i++)
     {
-        *s++ = int_part % 10 + '0';// decimal base
-        int_part /= 10;
-        m++;                    // string's length counter
-        length--;               // space remaining
-    }
-    // now the string is written in the right direction
-    while (m--)
-    {
-        *string++ = *--s;
-        /*----- TODO separator -------------------------------------
-        if ( separator && (m % 3 == 0) )
-        {
-            pprintc(out, ' ');
-            ++count;
-            --width;
-        }
-        ----------------------------------------------------------*/
+        frac_part = (frac_part << 3) + (frac_part << 1);   // x10
+        digit[i] = frac_part >> PRINTF_FBITS;
+        frac_part &= ((pfrac_t)1 << PRINTF_FBITS) - 1;
     }
 
-    // Add fractional part to string
+    // Round to nearest so that print(1.999, 2) prints as "2.00"
     // -----------------------------------------------------------------
-    
-    if (precision > 6)
-        precision = 6;
-
-    // check if we still have enough space
-    if (precision > length)
-        precision = length;
- 
-    // otherwise, number has no fractional part
-    if (precision > 0)
-    {
-        // add the decimal point to string
-        *string++ = '.';
 
-        while (precision-- > 0)
-        //for (m = 0; m < precision; m++)
+    odd = precision ? digit[precision - 1] & 1 : int_part & 1;
+
+    if (frac_part > half || (frac_part == half && odd))
+    {
+        for (i = precision; i > 0; i--)
         {
-            // Extract digits from the frac_part one at a time
-            // multiplies frac_part by 10 by adding 8 times and 2 times; 
-            //frac_part = (frac_part << 3) + (frac_part << 1);
-            frac_part *= 10.0;
-            toPrint = (unsigned int)frac_part;
-            // print binary-coded decimal (BCD)
-            // converts leading digits to number character
-            //*string++ = (frac_part >> 24) + '0';
-            *string++ =  toPrint + '0';
-            // strips off leading digits
-            //frac_part &= 0xFFFFFF;
-            frac_part -= (float)toPrint;
+            if (++digit[i - 1] < 10)
+                break;
+            digit[i - 1] = 0;
         }
+        if (i == 0)                 // carry into the integer part
+            int_part++;
     }
 
-    /*
+    return pprintdigits(out, neg, int_part, digit, width, pad, precision);
+}
+
+/*  --------------------------------------------------------------------
+    pprintfl = pinguino print float
+    --------------------------------------------------------------------
+    The IEEE 754 standard specifies a binary32 (float) as having:
+        Sign bit: 1 bit
+        Exponent width: 8 bits
+        Significand precision: 24 bits (23 explicitly stored)
+    value = mantissa * 2^(exponent - 127 - 23)
+    --------------------------------------------------------------------
+    out        : pointer to output function
+    value      : floating point value
+    width      : number of Zeros or Spaces
+    pad        : PAD_RIGHT or PAD_ZERO
+    separator  : thousands separator (1=ON, 0=OFF)
+    precision  : number of digits after comma (from 0 to 9 on P32, 7 on P8)
+    return     : string's length
+    ------------------------------------------------------------------*/
+
+#ifndef __PIC32MX__
+u8 pprintfl(u8 **out, float value, u8 width, u8 pad, u8 separator, u8 precision)
+#else
+u8 pprintfl(u8 **out, double value, u8 width, u8 pad, u8 separator, u8 precision)
+#endif
+{
     union
     {
         float f;
         u32 l;
     } helper;
-    /
-    
-    u32 helper;
-    u32 int_part  = 0;
-    u32 frac_part = 0;
-
-    u32 mantissa;   // bits <0:22>
-    s8  exponent;    // bits <23:30>
-    u8  sign;        // bit  <31>
-
-    u8 buffer[PRINTF_BUF_LEN], *string = buffer;
-    u8 tmp[PRINTF_BUF_LEN], *s = tmp;
-    u8 count = 0, m, t;
-    u8 length = PRINTF_BUF_LEN - 1;
-   
-    /* 
-    #ifndef __PIC32MX__
-    helper.f = value;
+
+    u32 mantissa;
+    s16 exponent;
+    u8  sign;
+    #ifdef __PIC32MX__
+    s8  shift;
+    pfrac_t frac_part = 0;
     #else
-    helper.f = (float)value;
+    u8  digit[PRINTF_MAXPREC];
+    u8  i, s, odd;
+    u32 q, lo, hi, mid, hb, lb, t;
     #endif
-    /
-    
-    // takes last 23 bits and adds the implicit 1
-    //mantissa = (helper.l & 0x7FFFFF) | 0x800000;
-    helper = *((u32*)&value);
-    mantissa = (helper & 0x7FFFFF) | 0x800000;
-    
-    // shifts the 23 bits of mantissa out,
-    // takes the next 8 bits
-    // then subtracts 127 to get an exponent value in the range −126 .. +127
-    //exponent = ((helper.l >> 23) & 0xFF) - 127;
-    helper = helper >> 23;
-    exponent = (helper & 0xFF) -127 ;
-    
-    // sign is 31st bit
-    //sign = helper.l >> 31;
-    helper = helper >> 8;
-    sign = (helper & 0x01);
-
-    // add negative sign if applicable
-    // (1 for negative, 0 for positive)
-    //if (helper.l < 0)
-    if (sign)
+    pint_t  int_part  = 0;
+
+    helper.f = (float)value;
+    sign     = helper.l >> 31;
+    exponent = (helper.l >> 23) & 0xFF;
+    mantissa = helper.l & 0x7FFFFF;
+
+    // Not a number and infinities
+    // -----------------------------------------------------------------
+
+    if (exponent == 0xFF)
     {
-        if (width && (pad & PAD_ZERO))
-        {
-            pprintc(out, '-');
-            ++count;
-            --width;
-        }
-        else
-        {
-            *string++ = '-';
-            length--;
-        }
+        if (mantissa)
+            return pprints(out, (const u8 *)"nan", width, pad);
+        return pprints(out, sign ? (const u8 *)"-inf" : (const u8 *)"inf", width, pad);
     }
 
-    /*
-    if ( (exponent >= 31) || (exponent < -23) )
+    // Add the implicit 1 (denormals don't have it)
+    // -----------------------------------------------------------------
+
+    if (exponent)
+        mantissa |= 0x800000;
+    else
+        exponent = 1;
+
+    exponent -= 127 + 23;           // value = mantissa * 2^exponent
+
+    // Split into integer and fractional parts
+    // -----------------------------------------------------------------
+
+    if (exponent >= 0)
     {
-        buffer[0] = 'i';
-        buffer[1] = 'n';
-        buffer[2] = 'f';
-        buffer[3] = '\0';
-        return pprints(out, buffer, width, pad);
+        // too big for the integer part
+        if (exponent + 24 > (s16)(sizeof(pint_t) * 8))
+            return pprints(out, sign ? (const u8 *)"-ovf" : (const u8 *)"ovf", width, pad);
+        int_part = (pint_t)mantissa << exponent;
+        mantissa = 0;
     }
-    /
-    
-    if (exponent >= 38)
+    else if (exponent > -24)
     {
-        buffer[0] = '+';
-        buffer[1] = 'i';
-        buffer[2] = 'n';
-        buffer[3] = 'f';
-        buffer[4] = '\0';
-        return pprints(out, buffer, width, pad);
+        int_part = mantissa >> -exponent;
+        mantissa &= ((u32)1 << -exponent) - 1;
     }
 
-    else if (exponent < -38)
-    {
-        buffer[0] = '-';
-        buffer[1] = 'i';
-        buffer[2] = 'n';
-        buffer[3] = 'f';
-        buffer[4] = '\0';
-        return pprints(out, buffer, width, pad);
-        /*
-        int_part  = 0;
-        frac_part = 0;
-        /
-    }
+    #ifdef __PIC32MX__
 
-    else if (exponent >= 23)
-    {
-        int_part = mantissa << (exponent - 23);
-    }
+    // align the remaining bits on the binary point
+    shift = PRINTF_FBITS + exponent;
+    if (shift >= 0)
+        frac_part = (pfrac_t)mantissa << shift;
+    else if (shift > -32)
+        frac_part = mantissa >> -shift;
 
-    else if (exponent >= 0) 
-    {
-        int_part  = mantissa >> (23 - exponent);
-        frac_part = (mantissa << (exponent + 1)) & 0xFFFFFF; // mfh
-    }
+    return pprintdec(out, sign, int_part, frac_part, width, pad, precision);
 
-    else // if (exponent < 0)
-        frac_part = (mantissa & 0xFFFFFF) >> -(exponent + 1);
+    #else
 
-    // add integer part to string
-    if (int_part == 0)
-    {
-        *string++ = '0';
-        length--;
-    }
+    // q = mantissa * 10^precision / 2^-exponent, rounded half to even
+    // the product (48 bits max.) is computed exactly in hi:lo
+    // -----------------------------------------------------------------
 
-    else
+    if (precision > PRINTF_MAXPREC)
+        precision = PRINTF_MAXPREC;
+
+    q = 0;
+    if (mantissa && exponent >= -48)
     {
-        m = 0;
-        // the string is more easily written backwards
-        while (int_part)
+        s = -exponent;
+        t = ppow10[precision];
+
+        lo  = (mantissa & 0xFFFF) * (t & 0xFFFF);
+        mid = (mantissa >> 16) * (t & 0xFFFF) + (mantissa & 0xFFFF) * (t >> 16);
+        hi  = (mantissa >> 16) * (t >> 16) + (mid >> 16);
+        mid <<= 16;
+        lo += mid;
+        if (lo < mid)
+            hi++;
+
+        // q = hi:lo >> s, hi:lo = remainder, hb:lb = half
+        if (s >= 32)
         {
-            t = int_part % 10;      // decimal base
-            *s++ = t + '0';
-            int_part /= 10;
-            m++;                    // string's length counter
-            length--;
+            q = hi >> (s - 32);
+            hi &= ((u32)1 << (s - 32)) - 1;
         }
-        // now the string is written in the right direction
-        while (m--)
+        else
         {
-            *string++ = *--s;
-            /*----- TODO separator -------------------------------------
-            if ( separator && (m % 3 == 0) )
-            {
-                pprintc(out, ' ');
-                ++count;
-                --width;
-            }
-            ----------------------------------------------------------/
+            q = (lo >> s) | (hi << (32 - s));
+            lo &= ((u32)1 << s) - 1;
+            hi = 0;
         }
+
+        hb = s > 32 ? (u32)1 << (s - 33) : 0;
+        lb = s > 32 ? 0 : (u32)1 << (s - 1);
+
+        odd = precision ? q & 1 : int_part & 1;
+
+        if (hi > hb || (hi == hb && (lo > lb || (lo == lb && odd))))
+            q++;
     }
-    
-    // add fractional part to string
-    if (precision > 6)
-        precision = 6;
-
-    // check if we have enough space
-    if (precision > length)
-        precision = length;
- 
-    // otherwise, number has no fractional part
-    if (precision >= 1)
+
+    if (q == ppow10[precision])     // carry into the integer part
     {
-        // add the decimal point to string
-        *string++ = '.';
+        q = 0;
+        int_part++;
+    }
 
-        // print binary-coded decimal (BCD)
-        for (m = 0; m < precision; m++)
-        {
-            // multiplies frac_part by 10 by adding 8 times and 2 times; 
-            frac_part = (frac_part << 3) + (frac_part << 1); 
-            // converts leading digits to number character
-            *string++ = (frac_part >> 24) + '0';
-            // strips off leading digits
-            frac_part &= 0xFFFFFF;
-        }
+    for (i = precision; i > 0; i--)
+    {
+        digit[i - 1] = q % 10;
+        q /= 10;
     }
-    */
 
-    // end of string
-    *string++ = '\0';
+    return pprintdigits(out, sign, int_part, digit, width, pad, precision);
 
-    return count + pprints(out, buffer, width, pad);
+    #endif
+}
+
+/*  --------------------------------------------------------------------
+    pprintq = pinguino print fixed-point number
+    --------------------------------------------------------------------
+    value      : signed 32-bit number with PRINTF_QBITS fractional bits
+                 (FIXEDPT_FBITS if fixedptc.h is included first)
+    width      : number of Zeros or Spaces
+    pad        : PAD_RIGHT or PAD_ZERO
+    precision  : number of digits after comma
+    return     : string's length
+    ------------------------------------------------------------------*/
+
+u8 pprintq(u8 **out, s32 value, u8 width, u8 pad, u8 precision)
+{
+    u8 neg = 0;
+    u32 u = value;
+
+    if (value < 0)
+    {
+        neg = 1;
+        u = -value;
+    }
+
+    return pprintdec(out, neg, u >> PRINTF_QBITS,
+        (pfrac_t)(u & (((u32)1 << PRINTF_QBITS) - 1)) << (PRINTF_FBITS - PRINTF_QBITS),
+        width, pad, precision);
 }
 
 #endif // !defined(16F1459)
@@ -596,6 +668,13 @@ u8 pprint(u8 **out, const u8 *format, va_list args)
                 #endif
                 continue;
             }
+
+            // fixed-point
+            if (*format == 'q')
+            {
+                pc += pprintq(out, va_arg(args, s32), width, pad, precision);
+                continue;
+            }
             
             #endif // !defined(__16F1459)
             /*--------------------------------------------------------*/
@@ -703,6 +782,7 @@ u8 pprint(u8 **out, const u8 *format, va_list args)
         }
     }
     if (out) **out = '\0';
+    else if (pwrite) pflush();
 
     return pc;
 }
@@ -720,6 +800,24 @@ u8 pprint(u8 **out, const u8 *format, va_list args)
 u8 pprintf(funcout func, const u8 *format, va_list args)
 {
     pputchar = func;
+    pwrite = 0;
+    return pprint(0, format, args);
+}
+
+/*  --------------------------------------------------------------------
+    pprintfw = pinguino print formatted to a span sink
+    --------------------------------------------------------------------
+    func    : pointer on output function receiving runs of chars
+              (up to PRINTF_SINK_LEN chars per call)
+    format  : pointer on string with % tags
+    args    : list of variable arguments
+    return  : string's length
+    ------------------------------------------------------------------*/
+
+u8 pprintfw(funcwrite func, const u8 *format, va_list args)
+{
+    pwrite = func;
+    psinklen = 0;
     return pprint(0, format, args);
 }
 
@@ -730,7 +828,8 @@ u8 pprintf(funcout func, const u8 *format, va_list args)
     format  : pointer on string with % tags
     args    : list of variable arguments
     return  : string's length
-    Note    : this function is called from CDC.printf only
+    Note    : CDC.printf uses pprintfw, a long string could overflow
+              the USB buffer
     ------------------------------------------------------------------*/
 
 u8 psprintf2(u8 *out, const u8 *format, va_list args)
@@ -198,3 +198,424 @@ void MahonyQuaternionUpdate(float ax, float ay, float az, float gx, float gy, fl
     q[2] = q3 * norm;
     q[3] = q4 * norm;
 }
+
+#if defined(QUATERNIONFX)
+
+/*  --------------------------------------------------------------------
+    FIXED-POINT SENSOR FUSION
+    --------------------------------------------------------------------
+    Same filters without any float operation at run time.
+    * quaternion and internal values are Q8.24 (s32) : same resolution
+      as a float around 1.0, with room for the Madgwick gradient terms
+    * inputs are Q16.16 : accelerometer and magnetometer in any unit
+      (only their direction is used), gyroscope in degrees/s.
+      This is the MPU9250_sample_t layout of the MPU9250 library.
+    * Euler angles are returned in degrees Q16.16
+    ------------------------------------------------------------------*/
+
+typedef s32 q24_t;
+
+#define Q24(x)          ((q24_t)((x) * 16777216.0f))
+#define q24_mul(a, b)   ((q24_t)(((s64)(a) * (b)) >> 24))
+
+#define QFX_PI          52707179                // PI in Q8.24
+#define QFX_DEG2RAD     292818                  // PI/180 in Q8.24
+#define QFX_RAD2DEG     3754936                 // 180/PI in Q16.16
+#define QFX_BETA        Q24(0.8660254f * GyroMeasError)
+#define QFX_KP          Q24(Kp)
+#define QFX_KI          Q24(Ki)
+
+// quaternion and sample period for both fixed-point filters
+q24_t qfx[4] = {Q24(1.0f), 0, 0, 0};
+q24_t qfxdeltat = Q24(0.01f);                   // 10ms
+q24_t qfxeInt[3] = {0, 0, 0};
+
+/*  --------------------------------------------------------------------
+    fxrsqrt
+    * integer reciprocal square root
+    * n = m * 4^k with m in [2^60, 2^62)
+    * returns r = 2^30 / sqrt(m / 2^62), ie 1/sqrt(n) = r / 2^(61 + k)
+    * a 12-entry table gives 4 bits, 3 Newton steps give 30 bits
+    ------------------------------------------------------------------*/
+
+const u32 fxrsqrt_seed[12] = {
+    2024667000, 1831380208, 1684624773, 1568300315,
+    1473161629, 1393471397, 1325455684, 1266516759,
+    1214800200, 1168942037, 1127913670, 1090922784 };
+
+u32 fxrsqrt(u64 n, s8 *k)
+{
+    s8 e = 0;
+    u32 x;
+    s64 r, t;
+    u8 i;
+
+    while (n >= ((u64)1 << 62)) { n >>= 2; e++; }
+    while (n <  ((u64)1 << 60)) { n <<= 2; e--; }
+
+    x = n >> 32;                                // m / 2^62 in Q2.30
+    r = fxrsqrt_seed[(x >> 26) - 4];
+
+    for (i = 0; i < 3; i++)                     // r = r * (3 - x * r^2) / 2
+    {
+        t = (r * r) >> 30;
+        t = ((s64)x * t) >> 30;
+        r = (r * (((s64)3 << 30) - t)) >> 31;
+    }
+
+    *k = e;
+    return (u32)r;
+}
+
+/*  --------------------------------------------------------------------
+    fxsqrt
+    * integer square root, sqrt(m) = m * rsqrt(m)
+    ------------------------------------------------------------------*/
+
+u32 fxsqrt(u64 n)
+{
+    u32 r;
+    s8 k;
+
+    if (n == 0)
+        return 0;
+    r = fxrsqrt(n, &k);
+    n = (k >= 0) ? n >> (2 * k) : n << (-2 * k);  // m in [2^60, 2^62)
+    n = ((n >> 32) * r) >> 29;
+    return (k >= 0) ? (u32)(n << k) : (u32)(n >> -k);
+}
+
+/*  --------------------------------------------------------------------
+    fxnormalize
+    * scale the n components of v to a Q8.24 unit vector
+    * returns 0 if v is null
+    ------------------------------------------------------------------*/
+
+u8 fxnormalize(s32 *v, u8 n)
+{
+    u64 n2 = 0;
+    u32 r;
+    s8 k;
+    u8 i;
+
+    for (i = 0; i < n; i++)
+        n2 += (s64)v[i] * v[i];
+    if (n2 == 0)
+        return 0;
+
+    r = fxrsqrt(n2, &k);
+    for (i = 0; i < n; i++)                     // v * 2^24 / sqrt(n2)
+        v[i] = ((s64)v[i] * r) >> (37 + k);
+    return 1;
+}
+
+/*  --------------------------------------------------------------------
+    fxatan2
+    * CORDIC in vectoring mode, returns atan2(y, x) in Q8.24 radians
+    * x and y may have any scale
+    ------------------------------------------------------------------*/
+
+const q24_t fxatan_table[24] = {
+    13176795, 7778716, 4110060, 2086331, 1047214, 524117, 262123, 131069,
+    65536, 32768, 16384, 8192, 4096, 2048, 1024, 512, 256, 128, 64, 32,
+    16, 8, 4, 2 };
+
+q24_t fxatan2(s32 y, s32 x)
+{
+    q24_t z = 0;
+    s32 t;
+    u8 i;
+
+    if (x == 0 && y == 0)
+        return 0;
+
+    // keep 2 bits of headroom for the CORDIC gain (1.647)
+    while (x > (1L << 28) || x < -(1L << 28) || y > (1L << 28) || y < -(1L << 28))
+    {
+        x >>= 1;
+        y >>= 1;
+    }
+    while (x < (1L << 27) && x > -(1L << 27) && y < (1L << 27) && y > -(1L << 27))
+    {
+        x <<= 1;
+        y <<= 1;
+    }
+
+    // rotate into the right half-plane
+    if (x < 0)
+    {
+        x = -x;
+        y = -y;
+        z = (y > 0) ? -QFX_PI : QFX_PI;
+    }
+
+    for (i = 0; i < 24; i++)
+    {
+        t = x;
+        if (y > 0)
+        {
+            x += y >> i;
+            y -= t >> i;
+            z += fxatan_table[i];
+        }
+        else
+        {
+            x -= y >> i;
+            y += t >> i;
+            z -= fxatan_table[i];
+        }
+    }
+    return z;
+}
+
+/*  --------------------------------------------------------------------
+    fxintegrate
+    * q += 0.5 * q x (0, g) * deltat, then normalize
+    * qd is the feedback term (Madgwick) or NULL
+    ------------------------------------------------------------------*/
+
+void fxintegrate(q24_t *g, q24_t *qd)
+{
+    q24_t q1 = qfx[0], q2 = qfx[1], q3 = qfx[2], q4 = qfx[3];
+    q24_t hx = q24_mul(g[0], qfxdeltat) >> 1;   // 0.5 * g * deltat
+    q24_t hy = q24_mul(g[1], qfxdeltat) >> 1;
+    q24_t hz = q24_mul(g[2], qfxdeltat) >> 1;
+
+    qfx[0] += q24_mul(-q2, hx) - q24_mul(q3, hy) - q24_mul(q4, hz);
+    qfx[1] += q24_mul( q1, hx) + q24_mul(q3, hz) - q24_mul(q4, hy);
+    qfx[2] += q24_mul( q1, hy) - q24_mul(q2, hz) + q24_mul(q4, hx);
+    qfx[3] += q24_mul( q1, hz) + q24_mul(q2, hy) - q24_mul(q3, hx);
+
+    if (qd)
+    {
+        qfx[0] -= q24_mul(qd[0], qfxdeltat);
+        qfx[1] -= q24_mul(qd[1], qfxdeltat);
+        qfx[2] -= q24_mul(qd[2], qfxdeltat);
+        qfx[3] -= q24_mul(qd[3], qfxdeltat);
+    }
+
+    fxnormalize(qfx, 4);
+}
+
+/*  --------------------------------------------------------------------
+    fxinputs
+    * Q16.16 sample -> unit accel and mag, gyro in rad/s (Q8.24)
+    ------------------------------------------------------------------*/
+
+u8 fxinputs(const s32 *sample, q24_t *a, q24_t *g, q24_t *m)
+{
+    u8 i;
+
+    for (i = 0; i < 3; i++)
+    {
+        a[i] = sample[i];
+        g[i] = ((s64)sample[3 + i] * QFX_DEG2RAD) >> 16;
+        m[i] = sample[6 + i];
+    }
+    return fxnormalize(a, 3) && fxnormalize(m, 3);
+}
+
+/*  --------------------------------------------------------------------
+    MadgwickQuaternionUpdateFx
+    * sample : ax, ay, az, gx, gy, gz, mx, my, mz in Q16.16
+    ------------------------------------------------------------------*/
+
+void MadgwickQuaternionUpdateFx(const s32 *sample)
+{
+    q24_t a[3], g[3], m[3], s[4];
+    q24_t q1 = qfx[0], q2 = qfx[1], q3 = qfx[2], q4 = qfx[3];
+    q24_t hx, hy, _2bx, _2bz, _4bx, _4bz;
+    q24_t _2q1mx, _2q1my, _2q1mz, _2q2mx;
+    q24_t _2q1 = 2 * q1, _2q2 = 2 * q2, _2q3 = 2 * q3, _2q4 = 2 * q4;
+    q24_t q1q1 = q24_mul(q1, q1), q1q2 = q24_mul(q1, q2);
+    q24_t q1q3 = q24_mul(q1, q3), q1q4 = q24_mul(q1, q4);
+    q24_t q2q2 = q24_mul(q2, q2), q2q3 = q24_mul(q2, q3);
+    q24_t q2q4 = q24_mul(q2, q4), q3q3 = q24_mul(q3, q3);
+    q24_t q3q4 = q24_mul(q3, q4), q4q4 = q24_mul(q4, q4);
+    q24_t _2q1q3 = 2 * q1q3, _2q3q4 = 2 * q3q4;
+    q24_t ea, eb, ec, fa, fb, fc;
+
+    if (!fxinputs(sample, a, g, m))
+        return;
+
+    // Reference direction of Earth's magnetic field
+    _2q1mx = 2 * q24_mul(q1, m[0]);
+    _2q1my = 2 * q24_mul(q1, m[1]);
+    _2q1mz = 2 * q24_mul(q1, m[2]);
+    _2q2mx = 2 * q24_mul(q2, m[0]);
+    hx = q24_mul(m[0], q1q1) - q24_mul(_2q1my, q4) + q24_mul(_2q1mz, q3)
+       + q24_mul(m[0], q2q2) + q24_mul(q24_mul(_2q2, m[1]), q3)
+       + q24_mul(q24_mul(_2q2, m[2]), q4) - q24_mul(m[0], q3q3) - q24_mul(m[0], q4q4);
+    hy = q24_mul(_2q1mx, q4) + q24_mul(m[1], q1q1) - q24_mul(_2q1mz, q2)
+       + q24_mul(_2q2mx, q3) - q24_mul(m[1], q2q2) + q24_mul(m[1], q3q3)
+       + q24_mul(q24_mul(_2q3, m[2]), q4) - q24_mul(m[1], q4q4);
+    s[0] = hx; s[1] = hy; s[2] = 0;             // |h| = sqrt(hx^2 + hy^2)
+    _2bx = fxnormalize(s, 2) ? q24_mul(hx, s[0]) + q24_mul(hy, s[1]) : 0;
+    _2bz = -q24_mul(_2q1mx, q3) + q24_mul(_2q1my, q2) + q24_mul(m[2], q1q1)
+         + q24_mul(_2q2mx, q4) - q24_mul(m[2], q2q2) + q24_mul(q24_mul(_2q3, m[1]), q4)
+         - q24_mul(m[2], q3q3) + q24_mul(m[2], q4q4);
+    _4bx = 2 * _2bx;
+    _4bz = 2 * _2bz;
+
+    // Errors between estimated and measured directions
+    ea = 2 * q2q4 - _2q1q3 - a[0];
+    eb = 2 * q1q2 + _2q3q4 - a[1];
+    ec = Q24(1.0f) - 2 * q2q2 - 2 * q3q3 - a[2];
+    fa = q24_mul(_2bx, Q24(0.5f) - q3q3 - q4q4) + q24_mul(_2bz, q2q4 - q1q3) - m[0];
+    fb = q24_mul(_2bx, q2q3 - q1q4) + q24_mul(_2bz, q1q2 + q3q4) - m[1];
+    fc = q24_mul(_2bx, q1q3 + q2q4) + q24_mul(_2bz, Q24(0.5f) - q2q2 - q3q3) - m[2];
+
+    // Gradient decent algorithm corrective step
+    s[0] = -q24_mul(_2q3, ea) + q24_mul(_2q2, eb)
+         - q24_mul(q24_mul(_2bz, q3), fa)
+         + q24_mul(-q24_mul(_2bx, q4) + q24_mul(_2bz, q2), fb)
+         + q24_mul(q24_mul(_2bx, q3), fc);
+    s[1] = q24_mul(_2q4, ea) + q24_mul(_2q1, eb) - q24_mul(4 * q2, ec)
+         + q24_mul(q24_mul(_2bz, q4), fa)
+         + q24_mul(q24_mul(_2bx, q3) + q24_mul(_2bz, q1), fb)
+         + q24_mul(q24_mul(_2bx, q4) - q24_mul(_4bz, q2), fc);
+    s[2] = -q24_mul(_2q1, ea) + q24_mul(_2q4, eb) - q24_mul(4 * q3, ec)
+         + q24_mul(-q24_mul(_4bx, q3) - q24_mul(_2bz, q1), fa)
+         + q24_mul(q24_mul(_2bx, q2) + q24_mul(_2bz, q4), fb)
+         + q24_mul(q24_mul(_2bx, q1) - q24_mul(_4bz, q3), fc);
+    s[3] = q24_mul(_2q2, ea) + q24_mul(_2q3, eb)
+         + q24_mul(-q24_mul(_4bx, q4) + q24_mul(_2bz, q2), fa)
+         + q24_mul(-q24_mul(_2bx, q1) + q24_mul(_2bz, q3), fb)
+         + q24_mul(q24_mul(_2bx, q2), fc);
+
+    // normalise step magnitude and apply beta
+    if (fxnormalize(s, 4))
+    {
+        s[0] = q24_mul(s[0], QFX_BETA);
+        s[1] = q24_mul(s[1], QFX_BETA);
+        s[2] = q24_mul(s[2], QFX_BETA);
+        s[3] = q24_mul(s[3], QFX_BETA);
+        fxintegrate(g, s);
+    }
+    else
+    {
+        fxintegrate(g, NULL);
+    }
+}
+
+/*  --------------------------------------------------------------------
+    MahonyQuaternionUpdateFx
+    * sample : ax, ay, az, gx, gy, gz, mx, my, mz in Q16.16
+    ------------------------------------------------------------------*/
+
+void MahonyQuaternionUpdateFx(const s32 *sample)
+{
+    q24_t a[3], g[3], m[3], h[3];
+    q24_t q1 = qfx[0], q2 = qfx[1], q3 = qfx[2], q4 = qfx[3];
+    q24_t hx, hy, bx, bz;
+    q24_t vx, vy, vz, wx, wy, wz;
+    q24_t ex, ey, ez;
+    q24_t q1q1 = q24_mul(q1, q1), q1q2 = q24_mul(q1, q2);
+    q24_t q1q3 = q24_mul(q1, q3), q1q4 = q24_mul(q1, q4);
+    q24_t q2q2 = q24_mul(q2, q2), q2q3 = q24_mul(q2, q3);
+    q24_t q2q4 = q24_mul(q2, q4), q3q3 = q24_mul(q3, q3);
+    q24_t q3q4 = q24_mul(q3, q4), q4q4 = q24_mul(q4, q4);
+
+    if (!fxinputs(sample, a, g, m))
+        return;
+
+    // Reference direction of Earth's magnetic field
+    hx = 2 * (q24_mul(m[0], Q24(0.5f) - q3q3 - q4q4) + q24_mul(m[1], q2q3 - q1q4) + q24_mul(m[2], q2q4 + q1q3));
+    hy = 2 * (q24_mul(m[0], q2q3 + q1q4) + q24_mul(m[1], Q24(0.5f) - q2q2 - q4q4) + q24_mul(m[2], q3q4 - q1q2));
+    h[0] = hx; h[1] = hy; h[2] = 0;
+    bx = fxnormalize(h, 2) ? q24_mul(hx, h[0]) + q24_mul(hy, h[1]) : 0;
+    bz = 2 * (q24_mul(m[0], q2q4 - q1q3) + q24_mul(m[1], q3q4 + q1q2) + q24_mul(m[2], Q24(0.5f) - q2q2 - q3q3));
+
+    // Estimated direction of gravity and magnetic field
+    vx = 2 * (q2q4 - q1q3);
+    vy = 2 * (q1q2 + q3q4);
+    vz = q1q1 - q2q2 - q3q3 + q4q4;
+    wx = 2 * (q24_mul(bx, Q24(0.5f) - q3q3 - q4q4) + q24_mul(bz, q2q4 - q1q3));
+    wy = 2 * (q24_mul(bx, q2q3 - q1q4) + q24_mul(bz, q1q2 + q3q4));
+    wz = 2 * (q24_mul(bx, q1q3 + q2q4) + q24_mul(bz, Q24(0.5f) - q2q2 - q3q3));
+
+    // Error is cross product between estimated direction and measured direction of gravity
+    ex = (q24_mul(a[1], vz) - q24_mul(a[2], vy)) + (q24_mul(m[1], wz) - q24_mul(m[2], wy));
+    ey = (q24_mul(a[2], vx) - q24_mul(a[0], vz)) + (q24_mul(m[2], wx) - q24_mul(m[0], wz));
+    ez = (q24_mul(a[0], vy) - q24_mul(a[1], vx)) + (q24_mul(m[0], wy) - q24_mul(m[1], wx));
+
+    if (QFX_KI > 0)
+    {
+        qfxeInt[0] += ex;                       // accumulate integral error
+        qfxeInt[1] += ey;
+        qfxeInt[2] += ez;
+    }
+    else
+    {
+        qfxeInt[0] = 0;                         // prevent integral wind up
+        qfxeInt[1] = 0;
+        qfxeInt[2] = 0;
+    }
+
+    // Apply feedback terms
+    g[0] += q24_mul(QFX_KP, ex) + q24_mul(QFX_KI, qfxeInt[0]);
+    g[1] += q24_mul(QFX_KP, ey) + q24_mul(QFX_KI, qfxeInt[1]);
+    g[2] += q24_mul(QFX_KP, ez) + q24_mul(QFX_KI, qfxeInt[2]);
+
+    fxintegrate(g, NULL);
+}
+
+/*  --------------------------------------------------------------------
+    Sample period and batch update
+    ------------------------------------------------------------------*/
+
+// period in microseconds
+void QuaternionFx_setPeriod(u32 us)
+{
+    qfxdeltat = ((u64)us << 24) / 1000000;
+}
+
+// n samples of 9 Q16.16 values, stride s32 between two samples
+// (eg. a burst of MPU9250_sample_t : stride = 9)
+void MadgwickQuaternionUpdateFxBatch(const s32 *samples, u8 n, u8 stride)
+{
+    for ( ; n; n--, samples += stride)
+        MadgwickQuaternionUpdateFx(samples);
+}
+
+void MahonyQuaternionUpdateFxBatch(const s32 *samples, u8 n, u8 stride)
+{
+    for ( ; n; n--, samples += stride)
+        MahonyQuaternionUpdateFx(samples);
+}
+
+/*  --------------------------------------------------------------------
+    Euler angles in degrees (Q16.16)
+    ------------------------------------------------------------------*/
+
+s32 QuaternionFx_getYaw(s32 declination)
+{
+    q24_t x = 2 * (q24_mul(qfx[1], qfx[2]) + q24_mul(qfx[0], qfx[3]));
+    q24_t y = q24_mul(qfx[0], qfx[0]) + q24_mul(qfx[1], qfx[1])
+            - q24_mul(qfx[2], qfx[2]) - q24_mul(qfx[3], qfx[3]);
+    return (((s64)fxatan2(x, y) * QFX_RAD2DEG) >> 24) + declination;
+}
+
+s32 QuaternionFx_getPitch()
+{
+    // asin(x) = atan2(x, sqrt(1 - x^2))
+    q24_t x = 2 * (q24_mul(qfx[1], qfx[3]) - q24_mul(qfx[0], qfx[2]));
+    q24_t c;
+
+    if (x >= Q24(1.0f))
+        return -(90L << 16);
+    if (x <= -Q24(1.0f))
+        return 90L << 16;
+    c = fxsqrt((u64)(Q24(1.0f) - q24_mul(x, x)) << 24);
+    return -(((s64)fxatan2(x, c) * QFX_RAD2DEG) >> 24);
+}
+
+s32 QuaternionFx_getRoll()
+{
+    q24_t x = 2 * (q24_mul(qfx[0], qfx[1]) + q24_mul(qfx[2], qfx[3]));
+    q24_t y = q24_mul(qfx[0], qfx[0]) - q24_mul(qfx[1], qfx[1])
+            - q24_mul(qfx[2], qfx[2]) + q24_mul(qfx[3], qfx[3]);
+    return ((s64)fxatan2(x, y) * QFX_RAD2DEG) >> 24;
+}
+
+#endif /* QUATERNIONFX */
@@ -0,0 +1,302 @@
+/*  --------------------------------------------------------------------
+    FILE:           mrf24j40_queue.c
+    PROJECT:        pinguino
+    PURPOSE:        MRF24J40 packet queues and FIFO burst access
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    The MRF24J40 holds one received frame and one frame to transmit,
+    a new frame off air overwrites the previous one. Each frame is
+    moved as soon as the radio raises RXIF to a queue of packets, the
+    application reads them when it has time. Frames to send wait in
+    another queue, the next one is loaded in the TX FIFO when the
+    radio tells (TXNIF) the previous one has been acknowledged or has
+    failed after its retries.
+
+    The FIFOs are read and written with sequential long address
+    accesses (the MRF24J40 increments the address as long as CS is
+    low) : 2 address bytes per burst instead of 2 per data byte.
+
+    RX FIFO (0x300) : [len][frame ...][fcs][fcs][lqi][rssi]
+    TX FIFO (0x000) : [header len][frame len][frame ...]
+                      (the radio adds the FCS)
+
+    A queue is filled by one side and emptied by the other (interrupt
+    and main loop), head and tail are u8 each written by one side only
+    so no lock is needed. The number of slots must be a power of 2.
+
+    Only uses the mrf24j40_xxx_read/write routines and can be tested
+    on a host with a fake radio.
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    ------------------------------------------------------------------*/
+
+#ifndef __MRF24J40_QUEUE_C
+#define __MRF24J40_QUEUE_C
+
+#include <typedef.h>
+#include "mrf24j40.h"
+
+// longest payload, 127 - 11 (short addresses header) - 2 (FCS) at most
+#ifndef MRF24J40_MAXPAYLOAD
+    #if defined(__PIC32MX__)
+    #define MRF24J40_MAXPAYLOAD 114
+    #else
+    #define MRF24J40_MAXPAYLOAD 32
+    #endif
+#endif
+
+#define MRF24J40_TXFIFO         0x000
+#define MRF24J40_RXFIFO         0x300
+
+// frame control, seq, dest PAN, dest, src PAN, src (extended addresses)
+#define MRF24J40_MAXHEADER      23
+// short dest and src addresses, no PAN ID compression
+#define MRF24J40_SHORTHEADER    11
+
+// address given to a node which uses its extended address
+#define MRF24J40_EXTENDED       0xFFFE
+
+typedef struct
+{
+    u8  length;                     // payload bytes
+    u8  type;                       // FTDATA, ...
+    u8  ack;                        // acknowledgement requested
+    u8  seq;                        // sequence number
+    u8  lqi;                        // link quality (received packets)
+    u8  rssi;                       // signal strength (received packets)
+    u16 destpan;
+    u16 destadd;
+    u16 srcpan;
+    u16 srcadd;
+    u8  data[MRF24J40_MAXPAYLOAD];
+} mrf24j40_packet_t;
+
+typedef struct
+{
+    mrf24j40_packet_t *slot;
+    u8 size;                        // number of slots, power of 2
+    volatile u8 head;               // written by the producer only
+    volatile u8 tail;               // written by the consumer only
+} mrf24j40_queue_t;
+
+/*  --------------------------------------------------------------------
+    Queue
+    --------------------------------------------------------------------
+    The producer fills the slot given by back() then push() it, the
+    consumer reads the slot given by front() then pop() it. back()
+    and front() return NULL when the queue is full or empty.
+    ------------------------------------------------------------------*/
+
+void mrf24j40_queue_init(mrf24j40_queue_t *q, mrf24j40_packet_t *slot, u8 size)
+{
+    q->slot = slot;
+    q->size = size;
+    q->head = 0;
+    q->tail = 0;
+}
+
+u8 mrf24j40_queue_count(mrf24j40_queue_t *q)
+{
+    return (u8)(q->head - q->tail);
+}
+
+mrf24j40_packet_t *mrf24j40_queue_back(mrf24j40_queue_t *q)
+{
+    if (mrf24j40_queue_count(q) == q->size)
+        return NULL;
+    return &q->slot[q->head & (q->size - 1)];
+}
+
+void mrf24j40_queue_push(mrf24j40_queue_t *q)
+{
+    q->head++;
+}
+
+mrf24j40_packet_t *mrf24j40_queue_front(mrf24j40_queue_t *q)
+{
+    if (q->head == q->tail)
+        return NULL;
+    return &q->slot[q->tail & (q->size - 1)];
+}
+
+void mrf24j40_queue_pop(mrf24j40_queue_t *q)
+{
+    q->tail++;
+}
+
+/*  --------------------------------------------------------------------
+    mrf24j40_frame_header
+    --------------------------------------------------------------------
+    @param:     fc      frame control, LSB first
+    @return:    MAC header size (frame control to source address) or
+                0 if an addressing mode is reserved
+    ------------------------------------------------------------------*/
+
+u8 mrf24j40_frame_header(const u8 *fc)
+{
+    u8 dmode = (fc[1] >> 2) & 3;
+    u8 smode = (fc[1] >> 6) & 3;
+    u8 h = 3;
+
+    if (dmode == 1 || smode == 1)
+        return 0;
+
+    if (dmode)
+        h += (dmode == 3) ? 10 : 4;
+
+    if (smode)
+    {
+        if (!(dmode && (fc[0] & 0x40)))  // no PAN ID compression
+            h += 2;
+        h += (smode == 3) ? 8 : 2;
+    }
+
+    return h;
+}
+
+/*  --------------------------------------------------------------------
+    mrf24j40_frame_parse
+    --------------------------------------------------------------------
+    @descr:     header fields of a received frame to the packet
+    @param:     hdr     MAC header, mrf24j40_frame_header() bytes
+    ------------------------------------------------------------------*/
+
+void mrf24j40_frame_parse(mrf24j40_packet_t *p, const u8 *hdr)
+{
+    u8 dmode = (hdr[1] >> 2) & 3;
+    u8 smode = (hdr[1] >> 6) & 3;
+    u8 i = 3;
+
+    p->type = hdr[0] & 7;
+    p->ack = (hdr[0] >> 5) & 1;
+    p->seq = hdr[2];
+    p->destpan = 0xFFFF;
+    p->destadd = 0xFFFF;
+    p->srcpan = 0xFFFF;
+    p->srcadd = 0xFFFF;
+
+    if (dmode)
+    {
+        p->destpan = hdr[i] | (hdr[i + 1] << 8);
+        i += 2;
+        if (dmode == 3)
+        {
+            p->destadd = MRF24J40_EXTENDED;
+            i += 8;
+        }
+        else
+        {
+            p->destadd = hdr[i] | (hdr[i + 1] << 8);
+            i += 2;
+        }
+    }
+
+    if (smode)
+    {
+        if (dmode && (hdr[0] & 0x40))
+            p->srcpan = p->destpan;
+        else
+        {
+            p->srcpan = hdr[i] | (hdr[i + 1] << 8);
+            i += 2;
+        }
+        if (smode == 3)
+            p->srcadd = MRF24J40_EXTENDED;
+        else
+            p->srcadd = hdr[i] | (hdr[i + 1] << 8);
+    }
+}
+
+/*  --------------------------------------------------------------------
+    mrf24j40_frame_receive
+    --------------------------------------------------------------------
+    @descr:     moves the frame in the RX FIFO to the queue, to be
+                called when RXIF is set
+    @return:    1 if queued, 0 if dropped (queue full, frame too long
+                or malformed)
+    ------------------------------------------------------------------*/
+
+u8 mrf24j40_frame_receive(mrf24j40_queue_t *q)
+{
+    mrf24j40_packet_t *p = mrf24j40_queue_back(q);
+    u8 hdr[MRF24J40_MAXHEADER + 1];
+    u8 n, h, ok = 0;
+
+    // no more frames off air while the FIFO is read
+    mrf24j40_short_addr_write(BBREG1, 1 << BBREG1_RXDECINV);
+
+    // frame length (with the FCS) and frame control
+    mrf24j40_long_addr_read_burst(MRF24J40_RXFIFO, hdr, 3);
+    n = hdr[0];
+    h = mrf24j40_frame_header(hdr + 1);
+
+    if (p != NULL && h != 0 && n >= h + 2 && n - h - 2 <= MRF24J40_MAXPAYLOAD)
+    {
+        // sequence number and addresses
+        mrf24j40_long_addr_read_burst(MRF24J40_RXFIFO + 3, hdr + 3, h - 2);
+        mrf24j40_frame_parse(p, hdr + 1);
+
+        p->length = n - h - 2;
+        mrf24j40_long_addr_read_burst(MRF24J40_RXFIFO + 1 + h, p->data, p->length);
+
+        // LQI and RSSI follow the FCS
+        mrf24j40_long_addr_read_burst(MRF24J40_RXFIFO + 1 + n, hdr, 2);
+        p->lqi = hdr[0];
+        p->rssi = hdr[1];
+
+        mrf24j40_queue_push(q);
+        ok = 1;
+    }
+
+    mrf24j40_short_addr_write(BBREG1, 0);
+    return ok;
+}
+
+/*  --------------------------------------------------------------------
+    mrf24j40_frame_transmit
+    --------------------------------------------------------------------
+    @descr:     loads the packet in the TX FIFO with short addresses
+                and starts the transmission, TXNIF tells when it's over
+    ------------------------------------------------------------------*/
+
+void mrf24j40_frame_transmit(mrf24j40_packet_t *p)
+{
+    u8 fifo[MRF24J40_SHORTHEADER + 2];
+
+    fifo[0]  = MRF24J40_SHORTHEADER;
+    fifo[1]  = MRF24J40_SHORTHEADER + p->length;
+    fifo[2]  = p->type | (p->ack ? 0x20 : 0);
+    fifo[3]  = 0b10001000;          // short dest and src addresses
+    fifo[4]  = p->seq;
+    fifo[5]  = p->destpan & 0xFF;
+    fifo[6]  = p->destpan >> 8;
+    fifo[7]  = p->destadd & 0xFF;
+    fifo[8]  = p->destadd >> 8;
+    fifo[9]  = p->srcpan & 0xFF;
+    fifo[10] = p->srcpan >> 8;
+    fifo[11] = p->srcadd & 0xFF;
+    fifo[12] = p->srcadd >> 8;
+
+    mrf24j40_long_addr_write_burst(MRF24J40_TXFIFO, fifo, sizeof(fifo));
+    mrf24j40_long_addr_write_burst(MRF24J40_TXFIFO + sizeof(fifo), p->data, p->length);
+
+    mrf24j40_short_addr_write(TXNCON, (1 << TXNCON_TXNTRIG) |
+                                      (p->ack ? (1 << TXNCON_TXNACKREQ) : 0));
+}
+
+#endif /* __MRF24J40_QUEUE_C */
@@ -12,6 +12,8 @@
     18 Oct. 2016 - Régis Blanchot - changed PIC16F1459 and PIC1xK50 numbering
     24 Nov. 2016 - Régis Blanchot - fixed pin 12 (set it to RA5 while it was RA4) for PIC18F47J53
     05 Apr. 2017 - Régis Blanchot - added Pinguino 47J53B (aka Pinguino Torda)
+    19 Oct. 2026 - port and bit of each pin (_DPINn) and digitalwritefast,
+                   digitalreadfast, togglefast and pinmodefast macros
     --------------------------------------------------------------------
     TODO : 
     --------------------------------------------------------------------
@@ -68,6 +70,26 @@ const u8 port[18]={
                     pA, pA, pA, pC, pC, pC, pC, pC, pB,
                     pA, pA, pA, pC, pC, pC, pB, pB, pB };
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    A,5
+#define _DPIN1    A,4
+#define _DPIN2    A,3
+#define _DPIN3    C,5
+#define _DPIN4    C,4
+#define _DPIN5    C,3
+#define _DPIN6    C,6
+#define _DPIN7    C,7
+#define _DPIN8    B,7
+#define _DPIN9    A,0
+#define _DPIN10   A,1
+#define _DPIN11   A,2
+#define _DPIN12   C,0
+#define _DPIN13   C,1
+#define _DPIN14   C,2
+#define _DPIN15   B,4
+#define _DPIN16   B,5
+#define _DPIN17   B,6
+
 /**********************************************************************/
 #elif defined(PINGUINO1459) || defined(PINGUINO13K50) || defined(PINGUINO14K50) 
 /**********************************************************************/
@@ -88,6 +110,25 @@ const u8 port[18]={ pC, pC, pC, pC, pC, pC, pC, pC, // 00 - 07
                     pA, pA, pU, pA, pA, pA,         // 08 - 13    
                     pB, pB, pB, pB};                // 14 - 17
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    C,0
+#define _DPIN1    C,1
+#define _DPIN2    C,2
+#define _DPIN3    C,3
+#define _DPIN4    C,4
+#define _DPIN5    C,5
+#define _DPIN6    C,6
+#define _DPIN7    C,7
+#define _DPIN8    A,0
+#define _DPIN9    A,1
+#define _DPIN11   A,3
+#define _DPIN12   A,4
+#define _DPIN13   A,5
+#define _DPIN14   B,4
+#define _DPIN15   B,5
+#define _DPIN16   B,6
+#define _DPIN17   B,7
+
 /**********************************************************************/
 #elif defined(PINGUINO1220) || defined(PINGUINO1320)
 /**********************************************************************/
@@ -100,6 +141,22 @@ const u8 port[14]={
                     pB, pB, pB, pB, pB, pB, pB, pB, // 0 - 7
                     pA, pA, pA, pA, pA, pA};        // 8 - 13
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    B,0
+#define _DPIN1    B,1
+#define _DPIN2    B,2
+#define _DPIN3    B,3
+#define _DPIN4    B,4
+#define _DPIN5    B,5
+#define _DPIN6    B,6
+#define _DPIN7    B,7
+#define _DPIN8    A,0
+#define _DPIN9    A,1
+#define _DPIN10   A,2
+#define _DPIN11   A,3
+#define _DPIN12   A,4
+#define _DPIN13   A,5
+
 /**********************************************************************/
 #elif defined(__18f14k22)
 /**********************************************************************/
@@ -112,6 +169,26 @@ const u8 port[19]={
                     pA, pA, pA, pC, pC, pC, pC, pC, pB, // 0 - 8
                     pA, pA, pA, pC, pC, pC, pB, pB, pB }; // 9 - 17
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    A,5
+#define _DPIN1    A,4
+#define _DPIN2    A,3
+#define _DPIN3    C,5
+#define _DPIN4    C,4
+#define _DPIN5    C,3
+#define _DPIN6    C,6
+#define _DPIN7    C,7
+#define _DPIN8    B,7
+#define _DPIN9    A,0
+#define _DPIN10   A,1
+#define _DPIN11   A,2
+#define _DPIN12   C,0
+#define _DPIN13   C,1
+#define _DPIN14   C,2
+#define _DPIN15   B,4
+#define _DPIN16   B,5
+#define _DPIN17   B,6
+
 /**********************************************************************/
 #elif defined(AMICUS18)
 /**********************************************************************/
@@ -124,6 +201,26 @@ const u8 port[19]={
                     pA, pA, pA, pC, pC, pC, pC, pC, pB, // 0 - 8
                     pA, pA, pA, pC, pC, pC, pB, pB, pB }; // 9 - 17
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    A,5
+#define _DPIN1    A,4
+#define _DPIN2    A,3
+#define _DPIN3    C,5
+#define _DPIN4    C,4
+#define _DPIN5    C,3
+#define _DPIN6    C,6
+#define _DPIN7    C,7
+#define _DPIN8    B,7
+#define _DPIN9    A,0
+#define _DPIN10   A,1
+#define _DPIN11   A,2
+#define _DPIN12   C,0
+#define _DPIN13   C,1
+#define _DPIN14   C,2
+#define _DPIN15   B,4
+#define _DPIN16   B,5
+#define _DPIN17   B,6
+
 /**********************************************************************/
 #elif defined(PINGUINO2455) || defined(PINGUINO2550) || defined(PINGUINO25K50)
 /**********************************************************************/
@@ -138,6 +235,27 @@ const u8 port[19]={
                     pC, pC, pC, pC, pC,             // 8 - 12
                     pA, pA, pA, pA, pA, pA};        // 13 - 18
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    B,0
+#define _DPIN1    B,1
+#define _DPIN2    B,2
+#define _DPIN3    B,3
+#define _DPIN4    B,4
+#define _DPIN5    B,5
+#define _DPIN6    B,6
+#define _DPIN7    B,7
+#define _DPIN8    C,6
+#define _DPIN9    C,7
+#define _DPIN10   C,0
+#define _DPIN11   C,1
+#define _DPIN12   C,2
+#define _DPIN13   A,0
+#define _DPIN14   A,1
+#define _DPIN15   A,2
+#define _DPIN16   A,3
+#define _DPIN17   A,5
+#define _DPIN18   A,4
+
 /**********************************************************************/
 #elif defined(PINGUINO26J50) || defined(PINGUINO27J53)
 /**********************************************************************/
@@ -152,6 +270,26 @@ const u8 port[18]={
                     pC, pC, pC, pC, pC,             // 8 - 12
                     pA, pA, pA, pA, pA};            // 13 - 17
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    B,0
+#define _DPIN1    B,1
+#define _DPIN2    B,2
+#define _DPIN3    B,3
+#define _DPIN4    B,4
+#define _DPIN5    B,5
+#define _DPIN6    B,6
+#define _DPIN7    B,7
+#define _DPIN8    C,6
+#define _DPIN9    C,7
+#define _DPIN10   C,0
+#define _DPIN11   C,1
+#define _DPIN12   C,2
+#define _DPIN13   A,0
+#define _DPIN14   A,1
+#define _DPIN15   A,2
+#define _DPIN16   A,3
+#define _DPIN17   A,5
+
 /**********************************************************************/
 #elif defined(PINGUINO4455) || defined(PINGUINO4550)
 /**********************************************************************/
@@ -173,6 +311,38 @@ const u8 port[30]={
                     pD, pD, pD, pD, pD, pD, pD, pD,
                     pA};
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    B,0
+#define _DPIN1    B,1
+#define _DPIN2    B,2
+#define _DPIN3    B,3
+#define _DPIN4    B,4
+#define _DPIN5    B,5
+#define _DPIN6    B,6
+#define _DPIN7    B,7
+#define _DPIN8    C,6
+#define _DPIN9    C,7
+#define _DPIN10   C,0
+#define _DPIN11   C,1
+#define _DPIN12   C,2
+#define _DPIN13   A,0
+#define _DPIN14   A,1
+#define _DPIN15   A,2
+#define _DPIN16   A,3
+#define _DPIN17   A,5
+#define _DPIN18   E,0
+#define _DPIN19   E,1
+#define _DPIN20   E,2
+#define _DPIN21   D,0
+#define _DPIN22   D,1
+#define _DPIN23   D,2
+#define _DPIN24   D,3
+#define _DPIN25   D,4
+#define _DPIN26   D,5
+#define _DPIN27   D,6
+#define _DPIN28   D,7
+#define _DPIN29   A,4
+
 /**********************************************************************/
 #elif defined(PINGUINO45K50)
 /**********************************************************************/
@@ -193,6 +363,44 @@ const u8 port[36]={
                     pE, pE, pE, pE
                     };
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    B,0
+#define _DPIN1    B,1
+#define _DPIN2    B,2
+#define _DPIN3    B,3
+#define _DPIN4    B,4
+#define _DPIN5    B,5
+#define _DPIN6    B,6
+#define _DPIN7    B,7
+#define _DPIN8    A,0
+#define _DPIN9    A,1
+#define _DPIN10   A,2
+#define _DPIN11   A,3
+#define _DPIN12   A,4
+#define _DPIN13   A,5
+#define _DPIN14   A,6
+#define _DPIN15   A,7
+#define _DPIN16   C,0
+#define _DPIN17   C,1
+#define _DPIN18   C,2
+#define _DPIN19   C,3
+#define _DPIN20   C,4
+#define _DPIN21   C,5
+#define _DPIN22   C,6
+#define _DPIN23   C,7
+#define _DPIN24   D,0
+#define _DPIN25   D,1
+#define _DPIN26   D,2
+#define _DPIN27   D,3
+#define _DPIN28   D,4
+#define _DPIN29   D,5
+#define _DPIN30   D,6
+#define _DPIN31   D,7
+#define _DPIN32   E,0
+#define _DPIN33   E,1
+#define _DPIN34   E,2
+#define _DPIN35   E,3
+
 /**********************************************************************/
 #elif defined(PINGUINO46J50) || defined(PINGUINO47J53A)
 /**********************************************************************/
@@ -211,6 +419,39 @@ const u8 port[32]={
                     pD, pD, pD, pD, pD, pD, pD, pD  // 24 - 31
                     };            
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    B,0
+#define _DPIN1    B,1
+#define _DPIN2    B,2
+#define _DPIN3    B,3
+#define _DPIN4    B,4
+#define _DPIN5    B,5
+#define _DPIN6    B,6
+#define _DPIN7    B,7
+#define _DPIN8    A,0
+#define _DPIN9    A,1
+#define _DPIN10   A,2
+#define _DPIN11   A,3
+#define _DPIN12   A,5
+#define _DPIN13   E,0
+#define _DPIN14   E,1
+#define _DPIN15   E,2
+#define _DPIN16   C,0
+#define _DPIN17   C,1
+#define _DPIN18   C,2
+#define _DPIN20   C,4
+#define _DPIN21   C,5
+#define _DPIN22   C,6
+#define _DPIN23   C,7
+#define _DPIN24   D,0
+#define _DPIN25   D,1
+#define _DPIN26   D,2
+#define _DPIN27   D,3
+#define _DPIN28   D,4
+#define _DPIN29   D,5
+#define _DPIN30   D,6
+#define _DPIN31   D,7
+
 /**********************************************************************/
 #elif defined(PINGUINO47J53B) // AKA Pinguino Torda
 /**********************************************************************/
@@ -229,6 +470,39 @@ const u8 port[32]={
                     pD, pD, pD, pD, pD, pD, pD, pD  // 24 - 31
                     };            
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    B,0
+#define _DPIN1    B,1
+#define _DPIN2    B,2
+#define _DPIN3    B,3
+#define _DPIN4    B,4
+#define _DPIN5    B,5
+#define _DPIN6    B,6
+#define _DPIN7    B,7
+#define _DPIN8    C,0
+#define _DPIN9    C,1
+#define _DPIN10   C,2
+#define _DPIN12   C,4
+#define _DPIN13   C,5
+#define _DPIN14   C,6
+#define _DPIN15   C,7
+#define _DPIN16   A,0
+#define _DPIN17   A,1
+#define _DPIN18   A,2
+#define _DPIN19   A,3
+#define _DPIN20   A,5
+#define _DPIN21   E,0
+#define _DPIN22   E,1
+#define _DPIN23   E,2
+#define _DPIN24   D,0
+#define _DPIN25   D,1
+#define _DPIN26   D,2
+#define _DPIN27   D,3
+#define _DPIN28   D,4
+#define _DPIN29   D,5
+#define _DPIN30   D,6
+#define _DPIN31   D,7
+
 /**********************************************************************/
 #elif defined(FREEJALDUINO)
 /**********************************************************************/
@@ -237,6 +511,27 @@ const u8 mask[19]={_7,_6,_4,_0,_1,_2,_3,_4,_5,_6,_7,_0,_1,_2,_0,_1,_2,_3, _5};
 
 const u8 port[19]={1,1,2,0,0,0,0,0,0,0,0,1,1,1,2,2,2,2,2};
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    B,7
+#define _DPIN1    B,6
+#define _DPIN2    C,4
+#define _DPIN3    A,0
+#define _DPIN4    A,1
+#define _DPIN5    A,2
+#define _DPIN6    A,3
+#define _DPIN7    A,4
+#define _DPIN8    A,5
+#define _DPIN9    A,6
+#define _DPIN10   A,7
+#define _DPIN11   B,0
+#define _DPIN12   B,1
+#define _DPIN13   B,2
+#define _DPIN14   C,0
+#define _DPIN15   C,1
+#define _DPIN16   C,2
+#define _DPIN17   C,3
+#define _DPIN18   C,5
+
 /**********************************************************************/
 #elif defined(PICUNO_EQUO)
 /**********************************************************************/
@@ -253,6 +548,29 @@ const u8 port[19]={1,1,2,0,0,0,0,0,0,0,0,1,1,1,2,2,2,2,2};
                         pB, pB, pB, pC, pC, pC,         // 8 - 13
                         pA, pA, pA, pA, pA, pE, pE, pE  // 14 - 21
                         };
+
+    // port and bit of each pin, for the fast macros
+    #define _DPIN0    C,7
+    #define _DPIN1    C,6
+    #define _DPIN2    A,4
+    #define _DPIN3    B,0
+    #define _DPIN4    B,1
+    #define _DPIN5    B,2
+    #define _DPIN6    B,3
+    #define _DPIN7    B,4
+    #define _DPIN8    B,5
+    #define _DPIN9    B,6
+    #define _DPIN10   B,7
+    #define _DPIN11   C,0
+    #define _DPIN12   C,1
+    #define _DPIN13   C,2
+    #define _DPIN14   A,0
+    #define _DPIN15   A,1
+    #define _DPIN16   A,2
+    #define _DPIN17   A,3
+    #define _DPIN18   A,5
+    #define _DPIN19   E,0
+    #define _DPIN20   E,1
     #else                // Second and last version (BLACK PCB)
     const u8 mask[21]={
                         _7,_6,_2,_3,_0,_2,_1,_1,        // 0 - 7
@@ -265,6 +583,29 @@ const u8 port[19]={1,1,2,0,0,0,0,0,0,0,0,1,1,1,2,2,2,2,2};
                         pD, pD, pD, pD, pD, pD,
                         pA, pA, pA, pA, pE, pE, pA
                         };
+
+    // port and bit of each pin, for the fast macros
+    #define _DPIN0    C,7
+    #define _DPIN1    C,6
+    #define _DPIN2    B,2
+    #define _DPIN3    B,3
+    #define _DPIN4    D,0
+    #define _DPIN5    C,2
+    #define _DPIN6    C,1
+    #define _DPIN7    D,1
+    #define _DPIN8    D,2
+    #define _DPIN9    D,3
+    #define _DPIN10   D,4
+    #define _DPIN11   D,5
+    #define _DPIN12   D,6
+    #define _DPIN13   D,7
+    #define _DPIN14   A,0
+    #define _DPIN15   A,1
+    #define _DPIN16   A,2
+    #define _DPIN17   A,5
+    #define _DPIN18   E,0
+    #define _DPIN19   E,1
+    #define _DPIN20   A,4
     #endif
 
 /**********************************************************************/
@@ -282,6 +623,29 @@ const u8 port[21]={
                     pA, pA, pA, pA, pA, pA, pA, pA  // 13 - 20
                     };
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    B,0
+#define _DPIN1    B,1
+#define _DPIN2    B,2
+#define _DPIN3    B,3
+#define _DPIN4    B,4
+#define _DPIN5    B,5
+#define _DPIN6    B,6
+#define _DPIN7    B,7
+#define _DPIN8    C,6
+#define _DPIN9    C,7
+#define _DPIN10   C,0
+#define _DPIN11   C,1
+#define _DPIN12   C,2
+#define _DPIN13   A,0
+#define _DPIN14   A,1
+#define _DPIN15   A,2
+#define _DPIN16   A,3
+#define _DPIN17   A,4
+#define _DPIN18   A,5
+#define _DPIN19   A,6
+#define _DPIN20   A,7
+
 /**********************************************************************/
 #elif defined(__18f4685)				// Added by Andrej Golac
 /**********************************************************************/
@@ -301,6 +665,44 @@ const u8 port[36] = {
             pE, pE, pE, pE			        // PORT E
             };
 
+// port and bit of each pin, for the fast macros
+#define _DPIN0    A,0
+#define _DPIN1    A,1
+#define _DPIN2    A,2
+#define _DPIN3    A,3
+#define _DPIN4    A,4
+#define _DPIN5    A,5
+#define _DPIN6    A,6
+#define _DPIN7    A,7
+#define _DPIN8    B,0
+#define _DPIN9    B,1
+#define _DPIN10   B,2
+#define _DPIN11   B,3
+#define _DPIN12   B,4
+#define _DPIN13   B,5
+#define _DPIN14   B,6
+#define _DPIN15   B,7
+#define _DPIN16   C,0
+#define _DPIN17   C,1
+#define _DPIN18   C,2
+#define _DPIN19   C,3
+#define _DPIN20   C,4
+#define _DPIN21   C,5
+#define _DPIN22   C,6
+#define _DPIN23   C,7
+#define _DPIN24   D,0
+#define _DPIN25   D,1
+#define _DPIN26   D,2
+#define _DPIN27   D,3
+#define _DPIN28   D,4
+#define _DPIN29   D,5
+#define _DPIN30   D,6
+#define _DPIN31   D,7
+#define _DPIN32   E,0
+#define _DPIN33   E,1
+#define _DPIN34   E,2
+#define _DPIN35   E,3
+
 /**********************************************************************/
 #else
 /**********************************************************************/
@@ -310,4 +712,30 @@ const u8 port[36] = {
 
 #endif
 
+/*  --------------------------------------------------------------------
+    Fast access to a pin known at compile time
+    --------------------------------------------------------------------
+    digitalwritefast(USERLED, HIGH) is a single bsf LATx,n instruction
+    instead of a call to digitalwrite() and its port[] and mask[]
+    lookup. The pin must be a number or a macro such as USERLED, a
+    variable doesn't compile (_DPINpin undeclared). Unlike
+    digitalwrite() and digitalread(), these don't stop the PWM output
+    of the pin.
+    ------------------------------------------------------------------*/
+
+#define digitalwritefast(pin, state)    _DWRITE(_DPIN(pin), state)
+#define digitalreadfast(pin)            _DREAD(_DPIN(pin))
+#define togglefast(pin)                 _DTOGGLE(_DPIN(pin))
+#define pinmodefast(pin, state)         _DMODE(_DPIN(pin), state)
+
+#define _DPIN(pin)                      _DPIN##pin
+#define _DWRITE(pb, state)              _DWRITE_(pb, state)
+#define _DWRITE_(p, b, state)           (LAT##p##bits.LAT##p##b = (state))
+#define _DREAD(pb)                      _DREAD_(pb)
+#define _DREAD_(p, b)                   (PORT##p##bits.R##p##b)
+#define _DTOGGLE(pb)                    _DTOGGLE_(pb)
+#define _DTOGGLE_(p, b)                 (LAT##p##bits.LAT##p##b ^= 1)
+#define _DMODE(pb, state)               _DMODE_(pb, state)
+#define _DMODE_(p, b, state)            (TRIS##p##bits.TRIS##p##b = (state))
+
 #endif /* __DIGITAL_H__ */
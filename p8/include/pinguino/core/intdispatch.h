@@ -0,0 +1,357 @@
+/*	----------------------------------------------------------------------------
+    FILE:			intdispatch.h
+    PROJECT:		pinguino
+    PURPOSE:		interrupt dispatch, included by interrupt.c
+    PROGRAMER:		Pinguino team
+    ----------------------------------------------------------------------------
+    CHANGELOG :
+    19 Oct. 2026 - first release
+    ----------------------------------------------------------------------------
+    One block per interrupt source, compiled only if its xxxINT flag is
+    defined : userhighinterrupt() and userlowinterrupt() test nothing
+    else than the interrupts used by the program, without any table or
+    indirect call other than the user function.
+
+    This file is included once per rank (INT_PASS = 0, 1 then 2) :
+    sources of rank 0 are served first, then rank 1 (default), then
+    rank 2. To change the order, define the rank before including
+    interrupt.c, ex. #define RCINT_RANK 0 to serve the UART first.
+
+    INT_PENDING(enable, flag, priority) is defined by the caller, it
+    selects the sources of its priority level (see IntSetPriority).
+    ----------------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    --------------------------------------------------------------------------*/
+
+// No include guard, only the ranks are defined once
+
+#ifndef __INTDISPATCH_H
+    #define __INTDISPATCH_H
+
+    // rank of each source, TMRxINT_RANK is also used by OnCounterX
+
+    #ifndef INT1INT_RANK
+    #define INT1INT_RANK  1
+    #endif
+    #ifndef INT2INT_RANK
+    #define INT2INT_RANK  1
+    #endif
+    #ifndef RBINT_RANK
+    #define RBINT_RANK    1
+    #endif
+    #ifndef TMR0INT_RANK
+    #define TMR0INT_RANK  1
+    #endif
+    #ifndef TMR1INT_RANK
+    #define TMR1INT_RANK  1
+    #endif
+    #ifndef TMR2INT_RANK
+    #define TMR2INT_RANK  1
+    #endif
+    #ifndef TMR3INT_RANK
+    #define TMR3INT_RANK  1
+    #endif
+    #ifndef TMR4INT_RANK
+    #define TMR4INT_RANK  1
+    #endif
+    #ifndef TMR5INT_RANK
+    #define TMR5INT_RANK  1
+    #endif
+    #ifndef TMR6INT_RANK
+    #define TMR6INT_RANK  1
+    #endif
+    #ifndef TMR8INT_RANK
+    #define TMR8INT_RANK  1
+    #endif
+    #ifndef ADINT_RANK
+    #define ADINT_RANK    1
+    #endif
+    #ifndef RCINT_RANK
+    #define RCINT_RANK    1
+    #endif
+    #ifndef TXINT_RANK
+    #define TXINT_RANK    1
+    #endif
+    #ifndef CCP1INT_RANK
+    #define CCP1INT_RANK  1
+    #endif
+    #ifndef CCP2INT_RANK
+    #define CCP2INT_RANK  1
+    #endif
+    #ifndef EEINT_RANK
+    #define EEINT_RANK    1
+    #endif
+    #ifndef USBINT_RANK
+    #define USBINT_RANK   1
+    #endif
+    #ifndef OSCFINT_RANK
+    #define OSCFINT_RANK  1
+    #endif
+    #ifndef CMINT_RANK
+    #define CMINT_RANK    1
+    #endif
+    #ifndef BCLINT_RANK
+    #define BCLINT_RANK   1
+    #endif
+    #ifndef HLVDINT_RANK
+    #define HLVDINT_RANK  1
+    #endif
+    #ifndef SSPINT_RANK
+    #define SSPINT_RANK   1
+    #endif
+    #ifndef PMPINT_RANK
+    #define PMPINT_RANK   1
+    #endif
+
+#endif /* __INTDISPATCH_H */
+
+#if defined(INT1INT) && (INT1INT_RANK == INT_PASS)
+    if (INT_PENDING(INTCON3bits.INT1IE, INTCON3bits.INT1IF, INTCON3bits.INT1IP))
+    {
+        INTCON3bits.INT1IF = 0;
+        intFunction[INT_INT1]();
+    }
+#endif
+
+#if defined(INT2INT) && (INT2INT_RANK == INT_PASS)
+    if (INT_PENDING(INTCON3bits.INT2IE, INTCON3bits.INT2IF, INTCON3bits.INT2IP))
+    {
+        INTCON3bits.INT2IF = 0;
+        intFunction[INT_INT2]();
+    }
+#endif
+
+#if defined(RBINT) && (RBINT_RANK == INT_PASS)
+    if (INT_PENDING(INTCONbits.RBIE, INTCONbits.RBIF, INTCON2bits.RBIP))
+    {
+        INTRB = (PORTB & 0xF0) ^ intLastPortB;
+        intLastPortB = (PORTB & 0xF0);
+        intFunction[INT_RB]();
+        INTCONbits.RBIF = 0;
+    }
+#endif
+
+#if (defined(TMR0INT) || defined(CNTR0INT)) && (TMR0INT_RANK == INT_PASS)
+    if (INT_PENDING(INTCONbits.TMR0IE, INTCONbits.TMR0IF, INTCON2bits.TMR0IP))
+    {
+        #ifdef TMR0INT
+            #ifdef __16F1459
+            TMR0 += low8(preload[INT_TMR0]);
+            #else
+            INT_RELOAD(TMR0H, TMR0L, INT_TMR0);
+            #endif
+        #endif
+        INTCONbits.TMR0IF = 0;
+        INT_TICK(INT_TMR0);
+    }
+#endif
+
+// Timer1 overflow : OnTimer1 without TMR1CCP, OnRTCC or OnCounter1
+#if (defined(TMR1INT) || defined(CNTR1INT)) && (TMR1INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE1bits.TMR1IE, PIR1bits.TMR1IF, IPR1bits.TMR1IP))
+    {
+        #ifdef TMR1INT
+        INT_RELOAD(TMR1H, TMR1L, INT_TMR1);
+        #endif
+        PIR1bits.TMR1IF = 0;
+        INT_TICK(INT_TMR1);
+    }
+#endif
+
+// Timer1 period : CCP1 has already reset Timer1
+#if defined(TMR1CCP) && (TMR1INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE1bits.CCP1IE, PIR1bits.CCP1IF, IPR1bits.CCP1IP))
+    {
+        PIR1bits.CCP1IF = 0;
+        INT_TICK(INT_TMR1);
+    }
+#endif
+
+#if defined(TMR2INT) && (TMR2INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE1bits.TMR2IE, PIR1bits.TMR2IF, IPR1bits.TMR2IP))
+    {
+        PIR1bits.TMR2IF = 0;
+        INT_TICK(INT_TMR2);
+        // NB : no need to reload PR2
+    }
+#endif
+
+#if (defined(TMR3INT) || defined(CNTR3INT)) && (TMR3INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE2bits.TMR3IE, PIR2bits.TMR3IF, IPR2bits.TMR3IP))
+    {
+        #ifdef TMR3INT
+        INT_RELOAD(TMR3H, TMR3L, INT_TMR3);
+        #endif
+        PIR2bits.TMR3IF = 0;
+        INT_TICK(INT_TMR3);
+    }
+#endif
+
+// Timer3 period : CCP2 has already reset Timer3
+#if defined(TMR3CCP) && (TMR3INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE2bits.CCP2IE, PIR2bits.CCP2IF, IPR2bits.CCP2IP))
+    {
+        PIR2bits.CCP2IF = 0;
+        INT_TICK(INT_TMR3);
+    }
+#endif
+
+#if defined(TMR4INT) && (TMR4INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE3bits.TMR4IE, PIR3bits.TMR4IF, IPR3bits.TMR4IP))
+    {
+        PIR3bits.TMR4IF = 0;
+        INT_TICK(INT_TMR4);
+        // NB : no need to reload PR4
+    }
+#endif
+
+#if defined(TMR5INT) && (TMR5INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE5bits.TMR5IE, PIR5bits.TMR5IF, IPR5bits.TMR5IP))
+    {
+        INT_RELOAD(TMR5H, TMR5L, INT_TMR5);
+        PIR5bits.TMR5IF = 0;
+        INT_TICK(INT_TMR5);
+    }
+#endif
+
+#if defined(TMR6INT) && (TMR6INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE5bits.TMR6IE, PIR5bits.TMR6IF, IPR5bits.TMR6IP))
+    {
+        PIR5bits.TMR6IF = 0;
+        INT_TICK(INT_TMR6);
+    }
+#endif
+
+#if defined(TMR8INT) && (TMR8INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE5bits.TMR8IE, PIR5bits.TMR8IF, IPR5bits.TMR8IP))
+    {
+        PIR5bits.TMR8IF = 0;
+        INT_TICK(INT_TMR8);
+    }
+#endif
+
+#if defined(ADINT) && (ADINT_RANK == INT_PASS)
+    if (INT_PENDING(PIE1bits.ADIE, PIR1bits.ADIF, IPR1bits.ADIP))
+    {
+        PIR1bits.ADIF = 0;
+        intFunction[INT_AD]();
+    }
+#endif
+
+#if defined(RCINT) && (RCINT_RANK == INT_PASS)
+    if (INT_PENDING(PIE1bits.RCIE, PIR1bits.RCIF, IPR1bits.RCIP))
+    {
+        PIR1bits.RCIF = 0;
+        intFunction[INT_RC]();
+    }
+#endif
+
+#if defined(TXINT) && (TXINT_RANK == INT_PASS)
+    if (INT_PENDING(PIE1bits.TXIE, PIR1bits.TXIF, IPR1bits.TXIP))
+    {
+        PIR1bits.TXIF = 0;
+        intFunction[INT_TX]();
+    }
+#endif
+
+#if defined(CCP1INT) && (CCP1INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE1bits.CCP1IE, PIR1bits.CCP1IF, IPR1bits.CCP1IP))
+    {
+        PIR1bits.CCP1IF = 0;
+        intFunction[INT_CCP1]();
+    }
+#endif
+
+#if defined(CCP2INT) && (CCP2INT_RANK == INT_PASS)
+    if (INT_PENDING(PIE2bits.CCP2IE, PIR2bits.CCP2IF, IPR2bits.CCP2IP))
+    {
+        PIR2bits.CCP2IF = 0;
+        intFunction[INT_CCP2]();
+    }
+#endif
+
+#if defined(EEINT) && (EEINT_RANK == INT_PASS)
+    if (INT_PENDING(PIE2bits.EEIE, PIR2bits.EEIF, IPR2bits.EEIP))
+    {
+        PIR2bits.EEIF = 0;
+        intFunction[INT_EE]();
+    }
+#endif
+
+#if defined(USBINT) && (USBINT_RANK == INT_PASS)
+    #if defined(__18f25k50) || defined(__18f45k50)
+    if (INT_PENDING(PIE3bits.USBIE, PIR3bits.USBIF, IPR3bits.USBIP))
+    {
+        PIR3bits.USBIF = 0;
+        intFunction[INT_USB]();
+    }
+    #else
+    if (INT_PENDING(PIE2bits.USBIE, PIR2bits.USBIF, IPR2bits.USBIP))
+    {
+        PIR2bits.USBIF = 0;
+        intFunction[INT_USB]();
+    }
+    #endif
+#endif
+
+#if defined(OSCFINT) && (OSCFINT_RANK == INT_PASS)
+    if (INT_PENDING(PIE2bits.OSCFIE, PIR2bits.OSCFIF, IPR2bits.OSCFIP))
+    {
+        PIR2bits.OSCFIF = 0;
+        intFunction[INT_OSCF]();
+    }
+#endif
+
+#if defined(CMINT) && (CMINT_RANK == INT_PASS)
+    if (INT_PENDING(PIE2bits.CMIE, PIR2bits.CMIF, IPR2bits.CMIP))
+    {
+        PIR2bits.CMIF = 0;
+        intFunction[INT_CM]();
+    }
+#endif
+
+#if defined(BCLINT) && (BCLINT_RANK == INT_PASS)
+    if (INT_PENDING(PIE2bits.BCLIE, PIR2bits.BCLIF, IPR2bits.BCLIP))
+    {
+        PIR2bits.BCLIF = 0;
+        intFunction[INT_BCL]();
+    }
+#endif
+
+#if defined(HLVDINT) && (HLVDINT_RANK == INT_PASS)
+    if (INT_PENDING(PIE2bits.HLVDIE, PIR2bits.HLVDIF, IPR2bits.HLVDIP))
+    {
+        PIR2bits.HLVDIF = 0;
+        intFunction[INT_HLVD]();
+    }
+#endif
+
+#if defined(SSPINT) && (SSPINT_RANK == INT_PASS)
+    if (INT_PENDING(PIE1bits.SSPIE, PIR1bits.SSPIF, IPR1bits.SSPIP))
+    {
+        PIR1bits.SSPIF = 0;
+        intFunction[INT_SSP]();
+    }
+#endif
+
+#if defined(__18f46j53) || defined(__18f47j53)
+#if defined(PMPINT) && (PMPINT_RANK == INT_PASS)
+    if (INT_PENDING(PIE1bits.PMPIE, PIR1bits.PMPIF, IPR1bits.PMPIP))
+    {
+        PIR1bits.PMPIF = 0;
+        intFunction[INT_PMP]();
+    }
+#endif
+#endif
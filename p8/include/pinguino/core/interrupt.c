@@ -12,6 +12,10 @@
     18 Apr. 2014 - Régis Blanchot - fixed OnTimer1 and 3 bug for x550 family
     20 Apr. 2014 - Régis Blanchot - added partial PIC18Fx7J53 support
     03 Feb. 2016 - Régis Blanchot - added partial PIC16F1459 support
+    19 Oct. 2026 - interrupt dispatch generated from the xxxINT flags
+                   in rank order (intdispatch.h), IntSetPriority fixed,
+                   drift-free Timer1/3 periods (CCP special event),
+                   exact timer periods, IntLatency measurement
     ----------------------------------------------------------------------------
     TODO :
     * INT3
@@ -61,18 +65,85 @@
     static callback intFunction[INT_NUM];
     u8  intUsed[INT_NUM];
 
-    // OnTimerX only
+    // OnTimerX and OnCounterX only
     #if defined(TMR0INT) || defined(TMR1INT) || \
         defined(TMR2INT) || defined(TMR3INT) || \
         defined(TMR4INT) || defined(TMR5INT) || \
-        defined(TMR6INT) || defined(TMR8INT) 
+        defined(TMR6INT) || defined(TMR8INT) || \
+        defined(CNTR0INT) || defined(CNTR1INT) || defined(CNTR3INT)
 
-    volatile u16 intCount[8];
-    volatile u16 intCountLimit[8];
-    volatile u8 preloadH[8];
-    volatile u8 preloadL[8];
+    volatile u16 intCount[9];               // INT_TMR0 to INT_TMR8
+    volatile u16 intCountLimit[9];
+    volatile u16 preload[9];                // added to the timer on overflow
 
     #endif
+
+    /*  Timer1 and Timer3 periods
+        With TMR1CCP (TMR3CCP) defined, CCP1 (CCP2) is set in Special
+        Event Trigger mode : the timer is reset by the hardware when
+        it matches CCPR1 (CCPR2), there is nothing to reload in the
+        interrupt and the period doesn't drift. The CCP module is not
+        available anymore for OnCompare, PWM, analogWrite or Servo.
+        CCP2 special event also starts an A/D conversion if ADON = 1.
+        Otherwise the period is added to the timer on each overflow,
+        the interrupt latency is kept but the few cycles of the
+        read-modify-write are lost. */
+
+    /*  Context save
+        With SDCC the low priority vector (main.c) saves the table
+        pointer and TABLAT around the dispatch, in case a callback
+        reads the program memory. The dispatch itself doesn't (no
+        table, see intdispatch.h) : if the callbacks don't either (no
+        const table or string), define INTFASTCONTEXT to skip it, 8
+        cycles on each side, IntLatencyEntry/Exit show the gain. The
+        high priority vector is left as it is, the libraries running
+        there read descriptors and strings. XC8 only saves what the
+        ISR uses. */
+
+    #if defined(INTLATENCY) && !defined(TMR1CCP)
+        #define TMR1CCP
+    #endif
+
+    #if defined(TMR1CCP)
+        #if !defined(TMR1INT) || defined(__16F1459)
+            #error "TMR1CCP and IntLatency need OnTimer1 on a PIC18F."
+        #endif
+        #if defined(CCP1INT) || defined(CMP1INT)
+            #error "TMR1CCP : CCP1 is already used by OnCompare1."
+        #endif
+        #if defined(__PWM__) || defined(ANALOGWRITE)
+            #error "TMR1CCP : CCP1 is already used by PWM or analogWrite."
+        #endif
+    #endif
+
+    #if defined(TMR3CCP)
+        #if !defined(__18f2455) && !defined(__18f4455) && \
+            !defined(__18f2550) && !defined(__18f4550)
+            #error "TMR3CCP is only available on 18F2455/2550/4455/4550."
+        #endif
+        #if defined(CCP2INT) || defined(CMP2INT)
+            #error "TMR3CCP : CCP2 is already used by OnCompare2."
+        #endif
+        #if defined(__PWM__) || defined(ANALOGWRITE)
+            #error "TMR3CCP : CCP2 is already used by PWM or analogWrite."
+        #endif
+    #endif
+
+    // ISR entry and exit worst case, in Timer1 ticks
+    #ifdef INTLATENCY
+    volatile u16 intLatencyEntry = 0;
+    volatile u16 intLatencyExit = 0;
+    u8 intLatencyShift = 0;                 // Timer1 prescaler (log2)
+    #endif
+
+    // Add the preload value to a running 16-bit timer
+    // TMRxL is read first to latch TMRxH, TMRxH is written first
+    #define INT_RELOAD(h, l, n)     { t16 _t; _t.l8 = l; _t.h8 = h; \
+                                      _t.w += preload[n]; h = _t.h8; l = _t.l8; }
+
+    // Call the timer function every intCountLimit periods
+    #define INT_TICK(n)             if (++intCount[n] >= intCountLimit[n]) \
+                                    { intCount[n] = 0; intFunction[n](); }
     
 /*	----------------------------------------------------------------------------
     ---------- Attach / Detach Interrupt
@@ -125,10 +196,15 @@ void IntSetEnable(u8 inter, u8 enable)
 
         #if defined(TMR1INT)
         case INT_TMR1:
+            #if defined(TMR1CCP)
+            IPR1bits.CCP1IP = INT_LOW_PRIORITY;
+            PIE1bits.CCP1IE = enable;
+            #else
             #ifndef __16F1459
             IPR1bits.TMR1IP = INT_LOW_PRIORITY;
             #endif
             PIE1bits.TMR1IE = enable;
+            #endif
             break;
         #endif
 
@@ -144,8 +220,13 @@ void IntSetEnable(u8 inter, u8 enable)
         #if defined(TMR3INT)
         #ifndef __16F1459
         case INT_TMR3:
+            #if defined(TMR3CCP)
+            IPR2bits.CCP2IP = INT_LOW_PRIORITY;
+            PIE2bits.CCP2IE = enable;
+            #else
             IPR2bits.TMR3IP = INT_LOW_PRIORITY;
             PIE2bits.TMR3IE = enable;
+            #endif
             break;
         #endif
         #endif
@@ -403,16 +484,24 @@ void IntClearFlag(u8 inter)
         #endif
 
         #if defined(TMR1INT)
+        #if defined(TMR1CCP)
+        case INT_TMR1: PIR1bits.CCP1IF = 0; break;
+        #else
         case INT_TMR1: PIR1bits.TMR1IF = 0; break;
         #endif
+        #endif
 
         #if defined(TMR2INT)
         case INT_TMR2: PIR1bits.TMR2IF = 0; break;
         #endif
 
         #if defined(TMR3INT)
+        #if defined(TMR3CCP)
+        case INT_TMR3: PIR2bits.CCP2IF = 0; break;
+        #else
         case INT_TMR3: PIR2bits.TMR3IF = 0; break;
         #endif
+        #endif
 
         #if defined(__18f26j50) || defined(__18f46j50) || \
             defined(__18f26j53) || defined(__18f46j53) || \
@@ -597,16 +686,24 @@ u8 IntIsFlagSet(u8 inter)
         #endif
         
         #if defined(TMR1INT)
+        #if defined(TMR1CCP)
+        case INT_TMR1:	return PIR1bits.CCP1IF;
+        #else
         case INT_TMR1:	return PIR1bits.TMR1IF;
         #endif
+        #endif
         
         #if defined(TMR2INT)
         case INT_TMR2:	return PIR1bits.TMR2IF;
         #endif
         
         #if defined(TMR3INT)
+        #if defined(TMR3CCP)
+        case INT_TMR3:	return PIR2bits.CCP2IF;
+        #else
         case INT_TMR3:	return PIR2bits.TMR3IF;
         #endif
+        #endif
 
         #if defined(__18f26j50) || defined(__18f46j50) || \
             defined(__18f26j53) || defined(__18f46j53) || \
@@ -763,110 +860,175 @@ u8 IntIsFlagSet(u8 inter)
     ---------- IntSetPriority
     --------------------------------------------------------------------
     @author		Regis Blanchot <rblanchot@gmail.com>
-    @descr		set interrupt priority
+    @descr		set interrupt priority, to be called after OnXxx()
+                high priority interrupts are dispatched by
+                userhighinterrupt(), the others by userlowinterrupt()
     @param	    inter : interrupt num.
-                pri : INT_LOW_PRIORITY or INT_LOW_PRIORITY
+                pri : INT_HIGH_PRIORITY or INT_LOW_PRIORITY
     ------------------------------------------------------------------*/
 
 #ifdef INTSETPRIORITY
 void IntSetPriority(u8 inter, u8 pri)
 {
-    #ifdef INT1INT
-    INTCON3bits.INT1IP = pri;
-    #endif
-    
-    #ifdef INT2INT
-    INTCON3bits.INT2IP = pri;
-    #endif
-    
-    #ifdef RBINT
-    INTCONbits.RBIP = pri;
-    #endif
-    
-    #if defined (TMR0INT) || defined(CNTR0INT)
-    INTCON2bits.TMR0IP = pri;
-    #endif
-    
-    #if defined (TMR1INT) || defined(CNTR1INT)
-    PIR1bits.TMR1IP = pri;
-    #endif
-    
-    #ifdef TMR2INT
-    PIR1bits.TMR2IP = pri;
-    #endif
-    
-    #if defined (TMR3INT) || defined(CNTR3INT)
-    PIR2bits.TMR3IP = pri;
-    #endif
-    
-    #ifdef TMR4INT
-    PIR3bits.TMR4IP = pri;
-    #endif
-    
-    #ifdef TMR5INT
-    PIR5bits.TMR5IP = pri;
-    #endif
-    
-    #ifdef TMR6INT
-    PIR5bits.TMR6IP = pri;
-    #endif
-    
-    #ifdef TMR8INT
-    PIR5bits.TMR8IP = pri;
-    #endif
-    
-    #ifdef ADINT
-    PIR1bits.ADIP = pri;
-    #endif
-    
-    #ifdef RCINT
-    PIR1bits.RCIP = pri;
-    #endif
-    
-    #ifdef TXINT
-    PIR1bits.TXIP = pri;
-    #endif
-    
-    #ifdef CCP1INT
-    PIR1bits.CCP1IP = pri;
-    #endif
-    
-    #ifdef CCP2INT
-    PIR2bits.CCP2IP = pri;
-    #endif
-    
-    #ifdef EEINT
-    PIR2bits.EEIP = pri;
-    #endif
-    
-    #ifdef USBINT
-    PIR2bits.USBIP = pri;
-    #endif
-    
-    #ifdef OSCFINT
-    PIR2bits.OSCFIP = pri;
-    #endif
-    
-    #ifdef CMINT
-    PIR2bits.CMIP = pri;
-    #endif
-    
-    #ifdef BCLINT
-    PIR2bits.BCLIP = pri;
-    #endif
-    
-    #ifdef HLVDINT
-    PIR2bits.HLVDIP = pri;
-    #endif
-    
-    #ifdef SSPINT
-    PIR1bits.SSPIP = pri;
-    #endif
+    #ifndef __16F1459
+    switch(inter)
+    {
+        #if defined(INT1INT)
+        case INT_INT1:
+            INTCON3bits.INT1IP = pri;
+            break;
+        #endif
 
-    #if defined(__18f46j53) || defined(__18f47j53)
-    #if defined(PMPINT)
-    PIR1bits.PMPIP = pri;
-    #endif
+        #if defined(INT2INT)
+        case INT_INT2:
+            INTCON3bits.INT2IP = pri;
+            break;
+        #endif
+
+        #if defined(RBINT)
+        case INT_RB:
+            INTCON2bits.RBIP = pri;
+            break;
+        #endif
+
+        #if defined(TMR0INT) || defined(CNTR0INT)
+        case INT_TMR0:
+            INTCON2bits.TMR0IP = pri;
+            break;
+        #endif
+
+        #if defined(TMR1INT) || defined(CNTR1INT)
+        case INT_TMR1:
+            IPR1bits.TMR1IP = pri;
+            #ifdef TMR1CCP
+            IPR1bits.CCP1IP = pri;
+            #endif
+            break;
+        #endif
+
+        #if defined(TMR2INT)
+        case INT_TMR2:
+            IPR1bits.TMR2IP = pri;
+            break;
+        #endif
+
+        #if defined(TMR3INT) || defined(CNTR3INT)
+        case INT_TMR3:
+            IPR2bits.TMR3IP = pri;
+            #ifdef TMR3CCP
+            IPR2bits.CCP2IP = pri;
+            #endif
+            break;
+        #endif
+
+        #if defined(TMR4INT)
+        case INT_TMR4:
+            IPR3bits.TMR4IP = pri;
+            break;
+        #endif
+
+        #if defined(TMR5INT)
+        case INT_TMR5:
+            IPR5bits.TMR5IP = pri;
+            break;
+        #endif
+
+        #if defined(TMR6INT)
+        case INT_TMR6:
+            IPR5bits.TMR6IP = pri;
+            break;
+        #endif
+
+        #if defined(TMR8INT)
+        case INT_TMR8:
+            IPR5bits.TMR8IP = pri;
+            break;
+        #endif
+
+        #if defined(ADINT)
+        case INT_AD:
+            IPR1bits.ADIP = pri;
+            break;
+        #endif
+
+        #if defined(RCINT)
+        case INT_RC:
+            IPR1bits.RCIP = pri;
+            break;
+        #endif
+
+        #if defined(TXINT)
+        case INT_TX:
+            IPR1bits.TXIP = pri;
+            break;
+        #endif
+
+        #if defined(CCP1INT)
+        case INT_CCP1:
+            IPR1bits.CCP1IP = pri;
+            break;
+        #endif
+
+        #if defined(CCP2INT)
+        case INT_CCP2:
+            IPR2bits.CCP2IP = pri;
+            break;
+        #endif
+
+        #if defined(EEINT)
+        case INT_EE:
+            IPR2bits.EEIP = pri;
+            break;
+        #endif
+
+        #if defined(USBINT)
+        case INT_USB:
+            #if defined(__18f25k50) || defined(__18f45k50)
+            IPR3bits.USBIP = pri;
+            #else
+            IPR2bits.USBIP = pri;
+            #endif
+            break;
+        #endif
+
+        #if defined(OSCFINT)
+        case INT_OSCF:
+            IPR2bits.OSCFIP = pri;
+            break;
+        #endif
+
+        #if defined(CMINT)
+        case INT_CM:
+            IPR2bits.CMIP = pri;
+            break;
+        #endif
+
+        #if defined(BCLINT)
+        case INT_BCL:
+            IPR2bits.BCLIP = pri;
+            break;
+        #endif
+
+        #if defined(HLVDINT)
+        case INT_HLVD:
+            IPR2bits.HLVDIP = pri;
+            break;
+        #endif
+
+        #if defined(SSPINT)
+        case INT_SSP:
+            IPR1bits.SSPIP = pri;
+            break;
+        #endif
+
+        #if defined(__18f46j53) || defined(__18f47j53)
+        #if defined(PMPINT)
+        case INT_PMP:
+            IPR1bits.PMPIP = pri;
+            break;
+        #endif
+        #endif
+    }
     #endif
 }
 #endif /* INTSETPRIORITY */
@@ -1017,7 +1179,7 @@ void IntTimerStop()
     --------------------------------------------------------------------------*/
 
 #ifdef TMR0INT
-u8 OnTimer0(callback func, u8 timediv, u16 delay)
+u8 OnTimer0(callback func, u32 timediv, u16 delay)
 {
     u8 _t0con = 0;
     u16 _cycles_;
@@ -1037,11 +1199,10 @@ u8 OnTimer0(callback func, u8 timediv, u16 delay)
                 _cycles_ = System_getPeripheralFrequency() / 1000 / 1000;
                 #ifdef __16F1459
                 _t0con = T0_SOURCE_INT | T0_PS_OFF;
-                preloadL[INT_TMR0] =  0xFF - (u8)_cycles_; // 12
+                preload[INT_TMR0] = 0x100 - _cycles_; // 12
                 #else
                 _t0con = T0_OFF | T0_16BIT | T0_SOURCE_INT | T0_PS_OFF;
-                preloadH[INT_TMR0] = 0xFF;
-                preloadL[INT_TMR0] = 0xFF - (u8)_cycles_;
+                preload[INT_TMR0] = 0 - _cycles_;
                 #endif
                 break;
             case INT_MILLISEC:
@@ -1050,11 +1211,10 @@ u8 OnTimer0(callback func, u8 timediv, u16 delay)
                 _cycles_ = System_getPeripheralFrequency() / 1000;
                 #ifdef __16F1459
                 _t0con = T0_SOURCE_INT | T0_PS_ON | T0_PS_1_64;
-                preloadL[INT_TMR0] =  0xFF - (_cycles_/64); // 12000/64=187
+                preload[INT_TMR0] = 0x100 - (_cycles_/64); // 12000/64=187
                 #else
                 _t0con = T0_OFF | T0_16BIT | T0_SOURCE_INT | T0_PS_OFF;
-                preloadH[INT_TMR0] = high8(0xFFFF - _cycles_);
-                preloadL[INT_TMR0] =  low8(0xFFFF - _cycles_);
+                preload[INT_TMR0] = 0 - _cycles_;
                 #endif
                 break;
             case INT_SEC:
@@ -1064,23 +1224,22 @@ u8 OnTimer0(callback func, u8 timediv, u16 delay)
                 #ifdef __16F1459
                 _t0con = T0_SOURCE_INT | T0_PS_ON | T0_PS_1_256;
                 intCountLimit[INT_TMR0] = 256 * delay;
-                preloadL[INT_TMR0] =  0xFF - (_cycles_/256); // 46875/256 = 183
+                preload[INT_TMR0] = 0x100 - (_cycles_/256); // 46875/256 = 183
                 #else
                 _t0con = T0_OFF | T0_16BIT | T0_SOURCE_INT | T0_PS_ON | T0_PS_1_256;
-                preloadH[INT_TMR0] = high8(0xFFFF - _cycles_);
-                preloadL[INT_TMR0] =  low8(0xFFFF - _cycles_);
+                preload[INT_TMR0] = 0 - _cycles_;
                 #endif
                 break;
         }
 
         #ifdef __16F1459
             OPTION_REG = _t0con;
-            TMR0 = preloadL[INT_TMR0];
+            TMR0 = low8(preload[INT_TMR0]);
         #else
             T0CON = _t0con;
             INTCON2bits.TMR0IP = INT_LOW_PRIORITY;
-            TMR0H = preloadH[INT_TMR0];
-            TMR0L = preloadL[INT_TMR0];
+            TMR0H = high8(preload[INT_TMR0]);
+            TMR0L = low8(preload[INT_TMR0]);
         #endif
 
         INTCONbits.TMR0IF = 0;
@@ -1139,9 +1298,7 @@ u8 OnTimer1(callback func, u32 timediv, u16 delay)
             _cycles_ = fosc / timediv;
         }
         
-        _cycles_ = 0xFFFF - _cycles_;
-        preloadH[INT_TMR1] = high8(_cycles_);
-        preloadL[INT_TMR1] = low8(_cycles_);
+        preload[INT_TMR1] = 0 - _cycles_;
 
         #if defined(__16F1459)  || \
             defined(__18f25k50) || defined(__18f45k50) || \
@@ -1153,8 +1310,26 @@ u8 OnTimer1(callback func, u32 timediv, u16 delay)
         
         #endif
 
-        TMR1H = preloadH[INT_TMR1];
-        TMR1L = preloadL[INT_TMR1];
+        #ifdef TMR1CCP
+
+        // CCP1 resets Timer1 on the cycle after the match
+        TMR1H = 0;
+        TMR1L = 0;
+        CCPR1H = high8(_cycles_ - 1);
+        CCPR1L = low8(_cycles_ - 1);
+        CCP1CON = CCP_SPECIAL_EVENT;
+        T1CON = T1_ON | T1_16BIT | T1_SYNC_EXT_ON | _presca_ | T1_SOURCE_FOSCDIV4;
+        #ifdef INTLATENCY
+        intLatencyShift = (_presca_ == T1_PS_1_8) ? 3 : 0;
+        #endif
+        IPR1bits.CCP1IP = INT_LOW_PRIORITY;
+        PIR1bits.CCP1IF = 0;
+        PIE1bits.CCP1IE = INT_ENABLE;
+
+        #else
+
+        TMR1H = high8(preload[INT_TMR1]);
+        TMR1L = low8(preload[INT_TMR1]);
         #ifdef __16F1459
         T1CON = T1_ON | T1_SYNC_EXT_ON | _presca_ | T1_SOURCE_FOSCDIV4;
         #else
@@ -1163,6 +1338,8 @@ u8 OnTimer1(callback func, u32 timediv, u16 delay)
         #endif
         PIR1bits.TMR1IF = 0;
         PIE1bits.TMR1IE = INT_ENABLE;
+
+        #endif
         
         return INT_TMR1;
     }
@@ -1190,9 +1367,8 @@ void OnRTCC(callback func, u16 delay)
             intCountLimit[INT_TMR1] = delay;
             intFunction[INT_TMR1] = func;
 
-            // Preload TMR1 register pair for 1 mn (60 s = 60 x 1000 x 4 x 250 us) overflow
-            preloadH[INT_TMR1] = 0x80;			// (0xFFFF - 0xFF0F) = 240
-            preloadL[INT_TMR1] = 0x00;			// TMR1L is never preloaded or altered
+            // 32768 Hz crystal : 0x8000 added to TMR1 for a 1 s overflow
+            preload[INT_TMR1] = 0x8000;
 
             // RD16    = 1	Enables register read/write of Timer1 in one 16-bit operation
             // T1RUN   = 0	Device clock is derived from another source (le quartz 20MHz)
@@ -1213,8 +1389,8 @@ void OnRTCC(callback func, u16 delay)
             IPR1bits.TMR1IP = INT_LOW_PRIORITY;
             PIE1bits.TMR1IE = INT_ENABLE;
             PIR1bits.TMR1IF = 0;
-            TMR1H = preloadH[INT_TMR1];
-            TMR1L = preloadL[INT_TMR1];
+            TMR1H = high8(preload[INT_TMR1]);
+            TMR1L = low8(preload[INT_TMR1]);
             T1CON = _t1con;
         }
         #ifdef DEBUG
@@ -1246,7 +1422,7 @@ void OnRTCC(callback func, u16 delay)
     --------------------------------------------------------------------------*/
 
 #ifdef TMR2INT
-u8 OnTimer2(callback func, u8 timediv, u16 delay)
+u8 OnTimer2(callback func, u32 timediv, u16 delay)
 {
     u8 _t2con = 0;
     u8 _pr2 = 0;
@@ -1291,7 +1467,7 @@ u8 OnTimer2(callback func, u8 timediv, u16 delay)
         }
 
         T2CON = _t2con;
-        PR2 = _pr2;	// Timer2 Match value
+        PR2 = _pr2 - 1;	// Timer2 Match value
         #ifndef __16F1459
         IPR1bits.TMR2IP = INT_LOW_PRIORITY;
         #endif
@@ -1353,8 +1529,7 @@ u8 OnTimer3(callback func, u32 timediv, u16 delay)
             _cycles_ = osc / timediv;
         }
         
-        preloadH[INT_TMR3] = high8(0xFFFF - _cycles_);
-        preloadL[INT_TMR3] =  low8(0xFFFF - _cycles_);
+        preload[INT_TMR3] = 0 - _cycles_;
 
         #if defined(__18f25k50) || defined(__18f45k50) || \
             defined(__18f26j50) || defined(__18f46j50) || \
@@ -1365,13 +1540,31 @@ u8 OnTimer3(callback func, u32 timediv, u16 delay)
         
         #endif
 
+        #ifdef TMR3CCP
+
+        // CCP2 resets Timer3 on the cycle after the match
+        TMR3H = 0;
+        TMR3L = 0;
+        CCPR2H = high8(_cycles_ - 1);
+        CCPR2L = low8(_cycles_ - 1);
+        CCP2CON = CCP_SPECIAL_EVENT;
+        T3CON = T3_ON | T3_16BIT | T3_SYNC_EXT_ON | _presca_ | T3_SOURCE_FOSCDIV4;
+        T3CONbits.T3CCP1 = 1;               // Timer3 for CCP2, Timer1 for CCP1
+        IPR2bits.CCP2IP = INT_LOW_PRIORITY;
+        PIR2bits.CCP2IF = 0;
+        PIE2bits.CCP2IE = INT_ENABLE;
+
+        #else
+
         T3CON = T3_ON | T3_16BIT | T3_SYNC_EXT_ON | _presca_ | T3_SOURCE_FOSCDIV4;
         IPR2bits.TMR3IP = INT_LOW_PRIORITY;
-        TMR3H = preloadH[INT_TMR3];
-        TMR3L = preloadL[INT_TMR3];
+        TMR3H = high8(preload[INT_TMR3]);
+        TMR3L = low8(preload[INT_TMR3]);
         PIR2bits.TMR3IF = 0;
         PIE2bits.TMR3IE = INT_ENABLE;
 
+        #endif
+
         return INT_TMR3;
     }
     else
@@ -1405,7 +1598,7 @@ u8 OnTimer3(callback func, u32 timediv, u16 delay)
     defined(__18f26j53) || defined(__18f46j53) || \
     defined(__18f27j53) || defined(__18f47j53)
 
-u8 OnTimer4(callback func, u8 timediv, u16 delay)
+u8 OnTimer4(callback func, u32 timediv, u16 delay)
 {
     u8 _t4con = 0;
     u8 _pr4 = 0;
@@ -1442,7 +1635,7 @@ u8 OnTimer4(callback func, u8 timediv, u16 delay)
 
         T4CON = _t4con;
         IPR3bits.TMR4IP = INT_LOW_PRIORITY;
-        PR4 = _pr4;	// Timer2 Match value
+        PR4 = _pr4 - 1;	// Timer2 Match value
         PIR3bits.TMR4IF = 0;
         PIE3bits.TMR4IE = INT_ENABLE;
         return INT_TMR4;
@@ -1502,19 +1695,18 @@ u8 OnTimer5(callback func, u32 timediv, u16 delay)
         else // INT_MICROSEC or INT_MILLISEC
         {
             _presca_ = T1_PS_1_1;
-            intCountLimit[INT_TMR3] = delay;
+            intCountLimit[INT_TMR5] = delay;
             _cycles_ = osc / timediv;
         }
         
-        preloadH[INT_TMR5] = high8(0xFFFF - _cycles_);
-        preloadL[INT_TMR5] =  low8(0xFFFF - _cycles_);
+        preload[INT_TMR5] = 0 - _cycles_;
 
         T5GCONbits.TMR5GE = 0;				/* First Ignore T1DIG effection */ 
 
-        T5CON = T5_ON | T5_16BIT | T5_SYNC_EXT_ON | T5_SOURCE_T10 | _presca_ | T5_SOURCE_FOSCDIV4;
+        T5CON = T5_ON | T5_16BIT | T5_SYNC_EXT_ON | T5_SOURCE_T1OFF | _presca_ | T5_SOURCE_FOSCDIV4;
         IPR5bits.TMR5IP = INT_LOW_PRIORITY;
-        TMR5H = preloadH[INT_TMR5];
-        TMR5L = preloadL[INT_TMR5];
+        TMR5H = high8(preload[INT_TMR5]);
+        TMR5L = low8(preload[INT_TMR5]);
         PIR5bits.TMR5IF = 0;
         PIE5bits.TMR5IE = INT_ENABLE;
         return INT_TMR5;
@@ -1547,7 +1739,7 @@ u8 OnTimer5(callback func, u32 timediv, u16 delay)
 #if defined(__18f26j53) || defined(__18f46j53) || \
     defined(__18f27j53) || defined(__18f47j53)
 
-u8 OnTimer6(callback func, u8 timediv, u16 delay)
+u8 OnTimer6(callback func, u32 timediv, u16 delay)
 {
     u8 _t6con = 0;
     u8 _pr6 = 0;
@@ -1584,7 +1776,7 @@ u8 OnTimer6(callback func, u8 timediv, u16 delay)
 
         T6CON = _t6con;
         IPR5bits.TMR6IP = INT_LOW_PRIORITY;
-        PR6 = _pr6;	// Timer6 Match value
+        PR6 = _pr6 - 1;	// Timer6 Match value
         PIR5bits.TMR6IF = 0;
         PIE5bits.TMR6IE = INT_ENABLE;
         return INT_TMR6;
@@ -1617,7 +1809,7 @@ u8 OnTimer6(callback func, u8 timediv, u16 delay)
 #if defined(__18f26j53) || defined(__18f46j53) || \
     defined(__18f27j53) || defined(__18f47j53)
 
-u8 OnTimer8(callback func, u8 timediv, u16 delay)
+u8 OnTimer8(callback func, u32 timediv, u16 delay)
 {
     u8 _t8con = 0;
     u8 _pr8 = 0;
@@ -1654,7 +1846,7 @@ u8 OnTimer8(callback func, u8 timediv, u16 delay)
 
         T8CON = _t8con;
         IPR5bits.TMR8IP = INT_LOW_PRIORITY;
-        PR8 = _pr8;	// Timer8 Match value
+        PR8 = _pr8 - 1;	// Timer8 Match value
         PIR5bits.TMR8IF = 0;
         PIE5bits.TMR8IE = INT_ENABLE;
         return INT_TMR8;
@@ -1697,8 +1889,7 @@ void OnCounter0(callback func, u8 config)
         intCountLimit[INT_TMR0] = 0;
         INTCON2bits.TMR0IP = INT_LOW_PRIORITY;
         INTCONbits.TMR0IE = INT_ENABLE;
-        preloadH[INT_TMR0] = 0;
-        preloadL[INT_TMR0] = 0;
+        preload[INT_TMR0] = 0;
         TMR0H = 0;
         TMR0L = 0;
         T0CON = T0_ON | T0_16BIT | T0_SOURCE_EXT | T0_L2H | T0_PS_ON | T0_PS_1_2;
@@ -1725,8 +1916,7 @@ void OnCounter1(callback func, u8 config)
         intCountLimit[INT_TMR1] = 0;
         IPR1bits.TMR1IP = INT_LOW_PRIORITY;
         PIE1bits.TMR1IE = INT_ENABLE;
-        preloadH[INT_TMR1] = 0;
-        preloadL[INT_TMR1] = 0;
+        preload[INT_TMR1] = 0;
         TMR1H = 0;
         TMR1L = 0;
         T1CON = T1_ON | T1_16BIT | T1_PS_1_8 | T1_RUN_FROM_ANOTHER | T1_OSC_ON | T1_SYNC_EXT_ON | T1_SOURCE_EXT;
@@ -1753,8 +1943,7 @@ void OnCounter3(callback func, u8 config)
         intCountLimit[INT_TMR3] = 0;
         IPR2bits.TMR3IP = INT_LOW_PRIORITY;
         PIE2bits.TMR3IE = INT_ENABLE;
-        preloadH[INT_TMR3] = 0;
-        preloadL[INT_TMR3] = 0;
+        preload[INT_TMR3] = 0;
         TMR3H = 0;
         TMR3L = 0;
         T3CON = T3_ON | T3_16BIT | T3_PS_1_8 | T3_SOURCE_EXT; // default
@@ -1913,6 +2102,7 @@ void OnChangePin3(callback func, u8 config)
 #define INTRBALL    0xF0
 
 volatile u8 INTRB;
+u8 intLastPortB;
 
 void OnChangePin4to7(callback func, u8 pin)
 {
@@ -1923,6 +2113,7 @@ void OnChangePin4to7(callback func, u8 pin)
         pin &= 0xF0;    // to prevent lower pins to change
         TRISB &= 0x0F;  // clears bit 7 to 4
         TRISB |= pin;   // pin as an INPUT
+        intLastPortB = PORTB & 0xF0;
         INTCON2bits.RBIP = INT_LOW_PRIORITY;
         INTCONbits.RBIE  = INT_ENABLE;
         INTCONbits.RBIF  = 0;
@@ -2172,16 +2363,86 @@ void OnI2CReceive(callback func)	{	OnEvent(INT_SSP, func);	}
 void OnParallel(callback func)	    {	OnEvent(INT_PMP, func);	}
 #endif
 #endif
+/*	----------------------------------------------------------------------------
+    ---------- IntLatency
+    ----------------------------------------------------------------------------
+    @descr		worst case interrupt latency since the last IntLatencyReset()
+                measured on each Timer1 period : when the ISR starts to
+                serve the interrupts (entry) and when it has served them
+                all (exit), the context save and restore done by the
+                compiler are not included
+    @return		number of cycles (Fosc/4), 0xFFFF if the ISR has
+                lasted more than one Timer1 period
+    --------------------------------------------------------------------------*/
+
+#ifdef INTLATENCY
+static u32 IntLatencyRead(volatile u16 *ticks)
+{
+    u16 t;
+
+    noInterrupts();
+    t = *ticks;
+    interrupts();
+
+    if (t == 0xFFFF)
+        return 0xFFFF;
+    return (u32)t << intLatencyShift;
+}
+
+u32 IntLatencyEntry()
+{
+    return IntLatencyRead(&intLatencyEntry);
+}
+
+u32 IntLatencyExit()
+{
+    return IntLatencyRead(&intLatencyExit);
+}
+
+void IntLatencyReset()
+{
+    noInterrupts();
+    intLatencyEntry = 0;
+    intLatencyExit = 0;
+    interrupts();
+}
+
+/*  The CCP1 flag is still set when the ISR starts : Timer1 has
+    counted the ticks since the CCP1 event reset it. */
+
+#define INT_LATENCY_ENTRY()     t16 _entry; \
+                                u8 _sampled = INT_PENDING(PIE1bits.CCP1IE, PIR1bits.CCP1IF, IPR1bits.CCP1IP); \
+                                if (_sampled) { _entry.l8 = TMR1L; _entry.h8 = TMR1H; }
+
+#define INT_LATENCY_EXIT()      if (_sampled) \
+                                { \
+                                    t16 _exit; \
+                                    _exit.l8 = TMR1L; _exit.h8 = TMR1H; \
+                                    if (PIR1bits.CCP1IF) _exit.w = 0xFFFF; \
+                                    if (_entry.w > intLatencyEntry) intLatencyEntry = _entry.w; \
+                                    if (_exit.w > intLatencyExit) intLatencyExit = _exit.w; \
+                                }
+#else
+#define INT_LATENCY_ENTRY()
+#define INT_LATENCY_EXIT()
+#endif
+
 /*	----------------------------------------------------------------------------
     ---------- userhighinterrupt
     ----------------------------------------------------------------------------
     @author		Regis Blanchot <rblanchot@gmail.com>
     @descr		function called by high_priority_isr
+                INT0 then the sources set to INT_HIGH_PRIORITY
     @param		none
     --------------------------------------------------------------------------*/
 
 void userhighinterrupt()
 {
+    #if !defined(__16F1459) && !defined(_16F1459)
+    #define INT_PENDING(enable, flag, priority) ((enable) && (flag) && (priority))
+    INT_LATENCY_ENTRY();
+    #endif
+
     #ifdef INT0INT
         #ifdef _16F1459
         if (INTCONbits.IOCIE && INTCONbits.IOCIF)
@@ -2197,6 +2458,23 @@ void userhighinterrupt()
         }
         #endif
     #endif
+
+    #if !defined(__16F1459) && !defined(_16F1459)
+
+    #define INT_PASS 0
+    #include <intdispatch.h>
+    #undef  INT_PASS
+    #define INT_PASS 1
+    #include <intdispatch.h>
+    #undef  INT_PASS
+    #define INT_PASS 2
+    #include <intdispatch.h>
+    #undef  INT_PASS
+
+    INT_LATENCY_EXIT();
+    #undef INT_PENDING
+
+    #endif
 }
 
 /*	----------------------------------------------------------------------------
@@ -2204,263 +2482,33 @@ void userhighinterrupt()
     ----------------------------------------------------------------------------
     @author		Regis Blanchot <rblanchot@gmail.com>
     @descr		function called by low_priority_isr
+                the sources set to INT_LOW_PRIORITY (default), or
+                all of them on the PIC16F
     @param		none
     --------------------------------------------------------------------------*/
 
 void userlowinterrupt()
 {
-    #ifdef INT1INT
-    if (INTCON3bits.INT1IE && INTCON3bits.INT1IF)
-    {
-        INTCON3bits.INT1IF = 0;
-        intFunction[INT_INT1]();
-    }
-    #endif
-    
-    #ifdef INT2INT
-    if (INTCON3bits.INT2IE && INTCON3bits.INT2IF)
-    {
-        INTCON3bits.INT2IF = 0;
-        intFunction[INT_INT2]();
-    }
-    #endif
-    
-    #ifdef RBINT
-    u8 LastPortB;
-    
-    if (INTCONbits.RBIE && INTCONbits.RBIF)
-    {
-        INTRB = (PORTB & 0xF0) ^ LastPortB;
-        LastPortB = (PORTB & 0xF0);
-        intFunction[INT_RB]();
-        INTCONbits.RBIF = 0;
-    }
-    #endif
-    
-    #if defined (TMR0INT) || defined(CNTR0INT)
-    if (INTCONbits.TMR0IE && INTCONbits.TMR0IF)
-    {
-        //T0CONbits.TMR0ON = 0;
-        #ifdef _16F1459
-        TMR0 = preloadL[INT_TMR0];
-        #else
-        TMR0H = preloadH[INT_TMR0];
-        TMR0L = preloadL[INT_TMR0];
-        #endif
-        INTCONbits.TMR0IF = 0;
-        if (intCount[INT_TMR0]++ >= intCountLimit[INT_TMR0])
-        {
-            intCount[INT_TMR0] = 0;
-            intFunction[INT_TMR0]();
-        }
-    }
-    #endif
-    
-    #if defined (TMR1INT) || defined(CNTR1INT)
-    if (PIE1bits.TMR1IE && PIR1bits.TMR1IF)
-    {
-        //T1CONbits.TMR1ON = 0;
-        TMR1H = preloadH[INT_TMR1];
-        TMR1L = preloadL[INT_TMR1];
-        PIR1bits.TMR1IF = 0;
-        if (intCount[INT_TMR1]++ >= intCountLimit[INT_TMR1])
-        {
-            intCount[INT_TMR1] = 0;
-            intFunction[INT_TMR1]();
-        }
-    }
-    #endif
-    
-    #ifdef TMR2INT
-    if (PIE1bits.TMR2IE && PIR1bits.TMR2IF)
-    {
-        //T2CONbits.TMR2ON = 0;
-        PIR1bits.TMR2IF = 0;
-        if (intCount[INT_TMR2]++ >= intCountLimit[INT_TMR2])
-        {
-            intCount[INT_TMR2] = 0;
-            intFunction[INT_TMR2]();
-        }
-        // NB : no need to reload PR2
-    }
-    #endif
-    
-    #if defined (TMR3INT) || defined(CNTR3INT)
-    if (PIE2bits.TMR3IE && PIR2bits.TMR3IF)
-    {
-        //T3CONbits.TMR3ON = 0;
-        TMR3H = preloadH[INT_TMR3];
-        TMR3L = preloadL[INT_TMR3];
-        PIR2bits.TMR3IF = 0;
-        if (intCount[INT_TMR3]++ >= intCountLimit[INT_TMR3])
-        {
-            intCount[INT_TMR3] = 0;
-            intFunction[INT_TMR3]();
-        }
-    }
-    #endif
-    
-    #ifdef TMR4INT
-    if (PIE3bits.TMR4IE && PIR3bits.TMR4IF)
-    {
-        //T4CONbits.TMR4ON = 0;
-        PIR3bits.TMR4IF = 0;
-        if (intCount[INT_TMR4]++ >= intCountLimit[INT_TMR4])
-        {
-            intCount[INT_TMR4] = 0;
-            intFunction[INT_TMR4]();
-        }
-        // NB : no need to reload PR4
-    }
-    #endif
-    
-    #ifdef TMR5INT
-    if (PIE5bits.TMR5IE && PIR5bits.TMR5IF)
-    {
-        //T5CONbits.TMR5ON = 0;
-        PIR5bits.TMR5IF = 0;
-        if (intCount[INT_TMR5]++ >= intCountLimit[INT_TMR5])
-        {
-            intCount[INT_TMR5] = 0;
-            intFunction[INT_TMR5]();
-        }
-    }
-    #endif
-    
-    #ifdef TMR6INT
-    if (PIE5bits.TMR6IE && PIR5bits.TMR6IF)
-    {
-        //T6CONbits.TMR6ON = 0;
-        PIR5bits.TMR6IF = 0;
-        if (intCount[INT_TMR6]++ >= intCountLimit[INT_TMR6])
-        {
-            intCount[INT_TMR6] = 0;
-            intFunction[INT_TMR6]();
-        }
-    }
-    #endif
-    
-    #ifdef TMR8INT
-    if (PIE5bits.TMR8IE && PIR5bits.TMR8IF)
-    {
-        //T8CONbits.TMR8ON = 0;
-        PIR5bits.TMR8IF = 0;
-        if (intCount[INT_TMR8]++ >= intCountLimit[INT_TMR8])
-        {
-            intCount[INT_TMR8] = 0;
-            intFunction[INT_TMR8]();
-        }
-    }
-    #endif
-    
-    #ifdef ADINT
-    if (PIE1bits.ADIE && PIR1bits.ADIF)
-    {
-        PIR1bits.ADIF = 0;
-        intFunction[INT_AD]();
-    }
-    #endif
-    
-    #ifdef RCINT
-    if (PIE1bits.RCIE && PIR1bits.RCIF)
-    {
-        PIR1bits.RCIF = 0;
-        intFunction[INT_RC]();
-    }
-    #endif
-    
-    #ifdef TXINT
-    if (PIE1bits.TXIE && PIR1bits.TXIF)
-    {
-        PIR1bits.TXIF = 0;
-        intFunction[INT_TX]();
-    }
-    #endif
-    
-    #ifdef CCP1INT
-    if (PIE1bits.CCP1IE && PIR1bits.CCP1IF)
-    {
-        PIR1bits.CCP1IF = 0;
-        intFunction[INT_CCP1]();
-    }
-    #endif
-    
-    #ifdef CCP2INT
-    if (PIE2bits.CCP2IE && PIR2bits.CCP2IF)
-    {
-        PIR2bits.CCP2IF = 0;
-        intFunction[INT_CCP2]();
-    }
-    #endif
-    
-    #ifdef EEINT
-    
-    if (PIE2bits.EEIE && PIR2bits.EEIF)
-    {
-        PIR2bits.EEIF = 0;
-        intFunction[INT_EE]();
-    }
-    #endif
-    
-    #ifdef USBINT
-    if (PIE2bits.USBIE && PIR2bits.USBIF)
-    {
-        PIR2bits.USBIF = 0;
-        intFunction[INT_USB]();
-    }
-    #endif
-    
-    #ifdef OSCFINT
-    if (PIE2bits.OSCFIE && PIR2bits.OSCFIF)
-    {
-        PIR2bits.OSCFIF = 0;
-        intFunction[INT_OSCF]();
-    }
-    #endif
-    
-    #ifdef CMINT
-    if (PIE2bits.CMIE && PIR2bits.CMIF)
-    {
-        PIR2bits.CMIF = 0;
-        intFunction[INT_CM]();
-    }
-    #endif
-    
-    #ifdef BCLINT
-    if (PIE2bits.BCLIE && PIR2bits.BCLIF)
-    {
-        PIR2bits.BCLIF = 0;
-        intFunction[INT_BCL]();
-    }
-    #endif
-    
-    #ifdef HLVDINT
-    if (PIE2bits.HLVDIE && PIR2bits.HLVDIF)
-    {
-        PIR2bits.HLVDIF = 0;
-        intFunction[INT_HLVD]();
-    }
-    #endif
-    
-    #ifdef SSPINT
-    if (PIE1bits.SSPIE && PIR1bits.SSPIF)
-    {
-        PIR1bits.SSPIF = 0;
-        intFunction[INT_SSP]();
-    }
+    #if defined(__16F1459) || defined(_16F1459)
+    #define INT_PENDING(enable, flag, priority) ((enable) && (flag))
+    #else
+    #define INT_PENDING(enable, flag, priority) ((enable) && (flag) && !(priority))
     #endif
 
-    #if defined(__18f46j53) || defined(__18f47j53)
-    #if defined(PMPINT)
-    if (PIE1bits.PMPIE && PIR1bits.PMPIF)
-    {
-        PIR1bits.PMPIF = 0;
-        intFunction[INT_PMP]();
-    }
-    #endif
-    #endif
+    INT_LATENCY_ENTRY();
+
+    #define INT_PASS 0
+    #include <intdispatch.h>
+    #undef  INT_PASS
+    #define INT_PASS 1
+    #include <intdispatch.h>
+    #undef  INT_PASS
+    #define INT_PASS 2
+    #include <intdispatch.h>
+    #undef  INT_PASS
 
-    //int_start();
+    INT_LATENCY_EXIT();
+    #undef INT_PENDING
 }
 
 #endif /* __INTERRUPT_C */
@@ -0,0 +1,224 @@
+/*  --------------------------------------------------------------------
+    FILE:           intx.c
+    PROJECT:        pinguino
+    PURPOSE:        external interrupts shared by the libraries
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    The libraries which time the edges of a line (DHT sensors, DCF77,
+    433MHz receiver) attach a callback to an external interrupt with
+    IntxAttach() instead of testing the flags themselves :
+    * PIC18F  : INT0 to INT2 (pins 0 to 2 on most boards)
+    * PIC16F  : INT only (line 0)
+    A line is given to one callback at a time, IntxAttach() returns
+    false if it is already attached, or if the sketch has it with
+    OnChangePinX() (INTnINT is defined).
+
+    The edge is inverted at each interrupt, the callback is called
+    with the line number and the level after the edge (1 = rising).
+    intx_interrupt() is called by the high priority interrupt routine
+    in main.c, all the lines are high priority. The pin direction is
+    left to the library.
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    ------------------------------------------------------------------*/
+
+#ifndef __INTX_C
+#define __INTX_C
+
+#define __INTX__            // used in main.c to call intx_interrupt()
+
+#include <compiler.h>
+#include <typedef.h>
+#include <const.h>
+#include <interrupt.h>
+
+#if defined(__16F1459) || defined(__16F1708)
+#define INTX_LINES      1
+#else
+#define INTX_LINES      3
+#endif
+
+typedef void (*intx_callback) (u8, u8); // line, level after the edge
+
+intx_callback gIntx[INTX_LINES];
+
+// lines kept by OnChangePinX()
+#if defined(INT0INT)
+    #define INTX_OWNED0     1
+#else
+    #define INTX_OWNED0     0
+#endif
+#if defined(INT1INT)
+    #define INTX_OWNED1     (1 << 1)
+#else
+    #define INTX_OWNED1     0
+#endif
+#if defined(INT2INT)
+    #define INTX_OWNED2     (1 << 2)
+#else
+    #define INTX_OWNED2     0
+#endif
+
+#define INTX_OWNED      (INTX_OWNED0 | INTX_OWNED1 | INTX_OWNED2)
+
+/*  --------------------------------------------------------------------
+    IntxAttach
+    --------------------------------------------------------------------
+    @param:     line    0 to INTX_LINES - 1
+                func    called at each edge
+                edge    first edge, INT_RISING_EDGE or INT_FALLING_EDGE
+    @return:    false if the line is not free
+    ------------------------------------------------------------------*/
+
+u8 IntxAttach(u8 line, intx_callback func, u8 edge)
+{
+    if (line >= INTX_LINES || (INTX_OWNED & (1 << line)) || gIntx[line] != NULL)
+        return false;
+
+    gIntx[line] = func;
+
+    #if defined(__16F1459) || defined(__16F1708)
+
+    OPTION_REGbits.INTEDG = edge;
+    INTCONbits.INTF = 0;
+    INTCONbits.INTE = 1;
+    INTCONbits.PEIE = 1;
+    INTCONbits.GIE = 1;
+
+    #else
+
+    RCONbits.IPEN = 1;                      // Enable HP/LP interrupts
+
+    switch (line)
+    {
+        case 0:
+            INTCON2bits.INTEDG0 = edge;
+            INTCONbits.INT0IF = 0;
+            INTCONbits.INT0IE = INT_ENABLE; // INT0 is always high priority
+            break;
+
+        case 1:
+            INTCON2bits.INTEDG1 = edge;
+            INTCON3bits.INT1IP = INT_HIGH_PRIORITY;
+            INTCON3bits.INT1IF = 0;
+            INTCON3bits.INT1IE = INT_ENABLE;
+            break;
+
+        case 2:
+            INTCON2bits.INTEDG2 = edge;
+            INTCON3bits.INT2IP = INT_HIGH_PRIORITY;
+            INTCON3bits.INT2IF = 0;
+            INTCON3bits.INT2IE = INT_ENABLE;
+            break;
+    }
+
+    INTCONbits.GIEH = 1;                    // Enable HP interrupts
+    INTCONbits.GIEL = 1;                    // Enable LP interrupts
+
+    #endif
+
+    return true;
+}
+
+/*  --------------------------------------------------------------------
+    IntxDetach
+    --------------------------------------------------------------------
+    @param:     line    given back to the other libraries
+    ------------------------------------------------------------------*/
+
+void IntxDetach(u8 line)
+{
+    if (line >= INTX_LINES || (INTX_OWNED & (1 << line)))
+        return;
+
+    #if defined(__16F1459) || defined(__16F1708)
+
+    INTCONbits.INTE = 0;
+    INTCONbits.INTF = 0;
+
+    #else
+
+    switch (line)
+    {
+        case 0: INTCONbits.INT0IE = 0;  INTCONbits.INT0IF = 0;  break;
+        case 1: INTCON3bits.INT1IE = 0; INTCON3bits.INT1IF = 0; break;
+        case 2: INTCON3bits.INT2IE = 0; INTCON3bits.INT2IF = 0; break;
+    }
+
+    #endif
+
+    gIntx[line] = NULL;
+}
+
+/*  --------------------------------------------------------------------
+    intx_interrupt
+    --------------------------------------------------------------------
+    called by the high priority interrupt routine in main.c, a line
+    without callback is left to the code which enabled it
+    ------------------------------------------------------------------*/
+
+void intx_interrupt(void)
+{
+    u8 level;
+
+    #if defined(__16F1459) || defined(__16F1708)
+
+    if (gIntx[0] != NULL && INTCONbits.INTE && INTCONbits.INTF)
+    {
+        INTCONbits.INTF = 0;
+        level = OPTION_REGbits.INTEDG;
+        OPTION_REGbits.INTEDG = !level;
+        gIntx[0](0, level);
+    }
+
+    #else
+
+    #if !defined(INT0INT)
+    if (gIntx[0] != NULL && INTCONbits.INT0IE && INTCONbits.INT0IF)
+    {
+        INTCONbits.INT0IF = 0;
+        level = INTCON2bits.INTEDG0;
+        INTCON2bits.INTEDG0 = !level;
+        gIntx[0](0, level);
+    }
+    #endif
+
+    #if !defined(INT1INT)
+    if (gIntx[1] != NULL && INTCON3bits.INT1IE && INTCON3bits.INT1IF)
+    {
+        INTCON3bits.INT1IF = 0;
+        level = INTCON2bits.INTEDG1;
+        INTCON2bits.INTEDG1 = !level;
+        gIntx[1](1, level);
+    }
+    #endif
+
+    #if !defined(INT2INT)
+    if (gIntx[2] != NULL && INTCON3bits.INT2IE && INTCON3bits.INT2IF)
+    {
+        INTCON3bits.INT2IF = 0;
+        level = INTCON2bits.INTEDG2;
+        INTCON2bits.INTEDG2 = !level;
+        gIntx[2](2, level);
+    }
+    #endif
+
+    #endif
+}
+
+#endif // __INTX_C
@@ -18,6 +18,8 @@
     10 Feb. 2016 - Régis Blanchot - changed from Timer0 to Timer1 for PIC16F
                                     Timer1 is the only 16-bit timer available on 16F
     10 Mai. 2016 - Régis Blanchot - replaced System_getPeripheralFrequency() with _cpu_clock_
+    19 Oct. 2026 - built on the free-running timebase, no more reload drift
+                                    added micros() and elapsed()
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -39,100 +41,52 @@
 
 #include <compiler.h>           // compatibility between SDCC and XC8
 #include <typedef.h>            // u8, u32, ...
-#include <macro.h>              // interrupts() and noInterrupts
-//#include <oscillator.c>         // System_getPeripheralFrequency()
+#include <timebase.c>
 
 extern u32 _cpu_clock_;
-volatile u32 _millis;
-volatile t16 _millis_period;
 
 /*  --------------------------------------------------------------------
     if Fosc = 48 MHz then Fosc/4 = 12MHz
-    which means 12.E-06 cycles/sec = 12.000 cycles/ms
-    if TMR0 is loaded with 65536 - 12000
-    overload will occur after 12.000 cycles = 1ms
+    the timer counts 12.000 cycles/ms and overflows every 5.46 ms
     ------------------------------------------------------------------*/
 
 void millis_init(void)
 {
-    noInterrupts();             // Disable global interrupts
-    
-    //_millis_period.w = 0xFFFF - (System_getPeripheralFrequency() / 1000);
-    _millis_period.w = 0xFFFF - (_cpu_clock_ / 4000);
-
-    #if defined(__16F1459) || defined(__16F1708)
-
-    T1CON = 0b00000001;         // T1_SOURCE_FOSCDIV4 | T1_PS_1_1;
-    T1GCONbits.TMR1GE = 0;      // Ignore T1DIG effection 
-    TMR1H = _millis_period.h8;
-    TMR1L = _millis_period.l8;
-    PIR1bits.TMR1IF = 0;
-    PIE1bits.TMR1IE = 1;
-
-    #else
-
-    T0CON = 0b00001000;         // T0_OFF | T0_16BIT | T0_SOURCE_INT | T0_PS_OFF;
-    TMR0H = _millis_period.h8;
-    TMR0L = _millis_period.l8;
-    INTCON2bits.TMR0IP = 1;     // INT_HIGH_PRIORITY;
-    INTCONbits.TMR0IF  = 0;
-    INTCONbits.TMR0IE  = 1;     // INT_ENABLE;
-    T0CONbits.TMR0ON   = 1;
-
-    #endif
-
-    interrupts();               // Enable global interrupts
-
-    _millis = 0;
+    timebase_init(_cpu_clock_ / 4);
 }
 
+/*  --------------------------------------------------------------------
+    ms and us since millis_init(), they wrap after 49 days and 71 min.
+    Always compare differences : (millis() - start) >= timeout
+    ------------------------------------------------------------------*/
+
 u32 millis()
 {
-    u32 temp;
+    u32 ms;
+    u16 ticks;
 
-    /* Atomic operation */
-
-    #if defined(__16F1459) || defined(__16F1708)
-    
-    PIE1bits.TMR1IE = 0;
-    temp = _millis;
-    PIE1bits.TMR1IE = 1;
-
-    #else
+    timebase_read(&ms, &ticks);
+    return ms;
+}
 
-    INTCONbits.TMR0IE = 0;      //INT_DISABLE;
-    temp = _millis;
-    INTCONbits.TMR0IE = 1;      //INT_ENABLE;
+u32 micros()
+{
+    u32 ms;
+    u16 ticks;
 
-    #endif
+    timebase_read(&ms, &ticks);
+    return ms * 1000 + timebase_us(ticks);
+}
 
-    return temp;
+u32 elapsed(u32 start)
+{
+    return millis() - start;
 }
 
 // called by interruption service routine in main.c
 void millis_interrupt(void)
 {
-    #if defined(__16F1459) || defined(__16F1708)
-    
-    if (PIR1bits.TMR1IF)
-    {
-        PIR1bits.TMR1IF = 0;
-        TMR1H = _millis_period.h8;
-        TMR1L = _millis_period.l8;
-        _millis++;
-    }
-
-    #else
-
-    if (INTCONbits.TMR0IF)
-    {
-        INTCONbits.TMR0IF = 0;
-        TMR0H = _millis_period.h8;//0xD1;
-        TMR0L = _millis_period.l8;//0x1F;
-        _millis++;
-    }
-
-    #endif
+    timebase_interrupt();
 }
 
 #endif /* _MILLIS_C_ */
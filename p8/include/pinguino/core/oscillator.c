@@ -54,8 +54,8 @@
     #include <flash.c>
 #endif
 
-#if defined(_MILLIS_C_)
-extern volatile t16 _period;
+#if defined(_TIMEBASE_C_)
+extern void timebase_setfreq(u32);
 #endif
 
 // defined in main.cclear
@@ -1128,18 +1128,18 @@ void System_setIntOsc(u32 freq)
     // RB : Can not work because this function call System_getPeripheralFrequency()
     //updateMillisReloadValue();
 
-    #if defined(_MILLIS_C_)
+    #if defined(_TIMEBASE_C_)
     
         #if defined(__16F1459) || defined(__16F1708)
         
         PIE1bits.TMR1IE = 0;
-        _period.w = 0xFFFF - (_cpu_clock_ / 4 / 1000) ;
+        timebase_setfreq(_cpu_clock_ / 4);
         PIE1bits.TMR1IE = 1;
 
         #else
 
         INTCONbits.TMR0IE = 0;
-        _period.w = 0xFFFF - (_cpu_clock_ / 4 / 1000) ;
+        timebase_setfreq(_cpu_clock_ / 4);
         INTCONbits.TMR0IE = 1;
 
         #endif
@@ -0,0 +1,209 @@
+/*  --------------------------------------------------------------------
+    FILE:           portgroup.c
+    PROJECT:        pinguino
+    PURPOSE:        write or read several pins of the same port at once
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    A group is made of up to 8 pins of the same port, given in any
+    order. Bit i of the value written or read is the i-th pin. The port
+    and bits are looked up once by portgroup_init(), then each write is
+    a single read-modify-write of the LATx register, each read a single
+    read of PORTx. When the pins are consecutive bits in ascending
+    order the value is only shifted.
+
+        u8 data[4] = { 4, 5, 6, 7 };
+        PortGroup bus;
+        if (portgroup_init(&bus, data, 4))
+        {
+            portgroup_mode(&bus, OUTPUT);
+            portgroup_write(&bus, 0x0A);    // pins 5 and 7 high
+        }
+
+    Libraries which keep their pins in variables (lcdlib, ...) can use
+    a group instead of a digitalwrite() per pin and fall back to the
+    latter when portgroup_init() fails.
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+    ------------------------------------------------------------------*/
+
+#ifndef __PORTGROUP_C
+#define __PORTGROUP_C
+
+#include <compiler.h>
+#include <typedef.h>
+#include <digital.h>
+
+typedef struct
+{
+    u8 port;                        // pA, pB, ...
+    u8 mask;                        // bits of the group in the port
+    u8 shift;                       // bit number of the first pin
+    u8 packed;                      // consecutive bits, ascending order
+    u8 n;                           // number of pins
+    u8 bit[8];                      // bit of each pin in the port
+} PortGroup;
+
+/*  --------------------------------------------------------------------
+    portgroup_init
+    --------------------------------------------------------------------
+    @param:     g       group to fill
+                pins    Pinguino pin numbers, bit 0 first
+                n       number of pins, 1 to 8
+    @return:    1 if all the pins belong to the same port, else 0
+    ------------------------------------------------------------------*/
+
+u8 portgroup_init(PortGroup *g, const u8 *pins, u8 n)
+{
+    u8 i, m;
+
+    if (n == 0 || n > 8)
+        return 0;
+
+    g->port = port[pins[0]];
+    g->mask = 0;
+    g->n = n;
+    g->packed = 1;
+
+    for (i = 0; i < n; i++)
+    {
+        m = mask[pins[i]];
+        if (port[pins[i]] != g->port || m == _U || (g->mask & m))
+            return 0;
+        g->bit[i] = m;
+        g->mask |= m;
+        if (m != (g->bit[0] << i))
+            g->packed = 0;
+    }
+
+    for (g->shift = 0; !(g->bit[0] & (1 << g->shift)); g->shift++);
+
+    return 1;
+}
+
+/*  --------------------------------------------------------------------
+    portgroup_bits
+    --------------------------------------------------------------------
+    @return:    bits of the port for the value
+    ------------------------------------------------------------------*/
+
+u8 portgroup_bits(PortGroup *g, u8 value)
+{
+    u8 i, bits = 0;
+
+    if (g->packed)
+        return (value << g->shift) & g->mask;
+
+    for (i = 0; i < g->n; i++)
+    {
+        if (value & 1)
+            bits |= g->bit[i];
+        value >>= 1;
+    }
+    return bits;
+}
+
+/*  --------------------------------------------------------------------
+    portgroup_write
+    --------------------------------------------------------------------
+    @descr:     bit i of value to the i-th pin, the other pins of the
+                port are left as they are
+    ------------------------------------------------------------------*/
+
+void portgroup_write(PortGroup *g, u8 value)
+{
+    u8 bits = portgroup_bits(g, value);
+    u8 c = 255 - g->mask;
+
+    switch (g->port)
+    {
+        case pA: LATA = (LATA & c) | bits; break;
+        case pB: LATB = (LATB & c) | bits; break;
+        case pC: LATC = (LATC & c) | bits; break;
+        #if defined(PINGUINO4455)   || defined(PINGUINO4550)   || \
+            defined(PINGUINO45K50)  || defined(PINGUINO46J50)  || \
+            defined(PINGUINO47J53A) || defined(PINGUINO47J53B) || \
+            defined(PICUNO_EQUO)
+        case pD: LATD = (LATD & c) | bits; break;
+        case pE: LATE = (LATE & c) | bits; break;
+        #endif
+    }
+}
+
+/*  --------------------------------------------------------------------
+    portgroup_read
+    --------------------------------------------------------------------
+    @return:    state of the i-th pin in bit i
+    ------------------------------------------------------------------*/
+
+u8 portgroup_read(PortGroup *g)
+{
+    u8 i, r = 0, value = 0;
+
+    switch (g->port)
+    {
+        case pA: r = PORTA; break;
+        case pB: r = PORTB; break;
+        case pC: r = PORTC; break;
+        #if defined(PINGUINO4455)   || defined(PINGUINO4550)   || \
+            defined(PINGUINO45K50)  || defined(PINGUINO46J50)  || \
+            defined(PINGUINO47J53A) || defined(PINGUINO47J53B) || \
+            defined(PICUNO_EQUO)
+        case pD: r = PORTD; break;
+        case pE: r = PORTE; break;
+        #endif
+    }
+
+    if (g->packed)
+        return (r & g->mask) >> g->shift;
+
+    for (i = g->n; i > 0; i--)
+    {
+        value <<= 1;
+        if (r & g->bit[i - 1])
+            value |= 1;
+    }
+    return value;
+}
+
+/*  --------------------------------------------------------------------
+    portgroup_mode
+    --------------------------------------------------------------------
+    @descr:     all the pins as INPUT or OUTPUT with one TRISx access
+    ------------------------------------------------------------------*/
+
+void portgroup_mode(PortGroup *g, u8 state)
+{
+    u8 m = g->mask;
+    u8 c = 255 - m;
+
+    switch (g->port)
+    {
+        case pA: TRISA = state ? (TRISA | m) : (TRISA & c); break;
+        case pB: TRISB = state ? (TRISB | m) : (TRISB & c); break;
+        case pC: TRISC = state ? (TRISC | m) : (TRISC & c); break;
+        #if defined(PINGUINO4455)   || defined(PINGUINO4550)   || \
+            defined(PINGUINO45K50)  || defined(PINGUINO46J50)  || \
+            defined(PINGUINO47J53A) || defined(PINGUINO47J53B) || \
+            defined(PICUNO_EQUO)
+        case pD: TRISD = state ? (TRISD | m) : (TRISD & c); break;
+        case pE: TRISE = state ? (TRISE | m) : (TRISE & c); break;
+        #endif
+    }
+}
+
+#endif /* __PORTGROUP_C */
@@ -42,6 +42,16 @@
 #ifndef __PWM__
 #define __PWM__
 
+// CCP1 and CCP2 reset Timer1 and Timer3 (interrupt.c)
+#if defined(TMR1CCP) || defined(TMR3CCP)
+    #error "PWM : CCP1 or CCP2 is already used by TMR1CCP or TMR3CCP."
+#endif
+
+// Timer2 gives the PWM period (swserial.c)
+#if defined(__SWSERIAL__)
+    #error "PWM : Timer2 is already used by SwSerial."
+#endif
+
 #include <compiler.h>       // sfr's
 #include <typedef.h>        // u8, u16, u32, ...
 #include <pin.h>            // USERLED, CCPx, PWMx, ...
@@ -577,6 +577,20 @@ void printChar(u8 c)
 }
 */
 
+/***********************************************************************
+ * Serial.printSpan2()
+ * Write a run of chars on Serial port (span sink of the printf)
+ **********************************************************************/
+
+#if defined(SERIALPRINTF)  || defined(SERIALPRINTFSW) || \
+    defined(SERIALPRINTF1) || defined(SERIALPRINTF2)
+void Serial_printSpan2(const u8 *s, u16 n)
+{
+    while (n--)
+        Serial_printChar2(*s++);
+}
+#endif
+
 /***********************************************************************
  * USB SERIAL print routine (SERIAL.print)
  * 16-08-2011: fixed bug in print - Régis Blanchot & Tiew Weng Khai
@@ -682,7 +696,7 @@ void Serial_printf(u8 module, char *fmt, ...)
     va_list args;
     va_start(args, fmt);
     UART_Module = module;
-    pprintf(Serial_printChar2, fmt, args);
+    pprintfw(Serial_printSpan2, fmt, args);
     va_end(args);
 }
 #endif /* SERIALPRINTF */
@@ -693,7 +707,7 @@ void SerialSW_printf(char *fmt, ...)
     va_list args;
     va_start(args, fmt);
     UART_Module = UARTSW;
-    pprintf(Serial_printChar2, fmt, args);
+    pprintfw(Serial_printSpan2, fmt, args);
     va_end(args);
 }
 #endif /* SERIALPRINTFSW */
@@ -704,7 +718,7 @@ void Serial1_printf(char *fmt, ...)
     va_list args;
     va_start(args, fmt);
     UART_Module = UART1;
-    pprintf(Serial_printChar2, fmt, args);
+    pprintfw(Serial_printSpan2, fmt, args);
     va_end(args);
 }
 #endif /* SERIALPRINTF1 */
@@ -715,7 +729,7 @@ void Serial2_printf(char *fmt, ...)
     va_list args;
     va_start(args, fmt);
     UART_Module = UART2;
-    pprintf(Serial_printChar2, fmt, args);
+    pprintfw(Serial_printSpan2, fmt, args);
     va_end(args);
 }
 #endif /* SERIALPRINTF2 */
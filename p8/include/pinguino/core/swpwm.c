@@ -6,6 +6,8 @@
     --------------------------------------------------------------------
     Changelog :
     18 Apr. 2016 - Régis Blanchot - first release
+    19 Oct. 2026 - staged duty cycles, SWPWM_commit() hands a whole set
+                   of them to the ISR at the beginning of a period
     --------------------------------------------------------------------
     To do :
     * Change to Timer 1
@@ -37,12 +39,16 @@
 #define SWPWMRES                255 // PWM resolution
 #define SWPWMNBPIN              8   // Number of SW PWM pin
 
-volatile u8 gDutyCycle[SWPWMNBPIN];
+volatile u8 gDutyCycle[SWPWMNBPIN];     // read by the ISR
 volatile u8 gCounter=0;
 volatile u8 gPinNum=0;
 volatile u8 gPinActivated=0;
 volatile t16 _swpwm_period;
 
+u8 gStagedDutyCycle[SWPWMNBPIN];        // next values, see SWPWM_commit
+u8 gStagedActivated=0;
+volatile u8 gSWPWMPending=0;
+
 /*  --------------------------------------------------------------------
     SWPWM_setFrequency
     --------------------------------------------------------------------
@@ -79,6 +85,39 @@ u16 SWPWM_setFrequency(u32 freq)
     return _swpwm_period.w;
 }
 
+/*  --------------------------------------------------------------------
+    SWPWM_stageDutyCycle
+    --------------------------------------------------------------------
+    Prepare a new duty cycle, the output doesn't change before the
+    next SWPWM_commit(). Several pins (the 3 colors of a RGB led for
+    ex.) can then be changed on the same PWM period.
+    @param pin:		PortB pin (0 to 7)
+    @param duty:	8-bit duty cycle
+    ------------------------------------------------------------------*/
+
+void SWPWM_stageDutyCycle(u8 pin, u8 duty)
+{
+    if (pin >= SWPWMNBPIN)
+        return;
+
+    BitClear(TRISB, pin);           // Configure pins as output
+    BitSet(gStagedActivated, pin);  // Declare pin as activated
+    gStagedDutyCycle[pin] = duty;   // Set duty cycle
+}
+
+/*  --------------------------------------------------------------------
+    SWPWM_commit
+    --------------------------------------------------------------------
+    The ISR copies the staged duty cycles when its counter wraps, so
+    they all start on the same period and none of the pins gets a
+    period mixing its old and new duty cycles.
+    ------------------------------------------------------------------*/
+
+void SWPWM_commit()
+{
+    gSWPWMPending = 1;
+}
+
 /*  --------------------------------------------------------------------
     PWM_setDutyCycle
     --------------------------------------------------------------------
@@ -89,9 +128,8 @@ u16 SWPWM_setFrequency(u32 freq)
 
 void SWPWM_setDutyCycle(u8 pin, u8 duty)
 {
-    BitClear(TRISB, pin);           // Configure pins as output
-    BitSet(gPinActivated, pin);     // Declare pin as activated
-    gDutyCycle[pin] = duty;         // Set duty cycle
+    SWPWM_stageDutyCycle(pin, duty);
+    SWPWM_commit();
 }
 
 /*  --------------------------------------------------------------------
@@ -141,6 +179,20 @@ void swpwm_interrupt()
         gCounter++;
         gCounter &= SWPWMRES;
         //
+        if (gCounter == 0 && gSWPWMPending)
+        {
+            gDutyCycle[0] = gStagedDutyCycle[0];
+            gDutyCycle[1] = gStagedDutyCycle[1];
+            gDutyCycle[2] = gStagedDutyCycle[2];
+            gDutyCycle[3] = gStagedDutyCycle[3];
+            gDutyCycle[4] = gStagedDutyCycle[4];
+            gDutyCycle[5] = gStagedDutyCycle[5];
+            gDutyCycle[6] = gStagedDutyCycle[6];
+            gDutyCycle[7] = gStagedDutyCycle[7];
+            gPinActivated = gStagedActivated;
+            gSWPWMPending = 0;
+        }
+        //
         if (gPinActivated & 1)
             LATBbits.LATB0 = (gCounter < gDutyCycle[0]);
         if (gPinActivated & 2)
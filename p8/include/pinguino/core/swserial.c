@@ -1,388 +1,552 @@
-/* $Id: getsuart.c,v 1.1 2003/12/09 22:43:28 GrosbaJ Exp $ */
-/* $Id: swserial_print.c,v 1.1 2003/12/09 22:43:28 GrosbaJ Exp $ */
-// Adaptation from Free Open Source Codes Forge and Sharing - www.codeforge.com
-// Functions to get RS232 transmission without UART hardware
-// RXD pin is defined on RB5, TXD on RB4
-// other pairs can be chosen on digital pins
-// OSC_FREQ = 48 MHz standard frequency for Pinguino Board 18fx550
-// BAUDRATE = 9600 Bds
-// For other configurations calculate 3 new delays according to following formulas
-//DelayRXHalfBitUART = (((2*OSC_FREQ)/(8*BAUDRATE))+1)/2 - 9 Tcy
-//DelayRXBitUART = (((2*OSC_FREQ)/(4*BAUDRATE))+1)/2 - 14 Tcy
-//DelayTXBitUART = (((2*OSC_FREQ)/(4*BAUDRATE))+1)/2 - 12 Tcy
-// change each Delay function :
-// for example, here with 48 Mhz and 9600 Bds DelayRXHalfBitUART = 616 = 61 x 10Tcy + 6 Tcy
-// -> therefore we find delay10tcy(61) (this is a SDCC function defined in delay.h header)
-//                  and 3 nop (asm code nop = 2Tcy)
-
-// 29/08/2014 adapted by A. Gentric for Pinguino Project
-// Baud rates 115200, 2400, 1200 do not work perfectly
+/*  --------------------------------------------------------------------
+    FILE:       swserial.c
+    PROJECT:    Pinguino
+    PURPOSE:    Software UART Library for 8-bit Pinguino
+    PROGRAMER:  Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    29-08-2014  A. Gentric     - blocking version adapted for Pinguino
+    19-10-2026  interrupt driven, full duplex, up to 3 channels
+    --------------------------------------------------------------------
+    Timer2 interrupts at 3 times the fastest baud rate, on each tick
+    every channel :
+    * RX : looks for a start bit (falling edge) then samples each bit
+      in its middle, +/- 1/6 bit, and stores the byte in its buffer.
+    * TX : shifts the next bit out when a bit time is over.
+    A slower channel counts more ticks per bit, its baud rate should
+    divide the fastest one.
+
+    Nothing waits for the line, SwSerial_printChar() only waits when
+    the TX buffer is full. At 48 MHz, 9600 bauds on 2 channels or
+    4800 bauds on 3 channels are a reasonable maximum.
+
+    Timer2 can't be used for anything else : OnTimer2, PWM,
+    analogWrite and the audio library are refused at compile time.
+
+    Define SWSERIAL_GET, SWSERIAL_SET, SWSERIAL_CLR, SWSERIAL_PENDING
+    and SWSERIAL_CLEAR to test the bit engine on a host.
+    --------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the
+    Free Software Foundation; either version 2, or (at your option) any
+    later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+    ------------------------------------------------------------------*/
 
 #ifndef __SWSERIAL__
 #define __SWSERIAL__
 
-#include <delay.h>
-#include <printFormated.c>
-#include <stdarg.h>
+// Timer2 period and interrupt
+#if defined(TMR2INT)
+    #error "SwSerial : Timer2 is already used by OnTimer2."
+#endif
+#if defined(__PWM__) || defined(ANALOGWRITE)
+    #error "SwSerial : Timer2 is already used by PWM or analogWrite."
+#endif
+#if defined(__AUDIO__)
+    #error "SwSerial : Timer2 is already used by the audio library."
+#endif
+
+#include <compiler.h>
+#include <typedef.h>        // u8, u16, ...
+#include <const.h>          // INPUT, OUTPUT, ...
+#include <macro.h>          // interrupts(), noInterrupts()
+#include <swserial.h>
+#include <stdarg.h>         // variadic functions
+
+// Printf
+#if defined(SWSERIALPRINTF)  || defined(SWSERIALPRINTF1) || \
+    defined(SWSERIALPRINTF2) || defined(SWSERIALPRINTF3)
+    #include <printFormated.c>
+#endif
+
+// PrintFloat
+#if defined(SWSERIALPRINTFLOAT)
+    #include <printFloat.c>
+#endif
+
+// PrintNumber
+#if defined(SWSERIALPRINTNUMBER) || defined(SWSERIALPRINTFLOAT)
+    #include <printNumber.c>
+#endif
+
+#ifndef SWSERIAL_GET
+
+#include <digital.h>        // port[], mask[]
+#include <digitalp.c>       // pinmode
+
+#define SWSERIAL_GET(p, m)      (*(p) & (m))
+#define SWSERIAL_SET(p, m)      (*(p) |= (m))
+#define SWSERIAL_CLR(p, m)      (*(p) &= ~(m))
+#define SWSERIAL_PENDING()      (PIE1bits.TMR2IE && PIR1bits.TMR2IF)
+#define SWSERIAL_CLEAR()        (PIR1bits.TMR2IF = 0)
+
+#endif /* SWSERIAL_GET */
 
-char uartdata;
-void swserial_printf(char *fmt, ...);
+swserial_t SwSerial[SWSERIAL_CHANNELS];
 
-#if (SWBAUDRATE ==57600)
-void DelayRXHalfBitUART(void)
+static volatile u8 _swserial_sink;          // unused TX or DE pin
+static volatile u8 _swserial_idle = 0xFF;   // unused RX pin
+#if defined(SWSERIALPRINTNUMBER) || defined(SWSERIALPRINTFLOAT) || \
+    defined(SWSERIALPRINTF)      || defined(SWSERIALPRINTF1)    || \
+    defined(SWSERIALPRINTF2)     || defined(SWSERIALPRINTF3)
+static u8 _swserial_ch;                     // for printf, printNumber, ...
+#endif
+
+/*  --------------------------------------------------------------------
+    Bit engine, called on every tick
+    ------------------------------------------------------------------*/
+
+static void swserial_tick(swserial_t *c)
 {
-//delay = (((2*OSC_FREQ)/(8*BAUDRATE))+1)/2 - 9 Tcy
-    delay10tcy(9); //9+6nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    u8 b;
+
+    /// RX
+
+    if (c->rxbits == 0)
+    {
+        // start bit, check it in its middle
+        if (!SWSERIAL_GET(c->rxport, c->rxmask))
+        {
+            c->rxbits = 10;
+            c->rxtick = c->nbit >> 1;
+        }
+    }
+    else if (--c->rxtick == 0)
+    {
+        b = SWSERIAL_GET(c->rxport, c->rxmask);
+        c->rxtick = c->nbit;
+
+        if (c->rxbits == 10)
+        {
+            // glitch
+            if (b)
+                c->rxbits = 0;
+            else
+                c->rxbits--;
+        }
+        else if (--c->rxbits)
+        {
+            // data, lsb first
+            c->rxshift >>= 1;
+            if (b)
+                c->rxshift |= 0x80;
+        }
+        else
+        {
+            // stop bit
+            if (b && (u8)(c->rxhead - c->rxtail) < SWSERIAL_RXBUFFER)
+            {
+                c->rxbuf[c->rxhead & (SWSERIAL_RXBUFFER - 1)] = c->rxshift;
+                c->rxhead++;
+            }
+            else
+                c->errors++;
+        }
+    }
+
+    /// TX
+
+    if (c->txtick && --c->txtick)
+        return;
+
+    if (c->txbits)
+    {
+        if (--c->txbits)
+        {
+            // data, lsb first
+            if (c->txshift & 1)
+                SWSERIAL_SET(c->txlat, c->txmask);
+            else
+                SWSERIAL_CLR(c->txlat, c->txmask);
+            c->txshift >>= 1;
+        }
+        else
+        {
+            // stop bit
+            SWSERIAL_SET(c->txlat, c->txmask);
+        }
+        c->txtick = c->nbit;
+    }
+    else if (c->txhead != c->txtail)
+    {
+        // start bit
+        SWSERIAL_SET(c->delat, c->demask);
+        SWSERIAL_CLR(c->txlat, c->txmask);
+        c->txshift = c->txbuf[c->txtail & (SWSERIAL_TXBUFFER - 1)];
+        c->txtail++;
+        c->txbits = 9;
+        c->txtick = c->nbit;
+    }
+    else
+    {
+        // last stop bit is over
+        SWSERIAL_CLR(c->delat, c->demask);
+    }
 }
 
-void DelayRXBitUART(void)
+/*  --------------------------------------------------------------------
+    Interruption routine called by main.c
+    ------------------------------------------------------------------*/
+
+void swserial_interrupt(void)
 {
-//delay = (((2*OSC_FREQ)/(4*BAUDRATE))+1)/2 - 14 Tcy
-    delay10tcy(19);//19+6nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    u8 i;
+
+    if (SWSERIAL_PENDING())
+    {
+        SWSERIAL_CLEAR();
+        for (i = 0; i < SWSERIAL_CHANNELS; i++)
+            if (SwSerial[i].nbit)
+                swserial_tick(&SwSerial[i]);
+    }
 }
 
-void DelayTXBitUART(void)
+/*  --------------------------------------------------------------------
+    Hardware
+    ------------------------------------------------------------------*/
+
+#ifndef SWSERIAL_REG
+
+// LATx (lat = 1) or PORTx (lat = 0) register of a pin
+static volatile u8 * swserial_reg(u8 pin, u8 lat)
 {
-    delay10tcy(19);//19+4nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    switch (port[pin])
+    {
+        case pA: return lat ? &LATA : &PORTA;
+        case pB: return lat ? &LATB : &PORTB;
+        case pC: return lat ? &LATC : &PORTC;
+        #if defined(PINGUINO4455)   || defined(PINGUINO4550)   || \
+            defined(PINGUINO45K50)  || defined(PINGUINO46J50)  || \
+            defined(PINGUINO47J53A) || defined(PINGUINO47J53B) || \
+            defined(PICUNO_EQUO)
+        case pD: return lat ? &LATD : &PORTD;
+        case pE: return lat ? &LATE : &PORTE;
+        #endif
+    }
+    return &_swserial_sink;
 }
-#elif (SWBAUDRATE ==38400)
-void DelayRXHalfBitUART(void)
+
+#define SWSERIAL_REG(pin, lat)  swserial_reg(pin, lat)
+#define SWSERIAL_MASK(pin)      (mask[pin])
+#define SWSERIAL_PINMODE(p, m)  pinmode(p, m)
+
+#endif /* SWSERIAL_REG */
+
+#ifndef SWSERIAL_TIMER
+
+/*  --------------------------------------------------------------------
+    Timer2 period = prescaler (1, 4, 16) * (PR2 + 1) * postscaler (1..16)
+    PR2 is reloaded by the hardware, the tick doesn't drift
+    ------------------------------------------------------------------*/
+
+static void swserial_timer(u32 cycles)
 {
-//delay = (((2*OSC_FREQ)/(8*BAUDRATE))+1)/2 - 9 Tcy
-    delay10tcy(14); //14+8nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    u8 ps, post = 16;
+    u16 div;
+    u32 period = 256;
+
+    for (ps = 0; ps < 3; ps++)
+    {
+        for (post = 1; post <= 16; post++)
+        {
+            div = (u16)post << (ps * 2);
+            period = (cycles + div / 2) / div;
+            if (period <= 256)
+                break;
+        }
+        if (period <= 256)
+            break;
+    }
+
+    if (ps == 3)
+    {
+        ps = 2;
+        post = 16;
+        period = 256;
+    }
+
+    noInterrupts();
+
+    T2CON = ((post - 1) << 3) | ps;     // postscaler, prescaler, off
+    TMR2 = 0;
+    PR2 = period - 1;
+
+    #if !defined(__16F1459) && !defined(__16F1708)
+    IPR1bits.TMR2IP = 1;                // INT_HIGH_PRIORITY
+    #endif
+
+    PIR1bits.TMR2IF = 0;
+    PIE1bits.TMR2IE = 1;
+    T2CONbits.TMR2ON = 1;
+
+    interrupts();
 }
 
-void DelayRXBitUART(void)
+#define SWSERIAL_TIMER(cycles)  swserial_timer(cycles)
+
+#endif /* SWSERIAL_TIMER */
+
+/***********************************************************************
+ * SwSerial.begin()
+ * ch       : SWSERIAL1, SWSERIAL2 or SWSERIAL3
+ * txpin    : any digital pin, SWSERIAL_NOPIN if not used
+ * rxpin    : any digital pin, SWSERIAL_NOPIN if not used
+ * The tick is adjusted to the fastest channel
+ **********************************************************************/
+
+void SwSerial_begin(u8 ch, u32 baudrate, u8 txpin, u8 rxpin)
 {
-//delay = (((2*OSC_FREQ)/(4*BAUDRATE))+1)/2 - 14 Tcy
-    delay10tcy(29); //29 + 8nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    swserial_t *c = &SwSerial[ch];
+    u32 fastest = baudrate;
+    u8 i;
+
+    c->nbit = 0;                        // stop the channel
+
+    if (txpin == SWSERIAL_NOPIN)
+    {
+        c->txlat = &_swserial_sink;
+        c->txmask = 0;
+    }
+    else
+    {
+        c->txlat = SWSERIAL_REG(txpin, 1);
+        c->txmask = SWSERIAL_MASK(txpin);
+        SWSERIAL_SET(c->txlat, c->txmask);  // line idling
+        SWSERIAL_PINMODE(txpin, OUTPUT);
+    }
+
+    if (rxpin == SWSERIAL_NOPIN)
+    {
+        c->rxport = &_swserial_idle;
+        c->rxmask = 0xFF;
+    }
+    else
+    {
+        c->rxport = SWSERIAL_REG(rxpin, 0);
+        c->rxmask = SWSERIAL_MASK(rxpin);
+        SWSERIAL_PINMODE(rxpin, INPUT);
+    }
+
+    if (!c->delat)
+    {
+        c->delat = &_swserial_sink;
+        c->demask = 0;
+    }
+
+    c->txhead = c->txtail = 0;
+    c->rxhead = c->rxtail = 0;
+    c->txtick = c->txbits = 0;
+    c->rxtick = c->rxbits = 0;
+    c->errors = 0;
+    c->baud = baudrate;
+
+    for (i = 0; i < SWSERIAL_CHANNELS; i++)
+        if (SwSerial[i].baud > fastest)
+            fastest = SwSerial[i].baud;
+
+    // 3 ticks per bit on the fastest channel
+    SWSERIAL_TIMER(_cpu_clock_ / 4 / (3 * fastest));
+
+    for (i = 0; i < SWSERIAL_CHANNELS; i++)
+        if (SwSerial[i].baud)
+            SwSerial[i].nbit = (3 * fastest + SwSerial[i].baud / 2) / SwSerial[i].baud;
 }
 
-void DelayTXBitUART(void)
+/***********************************************************************
+ * SwSerial.setDirPin()
+ * RS-485 driver enable, high from the first start bit to the last
+ * stop bit
+ **********************************************************************/
+
+void SwSerial_setDirPin(u8 ch, u8 pin)
 {
-    delay10tcy(30);//30+1nop
-    __asm
-    nop
-    __endasm;
+    swserial_t *c = &SwSerial[ch];
+    volatile u8 *lat = SWSERIAL_REG(pin, 1);
+
+    SWSERIAL_CLR(lat, SWSERIAL_MASK(pin));
+    SWSERIAL_PINMODE(pin, OUTPUT);
+    c->demask = SWSERIAL_MASK(pin);
+    c->delat = lat;
 }
 
-#elif (SWBAUDRATE ==19200)
-void DelayRXHalfBitUART(void)
+/***********************************************************************
+ * SwSerial.printChar()
+ * Queue a char, wait only if the TX buffer is full
+ **********************************************************************/
+
+void SwSerial_printChar(u8 ch, u8 c)
 {
-//delay = (((2*OSC_FREQ)/(8*BAUDRATE))+1)/2 - 9 Tcy
-    delay10tcy(30); //30 + 4 nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    swserial_t *s = &SwSerial[ch];
+
+    while ((u8)(s->txhead - s->txtail) == SWSERIAL_TXBUFFER);
+    s->txbuf[s->txhead & (SWSERIAL_TXBUFFER - 1)] = c;
+    s->txhead++;
 }
 
-void DelayRXBitUART(void)
+// current channel, for the functions with a funcout parameter
+#if defined(SWSERIALPRINTNUMBER) || defined(SWSERIALPRINTFLOAT) || \
+    defined(SWSERIALPRINTF)      || defined(SWSERIALPRINTF1)    || \
+    defined(SWSERIALPRINTF2)     || defined(SWSERIALPRINTF3)
+static void swserial_putc(u8 c)
 {
-//delay = (((2*OSC_FREQ)/(4*BAUDRATE))+1)/2 - 14 Tcy
-    delay10tcy(61); //61 + 1 nop
-    __asm
-    nop
-    __endasm;
+    SwSerial_printChar(_swserial_ch, c);
 }
+#endif
 
-void DelayTXBitUART(void)
-{
+/***********************************************************************
+ * SwSerial.print()
+ * SwSerial.println()
+ **********************************************************************/
 
-    delay10tcy(61);//61 + 3 nop
-    __asm
-    nop
-    nop
-    nop
-    __endasm;
-}
-#elif (SWBAUDRATE ==9600)
-void DelayRXHalfBitUART(void)
+#if defined(SWSERIALPRINTSTRING) || defined(SWSERIALPRINTLN)
+
+void SwSerial_print(u8 ch, const char *s)
 {
-//delay = (((2*OSC_FREQ)/(8*BAUDRATE))+1)/2 - 9 Tcy
-    delay10tcy(61); //61 + 6nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    while (*s)
+        SwSerial_printChar(ch, *s++);
 }
 
-void DelayRXBitUART(void)
+#endif /* SWSERIALPRINTSTRING */
+
+#if defined(SWSERIALPRINTLN)
+void SwSerial_println(u8 ch, const char *s)
 {
-//delay = (((2*OSC_FREQ)/(4*BAUDRATE))+1)/2 - 14 Tcy
-    delay10tcy(123); //123+6nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    SwSerial_print(ch, s);
+    SwSerial_print(ch, (const char *)"\n\r");
 }
+#endif /* SWSERIALPRINTLN */
+
+/***********************************************************************
+ * SwSerial.printNumber()
+ * SwSerial.printFloat()
+ **********************************************************************/
 
-void DelayTXBitUART(void)
+#if defined(SWSERIALPRINTNUMBER)
+void SwSerial_printNumber(u8 ch, s32 value, u8 base)
 {
-    delay10tcy(123);//123 +8nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    _swserial_ch = ch;
+    printNumber(swserial_putc, value, base);
 }
-#elif (SWBAUDRATE ==4800)
-void DelayRXHalfBitUART(void)
+#endif /* SWSERIALPRINTNUMBER */
+
+#if defined(SWSERIALPRINTFLOAT)
+void SwSerial_printFloat(u8 ch, float number, u8 digits)
 {
-//delay = (((2*OSC_FREQ)/(8*BAUDRATE))+1)/2 - 9 Tcy
-    delay10tcy(124); //124+1nop
-    __asm
-    nop
-    __endasm;
+    _swserial_ch = ch;
+    printFloat(swserial_putc, number, digits);
 }
+#endif /* SWSERIALPRINTFLOAT */
 
-void DelayRXBitUART(void)
+/***********************************************************************
+ * SwSerial.printf()
+ **********************************************************************/
+
+#if defined(SWSERIALPRINTF)
+void SwSerial_printf(u8 ch, char *fmt, ...)
 {
-//delay = (((2*OSC_FREQ)/(4*BAUDRATE))+1)/2 - 14 Tcy
-    delay10tcy(248); //248 + 6nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    va_list args;
+    va_start(args, fmt);
+    _swserial_ch = ch;
+    pprintf(swserial_putc, fmt, args);
+    va_end(args);
 }
+#endif /* SWSERIALPRINTF */
 
-void DelayTXBitUART(void)
+#if defined(SWSERIALPRINTF1)
+void SwSerial1_printf(char *fmt, ...)
 {
-    delay10tcy(248);//248+8nop
-    __asm
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    nop
-    __endasm;
+    va_list args;
+    va_start(args, fmt);
+    _swserial_ch = SWSERIAL1;
+    pprintf(swserial_putc, fmt, args);
+    va_end(args);
 }
-#endif
+#endif /* SWSERIALPRINTF1 */
 
-/* **********************************************************************
-*      Function Name:  ReadUART                                        *
-*      Return Value:   char: received data                             *
-*      Parameters:     void                                            *
-*      Description:    This routine waits for a start bit, and then    *
-*                      reads all 8-bits.                               *
-*      Special Note:   The user must provide two routines:             *
-*                      DelayRXHalfBit():                               *
-*                        DelayRXHalfBit should have:                   *
-*                              5 Tcy for overhead                      *
-*                              2 Tcy call to DelayRXHalfBit            *
-*                              ? Tcy                                   *
-*                              2 Tcy for return from DelayRXHalfBit    *
-*                              = (((2*OSC_FREQ)/(8*BAUDRATE))+1)/2 Tcy *
-*                      DelayRXBit():                                   *
-*                        DelayRXBit should have:                       *
-*                              10 Tcy for overhead                     *
-*                              2 Tcy call to DelayRXBit                *
-*                              ? Tcy                                   *
-*                              2 Tcy for return from DelayRXBit        *
-*                              = (((2*OSC_FREQ)/(4*BAUDRATE))+1)/2 Tcy *
-*********************************************************************** */
-
-unsigned char getcUART(void)
+#if defined(SWSERIALPRINTF2)
+void SwSerial2_printf(char *fmt, ...)
 {
-    extern unsigned char uartdata;
-    int i;
-    //unsigned char temp;
-
-    uartdata=0;
-
-    while (SW_PORT_RXDpin)
-    {
-        while (SW_PORT_RXDpin);
-        DelayRXHalfBitUART();
-    }
-
-    /*      __asm
-              banksel _PORTB
-        beginloop:
-              btfsc _PORTB,5
-              goto beginloop
-              call DelayRXHalfBitUART
-          __endasm;
-    */
-
-    // data reading
-    // bits are written one by one
-    for(i=0; i<8; i++)
-    {
-        DelayRXBitUART();
-        //uartdata = uartdata | (SW_PORT_RXDpin<<i);
-          __asm
-            banksel _SW_PORT
-            btfss   _SW_PORT,RXDpin         ; Set or clear the carry bit
-            bcf     STATUS,0                ; according to the state of the
-            btfsc   _SW_PORT,RXDpin         ; RXD I/O pin
-            bsf     STATUS,0
-            banksel _uartdata
-            rrcf    _uartdata,F             ; Rotate the carry into data
-          __endasm;
-    }
-          __asm
-            banksel _uartdata
-            movf   _uartdata,W,B
-          __endasm;
-
-    DelayRXBitUART(); // stop bit
-    //		swserial_printf("%c", uartdata);
-    return uartdata;
+    va_list args;
+    va_start(args, fmt);
+    _swserial_ch = SWSERIAL2;
+    pprintf(swserial_putc, fmt, args);
+    va_end(args);
 }
+#endif /* SWSERIALPRINTF2 */
 
-/* **********************************************************************
-*      Function Name:  WriteUART                                       *
-*      Return Value:   void                                            *
-*      Parameters:     data: byte to send out the UART                 *
-*      Description:    This routine sends a byte out the TXD pin.      *
-*      Special Note:   The user must provide a routine:                *
-*                      DelayTXBit():                                   *
-*                        DelayTXBit should have:                       *
-*                              8 Tcy for overhead                      *
-*                              2 Tcy call to DelayTXBit                *
-*                              ? Tcy                                   *
-*                              2 Tcy for return from DelayTXBit        *
-*                      = (((2*OSC_FREQ)/(4*BAUDRATE))+1)/2  Tcy        *
-*********************************************************************** */
-
-
-void swserial_printChar (unsigned char uartdat)
+#if defined(SWSERIALPRINTF3)
+void SwSerial3_printf(char *fmt, ...)
 {
-    int i;
-
-    uartdata=uartdat;
-    SW_PORT_TXDpin=1;
-    DelayTXBitUART();
-    SW_PORT_TXDpin=0; //start bit
-    DelayTXBitUART();
-    for(i=0;i < 8; i++)
-    {
-        __asm
-        banksel _uartdata
-        rrcf    _uartdata,F     ; Rotate next bit into carry
-        banksel _SW_PORT
-        btfss   STATUS,0        ; Set or clear TXD pin according
-        bcf     _SW_PORT,TXDpin ; to what is in the carry
-        btfsc   STATUS,0
-        bsf     _SW_PORT,TXDpin
-        __endasm;
-        //SW_PORT_TXDpin= (uartdata>>i) & 0x01;
-        DelayTXBitUART();
-    }
-    SW_PORT_TXDpin=1;
-    DelayTXBitUART();
+    va_list args;
+    va_start(args, fmt);
+    _swserial_ch = SWSERIAL3;
+    pprintf(swserial_putc, fmt, args);
+    va_end(args);
 }
+#endif /* SWSERIALPRINTF3 */
+
+/***********************************************************************
+ * SwSerial.readChar()
+ * Oldest char received, -1 if none
+ **********************************************************************/
 
-void swserial_printf(char *fmt, ...)
+u8 SwSerial_readChar(u8 ch)
 {
-	va_list args;
+    swserial_t *s = &SwSerial[ch];
+    u8 c;
 
-	va_start(args, fmt);
-	pprintf(swserial_printChar, fmt, args);
-	va_end(args);
+    if (s->rxhead == s->rxtail)
+        return (-1);
+
+    c = s->rxbuf[s->rxtail & (SWSERIAL_RXBUFFER - 1)];
+    s->rxtail++;
+    return c;
 }
 
-/********************************************************************
-*    Function Name:  getsUART                                       *
-*    Return Value:   void                                           *
-*    Parameters:     buffer: pointer to string                      *
-*                    len: length of characters to receive           *
-*    Description:    This routine receives a string of characters   *
-*                    from the SW UART of length specified by len.   *
-********************************************************************/
-unsigned char * getsUART(void)
+/***********************************************************************
+ * SwSerial.getKey()
+ * SwSerial.getString()
+ **********************************************************************/
+
+#if defined(SWSERIALGETKEY) || defined(SWSERIALGETSTRING)
+u8 SwSerial_getKey(u8 ch)
 {
-    // Need static attribute, because a function can not return
-    // local array without static attribute.
-	static unsigned char buffer[80];
-	unsigned char c;
-	unsigned char i = 0;
-
-	do {
-		c = getcUART();
-		swserial_printf("%c", c);
-        buffer[i++] = c;
-	} while (c != '\r');
-	buffer[i] = '\0';
-	return (buffer);
+    u8 c;
+
+    while (!SwSerial_available(ch));
+    c = SwSerial_readChar(ch);
+    SwSerial_flush(ch);
+    return c;
 }
+#endif /* SWSERIALGETKEY */
 
-/**********************************************************************
-*    Function Name:  swserial_print                                         *
-*    Return Value:   void                                             *
-*    Parameters:     data: pointer to string of data                  *
-*    Description:    This routine transmits a string of characters    *
-*                    to the UART data byte including the null.        *
-**********************************************************************/
-void swserial_print( char *datx)
+#if defined(SWSERIALGETSTRING)
+u8 * SwSerial_getString(u8 ch)
 {
-    while (*datx)
-        swserial_printChar(*datx++);
+    // static attribute to return local array
+    static u8 buffer[80];
+    u8 c;
+    u8 i = 0;
+
+    do {
+        c = SwSerial_getKey(ch);
+        SwSerial_printChar(ch, c);
+        if (c != '\r' && i < sizeof(buffer) - 1)
+            buffer[i++] = c;
+    } while (c != '\r');
+
+    buffer[i] = '\0';
+    return (buffer);
 }
+#endif /* SWSERIALGETSTRING */
 
-#endif // __SWSERIAL__
+#endif /* __SWSERIAL__ */
@@ -0,0 +1,141 @@
+/*  --------------------------------------------------------------------
+    FILE:       swserial.h
+    PROJECT:    Pinguino
+    PURPOSE:    Software UART Library for 8-bit Pinguino
+    PROGRAMER:  Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19-10-2026  first release
+    --------------------------------------------------------------------
+    This program is free software; you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the
+    Free Software Foundation; either version 2, or (at your option) any
+    later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+    ------------------------------------------------------------------*/
+
+#ifndef __SWSERIAL_H
+#define __SWSERIAL_H
+
+#include <typedef.h>
+#include <stdarg.h>         // variadic functions
+
+#define SWSERIAL1           0
+#define SWSERIAL2           1
+#define SWSERIAL3           2
+
+#define SWSERIAL_NOPIN      0xFF    // TX or RX not used
+
+// Number of channels, only the ones used take RAM
+#ifndef SWSERIAL_CHANNELS
+    #if defined(SWSERIALUSE3)
+    #define SWSERIAL_CHANNELS   3
+    #elif defined(SWSERIALUSE2)
+    #define SWSERIAL_CHANNELS   2
+    #else
+    #define SWSERIAL_CHANNELS   1
+    #endif
+#endif
+
+// Buffer lengths (power of 2, 128 max.)
+#ifndef SWSERIAL_RXBUFFER
+#define SWSERIAL_RXBUFFER   32
+#endif
+
+#ifndef SWSERIAL_TXBUFFER
+#define SWSERIAL_TXBUFFER   16
+#endif
+
+typedef struct
+{
+    volatile u8 *txlat;         // TX pin
+    volatile u8 *rxport;        // RX pin
+    volatile u8 *delat;         // RS-485 driver enable pin
+    u8 txmask;
+    u8 rxmask;
+    u8 demask;
+    u8 nbit;                    // ticks per bit, 0 if closed
+    u8 txtick, txbits, txshift;
+    u8 rxtick, rxbits, rxshift;
+    volatile u8 txhead, txtail; // written by the user, the interrupt
+    volatile u8 rxhead, rxtail; // written by the interrupt, the user
+    volatile u8 errors;         // framing errors and overruns
+    u32 baud;
+    u8 txbuf[SWSERIAL_TXBUFFER];
+    u8 rxbuf[SWSERIAL_RXBUFFER];
+} swserial_t;
+
+extern swserial_t SwSerial[SWSERIAL_CHANNELS];
+
+void SwSerial_begin(u8 ch, u32 baudrate, u8 txpin, u8 rxpin);
+void SwSerial_setDirPin(u8 ch, u8 pin);
+void SwSerial_printChar(u8 ch, u8 c);
+void SwSerial_print(u8 ch, const char *s);
+void SwSerial_println(u8 ch, const char *s);
+void SwSerial_printNumber(u8 ch, s32 value, u8 base);
+void SwSerial_printFloat(u8 ch, float number, u8 digits);
+void SwSerial_printf(u8 ch, char *fmt, ...);
+void SwSerial1_printf(char *fmt, ...);
+void SwSerial2_printf(char *fmt, ...);
+void SwSerial3_printf(char *fmt, ...);
+u8 SwSerial_readChar(u8 ch);
+u8 SwSerial_getKey(u8 ch);
+u8 * SwSerial_getString(u8 ch);
+void swserial_interrupt(void);
+
+#define SwSerial_available(ch)      ((u8)(SwSerial[ch].rxhead - SwSerial[ch].rxtail))
+#define SwSerial_flush(ch)          (SwSerial[ch].rxtail = SwSerial[ch].rxhead)
+#define SwSerial_pending(ch)        ((u8)(SwSerial[ch].txhead - SwSerial[ch].txtail))
+#define SwSerial_errors(ch)         (SwSerial[ch].errors)
+
+#define SwSerial1_begin(b, t, r)    SwSerial_begin(SWSERIAL1, b, t, r)
+#define SwSerial1_setDirPin(p)      SwSerial_setDirPin(SWSERIAL1, p)
+#define SwSerial1_write(c)          SwSerial_printChar(SWSERIAL1, c)
+#define SwSerial1_printChar(c)      SwSerial_printChar(SWSERIAL1, c)
+#define SwSerial1_print(s)          SwSerial_print(SWSERIAL1, s)
+#define SwSerial1_println(s)        SwSerial_println(SWSERIAL1, s)
+#define SwSerial1_printNumber(v, b) SwSerial_printNumber(SWSERIAL1, v, b)
+#define SwSerial1_printFloat(n, d)  SwSerial_printFloat(SWSERIAL1, n, d)
+#define SwSerial1_readChar()        SwSerial_readChar(SWSERIAL1)
+#define SwSerial1_getKey()          SwSerial_getKey(SWSERIAL1)
+#define SwSerial1_getString()       SwSerial_getString(SWSERIAL1)
+#define SwSerial1_available()       SwSerial_available(SWSERIAL1)
+#define SwSerial1_flush()           SwSerial_flush(SWSERIAL1)
+
+#define SwSerial2_begin(b, t, r)    SwSerial_begin(SWSERIAL2, b, t, r)
+#define SwSerial2_setDirPin(p)      SwSerial_setDirPin(SWSERIAL2, p)
+#define SwSerial2_write(c)          SwSerial_printChar(SWSERIAL2, c)
+#define SwSerial2_printChar(c)      SwSerial_printChar(SWSERIAL2, c)
+#define SwSerial2_print(s)          SwSerial_print(SWSERIAL2, s)
+#define SwSerial2_println(s)        SwSerial_println(SWSERIAL2, s)
+#define SwSerial2_printNumber(v, b) SwSerial_printNumber(SWSERIAL2, v, b)
+#define SwSerial2_printFloat(n, d)  SwSerial_printFloat(SWSERIAL2, n, d)
+#define SwSerial2_readChar()        SwSerial_readChar(SWSERIAL2)
+#define SwSerial2_getKey()          SwSerial_getKey(SWSERIAL2)
+#define SwSerial2_getString()       SwSerial_getString(SWSERIAL2)
+#define SwSerial2_available()       SwSerial_available(SWSERIAL2)
+#define SwSerial2_flush()           SwSerial_flush(SWSERIAL2)
+
+#define SwSerial3_begin(b, t, r)    SwSerial_begin(SWSERIAL3, b, t, r)
+#define SwSerial3_setDirPin(p)      SwSerial_setDirPin(SWSERIAL3, p)
+#define SwSerial3_write(c)          SwSerial_printChar(SWSERIAL3, c)
+#define SwSerial3_printChar(c)      SwSerial_printChar(SWSERIAL3, c)
+#define SwSerial3_print(s)          SwSerial_print(SWSERIAL3, s)
+#define SwSerial3_println(s)        SwSerial_println(SWSERIAL3, s)
+#define SwSerial3_printNumber(v, b) SwSerial_printNumber(SWSERIAL3, v, b)
+#define SwSerial3_printFloat(n, d)  SwSerial_printFloat(SWSERIAL3, n, d)
+#define SwSerial3_readChar()        SwSerial_readChar(SWSERIAL3)
+#define SwSerial3_getKey()          SwSerial_getKey(SWSERIAL3)
+#define SwSerial3_getString()       SwSerial_getString(SWSERIAL3)
+#define SwSerial3_available()       SwSerial_available(SWSERIAL3)
+#define SwSerial3_flush()           SwSerial_flush(SWSERIAL3)
+
+#endif /* __SWSERIAL_H */
@@ -0,0 +1,226 @@
+/*  --------------------------------------------------------------------
+    FILE:           timebase.c
+    PROJECT:        pinguino
+    PURPOSE:        drift-free monotonic timebase
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG :
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    A 16-bit timer runs free at Fosc/4 (Timer0 on 18F, Timer1 on 16F),
+    it is never reloaded so no cycle is lost. Each overflow adds
+    65536 ticks, split in ms and a remainder (< 1 ms), to the count.
+
+    SDCC and XC8 have no 64-bit type, the count is kept as ms (32 bits,
+    49 days) + ticks, which is the same information as a 48-bit tick
+    counter without the 48-bit conversions.
+
+    The interrupt is the only writer and increments a sequence number.
+    A reader samples the count and the timer and starts again if the
+    sequence number has changed, interrupts are never disabled. If the
+    timer has overflowed and its interrupt has not run yet (reader in
+    another interrupt), the pending flag is taken into account, as long
+    as the interrupt is not late by half a period (5.4 ms at 48 MHz).
+
+    Ticks are converted to ms and us by multiply and shift with
+    constants computed once by timebase_setfreq(). When the frequency
+    changes, the ticks counted so far are converted at the old one and
+    the timer is cleared, the next ones are counted at the new one.
+
+    Define TIMEBASE_READ(), TIMEBASE_PENDING(), TIMEBASE_CLEAR(),
+    TIMEBASE_START() and TIMEBASE_RESET() to test it on a host with a
+    simulated timer.
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+    ------------------------------------------------------------------*/
+
+#ifndef _TIMEBASE_C_
+#define _TIMEBASE_C_
+
+#include <compiler.h>           // compatibility between SDCC and XC8
+#include <typedef.h>            // u8, u32, ...
+
+#ifndef TIMEBASE_READ
+
+#if defined(__16F1459) || defined(__16F1708)
+
+// Timer1 is the only 16-bit timer available on 16F, no latch on TMR1H
+#define TIMEBASE_READ(t)        do { u8 _h;                             \
+                                     do { _h = TMR1H;                   \
+                                          (t).l8 = TMR1L;               \
+                                          (t).h8 = TMR1H;               \
+                                     } while ((t).h8 != _h); } while (0)
+#define TIMEBASE_PENDING()      (PIR1bits.TMR1IF)
+#define TIMEBASE_CLEAR()        (PIR1bits.TMR1IF = 0)
+#define TIMEBASE_RESET()        do { TMR1H = 0; TMR1L = 0;              \
+                                     PIR1bits.TMR1IF = 0; } while (0)
+#define TIMEBASE_START()        do { T1CON = 0b00000000;                \
+                                     T1GCONbits.TMR1GE = 0;             \
+                                     TMR1H = 0; TMR1L = 0;              \
+                                     PIR1bits.TMR1IF = 0;               \
+                                     PIE1bits.TMR1IE = 1;               \
+                                     T1CONbits.TMR1ON = 1; } while (0)
+
+#else
+
+// reading TMR0L latches TMR0H
+#define TIMEBASE_READ(t)        do { (t).l8 = TMR0L; (t).h8 = TMR0H; } while (0)
+#define TIMEBASE_PENDING()      (INTCONbits.TMR0IF)
+#define TIMEBASE_CLEAR()        (INTCONbits.TMR0IF = 0)
+// writing TMR0L loads TMR0H from its buffer
+#define TIMEBASE_RESET()        do { TMR0H = 0; TMR0L = 0;              \
+                                     INTCONbits.TMR0IF = 0; } while (0)
+#define TIMEBASE_START()        do { T0CON = 0b00001000;                \
+                                     TMR0H = 0; TMR0L = 0;              \
+                                     INTCON2bits.TMR0IP = 1;            \
+                                     INTCONbits.TMR0IF  = 0;            \
+                                     INTCONbits.TMR0IE  = 1;            \
+                                     T0CONbits.TMR0ON   = 1; } while (0)
+
+#endif
+
+#endif /* TIMEBASE_READ */
+
+// written by the interrupt only
+volatile u32 _timebase_ms;              // ms at the last overflow
+volatile u16 _timebase_rem;             // + ticks, < _timebase_d
+volatile u8  _timebase_seq;
+
+// constants, see timebase_setfreq()
+u16 _timebase_d;                        // ticks per ms
+u16 _timebase_ovfms;                    // 65536 ticks in ms
+u16 _timebase_ovfrem;                   // + ticks
+u16 _timebase_invh;                     // 2^32 / d, rounded up
+u16 _timebase_invl;
+u32 _timebase_usmul;                    // 2^16 us per tick
+
+/*  --------------------------------------------------------------------
+    timebase_setfreq
+    --------------------------------------------------------------------
+    @param:     freq    timer frequency (Hz), 32 kHz to 16 MHz
+    @descr:     also called when the CPU clock changes, with the timer
+                interrupt disabled
+    ------------------------------------------------------------------*/
+
+void timebase_read(u32 *ms, u16 *ticks);
+
+void timebase_setfreq(u32 freq)
+{
+    u32 inv, ms;
+    u16 ticks = 0, d = _timebase_d;
+
+    // the ticks of the current period were counted at the old rate
+    if (d)
+    {
+        timebase_read(&ms, &ticks);
+        TIMEBASE_RESET();
+        _timebase_ms = ms;
+    }
+
+    _timebase_d = freq / 1000;
+    _timebase_ovfms = 65536UL / _timebase_d;
+    _timebase_ovfrem = 65536UL % _timebase_d;
+
+    inv = 0xFFFFFFFFUL / _timebase_d + 1;
+    _timebase_invh = inv >> 16;
+    _timebase_invl = inv;
+
+    _timebase_usmul = 65536000UL / _timebase_d;
+
+    // < 1 ms at the old rate, < 1 ms at the new one
+    _timebase_rem = d ? (u32)ticks * _timebase_d / d : 0;
+}
+
+/*  --------------------------------------------------------------------
+    timebase_init
+    --------------------------------------------------------------------
+    @param:     freq    timer frequency (Hz), Fosc/4
+    ------------------------------------------------------------------*/
+
+void timebase_init(u32 freq)
+{
+    _timebase_ms = 0;
+    _timebase_rem = 0;
+    _timebase_seq = 0;
+    _timebase_d = 0;
+    timebase_setfreq(freq);
+    TIMEBASE_START();
+}
+
+/*  --------------------------------------------------------------------
+    timebase_interrupt
+    --------------------------------------------------------------------
+    @descr:     called by the interrupt service routine
+    ------------------------------------------------------------------*/
+
+void timebase_interrupt(void)
+{
+    if (TIMEBASE_PENDING())
+    {
+        TIMEBASE_CLEAR();
+        _timebase_seq++;
+        _timebase_ms += _timebase_ovfms;
+        _timebase_rem += _timebase_ovfrem;
+        if (_timebase_rem >= _timebase_d)
+        {
+            _timebase_rem -= _timebase_d;
+            _timebase_ms++;
+        }
+    }
+}
+
+/*  --------------------------------------------------------------------
+    timebase_read
+    --------------------------------------------------------------------
+    @param:     ms      ms since timebase_init()
+                ticks   + ticks, < 1 ms
+    @descr:     never goes backwards
+    ------------------------------------------------------------------*/
+
+void timebase_read(u32 *ms, u16 *ticks)
+{
+    u32 base, n, q;
+    u16 nl;
+    u8 seq, pending;
+    t16 tmr;
+
+    do {
+        seq  = _timebase_seq;
+        base = _timebase_ms;
+        n    = _timebase_rem;
+        TIMEBASE_READ(tmr);
+        pending = TIMEBASE_PENDING();
+    } while (seq != _timebase_seq);
+
+    n += tmr.w;
+
+    // overflowed before it was read, interrupt not served yet
+    if (pending && !(tmr.h8 & 0x80))
+        n += 0x10000UL;
+
+    // q = n / d, exact for n < 2^18 and d < 2^14
+    nl = n;
+    q = (u32)nl * _timebase_invl >> 16;
+    q += (u32)nl * _timebase_invh;
+    q += (n >> 16) * _timebase_invl;
+    q = (q >> 16) + (n >> 16) * _timebase_invh;
+
+    *ms = base + q;
+    *ticks = n - q * _timebase_d;
+}
+
+#define timebase_us(ticks)      ((u16)(((ticks) * _timebase_usmul) >> 16))
+
+#endif /* _TIMEBASE_C_ */
@@ -78,6 +78,7 @@
     } tFloat;                               // Pinguino float format
 
     typedef void (*funcout) (u8);           // type of void funcout(u8)
+    typedef void (*funcwrite) (const u8 *, u16); // type of void funcwrite(const u8 *, u16)
 
 /*	----------------------------------------------------------------------------
     avr-gcc types
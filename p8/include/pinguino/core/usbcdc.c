@@ -320,14 +320,26 @@ void CDCprintFloat(float number, u8 digits)
  **********************************************************************/
 
 #if defined(CDCPRINTF)
+/*
+ * span sink of the formatter, each run of chars (up to PRINTF_SINK_LEN)
+ * is a packet. CDCwrite drops it while the previous packet is still
+ * owned by the SIE, so try again a few times.
+ */
+void CDCprintSpan(const u8 *s, u16 n)
+{
+    u8 retry = 255;
+
+    while (retry-- && deviceState == CONFIGURED && CONTROL_LINE)
+        if (CDCwrite((u8 *)s, n))
+            return;
+}
+
 void CDCprintf(const u8 *fmt, ...)
 {
-    u8 len;
     va_list	args;
 
     va_start(args, fmt);
-    len = psprintf2(CDCTxBuffer, fmt, args);
-    CDCwrite(CDCTxBuffer, len);
+    pprintfw(CDCprintSpan, fmt, args);
     va_end(args);
 }
 #endif
@@ -38,6 +38,12 @@
                                     Updated DS18B20.function() to DS18x20.function()
                                     Completed 18B20 and 18S20 reading
                                     Updated DS18x20Wait() to a non-blocking loop
+    19 Oct 2026                     Removed the bus reset sent between Match ROM
+                                    and the function command (it deselected the device)
+                                    Family code taken from the cached ROM code
+                                    CRC computed with the OneWireCRC8 table
+                                    Added DS18x20ReadAll() : one parallel conversion
+                                    (Skip ROM + Convert T) for all the sensors found
     --------------------------------------------------------------------
     TODO :
     * DS1822 support
@@ -83,7 +89,7 @@
     ---------- GLOBAL VARIABLES
     ------------------------------------------------------------------*/
 
-    u8 DS18X20ROM[MAX_SENSORS_NUM][8];  // table of found ROM codes
+    u8 DS18X20ROM[MAX_SENSORS_NUM+1][8];// found ROM codes (index 1 to gNumROMs)
     u8 gROMCODE[8];                      // ROM Bit
     u8 gSCRATCHPAD[9];                   // Scratchpad
     u8 gLastDiscrep = 0;                // last discrepancy
@@ -92,25 +98,6 @@
     u8 gDowCRC = 0;
     u8 gFamily = 0;
     
-    /*
-    const u8 dscrc_table[] = {
-        0, 94,188,226, 97, 63,221,131,194,156,126, 32,163,253, 31, 65,
-        157,195, 33,127,252,162, 64, 30, 95, 1,227,189, 62, 96,130,220,
-        35,125,159,193, 66, 28,254,160,225,191, 93, 3,128,222, 60, 98,
-        190,224, 2, 92,223,129, 99, 61,124, 34,192,158, 29, 67,161,255,
-        70, 24,250,164, 39,121,155,197,132,218, 56,102,229,187, 89, 7,
-        219,133,103, 57,186,228, 6, 88, 25, 71,165,251,120, 38,196,154,
-        101, 59,217,135, 4, 90,184,230,167,249, 27, 69,198,152,122, 36,
-        248,166, 68, 26,153,199, 37,123, 58,100,134,216, 91, 5,231,185,
-        140,210, 48,110,237,179, 81, 15, 78, 16,242,172, 47,113,147,205,
-        17, 79,173,243,112, 46,204,146,211,141,111, 49,178,236, 14, 80,
-        175,241, 19, 77,206,144,114, 44,109, 51,209,143, 12, 82,176,238,
-        50,108,142,208, 83, 13,239,177,240,174, 76, 18,145,207, 45,115,
-        202,148,118, 40,171,245, 23, 73, 8, 86,180,234,105, 55,213,139,
-        87, 9,235,181, 54,104,138,212,149,203, 41,119,244,170, 72, 22,
-        233,183, 85, 11,136,214, 52,106, 43,117,151,201, 74, 20,246,168,
-        116, 42,200,150, 21, 75,169,247,182,232, 10, 84,215,137,107, 53};
-    */
 
 /*  --------------------------------------------------------------------
     ---------- DS18x20Wait()
@@ -206,13 +193,8 @@
 
         // Talk to a particular device
         else
-        {
             if (!DS18x20MatchRom(bus, index))
                 return false;
-            // Exit if no device is present
-            if (OneWireReset(bus))
-                return false;
-        }
 
         // Send Command
         OneWireWriteByte(bus, CONVERT_T);
@@ -235,6 +217,10 @@
 
     u8 DS18x20ReadMeasure(u8 bus, u8 index, DS18x20_Temperature * t)
     {
+        // The family code is the first byte of the ROM code
+        if (index != SKIPROM && index <= gNumROMs)
+            gFamily = DS18X20ROM[index][0];
+
         #ifdef DS18X20DEBUG
         Serial_printf("Fam. = 0x%X\r\n", gFamily);
         #endif
@@ -279,6 +265,41 @@
         return (DS18x20ReadMeasure(bus, index, t));
     }
 
+/*  --------------------------------------------------------------------
+    ---------- DS18x20ReadAll()
+    --------------------------------------------------------------------
+    * Description:  starts the conversion of all the sensors at once
+                    (Skip ROM + Convert T), waits for the end of the
+                    conversion then reads every sensor found by
+                    DS18x20Find()
+    * Arguments:    bus = pin number where the 1-wire bus is connected.
+                    t = DS18x20DeviceCount() temperatures,
+                    t[0] is sensor #1
+    * Note          a sweep lasts one conversion time (750 ms at 12-bit)
+                    whatever the number of sensors
+    * Returns       number of sensors successfully read
+    ------------------------------------------------------------------*/
+
+    #ifdef DS18x20READALL
+    u8 DS18x20ReadAll(u8 bus, DS18x20_Temperature * t)
+    {
+        u8 i, n = 0;
+
+        // All the sensors convert in parallel
+        if (!DS18x20StartMeasure(bus, SKIPROM))
+            return 0;
+
+        // Wait while the 1-wire bus is busy
+        DS18x20Wait(bus);
+
+        for (i = 1; i <= gNumROMs; i++)
+            if (DS18x20ReadMeasure(bus, i, &t[i - 1]))
+                n++;
+
+        return n;
+    }
+    #endif // DS18x20READALL
+
 /*  --------------------------------------------------------------------
     ---------- DS18x20ReadFahrenheit()
     --------------------------------------------------------------------
@@ -337,13 +358,8 @@
 
         // Talk to a particular device
         else
-        {
             if (!DS18x20MatchRom(bus, index))
                 return false;
-            // Exit if no device is present
-            if (OneWireReset(bus))
-                return false;
-        }
 
         // Send Command
         OneWireWriteByte(bus, cmd);
@@ -861,18 +877,8 @@
 
     void DS18x20CRC(u8 x)
     {
-        u8 i = (x ^ gDowCRC) & 0xff;
-
-        gDowCRC = 0;
-
-        if (i & 0x01) gDowCRC ^= 0x5e;
-        if (i & 0x02) gDowCRC ^= 0xbc;
-        if (i & 0x04) gDowCRC ^= 0x61;
-        if (i & 0x08) gDowCRC ^= 0xc2;
-        if (i & 0x10) gDowCRC ^= 0x9d;
-        if (i & 0x20) gDowCRC ^= 0x23;
-        if (i & 0x40) gDowCRC ^= 0x46;
-        if (i & 0x80) gDowCRC ^= 0x8c;
+        // 1rst method, the table is shared with 1wire.c
+        gDowCRC = OneWireCRC8Update(gDowCRC, x);
     }
 
 #endif /* __DS18x20_C */
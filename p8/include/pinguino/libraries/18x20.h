@@ -69,6 +69,7 @@
     ///-----------------------------------------------------------------
     u8 DS18x20Read(u8, u8, DS18x20_Temperature *);
     u8 DS18x20ReadFahrenheit(u8, u8, DS18x20_Temperature *);
+    u8 DS18x20ReadAll(u8, DS18x20_Temperature *);
     u8 DS18x20ReadMeasure(u8, u8, DS18x20_Temperature *);
     u8 DS18B20ReadMeasure(u8, u8, DS18x20_Temperature *);
     u8 DS18S20ReadMeasure(u8, u8, DS18x20_Temperature *);
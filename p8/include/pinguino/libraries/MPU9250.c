@@ -9,6 +9,7 @@
     * Copyright (C) 2015 Brian Chen - Open source under the MIT License.
     * 2018-01-17 - Régis Blanchot - Adapted to Pinguino
     * 2018-01-17 - Régis Blanchot - Added I2C communication
+    * 2026-10-19 - Added FIFO streaming mode (MPU9250STREAM)
     --------------------------------------------------------------------
     TODO:
     * accuracy improvment
@@ -66,6 +67,21 @@
 #include <spi.c>
 #endif
 
+#if defined(MPU9250STREAM)
+    // the external interrupt wired to the MPU INT pin is given to
+    // MPU9250.stream() as MPU9250INTx, the keyword defines INTxINT
+    // for the whole build (see mpu9250.pdl)
+    #if !defined(INT0INT) && !defined(INT1INT) && !defined(INT2INT) && \
+        !defined(INT3INT) && !defined(INT4INT)
+    #error "MPU9250.stream : select the interrupt with MPU9250INT0 to MPU9250INT4"
+    #endif
+    #if defined(__PIC32MX__)
+    #include <onevent.c>
+    #else
+    #include <interrupt.c>
+    #endif
+#endif
+
 #if defined(MPU9250DEBUGSERIAL)
     #ifndef SERIALPRINTX
     #define SERIALPRINTX
@@ -103,6 +119,16 @@ float gAccBias[3];
 
 s16 gMagDataRaw[3];    
 
+#if defined(MPU9250STREAM)
+MPU9250_stream_t gMPU9250Stream;
+    #if defined(MPU9250SPISWENABLE) || \
+        defined(MPU9250SPI1ENABLE)  || defined(MPU9250SPI2ENABLE)
+    #define MPU9250_STREAM_CTRL (BIT_FIFO_EN | BIT_I2C_MST_EN | BIT_I2C_IF_DIS)
+    #else
+    #define MPU9250_STREAM_CTRL (BIT_FIFO_EN | BIT_I2C_MST_EN)
+    #endif
+#endif
+
 // vector to hold quaternion
 float q[4] = {1.0f, 0.0f, 0.0f, 0.0f};
 // integration interval for both filter schemes
@@ -654,6 +680,228 @@ void MPU9250_read_all(int module)
 }
 */
 
+/*  --------------------------------------------------------------------
+    STREAMING MODE
+    --------------------------------------------------------------------
+    * The on-chip FIFO is filled at the sample rate with accelerometer,
+    * gyroscope and magnetometer data (the AK8963 is read by the I2C
+    * master of the MPU once configured, not at each call).
+    * The MPU INT pin, wired to the external interrupt MPU9250INT,
+    * only counts data-ready events. MPU9250_service() then reads all
+    * the pending FIFO frames in a few burst transfers and converts
+    * them to fixed-point (Q16.16) samples in a lock-free ring buffer.
+    * No floating point operation is done per sample.
+    *
+    * usage:
+    *   MPU9250.init(...);
+    *   MPU9250.stream(SPI1, 0, MPU9250INT1); // 1 kHz / (1 + 0), INT1
+    *   loop: while (MPU9250.available(SPI1))
+    *             MPU9250.readSample(&s);
+    ------------------------------------------------------------------*/
+
+#ifdef MPU9250STREAM
+
+// converts a raw sample to Q16.16 (no float)
+#define MPU9250_q16(raw, scale) ((s32)(raw) * (s32)(scale))
+
+/*  --------------------------------------------------------------------
+    MPU9250_parse
+    * decode len bytes of FIFO frames into the ring buffer
+    * s may be any stream, this function doesn't access the bus
+    * returns the number of frames stored
+    ------------------------------------------------------------------*/
+
+u8 MPU9250_parse(MPU9250_stream_t *s, const u8 *buf, u16 len)
+{
+    MPU9250_sample_t *d;
+    s16 raw;
+    u8 i, next, n = 0;
+
+    for ( ; len >= MPU9250_FRAME; len -= MPU9250_FRAME, buf += MPU9250_FRAME)
+    {
+        next = (s->head + 1) & (MPU9250RINGSIZE - 1);
+        if (next == s->tail)
+        {
+            s->overruns++;              // ring full, sample lost
+            continue;
+        }
+
+        d = &s->ring[s->head];
+        for (i = 0; i < 3; i++)
+        {
+            // accelerometer and gyroscope are big-endian
+            raw = ((s16)buf[i*2] << 8) | buf[i*2+1];
+            d->acc[i] = MPU9250_q16(raw - s->accBias[i], s->accScale);
+            raw = ((s16)buf[6+i*2] << 8) | buf[6+i*2+1];
+            d->gyro[i] = MPU9250_q16(raw, s->gyroScale);
+            // magnetometer is little-endian, ST2.HOFL flags an overflow
+            if (!(buf[18] & 0x08))
+            {
+                raw = ((s16)buf[12+i*2+1] << 8) | buf[12+i*2];
+                s->mag[i] = MPU9250_q16(raw, s->magScale[i]);
+            }
+            d->mag[i] = s->mag[i];
+        }
+
+        s->head = next;                 // publish the sample
+        n++;
+    }
+    return n;
+}
+
+/*  --------------------------------------------------------------------
+    MPU9250_dataReady
+    * called on each rising edge of the MPU INT pin
+    ------------------------------------------------------------------*/
+
+void MPU9250_dataReady()
+{
+    gMPU9250Stream.ready++;
+}
+
+/*  --------------------------------------------------------------------
+    MPU9250_service
+    * read all the frames waiting in the chip FIFO, MPU9250BATCH at a
+    * time, if the INT pin signaled new data
+    * returns the number of new samples
+    ------------------------------------------------------------------*/
+
+u8 MPU9250_service(int module)
+{
+    u8 buffer[MPU9250BATCH * MPU9250_FRAME];
+    u8 n, total = 0;
+    u16 count;
+
+    if (!gMPU9250Stream.ready)
+        return 0;
+    gMPU9250Stream.ready = 0;
+
+    MPU9250_readBytes(module, MPU9250_FIFO_COUNTH, buffer, 2);
+    count = ((u16)(buffer[0] & 0x1F) << 8) | buffer[1];
+
+    // the FIFO overflowed (512 bytes) and frames are no longer aligned
+    if ((MPU9250_readChar(module, MPU9250_INT_STATUS) & BIT_FIFO_OFLOW_INT) ||
+        (count % MPU9250_FRAME))
+    {
+        MPU9250_writeChar(module, MPU9250_USER_CTRL, MPU9250_STREAM_CTRL | BIT_FIFO_RST);
+        gMPU9250Stream.overruns++;
+        return 0;
+    }
+
+    for (count /= MPU9250_FRAME; count; count -= n)
+    {
+        n = (count > MPU9250BATCH) ? MPU9250BATCH : count;
+        MPU9250_readBytes(module, MPU9250_FIFO_R_W, buffer, n * MPU9250_FRAME);
+        total += MPU9250_parse(&gMPU9250Stream, buffer, n * MPU9250_FRAME);
+    }
+    return total;
+}
+
+/*  --------------------------------------------------------------------
+    MPU9250_stream
+    * configure the FIFO and the INT pin once, call after MPU9250_init
+    * divider: sample rate = 1 kHz / (1 + divider)
+    * irq: external interrupt wired to the INT pin, MPU9250INT0 to
+    * MPU9250INT4 (up to MPU9250INT2 on 8-bit)
+    ------------------------------------------------------------------*/
+
+void MPU9250_stream(int module, u8 divider, u8 irq)
+{
+    u8 i, fs;
+
+    MPU9250_writeChar(module, MPU9250_INT_ENABLE, 0x00);
+    MPU9250_writeChar(module, MPU9250_FIFO_EN, 0x00);
+    MPU9250_writeChar(module, MPU9250_SMPLRT_DIV, divider);
+
+    // the I2C master reads the 7 magnetometer bytes (HXL to ST2) at
+    // each sample, reading ST2 unlatches the next measurement
+    MPU9250_writeChar(module, MPU9250_I2C_SLV0_ADDR, AK8963_I2C_ADDR | READ_FLAG);
+    MPU9250_writeChar(module, MPU9250_I2C_SLV0_REG, AK8963_HXL);
+    MPU9250_writeChar(module, MPU9250_I2C_SLV0_CTRL, MPU9250_I2C_SLV0_EN | 7);
+
+    // scales : full-scale / 32768 in Q16.16
+    fs = (MPU9250_readChar(module, MPU9250_ACCEL_CONFIG) & BITS_FS_MASK) >> 3;
+    gMPU9250Stream.accScale = 4 << fs;                  // g
+    fs = (MPU9250_readChar(module, MPU9250_GYRO_CONFIG) & BITS_FS_MASK) >> 3;
+    gMPU9250Stream.gyroScale = 500 << fs;               // dps
+    for (i = 0; i < 3; i++)
+    {
+        // biases and sensitivity adjustments are measured at init
+        gMPU9250Stream.accBias[i] = (s16)(gAccBias[i] * gAccDivider);
+        gMPU9250Stream.magScale[i] = (s32)(gMagDataASA[i] * 65536.0f); // uT
+        gMPU9250Stream.mag[i] = 0;
+    }
+
+    gMPU9250Stream.head = 0;
+    gMPU9250Stream.tail = 0;
+    gMPU9250Stream.ready = 0;
+    gMPU9250Stream.overruns = 0;
+
+    // FIFO : accelerometer, gyroscope and slave 0 (19 bytes per sample)
+    MPU9250_writeChar(module, MPU9250_USER_CTRL, MPU9250_STREAM_CTRL | BIT_FIFO_RST);
+    MPU9250_writeChar(module, MPU9250_FIFO_EN, BIT_FIFO_ACCEL | BIT_FIFO_GYRO | BIT_FIFO_SLV0);
+
+    // INT pin : active high 50us pulse on each new sample
+    MPU9250_writeChar(module, MPU9250_INT_PIN_CFG, BIT_INT_ANYRD_2CLEAR);
+    MPU9250_writeChar(module, MPU9250_INT_ENABLE, BIT_RAW_RDY_EN);
+    switch (irq)
+    {
+        #ifdef INT0INT
+        case 0: OnChangePin0(MPU9250_dataReady, INT_RISING_EDGE); break;
+        #endif
+        #ifdef INT1INT
+        case 1: OnChangePin1(MPU9250_dataReady, INT_RISING_EDGE); break;
+        #endif
+        #ifdef INT2INT
+        case 2: OnChangePin2(MPU9250_dataReady, INT_RISING_EDGE); break;
+        #endif
+        #ifdef INT3INT
+        case 3: OnChangePin3(MPU9250_dataReady, INT_RISING_EDGE); break;
+        #endif
+        #ifdef INT4INT
+        case 4: OnChangePin4(MPU9250_dataReady, INT_RISING_EDGE); break;
+        #endif
+    }
+}
+
+/*  --------------------------------------------------------------------
+    MPU9250_available
+    * service the FIFO then return the number of samples in the ring
+    ------------------------------------------------------------------*/
+
+u8 MPU9250_available(int module)
+{
+    MPU9250_service(module);
+    return (gMPU9250Stream.head - gMPU9250Stream.tail) & (MPU9250RINGSIZE - 1);
+}
+
+/*  --------------------------------------------------------------------
+    MPU9250_readSample
+    * copy the oldest sample to dest
+    * returns 0 if the ring is empty
+    ------------------------------------------------------------------*/
+
+u8 MPU9250_readSample(MPU9250_sample_t *dest)
+{
+    MPU9250_sample_t *src;
+    u8 i;
+
+    if (gMPU9250Stream.tail == gMPU9250Stream.head)
+        return 0;
+
+    src = &gMPU9250Stream.ring[gMPU9250Stream.tail];
+    for (i = 0; i < 3; i++)
+    {
+        dest->acc[i]  = src->acc[i];
+        dest->gyro[i] = src->gyro[i];
+        dest->mag[i]  = src->mag[i];
+    }
+    gMPU9250Stream.tail = (gMPU9250Stream.tail + 1) & (MPU9250RINGSIZE - 1);
+    return 1;
+}
+
+#endif // MPU9250STREAM
+
 void MPU9250_getBiases(int module, float *dest1, float *dest2)
 {  
     u8 data[12];                       // hold accelerometer and gyro x, y, z, data
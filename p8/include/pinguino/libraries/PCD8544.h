@@ -229,6 +229,7 @@ void PCD8544_drawCircle(u8, u8, u8, u8);
 void PCD8544_fillCircle(u8, u8, u8, u8);
 //BITMAP
 void PCD8544_drawBitmap(u8, u8, u8, const u8 *,u8, u8);
+void PCD8544_blit(u8, const u8 *, u16, u16, u8, u8, u8);
 //BASICS
 void drawPixel(u16, u16);
 extern void drawBitmap(u8, const u8 *, u16, u16);
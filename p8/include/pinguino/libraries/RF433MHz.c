@@ -0,0 +1,21 @@
+/*  --------------------------------------------------------------------
+    FILE:           RF433MHz.c
+    PROJECT:        Pinguino
+    PURPOSE:        433MHz Wireless Modules library
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - RF433MHz.init is used by both sides, the receiver
+                   keywords define RF433MHZRECEIVER and select the
+                   receiver, else the transmitter is used
+    ------------------------------------------------------------------*/
+
+#ifndef __RF433MHZ_C
+#define __RF433MHZ_C
+
+#if defined(RF433MHZRECEIVER)
+#include <RF433MHz_Rx.c>
+#else
+#include <RF433MHz_Tx.c>
+#endif
+
+#endif // __RF433MHZ_C
@@ -6,6 +6,9 @@
     --------------------------------------------------------------------
     CHANGELOG:
     2018-01-31 - Régis Blanchot -   first release
+    19 Oct. 2026 - bits sent with the right Manchester waveform
+                 - print functions send one packet with a length and a
+                   CRC (see RF433MHz_Packet.c), RF433MHz_useFEC()
     --------------------------------------------------------------------
     TODO:
     --------------------------------------------------------------------
@@ -27,7 +30,9 @@
 #ifndef __RF433MHZ_TX_C
 #define __RF433MHZ_TX_C
 
+#ifndef RF433MHZTRANSMITTER
 #define RF433MHZTRANSMITTER
+#endif
 
 #if defined(RF433MHZRECEIVER) && defined(RF433MHZTRANSMITTER)
 #error "I CAN'T BE RECEIVER AND TRANSMITTER AT THE SAME TIME"
@@ -49,6 +54,7 @@
 #include <macro.h>
 #include <stdarg.h>
 #include <RF433MHz.h>
+#include <RF433MHz_Packet.c>
 #include <manchester.c>
 
 // Printf
@@ -76,93 +82,101 @@ RF433MHZ_t rf;
     to input noise. A CRO connected to the data line looks like 433.92
     is full of transmissions.
 
-    Any ASK transmission method must first sent a capture signal of 101010........
-    When the receiver has adjusted its AGC to the required level for the
-    transmisssion the actual data transmission can occur.
-
-    We send 14 0's 1010... It takes 1 to 3 10's for the receiver to
-    adjust to the transmit level.
-
-    The receiver waits until we have at least 10 10's and then a start
-    pulse 01. The receiver is then operating correctly and we have
-    locked onto the transmission.
+    We send RF433MHZ_PREAMBLE 1's (LO,HI) so the receiver can adjust its
+    AGC and measure the bit time, then a 0 (HI,LO) as a start bit, the
+    sync byte and the frame. The receiver waits for at least
+    RF433MHZ_LOCK regular transitions before it accepts the start bit.
     ------------------------------------------------------------------*/
 
 void RF433MHz_init(u8 pin, u16 bauds)
 {
     // TX a digital pin as output
     rf.TxPin = pin;
-    pinmode(pin, OUTPUT); 
+    pinmode(pin, OUTPUT);
+    digitalwrite(pin, LOW);
+
+    rf.fec = 0;
+    rf.len = 0;
 
-    // Baud rate is defined as the number of symbols sent or received per second
-    rf.bauds = bauds;
-    
     // Half a bit time in us
     // 1s = 1.000.000 us
     rf.half_bit_interval_us = 500000 / bauds;
 }
 
+// each byte is sent as 2 Hamming code words (twice as long)
+void RF433MHz_useFEC(u8 fec)
+{
+    rf.fec = fec;
+}
+
 void RF433MHz_sendZero(void)
 {
-    Delayus(rf.half_bit_interval_us);
     digitalwrite(rf.TxPin, HIGH);
-
     Delayus(rf.half_bit_interval_us);
     digitalwrite(rf.TxPin, LOW);
+    Delayus(rf.half_bit_interval_us);
 }
 
 void RF433MHz_sendOne(void)
 {
-    Delayus(rf.half_bit_interval_us);
     digitalwrite(rf.TxPin, LOW);
-
     Delayus(rf.half_bit_interval_us);
     digitalwrite(rf.TxPin, HIGH);
+    Delayus(rf.half_bit_interval_us);
 }
 
-// Start sequence
-void RF433MHz_start(void)
+// 8 half bits from the Manchester table, first one in bit 7
+void RF433MHz_sendHalfBits(u8 code)
 {
     u8 i;
-            
-    for(i = 0; i < SYNC_PULSE_DEF; i++) //send capture pulses
-    #if SYNC_BIT_VALUE
-        RF433MHz_sendOne(); //end of capture pulses
-    RF433MHz_sendZero(); //start data pulse
-    #else
-        RF433MHz_sendZero(); //end of capture pulses
-    RF433MHz_sendOne(); //start data pulse
-    #endif
-}
-
-// End sequence
-// Send 3 terminatings 0's to correctly terminate the previous bit
-// and to turn the transmitter off
+
+    for (i = 0; i < 8; i++)
+    {
+        digitalwrite(rf.TxPin, (code & 0x80) ? HIGH : LOW);
+        code <<= 1;
+        Delayus(rf.half_bit_interval_us);
+    }
+}
+
+// MSB first
+void RF433MHz_sendByte(u8 b)
+{
+    RF433MHz_sendHalfBits(Manchester_encodeTable[b >> 4]);
+    RF433MHz_sendHalfBits(Manchester_encodeTable[b & 0x0F]);
+}
+
+// Start a packet
+void RF433MHz_start(void)
+{
+    rf.len = 0;
+}
+
+// Send the packet
+// 2 trailing 1's terminate the last bit, then the transmitter is off
 void RF433MHz_end(void)
 {
-    #if SYNC_BIT_VALUE
-    RF433MHz_sendOne();
+    u8 i, n;
+
+    n = RF433MHz_packetBuild(rf.frame, rf.payload, rf.len, rf.fec);
+
+    for (i = 0; i < RF433MHZ_PREAMBLE; i++)
+        RF433MHz_sendOne();
+    RF433MHz_sendZero();
+    RF433MHz_sendByte(rf.fec ? RF433MHZ_SYNCFEC : RF433MHZ_SYNCBYTE);
+    for (i = 0; i < n; i++)
+        RF433MHz_sendByte(rf.frame[i]);
     RF433MHz_sendOne();
     RF433MHz_sendOne();
-    #else
-    RF433MHz_sendZero();
-    RF433MHz_sendZero();
-    RF433MHz_sendZero();
-    #endif
+
+    digitalwrite(rf.TxPin, LOW);
+    rf.len = 0;
 }
 
+// Add a byte to the packet, dropped if the packet is full
 void RF433MHz_printChar(u8 c)
 {
-    u8 i, encoded[2];
-
-    // A lot of zeroes can result to packet lost, 
-    // therefore we xor the data with random decoupling mask
-    c = c ^ DECOUPLING_MASK;
-    Manchester_encode(c, encoded);
-    for (i = 0; i < 8; i++)
-        (encoded[0] & (1 << i)) ? RF433MHz_sendOne():RF433MHz_sendZero();
-    for (i = 0; i < 8; i++)
-        (encoded[1] & (1 << i)) ? RF433MHz_sendOne():RF433MHz_sendZero();
+    if (rf.len < RF433MHZ_MAXPAYLOAD)
+        rf.payload[rf.len++] = c;
 }
 
 #if defined(RF433MHZWRITECHAR)
@@ -5,6 +5,8 @@
     PROGRAMER:      Regis Blanchot <rblanchot@gmail.com>
     --------------------------------------------------------------------
     31 Jan. 2017    Regis Blanchot - first release
+    19 Oct. 2026    drawing done a byte at a time by raster.c,
+                    added ST7565_blit
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -32,6 +34,7 @@
 #include <stdarg.h>
 #include <string.h>         // memset
 #include <ST7565.h>
+#include <raster.c>         // 1bpp buffer drawing
 #include <spi.h>
 #include <spi.c>
 #include <digitalw.c>       // pinmode, digitalwrite
@@ -62,6 +65,7 @@
     #ifdef ST7565DRAWBITMAP
     #define DRAWBITMAP
     #endif
+    #define GRAPHICSHVLINES
     #include <graphics.c>
 #endif
 
@@ -74,6 +78,15 @@ const u8 pagemap[] = { 3, 2, 1, 0, 7, 6, 5, 4 };
 
 u8 ST7565_buffer[1024];
 
+// Pages in the buffer, as seen by the drawing functions
+// (bit 7 is the top row)
+u8 *ST7565_page[8] = {
+    ST7565_buffer,       ST7565_buffer + 128, ST7565_buffer + 256, ST7565_buffer + 384,
+    ST7565_buffer + 512, ST7565_buffer + 640, ST7565_buffer + 768, ST7565_buffer + 896
+};
+
+raster_t ST7565_raster;
+
 // reduces how much is refreshed, which speeds it up!
 // originally derived from Steve Evans/JCW's mod but cleaned up and
 // optimized
@@ -88,6 +101,13 @@ static void updateBoundingBox(u8 xmin, u8 ymin, u8 xmax, u8 ymax)
     if (ymin < yUpdateMin) yUpdateMin = ymin;
     if (ymax > yUpdateMax) yUpdateMax = ymax;
 }
+
+// same with an area which may be partly out of the screen
+static void updateBoundingRect(s16 x, s16 y, s16 w, s16 h)
+{
+    if (raster_clip(&ST7565_raster, &x, &y, &w, &h))
+        updateBoundingBox(x, y, x + w - 1, y + h - 1);
+}
 #endif
 
 void ST7565_sendCommand(u8 module, u8 val)
@@ -157,7 +177,7 @@ void ST7565_refresh(u8 module)
 // clear everything
 void ST7565_clearScreen(u8 module) 
 {
-    memset(ST7565_buffer, 0, 1024);
+    raster_clear(&ST7565_raster);
     #ifdef enablePartialUpdate
     updateBoundingBox(0, 0, ST7565_WIDTH-1, ST7565_HEIGHT-1);
     #endif
@@ -230,6 +250,8 @@ void ST7565_init(int module, ...)
     ST7565.screen.width  = ST7565_WIDTH;
     ST7565.screen.height = ST7565_HEIGHT;
 
+    raster_init(&ST7565_raster, ST7565_page, ST7565_WIDTH, ST7565_HEIGHT, 1);
+
     // Software reset and minimal init.
     SPI_select(module);
 
@@ -555,11 +577,7 @@ void ST7565_setPixel(u8 module, u8 x, u8 y, u8 color)
     if ((x >= ST7565_WIDTH) || (y >= ST7565_HEIGHT))
         return;
 
-    // x is which column
-    if (color) 
-        ST7565_buffer[x+ (y/8)*128] |= Bit(7-(y%8));  
-    else
-        ST7565_buffer[x+ (y/8)*128] &= ~Bit(7-(y%8)); 
+    raster_setPixel(&ST7565_raster, x, y, color ? RASTER_SET : RASTER_CLEAR);
 
     #ifdef enablePartialUpdate
     updateBoundingBox(x,y,x,y);
@@ -580,10 +598,7 @@ void ST7565_clearPixel(u8 module, u8 x, u8 y)
 // the most basic function, get a single pixel
 u8 ST7565_getPixel(u8 module, u8 x, u8 y) 
 {
-    if ((x >= ST7565_WIDTH) || (y >= ST7565_HEIGHT))
-        return 0;
-
-    return (ST7565_buffer[x+ (y/8)*128] >> (7-(y%8))) & 0x1;  
+    return raster_getPixel(&ST7565_raster, x, y);
 }
 
 /*	--------------------------------------------------------------------
@@ -605,7 +620,39 @@ void setWindow(u8 x0, u8 y0, u8 x1, u8 y1)
 
 void drawPixel(u16 x, u16 y)
 {
-    ST7565_drawPixel(ST7565_SPI, x, y);
+    // checked before the u8 cast, x = 300 would land on x = 44
+    if (x < ST7565_WIDTH && y < ST7565_HEIGHT)
+        ST7565_drawPixel(ST7565_SPI, x, y);
+}
+
+// graphics.c lines leave out their end point (see drawLine), the
+// generic drawHLine and drawVLine draw w - 1 and h - 1 pixels
+void drawHLine(u16 x, u16 y, u16 w)
+{
+    raster_drawHLine(&ST7565_raster, (s16)x, (s16)y, (s16)w - 1, RASTER_SET);
+    #ifdef enablePartialUpdate
+    updateBoundingRect((s16)x, (s16)y, (s16)w - 1, 1);
+    #endif
+}
+
+void drawVLine(u16 x, u16 y, u16 h)
+{
+    raster_drawVLine(&ST7565_raster, (s16)x, (s16)y, (s16)h - 1, RASTER_SET);
+    #ifdef enablePartialUpdate
+    updateBoundingRect((s16)x, (s16)y, 1, (s16)h - 1);
+    #endif
+}
+
+// columns x1 to x2, rows y1 to y2 - 2, like the generic fillRect
+// made of drawVLine(x, y1, y2 - y1)
+void fillRect(u16 x1, u16 y1, u16 x2, u16 y2)
+{
+    if (x1 > x2) swap(x1, x2);
+    if (y1 > y2) swap(y1, y2);
+    raster_fillRect(&ST7565_raster, (s16)x1, (s16)y1, x2 - x1 + 1, (s16)(y2 - y1) - 1, RASTER_SET);
+    #ifdef enablePartialUpdate
+    updateBoundingRect((s16)x1, (s16)y1, x2 - x1 + 1, (s16)(y2 - y1) - 1);
+    #endif
 }
 
 void setColor(u8 r, u8 g, u8 b)
@@ -662,6 +709,16 @@ void ST7565_fillRoundRect(u8 module, u16 x1, u16 y1, u16 x2, u16 y2)
     fillRoundRect(x1, y1, x2, y2);
 }
 
+// Bitmap in the fonts format (one byte per column, bit 0 on top)
+// rop : RASTER_COPY, RASTER_OR, RASTER_AND or RASTER_XOR
+void ST7565_blit(u8 module, const u8 *bitmap, u16 x, u16 y, u8 w, u8 h, u8 rop)
+{
+    raster_blit(&ST7565_raster, (s16)x, (s16)y, bitmap, w, h, rop);
+    #ifdef enablePartialUpdate
+    updateBoundingRect((s16)x, (s16)y, w, h);
+    #endif
+}
+
 #ifdef ST7565DRAWBITMAP
 void ST7565_drawBitmap(u8 module1, u8 module2, const u8* filename, u16 x, u16 y)
 {
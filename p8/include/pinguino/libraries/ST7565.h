@@ -213,6 +213,7 @@ void ST7565_setCursor(u8, u8, u8);
 void ST7565_drawPixel(u8, u8, u8);
 void ST7565_clearPixel(u8, u8, u8);
 void ST7565_drawBitmap(u8, u8, const u8*, u16, u16);
+void ST7565_blit(u8, const u8 *, u16, u16, u8, u8, u8);
 void ST7565_drawCircle(u8, u16, u16, u16);
 void ST7565_fillCircle(u8, u16, u16, u16);
 void ST7565_drawLine(u8, u16, u16, u16, u16);
@@ -37,6 +37,10 @@
     #define __AUDIO_C
     #define __AUDIO__
 
+    #if !defined(__PIC32MX__) && defined(__SWSERIAL__)
+    #error "Audio : Timer2 is already used by SwSerial."
+    #endif
+
     #include <typedef.h>
     #include <pin.h>            // CCPx pin definitions
     #include <audio.h>
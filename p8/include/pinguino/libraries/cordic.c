@@ -0,0 +1,624 @@
+/*  --------------------------------------------------------------------
+    FILE:           cordic.c
+    PROJECT:        pinguino
+    PURPOSE:        CORDIC fixed point trigonometric, hyperbolic,
+                    exponential and logarithm functions
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    Only shifts, additions and a table lookup per iteration, no float
+    and no 64-bit multiply (SDCC doesn't have them).
+
+    Formats :
+    * Q15 : s16, 1.0 = 32768           * Q31 : s32, 1.0 = 2^31
+    * angles are binary angles, the full range of the type is one turn
+      (-pi to pi) : 0x4000 (Q15) or 0x40000000 (Q31) is pi/2, 90 deg.
+      Any angle is valid, it wraps like the type.
+    * exp, ln, sinh and cosh take and return s32 with q fraction bits
+      (q = 15 for Q16.15, q = FIXEDPT_FBITS for fixedptc, 8 to 29).
+
+    The engine works on s32 with 30 fraction bits (Q2.30) :
+    * cordic_rotate / cordic_vector         circular (sin, cos, atan2, hypot)
+    * cordic_rotateh / cordic_vectorh       hyperbolic (exp, ln)
+    Each iteration gives about one more bit :
+    * CORDIC_ITER15 (default 17) iterations for the Q15 functions,
+    * CORDIC_ITER31 (default 30) for the Q31 functions,
+    * CORDIC_ITERH (default 30) for the hyperbolic ones, whatever q is
+      since exp gives up to 31 significant bits.
+    Tables only keep CORDIC_MAXITER entries (rounded up to a multiple
+    of 6), so 8-bit sketches which only use Q15 functions keep 18
+    entries per table instead of 30.
+
+    #define CORDICQ15, CORDICQ31 or CORDICHYPERBOLIC to get the functions
+    (done by the keywords of math.pdl).
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    ------------------------------------------------------------------*/
+
+#ifndef __CORDIC_C
+#define __CORDIC_C
+
+#include <typedef.h>
+
+#ifndef CORDIC_ITER15
+#define CORDIC_ITER15       17
+#endif
+
+#ifndef CORDIC_ITER31
+#define CORDIC_ITER31       30
+#endif
+
+// exp, ln, sinh, cosh
+#ifndef CORDIC_ITERH
+#define CORDIC_ITERH        CORDIC_ITER31
+#endif
+
+#ifndef CORDIC_MAXITER
+    #if defined(CORDICQ31) || defined(CORDICHYPERBOLIC)
+    #define CORDIC_MAXITER  CORDIC_ITER31
+    #else
+    #define CORDIC_MAXITER  CORDIC_ITER15
+    #endif
+#endif
+
+#if CORDIC_MAXITER > 30
+#error "CORDIC_MAXITER must be 30 or less"
+#endif
+
+#define CORDIC_ONE          0x40000000L     // 1.0 in Q2.30
+#define CORDIC_K            652032874L      // 1 / circular gain, Q2.30
+#define CORDIC_KQ31         1304065748L     // 1 / circular gain, Q31
+#define CORDIC_KH           1296540104L     // 1 / hyperbolic gain, Q2.30
+#define CORDIC_LN2          744261118L      // ln(2), Q2.30
+#define CORDIC_LN2Q24       11629080L       // ln(2), Q8.24
+#define CORDIC_INVLN2       1549082005L     // 1 / ln(2) / 2, Q31
+#define CORDIC_PI           0x80000000UL    // binary angle
+
+// atan(2^-i), binary angle (pi = 2^31)
+const u32 cordic_atan[] = {
+    536870912, 316933406, 167458907, 85004756, 42667331, 21354465,
+    10679838, 5340245, 2670163, 1335087, 667544, 333772,
+    #if CORDIC_MAXITER > 12
+    166886, 83443, 41722, 20861, 10430, 5215,
+    #endif
+    #if CORDIC_MAXITER > 18
+    2608, 1304, 652, 326, 163, 81,
+    #endif
+    #if CORDIC_MAXITER > 24
+    41, 20, 10, 5, 3, 1
+    #endif
+};
+
+#if defined(CORDICHYPERBOLIC)
+// atanh(2^-i), Q2.30, i starts at 1
+const u32 cordic_atanh[] = {
+    589812981, 274247419, 134923406, 67196451, 33565361, 16778582,
+    8388779, 4194325, 2097155, 1048576, 524288, 262144,
+    #if CORDIC_MAXITER > 12
+    131072, 65536, 32768, 16384, 8192, 4096,
+    #endif
+    #if CORDIC_MAXITER > 18
+    2048, 1024, 512, 256, 128, 64,
+    #endif
+    #if CORDIC_MAXITER > 24
+    32, 16, 8, 4, 2, 1
+    #endif
+};
+#endif
+
+/*  --------------------------------------------------------------------
+    cordic_mul31
+    --------------------------------------------------------------------
+    @return:    (a * b) >> 31, made of 16-bit products on 8-bit chips
+    ------------------------------------------------------------------*/
+
+s32 cordic_mul31(s32 a, s32 b)
+{
+    #if defined(__PIC32MX__)
+
+    return (s32)(((s64)a * (s64)b) >> 31);
+
+    #else
+
+    u32 ua, ub, hi, mid, lo;
+    u8 neg = 0;
+
+    if (a < 0) { ua = -(u32)a; neg = 1; } else ua = a;
+    if (b < 0) { ub = -(u32)b; neg ^= 1; } else ub = b;
+
+    lo  = (ua & 0xFFFF) * (ub & 0xFFFF);
+    hi  = (ua >> 16) * (ub >> 16);
+    mid = (ua >> 16) * (ub & 0xFFFF);
+    hi += mid >> 16;
+    mid = (mid << 16);
+    lo += mid;
+    if (lo < mid) hi++;
+    mid = (ua & 0xFFFF) * (ub >> 16);
+    hi += mid >> 16;
+    mid = (mid << 16);
+    lo += mid;
+    if (lo < mid) hi++;
+
+    hi = (hi << 1) | (lo >> 31);
+    return neg ? -(s32)hi : (s32)hi;
+
+    #endif
+}
+
+/*  --------------------------------------------------------------------
+    Circular engine
+    --------------------------------------------------------------------
+    cordic_rotate : rotates (x, y) by z (binary angle, -pi/2 to pi/2),
+    the result is multiplied by the gain (1.647), start with
+    x = CORDIC_K to get cos z and sin z.
+    cordic_vector : rotates (x, y) to the x axis (x must be >= 0),
+    returns the angle, x is the magnitude multiplied by the gain.
+    ------------------------------------------------------------------*/
+
+void cordic_rotate(s32 *px, s32 *py, s32 z, u8 n)
+{
+    s32 x = *px, y = *py, t;
+    u32 a = z;
+    u8 i;
+
+    for (i = 0; i < n; i++)
+    {
+        t = x;
+        if ((s32)a >= 0)
+        {
+            x -= y >> i;
+            y += t >> i;
+            a -= cordic_atan[i];
+        }
+        else
+        {
+            x += y >> i;
+            y -= t >> i;
+            a += cordic_atan[i];
+        }
+    }
+
+    *px = x;
+    *py = y;
+}
+
+u32 cordic_vector(s32 *px, s32 *py, u8 n)
+{
+    s32 x = *px, y = *py, t;
+    u32 a = 0;
+    u8 i;
+
+    for (i = 0; i < n; i++)
+    {
+        t = x;
+        if (y < 0)
+        {
+            x -= y >> i;
+            y += t >> i;
+            a -= cordic_atan[i];
+        }
+        else
+        {
+            x += y >> i;
+            y -= t >> i;
+            a += cordic_atan[i];
+        }
+    }
+
+    *px = x;
+    *py = y;
+    return a;
+}
+
+/*  --------------------------------------------------------------------
+    cordic_sincos
+    --------------------------------------------------------------------
+    @descr:     sin and cos of any binary angle, Q2.30
+    ------------------------------------------------------------------*/
+
+void cordic_sincos(u32 angle, s32 *s, s32 *c, u8 n)
+{
+    s32 x = CORDIC_K, y = 0;
+    u8 back = 0;
+
+    // 2nd and 3rd quadrants : sin(a - pi) = -sin(a), same for cos
+    if (((angle >> 30) + 1) & 2)
+    {
+        angle -= CORDIC_PI;
+        back = 1;
+    }
+
+    cordic_rotate(&x, &y, angle, n);
+
+    *s = back ? -y : y;
+    *c = back ? -x : x;
+}
+
+/*  --------------------------------------------------------------------
+    cordic_polar
+    --------------------------------------------------------------------
+    @descr:     angle of (x, y), Q2.29 inputs. Small vectors are first
+                scaled up by 2^k so that all the iterations are useful.
+                x is replaced by the magnitude.2^k (still with the gain)
+    ------------------------------------------------------------------*/
+
+u32 cordic_polar(s32 *x, s32 *y, u8 n, u8 *k)
+{
+    u32 a = 0;
+    s32 m;
+
+    if (*x < 0)
+    {
+        *x = -*x;
+        *y = -*y;
+        a = CORDIC_PI;
+    }
+
+    m = *x | (*y < 0 ? -*y : *y);
+    *k = 0;
+    if (m)
+    {
+        while (m < (1L << 28))
+        {
+            m <<= 1;
+            (*k)++;
+        }
+    }
+    *x <<= *k;
+    *y <<= *k;
+
+    return a + cordic_vector(x, y, n);
+}
+
+/*  --------------------------------------------------------------------
+    Q15 functions
+    ------------------------------------------------------------------*/
+
+#if defined(CORDICQ15)
+
+s16 cordic_q15(s32 v)
+{
+    v = (v + (1L << 14)) >> 15;
+    if (v > 32767)
+        v = 32767;
+    return (s16)v;
+}
+
+void cordic_sincos15(s16 angle, s16 *s, s16 *c)
+{
+    s32 ys, xc;
+
+    cordic_sincos((u32)angle << 16, &ys, &xc, CORDIC_ITER15);
+    *s = cordic_q15(ys);
+    *c = cordic_q15(xc);
+}
+
+s16 cordic_sin15(s16 angle)
+{
+    s16 s, c;
+
+    cordic_sincos15(angle, &s, &c);
+    return s;
+}
+
+s16 cordic_cos15(s16 angle)
+{
+    s16 s, c;
+
+    cordic_sincos15(angle, &s, &c);
+    return c;
+}
+
+// binary angle of (x, y)
+s16 cordic_atan2_15(s16 y, s16 x)
+{
+    s32 vx = (s32)x << 14, vy = (s32)y << 14;
+    u8 k;
+
+    return (s16)((cordic_polar(&vx, &vy, CORDIC_ITER15, &k) + 0x8000UL) >> 16);
+}
+
+// sqrt(x^2 + y^2), up to 1.414 so unsigned
+u16 cordic_hypot15(s16 x, s16 y)
+{
+    s32 vx = (s32)x << 14, vy = (s32)y << 14;
+    u8 k;
+
+    cordic_polar(&vx, &vy, CORDIC_ITER15, &k);
+    k += 14;
+    return (u16)((cordic_mul31(vx, CORDIC_KQ31) + (1L << (k - 1))) >> k);
+}
+
+#endif /* CORDICQ15 */
+
+/*  --------------------------------------------------------------------
+    Q31 functions
+    ------------------------------------------------------------------*/
+
+#if defined(CORDICQ31)
+
+s32 cordic_q31(s32 v)
+{
+    if (v >= CORDIC_ONE)
+        return 0x7FFFFFFFL;
+    if (v < -CORDIC_ONE)
+        return -0x7FFFFFFFL - 1;
+    return v << 1;
+}
+
+void cordic_sincos31(s32 angle, s32 *s, s32 *c)
+{
+    cordic_sincos(angle, s, c, CORDIC_ITER31);
+    *s = cordic_q31(*s);
+    *c = cordic_q31(*c);
+}
+
+s32 cordic_sin31(s32 angle)
+{
+    s32 s, c;
+
+    cordic_sincos31(angle, &s, &c);
+    return s;
+}
+
+s32 cordic_cos31(s32 angle)
+{
+    s32 s, c;
+
+    cordic_sincos31(angle, &s, &c);
+    return c;
+}
+
+s32 cordic_atan2_31(s32 y, s32 x)
+{
+    u8 k;
+
+    // only the direction matters, small vectors keep all their bits
+    if (((x ^ (x >> 31)) | (y ^ (y >> 31))) >= (1L << 29))
+    {
+        y >>= 2;
+        x >>= 2;
+    }
+    return (s32)cordic_polar(&x, &y, CORDIC_ITER31, &k);
+}
+
+u32 cordic_hypot31(s32 x, s32 y)
+{
+    u32 m;
+    u8 k;
+
+    x >>= 2;
+    y >>= 2;
+    cordic_polar(&x, &y, CORDIC_ITER31, &k);
+    m = cordic_mul31(x, CORDIC_KQ31);
+    if (k < 2)
+        return m << (2 - k);
+    k -= 2;
+    return k ? (m + (1UL << (k - 1))) >> k : m;
+}
+
+#endif /* CORDICQ31 */
+
+/*  --------------------------------------------------------------------
+    Hyperbolic functions
+    ------------------------------------------------------------------*/
+
+#if defined(CORDICHYPERBOLIC)
+
+/*  --------------------------------------------------------------------
+    Hyperbolic engine, iterations 4 and 13 are done twice
+    cordic_rotateh : |z| <= 1.118, start with x = CORDIC_KH to get
+    cosh z and sinh z
+    cordic_vectorh : returns atanh(y / x), |y / x| <= 0.8
+    ------------------------------------------------------------------*/
+
+void cordic_rotateh(s32 *px, s32 *py, s32 z, u8 n)
+{
+    s32 x = *px, y = *py, t;
+    u8 i, k = 4;
+
+    for (i = 1; i <= n; i++)
+    {
+        t = x;
+        if (z >= 0)
+        {
+            x += y >> i;
+            y += t >> i;
+            z -= cordic_atanh[i - 1];
+        }
+        else
+        {
+            x -= y >> i;
+            y -= t >> i;
+            z += cordic_atanh[i - 1];
+        }
+
+        if (i == k)
+        {
+            k = 3 * k + 1;
+            i--;
+        }
+    }
+
+    *px = x;
+    *py = y;
+}
+
+s32 cordic_vectorh(s32 *px, s32 *py, u8 n)
+{
+    s32 x = *px, y = *py, t, z = 0;
+    u8 i, k = 4;
+
+    for (i = 1; i <= n; i++)
+    {
+        t = x;
+        if (y < 0)
+        {
+            x += y >> i;
+            y += t >> i;
+            z -= cordic_atanh[i - 1];
+        }
+        else
+        {
+            x -= y >> i;
+            y -= t >> i;
+            z += cordic_atanh[i - 1];
+        }
+
+        if (i == k)
+        {
+            k = 3 * k + 1;
+            i--;
+        }
+    }
+
+    *px = x;
+    *py = y;
+    return z;
+}
+
+/*  --------------------------------------------------------------------
+    cordic_scale
+    --------------------------------------------------------------------
+    @return:    v (Q2.30) * 2^e, with q fraction bits, rounded and
+                saturated
+    ------------------------------------------------------------------*/
+
+s32 cordic_scale(s32 v, s8 e, u8 q)
+{
+    e -= 30 - q;
+
+    if (e >= 0)
+    {
+        if (e > 30 || v > (0x7FFFFFFFL >> e) || v < -(0x7FFFFFFFL >> e))
+            return v < 0 ? -0x7FFFFFFFL : 0x7FFFFFFFL;
+        return v << e;
+    }
+
+    e = -e;
+    if (e > 31)
+        return 0;
+    return (v + (1L << (e - 1))) >> e;
+}
+
+// n.ln(2) with q fraction bits, rounded
+s32 cordic_nln2(s32 n, u8 q)
+{
+    u8 sh = 30 - q;
+
+    return n * (CORDIC_LN2 >> sh) +
+        ((n * (CORDIC_LN2 & ((1L << sh) - 1)) + (1L << (sh - 1))) >> sh);
+}
+
+/*  --------------------------------------------------------------------
+    cordic_exph
+    --------------------------------------------------------------------
+    @descr:     x = n.ln(2) + r, |r| <= ln(2)/2
+                e^x = 2^n.(cosh r + sinh r)
+    @param:     x       q fraction bits
+                c, s    cosh r, sinh r (Q2.30)
+    @return:    n
+    ------------------------------------------------------------------*/
+
+s8 cordic_exph(s32 x, u8 q, s32 *c, s32 *s)
+{
+    s32 n, r;
+    u8 sh = 30 - q;
+
+    // n = round(x / ln2)
+    n = cordic_mul31(x, CORDIC_INVLN2);
+    n = (n + (1L << (q - 2))) >> (q - 1);
+
+    if (n > 31 || n < -31)
+    {
+        // out of range, the result is saturated or 0
+        n = n > 0 ? 31 : -31;
+        r = 0;
+    }
+    else
+    {
+        // r = x - n.ln2 in Q2.30, the ln2 bits beyond q aren't lost
+        r = ((x - n * (CORDIC_LN2 >> sh)) << sh) -
+            n * (CORDIC_LN2 & ((1L << sh) - 1));
+    }
+
+    *c = CORDIC_KH;
+    *s = 0;
+    cordic_rotateh(c, s, r, CORDIC_ITERH);
+    return (s8)n;
+}
+
+s32 cordic_exp(s32 x, u8 q)
+{
+    s32 c, s;
+    s8 n = cordic_exph(x, q, &c, &s);
+
+    return cordic_scale(c + s, n, q);
+}
+
+s32 cordic_sinh(s32 x, u8 q)
+{
+    s32 c, s;
+    s8 n = cordic_exph(x, q, &c, &s);
+
+    // (2^n.(c + s) - 2^-n.(c - s)) / 2
+    return cordic_scale(c + s, n - 1, q) - cordic_scale(c - s, -n - 1, q);
+}
+
+s32 cordic_cosh(s32 x, u8 q)
+{
+    s32 c, s;
+    s8 n = cordic_exph(x, q, &c, &s);
+
+    return cordic_scale(c + s, n - 1, q) + cordic_scale(c - s, -n - 1, q);
+}
+
+/*  --------------------------------------------------------------------
+    cordic_ln
+    --------------------------------------------------------------------
+    @descr:     x = m.2^e, 1 <= m < 2
+                ln(x) = 2.atanh((m - 1) / (m + 1)) + e.ln(2)
+    @param:     x       > 0, q fraction bits
+    @return:    ln(x), q fraction bits, -0x7FFFFFFF if x <= 0
+    ------------------------------------------------------------------*/
+
+s32 cordic_ln(s32 x, u8 q)
+{
+    s32 m, y;
+    s8 e = 30 - q;
+
+    if (x <= 0)
+        return -0x7FFFFFFFL;
+
+    // m in Q2.30
+    while (x < CORDIC_ONE)
+    {
+        x <<= 1;
+        e--;
+    }
+
+    // m + 1 and m - 1 in Q3.29
+    m = (x >> 1) + (CORDIC_ONE >> 1);
+    y = (x >> 1) - (CORDIC_ONE >> 1);
+    y = cordic_vectorh(&m, &y, CORDIC_ITERH);
+
+    return cordic_scale(y, 1, q) + cordic_nln2(e, q);
+}
+
+#endif /* CORDICHYPERBOLIC */
+
+#endif /* __CORDIC_C */
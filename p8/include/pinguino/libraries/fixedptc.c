@@ -71,6 +71,8 @@
  * ---------------------------------------------------------------------
  * CHANGELOG
  * 11-02-2016 - Régis Blanchot - first Pinguino release
+ * 19 Oct. 2026 - fixedpt_sin, fixedpt_cos, fixedpt_exp and fixedpt_ln
+ *                use the CORDIC engine (cordic.c)
  * ---------------------------------------------------------------------
  */
  
@@ -88,6 +90,11 @@
 
 #include <typedef.h>
 
+// sin, cos, exp and ln
+#define CORDICQ31
+#define CORDICHYPERBOLIC
+#include <cordic.c>
+
 typedef u32 fixedpt;
 typedef u64 fixedptd;
 typedef u32 fixedptu;
@@ -250,47 +257,38 @@ fixedpt fixedpt_sqrt(fixedpt A)
 }
 
 
-/* Returns the sine of the given fixedpt number. 
- * Note: the loss of precision is extraordinary! */
+/* Returns the binary angle (pi = 2^31) of the given fixedpt number,
+ * A.2^(31 - FBITS) / pi modulo 2^32 (one turn). 2^31 / pi is split in
+ * an integer part and a Q31 fraction so the reduction is exact. */
+#define FIXEDPT_INVPI_INT   (683565275UL >> FIXEDPT_FBITS)
+#define FIXEDPT_INVPI_FRAC  (((683565275L & FIXEDPT_FMASK) << (31 - FIXEDPT_FBITS)) \
+                            + (1237877413L >> FIXEDPT_FBITS))
+
+u32 fixedpt_bam(fixedpt A)
+{
+    return (u32)A * FIXEDPT_INVPI_INT +
+        (u32)cordic_mul31((s32)A, FIXEDPT_INVPI_FRAC);
+}
+
+
+/* Returns the Q31 sin or cos value v as a rounded fixedpt number */
+fixedpt fixedpt_fromq31(s32 v)
+{
+    return (fixedpt)(((v >> (30 - FIXEDPT_FBITS)) + 1) >> 1);
+}
+
+
+/* Returns the sine of the given fixedpt number. */
 fixedpt fixedpt_sin(fixedpt fp)
 {
-    int sign = 1;
-    fixedpt sqr, result;
-    const fixedpt SK[2] = {
-        fixedpt_rconst(7.61e-03),
-        fixedpt_rconst(1.6605e-01)
-    };
-
-    fp %= 2 * FIXEDPT_PI;
-    if (fp < 0)
-        fp = FIXEDPT_PI * 2 + fp;
-    if ((fp > FIXEDPT_HALF_PI) && (fp <= FIXEDPT_PI)) 
-        fp = FIXEDPT_PI - fp;
-    else if ((fp > FIXEDPT_PI) && (fp <= (FIXEDPT_PI + FIXEDPT_HALF_PI)))
-    {
-        fp = fp - FIXEDPT_PI;
-        sign = -1;
-    }
-    else if (fp > (FIXEDPT_PI + FIXEDPT_HALF_PI))
-    {
-        fp = (FIXEDPT_PI << 1) - fp;
-        sign = -1;
-    }
-    sqr = fixedpt_mul(fp, fp);
-    result = SK[0];
-    result = fixedpt_mul(result, sqr);
-    result -= SK[1];
-    result = fixedpt_mul(result, sqr);
-    result += FIXEDPT_ONE;
-    result = fixedpt_mul(result, fp);
-    return sign * result;
+    return fixedpt_fromq31(cordic_sin31(fixedpt_bam(fp)));
 }
 
 
 /* Returns the cosine of the given fixedpt number */
 fixedpt fixedpt_cos(fixedpt A)
 {
-    return (fixedpt_sin(FIXEDPT_HALF_PI - A));
+    return fixedpt_fromq31(cordic_cos31(fixedpt_bam(A)));
 }
 
 
@@ -301,84 +299,21 @@ fixedpt fixedpt_tan(fixedpt A)
 }
 
 
-/* Returns the value exp(x), i.e. e^x of the given fixedpt number. */
+/* Returns the value exp(x), i.e. e^x of the given fixedpt number,
+ * saturated if it doesn't fit. */
 fixedpt fixedpt_exp(fixedpt fp)
 {
-    fixedpt xabs, k, z, R, xp;
-    const fixedpt LN2 = fixedpt_rconst(0.69314718055994530942);
-    const fixedpt LN2_INV = fixedpt_rconst(1.4426950408889634074);
-    const fixedpt EXP_P[5] = {
-        fixedpt_rconst(1.66666666666666019037e-01),
-        fixedpt_rconst(-2.77777777770155933842e-03),
-        fixedpt_rconst(6.61375632143793436117e-05),
-        fixedpt_rconst(-1.65339022054652515390e-06),
-        fixedpt_rconst(4.13813679705723846039e-08),
-    };
-
-    if (fp == 0)
-        return (FIXEDPT_ONE);
-    xabs = fixedpt_abs(fp);
-    k = fixedpt_mul(xabs, LN2_INV);
-    k += FIXEDPT_ONE_HALF;
-    k &= ~FIXEDPT_FMASK;
-    if (fp < 0)
-        k = -k;
-    fp -= fixedpt_mul(k, LN2);
-    z = fixedpt_mul(fp, fp);
-    /* Taylor */
-    R = FIXEDPT_TWO +
-        fixedpt_mul(z, EXP_P[0] + fixedpt_mul(z, EXP_P[1] +
-        fixedpt_mul(z, EXP_P[2] + fixedpt_mul(z, EXP_P[3] +
-        fixedpt_mul(z, EXP_P[4])))));
-    xp = FIXEDPT_ONE + fixedpt_div(fixedpt_mul(fp, FIXEDPT_TWO), R - fp);
-    if (k < 0)
-        k = FIXEDPT_ONE >> (-k >> FIXEDPT_FBITS);
-    else
-        k = FIXEDPT_ONE << (k >> FIXEDPT_FBITS);
-    return (fixedpt_mul(k, xp));
+    return (fixedpt)cordic_exp((s32)fp, FIXEDPT_FBITS);
 }
 
 
-/* Returns the natural logarithm of the given fixedpt number. */
+/* Returns the natural logarithm of the given fixedpt number,
+ * the most negative number if x <= 0. */
 fixedpt fixedpt_ln(fixedpt x)
 {
-    fixedpt log2, xi;
-    fixedpt f, s, z, w, R;
-    const fixedpt LN2 = fixedpt_rconst(0.69314718055994530942);
-    const fixedpt LG[7] = {
-        fixedpt_rconst(6.666666666666735130e-01),
-        fixedpt_rconst(3.999999999940941908e-01),
-        fixedpt_rconst(2.857142874366239149e-01),
-        fixedpt_rconst(2.222219843214978396e-01),
-        fixedpt_rconst(1.818357216161805012e-01),
-        fixedpt_rconst(1.531383769920937332e-01),
-        fixedpt_rconst(1.479819860511658591e-01)
-    };
-
-    if (x < 0)
-        return (0);
-    if (x == 0)
-        return 0xffffffff;
-
-    log2 = 0;
-    xi = x;
-    while (xi > FIXEDPT_TWO)
-    {
-        xi >>= 1;
-        log2++;
-    }
-    f = xi - FIXEDPT_ONE;
-    s = fixedpt_div(f, FIXEDPT_TWO + f);
-    z = fixedpt_mul(s, s);
-    w = fixedpt_mul(z, z);
-    R = fixedpt_mul(w, LG[1] + fixedpt_mul(w, LG[3]
-        + fixedpt_mul(w, LG[5]))) + fixedpt_mul(z, LG[0]
-        + fixedpt_mul(w, LG[2] + fixedpt_mul(w, LG[4]
-        + fixedpt_mul(w, LG[6]))));
-    return (fixedpt_mul(LN2, (log2 << FIXEDPT_FBITS)) + f
-        - fixedpt_mul(s, f - R));
+    return (fixedpt)cordic_ln((s32)x, FIXEDPT_FBITS);
 }
-    
+
 
 /* Returns the logarithm of the given base of the given fixedpt number */
 fixedpt fixedpt_log(fixedpt x, fixedpt base)
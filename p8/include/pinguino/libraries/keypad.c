@@ -9,9 +9,8 @@
     03 Feb. 2016 - Régis Blanchot - adpated and fixed for 8-bit
     02 Nov. 2016 - Régis Blanchot - fixed the whole lib. according 
                                     https://electrosome.com/matrix-keypad-pic-microcontroller/
-    --------------------------------------------------------------------
-    TODO :
-    * Keypad_isPressed(char keyChar)
+    19 Oct. 2026 - added an interrupt-driven scanner with per-key
+                   debounce and an event queue (KEYPADSCAN)
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -40,6 +39,7 @@
 #include <digitalr.c>
 #endif
 #include <digitalw.c>
+#include <macro.h>
 
 #include <keypad.h>
 #define  __MILLIS__
@@ -191,4 +191,413 @@ char Keypad_getKey()
     return NO_KEY;
 }
 
+/*  --------------------------------------------------------------------
+    ---------- Background scanner
+    --------------------------------------------------------------------
+    #define KEYPADSCAN to scan the matrix from a periodic interrupt
+    instead of polling it with Keypad_getKey() :
+
+        Keypad_init(keys, rows, cols, 4, 4);
+        Keypad_startScan(5);                    // scan period in ms
+        OnTimer2(Keypad_scan, INT_MILLISEC, 5);
+        ...
+        while (Keypad_available())
+        {
+            e = Keypad_getEvent();
+            if (Keypad_eventStatus(e) == PRESSED)
+                key = Keypad_eventKey(e);
+        }
+
+    Each column is pulled low in turn (latch low, TRIS toggled) and
+    every port holding a row is read once per column.
+    Each key keeps a history of its last samples : it is pressed when
+    the last n samples are closed and released when the last n samples
+    are open, with n = debounceTime / period (1 to 8). Keys are handled
+    independently so any number of them can be down at the same time
+    (put a diode in series with each key to avoid ghosting).
+    Press, hold and release events go into a ring buffer read by the
+    main loop. When every key is settled open, all the columns are
+    pulled low together and the rows are read once per tick until a
+    key is touched.
+    The rows need pull-up resistors (RBPU on 8-bit PORTB).
+    ------------------------------------------------------------------*/
+
+#if defined(KEYPADSCAN)
+
+#ifndef KEYPAD_MAXKEYS
+#define KEYPAD_MAXKEYS          16      // rows * columns, 64 max.
+#endif
+#if KEYPAD_MAXKEYS > 64
+#error "KEYPAD_MAXKEYS : an event holds the key index on 6 bits (64 keys max.)"
+#endif
+
+#define KEYPAD_MAXLINES         8       // rows or columns, see readRows
+
+#ifndef KEYPAD_QUEUESIZE
+#define KEYPAD_QUEUESIZE        16      // must be a power of 2
+#endif
+
+#define KEYPAD_DOWN             0x80    // debounced state is closed
+#define KEYPAD_HELD             0x40    // hold event already sent
+
+// event = status (2 bits) | key index (6 bits), 0 if none
+#define KEYPAD_EVENT(s, k)      ((u8)(((s) << 6) | (k)))
+#define Keypad_eventStatus(e)   ((KeypadStatus)((e) >> 6))
+#define Keypad_eventIndex(e)    ((e) & 0x3F)
+#define Keypad_eventKey(e)      (keypad.map[(e) & 0x3F])
+
+#if defined(__PIC32MX__)
+#define KEYPAD_NBPORT           7       // pA .. pG
+#else
+#define KEYPAD_NBPORT           5       // pA .. pE
+#endif
+
+typedef struct
+{
+    u8 history[KEYPAD_MAXKEYS];         // last samples, 1 = closed
+    u8 flags[KEYPAD_MAXKEYS];           // KEYPAD_DOWN | KEYPAD_HELD
+    u8 hold[KEYPAD_MAXKEYS];            // ticks since the key was pressed
+    u8 debounce;                        // mask of the samples to agree
+    u8 holdTicks;                       // ticks before a HOLD event
+    u8 idle;                            // every key is settled open
+    u8 keys;                            // rows * columns, 0 if not started
+    u8 ports;                           // ports holding a row (bit p)
+    u8 rowPort[KEYPAD_MAXLINES];
+    u8 colPort[KEYPAD_MAXLINES];
+    u16 rowMask[KEYPAD_MAXLINES];
+    u16 colMask[KEYPAD_MAXLINES];
+    u16 allMask[KEYPAD_NBPORT];         // all the columns of port p
+    u8 queue[KEYPAD_QUEUESIZE];
+    volatile u8 head;                   // written by Keypad_scan
+    volatile u8 tail;                   // written by Keypad_getEvent
+    u8 lost;                            // events dropped, queue full
+} KeypadScan;
+
+KeypadScan keypadScan;
+
+#define Keypad_available()      (keypadScan.head != keypadScan.tail)
+
+/*  --------------------------------------------------------------------
+    ---------- Debounce / event core
+    --------------------------------------------------------------------
+    Doesn't touch any register and can be tested on a host.
+    ------------------------------------------------------------------*/
+
+void Keypad_push(u8 e)
+{
+    u8 next = (keypadScan.head + 1) & (KEYPAD_QUEUESIZE - 1);
+
+    if (next == keypadScan.tail)
+    {
+        keypadScan.lost++;
+        return;
+    }
+    keypadScan.queue[keypadScan.head] = e;
+    keypadScan.head = next;
+}
+
+/*  --------------------------------------------------------------------
+    ---------- sample
+    --------------------------------------------------------------------
+    Description : shifts a new sample in the history of a key and
+                  queues the resulting events
+    Parameters :  k - key index (column + row * columns)
+                  closed - 1 if the key is closed
+    Returns :     the new history, 0 if the key is settled open
+    ------------------------------------------------------------------*/
+
+u8 Keypad_sample(u8 k, u8 closed)
+{
+    u8 h = (keypadScan.history[k] << 1) | closed;
+    u8 s = h & keypadScan.debounce;
+
+    keypadScan.history[k] = h;
+
+    if (!(keypadScan.flags[k] & KEYPAD_DOWN))
+    {
+        if (s == keypadScan.debounce)
+        {
+            keypadScan.flags[k] = KEYPAD_DOWN;
+            keypadScan.hold[k] = 0;
+            Keypad_push(KEYPAD_EVENT(PRESSED, k));
+        }
+    }
+
+    else if (s == 0)
+    {
+        keypadScan.flags[k] = 0;
+        Keypad_push(KEYPAD_EVENT(RELEASED, k));
+    }
+
+    else if (!(keypadScan.flags[k] & KEYPAD_HELD))
+    {
+        if (++keypadScan.hold[k] >= keypadScan.holdTicks)
+        {
+            keypadScan.flags[k] |= KEYPAD_HELD;
+            Keypad_push(KEYPAD_EVENT(HOLD, k));
+        }
+    }
+
+    return h;
+}
+
+/*  --------------------------------------------------------------------
+    ---------- sampleColumn
+    --------------------------------------------------------------------
+    Parameters :  c - column index
+                  rows - bit r set if the row r is low (key closed)
+    Returns :     non-zero if a key of this column is not settled open
+    ------------------------------------------------------------------*/
+
+u8 Keypad_sampleColumn(u8 c, u8 rows)
+{
+    u8 r, k = c, busy = 0;
+
+    for (r = 0; r < keypad.rows; r++)
+    {
+        busy |= Keypad_sample(k, rows & 1);
+        rows >>= 1;
+        k += keypad.columns;
+    }
+
+    return busy;
+}
+
+/*  --------------------------------------------------------------------
+    ---------- getEvent
+    --------------------------------------------------------------------
+    Description : takes the oldest event out of the queue and updates
+                  the keypad status and last key
+    Returns :     the event or 0 if the queue is empty
+    ------------------------------------------------------------------*/
+
+u8 Keypad_getEvent()
+{
+    u8 e;
+
+    if (!Keypad_available())
+        return 0;
+
+    e = keypadScan.queue[keypadScan.tail];
+    keypadScan.tail = (keypadScan.tail + 1) & (KEYPAD_QUEUESIZE - 1);
+
+    keypad.status = Keypad_eventStatus(e);
+    keypad.lastKey = (keypad.status == RELEASED) ? NO_KEY : Keypad_eventKey(e);
+
+    return e;
+}
+
+/*  --------------------------------------------------------------------
+    ---------- isPressed
+    --------------------------------------------------------------------
+    Returns :     true if the key is (debounced) down
+    ------------------------------------------------------------------*/
+
+u8 Keypad_isPressed(char key)
+{
+    u8 k;
+
+    for (k = 0; k < keypadScan.keys; k++)
+        if (keypad.map[k] == (u8)key)
+            return (keypadScan.flags[k] & KEYPAD_DOWN) != 0;
+
+    return false;
+}
+
+/*  --------------------------------------------------------------------
+    ---------- Port access
+    ------------------------------------------------------------------*/
+
+#if defined(__PIC32MX__)
+
+// TRISx register of each port, shared with portgroup.c
+
+#include <portgroup.c>
+
+#define Keypad_readPort(p)      ((u16)gPortGroupTris[p][PORTGROUP_PORT])
+#define Keypad_drive(p, m)      (gPortGroupTris[p][PORTGROUP_CLR] = (m))
+#define Keypad_release(p, m)    (gPortGroupTris[p][PORTGROUP_SET] = (m))
+#define Keypad_settle()         { nop(); nop(); nop(); nop(); }
+
+#else
+
+u8 Keypad_readPort(u8 p)
+{
+    switch (p)
+    {
+        case pA: return PORTA;
+        case pB: return PORTB;
+        case pC: return PORTC;
+        #if defined(PINGUINO4455)   || defined(PINGUINO4550)   || \
+            defined(PINGUINO45K50)  || defined(PINGUINO46J50)  || \
+            defined(PINGUINO47J53A) || defined(PINGUINO47J53B) || \
+            defined(PICUNO_EQUO)
+        case pD: return PORTD;
+        case pE: return PORTE;
+        #endif
+    }
+    return 0xFF;
+}
+
+// in = 0 pulls the pins low, in = 1 leaves them floating
+
+void Keypad_tris(u8 p, u8 m, u8 in)
+{
+    switch (p)
+    {
+        case pA: if (in) TRISA |= m; else TRISA &= ~m; break;
+        case pB: if (in) TRISB |= m; else TRISB &= ~m; break;
+        case pC: if (in) TRISC |= m; else TRISC &= ~m; break;
+        #if defined(PINGUINO4455)   || defined(PINGUINO4550)   || \
+            defined(PINGUINO45K50)  || defined(PINGUINO46J50)  || \
+            defined(PINGUINO47J53A) || defined(PINGUINO47J53B) || \
+            defined(PICUNO_EQUO)
+        case pD: if (in) TRISD |= m; else TRISD &= ~m; break;
+        case pE: if (in) TRISE |= m; else TRISE &= ~m; break;
+        #endif
+    }
+}
+
+#define Keypad_drive(p, m)      Keypad_tris(p, m, 0)
+#define Keypad_release(p, m)    Keypad_tris(p, m, 1)
+#define Keypad_settle()         nop()
+
+#endif
+
+/*  --------------------------------------------------------------------
+    ---------- readRows
+    --------------------------------------------------------------------
+    Returns :     bit r set if the row r is low
+    ------------------------------------------------------------------*/
+
+u8 Keypad_readRows()
+{
+    u16 snapshot[KEYPAD_NBPORT];
+    u8 p, r, rows = 0;
+
+    Keypad_settle();
+
+    for (p = 0; p < KEYPAD_NBPORT; p++)
+        if (keypadScan.ports & (1 << p))
+            snapshot[p] = Keypad_readPort(p);
+
+    for (r = 0; r < keypad.rows; r++)
+        if (!(snapshot[keypadScan.rowPort[r]] & keypadScan.rowMask[r]))
+            rows |= 1 << r;
+
+    return rows;
+}
+
+/*  --------------------------------------------------------------------
+    ---------- startScan
+    --------------------------------------------------------------------
+    Description : sets the rows as inputs, caches the port and mask of
+                  every pin and converts the debounce and hold times
+                  to scan ticks. Call it after Keypad_init() and the
+                  Keypad_set...Time() macros, before the first tick.
+    Parameters :  period - scan period in ms
+    Returns :     false if the keypad has more than 8 rows or columns
+                  or more than KEYPAD_MAXKEYS keys, it is not scanned
+    ------------------------------------------------------------------*/
+
+u8 Keypad_startScan(u8 period)
+{
+    u8 p;
+    u16 t;
+
+    keypadScan.keys = 0;                // Keypad_scan() does nothing
+
+    if (keypad.rows > KEYPAD_MAXLINES || keypad.columns > KEYPAD_MAXLINES ||
+        keypad.rows * keypad.columns > KEYPAD_MAXKEYS)
+        return false;
+
+    if (period == 0)
+        period = 1;
+
+    // u16 all along, 1000 ms / 1 ms doesn't fit in a u8
+    t = keypad.debounceTime / period;
+    if (t < 1) t = 1;
+    if (t > 8) t = 8;
+    keypadScan.debounce = (u8)((1 << t) - 1);
+
+    t = keypad.holdTime / period;
+    keypadScan.holdTicks = (t > 255) ? 255 : (t < 1) ? 1 : (u8)t;
+
+    keypadScan.ports = 0;
+    for (p = 0; p < KEYPAD_NBPORT; p++)
+        keypadScan.allMask[p] = 0;
+
+    for (p = 0; p < keypad.rows; p++)
+    {
+        pinmode(keypad.rowPins[p], INPUT);
+        keypadScan.rowPort[p] = port[keypad.rowPins[p]];
+        keypadScan.rowMask[p] = mask[keypad.rowPins[p]];
+        keypadScan.ports |= 1 << keypadScan.rowPort[p];
+    }
+
+    for (p = 0; p < keypad.columns; p++)
+    {
+        keypadScan.colPort[p] = port[keypad.columnPins[p]];
+        keypadScan.colMask[p] = mask[keypad.columnPins[p]];
+        keypadScan.allMask[keypadScan.colPort[p]] |= keypadScan.colMask[p];
+    }
+
+    for (p = 0; p < keypad.rows * keypad.columns; p++)
+    {
+        keypadScan.history[p] = 0;
+        keypadScan.flags[p] = 0;
+    }
+
+    keypadScan.head = keypadScan.tail = 0;
+    keypadScan.lost = 0;
+    keypadScan.idle = true;
+    keypadScan.keys = keypad.rows * keypad.columns;
+
+    return true;
+}
+
+/*  --------------------------------------------------------------------
+    ---------- scan
+    --------------------------------------------------------------------
+    Description : one scan tick, to be called periodically (interrupt)
+    ------------------------------------------------------------------*/
+
+void Keypad_scan()
+{
+    u8 c, p, busy = 0;
+
+    if (!keypadScan.keys)
+        return;
+
+    // Nothing moving : one read with all the columns pulled low
+    if (keypadScan.idle)
+    {
+        for (p = 0; p < KEYPAD_NBPORT; p++)
+            if (keypadScan.allMask[p])
+                Keypad_drive(p, keypadScan.allMask[p]);
+
+        busy = Keypad_readRows();
+
+        for (p = 0; p < KEYPAD_NBPORT; p++)
+            if (keypadScan.allMask[p])
+                Keypad_release(p, keypadScan.allMask[p]);
+
+        if (!busy)
+            return;
+    }
+
+    // Full scan, one column at a time
+    busy = 0;
+    for (c = 0; c < keypad.columns; c++)
+    {
+        Keypad_drive(keypadScan.colPort[c], keypadScan.colMask[c]);
+        busy |= Keypad_sampleColumn(c, Keypad_readRows());
+        Keypad_release(keypadScan.colPort[c], keypadScan.colMask[c]);
+    }
+
+    keypadScan.idle = !busy;
+}
+
+#endif // KEYPADSCAN
+
 #endif // _KEYPAD_C_
@@ -10,6 +10,7 @@
     25 Nov. 2016    Regis Blanchot - added multi I2C module support
     28 Nov. 2016    Regis Blanchot - replaced all global variables with LCDI2C struct
     13 Mar. 2017    Regis Blanchot - fixed backlight routine
+    19 Oct. 2026    RAM shadow with background diff refresh (LCDI2CSHADOW)
     --------------------------------------------------------------------
     TODO:
     * Manage other I/O expander (cf MCP23S17 / MCP342x / MCP23017 libraries)
@@ -93,6 +94,11 @@
 #endif
 #include <i2c.c>
 
+// Shadow
+#if defined(LCDI2CSHADOW)
+    #include <lcdshadow.c>
+#endif
+
 // Printf
 #ifdef LCDI2CPRINTF
     #include <printFormated.c>
@@ -257,6 +263,11 @@
     volatile LCDI2C_t LCDI2C[NUMOFI2C];
     volatile u8 gI2C_module;
 
+#if defined(LCDI2CSHADOW)
+    lcdshadow_t gLCDI2CShadow;
+    u8 gLCDI2CShadowModule = 0;         // shadowed module, 0 if none
+#endif
+
 /*  --------------------------------------------------------------------
     Send upper 4 bits of a byte to the PCF8574
     --------------------------------------------------------------------
@@ -357,6 +368,14 @@ void lcdi2c_setCursor(u8 module, u8 col, u8 line)
 {
     const u8 row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
 
+    #if defined(LCDI2CSHADOW)
+    if (module == gLCDI2CShadowModule)
+    {
+        lcdshadow_setCursor(&gLCDI2CShadow, col, line);
+        return;
+    }
+    #endif
+
     if (col > LCDI2C[module].width)
         col = LCDI2C[module].width;  // - 1;           // we count rows starting w/0
 
@@ -390,6 +409,11 @@ void lcdi2c_clearLine(u8 module, u8 line)
 void lcdi2c_printChar(u8 module, u8 c)
 {
     if (c < 32) c = 32;                     // replace ESC char with space
+    #if defined(LCDI2CSHADOW)
+    if (module == gLCDI2CShadowModule)
+        lcdshadow_write(&gLCDI2CShadow, c);
+    else
+    #endif
     lcdi2c_send8(module, c, LCD_DATA);
 }
 #endif
@@ -397,9 +421,87 @@ void lcdi2c_printChar(u8 module, u8 c)
 void lcdi2c_putChar(u8 c)
 {
     if (c < 32) c = 32;                     // replace ESC char with space
+    #if defined(LCDI2CSHADOW)
+    if (gI2C_module == gLCDI2CShadowModule)
+        lcdshadow_write(&gLCDI2CShadow, c);
+    else
+    #endif
     lcdi2c_send8(gI2C_module, c, LCD_DATA);
 }
 
+/*  --------------------------------------------------------------------
+    shadow
+    --------------------------------------------------------------------
+    From now on, the print functions, setCursor, clearScreen, home and
+    clearLine of this module only write into a RAM copy of the display
+    and return immediately. lcdi2c_refresh() sends the changed
+    characters. Call it from loop(), or from a timer interrupt if no
+    other I2C transfer can be interrupted by it.
+    usage :
+        lcdi2c_init(I2C1, 16, 2, ...);
+        lcdi2c_shadow(I2C1);
+    ------------------------------------------------------------------*/
+
+#if defined(LCDI2CSHADOW)
+
+#ifndef LCDI2CSHADOW_BURST
+#define LCDI2CSHADOW_BURST      4       // bytes sent per lcdi2c_refresh()
+#endif
+
+void lcdi2c_shadow(u8 module)
+{
+    lcdshadow_init(&gLCDI2CShadow, LCDI2C[module].width + 1, LCDI2C[module].height + 1);
+    gLCDI2CShadowModule = module;
+}
+
+void lcdi2c_refresh(void)
+{
+    u8 n, op, value;
+
+    if (gLCDI2CShadowModule == 0)
+        return;
+
+    for (n = 0; n < LCDI2CSHADOW_BURST; n++)
+    {
+        op = lcdshadow_step(&gLCDI2CShadow, &value);
+        if (op == LCDSHADOW_NONE)
+            break;
+        lcdi2c_send8(gLCDI2CShadowModule, value, (op == LCDSHADOW_DATA) ? LCD_DATA : LCD_CMD);
+    }
+}
+
+#if defined(LCDI2CCLEAR)
+void lcdi2c_shadowClear(u8 module)
+{
+    if (module == gLCDI2CShadowModule)
+    {
+        lcdshadow_clear(&gLCDI2CShadow);    // only the non-blank cells will be sent
+    }
+    else
+    {
+        lcdi2c_send8(module, LCD_DISPLAY_CLEAR, LCD_CMD);
+        Delayms(2);
+    }
+}
+#endif
+
+#if defined(LCDI2CHOME)
+void lcdi2c_shadowHome(u8 module)
+{
+    if (module == gLCDI2CShadowModule)
+    {
+        lcdshadow_home(&gLCDI2CShadow);
+    }
+    else
+    {
+        lcdi2c_send8(module, LCD_CURSOR_HOME, LCD_CMD);
+        Delayms(2);
+    }
+}
+#endif
+
+#endif
+
 /*  --------------------------------------------------------------------
     print
     ------------------------------------------------------------------*/
@@ -483,13 +585,20 @@ void lcdi2c_printFloat(u8 module, float number, u8 digits)
 
 #if defined(LCDI2CPRINTF)
 
+// span sink of the formatter, one call per run of chars
+void lcdi2c_putSpan(const u8 *s, u16 n)
+{
+    while (n--)
+        lcdi2c_putChar(*s++);
+}
+
 void lcdi2c_printf(u8 module, char *fmt, ...)
 {
     va_list args;
 
     va_start(args, fmt);
     gI2C_module = module;
-    pprintf(lcdi2c_putChar, fmt, args);
+    pprintfw(lcdi2c_putSpan, fmt, args);
     va_end(args);
 }
 
@@ -499,7 +608,7 @@ void lcdi2c1_printf(char* fmt, ...)
 
     va_start(args, fmt);
     gI2C_module = I2C1;
-    pprintf(lcdi2c_putChar, fmt, args);
+    pprintfw(lcdi2c_putSpan, fmt, args);
     //lcdi2c_printf(I2C1, fmt, args)
     va_end(args);
 }
@@ -510,7 +619,7 @@ void lcdi2c2_printf(char* fmt, ...)
 
     va_start(args, fmt);
     gI2C_module = I2C2;
-    pprintf(lcdi2c_putChar, fmt, args);
+    pprintfw(lcdi2c_putSpan, fmt, args);
     //lcdi2c_printf(I2C2, fmt, args)
     va_end(args);
 }
@@ -539,6 +648,12 @@ void lcdi2c_newchar(u8 module, const u8 *c, u8 char_code)
         lcdi2c_send8(module, c[i], LCD_DATA);
         a++;
     };
+
+    // the address counter now points to the CGRAM
+    #if defined(LCDI2CSHADOW)
+    if (module == gLCDI2CShadowModule)
+        lcdshadow_forget(&gLCDI2CShadow);
+    #endif
 }
 #endif
 
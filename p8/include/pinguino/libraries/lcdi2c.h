@@ -265,17 +265,36 @@ void lcdi2c_newchar(u8, const u8 *, u8);
 #define lcdi2c2_noBacklight()          lcdi2c_noBacklight(I2C2)
 #endif
 
+#if defined(LCDI2CSHADOW)
+void lcdi2c_shadow(u8);
+void lcdi2c_refresh(void);
+#define lcdi2c1_shadow()                lcdi2c_shadow(I2C1)
+#define lcdi2c2_shadow()                lcdi2c_shadow(I2C2)
+#endif
+
 #if defined(LCDI2CCLEAR)
+#if defined(LCDI2CSHADOW)
+#define lcdi2c_clearScreen(m)           lcdi2c_shadowClear(m)
+#define lcdi2c1_clearScreen()           lcdi2c_shadowClear(I2C1)
+#define lcdi2c2_clearScreen()           lcdi2c_shadowClear(I2C2)
+#else
 #define lcdi2c_clearScreen(m)           do { lcdi2c_send8(m, LCD_DISPLAY_CLEAR, LCD_CMD); Delayms(2); } while(0)
 #define lcdi2c1_clearScreen()           do { lcdi2c_send8(I2C1, LCD_DISPLAY_CLEAR, LCD_CMD); Delayms(2); } while(0)
 #define lcdi2c2_clearScreen()           do { lcdi2c_send8(I2C2, LCD_DISPLAY_CLEAR, LCD_CMD); Delayms(2); } while(0)
 #endif
+#endif
 
 #if defined(LCDI2CHOME)
+#if defined(LCDI2CSHADOW)
+#define lcdi2c_home(m)                  lcdi2c_shadowHome(m)
+#define lcdi2c1_home()                  lcdi2c_shadowHome(I2C1)
+#define lcdi2c2_home()                  lcdi2c_shadowHome(I2C2)
+#else
 #define lcdi2c_home(m)                  do { lcdi2c_send8(m, LCD_CURSOR_HOME, LCD_CMD); Delayms(2); } while(0)
 #define lcdi2c1_home()                  do { lcdi2c_send8(I2C1, LCD_CURSOR_HOME, LCD_CMD); Delayms(2); } while(0)
 #define lcdi2c2_home()                  do { lcdi2c_send8(I2C2, LCD_CURSOR_HOME, LCD_CMD); Delayms(2); } while(0)
 #endif
+#endif
 
 #if defined(LCDI2CNOAUTOSCROLL)
 #define lcdi2c_noAutoscroll(m)          lcdi2c_send8(m, LCD_ENTRYSHIFTDECREMENT, LCD_CMD)
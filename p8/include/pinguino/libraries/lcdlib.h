@@ -4,6 +4,7 @@
 //#include <stdio.h>
 //#include <stdlib.h>
 #include <typedef.h>
+#include <portgroup.c>          // data bus
 
 // commands
 #define LCD_CLEARDISPLAY 0x01
@@ -44,10 +45,14 @@
 #define LCD_5x8DOTS 0x00
 
 u8 _rs_pin;                         // LOW: command.  HIGH: character.
-//u8 _rw_pin;                       // LOW: write to LCD.  HIGH: read from LCD.
+u8 _rw_pin;                         // LOW: write to LCD.  HIGH: read from LCD.
 u8 _enable_pin;                     // activated by a HIGH pulse.
 u8 _data_pins[8];
 
+u8 _data_grouped;                   // data pins belong to the same port
+PortGroup _data_group;
+u8 _busyflag;                       // poll the busy flag (RW connected)
+
 u8 _displayfunction;
 u8 _displaycontrol;
 u8 _displaymode;
@@ -85,5 +90,8 @@ void _lcd_send(u8 value, u8 mode);
 void _lcd_write8bits(u8 value);
 void _lcd_write4bits(u8 value);
 void _lcd_pulseEnable(void);
+void _lcd_pinRW(u8 rw);
+void _lcd_shadow(u8 cols, u8 rows);
+void _lcd_refresh(void);
 
 #endif /* __LCDLIB_H__ */
@@ -11,6 +11,8 @@
  *    13 Jan. 2016 - Regis Blanchot - added SPI library support
  *    13 Jan. 2016 - Regis Blanchot - added better cascadind devices management (using OP_NOOP)
  *    24 May  2016 - Regis Blanchot - scroll function returns actual position
+ *    19 Oct. 2026 - framebuffer with dirty rows and chained flush (LEDCONTROLBUFFER)
+ *                 - timer-paced pixel scrolling (LEDCONTROLSCROLLTEXT)
  *
  *    Permission is hereby granted, free of charge, to any person
  *    obtaining a copy of this software and associated documentation
@@ -109,6 +111,51 @@ void LedControl_spiTransfer(u8 matrix, u8 opcode, u8 data)
     SPI_deselect(LEDCONTROL_SPI);
 }
 
+/*  --------------------------------------------------------------------
+    Framebuffer
+    --------------------------------------------------------------------
+    With LEDCONTROLBUFFER defined, the drawing functions only update
+    status[] and flag the digit registers (rows) they changed.
+    LedControl_flush() then sends each changed row to all the devices
+    in one chained transaction : 2 bytes per device and per row, where
+    LedControl_spiTransfer() needs 2 bytes per device for each single
+    register write.
+    ------------------------------------------------------------------*/
+
+#if defined(LEDCONTROLBUFFER)
+
+#define LedControl_update(matrix, row)  (gDirtyRows |= 1 << ((row) & 7))
+
+void LedControl_flush()
+{
+    u8 r, m, offset;
+
+    for (r = 0; r < 8; r++)
+    {
+        if (!(gDirtyRows & (1 << r)))
+            continue;
+
+        SPI_select(LEDCONTROL_SPI);
+
+        for (m = 0, offset = r; m <= gLastDevice; m++, offset += 8)
+        {
+            SPI_write(LEDCONTROL_SPI, OP_DIGIT0 + r);
+            SPI_write(LEDCONTROL_SPI, status[offset]);
+        }
+
+        SPI_deselect(LEDCONTROL_SPI);
+    }
+
+    gDirtyRows = 0;
+}
+
+#else
+
+#define LedControl_update(matrix, row)  \
+    LedControl_spiTransfer(matrix, ((row) & 7) + 1, status[((matrix) << 3) + ((row) & 7)])
+
+#endif
+
 /*  --------------------------------------------------------------------
     On initial power-up, all control registers are reset, the
     display is blanked, and the MAX7219/MAX7221 enter shutdown mode
@@ -177,7 +224,8 @@ void LedControl_init(u8 module, ...)
 
     #if defined(LEDCONTROLPRINTCHAR)   || defined(LEDCONTROLPRINT)      || \
         defined(LEDCONTROLPRINTNUMBER) || defined(LEDCONTROLPRINTFLOAT) || \
-        defined(LEDCONTROLPRINTF)      || defined(LEDCONTROLSCROLL)
+        defined(LEDCONTROLPRINTF)      || defined(LEDCONTROLSCROLL)     || \
+        defined(LEDCONTROLSCROLLTEXT)
     LedControl_setFont(font8x8);
     #endif
 }
@@ -230,7 +278,7 @@ void LedControl_clearDisplay(u8 matrix)
     for (i=0; i<8; i++)
     {
         status[offset + i] = 0;
-        LedControl_spiTransfer(matrix, i+1, 0);
+        LedControl_update(matrix, i);
     }
 }
 #endif
@@ -262,7 +310,7 @@ void LedControl_setLed(u8 matrix, u8 row, u8 column, boolean state)
     else
         status[offset] &= ~val;
 
-    LedControl_spiTransfer(matrix, row+1, status[offset]);
+    LedControl_update(matrix, row);
 }
 
 void LedControl_setRow(u8 matrix, u8 row, u8 value)
@@ -285,7 +333,7 @@ void LedControl_setColumn(u8 matrix, u8 col, u8 value)
 
     offset = (matrix << 3) + (col & 7);
     status[offset] = value;
-    LedControl_spiTransfer(matrix, col+1, value);
+    LedControl_update(matrix, col);
 }
 
 #if defined(LEDCONTROLSETDIGIT) || defined(LEDCONTROLSETCHAR)
@@ -304,7 +352,7 @@ void LedControl_setDigit(u8 matrix, u8 digit, u8 value, boolean dp)
     if (dp)
         v |= 0b10000000;
     status[offset+digit] = v;
-    LedControl_spiTransfer(matrix, digit+1, v);
+    LedControl_update(matrix, digit);
     
 }
 #define LedControl_setChar(a,b,c,d) LedControl_setDigit(a,b,c,d)
@@ -312,7 +360,8 @@ void LedControl_setDigit(u8 matrix, u8 digit, u8 value, boolean dp)
 
 #if defined(LEDCONTROLPRINTCHAR)   || defined(LEDCONTROLPRINT)      || \
     defined(LEDCONTROLPRINTNUMBER) || defined(LEDCONTROLPRINTFLOAT) || \
-    defined(LEDCONTROLPRINTF)      || defined(LEDCONTROLSCROLL)
+    defined(LEDCONTROLPRINTF)      || defined(LEDCONTROLSCROLL)     || \
+    defined(LEDCONTROLSCROLLTEXT)
 
 void LedControl_setFont(const u8* font)
 {
@@ -400,7 +449,7 @@ u16 LedControl_scroll(const char * string)
     //u8 len = strlen(str) - 1;       // number of char (from 0)
     u8 len;
     u8 str[64];
-    u16 scrollmax = 8 * max(gLastDevice+1, len+1);
+    u16 scrollmax;
 
     // fill the string with leading spaces, one for each matrix
     for (m = 0; m <= gLastDevice; m++)
@@ -408,6 +457,7 @@ u16 LedControl_scroll(const char * string)
     str[m] = '\0';
     strcat(str, string);
     len = strlen(str) - 1;
+    scrollmax = 8 * max(gLastDevice+1, len+1);
 
     // for every matrix connected
     for (m = 0; m <= gLastDevice; m++)
@@ -444,6 +494,10 @@ u16 LedControl_scroll(const char * string)
         curchar++;
     }
 
+    #if defined(LEDCONTROLBUFFER)
+    LedControl_flush();
+    #endif
+
     //Delayms(5);
     
     // Do we cover the whole scroll area ?
@@ -452,4 +506,85 @@ u16 LedControl_scroll(const char * string)
 }
 #endif
 
+/*  --------------------------------------------------------------------
+    Pixel scrolling
+    --------------------------------------------------------------------
+    Each digit register drives one column of a matrix, so status[]
+    is the whole sign, one byte per column from the left (device 0,
+    digit 0) to the right. Scrolling by one pixel moves the bytes one
+    place to the left and feeds the next column of the text on the
+    right, no glyph has to be rendered again.
+    Pace it with a timer :
+        LedControl_scrollText("Hello world ");
+        OnTimer2(LedControl_scrollStep, INT_MILLISEC, 40);
+    The text is scrolled out of the sign, then starts again.
+    ------------------------------------------------------------------*/
+
+#if defined(LEDCONTROLSCROLLTEXT)
+
+const char *gScrollText;            // text to scroll
+const char *gScrollChar;            // char being fed
+u8 gScrollColumn;                   // next column of this char
+u8 gScrollBlank;                    // blank columns left after the text
+
+void LedControl_scrollText(const char *str)
+{
+    gScrollText   = str;
+    gScrollChar   = str;
+    gScrollColumn = 0;
+    gScrollBlank  = 0;
+}
+
+u8 LedControl_nextColumn()
+{
+    const u8 *glyph;
+    u8 c, b, column = 0;
+
+    if (gScrollBlank)
+    {
+        // text is out of the sign, start again
+        if (--gScrollBlank == 0)
+            gScrollChar = gScrollText;
+        return 0;
+    }
+
+    if (*gScrollChar == '\0')
+    {
+        gScrollBlank = ((gLastDevice + 1) << 3) - 1;
+        return 0;
+    }
+
+    c = *gScrollChar - font_firstchar;
+    if (c >= font_charcount)
+        c = 0;
+    glyph = font_address + FONT_OFFSET + c * 8;
+
+    // one byte per glyph row, bit 0 is the left column
+    for (b = 0; b < 8; b++)
+        if (glyph[b] & (1 << gScrollColumn))
+            column |= 1 << b;
+
+    if (++gScrollColumn >= font_width)
+    {
+        gScrollColumn = 0;
+        gScrollChar++;
+    }
+
+    return column;
+}
+
+void LedControl_scrollStep()
+{
+    u8 x, last = (gLastDevice << 3) + 7;
+
+    for (x = 0; x < last; x++)
+        status[x] = status[x + 1];
+    status[last] = LedControl_nextColumn();
+
+    gDirtyRows = 0xFF;
+    LedControl_flush();
+}
+
+#endif
+
 #endif /* LEDCONTROL_C */
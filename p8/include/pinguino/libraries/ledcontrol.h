@@ -33,6 +33,11 @@
 #ifndef LEDCONTROL_H
 #define LEDCONTROL_H
 
+// pixel scrolling works on the framebuffer
+#if defined(LEDCONTROLSCROLLTEXT) && !defined(LEDCONTROLBUFFER)
+#define LEDCONTROLBUFFER
+#endif
+
 #include <typedef.h>
 #include <stdarg.h>
 
@@ -56,7 +61,8 @@
 
 #if defined(LEDCONTROLPRINTCHAR)   || defined(LEDCONTROLPRINT)      || \
     defined(LEDCONTROLPRINTNUMBER) || defined(LEDCONTROLPRINTFLOAT) || \
-    defined(LEDCONTROLPRINTF)      || defined(LEDCONTROLSCROLL)
+    defined(LEDCONTROLPRINTF)      || defined(LEDCONTROLSCROLL)     || \
+    defined(LEDCONTROLSCROLLTEXT)
     #include <fonts/font8x8.h>
     const u8 *font_address;
     u8 font_width;
@@ -107,6 +113,10 @@ const static u8 charTable[128] = {
 u8 LEDCONTROL_SPI;
 // We keep track of the led-status for all 8 max. devices in this array
 u8 status[64];
+// Rows (digit registers) changed since the last LedControl_flush()
+#if defined(LEDCONTROLBUFFER)
+u8 gDirtyRows = 0;
+#endif
 // The maximum number of devices we use (max. 8)
 u8 gLastDevice;
 // The current active matrix
@@ -265,4 +275,23 @@ void LedControl_printf(const u8 *, ...);
 u16 LedControl_scroll(const char *);
 #endif
 
+/* 
+ * Send the rows changed since the last call to all the devices
+ * (framebuffer mode, LEDCONTROLBUFFER)
+ */
+
+#if defined(LEDCONTROLBUFFER)
+void LedControl_flush();
+#endif
+
+/* 
+ * Scroll a text one pixel at a time, LedControl_scrollStep() is
+ * meant to be called from a timer interrupt
+ */
+
+#if defined(LEDCONTROLSCROLLTEXT)
+void LedControl_scrollText(const char *);
+void LedControl_scrollStep();
+#endif
+
 #endif	//LEDCONTROL_H
@@ -0,0 +1,293 @@
+/*  --------------------------------------------------------------------
+    FILE:           pool.c
+    PROJECT:        pinguino
+    PURPOSE:        Fixed-size block allocator
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    A pool is a statically reserved array of blocks of the same size.
+    Free blocks are chained through their first bytes, so allocating
+    or releasing a block is always O(1) and never fragments memory.
+    Several pools of different block sizes can be registered and
+    used as size classes through pool_malloc() / pool_mfree().
+
+    Usage :
+        POOL_DECLARE(small, 16, 8);     // 8 blocks of 16 bytes
+        POOL_DECLARE(large, 128, 2);    // 2 blocks of 128 bytes
+
+        POOL_INIT(small, 16);
+        POOL_INIT(large, 128);
+        p = pool_malloc(20);            // taken from the 128-byte class
+        pool_mfree(p);
+
+    #define POOLISRSAFE before including this file if blocks are
+    allocated or released from an interrupt routine.
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    ------------------------------------------------------------------*/
+
+#ifndef __POOL_C__
+#define __POOL_C__
+
+#include <typedef.h>
+#include <const.h>              // NULL
+
+#if defined(POOLISRSAFE) && defined(__PIC32MX__)
+#include <mips.h>               // DisableInterrupt(), EnableInterrupt()
+#endif
+
+/*  --------------------------------------------------------------------
+    Critical sections
+    ------------------------------------------------------------------*/
+
+#if defined(POOLISRSAFE)
+    #if defined(__PIC32MX__)
+    #define POOL_LOCK()     u32 pool_status = DisableInterrupt()
+    #define POOL_UNLOCK()   if (pool_status & 1) EnableInterrupt()
+    #else
+    #define POOL_LOCK()     u8 pool_status = INTCONbits.GIE; INTCONbits.GIE = 0
+    #define POOL_UNLOCK()   INTCONbits.GIE = pool_status
+    #endif
+#else
+    #define POOL_LOCK()
+    #define POOL_UNLOCK()
+#endif
+
+/*  --------------------------------------------------------------------
+    Types
+    ------------------------------------------------------------------*/
+
+typedef struct _pool_t pool_t;
+
+struct _pool_t
+{
+    u8 *mem;                    // first block
+    u8 *end;                    // just after the last block
+    void *head;                 // first free block
+    u16 size;                   // block size (bytes)
+    u16 used;                   // blocks in use
+    u16 peak;                   // max. blocks in use
+    u16 fails;                  // failed allocations
+    u16 spills;                 // pool_malloc served by a larger class
+    pool_t *next;               // next (larger) size class
+};
+
+// Block size rounded up to hold (and align) the free-list pointer
+#define POOL_BLOCK(size) \
+    (((size) + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *))
+
+// Static storage and descriptor of a pool
+#define POOL_DECLARE(name, size, count) \
+    void *name##_mem[(count) * POOL_BLOCK(size) / sizeof(void *)]; \
+    pool_t name
+
+#define POOL_INIT(name, size) \
+    pool_init(&name, name##_mem, size, sizeof(name##_mem) / POOL_BLOCK(size))
+
+pool_t *gPoolList = NULL;       // registered size classes, smallest first
+
+/*  --------------------------------------------------------------------
+    pool_init
+    --------------------------------------------------------------------
+    @descr:     chain all the blocks of mem into the free list and
+                register the pool as a size class
+    @param:     p       pool descriptor
+                mem     storage, at least count * POOL_BLOCK(size) bytes
+                size    block size in bytes
+                count   number of blocks
+    ------------------------------------------------------------------*/
+
+void pool_init(pool_t *p, void *mem, u16 size, u16 count)
+{
+    pool_t **link;
+    u8 *block;
+
+    size = POOL_BLOCK(size);
+
+    p->mem   = (u8 *)mem;
+    p->end   = p->mem + (u32)size * count;
+    p->size  = size;
+    p->used  = 0;
+    p->peak  = 0;
+    p->fails = 0;
+    p->spills = 0;
+    p->head  = NULL;
+
+    // chain the blocks backwards so that the first one is used first
+    for (block = p->end; block != p->mem; )
+    {
+        block -= size;
+        *(void **)block = p->head;
+        p->head = block;
+    }
+
+    // (re)insert into the size class list, sorted by block size
+    for (link = &gPoolList; *link; link = &(*link)->next)
+    {
+        if (*link == p)
+        {
+            *link = p->next;
+            break;
+        }
+    }
+    for (link = &gPoolList; *link && (*link)->size < size; link = &(*link)->next);
+    p->next = *link;
+    *link = p;
+}
+
+/*  --------------------------------------------------------------------
+    pool_pop
+    --------------------------------------------------------------------
+    @descr:     unlink the first free block, to be called with the
+                lock held
+    @return:    pointer to the block or NULL if the pool is empty
+    ------------------------------------------------------------------*/
+
+void *pool_pop(pool_t *p)
+{
+    void *block = p->head;
+
+    if (block)
+    {
+        p->head = *(void **)block;
+        if (++p->used > p->peak)
+            p->peak = p->used;
+    }
+    return block;
+}
+
+/*  --------------------------------------------------------------------
+    pool_alloc
+    --------------------------------------------------------------------
+    @descr:     take a block from the pool
+    @param:     p       pool descriptor
+    @return:    pointer to the block or NULL if the pool is empty
+    ------------------------------------------------------------------*/
+
+void *pool_alloc(pool_t *p)
+{
+    void *block;
+    POOL_LOCK();
+
+    block = pool_pop(p);
+    if (!block)
+        p->fails++;
+
+    POOL_UNLOCK();
+    return block;
+}
+
+/*  --------------------------------------------------------------------
+    pool_free
+    --------------------------------------------------------------------
+    @descr:     give a block back to its pool
+    @param:     p       pool descriptor
+                block   pointer returned by pool_alloc (NULL is ignored)
+    ------------------------------------------------------------------*/
+
+void pool_free(pool_t *p, void *block)
+{
+    POOL_LOCK();
+
+    if (block)
+    {
+        *(void **)block = p->head;
+        p->head = block;
+        p->used--;
+    }
+
+    POOL_UNLOCK();
+}
+
+/*  --------------------------------------------------------------------
+    pool_owner
+    --------------------------------------------------------------------
+    @return:    size class the block belongs to, or NULL
+    ------------------------------------------------------------------*/
+
+pool_t *pool_owner(void *block)
+{
+    pool_t *p;
+
+    for (p = gPoolList; p; p = p->next)
+        if ((u8 *)block >= p->mem && (u8 *)block < p->end)
+            return p;
+    return NULL;
+}
+
+/*  --------------------------------------------------------------------
+    pool_malloc
+    --------------------------------------------------------------------
+    @descr:     malloc replacement : take a block from the smallest
+                size class able to hold size bytes, falling back to
+                larger classes when it is exhausted
+                the statistics go to the smallest class able to hold
+                size bytes : spills when a larger class served the
+                request, fails when none could
+    @return:    pointer to the block or NULL
+    ------------------------------------------------------------------*/
+
+void *pool_malloc(u16 size)
+{
+    pool_t *p, *fit = NULL;
+    void *block = NULL;
+    POOL_LOCK();
+
+    for (p = gPoolList; p; p = p->next)
+    {
+        if (p->size < size)
+            continue;
+        if (!fit)
+            fit = p;
+        block = pool_pop(p);
+        if (block)
+            break;
+    }
+
+    if (fit)
+    {
+        if (!block)
+            fit->fails++;
+        else if (p != fit)
+            fit->spills++;
+    }
+
+    POOL_UNLOCK();
+    return block;
+}
+
+/*  --------------------------------------------------------------------
+    pool_mfree
+    --------------------------------------------------------------------
+    @descr:     free replacement for blocks given by pool_malloc
+    ------------------------------------------------------------------*/
+
+void pool_mfree(void *block)
+{
+    pool_t *p = pool_owner(block);
+
+    if (p)
+        pool_free(p, block);
+}
+
+#define pool_available(p)   ((u16)(((p)->end - (p)->mem) / (p)->size) - (p)->used)
+#define pool_used(p)        ((p)->used)
+#define pool_peak(p)        ((p)->peak)
+#define pool_fails(p)       ((p)->fails)
+#define pool_spills(p)      ((p)->spills)
+
+#endif /* __POOL_C__ */
@@ -0,0 +1,404 @@
+/*  --------------------------------------------------------------------
+    FILE:           raster.c
+    PROJECT:        pinguino
+    PURPOSE:        1bpp page organised raster engine for monochrome
+                    displays (SSD1306, PCD8544, ST7565, ...)
+    PROGRAMER:      Pinguino team
+    --------------------------------------------------------------------
+    CHANGELOG:
+    19 Oct. 2026 - first release
+    --------------------------------------------------------------------
+    The display buffer is split in pages of 8 rows, one byte per column
+    and per page, as it is sent to the controller. The buffer of each
+    page is given by a table of pointers so that the driver can keep
+    one array per page (PIC18F RAM banks) or one flat array.
+    Bit 0 of a byte is the top row of the page, or bit 7 when the
+    raster is created with msb = 1 (ST7565).
+
+    Shapes are drawn a whole byte at a time : a rectangle is, for each
+    page it crosses, one mask of the rows it covers applied to each of
+    its columns, instead of one read-modify-write per pixel.
+
+    Bitmaps use the same layout as the fonts and the logos (one byte
+    per column, bit 0 on top, a page after the other) and are blitted
+    at any y with a shift and a mask per byte, with a raster operation
+    (COPY, OR, AND, XOR).
+
+    Everything is clipped to a window (the whole screen by default),
+    coordinates can be negative or out of the screen.
+
+    Doesn't touch any register and can be tested on a host, the driver
+    only has to send the pages to the display (refresh).
+    --------------------------------------------------------------------
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+    ------------------------------------------------------------------*/
+
+#ifndef __RASTER_C
+#define __RASTER_C
+
+#include <typedef.h>
+#include <string.h>             // memset, memcpy
+
+// raster operations (bitmaps)
+#define RASTER_COPY             0
+#define RASTER_OR               1
+#define RASTER_AND              2
+#define RASTER_XOR              3
+
+// colors (shapes)
+#define RASTER_CLEAR            0
+#define RASTER_SET              1
+#define RASTER_INVERT           2
+
+typedef struct
+{
+    u8 **page;                  // buffer of each page
+    u8 width;
+    u8 height;
+    u8 pages;
+    u8 msb;                     // bit 7 is the top row
+    u8 x0, y0, x1, y1;          // clipping window, x1 and y1 excluded
+} raster_t;
+
+// bits order reversed (msb rasters)
+static const u8 raster_nibble[16] = {
+    0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+    0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+};
+
+#define raster_reverse(b)       ((raster_nibble[(b) & 0x0F] << 4) | raster_nibble[(b) >> 4])
+
+/*  --------------------------------------------------------------------
+    raster_init
+    --------------------------------------------------------------------
+    @param:     page    table of (height + 7) / 8 page buffers of
+                        width bytes each
+    ------------------------------------------------------------------*/
+
+void raster_init(raster_t *r, u8 **page, u8 width, u8 height, u8 msb)
+{
+    r->page = page;
+    r->width = width;
+    r->height = height;
+    r->pages = (height + 7) >> 3;
+    r->msb = msb;
+    r->x0 = 0;
+    r->y0 = 0;
+    r->x1 = width;
+    r->y1 = height;
+}
+
+/*  --------------------------------------------------------------------
+    raster_setClip
+    --------------------------------------------------------------------
+    @descr:     nothing is drawn out of the w x h window at x,y,
+                w = 0 restores the whole screen
+    ------------------------------------------------------------------*/
+
+void raster_setClip(raster_t *r, s16 x, s16 y, s16 w, s16 h)
+{
+    if (w == 0)
+    {
+        x = 0;
+        y = 0;
+        w = r->width;
+        h = r->height;
+    }
+
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (w < 0) w = 0;
+    if (h < 0) h = 0;
+    if (x + w > r->width)  w = r->width - x;
+    if (y + h > r->height) h = r->height - y;
+
+    r->x0 = x;
+    r->y0 = y;
+    r->x1 = (w > 0) ? x + w : x;
+    r->y1 = (h > 0) ? y + h : y;
+}
+
+/*  --------------------------------------------------------------------
+    raster_clip
+    --------------------------------------------------------------------
+    @descr:     reduces x,y,w,h to the clipping window
+    @return:    0 if nothing left to draw
+    ------------------------------------------------------------------*/
+
+static u8 raster_clip(raster_t *r, s16 *x, s16 *y, s16 *w, s16 *h)
+{
+    s16 e;
+
+    if (*x < r->x0) { *w -= r->x0 - *x; *x = r->x0; }
+    if (*y < r->y0) { *h -= r->y0 - *y; *y = r->y0; }
+
+    e = *x + *w;
+    if (e > r->x1) *w -= e - r->x1;
+    e = *y + *h;
+    if (e > r->y1) *h -= e - r->y1;
+
+    return (*w > 0 && *h > 0);
+}
+
+/*  --------------------------------------------------------------------
+    raster_mask
+    --------------------------------------------------------------------
+    @return:    bits of the rows first to last (0-7) of a page
+    ------------------------------------------------------------------*/
+
+static u8 raster_mask(raster_t *r, u8 first, u8 last)
+{
+    if (r->msb)
+        return (0xFF >> first) & (0xFF << (7 - last));
+    return (0xFF << first) & (0xFF >> (7 - last));
+}
+
+/*  --------------------------------------------------------------------
+    raster_clear
+    --------------------------------------------------------------------
+    @descr:     clears the whole buffer, whatever the clipping window
+    ------------------------------------------------------------------*/
+
+void raster_clear(raster_t *r)
+{
+    u8 p;
+    #ifdef __SDCC
+    u8 x;
+    #endif
+
+    for (p = 0; p < r->pages; p++)
+    {
+        #ifdef __SDCC
+        for (x = 0; x < r->width; x++)
+            r->page[p][x] = 0;
+        #else
+        memset(r->page[p], 0, r->width);
+        #endif
+    }
+}
+
+/*  --------------------------------------------------------------------
+    raster_fillRect
+    --------------------------------------------------------------------
+    @param:     color   RASTER_CLEAR, RASTER_SET or RASTER_INVERT
+    ------------------------------------------------------------------*/
+
+void raster_fillRect(raster_t *r, s16 x, s16 y, s16 w, s16 h, u8 color)
+{
+    u8 p, last, m, c, n;
+    u8 *d;
+
+    if (!raster_clip(r, &x, &y, &w, &h))
+        return;
+
+    n = w;
+    last = (y + h - 1) >> 3;
+
+    for (p = y >> 3; p <= last; p++)
+    {
+        m = raster_mask(r, (p == (y >> 3)) ? (y & 7) : 0,
+                           (p == last) ? ((y + h - 1) & 7) : 7);
+        d = r->page[p] + x;
+
+        switch (color)
+        {
+            case RASTER_CLEAR:
+                m = ~m;
+                #ifndef __SDCC
+                if (m == 0)
+                {
+                    memset(d, 0, n);
+                    break;
+                }
+                #endif
+                for (c = 0; c < n; c++)
+                    d[c] &= m;
+                break;
+
+            case RASTER_SET:
+                #ifndef __SDCC
+                if (m == 0xFF)
+                {
+                    memset(d, 0xFF, n);
+                    break;
+                }
+                #endif
+                for (c = 0; c < n; c++)
+                    d[c] |= m;
+                break;
+
+            default:
+                for (c = 0; c < n; c++)
+                    d[c] ^= m;
+                break;
+        }
+    }
+}
+
+void raster_drawHLine(raster_t *r, s16 x, s16 y, s16 w, u8 color)
+{
+    raster_fillRect(r, x, y, w, 1, color);
+}
+
+void raster_drawVLine(raster_t *r, s16 x, s16 y, s16 h, u8 color)
+{
+    raster_fillRect(r, x, y, 1, h, color);
+}
+
+void raster_setPixel(raster_t *r, s16 x, s16 y, u8 color)
+{
+    u8 m;
+
+    if (x < r->x0 || x >= r->x1 || y < r->y0 || y >= r->y1)
+        return;
+
+    m = r->msb ? (0x80 >> (y & 7)) : (1 << (y & 7));
+
+    if (color == RASTER_SET)
+        r->page[y >> 3][x] |= m;
+    else if (color == RASTER_CLEAR)
+        r->page[y >> 3][x] &= ~m;
+    else
+        r->page[y >> 3][x] ^= m;
+}
+
+u8 raster_getPixel(raster_t *r, s16 x, s16 y)
+{
+    u8 m;
+
+    if (x < 0 || x >= r->width || y < 0 || y >= r->height)
+        return 0;
+
+    m = r->msb ? (0x80 >> (y & 7)) : (1 << (y & 7));
+    return (r->page[y >> 3][x] & m) ? 1 : 0;
+}
+
+/*  --------------------------------------------------------------------
+    raster_blit
+    --------------------------------------------------------------------
+    @descr:     draws a w x h bitmap at x,y
+    @param:     bitmap  (h + 7) / 8 pages of w bytes, bit 0 on top
+                rop     RASTER_COPY, RASTER_OR, RASTER_AND or RASTER_XOR
+    ------------------------------------------------------------------*/
+
+void raster_blit(raster_t *r, s16 x, s16 y, const u8 *bitmap, u8 w, u8 h, u8 rop)
+{
+    s16 cx = x, cy = y, cw = w, ch = h;
+    s16 sy;
+    u8 p, last, m, c, n, s, b, sp;
+    const u8 *lo, *hi;
+    u8 *d;
+
+    if (!raster_clip(r, &cx, &cy, &cw, &ch))
+        return;
+
+    n = cw;
+    sp = (h + 7) >> 3;
+    last = (cy + ch - 1) >> 3;
+
+    for (p = cy >> 3; p <= last; p++)
+    {
+        m = raster_mask(r, (p == (cy >> 3)) ? (cy & 7) : 0,
+                           (p == last) ? ((cy + ch - 1) & 7) : 7);
+        d = r->page[p] + cx;
+
+        // bitmap rows sy to sy + 7 land on this page, they come from
+        // the low part of one bitmap page and the high part of the next
+        sy = (s16)(p << 3) - y;
+        s = sy & 7;
+        sy = (sy - s) >> 3;
+        lo = (sy >= 0 && sy < sp) ? bitmap + sy * w + (cx - x) : NULL;
+        hi = (s && sy + 1 >= 0 && sy + 1 < sp) ? bitmap + (sy + 1) * w + (cx - x) : NULL;
+
+        for (c = 0; c < n; c++)
+        {
+            b = 0;
+            if (lo) b  = lo[c] >> s;
+            if (hi) b |= hi[c] << (8 - s);
+            if (r->msb)
+                b = raster_reverse(b);
+
+            switch (rop)
+            {
+                case RASTER_COPY: d[c] = (d[c] & ~m) | (b & m); break;
+                case RASTER_OR:   d[c] |= b & m;                break;
+                case RASTER_AND:  d[c] &= b | ~m;               break;
+                default:          d[c] ^= b & m;                break;
+            }
+        }
+    }
+}
+
+/*  --------------------------------------------------------------------
+    raster_scroll
+    --------------------------------------------------------------------
+    @descr:     moves the whole screen dy rows up (dy > 0) or down
+                (dy < 0), the rows uncovered are cleared. Pages are
+                just copied when dy is a multiple of 8.
+    ------------------------------------------------------------------*/
+
+void raster_scroll(raster_t *r, s16 dy)
+{
+    s16 k;
+    u8 p, i, s, c;
+    u8 *d, *lo, *hi;
+
+    if (dy == 0)
+        return;
+
+    if (dy >= (s16)r->height || -dy >= (s16)r->height)
+    {
+        raster_clear(r);
+        return;
+    }
+
+    s = dy & 7;
+
+    // up : pages are rewritten from the top, down : from the bottom,
+    // so that a source page is always read before it's overwritten
+    for (i = 0; i < r->pages; i++)
+    {
+        p = (dy > 0) ? i : r->pages - 1 - i;
+        d = r->page[p];
+
+        k = ((s16)(p << 3) + dy - s) >> 3;
+        lo = (k >= 0 && k < r->pages) ? r->page[k] : NULL;
+        hi = (s && k + 1 >= 0 && k + 1 < r->pages) ? r->page[k + 1] : NULL;
+
+        if (s == 0)
+        {
+            #ifdef __SDCC
+            for (c = 0; c < r->width; c++)
+                d[c] = lo ? lo[c] : 0;
+            #else
+            if (lo)
+                memcpy(d, lo, r->width);
+            else
+                memset(d, 0, r->width);
+            #endif
+            continue;
+        }
+
+        for (c = 0; c < r->width; c++)
+        {
+            if (r->msb)
+                d[c] = (lo ? lo[c] << s : 0) | (hi ? hi[c] >> (8 - s) : 0);
+            else
+                d[c] = (lo ? lo[c] >> s : 0) | (hi ? hi[c] << (8 - s) : 0);
+        }
+    }
+}
+
+#endif /* __RASTER_C */
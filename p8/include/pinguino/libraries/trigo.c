@@ -11,6 +11,8 @@
     Apr 07 2012 - initial release, sin and cos
     Feb 08 2013 - added some comments for better understanding
     Mar 18 2014 - added fast and accurate float sine/cosine
+    19 Oct. 2026 - sine, sinr, cosr, sin100 and cos100 use the CORDIC
+                   engine (cordic.c), any angle, same precision everywhere
     --------------------------------------------------------------------
     This library is free software; you can redistribute it and/or
     modify it under the terms of the GNU Lesser General Public
@@ -36,30 +38,37 @@
 //#include <math.h>
 
 /*  --------------------------------------------------------------------
-    First 90 values (1/4's of the circle) of precomputed sinus table * 256
-    To obtain the other 3/4's of the circle, we use the symmetry of sine wave.
-    Each quadrant is obtained as follows:
-      0 <= x < 90      y =  sine[ x ];
-     90 <= x < 180     y =  sine[ 180 - x ];
-    180 <= x < 270     y = -sine[ x - 180 ];
-    270 <= x < 360     y = -sine[ 360 - x ];
+    Angles in degree are turned into binary angles (the full range of
+    the type is one turn) so the quadrant folding is done by cordic.c.
     ------------------------------------------------------------------*/
 
-#define _abs(x)     ((x)>0?(x):-(x));
+// degrees (0 to 359) to a 32-bit binary angle, d * 11930464.711
+#define TRIGO_BAM32(d)      ((u32)(d) * 11930464UL + (((u32)(d) * 182) >> 8))
 
-// http://devmaster.net/posts/9648/fast-and-accurate-sine-cosine
+// sinr and cosr need the float precision, sin100 and cos100 don't
 #if defined(SINR) || defined(COSR)
+#define CORDICQ31
+#endif
+#if defined(SIN100) || defined(COS100)
+#define CORDICQ15
+#endif
+
+#include <cordic.c>
+
+#if defined(SINR) || defined(COSR)
+/*  --------------------------------------------------------------------
+    sine of an angle in degree, any angle, error below 1e-7
+    ------------------------------------------------------------------*/
+
 float sine(int i)
 {
-    float x =  0.01745329 * (float)i;   // degree to rad
-    float B =  1.27323954;              // 4/pi;
-    float C = -0.40528473;              //-4/(pi*pi);
-    float y = B * x + C * x * _abs(x);
-    #ifdef TRIGO_EXTRA_PRECISION
-    float P = 0.225;
-    y = P * (y * _abs(y) - y) + y;
-    #endif
-    return y;
+    // normalize the angle
+    if (i < 0)
+        i = 360 - ((-i) % 360);
+    else
+        i %= 360;
+
+    return (float)cordic_sin31((s32)TRIGO_BAM32(i)) / 2147483648.0;
 }
 #endif
 
@@ -72,30 +81,7 @@ float sine(int i)
 #if defined(SINR) || defined(COSR)
 float sinr(int alpha)
 {
-    u8 sign = 0; // positive
-
-    // normalize the angle
-    if (alpha < 0)
-        alpha = 360 - ((-alpha) % 360);
-    else
-        alpha %= 360;
-
-    // sin(a+180) = - sin(a)
-    if (alpha >= 180)
-    {
-        alpha -= 180;
-        sign = 1; // negative 
-    }
-
-    // now a < 180
-    // sin(180-a) == sin(a);
-    if (alpha > 90)
-        alpha = 180 - alpha;
-
-    if (sign)
-        return -sine(alpha);
-    else
-        return  sine(alpha);
+    return sine(alpha);
 }
 #endif
 
@@ -109,45 +95,31 @@ float sinr(int alpha)
 #ifdef COSR
 float cosr(int alpha)
 {
-    return sinr(alpha + 90);
+    // alpha + 90 could overflow
+    return sine((alpha % 360) + 90);
 }
 #endif
 
 /*  --------------------------------------------------------------------
-    Return approximation of cos(i) where i is angle in integer degrees 0-359.
-    Returned value is in range -100 to 100 corresponding to -1.0 to 1.0.
+    Return cos(i) where i is angle in integer degrees 0-359.
+    Returned value is in range -100 to 100 corresponding to -1.0 to 1.0,
+    rounded to the nearest integer.
     ------------------------------------------------------------------*/
 
 #if defined(COS100) || defined(SIN100)
 s8 cos100(u16 alpha)
 {
-    s8 sign = 1;
-
-    // input is 0-359 but curve is fit to 0-90
-    // so perform quadrant conversion
-
-    if (alpha > 270)
-    {
-        alpha = 360 - alpha;
-    }
-    else if (alpha > 180)
-    {
-        alpha = alpha - 180;
-        sign = -1;
-    } 
-    else if (alpha > 90)
-    {
-        alpha = 180 - alpha;
-        sign = -1;
-    }
-
-    // apply quadratic fit approximation
-    return (((10188 - alpha * (alpha + 23)) / 101) * sign);
+    s16 c;
+
+    // degrees to a 16-bit binary angle
+    c = cordic_cos15((s16)(TRIGO_BAM32(alpha % 360) >> 16));
+    // round to the nearest hundredth
+    return (s8)(((s32)c * 100 + 16384) >> 15);
 }
 #endif
 
 /*  --------------------------------------------------------------------
-    Return approximation of sin(i) where i is angle in integer degrees 0-359.
+    Return sin(i) where i is angle in integer degrees 0-359.
     Returned value is in range -100 to 100 corresponding to -1.0 to 1.0.
     ------------------------------------------------------------------*/
 
@@ -155,7 +127,7 @@ s8 cos100(u16 alpha)
 s8 sin100(u16 alpha)
 {
     // sin is cos shifted -90 degrees
-    return cos100((alpha + 270) % 360);
+    return cos100((alpha % 360) + 270);
 }
 #endif
 
@@ -4,7 +4,14 @@
 	PURPOSE:		
 	PROGRAMER:		jean-pierre mandon <jp.mandon@gmail.com>
 	FIRST RELEASE:	30 may. 2011
-	LAST RELEASE:	
+	LAST RELEASE:	19 Oct. 2026 - packet queues, FIFO burst access
+	----------------------------------------------------------------------------
+	Received frames are moved to a queue as soon as the MRF24J40 raises
+	RXIF, frames to send wait in another queue and go on air one after
+	the other when the previous one is acknowledged or has failed.
+	With INTZIG the user's interrupt routine calls ZIGinterrupt() when
+	the MRF24J40 INT pin is active, else the radio is polled by
+	ZIGavailable(), ZIGgets(), ZIGputs() and ZIGpending().
 	----------------------------------------------------------------------------
 	This library is free software; you can redistribute it and/or
 	modify it under the terms of the GNU Lesser General Public
@@ -27,19 +34,49 @@
 #include <typedef.h>
 #include <macro.h>
 #include <zigbee/mrf24j40.c>
+#include <zigbee/mrf24j40_queue.c>
+
+// received packets waiting for ZIGgets, power of 2
+#ifndef ZIG_RXQUEUE
+#define ZIG_RXQUEUE		4
+#endif
 
-unsigned char ZIGrx[128];               // this is the receive buffer
-unsigned char zwpointer,zrpointer;      // write and read pointer
+// packets waiting to be sent, the first one is on air, power of 2
+#ifndef ZIG_TXQUEUE
+#define ZIG_TXQUEUE		2
+#endif
+
+mrf24j40_packet_t ZIGrxslot[ZIG_RXQUEUE];
+mrf24j40_packet_t ZIGtxslot[ZIG_TXQUEUE];
+mrf24j40_queue_t ZIGrxqueue;
+mrf24j40_queue_t ZIGtxqueue;
 
 u16 ZIGdestpan;							// dest PAN in received frame
 u16 ZIGsrcpan;							// src PAN in received frame
 u16 ZIGdestadd;							// dest short address in received frame
 u16 ZIGsrcadd;							// src short address in received frame
+u8 ZIGrxrssi;							// RSSI of the received frame
+u8 ZIGrxlqi;								// LQI of the received frame
+
+u16 ZIGdropped;							// frames lost, RX queue full
+u16 ZIGfailures;						// frames not acknowledged
+u8 ZIGretries;							// retries of the last frame sent
+
+// the SPI bus is shared by the main loop and ZIGinterrupt()
+volatile u8 ZIGlock;
+volatile u8 ZIGdeferred;
 
 // init Zigbee MRF24J40 module
 
 void init_zigbee(u8 _channel, u16 pan_id, u16 short_address)
 {
+	mrf24j40_queue_init(&ZIGrxqueue, ZIGrxslot, ZIG_RXQUEUE);
+	mrf24j40_queue_init(&ZIGtxqueue, ZIGtxslot, ZIG_TXQUEUE);
+	ZIGdropped = 0;
+	ZIGfailures = 0;
+	ZIGlock = 0;
+	ZIGdeferred = 0;
+
 	mrf24j40_setup_io();
 	mrf24j40_init();
     // RB : 30-08-2013 - Uncommented following lines
@@ -48,95 +85,164 @@ void init_zigbee(u8 _channel, u16 pan_id, u16 short_address)
 	mrf24j40_set_channel(_channel);
 }
 
-// ISR routine for zigbee. todo
+// ISR routine for zigbee, to be called when the MRF24J40 INT pin is
+// active (INTZIG), else the radio is polled by ZIGavailable and ZIGgets.
+// Deferred to ZIGunlock if the main loop is using the SPI bus.
 
 void ZIGinterrupt(void)
 {
-	Nop();
+	if (ZIGlock)
+		ZIGdeferred = 1;
+	else
+		mrf24j40_handle_isr();
 }
 
-// transmit callback is here to make pic_pack_lib happy
+void ZIGunlock(void)
+{
+	ZIGlock = 0;
+	while (ZIGdeferred)
+	{
+		ZIGlock = 1;
+		ZIGdeferred = 0;
+		mrf24j40_handle_isr();
+		ZIGlock = 0;
+	}
+}
+
+// polls the radio when Zigbee is not interrupt managed
+
+void ZIGpoll(void)
+{
+	#ifndef INTZIG
+	ZIGlock = 1;
+	mrf24j40_handle_isr();
+	ZIGunlock();
+	#endif
+}
+
+// the frame on air is over (acknowledged or not after its retries),
+// load the next one. A TX interrupt with nothing queued (a frame sent
+// without ZIGputs) must not pop, the queue count would wrap to 255.
 
 void mrf24j40_transmit_callback(uns8 status,uns8 retries,uns8 channel_busy)	
 {
-	Nop();
+	mrf24j40_packet_t *p;
+
+	if (mrf24j40_queue_count(&ZIGtxqueue) == 0)
+		return;
+
+	if (status)
+		ZIGfailures++;
+	ZIGretries = retries;
+
+	mrf24j40_queue_pop(&ZIGtxqueue);
+	p = mrf24j40_queue_front(&ZIGtxqueue);
+	if (p != NULL)
+		mrf24j40_frame_transmit(p);
 }
 
-// receive callback if Zigbee is interrupt managed
+// a frame has been received, move it to the queue before the next one
+// overwrites it
 
 void mrf24j40_receive_callback()
 {
-	unsigned char length,i,character;
-	unsigned char znewwp;
-	unsigned char data[128];
-
-		length=mrf24j40_long_addr_read(0x300);
-		for (i=0;i<length;i++)
-			ZIGrx[i]=mrf24j40_long_addr_read(0x301+i);
-		mrf24j40_flush_receive_buffer();	
-/*	
-	length=mrf24j40_receive(data, 128);
-	if (length>0)
-		for (i=0;i<length;i++)
-			{
-					if (zwpointer!=127)				// if not last place in buffer
-						znewwp=zwpointer+1;			// place=place+1
-					else
-						znewwp=1;					// else place=1
-
-					if (zrpointer!=znewwp)			// if read pointer!=write pointer
-						ZIGrx[zwpointer++]=data[i];	// store received char
-
-					if (zwpointer==128)				// if write pointer=length buffer
-						zwpointer=1;				// write pointer = 1
-			}
-*/
+	if (!mrf24j40_frame_receive(&ZIGrxqueue))
+		ZIGdropped++;
 }
 
 // Send a string to short address
+// The packet is queued, returns 0 if the queue is full
  
-void ZIGputs(u16 short_address, u8 *zigstr, u8 length)
+u8 ZIGputs(u16 dest_address, u8 *zigstr, u8 length)
 {
-	mrf24j40_transmit_to_short_address(FTDATA, pan_id, short_address, zigstr, length, 1);
+	mrf24j40_packet_t *p = mrf24j40_queue_back(&ZIGtxqueue);
+	u8 i;
+
+	if (p == NULL)
+	{
+		ZIGpoll();
+		p = mrf24j40_queue_back(&ZIGtxqueue);
+		if (p == NULL)
+			return 0;
+	}
+
+	if (length > MRF24J40_MAXPAYLOAD)
+		length = MRF24J40_MAXPAYLOAD;
+	for (i = 0; i < length; i++)
+		p->data[i] = zigstr[i];
+	p->length = length;
+	p->type = FTDATA;
+	p->ack = 1;
+	p->destpan = pan_id;
+	p->destadd = dest_address;
+	p->srcpan = pan_id;
+	p->srcadd = short_address;
+
+	ZIGlock = 1;
+	p->seq = ++data_sequence_number;
+	mrf24j40_queue_push(&ZIGtxqueue);
+	// the radio is idle, else the callback will send it
+	if (mrf24j40_queue_count(&ZIGtxqueue) == 1)
+		mrf24j40_frame_transmit(p);
+	ZIGunlock();
+
+	return 1;
+}
+
+// number of packets queued or on air
+
+u8 ZIGpending()
+{
+	ZIGpoll();
+	return mrf24j40_queue_count(&ZIGtxqueue);
 }
 
-// new character received ?
-// works only if ZIGBEE is managed by interrupt. Else return ERROR -1
-	
+// number of packets received
+
 int ZIGavailable()
 {
-	#ifdef INTZIG
-	return(zwpointer!=zrpointer);
-	#else
-	return(-1);
-	#endif
+	ZIGpoll();
+	return mrf24j40_queue_count(&ZIGrxqueue);
 }
 
+// copies the payload of the oldest packet received to zigstr
+// (MRF24J40_MAXPAYLOAD + 1 bytes), returns its length or 0
+
 u8 ZIGgets(u8 *zigstr)
 {
-	unsigned char length,i;
-	unsigned char intstat;
-	
-	#ifndef INTZIG				// Zigbee not interrupt managed
-	// read INSTAT Register
-	intstat = mrf24j40_short_addr_read(INTSTAT);
-	// test if we received something 
-	if (test_bit(intstat, INTSTAT_RXIF))
-	{
-		length=mrf24j40_receive(zigstr,128);
-		ZIGdestpan=(zigstr[4]<<8)+zigstr[3];
-		ZIGsrcpan=(zigstr[8]<<8)+zigstr[7];
-		ZIGsrcadd=(zigstr[10]<<8)+zigstr[9];
-		ZIGdestadd=(zigstr[6]<<8)+zigstr[5];
-		for (i=0;i<(length-15);i++)
-			zigstr[i]=zigstr[i+11];
-		zigstr[i]=0;
-		return(length-15);
-	}
-	else return(0);
-	#else
-	Nop();						// todo interrupt managed
-	#endif	
+	mrf24j40_packet_t *p;
+	u8 length,i;
+
+	ZIGpoll();
+	p = mrf24j40_queue_front(&ZIGrxqueue);
+	if (p == NULL)
+		return 0;
+
+	ZIGdestpan = p->destpan;
+	ZIGsrcpan = p->srcpan;
+	ZIGsrcadd = p->srcadd;
+	ZIGdestadd = p->destadd;
+	ZIGrxrssi = p->rssi;
+	ZIGrxlqi = p->lqi;
+	length = p->length;
+	for (i = 0; i < length; i++)
+		zigstr[i] = p->data[i];
+	zigstr[i] = 0;
+
+	mrf24j40_queue_pop(&ZIGrxqueue);
+	return length;
+}
+
+// signal strength and link quality of the last packet read by ZIGgets
+
+u8 ZIGrssi()
+{
+	return ZIGrxrssi;
+}
+
+u8 ZIGlqi()
+{
+	return ZIGrxlqi;
 }
 
 #endif
@@ -367,7 +367,6 @@ uns8 intstat;
 uns8 mrf24j40_receive(uns8 *data, uns8 bytes_to_receive) {
 
 uns8 frame_length;
-uns16 frame_pos;
 uns8 buffer_count;
 /*
 1. Receive RXIF interrupt.
@@ -378,205 +377,136 @@ uns8 buffer_count;
 6. Clear RXDECINV = 0; enable receiving packets.
 7. Enable host microcontroller interrupts.
 */
-        #ifndef __PIC32MX__        
-            serial_putc('a');
-        #endif        	
     // Disable reading packets off air
     mrf24j40_short_addr_write(BBREG1, 1 << BBREG1_RXDECINV);
-        #ifndef __PIC32MX__        	
-            serial_putc('b');
-        #endif        	
-    
-    frame_pos = 0x300;
-    frame_length = mrf24j40_long_addr_read(frame_pos++);	
-    buffer_count = 0;
-        #ifndef __PIC32MX__	
-            serial_putc('c');
-        #endif        	
-    
-    while ((buffer_count <= bytes_to_receive) && (buffer_count <= frame_length + 2)) {
-        //0x301 through (0x300 + Frame Length + 2 ); read packet data plus LQI and RSSI.
-        data[buffer_count++] = mrf24j40_long_addr_read(frame_pos++);
+
+    frame_length = mrf24j40_long_addr_read(0x300);
+
+    //0x301 through (0x300 + Frame Length + 2 ); read packet data plus LQI and RSSI.
+    buffer_count = frame_length + 2;
+    if (buffer_count > bytes_to_receive) {
+        buffer_count = bytes_to_receive;
     }
-        #ifndef __PIC32MX__	
-            serial_putc('d');
-        #endif        	
-    
+    mrf24j40_long_addr_read_burst(0x301, data, buffer_count);
+
     // Re-enable reading packets off air
     mrf24j40_short_addr_write(BBREG1, 0);
-        #ifndef __PIC32MX__	
-            serial_putc('e');
-        #endif        	
 
-    return buffer_count - 1;
-    
+    return buffer_count;
 }
 
 void mrf24j40_transmit_to_extended_address(uns8 frame_type, uns16 dest_pan_id, uns8 *dest_extended_address,
                                            uns8 *data, uns8 data_length, uns8 ack) {
-    
+
+    uns8 fifo[2+3+8+8+2+2]; // header length, frame length, header
+    uns8 count;
+
     // See notes below on frame control bytes format:
-    uns8 fc_msb = 0b11001100;	// 64 bit dest (10,11) 64 bit src (14,15)
-    uns8 fc_lsb = 0b00000000 | frame_type;	// pan id compression=0, data
-        #ifdef __PIC32MX__
-                u8 count=0;
-        #endif 
-        
+    uns8 fc_msb = 0b11001100;   // 64 bit dest (10,11) 64 bit src (14,15)
+    uns8 fc_lsb = 0b00000000 | frame_type;  // pan id compression=0, data
+
     if (ack) {
-        set_bit(fc_lsb, 5);	// ack bit
+        set_bit(fc_lsb, 5); // ack bit
     }
-    
+
     data_sequence_number++;
-    
-    uns8 header_length = 3+8+8+2+2;
-    uns8 frame_length = header_length + data_length;
-    
-    // Write out data to mrf
-        
-    mrf24j40_long_addr_write(0x00, header_length);
-    mrf24j40_long_addr_write(0x01, frame_length);
-    
-    mrf24j40_long_addr_write(0x02, fc_lsb);	
-    mrf24j40_long_addr_write(0x03, fc_msb);
-    mrf24j40_long_addr_write(0x04, data_sequence_number);
-    
-    mrf24j40_long_addr_write(0x05, dest_pan_id & 0xff);	// dest pan id LSB
-    mrf24j40_long_addr_write(0x06, dest_pan_id >> 8);	// MSB
-
-    mrf24j40_long_addr_write(0x07, dest_extended_address[7]); // LSB
-    mrf24j40_long_addr_write(0x08, dest_extended_address[6]);
-    mrf24j40_long_addr_write(0x09, dest_extended_address[5]);
-    mrf24j40_long_addr_write(0x0a, dest_extended_address[4]);
-    mrf24j40_long_addr_write(0x0b, dest_extended_address[3]);
-    mrf24j40_long_addr_write(0x0c, dest_extended_address[2]);
-    mrf24j40_long_addr_write(0x0d, dest_extended_address[1]);
-    mrf24j40_long_addr_write(0x0e, dest_extended_address[0]); // MSB
-    
-    mrf24j40_long_addr_write(0x0f, pan_id & 0xff);	// src pan id LSB
-    mrf24j40_long_addr_write(0x10, pan_id >> 8);	// MSB
-
-    
-    mrf24j40_long_addr_write(0x11, extended_address[7]);	// LSB
-    mrf24j40_long_addr_write(0x12, extended_address[6]);
-    mrf24j40_long_addr_write(0x13, extended_address[5]);
-    mrf24j40_long_addr_write(0x14, extended_address[4]);
-    mrf24j40_long_addr_write(0x15, extended_address[3]);
-    mrf24j40_long_addr_write(0x16, extended_address[2]);
-    mrf24j40_long_addr_write(0x17, extended_address[1]);
-    mrf24j40_long_addr_write(0x18, extended_address[0]);	// MSB
-    #ifndef __PIC32MX__
-            for (uns8 count=0;  count < data_length; count++) {
-                mrf24j40_long_addr_write(count+header_length+2,  data[count]);
-        #endif
-        #ifdef __PIC32MX__
-            for (count=0;  count < data_length; count++) {
-                mrf24j40_long_addr_write(count+header_length+2,  data[count]);
-        #endif        		        
+
+    fifo[0] = 3+8+8+2+2;    // header_length
+    fifo[1] = fifo[0] + data_length;    // frame_length
+
+    fifo[2] = fc_lsb;
+    fifo[3] = fc_msb;
+    fifo[4] = data_sequence_number;
+
+    fifo[5] = dest_pan_id & 0xff;   // dest pan id LSB
+    fifo[6] = dest_pan_id >> 8; // MSB
+
+    fifo[15] = pan_id & 0xff;   // src pan id LSB
+    fifo[16] = pan_id >> 8; // MSB
+
+    for (count = 0; count < 8; count++) {
+        fifo[7 + count] = dest_extended_address[7 - count]; // LSB first
+        fifo[17 + count] = extended_address[7 - count];
     }
-    
+
+    // Write out header then data to mrf, one burst each
+    mrf24j40_long_addr_write_burst(0x00, fifo, sizeof(fifo));
+    mrf24j40_long_addr_write_burst(sizeof(fifo), data, data_length);
+
     uns8 txncon = mrf24j40_short_addr_read(TXNCON);
-    
+
     set_bit(txncon, TXNCON_TXNTRIG);
     if (ack) {
         set_bit(txncon, TXNCON_TXNACKREQ);
-    }	
+    }
     mrf24j40_short_addr_write(TXNCON, txncon);
-    
-
 }
 
 
 void mrf24j40_transmit_to_short_address(uns8 frame_type, uns16 dest_pan_id, uns16 dest_short_address, uns8 *data, uns8 bytes_to_transmit, uns8 ack) {
-    
-    uns8 fc_msb = 0b10001000;	// short dest (10,11) short src (14,15)
-    uns8 fc_lsb = 0b00000000 | frame_type;	// data, pan id compression (only have dest pan id)
-        #ifdef __PIC32MX__
-                u8 count=0;
-        #endif                
+
+    uns8 fifo[2+3+2+2+2+2]; // header length, frame length, header
+
+    uns8 fc_msb = 0b10001000;   // short dest (10,11) short src (14,15)
+    uns8 fc_lsb = 0b00000000 | frame_type;  // data, pan id compression (only have dest pan id)
     // To do:
     // Not smart enough for this yet:
     //if (dest_pan_id == pan_id) {
-    //	set_bit(fc_lsb, 6); 	// pan compression
-    //}	
+    //  set_bit(fc_lsb, 6);     // pan compression
+    //}
     if (ack) {
-        set_bit(fc_lsb, 5);	// ack bit
-    }	
-    
+        set_bit(fc_lsb, 5); // ack bit
+    }
+
     data_sequence_number++;
-    
-    uns8 header_length = 3+2+2+2+2;
-    uns8 frame_length = header_length + bytes_to_transmit;
-        
-    mrf24j40_long_addr_write(0x00, header_length);
-    mrf24j40_long_addr_write(0x01, frame_length);
-    
-    mrf24j40_long_addr_write(0x02, fc_lsb);	
-    mrf24j40_long_addr_write(0x03, fc_msb);
-    mrf24j40_long_addr_write(0x04, data_sequence_number);
-    
-    mrf24j40_long_addr_write(0x05, dest_pan_id & 0xff);	// dest pan id  LSB
-    mrf24j40_long_addr_write(0x06, dest_pan_id >> 8);	// MSB
-    
-    mrf24j40_long_addr_write(0x07, dest_short_address & 0xff); // LSB
-    mrf24j40_long_addr_write(0x08, dest_short_address >> 8);	// MSB
 
-    mrf24j40_long_addr_write(0x09, pan_id & 0xff);	// src pan id  (=ours) LSB
-    mrf24j40_long_addr_write(0x0a, pan_id >> 8);	// MSB
+    fifo[0] = 3+2+2+2+2;    // header_length
+    fifo[1] = fifo[0] + bytes_to_transmit;  // frame_length
+
+    fifo[2] = fc_lsb;
+    fifo[3] = fc_msb;
+    fifo[4] = data_sequence_number;
+
+    fifo[5] = dest_pan_id & 0xff;   // dest pan id  LSB
+    fifo[6] = dest_pan_id >> 8; // MSB
+
+    fifo[7] = dest_short_address & 0xff; // LSB
+    fifo[8] = dest_short_address >> 8;  // MSB
+
+    fifo[9] = pan_id & 0xff;    // src pan id  (=ours) LSB
+    fifo[10] = pan_id >> 8; // MSB
+
+    fifo[11] = short_address & 0xff;    // LSB
+    fifo[12] = short_address >> 8;
+
+    mrf24j40_long_addr_write_burst(0x00, fifo, sizeof(fifo));
+    mrf24j40_long_addr_write_burst(sizeof(fifo), data, bytes_to_transmit);
 
-    
-    mrf24j40_long_addr_write(0x0b, short_address & 0xff);	// LSB
-    mrf24j40_long_addr_write(0x0c, short_address >> 8);
-        #ifndef __PIC32MX__	
-    for (uns8 count=0;  count < bytes_to_transmit; count++) { // check format here
-    #endif
-    #ifdef __PIC32MX__
-    for (count=0;  count < bytes_to_transmit; count++) { 
-    #endif
-        mrf24j40_long_addr_write(count+header_length+2,  data[count]);
-    }
-    
     uns8 txncon = mrf24j40_short_addr_read(TXNCON);
     set_bit(txncon, TXNCON_TXNTRIG);
     if (ack) {
         set_bit(txncon, TXNCON_TXNACKREQ);
-    }	
+    }
     mrf24j40_short_addr_write(TXNCON, txncon);
-    
-
 }
 
 
 
 void mrf24j40_transmit(uns8 *data, uns8 bytes_to_transmit) {
 
-    
-    uns8 fc_lsb = 0b01000001;
-    uns8 fc_msb = 0b00000000;
-        #ifdef __PIC32MX__
-                u8 count=0;
-        #endif                	
-    
-    
+    uns8 fifo[2+3]; // header length, frame length, header
+
     data_sequence_number++;
-    uns8 header_length = 3;	// Just two bytes of frame control + sequence number, no addrs
-    uns8 frame_length = header_length + bytes_to_transmit;
-    
-    mrf24j40_long_addr_write(0x00, header_length);
-    mrf24j40_long_addr_write(0x01, frame_length);
-    mrf24j40_long_addr_write(0x02, fc_lsb);
-    mrf24j40_long_addr_write(0x03, fc_msb);
-    mrf24j40_long_addr_write(0x04, data_sequence_number);
-    
-    #ifndef __PIC32MX__
-            for (uns8 count=0;  count < bytes_to_transmit; count++) { // check format here
-                mrf24j40_long_addr_write(count+header_length+2,  data[count]);
-        #endif
-        #ifdef __PIC32MX__
-            for (count=0;  count < bytes_to_transmit; count++) { // check format here
-                mrf24j40_long_addr_write(count+header_length+2,  data[count]);
-        #endif        		        
-    }
-    
+
+    fifo[0] = 3;    // Just two bytes of frame control + sequence number, no addrs
+    fifo[1] = fifo[0] + bytes_to_transmit;
+    fifo[2] = 0b01000001;   // fc_lsb
+    fifo[3] = 0b00000000;   // fc_msb
+    fifo[4] = data_sequence_number;
+
+    mrf24j40_long_addr_write_burst(0x00, fifo, sizeof(fifo));
+    mrf24j40_long_addr_write_burst(sizeof(fifo), data, bytes_to_transmit);
+
     uns8 txncon = mrf24j40_short_addr_read(TXNCON);
     set_bit(txncon, TXNCON_TXNTRIG);
     mrf24j40_short_addr_write(TXNCON, txncon);
@@ -922,6 +852,70 @@ void mrf24j40_long_addr_write(uns16 addr, uns8 data){
 }
 
 
+/*
+Sequential long address access : the address is sent once, then the
+mrf24j40 increments it after each data byte as long as CS is low.
+Used to move the TX and RX FIFOs in one transaction.
+*/
+void mrf24j40_long_addr_read_burst(uns16 addr, uns8 *data, uns8 count){
+
+        #ifndef __PIC32MX__
+            clear_pin(mrf24j40_cs_port, mrf24j40_cs_pin);
+
+            addr = addr & 0b0000001111111111; 	// <9:0> bits
+            addr = addr << 5;
+            set_bit(addr, 15);	// long addresss
+            spi_hw_transmit(addr >> 8);
+            spi_hw_transmit(addr & 0x00ff);
+            while (count--) {
+                *data++ = spi_hw_receive();
+            }
+
+            set_pin(mrf24j40_cs_port, mrf24j40_cs_pin);
+        #endif
+        #ifdef __PIC32MX__
+            ZIGCS=0;
+            addr=((addr<<1)&0x7FE)|0x800;
+            addr<<=4;
+            SPI_write(addr>>8);
+            SPI_write(addr);
+            while (count--)
+                *data++=SPI_read();
+            ZIGCS=1;
+        #endif
+}
+
+void mrf24j40_long_addr_write_burst(uns16 addr, const uns8 *data, uns8 count){
+
+        #ifndef __PIC32MX__
+            clear_pin(mrf24j40_cs_port, mrf24j40_cs_pin);
+
+            addr = addr & 0b0000001111111111; 	// <9:0> bits
+            addr = addr << 5;
+
+            set_bit(addr, 15);	// long addresss
+            set_bit(addr, 4);	// set for write
+
+            spi_hw_transmit(addr >> 8 );
+            spi_hw_transmit(addr & 0x00ff);
+            while (count--) {
+                spi_hw_transmit(*data++);
+            }
+
+            set_pin(mrf24j40_cs_port, mrf24j40_cs_pin);
+        #endif
+        #ifdef __PIC32MX__
+            ZIGCS=0;
+            addr=((addr<<1)&0x7FF)|0x801;
+            addr<<=4;
+            SPI_write(addr>>8);
+            SPI_write(addr);
+            while (count--)
+                SPI_write(*data++);
+            ZIGCS=1;
+        #endif
+}
+
 void mrf24j40_setup_io() {
 
         #ifndef __PIC32MX__	
@@ -167,6 +167,34 @@ uns8 mrf24j40_long_addr_read(uns16 addr);
 */
 void mrf24j40_long_addr_write(uns16 addr, uns8 data);
 
+/** 
+ 
+    \brief Read consecutive long address memory locations
+ 
+    Sequential access: the address is sent once and incremented by the
+    mrf24j40 after each byte. Used to read the RX FIFO in one go.
+    
+    \param addr First long address memory location
+    \param data Buffer the values are stored to
+    \param count Number of memory locations to read
+ 
+*/
+void mrf24j40_long_addr_read_burst(uns16 addr, uns8 *data, uns8 count);
+
+/** 
+ 
+    \brief Write consecutive long address memory locations
+ 
+    Sequential access, see mrf24j40_long_addr_read_burst. Used to load
+    the TX FIFO in one go.
+    
+    \param addr First long address memory location
+    \param data Values the memory locations should be set to
+    \param count Number of memory locations to write
+ 
+*/
+void mrf24j40_long_addr_write_burst(uns16 addr, const uns8 *data, uns8 count);
+
 /** 
  
     \brief Setup ports/pins as inputs/outputs ready for use
@@ -434,7 +434,8 @@ unsigned long _cpu_clock_ = 48000000;
      defined(__SERIAL__)    || defined(ON_EVENT)    || defined(__MILLIS__)  || \
      defined(__SERVO__)     || defined(__PS2KEYB__) || defined(__DCF77__)   || \
      defined(__IRREMOTE__)  || defined(__AUDIO__)   || defined(__STEPPER__) || \
-     defined(__CTMU__)      || defined(__SWPWM__)   || defined(RTCCALARMINTENABLE)
+     defined(__CTMU__)      || defined(__SWPWM__)   || defined(RTCCALARMINTENABLE) || \
+     defined(__RF433MHZRX__) || defined(__SWSERIAL__) || defined(__INTX__)
      // || defined(__DELAYMS__)
      // || defined(__MICROSTEPPING__)
 
@@ -462,6 +463,10 @@ unsigned long _cpu_clock_ = 48000000;
             serial_interrupt();
             #endif
 
+            #ifdef __SWSERIAL__
+            swserial_interrupt();
+            #endif
+
             #if defined(__MILLIS__) //|| defined(__DELAYMS__)
             millis_interrupt();
             #endif
@@ -482,8 +487,8 @@ unsigned long _cpu_clock_ = 48000000;
             keyboard_interrupt();
             #endif
 
-            #ifdef __DCF77__
-            dcf77_interrupt();
+            #ifdef __INTX__
+            intx_interrupt();
             #endif
 
             #ifdef __IRREMOTE__
@@ -563,6 +568,10 @@ unsigned long _cpu_clock_ = 48000000;
             serial_interrupt();
             #endif
 
+            #ifdef __SWSERIAL__
+            swserial_interrupt();
+            #endif
+
             #if defined(__MILLIS__) //|| defined(__DELAYMS__)
             millis_interrupt();
             #endif
@@ -575,7 +584,7 @@ unsigned long _cpu_clock_ = 48000000;
             servo_interrupt();
             #endif
 
-            #ifdef INT0INT
+            #if defined(INT0INT) || defined(INTSETPRIORITY)
             userhighinterrupt();
             #endif
 
@@ -587,8 +596,8 @@ unsigned long _cpu_clock_ = 48000000;
             //keypad_interrupt();
             //#endif
 
-            #ifdef __DCF77__
-            dcf77_interrupt();
+            #ifdef __INTX__
+            intx_interrupt();
             #endif
 
             #ifdef __IRREMOTE__
@@ -642,7 +651,10 @@ unsigned long _cpu_clock_ = 48000000;
         void low_priority_isr(void) __interrupt 2
         #endif
         {
-            #ifndef __XC8__
+            // INTFASTCONTEXT : the low priority callbacks don't read
+            // the program memory (const tables and strings), the table
+            // pointer is left as it is (8 cycles less on each side)
+            #if !defined(__XC8__) && !defined(INTFASTCONTEXT)
             __asm
                 MOVFF   _TBLPTRL, POSTDEC1
                 MOVFF   _TBLPTRH, POSTDEC1
@@ -659,7 +671,7 @@ unsigned long _cpu_clock_ = 48000000;
             userlowinterrupt();
             #endif
             
-            #ifndef __XC8__
+            #if !defined(__XC8__) && !defined(INTFASTCONTEXT)
             __asm
                 MOVFF   PREINC1, _TABLAT
                 MOVFF   PREINC1, _TBLPTRU
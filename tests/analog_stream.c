@@ -0,0 +1,143 @@
+/*  --------------------------------------------------------------------
+    analog_stream.c - host test of the PIC32 continuous acquisition
+    --------------------------------------------------------------------
+    scan list order and duplicates, AD1CSSL, oversampling, ring buffer
+    overrun and block callback, the ADC being replaced by a table of
+    conversions tagged with their ANx number
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+
+#define PIC32_PINGUINO
+#define ANALOGSTREAM
+#define ANALOGMAXCHANNELS   4
+#define ANALOGBUFFERSIZE    16
+#define ANALOGBLOCKSIZE     4
+
+#include <analog.c>
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+static u16 blocks[8];
+static u8 nblocks;
+
+static void onblock(u16 offset)
+{
+    blocks[nblocks++ & 7] = offset;
+}
+
+static void test_attach(void)
+{
+    // A3 = AN4, A0 = AN1, A1 = AN2, A4 = AN8, A7 = AN10, A6 = AN11
+    CHECK(Analog_attach(3) == 0);
+    CHECK(Analog_attach(0) == 0);   // AN1 goes before AN4
+    CHECK(Analog_attach(3) == 1);   // already attached
+    CHECK(Analog_attach(0) == 0);
+    CHECK(gAnalog.nbchannels == 2);
+    CHECK(Analog_attach(7) == 2);
+    CHECK(Analog_attach(1) == 1);   // AN2 between AN1 and AN4
+    CHECK(gAnalog.nbchannels == 4);
+    CHECK(Analog_attach(4) == 255); // full
+    CHECK(Analog_attach(3) == 2);   // still found when full
+    CHECK(gAnalog.nbchannels == 4);
+
+    CHECK(gAnalog.channel[0] == 1);
+    CHECK(gAnalog.channel[1] == 2);
+    CHECK(gAnalog.channel[2] == 4);
+    CHECK(gAnalog.channel[3] == 10);
+
+    CHECK(Analog_index(0) == 0);
+    CHECK(Analog_index(1) == 1);
+    CHECK(Analog_index(3) == 2);
+    CHECK(Analog_index(7) == 3);
+    CHECK(Analog_index(6) == 255);
+}
+
+static void test_insert(void)
+{
+    analog_stream_t s = { 0 };
+    u8 an[] = { 9, 3, 15, 0, 3, 9, 7 };
+    u8 i;
+
+    for (i = 0; i < sizeof(an); i++)
+        Analog_insert(&s, an[i]);
+
+    CHECK(s.nbchannels == 4);
+    for (i = 1; i < s.nbchannels; i++)
+        CHECK(s.channel[i - 1] < s.channel[i]);
+    CHECK(s.channel[0] == 0 && s.channel[3] == 15);
+}
+
+static void test_stream(void)
+{
+    u16 raw[16], frame[ANALOGMAXCHANNELS];
+    u8 i, c, k, n = gAnalog.nbchannels;
+    u16 f;
+
+    Analog_onBlock(onblock);
+    Analog_start(1000, 4);
+
+    CHECK(AD1CSSL == ((1 << 1) | (1 << 2) | (1 << 4) | (1 << 10)));
+    CHECK(gAnalog.oversample == 4 && gAnalog.shift == 1);
+    CHECK(((AD1CON2 >> 2) & 15) + 1 == n * 4);
+    CHECK(IntEnabled);
+
+    // conversion = 100 * ANx + frame number, 4 conversions per frame
+    // summed and shifted by 1 give 2 * value
+    for (f = 0; f < 20; f++)
+    {
+        for (k = 0, i = 0; k < 4; k++)
+            for (c = 0; c < n; c++)
+                raw[i++] = 100 * gAnalog.channel[c] + f;
+        Analog_push(&gAnalog, raw, i);
+    }
+
+    // 15 frames fit in a 16-frame ring, the last 5 are lost
+    CHECK(Analog_available() == 15);
+    CHECK(gAnalog.overrun == 5);
+    CHECK(nblocks == 3);
+    CHECK(blocks[0] == 0 && blocks[1] == 4 && blocks[2] == 8);
+
+    for (f = 0; f < 15; f++)
+    {
+        CHECK(Analog_readFrame(frame));
+        CHECK(frame[0] == 2 * (100 + f));           // A0 = AN1
+        CHECK(frame[1] == 2 * (200 + f));           // A1 = AN2
+        CHECK(frame[2] == 2 * (400 + f));           // A3 = AN4
+        CHECK(frame[3] == 2 * (1000 + f));          // A7 = AN10
+    }
+    CHECK(!Analog_readFrame(frame));
+}
+
+static void test_interrupt(void)
+{
+    u16 frame[ANALOGMAXCHANNELS];
+    u8 i, n = gAnalog.nbchannels;
+
+    // one interrupt, 16 words = 4 frames of 4 channels
+    for (i = 0; i < 16; i++)
+        ADC1BUF[i * 4] = 100 * gAnalog.channel[i % n];
+    AD1CON2bits.SMPI = 15;
+    IntFlag = 1;
+    ADCInterrupt();
+
+    CHECK(IntFlag == 0);
+    CHECK(Analog_available() == 1);
+    CHECK(Analog_readFrame(frame));
+    CHECK(frame[0] == 200 && frame[3] == 2000);
+}
+
+int main(void)
+{
+    test_attach();
+    test_insert();
+    test_stream();
+    test_interrupt();
+
+    printf("analog_stream: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
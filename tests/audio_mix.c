@@ -0,0 +1,249 @@
+/*  --------------------------------------------------------------------
+    audio_mix.c - host test of the PIC32 audio mixer
+    --------------------------------------------------------------------
+    Audio_mix() and Audio_render() are run without the timer : pitch
+    and amplitude of a voice, note duration (long notes included, the
+    sample count used to overflow), ADSR timing, saturation of the sum
+    of the voices, wavetable size limits with linear interpolation, and
+    the duty cycles put in the ring buffer for the TIMER2 ISR.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <typedef.h>
+
+#define PIC32_PINGUINO
+#define AUDIOINTERPOLATE
+
+// output compare and TIMER2 registers
+u32 OC1CON, OC1R, OC1RS, OC3CON, OC3R, OC3RS, OC4CON, OC4R, OC4RS;
+u32 PR2, TMR2, T2CON, IFS0CLR;
+#define _TIMER_2_IRQ        8
+#define _TIMER_2_VECTOR     8
+
+#include <audio.c>
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+#define RATE        CDQUALITY
+
+static s16 out[RATE];
+
+static void voices_off(void)
+{
+    u8 i;
+
+    for (i = 0; i < AUDIOVOICES; i++)
+    {
+        gAudioVoice[i].state = AUDIO_OFF;
+        gAudioVoice[i].volume = 255;
+        Audio_setWaveform(i, sine256, 8);
+        Audio_setEnvelope(i, 0, 0, 100, 0);
+    }
+}
+
+// 1 s of a 440 Hz sine : 880 zero crossings, full amplitude
+static void test_tone(void)
+{
+    u32 i, zero = 0;
+    s16 max = 0, min = 0;
+
+    voices_off();
+    Audio_noteOn(0, 440, 0);
+    Audio_mix(gAudioVoice, AUDIOVOICES, out, RATE);
+
+    for (i = 0; i < RATE; i++)
+    {
+        if (i && (out[i - 1] < 0) != (out[i] < 0))
+            zero++;
+        if (out[i] > max) max = out[i];
+        if (out[i] < min) min = out[i];
+    }
+    printf("audio_mix: 440 Hz, %u zero crossings, %d .. %d\n", zero, min, max);
+    CHECK(zero >= 879 && zero <= 881);
+    CHECK(max > 32400 && min < -32400);
+    CHECK(Audio_isPlaying(0));          // no duration, until noteOff
+
+    Audio_noteOff(0);
+    Audio_mix(gAudioVoice, AUDIOVOICES, out, 2);
+    CHECK(!Audio_isPlaying(0));         // no release time
+}
+
+// the number of samples of a note, even a very long one
+static void test_duration(void)
+{
+    u32 n = 0;
+
+    voices_off();
+
+    Audio_noteOn(0, 440, 10);
+    while (Audio_isPlaying(0) && n < RATE)
+    {
+        Audio_mix(gAudioVoice, 1, out, 1);
+        n++;
+    }
+    // 441 samples, then the release step which turns it off
+    CHECK(n == RATE / 100 + 1);
+
+    // 100000 ms * 44100 doesn't fit in 32 bits
+    Audio_noteOn(0, 440, 100000);
+    CHECK(gAudioVoice[0].remain == 100UL * RATE);
+    Audio_noteOn(0, 440, 0xFFFFFFFF);
+    CHECK(gAudioVoice[0].remain == 0xFFFFFFFF);
+
+    // and at a higher rate, the envelope steps too
+    gSampleRate = 96000;
+    Audio_setEnvelope(0, 60000, 0, 100, 0);
+    Audio_noteOn(0, 440, 3600000);
+    CHECK(gAudioVoice[0].remain == 3600UL * 96000);
+    CHECK(gAudioVoice[0].astep == AUDIO_ENVMAX / (60UL * 96000));
+    gSampleRate = RATE;
+}
+
+// the envelope times are for the full range, the steps are rounded
+// down so a segment can be up to 1% longer
+#define ABOUT(n, ms)    ((n) >= RATE * (ms) / 1000 && (n) <= RATE * (ms) / 990 + 1)
+
+// attack, decay to the sustain level, release
+static void test_envelope(void)
+{
+    u32 n;
+
+    voices_off();
+    Audio_setEnvelope(0, 10, 20, 50, 30);
+    Audio_noteOn(0, 440, 100);
+
+    for (n = 0; gAudioVoice[0].state == AUDIO_ATTACK; n++)
+        Audio_mix(gAudioVoice, 1, out, 1);
+    CHECK(ABOUT(n, 10));
+    CHECK(gAudioVoice[0].env == AUDIO_ENVMAX);
+
+    // down to 50%, half of the 20 ms
+    for (n = 0; gAudioVoice[0].state == AUDIO_DECAY; n++)
+        Audio_mix(gAudioVoice, 1, out, 1);
+    CHECK(ABOUT(n, 10));
+    CHECK(gAudioVoice[0].env == AUDIO_ENVMAX / 2);
+
+    // the release starts at the end of the 100 ms
+    for (n = 0; gAudioVoice[0].state == AUDIO_SUSTAIN; n++)
+        Audio_mix(gAudioVoice, 1, out, 1);
+    CHECK(gAudioVoice[0].state == AUDIO_RELEASE);
+    CHECK(gAudioVoice[0].remain == 0);
+
+    // from the sustain level, half of the 30 ms
+    for (n = 0; gAudioVoice[0].state == AUDIO_RELEASE; n++)
+        Audio_mix(gAudioVoice, 1, out, 1);
+    CHECK(ABOUT(n, 15));
+    CHECK(!Audio_isPlaying(0));
+}
+
+// 4 voices in phase are clipped, not wrapped
+static void test_saturation(void)
+{
+    u32 i, clipped = 0, bad = 0;
+    double ref;
+    u8 j;
+
+    voices_off();
+    for (j = 0; j < AUDIOVOICES; j++)
+        Audio_noteOn(j, 1000, 0);
+    Audio_mix(gAudioVoice, AUDIOVOICES, out, RATE / 10);
+
+    for (i = 0; i < RATE / 10; i++)
+    {
+        ref = AUDIOVOICES * 32640.0 * sin(2 * M_PI * 1000 * i / RATE);
+        if (ref > 32767 + 600)
+            bad += (out[i] != 32767);
+        else if (ref < -32768 - 600)
+            bad += (out[i] != -32768);
+        else
+            bad += (fabs(out[i] - ref) > 600);
+        if (out[i] == 32767 || out[i] == -32768)
+            clipped++;
+    }
+    CHECK(bad == 0);
+    CHECK(clipped > RATE / 20);
+}
+
+// table sizes and interpolation between the samples
+static void test_waveform(void)
+{
+    static s16 ramp[1 << AUDIOTABLEBITS];
+    static const s16 square[2] = { -16384, 16383 };
+    u32 i, back = 0;
+    u8 down = 0;
+
+    voices_off();
+    CHECK(!Audio_setWaveform(0, sine256, 0));
+    CHECK(!Audio_setWaveform(0, sine256, AUDIOTABLEBITS + 1));
+    CHECK(gAudioVoice[0].table == sine256 && gAudioVoice[0].shift == 24);
+
+    // the largest table : a rising ramp stays rising, but at the end
+    // of each of the 3 periods, the last one ends with the second
+    for (i = 0; i < (1 << AUDIOTABLEBITS); i++)
+        ramp[i] = (s32)i - 32768;
+    CHECK(Audio_setWaveform(0, ramp, AUDIOTABLEBITS));
+    Audio_noteOn(0, 3, 0);
+    Audio_mix(gAudioVoice, 1, out, RATE);
+    for (i = 1; i < RATE; i++)
+    {
+        // the last sample is interpolated towards the first one,
+        // a fall can then take two steps
+        if (out[i] < out[i - 1] && !down)
+            back++;
+        down = (out[i] < out[i - 1]);
+    }
+    CHECK(back == 2);
+
+    // the smallest one : the interpolation gives a triangle
+    CHECK(Audio_setWaveform(0, square, 1));
+    Audio_noteOn(0, RATE / 8, 0);
+    Audio_mix(gAudioVoice, 1, out, 8);
+    CHECK(out[0] < out[1] && out[1] < out[2] && out[2] < out[3]);
+    CHECK(out[4] > out[5] && out[5] > out[6] && out[6] > out[7]);
+}
+
+// duty cycles for the ISR, within the PWM period
+static void test_render(void)
+{
+    u16 i, n = 0, bad = 0;
+
+    voices_off();
+    Audio_noteOn(0, 440, 0);
+    Audio_noteOn(1, 660, 0);
+    Audio_render();
+
+    for (i = gAudioTail; i != gAudioHead; i = (i + 1) & (AUDIOBUFFERSIZE - 1), n++)
+        if (gAudioBuffer[i] >= gPeriodPlus1)
+            bad++;
+    CHECK(n == AUDIOBUFFERSIZE - 1);
+    CHECK(bad == 0);
+
+    // the ISR pops one sample per period, then counts the underruns
+    pOCxRS = (volatile u16 *)&OC1RS;
+    for (i = 0; i < n + 3; i++)
+        Timer2Interrupt();
+    CHECK(gAudioTail == gAudioHead);
+    CHECK(gAudioUnderrun == 3);
+}
+
+int main(void)
+{
+    Audio_init(RATE);
+    CHECK(gPeriodPlus1 == GetPeripheralClock() / RATE);
+
+    test_tone();
+    test_duration();
+    test_envelope();
+    test_saturation();
+    test_waveform();
+    test_render();
+
+    printf("audio_mix: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
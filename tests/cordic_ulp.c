@@ -0,0 +1,310 @@
+/*  --------------------------------------------------------------------
+    cordic_ulp.c - host accuracy test and benchmark of cordic.c
+    --------------------------------------------------------------------
+    Built once for P8 (cordic_mul31 made of 16-bit products) and once
+    for P32 (-D__PIC32MX__, 64-bit multiply). Each function is run on
+    random arguments and compared with libm in double precision, the
+    error is given in ULPs of the result format (2^-15 for Q15, 2^-31
+    for Q31, 2^-q for the s32 with q fraction bits, 2^-8 for fixedptc).
+    The time per call is compared with the libm double function.
+
+    trigo.c (sinr, cosr, sin100, cos100) and fixedptc (sin, cos, exp,
+    ln) are checked the same way.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <math.h>
+
+#define CORDICQ15
+#define CORDICQ31
+#define CORDICHYPERBOLIC
+#define SINR
+#define COSR
+#define SIN100
+#define COS100
+
+#include <trigo.c>
+#include <fixedptc.c>
+#include <bench.h>
+
+#ifdef __PIC32MX__
+#define TARGET      "p32"
+#else
+#define TARGET      "p8"
+#endif
+
+#define NTESTS      200000
+#define NBENCH      4096
+
+#define Q15         32768.0
+#define Q31         2147483648.0
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+typedef struct
+{
+    double max, sum;
+    u32 n;
+} ulp_t;
+
+static void ulp_add(ulp_t *u, double got, double want)
+{
+    double e = fabs(got - want);
+
+    if (e > u->max)
+        u->max = e;
+    u->sum += e;
+    u->n++;
+}
+
+static double ulp_report(const char *name, const ulp_t *u)
+{
+    printf("cordic_ulp_" TARGET ": %-16s max %8.2f ULP  mean %6.3f ULP\n",
+        name, u->max, u->sum / u->n);
+    return u->max;
+}
+
+static s32 rand31(void)
+{
+    return (s32)bench_rand();
+}
+
+static s16 rand15(void)
+{
+    return (s16)bench_rand();
+}
+
+// uniform in [lo, hi)
+static double uniform(double lo, double hi)
+{
+    return lo + (hi - lo) * (bench_rand() / 4294967296.0);
+}
+
+// reference angle error, the binary angle wraps at one turn
+static double angle_error(double got, double want, double turn)
+{
+    double e = fmod(got - want, turn);
+
+    if (e > turn / 2)
+        e -= turn;
+    if (e < -turn / 2)
+        e += turn;
+    return e;
+}
+
+/*  --------------------------------------------------------------------
+    circular functions, Q15 and Q31
+    ------------------------------------------------------------------*/
+
+static void test_q15(void)
+{
+    ulp_t us = { 0 }, ua = { 0 }, uh = { 0 };
+    s16 s, c, x, y;
+    double a;
+    u32 i;
+
+    for (i = 0; i < 65536; i++)
+    {
+        cordic_sincos15((s16)i, &s, &c);
+        a = (s16)i * M_PI / Q15;
+        ulp_add(&us, s, fmin(sin(a) * Q15, 32767));
+        ulp_add(&us, c, fmin(cos(a) * Q15, 32767));
+    }
+
+    for (i = 0; i < NTESTS; i++)
+    {
+        x = rand15();
+        y = rand15();
+        if (x == 0 && y == 0)
+            continue;
+        ulp_add(&ua, 0, angle_error(cordic_atan2_15(y, x), atan2(y, x) * Q15 / M_PI, 65536.0));
+        ulp_add(&uh, cordic_hypot15(x, y), hypot(x, y));
+    }
+
+    CHECK(ulp_report("sincos15", &us) <= 1.0);
+    CHECK(ulp_report("atan2_15", &ua) <= 1.0);
+    CHECK(ulp_report("hypot15", &uh) <= 1.0);
+}
+
+static void test_q31(void)
+{
+    ulp_t us = { 0 }, ua = { 0 }, uh = { 0 };
+    s32 s, c, x, y;
+    double a;
+    u32 i;
+
+    for (i = 0; i < NTESTS; i++)
+    {
+        x = rand31();
+        cordic_sincos31(x, &s, &c);
+        a = x * M_PI / Q31;
+        ulp_add(&us, s, fmin(sin(a) * Q31, 2147483647.0));
+        ulp_add(&us, c, fmin(cos(a) * Q31, 2147483647.0));
+
+        x = rand31();
+        y = rand31();
+        ulp_add(&ua, 0, angle_error((double)cordic_atan2_31(y, x), atan2(y, x) * Q31 / M_PI, 4294967296.0));
+        ulp_add(&uh, cordic_hypot31(x, y), hypot(x, y));
+
+        // small vectors keep their precision
+        x >>= 12;
+        y >>= 12;
+        if (x || y)
+            ulp_add(&ua, 0, angle_error((double)cordic_atan2_31(y, x), atan2(y, x) * Q31 / M_PI, 4294967296.0));
+    }
+
+    CHECK(ulp_report("sincos31", &us) <= 48.0);
+    CHECK(ulp_report("atan2_31", &ua) <= 32.0);
+    CHECK(ulp_report("hypot31", &uh) <= 64.0);
+}
+
+/*  --------------------------------------------------------------------
+    hyperbolic functions, Q16.15
+    ------------------------------------------------------------------*/
+
+static void test_hyperbolic(void)
+{
+    ulp_t ue = { 0 }, ul = { 0 }, ush = { 0 }, uch = { 0 };
+    double x;
+    s32 qx;
+    u32 i;
+
+    for (i = 0; i < NTESTS; i++)
+    {
+        // e^x below 2^16
+        qx = lround(uniform(-10.0, 11.0) * Q15);
+        x = qx / Q15;
+        ulp_add(&ue, cordic_exp(qx, 15), exp(x) * Q15);
+        ulp_add(&ush, cordic_sinh(qx, 15), sinh(x) * Q15);
+        ulp_add(&uch, cordic_cosh(qx, 15), cosh(x) * Q15);
+
+        // 2^-15 to 2^16
+        qx = 1 + (bench_rand() >> 1);
+        ulp_add(&ul, cordic_ln(qx, 15), log(qx / Q15) * Q15);
+    }
+
+    CHECK(ulp_report("exp Q16.15", &ue) <= 48.0);
+    CHECK(ulp_report("ln Q16.15", &ul) <= 1.0);
+    CHECK(ulp_report("sinh Q16.15", &ush) <= 24.0);
+    CHECK(ulp_report("cosh Q16.15", &uch) <= 24.0);
+    CHECK(cordic_ln(0, 15) == -0x7FFFFFFFL);
+    CHECK(cordic_exp(lround(12.0 * Q15), 15) == 0x7FFFFFFFL);
+}
+
+/*  --------------------------------------------------------------------
+    trigo.c and fixedptc (24.8)
+    ------------------------------------------------------------------*/
+
+static void test_trigo(void)
+{
+    double emax = 0, a;
+    u16 d;
+    int i;
+
+    for (i = -1000; i <= 1000; i++)
+    {
+        a = i * M_PI / 180;
+        emax = fmax(emax, fabs(sinr(i) - sin(a)));
+        emax = fmax(emax, fabs(cosr(i) - cos(a)));
+    }
+    printf("cordic_ulp_" TARGET ": %-16s max error %.1e\n", "sinr/cosr", emax);
+    CHECK(emax < 1e-7);
+
+    // rounded to the nearest hundredth
+    for (d = 0; d < 720; d++)
+    {
+        a = d * M_PI / 180;
+        CHECK(sin100(d) == (s8)lround(sin(a) * 100));
+        CHECK(cos100(d) == (s8)lround(cos(a) * 100));
+    }
+}
+
+static void test_fixedpt(void)
+{
+    ulp_t us = { 0 }, ue = { 0 }, ul = { 0 };
+    fixedpt f;
+    double x;
+    u32 i;
+
+    for (i = 0; i < NTESTS; i++)
+    {
+        f = (fixedpt)lround(uniform(-200.0, 200.0) * 256);
+        x = (s32)f / 256.0;
+        ulp_add(&us, (s32)fixedpt_sin(f), sin(x) * 256);
+        ulp_add(&us, (s32)fixedpt_cos(f), cos(x) * 256);
+
+        f = (fixedpt)lround(uniform(-10.0, 15.0) * 256);
+        ulp_add(&ue, (s32)fixedpt_exp(f), exp((s32)f / 256.0) * 256);
+
+        f = 1 + bench_rand() % (1UL << 31);
+        ulp_add(&ul, (s32)fixedpt_ln(f), log(f / 256.0) * 256);
+    }
+
+    CHECK(ulp_report("fixedpt sin/cos", &us) <= 1.0);
+    CHECK(ulp_report("fixedpt exp", &ue) <= 12.0);
+    CHECK(ulp_report("fixedpt ln", &ul) <= 1.0);
+}
+
+/*  --------------------------------------------------------------------
+    time per call
+    ------------------------------------------------------------------*/
+
+static double dx[NBENCH], dy[NBENCH];
+static s32 ix[NBENCH], iy[NBENCH], qe[NBENCH], ql[NBENCH];
+static volatile double dsink;
+
+#define TIME(expr)  ({ u64 _t = bench_cycles(); u32 _i;                  \
+                       for (_i = 0; _i < NBENCH; _i++) { expr; }        \
+                       (double)(bench_cycles() - _t) / NBENCH; })
+
+static void bench(void)
+{
+    s16 s, c;
+    s32 s31, c31;
+    u32 i;
+
+    for (i = 0; i < NBENCH; i++)
+    {
+        ix[i] = rand31();
+        iy[i] = rand31();
+        dx[i] = ix[i] / Q31;
+        dy[i] = iy[i] / Q31;
+        qe[i] = lround(uniform(-10.0, 11.0) * Q15);
+        ql[i] = 1 + (bench_rand() >> 1);
+    }
+
+    printf("cordic_ulp_" TARGET ": " BENCH_UNIT "/call  sincos15 %.0f, sincos31 %.0f, libm sin+cos %.0f\n",
+        TIME(cordic_sincos15(ix[_i] >> 16, &s, &c); bench_keep(s + c)),
+        TIME(cordic_sincos31(ix[_i], &s31, &c31); bench_keep(s31 + c31)),
+        TIME(dsink = sin(dx[_i] * M_PI) + cos(dx[_i] * M_PI)));
+    printf("cordic_ulp_" TARGET ": " BENCH_UNIT "/call  atan2_15 %.0f, atan2_31 %.0f, libm atan2 %.0f\n",
+        TIME(bench_keep(cordic_atan2_15(iy[_i] >> 16, ix[_i] >> 16))),
+        TIME(bench_keep(cordic_atan2_31(iy[_i], ix[_i]))),
+        TIME(dsink = atan2(dy[_i], dx[_i])));
+    printf("cordic_ulp_" TARGET ": " BENCH_UNIT "/call  hypot15 %.0f, hypot31 %.0f, libm hypot %.0f\n",
+        TIME(bench_keep(cordic_hypot15(iy[_i] >> 16, ix[_i] >> 16))),
+        TIME(bench_keep(cordic_hypot31(iy[_i], ix[_i]))),
+        TIME(dsink = hypot(dy[_i], dx[_i])));
+    printf("cordic_ulp_" TARGET ": " BENCH_UNIT "/call  exp %.0f, libm exp %.0f, ln %.0f, libm log %.0f\n",
+        TIME(bench_keep(cordic_exp(qe[_i], 15))),
+        TIME(dsink = exp(qe[_i] / Q15)),
+        TIME(bench_keep(cordic_ln(ql[_i], 15))),
+        TIME(dsink = log(ql[_i] / Q15)));
+}
+
+int main(void)
+{
+    test_q15();
+    test_q31();
+    test_hyperbolic();
+    test_trigo();
+    test_fixedpt();
+    bench();
+
+    printf("cordic_ulp_" TARGET ": %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
@@ -0,0 +1,358 @@
+/*  --------------------------------------------------------------------
+    dcf77_decode.c - host test of the DCF77 edge decoder
+    --------------------------------------------------------------------
+    Minutes are recorded as the module sends them : a pulse at the
+    start of each second, 100 ms for a 0 and 200 ms for a 1, none at
+    second 59, with a few ms of jitter on every edge. The edges reach
+    DCF77_edge() through intx.c : a fake INTCON and core timer, and
+    Int0Interrupt() called only when the edge is the armed one. The
+    core timer wraps every 107 s, so several times along the test.
+
+    Checked : three valid minutes (the second and third are accepted,
+    the first one only starts the chain), a minute with a parity error
+    and RTClock going on by itself (it used to stay at second 59), a
+    minute without its 59th second marker, and glitches : a late one
+    inside the 300 ms window after a 0, which used to turn it into a 1,
+    and a drop out inside a 1, which must not split it.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>
+#include <bench.h>
+
+// fake external interrupt registers, folded in by intcon_sync()
+u32 INTCON, INTCONSET, INTCONCLR, INTCONINV;
+#define INT_EXTERNAL0           3
+#define INT_EXTERNAL1           7
+#define INT_EXTERNAL2           11
+#define INT_EXTERNAL3           15
+#define INT_EXTERNAL4           19
+#define INT_EXTERNAL0_VECTOR    3
+#define INT_EXTERNAL1_VECTOR    7
+#define INT_EXTERNAL2_VECTOR    11
+#define INT_EXTERNAL3_VECTOR    15
+#define INT_EXTERNAL4_VECTOR    19
+#define INT_RISING_EDGE         1
+#define INT_FALLING_EDGE        0
+
+// fake core timer, SYSCLK / 2
+static u32 core;
+#define ReadCoreTimer()         (core)
+#define GetSystemClock()        80000000UL
+#define TICKS                   40000UL     // per ms
+
+#include <dcf77.c>
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    the module
+    ------------------------------------------------------------------*/
+
+static u32 now;                     // ms since the test started
+static u8 level;                    // module output
+static u32 fired, missed;
+
+static void intcon_sync(void)
+{
+    INTCON |= INTCONSET;
+    INTCON &= ~INTCONCLR;
+    INTCON ^= INTCONINV;
+    INTCONSET = INTCONCLR = INTCONINV = 0;
+}
+
+// the output moves at now + dt ms, the interrupt fires on the armed edge
+static void edge(u32 dt, u8 high)
+{
+    now += dt;
+    core = 0x80000000UL + now * TICKS;
+    if (level == high)
+        return;
+    level = high;
+    intcon_sync();
+    if ((INTCON & 1) != high || !IntEnabled)
+    {
+        missed++;
+        return;
+    }
+    fired++;
+    IntFlag = 1;
+    Int0Interrupt();
+    intcon_sync();
+}
+
+static s8 jitter(void)
+{
+    return (s8)(bench_rand() % 9) - 4;
+}
+
+// a pulse at the start of the second, the output low until its end
+static void pulse(u16 width)
+{
+    s8 j = jitter();
+
+    edge(0, 1);
+    edge(width + j, 0);
+    now += 1000 - width - j;
+}
+
+/*  --------------------------------------------------------------------
+    frames
+    ------------------------------------------------------------------*/
+
+static u8 bits[60];
+
+static u8 bcd(u8 v)
+{
+    return ((v / 10) << 4) | (v % 10);
+}
+
+static void field(u8 first, u8 n, u8 value)
+{
+    u8 i;
+
+    for (i = 0; i < n; i++)
+        bits[first + i] = (value >> i) & 1;
+}
+
+static u8 parity(u8 first, u8 last)
+{
+    u8 i, p = 0;
+
+    for (i = first; i <= last; i++)
+        p ^= bits[i];
+    return p;
+}
+
+static void frame(const Time_Date_Format *t)
+{
+    memset(bits, 0, sizeof(bits));
+    bits[17] = 1;                   // CET
+    bits[20] = 1;                   // start of time
+    field(21, 7, bcd(t->minutes));
+    bits[28] = parity(21, 27);
+    field(29, 6, bcd(t->hours));
+    bits[35] = parity(29, 34);
+    field(36, 6, bcd(t->dayofmonth));
+    field(42, 3, t->dayofweek);
+    field(45, 5, bcd(t->month));
+    field(50, 8, bcd(t->year));
+    bits[58] = parity(36, 57);
+}
+
+// seconds 0 to 58, the gap of second 59 and the next minute mark,
+// where the frame is decoded
+static void send(void)
+{
+    u8 s;
+
+    for (s = 0; s < 59; s++)
+        pulse(bits[s] ? 200 : 100);
+    now += 1000;
+    edge(0, 1);
+}
+
+static void next(Time_Date_Format *t)
+{
+    DCF77_nextMinute(t);
+}
+
+static u8 same(const Time_Date_Format *a, const Time_Date_Format *b)
+{
+    return a->minutes == b->minutes && a->hours == b->hours &&
+           a->dayofmonth == b->dayofmonth && a->dayofweek == b->dayofweek &&
+           a->month == b->month && a->year == b->year;
+}
+
+/*  --------------------------------------------------------------------
+    tests
+    ------------------------------------------------------------------*/
+
+// 19 Oct. 2026, a Monday, 23:58
+static Time_Date_Format t0 = { 0, 58, 23, 1, 19, 10, 26, 0 };
+
+static void test_valid(void)
+{
+    Time_Date_Format t;
+
+    DCF77_start(0);
+    CHECK(gIntx[0] == DCF77_interrupt && IntEnabled);
+    intcon_sync();
+    CHECK(INTCON & 1);              // first edge is rising
+
+    // a few seconds of the end of a minute, then the minute mark
+    now = 55000;
+    pulse(100);
+    pulse(100);
+    pulse(200);
+    now += 1000;
+    edge(0, 1);
+
+    memcpy(&t, &t0, sizeof(t));
+    frame(&t);
+    send();                         // decoded, nothing to compare with
+    CHECK(gDCF77Valid && !DCF77_available());
+    CHECK(same(&gDCF77Prev, &t0));
+
+    next(&t);
+    frame(&t);
+    send();                         // 23:59, accepted
+    CHECK(DCF77_available());
+    CHECK(same(&DCF77, &t));
+    CHECK(!DCF77_available());
+
+    next(&t);
+    frame(&t);
+    send();                         // 00:00 on the 20th
+    CHECK(DCF77_available());
+    CHECK(DCF77.hours == 0 && DCF77.minutes == 0 && DCF77.dayofmonth == 20);
+    CHECK(DCF77.dayofweek == 2);
+    CHECK(RTClock.seconds == 0 && RTClock.nosync == 0);
+    CHECK(missed == 0 && fired > 6 * 59);
+}
+
+static void test_parity(void)
+{
+    Time_Date_Format t;
+
+    memcpy(&t, &DCF77, sizeof(t));
+
+    next(&t);
+    frame(&t);
+    bits[23] ^= 1;                  // minutes wrong, P1 doesn't match
+    send();
+    CHECK(!DCF77_available());
+
+    // RTClock went on by itself
+    CHECK(same(&RTClock, &t) && RTClock.seconds == 0);
+
+    next(&t);
+    frame(&t);
+    send();                         // the chain goes on
+    CHECK(DCF77_available() && same(&DCF77, &t));
+
+    // an even number of errors goes through the parities, but not
+    // through the comparison with the previous minute
+    next(&t);
+    frame(&t);
+    bits[21] ^= 1;
+    bits[22] ^= 1;
+    send();
+    CHECK(!DCF77_available());
+}
+
+static void test_marker(void)
+{
+    Time_Date_Format t;
+    u8 s;
+
+    // resync on two good minutes
+    memcpy(&t, &t0, sizeof(t));
+    frame(&t);
+    send();
+    next(&t);
+    frame(&t);
+    send();
+    CHECK(DCF77_available());
+
+    // a pulse at second 59 : no minute mark
+    next(&t);
+    frame(&t);
+    for (s = 0; s < 59; s++)
+        pulse(bits[s] ? 200 : 100);
+    pulse(100);
+    edge(0, 1);                     // 1 s later, bit 59 is one too many
+    CHECK(gDCF77Bit == DCF77_UNKNOWN);
+    CHECK(!DCF77_available());
+
+    // the next minute starts without its mark : lost too
+    next(&t);
+    frame(&t);
+    send();
+    CHECK(!DCF77_available());
+
+    // gDCF77Prev missed a minute, this one only starts the chain again
+    next(&t);
+    frame(&t);
+    send();
+    CHECK(!DCF77_available() && same(&gDCF77Prev, &t));
+
+    next(&t);
+    frame(&t);
+    send();
+    CHECK(DCF77_available() && same(&DCF77, &t));
+}
+
+static void test_glitch(void)
+{
+    Time_Date_Format t;
+    u8 s;
+
+    memcpy(&t, &DCF77, sizeof(t));
+
+    next(&t);
+    frame(&t);
+    for (s = 0; s < 59; s++)
+    {
+        if (s == 21 || s == 30)
+        {
+            // a 0, then a 5 ms glitch at 250 ms
+            CHECK(bits[s] == 0);
+            edge(0, 1);
+            edge(100, 0);
+            edge(150, 1);
+            edge(5, 0);
+            now += 1000 - 255;
+        }
+        else if (s == 20 || s == 17)
+        {
+            // a 1 with a 10 ms drop out at 120 ms
+            CHECK(bits[s] == 1);
+            edge(0, 1);
+            edge(120, 0);
+            edge(10, 1);
+            edge(70, 0);
+            now += 1000 - 200;
+        }
+        else
+            pulse(bits[s] ? 200 : 100);
+    }
+    now += 1000;
+    edge(0, 1);
+    CHECK(DCF77_available() && same(&DCF77, &t));
+
+    // the glitch on its own, just after the mark
+    CHECK(DCF77_classify(100) == 0 && DCF77_classify(255) == 1);
+}
+
+static void test_line(void)
+{
+    // a line taken by another library, then given back by a restart
+    DCF77_start(0);
+    CHECK(gDCF77Line == 0);
+    DCF77_start(1);
+    CHECK(gDCF77Line == 1 && gIntx[0] == NULL && gIntx[1] == DCF77_interrupt);
+    IntxDetach(1);
+    CHECK(IntxAttach(1, DCF77_interrupt, INT_RISING_EDGE));
+    DCF77_start(5);
+    CHECK(gDCF77Line == INTX_LINES && gIntx[1] == NULL);
+}
+
+int main(void)
+{
+    test_valid();
+    test_parity();
+    test_marker();
+    test_glitch();
+    test_line();
+
+    printf("dcf77_decode: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
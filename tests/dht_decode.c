@@ -0,0 +1,313 @@
+/*  --------------------------------------------------------------------
+    dht_decode.c - host test of the DHT11 / DHT22 answer decoder
+    --------------------------------------------------------------------
+    Frames are built as the sensors send them, with the pulse lengths
+    of their datasheets and a few us of jitter on each pulse, turned
+    into the core timer timestamps the interrupt records, and decoded
+    by KS_DHTDecode(). The timer wraps in the middle of some of them.
+
+    Checked : DHT22 and DHT11 values, negative temperatures, a frame
+    with a bad checksum, answers cut short (no response, truncated
+    response, truncated data) and a zero length pulse.
+
+    The interrupt capture runs too, through intx.c, with a fake INTCON
+    and a fake core timer : start signal, release, edges fed to the
+    Int0Interrupt() handler only when their polarity is the armed one,
+    a sensor which stops answering (timeout after 10 ms), and a line
+    already taken by another library.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>
+#include <bench.h>
+
+// fake external interrupt registers, folded in by intcon_sync()
+u32 INTCON, INTCONSET, INTCONCLR, INTCONINV;
+#define INT_EXTERNAL0           3
+#define INT_EXTERNAL1           7
+#define INT_EXTERNAL2           11
+#define INT_EXTERNAL3           15
+#define INT_EXTERNAL4           19
+#define INT_EXTERNAL0_VECTOR    3
+#define INT_EXTERNAL1_VECTOR    7
+#define INT_EXTERNAL2_VECTOR    11
+#define INT_EXTERNAL3_VECTOR    15
+#define INT_EXTERNAL4_VECTOR    19
+#define INT_RISING_EDGE         1
+#define INT_FALLING_EDGE        0
+
+// fake core timer (40 MHz) and millis()
+static u32 core;
+static u32 ms;
+#define ReadCoreTimer()         (core)
+#define __MILLIS__
+#define millis()                (ms)
+
+// fake DHT pin, the MCU drives it low or releases it
+#define __DIGITALW_C
+static u8 mcu_low, sensor_low;
+#define pinmode(pin, dir)       ((void)(pin), mcu_low = ((dir) == OUTPUT))
+#define digitalwrite(pin, s)    ((void)(pin))
+#define digitalread(pin)        ((void)(pin), !(mcu_low || sensor_low))
+
+#define KS_DHTASYNC
+#include <ks_dht.c>
+
+#define TICKS       40              // core timer ticks per us
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+#define ABOUT(a, b) ((a) - (b) < 0.01 && (b) - (a) < 0.01)
+
+/*  --------------------------------------------------------------------
+    frames : pulse lengths in us, low then high, from the response on
+    ------------------------------------------------------------------*/
+
+static u16 pulses[KS_DHTEDGES + 1];
+
+static s16 jitter(u8 us)
+{
+    return (s16)(bench_rand() % (2 * us + 1)) - us;
+}
+
+// DHT22 : response 80 + 80, bits 50 low + 26 (0) or 70 (1) high
+// DHT11 : response 80 + 80, bits 50 low + 28 (0) or 70 (1) high
+static void frame(const u8 *dat, u8 type)
+{
+    u8 i, n = 0;
+
+    pulses[n++] = 80 + jitter(5);
+    pulses[n++] = 80 + jitter(5);
+    for (i = 0; i < 40; i++)
+    {
+        pulses[n++] = 50 + jitter(4);
+        if (dat[i >> 3] & (0x80 >> (i & 7)))
+            pulses[n++] = 70 + jitter(4);
+        else
+            pulses[n++] = (type == KS_DHT11 ? 28 : 26) + jitter(4);
+    }
+    pulses[n++] = 50;               // end of the last bit
+}
+
+// timestamps of the first n edges, the first one at t0
+static void stamps(KS_DHTTIME *edge, u8 n, u32 t0)
+{
+    u32 t = t0;
+    u8 i;
+
+    for (i = 0; i < n; i++)
+    {
+        edge[i] = t;
+        t += pulses[i] * TICKS;
+    }
+}
+
+static void checksum(u8 *dat)
+{
+    dat[4] = dat[0] + dat[1] + dat[2] + dat[3];
+}
+
+/*  --------------------------------------------------------------------
+    KS_DHTDecode
+    ------------------------------------------------------------------*/
+
+static void test_decode(void)
+{
+    KS_DHTTIME edge[KS_DHTEDGES];
+    KS_DHT_Data dh;
+    u8 dat[5], out[5];
+    u32 t0;
+    int k;
+
+    // DHT22, 65.2 %, 23.1 C, timer wrapping anywhere in the frame
+    dat[0] = 0x02; dat[1] = 0x8C; dat[2] = 0x00; dat[3] = 0xE7;
+    checksum(dat);
+    for (k = 0; k < 200; k++)
+    {
+        frame(dat, KS_DHT22);
+        t0 = 0x10000 - (bench_rand() % 0x3000) * 40;
+        stamps(edge, KS_DHTEDGES, t0);
+        memset(out, 0, 5);
+        CHECK(KS_DHTDecode(edge, KS_DHTEDGES, out) == 0);
+        CHECK(memcmp(out, dat, 5) == 0);
+    }
+    KS_DHTConvert(out, KS_DHT22, &dh);
+    CHECK(ABOUT(dh.hum, 65.2) && ABOUT(dh.temp, 23.1) && dh.sign == 0);
+
+    // DHT22, -10.1 C : sign and magnitude, not 2's complement
+    dat[0] = 0x01; dat[1] = 0xF4; dat[2] = 0x80; dat[3] = 0x65;
+    checksum(dat);
+    frame(dat, KS_DHT22);
+    stamps(edge, KS_DHTEDGES, 12345);
+    CHECK(KS_DHTDecode(edge, KS_DHTEDGES, out) == 0);
+    KS_DHTConvert(out, KS_DHT22, &dh);
+    CHECK(ABOUT(dh.hum, 50.0) && ABOUT(dh.temp, 10.1) && dh.sign == 1);
+
+    // DHT11, 45.0 %, 21.5 C
+    dat[0] = 45; dat[1] = 0; dat[2] = 21; dat[3] = 5;
+    checksum(dat);
+    frame(dat, KS_DHT11);
+    stamps(edge, KS_DHTEDGES, 0xFF00);
+    CHECK(KS_DHTDecode(edge, KS_DHTEDGES, out) == 0);
+    KS_DHTConvert(out, KS_DHT11, &dh);
+    CHECK(ABOUT(dh.hum, 45.0) && ABOUT(dh.temp, 21.5) && dh.sign == 0);
+
+    // one bit flipped on the way : checksum error
+    dat[0] = 0x02; dat[1] = 0x8C; dat[2] = 0x00; dat[3] = 0xE7;
+    checksum(dat);
+    dat[1] ^= 0x04;
+    frame(dat, KS_DHT22);
+    stamps(edge, KS_DHTEDGES, 0);
+    CHECK(KS_DHTDecode(edge, KS_DHTEDGES, out) == 7);
+
+    // answers cut short by the timeout
+    dat[1] ^= 0x04;
+    frame(dat, KS_DHT22);
+    stamps(edge, KS_DHTEDGES, 0);
+    CHECK(KS_DHTDecode(edge, 0, out) == 2);
+    CHECK(KS_DHTDecode(edge, 2, out) == 3);
+    CHECK(KS_DHTDecode(edge, 3, out) == 5);
+    CHECK(KS_DHTDecode(edge, KS_DHTEDGES - 1, out) == 5);
+
+    // two edges with the same timestamp
+    edge[40] = edge[41];
+    CHECK(KS_DHTDecode(edge, KS_DHTEDGES, out) == 6);
+}
+
+/*  --------------------------------------------------------------------
+    interrupt capture
+    ------------------------------------------------------------------*/
+
+static void intcon_sync(void)
+{
+    INTCON |= INTCONSET;
+    INTCON &= ~INTCONCLR;
+    INTCON ^= INTCONINV;
+    INTCONSET = INTCONCLR = INTCONINV = 0;
+}
+
+static u32 fired, missed;
+
+// the sensor moves the line, the interrupt fires on the armed edge
+static void sensor_edge(u8 line, u8 low)
+{
+    u8 before = !(mcu_low || sensor_low);
+
+    sensor_low = low;
+    if (before == !(mcu_low || sensor_low))
+        return;
+    intcon_sync();
+    if (((INTCON >> line) & 1) != !low || !IntEnabled)
+    {
+        missed++;
+        return;
+    }
+    fired++;
+    IntFlag = 1;
+    Int0Interrupt();
+    intcon_sync();
+}
+
+// the sensor answers n pulses of the frame, then stops
+static void answer(u8 n)
+{
+    u8 i;
+
+    core += 30 * TICKS;             // sensor waits 20-40 us
+    for (i = 0; i < n; i++)
+    {
+        sensor_edge(0, !(i & 1));
+        core += pulses[i] * TICKS;
+    }
+    sensor_edge(0, 0);              // released
+}
+
+static void other(u8 line, u8 level) { (void)line; (void)level; }
+
+static void test_capture(void)
+{
+    KS_DHT_Data dh;
+    u8 dat[5];
+    int k;
+
+    IntEnabled = 0;
+    core = 0xFFFF0000;
+    ms = 100;
+
+    CHECK(KS_DHTStart(KS_DHTLINES, 7, KS_DHT22) == false);
+    CHECK(KS_DHTStart(200, 7, KS_DHT22) == false);
+
+    // a full DHT22 answer
+    dat[0] = 0x02; dat[1] = 0x8C; dat[2] = 0x00; dat[3] = 0xE7;
+    checksum(dat);
+    frame(dat, KS_DHT22);
+
+    CHECK(KS_DHTStart(0, 7, KS_DHT22) == true);
+    CHECK(mcu_low && IntEnabled);
+    CHECK(KS_DHTStart(0, 7, KS_DHT22) == false);    // busy
+    KS_DHTService();
+    CHECK(gDHT[0].state == KS_DHT_START);           // start signal
+    ms += 2;
+    KS_DHTService();
+    CHECK(gDHT[0].state == KS_DHT_CAPTURE && !mcu_low);
+    CHECK(fired == 0);                              // release not seen
+
+    answer(KS_DHTEDGES);
+    CHECK(gDHT[0].n == KS_DHTEDGES);
+    CHECK(missed == 0);
+    KS_DHTService();
+    CHECK(KS_DHTAvailable(0));
+    CHECK(gIntx[0] == NULL && !IntEnabled);         // line given back
+    CHECK(KS_DHTGet(0, &dh) == 0);
+    CHECK(ABOUT(dh.hum, 65.2) && ABOUT(dh.temp, 23.1));
+    CHECK(!KS_DHTAvailable(0));
+
+    // the sensor stops after 20 bits : timeout
+    frame(dat, KS_DHT22);
+    CHECK(KS_DHTStart(0, 7, KS_DHT22) == true);
+    ms += 2;
+    KS_DHTService();
+    answer(2 + 2 * 20);
+    for (k = 0; k < 9; k++)
+    {
+        ms++;
+        KS_DHTService();
+        CHECK(!KS_DHTAvailable(0));
+    }
+    ms++;
+    KS_DHTService();
+    CHECK(KS_DHTAvailable(0));
+    CHECK(KS_DHTGet(0, &dh) == 5 && dh.dht_error == 5);
+    CHECK(gIntx[0] == NULL);
+
+    // no answer at all
+    CHECK(KS_DHTStart(0, 7, KS_DHT22) == true);
+    ms += 2;
+    KS_DHTService();
+    ms += 10;
+    KS_DHTService();
+    CHECK(KS_DHTGet(0, &dh) == 2);
+
+    // line already taken by another library, the pin is released
+    CHECK(IntxAttach(0, other, INT_RISING_EDGE) == true);
+    CHECK(KS_DHTStart(0, 7, KS_DHT22) == false);
+    CHECK(!mcu_low && gDHT[0].state == KS_DHT_IDLE);
+    IntxDetach(0);
+    CHECK(KS_DHTStart(0, 7, KS_DHT22) == true);
+}
+
+int main(void)
+{
+    test_decode();
+    test_capture();
+
+    printf("dht_decode: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
@@ -0,0 +1,249 @@
+/*  --------------------------------------------------------------------
+    gpio_fold.c - host test and benchmark of the PIC32 GPIO folding
+    --------------------------------------------------------------------
+    The real digitalw.c and portgroup.c are built for a PINGUINO32MX250
+    against fake TRIS, PORT and LAT registers, laid out as on the chip
+    (x, xCLR, xSET, xINV, 0x10 bytes apart), volatile as the SFR are.
+
+    Checked : high, low, toggle and digitalread with a constant pin
+    touch the pin's register only and give the same results as with a
+    pin held in a variable, for every pin of the board. PortGroup
+    write, read and mode on a packed and a scattered group.
+
+    Measured : cycles per call with a constant pin and with a variable
+    one, a 4-bit PortGroup write against 4 digitalwrite(). Host figures
+    compare both paths, they aren't PIC32 cycles, and they move with
+    the flags (-Os keeps the calls out of line), the order doesn't.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>
+#include <bench.h>
+
+// fake registers, [port][x, xCLR, xSET, xINV, PORTx..., LATx...]
+static volatile u32 regs[7][16];
+#define TRISA                   regs[0][0]
+#define TRISACLR                regs[0][1]
+#define TRISASET                regs[0][2]
+#define PORTA                   regs[0][4]
+#define LATACLR                 regs[0][9]
+#define LATASET                 regs[0][10]
+#define LATAINV                 regs[0][11]
+#define TRISB                   regs[1][0]
+#define TRISBCLR                regs[1][1]
+#define TRISBSET                regs[1][2]
+#define PORTB                   regs[1][4]
+#define LATBCLR                 regs[1][9]
+#define LATBSET                 regs[1][10]
+#define LATBINV                 regs[1][11]
+
+// the real pin tables and functions, not the stand-ins of p32/
+#define PINGUINO32MX250
+#define __32MX250F128B__
+#include "../p32/include/pinguino/core/digital.h"
+#include "../p32/include/pinguino/core/digitalw.c"
+#include <portgroup.c>
+
+#define NPINS       15
+#define LOOPS       1000
+#define RUNS        200
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    fake ports
+    ------------------------------------------------------------------*/
+
+static u32 before[7][16];
+
+// the SET, CLR and INV stores folded into the x registers
+static void sync(void)
+{
+    int p, r;
+
+    for (p = 0; p < 7; p++)
+        for (r = 0; r < 16; r += 4)
+        {
+            regs[p][r] = ((regs[p][r] | regs[p][r + 2]) & ~regs[p][r + 1]) ^ regs[p][r + 3];
+            regs[p][r + 1] = regs[p][r + 2] = regs[p][r + 3] = 0;
+        }
+}
+
+static void snapshot(void)
+{
+    memcpy(before, (void *)regs, sizeof(before));
+}
+
+// registers written since snapshot()
+static int written(int *p, int *r)
+{
+    int i, j, n = 0;
+
+    for (i = 0; i < 7; i++)
+        for (j = 0; j < 16; j++)
+            if (regs[i][j] != before[i][j])
+            {
+                *p = i;
+                *r = j;
+                n++;
+            }
+    return n;
+}
+
+/*  --------------------------------------------------------------------
+    constant pins
+    ------------------------------------------------------------------*/
+
+// one register, the right one : LATxSET, LATxCLR or LATxINV = mask
+#define ONESTORE(call, reg)                                             \
+    do {                                                                \
+        int p, r;                                                       \
+        memset((void *)regs, 0, sizeof(regs));                          \
+        snapshot();                                                     \
+        call;                                                           \
+        CHECK(written(&p, &r) == 1);                                    \
+        CHECK(p == port[PIN] && r == (reg) && regs[p][r] == mask[PIN]); \
+    } while (0)
+
+#define PIN 12
+static void test_fold12(void) { ONESTORE(high(PIN), 10); ONESTORE(low(PIN), 9); ONESTORE(toggle(PIN), 11); }
+#undef PIN
+#define PIN 7
+static void test_fold7(void)  { ONESTORE(high(PIN), 10); ONESTORE(low(PIN), 9); ONESTORE(toggle(PIN), 11); }
+#undef PIN
+
+// every pin, folded and called give the same ports
+#define SAME(k)                                                         \
+    do {                                                                \
+        memset((void *)regs, 0, sizeof(regs));                          \
+        high(k); sync(); toggle(k); sync(); toggle(k); sync();          \
+        regs[port[k]][4] = regs[port[k]][8];                            \
+        CHECK(digitalread(k) == 1);                                     \
+        memcpy(folded, (void *)regs, sizeof(folded));                   \
+        memset((void *)regs, 0, sizeof(regs));                          \
+        (high)(pin); sync();                                            \
+        (toggle)(pin); sync(); (toggle)(pin); sync();                   \
+        regs[port[k]][4] = regs[port[k]][8];                            \
+        CHECK((digitalread)(pin) == 1);                                 \
+        CHECK(memcmp(folded, (void *)regs, sizeof(folded)) == 0);       \
+        low(k); sync();                                                 \
+        CHECK(regs[port[k]][8] == 0);                                   \
+        pin++;                                                          \
+    } while (0)
+
+static void test_same(void)
+{
+    static u32 folded[7][16];
+    volatile int pin = 0;
+
+    SAME(0);  SAME(1);  SAME(2);  SAME(3);  SAME(4);
+    SAME(5);  SAME(6);  SAME(7);  SAME(8);  SAME(9);
+    SAME(10); SAME(11); SAME(12); SAME(13); SAME(14);
+    CHECK(pin == NPINS);
+}
+
+/*  --------------------------------------------------------------------
+    PortGroup
+    ------------------------------------------------------------------*/
+
+static void test_portgroup(void)
+{
+    static const u8 packed[4] = { 12, 11, 10, 9 };  // RB0 to RB3
+    static const u8 scattered[4] = { 5, 12, 0, 3 }; // RB7, RB0, RB15, RB9
+    static const u8 mixed[2] = { 12, 13 };          // RB0, RA0
+    PortGroup g;
+    u16 v;
+    int p, r;
+
+    memset((void *)regs, 0, sizeof(regs));
+    CHECK(!portgroup_init(&g, mixed, 2));
+    CHECK(portgroup_init(&g, packed, 4) && g.packed && g.shift == 0);
+    CHECK(portgroup_init(&g, scattered, 4) && !g.packed);
+
+    // mode : one TRISxSET or TRISxCLR store
+    snapshot();
+    portgroup_mode(&g, OUTPUT);
+    CHECK(written(&p, &r) == 1 && p == pB && r == 1 && regs[p][r] == g.mask);
+
+    // write : one LATxINV store, the other pins of the port kept
+    regs[pB][8] = 0x0421;
+    for (v = 0; v < 16; v++)
+    {
+        snapshot();
+        portgroup_write(&g, v);
+        CHECK(written(&p, &r) <= 1);
+        sync();
+        CHECK((regs[pB][8] & ~g.mask) == (0x0421 & ~g.mask));
+        regs[pB][4] = regs[pB][8];
+        CHECK(portgroup_read(&g) == v);
+        CHECK((digitalread)(scattered[0]) == (v & 1));
+        CHECK((digitalread)(scattered[3]) == ((v >> 3) & 1));
+    }
+}
+
+/*  --------------------------------------------------------------------
+    benchmark, cycles per call, best of RUNS
+    ------------------------------------------------------------------*/
+
+#define BEST(best, body)                                                \
+    do {                                                                \
+        int k, i;                                                       \
+        u64 t;                                                          \
+        best = ~0ULL;                                                   \
+        for (k = 0; k < RUNS; k++)                                      \
+        {                                                               \
+            t = bench_cycles();                                         \
+            for (i = 0; i < LOOPS; i++)                                 \
+                body;                                                   \
+            t = bench_cycles() - t;                                     \
+            if (t < best)                                               \
+                best = t;                                               \
+        }                                                               \
+    } while (0)
+
+static void bench(void)
+{
+    static const u8 packed[4] = { 12, 11, 10, 9 };
+    volatile int pin = 12;
+    u64 folded, called, group, single;
+    PortGroup g;
+    u8 b;
+
+    BEST(folded, toggle(12));
+    BEST(called, toggle(pin));
+    printf("gpio_fold: toggle(12)            %5.1f %s, toggle(pin)          %5.1f\n",
+        (double)folded / LOOPS, BENCH_UNIT, (double)called / LOOPS);
+    CHECK(folded < called);
+
+    BEST(folded, digitalwrite(12, i & 1));
+    BEST(called, digitalwrite(pin, i & 1));
+    printf("gpio_fold: digitalwrite(12, s)   %5.1f %s, digitalwrite(pin, s) %5.1f\n",
+        (double)folded / LOOPS, BENCH_UNIT, (double)called / LOOPS);
+    CHECK(folded < called);
+
+    portgroup_init(&g, packed, 4);
+    BEST(group, portgroup_write(&g, i));
+    BEST(single, for (b = 0; b < 4; b++) digitalwrite(packed[b], (i >> b) & 1));
+    printf("gpio_fold: portgroup_write(4)    %5.1f %s, 4 digitalwrite(pin)  %5.1f\n",
+        (double)group / LOOPS, BENCH_UNIT, (double)single / LOOPS);
+    CHECK(group < single);
+}
+
+int main(void)
+{
+    test_fold12();
+    test_fold7();
+    test_same();
+    test_portgroup();
+    bench();
+
+    printf("gpio_fold: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
@@ -0,0 +1,47 @@
+/*  --------------------------------------------------------------------
+    bench.h - timing helpers for the host benchmarks
+    --------------------------------------------------------------------
+    bench_cycles() reads the time stamp counter on x86, elsewhere it
+    falls back to nanoseconds. Host figures only compare algorithms,
+    they don't predict the cycles of a PIC, where float operations are
+    software routines.
+    ------------------------------------------------------------------*/
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT  "cycles"
+static inline uint64_t bench_cycles(void)
+{
+    return __rdtsc();
+}
+#else
+#define BENCH_UNIT  "ns"
+static inline uint64_t bench_cycles(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+// keeps the compiler from optimizing a result away
+static volatile uint32_t bench_sink;
+#define bench_keep(x)   (bench_sink += (uint32_t)(x))
+
+// xorshift32, same sequence on every run
+static uint32_t bench_seed = 2463534242UL;
+static inline uint32_t bench_rand(void)
+{
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+    return bench_seed;
+}
+
+#endif /* __BENCH_H */
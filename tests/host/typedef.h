@@ -0,0 +1,43 @@
+/*  --------------------------------------------------------------------
+    typedef.h - host stand-in for the P8 and P32 typedef.h
+    u32 is 32-bit on the targets, force the same widths on a 64-bit host
+    ------------------------------------------------------------------*/
+
+#ifndef __TYPEDEF_H
+#define __TYPEDEF_H
+
+#include <stdint.h>
+
+typedef int8_t      s8;
+typedef int16_t     s16;
+typedef int32_t     s32;
+typedef int64_t     s64;
+typedef uint8_t     u8;
+typedef uint16_t    u16;
+typedef uint32_t    u32;
+typedef uint64_t    u64;
+
+typedef union
+{
+    u16 w;
+    struct
+    {
+        u8 l8;
+        u8 h8;
+    };
+} t16;
+
+typedef void (*funcout) (u8);
+typedef void (*funcwrite) (const u8 *, u16);
+
+typedef unsigned char BOOL;
+typedef unsigned char boolean;
+
+#ifndef false
+#define false       0
+#endif
+#ifndef true
+#define true        !false
+#endif
+
+#endif /* __TYPEDEF_H */
@@ -0,0 +1,321 @@
+/*  --------------------------------------------------------------------
+    keypad_scan.c - host test of the keypad background scanner
+    --------------------------------------------------------------------
+    Keypad_sample() and Keypad_sampleColumn() are fed bouncing
+    contacts, then Keypad_scan() runs against a fake 4x4 matrix : rows
+    on RB0..RB3 with pull-ups, columns on RD0..RD3 pulled low by
+    clearing their TRIS bit. The matrix is wired with or without a
+    diode in series with each key.
+
+    Checked : a single press, hold and release event for a contact
+    bouncing on both edges, glitches shorter than the debounce time,
+    the debounce and hold times converted to ticks (1000 ms at 1 ms
+    used to be truncated to a u8), several keys down at once, the
+    ghost key of a matrix without diodes, the idle read and the queue
+    overflow.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>
+
+// fake ports, TRIS, TRISCLR, TRISSET, TRISINV, PORT, ... as on a PIC32
+static u32 regs[7][16];
+#define TRISA                   regs[0][0]
+#define TRISB                   regs[1][0]
+#define TRISC                   regs[2][0]
+#define TRISD                   regs[3][0]
+#define TRISE                   regs[4][0]
+#define TRISF                   regs[5][0]
+#define TRISG                   regs[6][0]
+
+// pins 0-3 are RB0-RB3 (rows), pins 4-7 are RD0-RD3 (columns)
+#define __DIGITALW_C
+#define pB                      1
+#define pD                      3
+static const u8 port[8] = { pB, pB, pB, pB, pD, pD, pD, pD };
+static const u16 mask[8] = { 1, 2, 4, 8, 1, 2, 4, 8 };
+#define pinmode(pin, dir)       ((void)(pin), (void)(dir))
+#define digitalwrite(pin, s)    ((void)(pin), (void)(s))
+#define digitalread(pin)        ((void)(pin), 1)
+
+static u32 ms;
+#define millis()                (ms)
+
+// the reads are done after the columns settle
+#include <macro.h>
+#undef nop
+static void matrix_update(void);
+#define nop()                   matrix_update()
+
+#define KEYPADSCAN
+#include <keypad.c>
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    fake matrix
+    ------------------------------------------------------------------*/
+
+static u8 closed[4][4];             // [row][column]
+static u8 diodes;
+static u32 reads;                   // port snapshots taken
+
+#define SNAPSHOTS(n)    ((n) * 4)   // Keypad_settle() is 4 nop()
+
+static void matrix_update(void)
+{
+    u8 low[8], r, c, more;
+    u32 *t;
+    int p;
+
+    // between two reads the scanner releases columns then drives others
+    for (p = 0; p < 7; p++)
+    {
+        t = regs[p];
+        t[0] = (t[0] | t[2]) & ~t[1];
+        t[1] = t[2] = 0;
+    }
+
+    // a column is low when its pin is an output (latch is low)
+    for (c = 0; c < 4; c++)
+        low[4 + c] = !(TRISD & (1 << c));
+    for (r = 0; r < 4; r++)
+        low[r] = 0;
+
+    // rows pulled down through the closed keys, and without diodes
+    // columns pulled down by the rows as well
+    do
+    {
+        more = 0;
+        for (r = 0; r < 4; r++)
+            for (c = 0; c < 4; c++)
+                if (closed[r][c])
+                {
+                    if (low[4 + c] && !low[r])
+                        low[r] = more = 1;
+                    if (!diodes && low[r] && !low[4 + c])
+                        low[4 + c] = more = 1;
+                }
+    } while (more);
+
+    regs[pB][4] = 0xFFFF;
+    for (r = 0; r < 4; r++)
+        if (low[r])
+            regs[pB][4] &= ~(1 << r);
+    reads++;
+}
+
+static u8 keys[16] = "123A456B789C*0#D";
+static u8 rowPins[4] = { 0, 1, 2, 3 };
+static u8 colPins[4] = { 4, 5, 6, 7 };
+
+static void start(u16 debounce, u16 hold, u8 period)
+{
+    memset(closed, 0, sizeof(closed));
+    TRISB = TRISD = 0xFFFF;
+    Keypad_init(keys, rowPins, colPins, 4, 4);
+    Keypad_setDebounceTime(debounce);
+    Keypad_setHoldTime(hold);
+    CHECK(Keypad_startScan(period));
+}
+
+// events left in the queue, as status << 6 | key index
+static u8 events(u8 *e)
+{
+    u8 n = 0;
+
+    while (Keypad_available() && n < 32)
+        e[n++] = Keypad_getEvent();
+    return n;
+}
+
+/*  --------------------------------------------------------------------
+    debounce core
+    ------------------------------------------------------------------*/
+
+static void test_bounce(void)
+{
+    static const u8 press[]   = { 1, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1 };
+    static const u8 release[] = { 0, 1, 0, 0, 1, 0, 0, 0, 0 };
+    u8 e[32], i, n;
+
+    start(20, 1000, 5);                 // 4 samples, 200 ticks
+    CHECK(keypadScan.debounce == 0x0F);
+    CHECK(keypadScan.holdTicks == 200);
+
+    // pressed on the 4th closed sample in a row, once
+    for (i = 0; i < sizeof(press); i++)
+    {
+        Keypad_sample(5, press[i]);
+        CHECK(!!(keypadScan.flags[5] & KEYPAD_DOWN) == (i == sizeof(press) - 1));
+    }
+    n = events(e);
+    CHECK(n == 1 && e[0] == KEYPAD_EVENT(PRESSED, 5));
+    CHECK(keypad.lastKey == '5' && Keypad_isPressed('5'));
+
+    // open glitches while down are ignored, then hold once
+    for (i = 0; i < 250; i++)
+        Keypad_sample(5, (i % 3) != 0);
+    n = events(e);
+    CHECK(n == 1 && e[0] == KEYPAD_EVENT(HOLD, 5));
+
+    // released on the 4th open sample in a row, once
+    for (i = 0; i < sizeof(release); i++)
+        Keypad_sample(5, release[i]);
+    n = events(e);
+    CHECK(n == 1 && e[0] == KEYPAD_EVENT(RELEASED, 5));
+    CHECK(keypad.lastKey == NO_KEY && !Keypad_isPressed('5'));
+
+    // a closed glitch shorter than the debounce time gives nothing
+    Keypad_sample(5, 1);
+    Keypad_sample(5, 1);
+    Keypad_sample(5, 1);
+    CHECK(Keypad_sample(5, 0) != 0);    // not settled yet
+    for (i = 0; i < 6; i++)
+        Keypad_sample(5, 0);
+    CHECK(Keypad_sample(5, 0) == 0);    // 8 open samples
+    CHECK(!Keypad_available());
+}
+
+static void test_ticks(void)
+{
+    // 256 and 1000 ms used to wrap in a u8 : 1 sample instead of 8
+    start(256, 60000, 1);
+    CHECK(keypadScan.debounce == 0xFF);
+    CHECK(keypadScan.holdTicks == 255);
+    start(1000, 1000, 1);
+    CHECK(keypadScan.debounce == 0xFF);
+
+    // shorter than a period : a single sample
+    start(2, 0, 5);
+    CHECK(keypadScan.debounce == 0x01);
+    CHECK(keypadScan.holdTicks == 1);
+
+    // too big a keypad is not scanned
+    Keypad_init(keys, rowPins, colPins, 9, 4);
+    CHECK(!Keypad_startScan(5));
+    Keypad_scan();
+    CHECK(!Keypad_available());
+}
+
+static void test_column(void)
+{
+    u8 e[32], i, n;
+
+    start(10, 60000, 5);                // 2 samples
+
+    // rows 0 and 3 of column 2 : keys 2 and 14, other columns untouched
+    for (i = 0; i < 2; i++)
+        CHECK(Keypad_sampleColumn(2, 0x09) != 0);
+    n = events(e);
+    CHECK(n == 2);
+    CHECK(e[0] == KEYPAD_EVENT(PRESSED, 2) && e[1] == KEYPAD_EVENT(PRESSED, 14));
+    CHECK(Keypad_isPressed('3') && Keypad_isPressed('#'));
+    CHECK(!Keypad_isPressed('2') && !Keypad_isPressed('9'));
+
+    // row 0 opens, row 3 stays down
+    for (i = 0; i < 2; i++)
+        CHECK(Keypad_sampleColumn(2, 0x08) != 0);
+    n = events(e);
+    CHECK(n == 1 && e[0] == KEYPAD_EVENT(RELEASED, 2));
+
+    for (i = 0; i < 7; i++)
+        CHECK(Keypad_sampleColumn(2, 0x00) != 0);
+    CHECK(Keypad_sampleColumn(2, 0x00) == 0);
+    n = events(e);
+    CHECK(n == 1 && e[0] == KEYPAD_EVENT(RELEASED, 14));
+}
+
+/*  --------------------------------------------------------------------
+    scan against the matrix
+    ------------------------------------------------------------------*/
+
+static void tick(u8 n)
+{
+    while (n--)
+        Keypad_scan();
+}
+
+static void test_matrix(void)
+{
+    u8 e[32], n;
+    u32 r;
+
+    // idle : one read per tick, the columns released afterwards
+    diodes = 1;
+    start(10, 60000, 5);
+    reads = 0;
+    tick(10);
+    CHECK(reads == SNAPSHOTS(10) && !Keypad_available());
+    matrix_update();
+    CHECK((TRISD & 0x0F) == 0x0F);      // columns released
+
+    // three keys of a rectangle, with diodes : no ghost
+    closed[0][0] = closed[0][1] = closed[1][0] = 1;
+    tick(3);
+    n = events(e);
+    CHECK(n == 3);
+    CHECK(Keypad_isPressed('1') && Keypad_isPressed('2') && Keypad_isPressed('4'));
+    CHECK(!Keypad_isPressed('5'));
+    matrix_update();
+    CHECK((TRISD & 0x0F) == 0x0F);      // columns released
+
+    // busy : a full scan, one read per column
+    r = reads;
+    tick(1);
+    CHECK(reads - r == SNAPSHOTS(4));
+
+    // released : back to the idle read once every key is settled
+    memset(closed, 0, sizeof(closed));
+    tick(8);
+    n = events(e);
+    CHECK(n == 3 && Keypad_eventStatus(e[2]) == RELEASED);
+    CHECK(keypadScan.idle);
+    r = reads;
+    tick(1);
+    CHECK(reads - r == SNAPSHOTS(1));
+
+    // the same three keys without diodes : the 4th corner shows up
+    diodes = 0;
+    start(10, 60000, 5);
+    closed[0][0] = closed[0][1] = closed[1][0] = 1;
+    tick(3);
+    CHECK(Keypad_isPressed('1') && Keypad_isPressed('2') && Keypad_isPressed('4'));
+    CHECK(Keypad_isPressed('5'));       // ghost
+    events(e);
+
+    // two keys never ghost, diodes or not
+    start(10, 60000, 5);
+    closed[2][1] = closed[3][3] = 1;
+    tick(3);
+    n = events(e);
+    CHECK(n == 2 && Keypad_isPressed('8') && Keypad_isPressed('D'));
+
+    // events nobody reads are counted, the queue keeps the oldest
+    start(5, 5, 5);
+    for (n = 0; n < 20; n++)
+    {
+        closed[0][0] ^= 1;
+        tick(1);
+    }
+    CHECK(keypadScan.lost == 20 - (KEYPAD_QUEUESIZE - 1));
+    CHECK(Keypad_getEvent() == KEYPAD_EVENT(PRESSED, 0));
+}
+
+int main(void)
+{
+    test_bounce();
+    test_ticks();
+    test_column();
+    test_matrix();
+
+    printf("keypad_scan: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
@@ -0,0 +1,366 @@
+/*  --------------------------------------------------------------------
+    lcd_shadow.c - host test of the HD44780 shadow and diff refresh
+    --------------------------------------------------------------------
+    lcdlib.c drives a simulated HD44780 wired in 4-bit mode : the RS
+    and data pins are latched on each falling edge of E, the display
+    starts in 8-bit mode and executes the instructions of lcd_begin()
+    as the real one does (function set, display control, clear, entry
+    mode, DDRAM address, data). Time only moves with Delayus(),
+    Delayms() and the 1 ms timer ticks of the test, every instruction
+    has to arrive after the previous one is executed (37 us, 1.52 ms
+    for clear and home).
+
+    Checked : the initialisation, one byte per lcd_refresh() and no
+    wait inside it, the DDRAM ending up as the shadow for 8x1, 16x2,
+    16x4, 20x4 and 40x2 layouts after random writes, only the changed
+    cells sent, commands queued between two characters and the full
+    queue drained by the sketch, lcd_refresh() kept out meanwhile.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>
+#include <bench.h>
+
+// fake ports for portgroup.c, the data pins are on different ones
+static u32 regs[7][16];
+#define TRISA                   regs[0][0]
+#define TRISB                   regs[1][0]
+#define TRISC                   regs[2][0]
+#define TRISD                   regs[3][0]
+#define TRISE                   regs[4][0]
+#define TRISF                   regs[5][0]
+#define TRISG                   regs[6][0]
+
+#define RS          1
+#define EN          2
+#define D4          3
+#define D5          4
+#define D6          5
+#define D7          6
+
+#define __DIGITALW_C
+static const u8 port[8] = { 0, 0, 0, 1, 2, 3, 4, 5 };
+static const u32 mask[8] = { 1, 2, 4, 1, 1, 1, 1, 1 };
+static void pin_write(u8 pin, u8 state);
+#define pinmode(pin, dir)       ((void)(pin), (void)(dir))
+#define digitalwrite(pin, s)    pin_write(pin, s)
+
+// time in us
+static u32 now;
+#define __DELAY_C
+#define Delayus(us)             (now += (us))
+#define Delayms(ms)             (now += 1000 * (ms))
+
+#define LCDSHADOW
+#define LCDPRINT
+#define LCDSETCURSOR
+#define LCDCLEAR
+#define LCDCURSOR
+#define LCDNOCURSOR
+#include <lcdlib.c>
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    simulated HD44780
+    ------------------------------------------------------------------*/
+
+static struct
+{
+    u8 pin[8];
+    u8 bits4;                       // 4-bit interface
+    u8 half;                        // high nibble received
+    u8 hi;
+    u8 lines2;
+    u8 control;                     // display, cursor, blink
+    u8 ac;                          // address counter
+    u8 ddram[0x80];
+    u32 ready;                      // end of the last instruction
+    u32 late;                       // instructions sent too early
+    u32 bytes;                      // instructions and characters
+    u32 commands;                   // other than Set DDRAM Address
+} hd;
+
+static void hd_reset(void)
+{
+    memset(&hd, 0, sizeof(hd));
+    memset(hd.ddram, '?', sizeof(hd.ddram));
+}
+
+static void hd_next(void)
+{
+    hd.ac++;
+    if (hd.lines2)
+    {
+        if (hd.ac == 0x28) hd.ac = 0x40;
+        else if (hd.ac == 0x68) hd.ac = 0x00;
+    }
+    else if (hd.ac == 0x50)
+        hd.ac = 0x00;
+}
+
+static void hd_execute(u8 rs, u8 v)
+{
+    u32 t = 37;
+
+    if (now < hd.ready)
+        hd.late++;
+    hd.bytes++;
+
+    if (rs)
+    {
+        hd.ddram[hd.ac] = v;
+        hd_next();
+    }
+    else if (v & 0x80)
+        hd.ac = v & 0x7F;
+    else
+    {
+        hd.commands++;
+        if (v & 0x40)
+            ;                       // CGRAM, not used
+        else if (v & 0x20)
+        {
+            hd.bits4 = !(v & 0x10);
+            hd.lines2 = (v & 0x08) != 0;
+        }
+        else if (v & 0x10)
+            ;                       // cursor / display shift
+        else if (v & 0x08)
+            hd.control = v & 0x07;
+        else if (v & 0x04)
+            ;                       // entry mode
+        else if (v & 0x02)
+        {
+            hd.ac = 0;
+            t = 1520;
+        }
+        else if (v & 0x01)
+        {
+            memset(hd.ddram, ' ', sizeof(hd.ddram));
+            hd.ac = 0;
+            t = 1520;
+        }
+    }
+    hd.ready = now + t;
+}
+
+static void pin_write(u8 pin, u8 state)
+{
+    u8 nibble;
+
+    if (pin == EN && hd.pin[EN] && !state)
+    {
+        nibble = hd.pin[D4] | (hd.pin[D5] << 1) | (hd.pin[D6] << 2) | (hd.pin[D7] << 3);
+        if (!hd.bits4)
+            hd_execute(hd.pin[RS], nibble << 4);
+        else if (!hd.half)
+        {
+            hd.hi = nibble;
+            hd.half = 1;
+        }
+        else
+        {
+            hd.half = 0;
+            hd_execute(hd.pin[RS], (hd.hi << 4) | nibble);
+        }
+    }
+    hd.pin[pin] = state;
+}
+
+/*  --------------------------------------------------------------------
+    helpers
+    ------------------------------------------------------------------*/
+
+static char screen[80];             // what the sketch wrote
+
+static void start(u8 cols, u8 rows)
+{
+    hd_reset();
+    now = 0;
+    lcd_pins(RS, EN, 0, 0, 0, 0, D4, D5, D6, D7);
+    lcd_begin(rows, 0);
+    lcd_shadow(cols, rows);
+    memset(screen, ' ', sizeof(screen));
+}
+
+// 1 ms timer ticks, returns the bytes sent
+static u32 tick(u32 n)
+{
+    u32 b = hd.bytes, t;
+
+    while (n--)
+    {
+        now += 1000;
+        t = now;
+        lcd_refresh();
+        CHECK(now - t <= 2);        // E pulses, no settling wait
+    }
+    return hd.bytes - b;
+}
+
+// ticks until nothing is sent any more, -1 if it never stops
+static int drain(void)
+{
+    u32 n, b;
+
+    for (n = 0; n < 1000; n++)
+    {
+        b = hd.bytes;
+        if (tick(1) == 0)
+            return n;
+        CHECK(hd.bytes - b == 1);   // one byte per tick
+    }
+    return -1;
+}
+
+static int same(u8 cols, u8 rows)
+{
+    u8 c;
+
+    for (c = 0; c < cols * rows; c++)
+        if (hd.ddram[lcdshadow_ddram(&gLCDShadow, c)] != (u8)screen[c])
+            return 0;
+    return 1;
+}
+
+static void put(u8 cols, u8 col, u8 row, const char *s)
+{
+    lcd_setCursor(col, row);
+    lcd_print((char *)s);
+    memcpy(&screen[row * cols + col], s, strlen(s));
+}
+
+/*  --------------------------------------------------------------------
+    tests
+    ------------------------------------------------------------------*/
+
+static void test_begin(void)
+{
+    start(20, 4);
+    CHECK(hd.bits4 && hd.lines2);
+    CHECK(hd.control == LCD_DISPLAYON);
+    CHECK(hd.late == 0);
+    CHECK(hd.ddram[0] == ' ' && hd.ddram[0x67] == ' ');
+    CHECK(drain() == 0);            // nothing to send yet
+}
+
+static void test_diff(void)
+{
+    u32 b;
+    int n;
+
+    start(20, 4);
+    put(20, 0, 0, "Pinguino");
+    put(20, 5, 2, "shadow");
+    CHECK(hd.bytes == 8);           // lcd_begin() only
+
+    n = drain();
+    CHECK(n == 1 + 8 + 1 + 6);      // 2 addresses, 14 characters
+    CHECK(same(20, 4));
+    CHECK(hd.late == 0);
+
+    // the same text again : nothing to send
+    put(20, 0, 0, "Pinguino");
+    CHECK(drain() == 0);
+
+    // one character changed : its address and itself
+    put(20, 3, 0, "G");
+    b = hd.bytes;
+    CHECK(drain() == 2);
+    CHECK(hd.bytes - b == 2 && same(20, 4));
+
+    // two neighbours : a single address
+    put(20, 9, 3, "ab");
+    CHECK(drain() == 3 && same(20, 4));
+
+    // clear only sends the cells which weren't blank
+    lcd_clear();
+    memset(screen, ' ', sizeof(screen));
+    n = drain();
+    CHECK(n > 0 && n <= 4 + 16);
+    CHECK(same(20, 4));
+    CHECK(hd.late == 0);
+}
+
+static void test_commands(void)
+{
+    u8 i;
+
+    start(16, 2);
+    put(16, 0, 1, "ab");
+    tick(2);                        // address and 'a' sent
+    lcd_cursor();
+    CHECK(hd.control == LCD_DISPLAYON);         // queued
+    tick(1);
+    CHECK(hd.control == (LCD_DISPLAYON | LCD_CURSORON));
+    CHECK(drain() >= 2);            // address again, 'b', cursor parked
+    CHECK(same(16, 2));
+    CHECK(hd.ac == lcdshadow_ddram(&gLCDShadow, gLCDShadow.cursor));
+
+    // more commands than the queue holds, nobody refreshing
+    for (i = 0; i < LCDSHADOW_COMMANDS + 3; i++)
+    {
+        if (i & 1)
+            lcd_cursor();
+        else
+            lcd_noCursor();
+    }
+    CHECK(hd.commands >= 3);
+    CHECK(!gLCDShadowPaused);
+    drain();
+    CHECK(hd.control == (LCD_DISPLAYON | ((i & 1) ? 0 : LCD_CURSORON)));
+    CHECK(hd.late == 0);
+
+    // the sketch owns the bus, the timer stays out
+    put(16, 0, 0, "x");
+    gLCDShadowPaused = true;
+    CHECK(tick(5) == 0);
+    gLCDShadowPaused = false;
+    CHECK(drain() > 0 && same(16, 2));
+}
+
+static void test_layouts(void)
+{
+    static const u8 layout[5][2] = { { 8, 1 }, { 16, 2 }, { 16, 4 }, { 20, 4 }, { 40, 2 } };
+    char s[2] = { 0, 0 };
+    u8 l, cols, rows, c;
+    int k;
+
+    for (l = 0; l < 5; l++)
+    {
+        cols = layout[l][0];
+        rows = layout[l][1];
+        start(cols, rows);
+
+        for (k = 0; k < 3000; k++)
+        {
+            c = bench_rand() % (cols * rows);
+            s[0] = 'A' + bench_rand() % 26;
+            put(cols, c % cols, c / cols, s);
+            if (bench_rand() % 4 == 0)
+                tick(1 + bench_rand() % 3);
+        }
+        CHECK(drain() >= 0);
+        CHECK(same(cols, rows));
+        CHECK(hd.late == 0);
+    }
+}
+
+int main(void)
+{
+    test_begin();
+    test_diff();
+    test_commands();
+    test_layouts();
+
+    printf("lcd_shadow: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
@@ -0,0 +1,354 @@
+/*  --------------------------------------------------------------------
+    onewire_async.c - host test of the non-blocking 1-Wire engine
+    --------------------------------------------------------------------
+    Timer5Interrupt() of 1wire.c runs against a fake Timer5 and a fake
+    DQ pin wired to a simulated DS18x20. The time is counted in Timer5
+    ticks (5 per us at 40 MHz / 8), each interrupt moves it forward by
+    PR5. The slave sees the master edges, answers a reset with a
+    presence pulse, reads the write slots 30us after the falling edge
+    and holds the line low 30us for a 0 in a read slot, so the line
+    the engine samples is the wired-and of both.
+
+    Checked : reset and presence, the write and read slot timings seen
+    from the slave, the bytes written and read, a scratchpad with a bad
+    CRC8, a bus with nobody on it, queued transfers and the order of
+    their done() callbacks, and the timer stopping once the queue is
+    empty.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>              // INPUT, OUTPUT
+
+// fake Timer5, the SET/CLR registers are folded in by timer5_sync()
+u32 T5CON, T5CONSET, T5CONCLR, TMR5, PR5;
+#define INT_TIMER5_VECTOR       20
+#define INT_TIMER5              20
+
+// fake DQ pin, 1wire.c gets these instead of the digitalw.c stand-in
+#define __DIGITALW_C
+static void pin_drive(u8 low);
+static u8 pin_level(void);
+#define pinmode(pin, dir)       ((void)(pin), pin_drive((dir) == OUTPUT))
+#define output(pin)             ((void)(pin), pin_drive(1))
+#define input(pin)              ((void)(pin), pin_drive(0))
+#define digitalwrite(pin, s)    ((void)(pin))
+#define digitalread(pin)        ((void)(pin), pin_level())
+
+#define ONEWIREASYNC
+#include <1wire.c>
+
+#define US          5UL             // ticks per us
+#define DQ          7
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    simulated slave
+    ------------------------------------------------------------------*/
+
+static struct
+{
+    u8 present;                     // 0 = nobody on the bus
+    const u8 *pad;                  // scratchpad sent after 0xBE
+    u8 padlen;
+
+    u32 now;                        // ticks
+    u8 master;                      // master pulls the line low
+    u32 fall;                       // last master falling edge
+    u32 rise;                       // last master rising edge
+    u32 presence0, presence1;       // presence pulse
+    u32 hold;                       // slave holds the line until then
+    u8 reading;                     // the master reads the scratchpad
+    u16 bit;                        // bits received / sent since reset
+
+    u8 rx[16];                      // bytes received since the reset
+    u8 resets;
+    u16 badslots;                   // slots out of the standard timings
+    u16 latesamples;                // read slots sampled too late
+} bus;
+
+static void slave_reset(u8 present, const u8 *pad, u8 padlen)
+{
+    memset(&bus, 0, sizeof(bus));
+    bus.present = present;
+    bus.pad = pad;
+    bus.padlen = padlen;
+}
+
+static void pin_drive(u8 low)
+{
+    u32 t;
+
+    if (low == bus.master)
+        return;
+    bus.master = low;
+
+    if (low)                        // falling edge, a new slot
+    {
+        if (bus.fall && bus.now - bus.rise < 1 * US)
+            bus.badslots++;         // no recovery time
+        if (bus.fall && bus.now - bus.fall < 61 * US)
+            bus.badslots++;         // slot too short
+        if (bus.reading && bus.present)
+        {
+            u16 n = bus.bit++;
+            if (n < bus.padlen * 8 && !(bus.pad[n >> 3] & (1 << (n & 7))))
+                bus.hold = bus.now + 30 * US;
+        }
+        bus.fall = bus.now;
+        return;
+    }
+
+    // rising edge
+    bus.rise = bus.now;
+    t = bus.now - bus.fall;
+    if (t >= 480 * US)
+    {
+        bus.resets++;
+        bus.reading = 0;
+        bus.bit = 0;
+        if (bus.present)
+        {
+            bus.presence0 = bus.now + 30 * US;
+            bus.presence1 = bus.now + 150 * US;
+        }
+        return;
+    }
+    if (bus.reading || !bus.present)
+        return;
+
+    // write slot : 1 if released before the slave samples at 30us
+    if (t < 15 * US)
+        bus.rx[bus.bit >> 3] |= 1 << (bus.bit & 7);
+    else if (t >= 60 * US && t <= 120 * US)
+        bus.rx[bus.bit >> 3] &= ~(1 << (bus.bit & 7));
+    else
+        bus.badslots++;
+    if (t < 1 * US)
+        bus.badslots++;
+    bus.bit++;
+
+    // skip ROM, read scratchpad
+    if (bus.bit == 16 && bus.rx[0] == 0xCC && bus.rx[1] == 0xBE)
+    {
+        bus.reading = 1;
+        bus.bit = 0;
+    }
+}
+
+static u8 pin_level(void)
+{
+    if (bus.reading && gOneWire.phase == OW_PH_SAMPLE && bus.now - bus.fall > 15 * US)
+        bus.latesamples++;
+    if (bus.master)
+        return 0;
+    if (bus.now >= bus.presence0 && bus.now < bus.presence1)
+        return 0;
+    if (bus.now < bus.hold)
+        return 0;
+    return 1;
+}
+
+/*  --------------------------------------------------------------------
+    fake Timer5
+    ------------------------------------------------------------------*/
+
+static void timer5_sync(void)
+{
+    T5CON |= T5CONSET;
+    T5CON &= ~T5CONCLR;
+    T5CONSET = T5CONCLR = 0;
+}
+
+// run the interrupts until the timer stops, or for at most n of them
+static u32 run(u32 n)
+{
+    u32 i = 0;
+
+    timer5_sync();
+    while ((T5CON & 0x8000) && i++ < n)
+    {
+        bus.now += PR5 ? PR5 : 1;
+        TMR5 = 0;
+        IntFlag = 1;
+        Timer5Interrupt();
+        timer5_sync();
+    }
+    return i;
+}
+
+/*  --------------------------------------------------------------------
+    transfers
+    ------------------------------------------------------------------*/
+
+static onewire_xfer_t *order[8];
+static u8 norder;
+
+static void done(onewire_xfer_t *x)
+{
+    if (norder < 8)
+        order[norder++] = x;
+}
+
+static void xfer(onewire_xfer_t *x, u8 reset, const u8 *tx, u8 txlen, u8 *rx, u8 rxlen)
+{
+    memset(x, 0, sizeof(*x));
+    x->bus = DQ;
+    x->reset = reset;
+    x->tx = tx;
+    x->txlen = txlen;
+    x->rx = rx;
+    x->rxlen = rxlen;
+    x->done = done;
+}
+
+// scratchpad of a DS18B20 at 25.0625 C, the last byte is its CRC8
+static const u8 pad[9] = { 0x91, 0x01, 0x4B, 0x46, 0x7F, 0xFF, 0x0F, 0x10, 0x00 };
+static const u8 readpad[2] = { 0xCC, 0xBE };
+static const u8 convert[2] = { 0xCC, 0x44 };
+
+static void test_read(void)
+{
+    u8 good[9], rx[9];
+    onewire_xfer_t x;
+
+    memcpy(good, pad, 8);
+    good[8] = OneWireCRC8(0, good, 8);
+    CHECK(OneWireCRC8(0, good, 9) == 0);
+
+    slave_reset(1, good, 9);
+    norder = 0;
+    memset(rx, 0x55, sizeof(rx));
+    xfer(&x, 1, readpad, 2, rx, 9);
+    OneWireAsyncStart(&x);
+    CHECK(x.status == OW_BUSY && OneWireAsyncBusy());
+    run(100000);
+
+    CHECK(x.status == OW_DONE);
+    CHECK(!OneWireAsyncBusy());
+    CHECK(!(T5CON & 0x8000));           // timer stopped
+    CHECK(!bus.master);                 // bus released
+    CHECK(bus.resets == 1);
+    CHECK(bus.rx[0] == 0xCC && bus.rx[1] == 0xBE);
+    CHECK(bus.reading && bus.bit == 72);
+    CHECK(memcmp(rx, good, 9) == 0);
+    CHECK(OneWireCRC8(0, rx, 9) == 0);
+    CHECK(bus.badslots == 0);
+    CHECK(bus.latesamples == 0);
+    CHECK(norder == 1 && order[0] == &x);
+}
+
+static void test_badcrc(void)
+{
+    u8 bad[9], rx[9];
+    onewire_xfer_t x;
+
+    memcpy(bad, pad, 8);
+    bad[8] = OneWireCRC8(0, bad, 8);
+    bad[3] ^= 0x10;                     // one bit flipped on the way
+
+    slave_reset(1, bad, 9);
+    norder = 0;
+    xfer(&x, 1, readpad, 2, rx, 9);
+    OneWireAsyncStart(&x);
+    run(100000);
+
+    // the engine reads what is on the bus, the caller rejects it
+    CHECK(x.status == OW_DONE);
+    CHECK(memcmp(rx, bad, 9) == 0);
+    CHECK(OneWireCRC8(0, rx, 9) != 0);
+}
+
+static void test_nodevice(void)
+{
+    u8 rx[9];
+    onewire_xfer_t x;
+    u32 n;
+
+    slave_reset(0, NULL, 0);
+    norder = 0;
+    memset(rx, 0x55, sizeof(rx));
+    xfer(&x, 1, readpad, 2, rx, 9);
+    OneWireAsyncStart(&x);
+    n = run(100000);
+
+    CHECK(x.status == OW_NODEVICE);
+    CHECK(norder == 1 && order[0] == &x);
+    CHECK(!(T5CON & 0x8000));
+    CHECK(!bus.master);
+    CHECK(rx[0] == 0x55 && rx[8] == 0x55);  // no slot after the reset
+    CHECK(n < 8);
+}
+
+static void test_queue(void)
+{
+    u8 rx[9];
+    onewire_xfer_t a, b, c;
+    u32 n;
+
+    slave_reset(1, pad, 9);
+    norder = 0;
+    xfer(&a, 1, convert, 2, NULL, 0);
+    xfer(&b, 1, readpad, 2, rx, 9);
+    xfer(&c, 0, NULL, 0, rx, 1);        // a single read, no reset
+
+    OneWireAsyncStart(&a);
+    run(20);                            // a is in its first slots
+    CHECK(a.status == OW_BUSY);
+    OneWireAsyncStart(&b);
+    OneWireAsyncStart(&c);
+    CHECK(b.status == OW_BUSY && c.status == OW_BUSY);
+    CHECK(norder == 0);
+    n = run(100000);
+
+    CHECK(n < 100000);
+    CHECK(norder == 3);
+    CHECK(order[0] == &a && order[1] == &b && order[2] == &c);
+    CHECK(a.status == OW_DONE && b.status == OW_DONE && c.status == OW_DONE);
+    CHECK(bus.resets == 2);
+    CHECK(rx[0] == 0xFF);               // past the scratchpad, the slave is silent
+    CHECK(bus.badslots == 0 && bus.latesamples == 0);
+    CHECK(!(T5CON & 0x8000));
+
+    // a transfer queued once the engine stopped restarts the timer
+    slave_reset(1, pad, 9);
+    norder = 0;
+    xfer(&a, 1, readpad, 2, rx, 9);
+    OneWireAsyncStart(&a);
+    CHECK(T5CON & 0x8000 || T5CONSET & 0x8000);
+    run(100000);
+    CHECK(a.status == OW_DONE && memcmp(rx, pad, 9) == 0);
+}
+
+static void test_timings(void)
+{
+    const u32 mhz = GetPeripheralClock() / 8 / 1000000;
+
+    OneWireAsyncInit();
+    CHECK(mhz == US);
+    CHECK(gOneWireTicks[OW_T_H] == 480 * US);
+    // a read slot is sampled within the 15us the slave holds the line
+    CHECK(gOneWireTicks[OW_T_R] + gOneWireTicks[OW_T_E] < 15 * US);
+    // every presence pulse is low between 60 and 15 + 60us
+    CHECK(gOneWireTicks[OW_T_I] > 60 * US && gOneWireTicks[OW_T_I] < 75 * US);
+    CHECK(gOneWireTicks[OW_T_I] + gOneWireTicks[OW_T_J] >= 480 * US);
+}
+
+int main(void)
+{
+    test_timings();
+    test_read();
+    test_badcrc();
+    test_nodevice();
+    test_queue();
+
+    printf("onewire_async: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
@@ -0,0 +1,13 @@
+/*  --------------------------------------------------------------------
+    delay.c - host stand-in, no wait
+    ------------------------------------------------------------------*/
+
+#ifndef __DELAY_C
+#define __DELAY_C
+
+#include <typedef.h>
+
+#define Delayus(us)
+#define Delayms(ms)
+
+#endif /* __DELAY_C */
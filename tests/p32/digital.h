@@ -0,0 +1,39 @@
+/*  --------------------------------------------------------------------
+    digital.h - host stand-in, the SFR used by the core are plain
+    variables the tests can read back
+    ------------------------------------------------------------------*/
+
+#ifndef __DIGITAL_H
+#define __DIGITAL_H
+
+#include <typedef.h>
+
+#define _0      (1<<0)
+#define _1      (1<<1)
+#define _2      (1<<2)
+#define _3      (1<<3)
+#define _4      (1<<4)
+#define _5      (1<<5)
+#define _6      (1<<6)
+#define _7      (1<<7)
+#define _8      (1<<8)
+#define _9      (1<<9)
+#define _10     (1<<10)
+#define _11     (1<<11)
+#define _12     (1<<12)
+#define _13     (1<<13)
+#define _14     (1<<14)
+#define _15     (1<<15)
+#define nil     (1<<16)
+
+u32 TRISBSET, AD1PCFG, AD1PCFGCLR;
+u32 AD1CSSL, AD1CON1, AD1CON2, AD1CON3, AD1CHS;
+u32 T3CON, TMR3, PR3;
+u32 ADC1BUF[64];
+#define ADC1BUF0    ADC1BUF[0]
+
+struct { u32 TRISD9:1, TRISD10:1; } TRISDbits;
+struct { u32 ADON:1, SAMP:1, DONE:1; } AD1CON1bits;
+struct { u32 BUFS:1, SMPI:4; } AD1CON2bits;
+
+#endif /* __DIGITAL_H */
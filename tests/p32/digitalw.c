@@ -0,0 +1,19 @@
+/*  --------------------------------------------------------------------
+    digitalw.c - host stand-in, the pins are not driven
+    ------------------------------------------------------------------*/
+
+#ifndef __DIGITALW_C
+#define __DIGITALW_C
+
+#include <typedef.h>
+
+#define pinmode(pin, dir)
+#define output(pin)
+#define input(pin)
+#define digitalwrite(pin, state)
+#define high(pin)
+#define low(pin)
+#define toggle(pin)
+#define digitalread(pin)        0
+
+#endif /* __DIGITALW_C */
@@ -0,0 +1,21 @@
+/*  --------------------------------------------------------------------
+    interrupt.c - host stand-in
+    ------------------------------------------------------------------*/
+
+#ifndef __INTERRUPT_C
+#define __INTERRUPT_C
+
+#define INT_SYSTEM_CONFIG_MULT_VECTOR   1
+#define INT_ADC1_CONVERT_DONE_VECTOR    27
+#define INT_ADC1_CONVERT_DONE           33
+
+u8 IntFlag, IntEnabled;
+
+#define IntConfigureSystem(c)
+#define IntSetVectorPriority(v, p, s)
+#define IntGetFlag(i)                   (IntFlag)
+#define IntClearFlag(i)                 (IntFlag = 0)
+#define IntEnable(i)                    (IntEnabled = 1)
+#define IntDisable(i)                   (IntEnabled = 0)
+
+#endif /* __INTERRUPT_C */
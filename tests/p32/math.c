@@ -0,0 +1,17 @@
+/*  --------------------------------------------------------------------
+    math.c - host stand-in, abs() is the C library one, random()
+    clashes with it and is left out
+    ------------------------------------------------------------------*/
+
+#ifndef __MATH_C
+#define __MATH_C
+
+#include <typedef.h>
+#include <stdlib.h>
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+#endif /* __MATH_C */
@@ -0,0 +1,14 @@
+/*  --------------------------------------------------------------------
+    mips.h - host stand-in, no interrupt to mask
+    ------------------------------------------------------------------*/
+
+#ifndef __MIPS_H
+#define __MIPS_H
+
+#include <typedef.h>
+
+static inline u32 DisableInterrupt(void)    { return 0; }
+static inline u32 EnableInterrupt(void)     { return 0; }
+#define RestoreIterruptStatus(x)
+
+#endif /* __MIPS_H */
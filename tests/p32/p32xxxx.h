@@ -0,0 +1,9 @@
+/*  --------------------------------------------------------------------
+    p32xxxx.h - host stand-in for the P32 p32xxxx.h
+    no SFR here, the tests which need some declare them themselves
+    ------------------------------------------------------------------*/
+
+#ifndef __P32XXXX_H
+#define __P32XXXX_H
+
+#endif /* __P32XXXX_H */
@@ -0,0 +1,27 @@
+/*  --------------------------------------------------------------------
+    spi.c - host stand-in, the bytes written are counted and dropped
+    ------------------------------------------------------------------*/
+
+#ifndef __SPI_C
+#define __SPI_C
+
+#include <typedef.h>
+#include <spi.h>
+
+u32 SPI_written;
+
+void SPI_select(u8 module) {}
+void SPI_deselect(u8 module) {}
+void SPI_setBitOrder(u8 module, u8 bitorder) {}
+void SPI_setDataMode(u8 module, u8 mode) {}
+void SPI_setMode(u8 module, u8 mode) {}
+void SPI_setClockDivider(u8 module, u32 divider) {}
+void SPI_begin(u8 module, ...) {}
+
+u8 SPI_write(u8 module, u8 data_out)
+{
+    SPI_written++;
+    return 0xFF;
+}
+
+#endif /* __SPI_C */
@@ -0,0 +1,10 @@
+/*  --------------------------------------------------------------------
+    system.c - host stand-in
+    ------------------------------------------------------------------*/
+
+#ifndef __SYSTEM_C
+#define __SYSTEM_C
+
+#define GetPeripheralClock()    40000000UL
+
+#endif /* __SYSTEM_C */
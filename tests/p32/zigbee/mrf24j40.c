@@ -0,0 +1,89 @@
+/*  --------------------------------------------------------------------
+    zigbee/mrf24j40.c - host stand-in, a fake MRF24J40
+    --------------------------------------------------------------------
+    The short and long address spaces are plain memory the tests fill
+    and read back. Reading INTSTAT clears it, as on the chip. Writing
+    TXNTRIG to TXNCON counts a transmission and keeps a copy of the TX
+    FIFO. mrf24j40_handle_isr() is the one of the real driver.
+    ------------------------------------------------------------------*/
+
+#ifndef __MRF24J40_C
+#define __MRF24J40_C
+
+#include <string.h>
+#include <typedef.h>
+#include <zigbee/mrf24j40.h>
+#include <zigbee/ieee154.h>
+
+#define test_bit(b, n)          (((b) & (1 << (n))) != 0)
+
+uns8 data_sequence_number;
+uns16 pan_id = 0xffff;
+uns16 short_address = 0xffff;
+uns8 current_channel = 0;
+
+u8 mrf24j40_short[0x40];
+u8 mrf24j40_long[0x400];
+
+u32 mrf24j40_sent;                  // frames handed to the radio
+u8 mrf24j40_air[0x80];              // TX FIFO when the last one was
+u8 mrf24j40_ackreq;                 // and its TXNACKREQ bit
+u8 mrf24j40_rxoff;                  // RXDECINV set while reading
+
+void mrf24j40_receive_callback();
+void mrf24j40_transmit_callback(uns8 status, uns8 retries, uns8 channel_busy);
+
+uns8 mrf24j40_short_addr_read(uns8 addr)
+{
+    u8 v = mrf24j40_short[addr];
+
+    if (addr == INTSTAT)
+        mrf24j40_short[addr] = 0;
+    return v;
+}
+
+void mrf24j40_short_addr_write(uns8 addr, uns8 data)
+{
+    if (addr == TXNCON && test_bit(data, TXNCON_TXNTRIG))
+    {
+        mrf24j40_sent++;
+        memcpy(mrf24j40_air, mrf24j40_long, sizeof(mrf24j40_air));
+        mrf24j40_ackreq = test_bit(data, TXNCON_TXNACKREQ);
+        return;
+    }
+    if (addr == BBREG1)
+        mrf24j40_rxoff = test_bit(data, BBREG1_RXDECINV);
+    mrf24j40_short[addr] = data;
+}
+
+void mrf24j40_long_addr_read_burst(uns16 addr, uns8 *data, uns8 count)
+{
+    memcpy(data, &mrf24j40_long[addr], count);
+}
+
+void mrf24j40_long_addr_write_burst(uns16 addr, const uns8 *data, uns8 count)
+{
+    memcpy(&mrf24j40_long[addr], data, count);
+}
+
+void mrf24j40_setup_io() {}
+void mrf24j40_init() {}
+void mrf24j40_set_pan_id(uns16 _pan_id) { pan_id = _pan_id; }
+void mrf24j40_set_short_address(uns16 _short_address) { short_address = _short_address; }
+void mrf24j40_set_channel(uns8 _channel) { current_channel = _channel; }
+
+void mrf24j40_handle_isr()
+{
+    uns8 intstat = mrf24j40_short_addr_read(INTSTAT);
+    uns8 stat;
+
+    if (test_bit(intstat, INTSTAT_RXIF))
+        mrf24j40_receive_callback();
+    if (test_bit(intstat, INTSTAT_TXNIF))
+    {
+        stat = mrf24j40_short_addr_read(TXSTAT);
+        mrf24j40_transmit_callback(stat & 1, stat >> 6, test_bit(stat, TXSTAT_CCAFAIL));
+    }
+}
+
+#endif /* __MRF24J40_C */
@@ -0,0 +1,9 @@
+/*  --------------------------------------------------------------------
+    compiler.h - host stand-in for the P8 compiler.h
+    no SFR here, the sources built on the host don't touch registers
+    ------------------------------------------------------------------*/
+
+#ifndef __COMPILER_H
+#define __COMPILER_H
+
+#endif /* __COMPILER_H */
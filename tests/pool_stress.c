@@ -0,0 +1,155 @@
+/*  --------------------------------------------------------------------
+    pool_stress.c - host stress test of the fixed-block allocator
+    --------------------------------------------------------------------
+    Random pool_malloc / pool_mfree of random sizes for many rounds.
+    Every live block is filled with a pattern checked when it is freed,
+    the counters are checked against a shadow count, and a failure is
+    only accepted when every class able to hold the request is empty.
+
+    Fragmentation metrics :
+    - internal : bytes lost rounding the requests up to a block size
+    - spills   : requests served by a larger class than the best fit
+    - stranded : failures while the free blocks of the smaller classes
+                 added up to the request, memory a heap could have used
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <pool.c>
+#include <bench.h>
+
+POOL_DECLARE(pool16, 16, 32);
+POOL_DECLARE(pool32, 32, 16);
+POOL_DECLARE(pool64, 64, 8);
+POOL_DECLARE(pool128, 128, 4);
+
+#define NCLASSES    4
+#define MAXLIVE     64
+#define ROUNDS      2000000
+
+static pool_t *classes[NCLASSES] = { &pool16, &pool32, &pool64, &pool128 };
+
+static struct
+{
+    u8 *ptr;
+    u16 size;
+    u8 tag;
+} live[MAXLIVE];
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { if (failed++ < 10)                  \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+int main(void)
+{
+    u32 i, k, n, nlive = 0;
+    u32 allocs = 0, frees = 0, fails = 0, stranded = 0;
+    u64 requested = 0, granted = 0;
+    u32 shadow[NCLASSES] = { 0 };
+    u32 spills = 0, nfails = 0;
+    u32 freebytes;
+    u16 size;
+    u8 *p;
+    pool_t *owner;
+
+    POOL_INIT(pool128, 128);        // registered out of order on purpose
+    POOL_INIT(pool16, 16);
+    POOL_INIT(pool64, 64);
+    POOL_INIT(pool32, 32);
+
+    // size classes sorted by block size
+    for (owner = gPoolList, k = 0; owner; owner = owner->next, k++)
+        CHECK(owner == classes[k]);
+    CHECK(k == NCLASSES);
+
+    for (i = 0; i < ROUNDS; i++)
+    {
+        n = bench_rand() % MAXLIVE;
+
+        if (live[n].ptr)
+        {
+            // free : the pattern must be intact
+            p = live[n].ptr;
+            for (k = 0; k < live[n].size; k++)
+                CHECK(p[k] == (u8)(live[n].tag + k));
+            owner = pool_owner(p);
+            CHECK(owner != NULL);
+            for (k = 0; k < NCLASSES; k++)
+                if (classes[k] == owner)
+                    shadow[k]--;
+            pool_mfree(p);
+            live[n].ptr = NULL;
+            nlive--;
+            frees++;
+            continue;
+        }
+
+        // mostly small requests, a few large ones
+        size = 1 + (bench_rand() % 4 ? bench_rand() % 32 : bench_rand() % 128);
+        p = pool_malloc(size);
+
+        if (p == NULL)
+        {
+            fails++;
+            freebytes = 0;
+            for (k = 0; k < NCLASSES; k++)
+            {
+                if (classes[k]->size >= size)
+                    CHECK(pool_available(classes[k]) == 0);
+                else
+                    freebytes += pool_available(classes[k]) * classes[k]->size;
+            }
+            if (freebytes >= size)
+                stranded++;
+            continue;
+        }
+
+        owner = pool_owner(p);
+        CHECK(owner != NULL && owner->size >= size);
+        CHECK(((u8 *)p - owner->mem) % owner->size == 0);
+        for (k = 0; k < NCLASSES; k++)
+            if (classes[k] == owner)
+                shadow[k]++;
+
+        live[n].ptr = p;
+        live[n].size = size;
+        live[n].tag = bench_rand();
+        for (k = 0; k < size; k++)
+            p[k] = live[n].tag + k;
+
+        requested += size;
+        granted += owner->size;
+        nlive++;
+        allocs++;
+    }
+
+    for (k = 0; k < NCLASSES; k++)
+    {
+        CHECK(pool_used(classes[k]) == shadow[k]);
+        CHECK(pool_peak(classes[k]) <= (classes[k]->end - classes[k]->mem) / classes[k]->size);
+        spills += pool_spills(classes[k]);
+        nfails += pool_fails(classes[k]);
+    }
+    CHECK(nfails == fails);         // one failure counted per request
+
+    // a direct pool_alloc on an empty pool counts as a failure
+    while (pool_alloc(&pool128));
+    n = pool_fails(&pool128);
+    CHECK(pool_alloc(&pool128) == NULL && pool_fails(&pool128) == n + 1);
+
+    printf("pool_stress: %u allocs, %u frees, %u fails (%u stranded), %u spills\n",
+        allocs, frees, fails, stranded, spills);
+    printf("pool_stress: internal fragmentation %.1f%%\n",
+        100.0 * (granted - requested) / granted);
+    for (k = 0; k < NCLASSES; k++)
+        printf("pool_stress: class %3u peak %2u/%2u fails %5u spills %5u\n",
+            classes[k]->size, pool_peak(classes[k]),
+            (u16)((classes[k]->end - classes[k]->mem) / classes[k]->size),
+            pool_fails(classes[k]), pool_spills(classes[k]));
+
+    printf("pool_stress: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
@@ -0,0 +1,202 @@
+/*  --------------------------------------------------------------------
+    printf_float.c - host test and benchmark of the %f and %q formatting
+    --------------------------------------------------------------------
+    Built once for P8 and once for P32 (-D__PIC32MX__). Every float of a
+    pseudo-random set is printed with each precision and compared with
+    the C library printf, which rounds the exact binary value half to
+    even. The time per %f conversion is compared with the float-based
+    formatter printFormated used before.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <printFormated.c>
+#include <bench.h>
+
+#ifdef __PIC32MX__
+#define TARGET      "p32"
+#define MAXINT      1e18            // pint_t is 64-bit
+#else
+#define TARGET      "p8"
+#define MAXINT      4e9             // pint_t is 32-bit
+#endif
+
+static int failed, checked;
+
+static void check(const char *got, const char *want, float f, u8 prec)
+{
+    checked++;
+    if (strcmp(got, want))
+    {
+        if (failed++ < 10)
+            printf("%.9g %%.%uf: got %s, want %s\n", f, prec, got, want);
+    }
+}
+
+static void format(u8 *buf, float f, u8 prec)
+{
+    u8 *p = buf;
+    pprintfl(&p, f, 0, 0, 0, prec);
+    *p = '\0';
+}
+
+/*  --------------------------------------------------------------------
+    the previous formatter, float multiplications and truncation
+    ------------------------------------------------------------------*/
+
+static void format_old(u8 *buf, float value, u8 precision)
+{
+    u8 tmp[12], *s = tmp, *string = buf, m = 0, d;
+    u32 int_part;
+    float frac_part;
+
+    if (value < 0.0f)
+    {
+        *string++ = '-';
+        value = -value;
+    }
+
+    int_part  = (u32)value;
+    frac_part = value - (float)int_part;
+
+    do {
+        *s++ = int_part % 10 + '0';
+        int_part /= 10;
+        m++;
+    } while (int_part);
+    while (m--)
+        *string++ = *--s;
+
+    if (precision > 6)
+        precision = 6;
+    if (precision)
+    {
+        *string++ = '.';
+        while (precision--)
+        {
+            frac_part *= 10.0f;
+            d = (u8)frac_part;
+            *string++ = d + '0';
+            frac_part -= (float)d;
+        }
+    }
+    *string = '\0';
+}
+
+static float random_float(int minexp, int maxexp)
+{
+    union { float f; u32 l; } u;
+    u32 r = bench_rand();
+
+    u.l = (r & 0x807FFFFF) | (u32)(127 + minexp + r % (maxexp - minexp + 1)) << 23;
+    return u.f;
+}
+
+static void test_float(void)
+{
+    static const float cases[] = { -0.0000638514f, 0.125f, 0.375f, 2.5f,
+        1.999f, 0.05f, 9.9999999f, 0.00000005f, 0.00000015f, -0.0f, 1e-30f };
+    u8 got[64];
+    char want[64];
+    u8 prec;
+    u32 i;
+    float f;
+
+    format(got, -0.0000638514f, 7);
+    check((char *)got, "-0.0000639", -0.0000638514f, 7);
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+        for (prec = 0; prec <= PRINTF_MAXPREC; prec++)
+        {
+            format(got, cases[i], prec);
+            snprintf(want, sizeof(want), "%.*f", prec, cases[i]);
+            check((char *)got, want, cases[i], prec);
+        }
+
+    for (i = 0; i < 200000; i++)
+    {
+        f = random_float(-40, 30);
+        if (fabsf(f) >= MAXINT)
+            continue;
+        for (prec = 0; prec <= PRINTF_MAXPREC; prec++)
+        {
+            format(got, f, prec);
+            snprintf(want, sizeof(want), "%.*f", prec, f);
+            check((char *)got, want, f, prec);
+        }
+    }
+
+    format(got, NAN, 2);
+    check((char *)got, "nan", NAN, 2);
+    format(got, -INFINITY, 2);
+    check((char *)got, "-inf", -INFINITY, 2);
+}
+
+static void test_fixed(void)
+{
+    u8 got[64], *p;
+    char want[64];
+    u8 prec;
+    u32 i;
+    s32 q;
+
+    for (i = 0; i < 100000; i++)
+    {
+        q = (s32)bench_rand();
+        for (prec = 0; prec <= PRINTF_MAXPREC; prec++)
+        {
+            p = got;
+            pprintq(&p, q, 0, 0, prec);
+            *p = '\0';
+            snprintf(want, sizeof(want), "%.*f", prec, q / (double)(1L << PRINTF_QBITS));
+            check((char *)got, want, q / (float)(1L << PRINTF_QBITS), prec);
+        }
+    }
+}
+
+/*  --------------------------------------------------------------------
+    time per conversion, values between 0.001 and 1000
+    ------------------------------------------------------------------*/
+
+#define NBENCH  4096
+
+static void bench(void)
+{
+    static float v[NBENCH];
+    u8 buf[64];
+    u64 t0, t1, t2;
+    u32 i;
+
+    for (i = 0; i < NBENCH; i++)
+        v[i] = random_float(-10, 9);
+
+    t0 = bench_cycles();
+    for (i = 0; i < NBENCH; i++)
+    {
+        format(buf, v[i], 6);
+        bench_keep(buf[1]);
+    }
+    t1 = bench_cycles();
+    for (i = 0; i < NBENCH; i++)
+    {
+        format_old(buf, v[i], 6);
+        bench_keep(buf[1]);
+    }
+    t2 = bench_cycles();
+
+    printf("printf_float_" TARGET ": %%.6f %.0f " BENCH_UNIT "/conversion (previous code %.0f)\n",
+        (double)(t1 - t0) / NBENCH, (double)(t2 - t1) / NBENCH);
+}
+
+int main(void)
+{
+    test_float();
+    test_fixed();
+    bench();
+
+    printf("printf_float_" TARGET ": %d/%d %s\n", checked - failed, checked,
+        failed ? "FAILED" : "ok");
+    return failed != 0;
+}
@@ -0,0 +1,232 @@
+/*  --------------------------------------------------------------------
+    quaternion_fx.c - host test and benchmark of the sensor fusion
+    --------------------------------------------------------------------
+    A known orientation is driven by a smooth angular rate, the IMU
+    readings it gives (gravity, magnetic field, gyroscope with noise and
+    bias) are fed to the float Mahony filter and to the fixed-point
+    Mahony and Madgwick filters. The estimate is compared with the true
+    orientation once the filters have converged, and the fixed-point
+    Mahony with the float one. The time per update is measured for each.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <math.h>
+
+#define QUATERNIONFX
+float q[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+float deltat = 0.001f;
+
+#include <quaternions.c>
+#include <bench.h>
+
+#define RATE        1000            // Hz
+#define DURATION    60              // s
+#define SETTLE      10              // s before the errors are measured
+#define NBENCH      100000
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+typedef struct { double w, x, y, z; } quat;
+
+static quat qmul(quat a, quat b)
+{
+    quat r = {
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w };
+    return r;
+}
+
+// angle between two orientations in degrees
+static double qangle(quat a, double w, double x, double y, double z)
+{
+    double d = fabs(a.w * w + a.x * x + a.y * y + a.z * z);
+    double n = sqrt(w * w + x * x + y * y + z * z);
+
+    d /= n;
+    return d >= 1.0 ? 0.0 : 2.0 * acos(d) * 180.0 / M_PI;
+}
+
+// earth vector seen from the sensor : R(q)^T v
+static void sensor(quat t, const double *v, double *s)
+{
+    double w = t.w, x = t.x, y = t.y, z = t.z;
+
+    s[0] = (1 - 2 * (y * y + z * z)) * v[0] + 2 * (x * y + w * z) * v[1] + 2 * (x * z - w * y) * v[2];
+    s[1] = 2 * (x * y - w * z) * v[0] + (1 - 2 * (x * x + z * z)) * v[1] + 2 * (y * z + w * x) * v[2];
+    s[2] = 2 * (x * z + w * y) * v[0] + 2 * (y * z - w * x) * v[1] + (1 - 2 * (x * x + y * y)) * v[2];
+}
+
+static double noise(double amplitude)
+{
+    return amplitude * ((bench_rand() & 0xFFFF) / 32768.0 - 1.0);
+}
+
+typedef struct
+{
+    double max, sum;
+    u32 n;
+} stat_t;
+
+static void stat_add(stat_t *s, double e)
+{
+    if (e > s->max)
+        s->max = e;
+    s->sum += e * e;
+    s->n++;
+}
+
+static double stat_rms(const stat_t *s)
+{
+    return s->n ? sqrt(s->sum / s->n) : 0.0;
+}
+
+static void test_tracking(void)
+{
+    static const double gravity[3] = { 0.0, 0.0, 1.0 };
+    static const double field[3] = { 0.39, 0.0, -0.92 };   // 67 deg dip
+    quat truth = { cos(0.6), sin(0.6) * 0.48, sin(0.6) * 0.6, sin(0.6) * 0.64 };
+    quat dq;
+    double w[3], a[3], m[3], t, angle, n;
+    s32 sample[9];
+    q24_t qmahony[4], qmadgwick[4] = { Q24(1.0f), 0, 0, 0 };
+    stat_t emahony = { 0 }, efx = { 0 }, emadgwick = { 0 }, ediff = { 0 };
+    u32 i;
+    u8 k;
+
+    deltat = 1.0f / RATE;
+    QuaternionFx_setPeriod(1000000 / RATE);
+    for (k = 0; k < 4; k++)
+        qmahony[k] = qfx[k];
+
+    for (i = 0; i < RATE * DURATION; i++)
+    {
+        t = (double)i / RATE;
+
+        // smooth rotation, up to 90 deg/s on each axis
+        w[0] = 1.5 * sin(0.7 * t);
+        w[1] = 1.2 * sin(0.5 * t + 1.0);
+        w[2] = 0.9 * cos(0.3 * t);
+
+        // exact integration over one period
+        angle = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]) / RATE;
+        n = angle > 0 ? sin(angle / 2) / (angle * RATE) : 0;
+        dq.w = cos(angle / 2);
+        dq.x = w[0] * n;
+        dq.y = w[1] * n;
+        dq.z = w[2] * n;
+        truth = qmul(truth, dq);
+
+        sensor(truth, gravity, a);
+        sensor(truth, field, m);
+        for (k = 0; k < 3; k++)
+        {
+            a[k] += noise(0.01);
+            m[k] += noise(0.01);
+            w[k] += noise(0.005) + 0.002;       // noise and bias (rad/s)
+        }
+
+        MahonyQuaternionUpdate(a[0], a[1], a[2], w[0], w[1], w[2], m[0], m[1], m[2]);
+
+        for (k = 0; k < 3; k++)
+        {
+            sample[k] = lround(a[k] * 65536);
+            sample[3 + k] = lround(w[k] * 180.0 / M_PI * 65536);
+            sample[6 + k] = lround(m[k] * 65536);
+        }
+
+        for (k = 0; k < 4; k++)
+            qfx[k] = qmahony[k];
+        MahonyQuaternionUpdateFx(sample);
+        for (k = 0; k < 4; k++)
+        {
+            qmahony[k] = qfx[k];
+            qfx[k] = qmadgwick[k];
+        }
+        MadgwickQuaternionUpdateFx(sample);
+        for (k = 0; k < 4; k++)
+            qmadgwick[k] = qfx[k];
+
+        if (t < SETTLE)
+            continue;
+
+        stat_add(&emahony, qangle(truth, q[0], q[1], q[2], q[3]));
+        stat_add(&efx, qangle(truth, qmahony[0], qmahony[1], qmahony[2], qmahony[3]));
+        stat_add(&emadgwick, qangle(truth, qmadgwick[0], qmadgwick[1], qmadgwick[2], qmadgwick[3]));
+        dq.w = q[0]; dq.x = q[1]; dq.y = q[2]; dq.z = q[3];
+        stat_add(&ediff, qangle(dq, qmahony[0], qmahony[1], qmahony[2], qmahony[3]));
+    }
+
+    printf("quaternion_fx: orientation error (deg)   max    rms\n");
+    printf("quaternion_fx:   Mahony float          %6.3f %6.3f\n", emahony.max, stat_rms(&emahony));
+    printf("quaternion_fx:   Mahony fixed-point    %6.3f %6.3f\n", efx.max, stat_rms(&efx));
+    printf("quaternion_fx:   Madgwick fixed-point  %6.3f %6.3f\n", emadgwick.max, stat_rms(&emadgwick));
+    printf("quaternion_fx:   fixed vs float Mahony %6.3f %6.3f\n", ediff.max, stat_rms(&ediff));
+
+    // the float filter normalizes with fastsqrt(), an approximation
+    // worth about half a degree here, the fixed-point one is exact
+    CHECK(efx.max < 1.0);
+    CHECK(emadgwick.max < 2.0);
+    CHECK(ediff.max < 1.0);
+}
+
+static void test_euler(void)
+{
+    // 30 deg roll, then 20 deg pitch, then 40 deg yaw (z-y-x)
+    double r = 30 * M_PI / 360, p = 20 * M_PI / 360, y = 40 * M_PI / 360;
+    quat qr = { cos(r), sin(r), 0, 0 }, qp = { cos(p), 0, sin(p), 0 }, qy = { cos(y), 0, 0, sin(y) };
+    quat o = qmul(qmul(qy, qp), qr);
+
+    qfx[0] = Q24(o.w); qfx[1] = Q24(o.x); qfx[2] = Q24(o.y); qfx[3] = Q24(o.z);
+
+    CHECK(fabs(QuaternionFx_getYaw(0) / 65536.0 - 40) < 0.01);
+    CHECK(fabs(QuaternionFx_getPitch() / 65536.0 - 20) < 0.01);
+    CHECK(fabs(QuaternionFx_getRoll() / 65536.0 - 30) < 0.01);
+}
+
+static void bench(void)
+{
+    static s32 samples[64][9];
+    u64 t0, t1, t2, t3;
+    u32 i;
+    u8 k;
+
+    for (i = 0; i < 64; i++)
+        for (k = 0; k < 9; k++)
+            samples[i][k] = (s32)(bench_rand() % 131072) - 65536;
+
+    t0 = bench_cycles();
+    for (i = 0; i < NBENCH; i++)
+    {
+        s32 *s = samples[i & 63];
+        MahonyQuaternionUpdate(s[0] / 65536.0f, s[1] / 65536.0f, s[2] / 65536.0f,
+            s[3] / 3754936.0f, s[4] / 3754936.0f, s[5] / 3754936.0f,
+            s[6] / 65536.0f, s[7] / 65536.0f, s[8] / 65536.0f);
+    }
+    t1 = bench_cycles();
+    for (i = 0; i < NBENCH; i++)
+        MahonyQuaternionUpdateFx(samples[i & 63]);
+    t2 = bench_cycles();
+    for (i = 0; i < NBENCH; i++)
+        MadgwickQuaternionUpdateFx(samples[i & 63]);
+    t3 = bench_cycles();
+    bench_keep(q[0] + qfx[0]);
+
+    printf("quaternion_fx: " BENCH_UNIT "/update  Mahony float %.0f, Mahony fixed %.0f, Madgwick fixed %.0f\n",
+        (double)(t1 - t0) / NBENCH, (double)(t2 - t1) / NBENCH, (double)(t3 - t2) / NBENCH);
+}
+
+int main(void)
+{
+    test_tracking();
+    test_euler();
+    bench();
+
+    printf("quaternion_fx: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
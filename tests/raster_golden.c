@@ -0,0 +1,327 @@
+/*  --------------------------------------------------------------------
+    raster_golden.c - golden image test of the 1bpp display drivers
+    --------------------------------------------------------------------
+    Built once per driver (SSD1306, PCD8544, ST7565), the driver is
+    selected with -DDRIVER_<name>. The same drawing script (pixels,
+    lines, rectangles, rounded rectangles, circles, triangles, shapes
+    partly out of the screen, text wrapped past the last line) is run
+    on the driver buffer, which is read back pixel by pixel in the
+    driver's own layout and compared with golden/<name>_shapes.pbm
+    after the shapes and golden/<name>_text.pbm after the text.
+
+    The golden images were made with the drivers as they were before
+    raster.c, so the byte-at-a-time drawing has to give exactly the
+    pixels the pixel-by-pixel code gave. The PCD8544 one had its
+    drawPixel bounded first, it used to write past the buffer. Run with
+    -u to rewrite the images after an intended change.
+
+    <driver>_blit, which has no older equivalent, is checked against
+    a pixel model for each raster operation at every y of a page.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <const.h>
+#include <fonts/font5x7.h>
+
+#if defined(DRIVER_ssd1306)
+
+#define SSD1306USESPI1
+#define SSD1306GRAPHICS
+#define SSD1306PRINT
+#include <SSD1306.c>
+
+#define NAME                    "ssd1306"
+#define WIDTH                   SSD1306_DISPLAY_WIDTH
+#define HEIGHT                  SSD1306_DISPLAY_HEIGHT
+
+static void screen_init(void)
+{
+    SSD1306_init(SPI1, 0, 1);
+    SSD1306_setFont(SPI1, font5x7);
+    SSD1306_clearScreen(SPI1);
+}
+
+static u8 screen_pixel(u8 x, u8 y)
+{
+    return (SSD1306_buffer[y >> 3][x] >> (y & 7)) & 1;
+}
+
+#define screen_print(s)                 SSD1306_print(SPI1, (u8 *)(s))
+#define screen_refresh()                SSD1306_refresh(SPI1)
+#define screen_blit(b, x, y, w, h, rop) SSD1306_blit(SPI1, b, x, y, w, h, rop)
+
+#elif defined(DRIVER_pcd8544)
+
+#define PCD8544GRAPHICS
+#define PCD8544SETFONT
+#define PCD8544PRINT
+#include <PCD8544.c>
+
+#define NAME                    "pcd8544"
+#define WIDTH                   PCD8544_DISPLAY_WIDTH
+#define HEIGHT                  PCD8544_DISPLAY_HEIGHT
+
+static void screen_init(void)
+{
+    PCD8544_init(SPI1, 0, 1);
+    PCD8544_setFont(SPI1, font5x7);
+    PCD8544_clearScreen(SPI1);
+}
+
+static u8 screen_pixel(u8 x, u8 y)
+{
+    return (PCD8544_buffer[y >> 3][x] >> (y & 7)) & 1;
+}
+
+#define screen_print(s)                 PCD8544_print(SPI1, (const u8 *)(s))
+#define screen_refresh()                PCD8544_refresh(SPI1)
+#define screen_blit(b, x, y, w, h, rop) PCD8544_blit(SPI1, b, x, y, w, h, rop)
+
+#elif defined(DRIVER_st7565)
+
+#define ST7565GRAPHICS
+#define ST7565SETFONT
+#define ST7565PRINT
+#include <ST7565.c>
+
+// declared by ST7565.h and called by setColor, but never written
+void ST7565_setColor(u8 module, u16 color) {}
+
+#define NAME                    "st7565"
+#define WIDTH                   ST7565_WIDTH
+#define HEIGHT                  ST7565_HEIGHT
+
+static void screen_init(void)
+{
+    ST7565_init(SPI1, 0);
+    ST7565_setFont(SPI1, font5x7);
+    ST7565_clearScreen(SPI1);
+}
+
+// bit 7 is the top row
+static u8 screen_pixel(u8 x, u8 y)
+{
+    return (ST7565_buffer[x + (y >> 3) * ST7565_WIDTH] >> (7 - (y & 7))) & 1;
+}
+
+#define screen_print(s)                 ST7565_print(SPI1, (const u8 *)(s))
+#define screen_refresh()                ST7565_refresh(SPI1)
+#define screen_blit(b, x, y, w, h, rop) ST7565_blit(SPI1, b, x, y, w, h, rop)
+
+#else
+#error "build with -DDRIVER_ssd1306, -DDRIVER_pcd8544 or -DDRIVER_st7565"
+#endif
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+static u8 image[HEIGHT][WIDTH];
+
+static void screen_read(void)
+{
+    u8 x, y;
+
+    for (y = 0; y < HEIGHT; y++)
+        for (x = 0; x < WIDTH; x++)
+            image[y][x] = screen_pixel(x, y);
+}
+
+/*  --------------------------------------------------------------------
+    the drawing script, in proportion to the screen
+    ------------------------------------------------------------------*/
+
+static void draw(void)
+{
+    const u16 w = WIDTH, h = HEIGHT;
+    u16 i;
+
+    // a pixel on each corner and a dotted diagonal
+    drawPixel(0, 0);
+    drawPixel(w - 1, 0);
+    drawPixel(0, h - 1);
+    drawPixel(w - 1, h - 1);
+    for (i = 0; i < h; i += 3)
+        drawPixel(i, i);
+
+    // lines in every octant from the centre
+    for (i = 0; i < 8; i++)
+        drawLine(w / 2, h / 2, w / 2 + (i & 1 ? 9 : 20) * ((i & 2) ? -1 : 1),
+                 h / 2 + (i & 1 ? 20 : 9) * ((i & 4) ? -1 : 1) / 2);
+
+    // rectangles on and across the page boundaries
+    drawRect(2, 3, w / 3, h / 3);
+    fillRect(5, 6, w / 3 - 3, 13);
+    fillRect(w / 3 + 4, 7, w / 3 - 2, 9);           // x1 > x2
+    fillRect(w - 12, 8, w - 4, 8 + 1);              // a single row
+    fillRect(w - 10, h - 5, w + 20, h + 20);        // past the screen
+    drawRoundRect(w / 2, 2, w - 2, h / 3 + 2);
+    fillRoundRect(w / 2 + 3, 6, w - 6, h / 3 - 1);
+
+    // circles, one of them partly out of the screen
+    drawCircle(w / 4, 2 * h / 3, h / 4);
+    fillCircle(w / 4, 2 * h / 3, h / 8);
+    fillCircle(w - 3, h - 3, 9);
+    drawCircle(3 * w / 4, 2 * h / 3, 1);
+
+    // triangles
+    drawTriangle(w / 2, h - 2, w / 2 + 10, h / 2 + 2, w / 2 + 19, h - 6);
+    fillTriangle(w / 2 + 2, h - 4, w / 2 + 10, h / 2 + 6, w / 2 + 15, h - 7);
+
+    screen_read();
+}
+
+// text to the last line and past it : the driver scrolls or wraps
+static void print(void)
+{
+    u8 i;
+
+    for (i = 0; i < 10; i++)
+        screen_print("Pinguino 0123456789 !\r\n");
+    screen_print("The end");
+
+    screen_read();
+}
+
+/*  --------------------------------------------------------------------
+    golden images, plain PBM (P1) so that a change can be looked at
+    ------------------------------------------------------------------*/
+
+static void golden_write(const char *name)
+{
+    FILE *f = fopen(name, "w");
+    u8 x, y;
+
+    if (f == NULL)
+    {
+        printf("raster_" NAME ": can't write %s\n", name);
+        failed++;
+        return;
+    }
+    fprintf(f, "P1\n%d %d\n", WIDTH, HEIGHT);
+    for (y = 0; y < HEIGHT; y++)
+    {
+        for (x = 0; x < WIDTH; x++)
+            fputc('0' + image[y][x], f);
+        fputc('\n', f);
+    }
+    fclose(f);
+    printf("raster_" NAME ": %s written\n", name);
+}
+
+static void golden_check(const char *name)
+{
+    FILE *f = fopen(name, "r");
+    int w, h, c, x = 0, y = 0, diff = 0;
+
+    if (f == NULL || fscanf(f, "P1 %d %d", &w, &h) != 2)
+    {
+        printf("raster_" NAME ": can't read %s\n", name);
+        failed++;
+        if (f)
+            fclose(f);
+        return;
+    }
+    CHECK(w == WIDTH && h == HEIGHT);
+
+    while (y < HEIGHT && (c = fgetc(f)) != EOF)
+    {
+        if (c != '0' && c != '1')
+            continue;
+        if (image[y][x] != c - '0' && diff++ < 10)
+            printf("raster_" NAME ": %s pixel %d,%d is %d\n", name, x, y, image[y][x]);
+        if (++x == WIDTH)
+        {
+            x = 0;
+            y++;
+        }
+    }
+    fclose(f);
+
+    CHECK(y == HEIGHT);
+    CHECK(diff == 0);
+    printf("raster_" NAME ": %s, %d pixels differ\n", name, diff);
+}
+
+/*  --------------------------------------------------------------------
+    blit against a pixel model, bitmap 8 rows per byte, bit 0 on top
+    ------------------------------------------------------------------*/
+
+static void test_blit(void)
+{
+    static const u8 bitmap[2 * 11] = {
+        0x3C, 0x42, 0x81, 0xA5, 0xFF, 0x00, 0x5A, 0x24, 0x99, 0x66, 0x0F,
+        0x01, 0x03, 0x07, 0x0F, 0x1F, 0x0F, 0x07, 0x03, 0x01, 0x00, 0x05
+    };
+    static u8 before[HEIGHT][WIDTH];
+    const u8 bw = 11, bh = 13;
+    u8 rop, b, want;
+    s16 x, y, px, py;
+    int bad = 0;
+
+    for (rop = RASTER_COPY; rop <= RASTER_XOR; rop++)
+    {
+        for (y = -bh; y < 9; y++)
+        {
+            x = (y & 1) ? WIDTH - 5 : 3 * y;        // clipped on both sides
+            memcpy(before, image, sizeof(image));
+            screen_blit(bitmap, x, y, bw, bh, rop);
+            screen_read();
+
+            for (py = 0; py < HEIGHT; py++)
+                for (px = 0; px < WIDTH; px++)
+                {
+                    want = before[py][px];
+                    if (px >= x && px < x + bw && py >= y && py < y + bh)
+                    {
+                        b = (bitmap[((py - y) >> 3) * bw + px - x] >> ((py - y) & 7)) & 1;
+                        switch (rop)
+                        {
+                            case RASTER_COPY: want = b;     break;
+                            case RASTER_OR:   want |= b;    break;
+                            case RASTER_AND:  want &= b;    break;
+                            default:          want ^= b;    break;
+                        }
+                    }
+                    if (image[py][px] != want)
+                        bad++;
+                }
+        }
+    }
+
+    printf("raster_" NAME ": blit, %d pixels wrong\n", bad);
+    CHECK(bad == 0);
+}
+
+int main(int argc, char *argv[])
+{
+    int update = (argc > 1 && strcmp(argv[1], "-u") == 0);
+
+    screen_init();
+
+    draw();
+    if (update)
+        golden_write("golden/" NAME "_shapes.pbm");
+    else
+        golden_check("golden/" NAME "_shapes.pbm");
+
+    print();
+    if (update)
+        golden_write("golden/" NAME "_text.pbm");
+    else
+        golden_check("golden/" NAME "_text.pbm");
+
+    test_blit();
+
+    // the whole buffer goes to the display
+    SPI_written = 0;
+    screen_refresh();
+    CHECK(SPI_written >= WIDTH * HEIGHT / 8);
+
+    printf("raster_" NAME ": %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
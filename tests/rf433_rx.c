@@ -0,0 +1,223 @@
+/*  --------------------------------------------------------------------
+    rf433_rx.c - host test and benchmark of the 433MHz packet receiver
+    --------------------------------------------------------------------
+    Packets are built as RF433MHz_end() sends them, turned into the edge
+    time stamps the receiver interrupt would see, with a transmitter
+    clock offset, edge jitter, line noise between the packets and short
+    spikes, and fed to RF433MHz_packetEdge(). The packet error rate is
+    measured for each channel, and the time spent per edge, which is
+    what the interrupt costs on top of reading the timer.
+
+    The Manchester tables are checked against the convention of the
+    transmitter : a 1 is sent LO,HI, an upward transition at bit centre.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <RF433MHz_Packet.c>
+#include <manchester.c>
+#include <bench.h>
+
+#define HALFBIT     375             // 48 MHz / 4 / 8 / 2 / 2000 bauds
+#define NPACKETS    2000
+#define MAXEDGES    8192
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+typedef struct
+{
+    const char *name;
+    double offset;                  // transmitter clock error
+    double jitter;                  // edge jitter, +/- part of a half bit
+    u16 spikes;                     // a spike every n half bits, 0 = none
+    u8 fec;
+    double maxper;                  // highest acceptable PER
+} channel_t;
+
+static const channel_t channels[] = {
+    { "clean",                0.00, 0.00,  0, 0, 0.0   },
+    { "clock +3%",            0.03, 0.05,  0, 0, 0.0   },
+    { "clock -3%",           -0.03, 0.05,  0, 0, 0.0   },
+    { "jitter 15%",           0.00, 0.15,  0, 0, 0.0   },
+    { "clock +3% jitter 15%", 0.03, 0.15,  0, 0, 0.0   },
+    // +/-40% on an interval, at the short / long limits
+    { "jitter 20%",           0.00, 0.20,  0, 0, 0.01  },
+    { "spikes / 50",          0.01, 0.05, 50, 0, 0.02  },
+    { "spikes / 50, FEC",     0.01, 0.05, 50, 1, 0.02  },
+};
+
+static u16 edges[MAXEDGES];
+static u16 nedges;
+
+static double uniform(double amplitude)
+{
+    return amplitude * ((bench_rand() & 0xFFFF) / 32768.0 - 1.0);
+}
+
+/*  --------------------------------------------------------------------
+    half bits sent by RF433MHz_end(), one level per entry
+    ------------------------------------------------------------------*/
+
+static u16 halfbits(u8 *level, const u8 *payload, u8 len, u8 fec)
+{
+    u8 frame[RF433MHZ_MAXFRAME + 1];
+    u8 i, k, n, code;
+    u16 h = 0;
+
+    n = RF433MHz_packetBuild(frame + 1, payload, len, fec);
+    frame[0] = fec ? RF433MHZ_SYNCFEC : RF433MHZ_SYNCBYTE;
+
+    for (i = 0; i < RF433MHZ_PREAMBLE; i++)
+    {
+        level[h++] = 0;
+        level[h++] = 1;
+    }
+    level[h++] = 1;                 // start bit
+    level[h++] = 0;
+    for (i = 0; i <= n; i++)
+    {
+        code = Manchester_encodeTable[frame[i] >> 4];
+        for (k = 0; k < 8; k++, code <<= 1)
+            level[h++] = (code & 0x80) != 0;
+        code = Manchester_encodeTable[frame[i] & 0x0F];
+        for (k = 0; k < 8; k++, code <<= 1)
+            level[h++] = (code & 0x80) != 0;
+    }
+    for (i = 0; i < 2; i++)
+    {
+        level[h++] = 0;
+        level[h++] = 1;
+    }
+    level[h++] = 0;
+    return h;
+}
+
+/*  --------------------------------------------------------------------
+    edge time stamps of a packet on a channel, after some noise
+    ------------------------------------------------------------------*/
+
+static void transmit(const channel_t *c, double *now, const u8 *payload, u8 len)
+{
+    static u8 level[16 * (RF433MHZ_MAXFRAME + 8) + 4 * RF433MHZ_PREAMBLE];
+    double h = HALFBIT * (1.0 + c->offset), t;
+    u16 i, n;
+    u8 prev = 0;
+
+    nedges = 0;
+
+    // AGC noise, random edges 0.1 to 3 half bits apart
+    for (i = 0; i < 40; i++)
+    {
+        *now += HALFBIT * (0.1 + (bench_rand() % 2900) / 1000.0);
+        edges[nedges++] = (u16)*now;
+    }
+    if (nedges & 1)
+        edges[nedges++] = (u16)(*now += HALFBIT);
+    *now += 4 * HALFBIT;
+
+    n = halfbits(level, payload, len, c->fec);
+    for (i = 0; i < n; i++)
+    {
+        t = *now + i * h;
+        if (level[i] != prev)
+        {
+            edges[nedges++] = (u16)(t + uniform(c->jitter * HALFBIT));
+            prev = level[i];
+        }
+        if (c->spikes && bench_rand() % c->spikes == 0)
+        {
+            // 2 edges a few percent of a half bit apart
+            t += (bench_rand() % 1000) / 1000.0 * h;
+            edges[nedges++] = (u16)t;
+            edges[nedges++] = (u16)(t + HALFBIT * (0.03 + (bench_rand() % 100) / 1000.0));
+        }
+    }
+    *now += n * h + 8 * HALFBIT;
+
+    // spikes may come out of order with a jittered edge
+    for (i = 1; i < nedges; i++)
+        if ((s16)(edges[i] - edges[i - 1]) < 0)
+            edges[i] = edges[i - 1];
+}
+
+static void test_channel(const channel_t *c, u64 *cycles, u32 *calls)
+{
+    RF433MHz_packet_t p;
+    u8 payload[RF433MHZ_MAXPAYLOAD], data[RF433MHZ_MAXPAYLOAD];
+    u8 len, got;
+    u32 k, lost = 0, wrong = 0;
+    u16 i;
+    u64 t0;
+    double now = 0;
+
+    RF433MHz_packetInit(&p, HALFBIT);
+
+    for (k = 0; k < NPACKETS; k++)
+    {
+        len = 1 + bench_rand() % RF433MHZ_MAXPAYLOAD;
+        for (i = 0; i < len; i++)
+            payload[i] = bench_rand();
+
+        transmit(c, &now, payload, len);
+
+        t0 = bench_cycles();
+        for (i = 0; i < nedges; i++)
+            RF433MHz_packetEdge(&p, edges[i]);
+        *cycles += bench_cycles() - t0;
+        *calls += nedges;
+
+        got = RF433MHz_packetRead(&p, data, sizeof(data));
+        if (got == RF433MHZ_ERROR)
+            lost++;
+        else if (got != len || memcmp(data, payload, len))
+            wrong++;
+        RF433MHz_packetHunt(&p);
+    }
+
+    printf("rf433_rx: %-22s PER %5.2f%%\n", c->name, 100.0 * (lost + wrong) / NPACKETS);
+    CHECK(wrong == 0);              // the CRC never lets a bad packet through
+    CHECK(lost + wrong <= c->maxper * NPACKETS);
+}
+
+static void test_manchester(void)
+{
+    u8 code[2], i, n = 0;
+    u16 b;
+
+    // bit 0 of the nibble is the last pair sent, a 1 is LO,HI
+    CHECK((Manchester_encodeTable[0x01] & 0x03) == 0x01);
+    CHECK((Manchester_encodeTable[0x00] & 0x03) == 0x02);
+
+    for (b = 0; b < 256; b++)
+    {
+        Manchester_encode(b, code);
+        CHECK(Manchester_check(code));
+        CHECK(Manchester_decode(code) == b);
+    }
+    for (b = 0; b < 256; b++)
+        if (Manchester_nibbler(b) != 0xFF)
+            n++;
+    CHECK(n == 16);
+    for (i = 0; i < 16; i++)
+        CHECK(Manchester_nibbler(Manchester_encodeTable[i]) == i);
+}
+
+int main(void)
+{
+    u64 cycles = 0;
+    u32 calls = 0;
+    u8 i;
+
+    test_manchester();
+    for (i = 0; i < sizeof(channels) / sizeof(channels[0]); i++)
+        test_channel(&channels[i], &cycles, &calls);
+
+    printf("rf433_rx: %.1f " BENCH_UNIT "/edge\n", (double)cycles / calls);
+    printf("rf433_rx: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
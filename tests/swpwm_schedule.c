@@ -0,0 +1,308 @@
+/*  --------------------------------------------------------------------
+    swpwm_schedule.c - host test of the software PWM edge schedule
+    --------------------------------------------------------------------
+    Built once for P8 (Timer0 counter, PORTB) and once for P32 (bit-angle
+    modulation on Timer1, any port). The timer interrupt is called for
+    a number of periods, the output latches being plain variables, and
+    the level of each pin is recorded at each timer tick, which gives
+    the edges of each period.
+
+    Checked : the on-time of each pin is its duty cycle, 0 and 255 give
+    no edge at all, a staged duty cycle doesn't change anything before
+    SWPWM_commit(), and the pins committed together all switch to their
+    new duty cycle on the same period, never in the middle of one.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include <typedef.h>
+
+#ifdef __PIC32MX__
+
+#define TARGET      "p32"
+
+// LATx, LATxCLR, LATxSET, LATxINV of PORTA .. PORTG
+u32 LATx[7][4];
+#define LATACLR     LATx[0][1]
+#define LATBCLR     LATx[1][1]
+#define LATCCLR     LATx[2][1]
+#define LATDCLR     LATx[3][1]
+#define LATECLR     LATx[4][1]
+#define LATFCLR     LATx[5][1]
+#define LATGCLR     LATx[6][1]
+
+u32 T1CON, T1CONSET, TMR1, PR1;
+
+// pins 0-3 on PORTB, pin 4 on PORTD, pin 5 on PORTG
+const u8 port[]  = { 1, 1, 1, 1, 3, 6 };
+const u32 mask[] = { 1 << 0, 1 << 5, 1 << 7, 1 << 15, 1 << 2, 1 << 9 };
+
+#include <swpwm.c>
+
+#define NBPIN       6
+#define PERIODTICKS (SWPWMRES * gSWPWM.unit)
+#define PERIODINTS  SWPWMNBSLOT
+
+static u8 pin_level(u8 pin)
+{
+    return (LATx[port[pin]][0] & mask[pin]) != 0;
+}
+
+// a LATxCLR and LATxSET write, as the hardware applies it
+static void timer_interrupt(void)
+{
+    u8 p;
+
+    IntFlag = 1;
+    Timer1Interrupt();
+    for (p = 0; p < 7; p++)
+    {
+        LATx[p][0] = (LATx[p][0] & ~LATx[p][1]) | LATx[p][2];
+        LATx[p][1] = LATx[p][2] = 0;
+    }
+}
+
+// the interrupt fires when TMR1 matches PR1, PR1 is the slot just started
+static u32 ticks;
+
+static u32 timer_run(void)
+{
+    timer_interrupt();
+    return PR1 + 1;
+}
+
+#else
+
+#define TARGET      "p8"
+
+unsigned long _cpu_clock_ = 48000000UL;
+
+u8 TRISB, T0CON, TMR0H, TMR0L;
+struct { u8 LATB0:1, LATB1:1, LATB2:1, LATB3:1,
+            LATB4:1, LATB5:1, LATB6:1, LATB7:1; } LATBbits;
+struct { u8 TMR0IF:1, TMR0IE:1, GIEH:1, GIEL:1; } INTCONbits;
+struct { u8 TMR0IP:1; } INTCON2bits;
+
+#include <swpwm.c>
+
+#define NBPIN       SWPWMNBPIN
+#define PERIODTICKS 256
+#define PERIODINTS  256
+
+static u8 pin_level(u8 pin)
+{
+    u8 latb;
+
+    memcpy(&latb, &LATBbits, 1);
+    return (latb >> pin) & 1;
+}
+
+static u32 ticks;
+
+static u32 timer_run(void)
+{
+    INTCONbits.TMR0IF = 1;
+    swpwm_interrupt();
+    return 1;
+}
+
+#endif
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    one PWM period, tick by tick
+    ------------------------------------------------------------------*/
+
+typedef struct
+{
+    u32 on[NBPIN];              // ticks at high level
+    u8 rising[NBPIN];           // number of edges
+    u8 falling[NBPIN];
+} period_t;
+
+static u8 level[NBPIN];
+static u32 commit_at;           // interrupt of the period doing a commit
+static u8 commit_duty;
+
+static void period_run(period_t *r)
+{
+    u32 t = 0, n, k = 0;
+    u8 pin, l;
+
+    memset(r, 0, sizeof(*r));
+
+    while (t < PERIODTICKS)
+    {
+        n = timer_run();
+        if (++k == commit_at)
+        {
+            for (pin = 0; pin < NBPIN; pin++)
+                SWPWM_stageDutyCycle(pin, commit_duty);
+            SWPWM_commit();
+        }
+        for (pin = 0; pin < NBPIN; pin++)
+        {
+            l = pin_level(pin);
+            if (l && !level[pin])
+                r->rising[pin]++;
+            if (!l && level[pin])
+                r->falling[pin]++;
+            level[pin] = l;
+            if (l)
+                r->on[pin] += n;
+        }
+        t += n;
+    }
+
+    ticks += t;
+    CHECK(t == PERIODTICKS);    // no slot missing or added
+}
+
+// the timer starts with a period
+static void period_sync(void)
+{
+    period_t r;
+
+    #ifdef __PIC32MX__
+    while (gSWPWM.slot != 0)
+        timer_run();
+    #else
+    while (gCounter != SWPWMRES)
+        timer_run();
+    #endif
+    period_run(&r);
+}
+
+static u32 on_time(u8 duty)
+{
+    #ifdef __PIC32MX__
+    return duty * gSWPWM.unit;
+    #else
+    return duty;
+    #endif
+}
+
+static void test_duty(void)
+{
+    static const u8 duty[] = { 0, 1, 128, 255, 77, 200, 254, 3 };
+    period_t r;
+    u8 pin;
+
+    for (pin = 0; pin < NBPIN; pin++)
+        SWPWM_setDutyCycle(pin, duty[pin]);
+
+    period_sync();
+    period_run(&r);
+
+    for (pin = 0; pin < NBPIN; pin++)
+    {
+        CHECK(r.on[pin] == on_time(duty[pin]));
+        #ifdef __PIC32MX__
+        if (duty[pin] == 0 || duty[pin] == 255)
+        #else
+        if (duty[pin] == 0)         // 255 is 255/256 of the period
+        #endif
+        {
+            // steady level
+            CHECK(r.rising[pin] == 0 && r.falling[pin] == 0);
+        }
+        else
+        {
+            CHECK(r.rising[pin] >= 1 && r.rising[pin] == r.falling[pin]);
+            #ifndef __PIC32MX__
+            CHECK(r.rising[pin] == 1);      // single pulse per period
+            #endif
+        }
+    }
+}
+
+static void test_staged(void)
+{
+    period_t r;
+    u8 pin, i;
+
+    for (pin = 0; pin < NBPIN; pin++)
+        SWPWM_setDutyCycle(pin, 10);
+    period_sync();
+
+    // staged in the middle of a period, nothing changes
+    for (i = 0; i < 3; i++)
+        timer_run();
+    SWPWM_stageDutyCycle(0, 100);
+    SWPWM_stageDutyCycle(1, 150);
+    SWPWM_stageDutyCycle(2, 250);
+    period_sync();
+    period_run(&r);
+    for (pin = 0; pin < NBPIN; pin++)
+        CHECK(r.on[pin] == on_time(10));
+
+    // committed in the middle of a period : this one ends with the
+    // old duty cycles, the next one has all the new ones
+    for (i = 0; i < 3; i++)
+        timer_run();
+    SWPWM_commit();
+    period_sync();
+    period_run(&r);
+    CHECK(r.on[0] == on_time(100));
+    CHECK(r.on[1] == on_time(150));
+    CHECK(r.on[2] == on_time(250));
+    for (pin = 3; pin < NBPIN; pin++)
+        CHECK(r.on[pin] == on_time(10));
+}
+
+// a commit after any interrupt of a period : that period ends with the
+// old duty cycles, the next one has the new ones, on every pin
+static void test_torn(void)
+{
+    period_t r;
+    u32 k;
+    u8 pin, ok = 1;
+
+    for (k = 1; k <= PERIODINTS; k += 1 + k / 8)
+    {
+        for (pin = 0; pin < NBPIN; pin++)
+            SWPWM_setDutyCycle(pin, 0x55);
+        period_sync();
+
+        commit_at = k;
+        commit_duty = 0xAA;
+        period_run(&r);
+        commit_at = 0;
+        for (pin = 0; pin < NBPIN; pin++)
+            if (r.on[pin] != on_time(0x55))
+                ok = 0;
+
+        period_run(&r);
+        for (pin = 0; pin < NBPIN; pin++)
+            if (r.on[pin] != on_time(0xAA))
+                ok = 0;
+    }
+    CHECK(ok);
+}
+
+int main(void)
+{
+    u16 period = SWPWM_setFrequency(1000);
+
+    #ifdef __PIC32MX__
+    // 8 slots of 1, 2, .., 128 units, the longest one in PR1
+    CHECK(period == gSWPWM.unit);
+    CHECK(PR1 == gSWPWM.unit - 1);
+    CHECK((gSWPWM.unit << 7) <= 0xFFFF);
+    #else
+    CHECK(period == 0xFFFF - (_cpu_clock_ / 4) / (1000UL * SWPWMRES));
+    #endif
+
+    test_duty();
+    test_staged();
+    test_torn();
+
+    printf("swpwm_schedule_" TARGET ": %lu ticks simulated\n", (unsigned long)ticks);
+    printf("swpwm_schedule_" TARGET ": %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
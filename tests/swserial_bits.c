@@ -0,0 +1,368 @@
+/*  --------------------------------------------------------------------
+    swserial_bits.c - host test of the P8 software UART bit engine
+    --------------------------------------------------------------------
+    swserial.c runs with two channels on fake lines : every pin is a
+    byte of line[], Timer2 is replaced by a tick of the period the
+    library asks for at 48 MHz, and swserial_interrupt() is called on
+    each tick. The RX lines are sampled from waveforms built in real
+    time, the TX lines are recorded tick by tick and decoded by an
+    ideal UART.
+
+    Checked : frames received at baud rates off by up to +/-2.5%, with
+    a random phase against the tick, back to back, on both channels at
+    different rates at once. Short glitches, framing errors and an
+    RX buffer overrun counted, readChar() with nothing received. Frames
+    sent at the right bit time, decoded back, and the RS-485 driver
+    enable pin high from the first start bit to the last stop bit.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>
+#include <bench.h>
+
+#define CPU             48000000UL
+#define TX1             0
+#define RX1             1
+#define TX2             2
+#define RX2             3
+#define DE1             4
+
+/*  --------------------------------------------------------------------
+    fake lines and timer
+    ------------------------------------------------------------------*/
+
+static volatile u8 line[5];
+static u32 tickcy;                  // CPU cycles per tick
+
+#define SWSERIALUSE2
+#define SWSERIAL_GET(p, m)      (*(p) & (m))
+#define SWSERIAL_SET(p, m)      (*(p) |= (m))
+#define SWSERIAL_CLR(p, m)      (*(p) &= ~(m))
+#define SWSERIAL_PENDING()      (1)
+#define SWSERIAL_CLEAR()        ((void)0)
+#define SWSERIAL_REG(pin, lat)  (&line[pin])
+#define SWSERIAL_MASK(pin)      (1)
+#define SWSERIAL_PINMODE(p, m)  ((void)0)
+#define SWSERIAL_TIMER(cycles)  (tickcy = 4 * (cycles))
+
+#include <swserial.c>
+
+unsigned long _cpu_clock_ = CPU;
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    RX waveforms, 8N1 frames back to back
+    ------------------------------------------------------------------*/
+
+typedef struct
+{
+    const u8 *data;
+    u16 n;
+    double t0;                      // start of the first start bit (s)
+    double bit;                     // bit time (s)
+    u16 badstop;                    // frame sent with a low stop bit, n if none
+} wave_t;
+
+static u8 wave_level(const wave_t *w, double t)
+{
+    long k;
+    u16 f;
+    u8 b;
+
+    if (!w->n || t < w->t0)
+        return 1;
+    k = (long)((t - w->t0) / w->bit);
+    f = k / 10;
+    b = k % 10;
+    if (f >= w->n)
+        return 1;
+    if (b == 0)
+        return 0;
+    if (b == 9)
+        return f != w->badstop;
+    return (w->data[f] >> (b - 1)) & 1;
+}
+
+static double wave_end(const wave_t *w)
+{
+    return w->t0 + 10 * w->n * w->bit;
+}
+
+/*  --------------------------------------------------------------------
+    simulation
+    ------------------------------------------------------------------*/
+
+#define MAXTICKS    200000
+
+static wave_t rx[2];
+static u8 txrec[2][MAXTICKS];       // TX level after each tick
+static u8 derec[MAXTICKS];
+static u32 nticks;
+static double glitch0, glitch1;     // low spike on RX1
+
+static void start(u32 baud1, u32 baud2)
+{
+    memset(SwSerial, 0, sizeof(SwSerial));
+    memset(rx, 0, sizeof(rx));
+    memset((void *)line, 0, sizeof(line));
+    line[RX1] = line[RX2] = 1;
+    glitch0 = glitch1 = 0;
+    nticks = 0;
+
+    SwSerial_setDirPin(SWSERIAL1, DE1);
+    SwSerial_begin(SWSERIAL1, baud1, TX1, RX1);
+    SwSerial_begin(SWSERIAL2, baud2, TX2, RX2);
+}
+
+static double tick(void)
+{
+    return (double)tickcy / CPU;
+}
+
+static void run(double until)
+{
+    double t;
+
+    for (t = nticks * tick(); t < until && nticks < MAXTICKS; t = nticks * tick())
+    {
+        line[RX1] = wave_level(&rx[0], t) && !(t >= glitch0 && t < glitch1);
+        line[RX2] = wave_level(&rx[1], t);
+        swserial_interrupt();
+        txrec[0][nticks] = line[TX1];
+        txrec[1][nticks] = line[TX2];
+        derec[nticks] = line[DE1];
+        nticks++;
+    }
+}
+
+static void receive(u8 ch, const u8 *data, u16 n, u32 baud, double err)
+{
+    rx[ch].data = data;
+    rx[ch].n = n;
+    rx[ch].t0 = nticks * tick() + (bench_rand() % 1000) * tick() / 1000;
+    rx[ch].bit = 1.0 / (baud * (1.0 + err));
+    rx[ch].badstop = n;
+}
+
+static u8 received(u8 ch, const u8 *data, u16 n)
+{
+    u16 i;
+
+    if (SwSerial_available(ch) != n)
+        return 0;
+    for (i = 0; i < n; i++)
+        if (SwSerial_readChar(ch) != data[i])
+            return 0;
+    return 1;
+}
+
+// falling edge on the recorded TX line, idling high before the first tick
+static u8 falling(u8 ch, u32 k)
+{
+    return (k == 0 || txrec[ch][k - 1]) && !txrec[ch][k];
+}
+
+// ideal UART on the recorded TX line, sampled in the middle of the bits,
+// at[] gets the tick of each start bit
+static u16 decode(u8 ch, u32 baud, u8 *data, u32 *at, u16 max)
+{
+    double bit = (double)CPU / baud / tickcy;   // ticks per bit
+    u32 k = 0, s;
+    u16 n = 0;
+    u8 b, i;
+
+    while (k < nticks && n < max)
+    {
+        if (!falling(ch, k))
+        {
+            k++;
+            continue;
+        }
+        b = 0;
+        for (i = 1; i <= 8; i++)
+        {
+            s = k + (u32)((i + 0.5) * bit);
+            b |= (s < nticks && txrec[ch][s]) << (i - 1);
+        }
+        s = k + (u32)(9.5 * bit);
+        if (s >= nticks || !txrec[ch][s])
+            break;
+        at[n] = k;
+        data[n++] = b;
+        k = s;
+    }
+    return n;
+}
+
+static void randomize(u8 *data, u16 n)
+{
+    u16 i;
+
+    for (i = 0; i < n; i++)
+        data[i] = bench_rand();
+}
+
+/*  --------------------------------------------------------------------
+    tests
+    ------------------------------------------------------------------*/
+
+static void test_tick(void)
+{
+    static const u32 baud[] = { 1200, 2400, 4800, 9600, 19200 };
+    double err;
+    u8 k;
+
+    // 3 ticks per bit, the timer rounding far below the 2.5% margin
+    for (k = 0; k < sizeof(baud) / sizeof(baud[0]); k++)
+    {
+        start(baud[k], baud[k]);
+        CHECK(SwSerial[0].nbit == 3 && SwSerial[1].nbit == 3);
+        err = 3.0 * baud[k] * tickcy / CPU - 1.0;
+        CHECK(err > -0.005 && err < 0.005);
+    }
+
+    // the slower channel counts more ticks
+    start(9600, 2400);
+    CHECK(SwSerial[0].nbit == 3 && SwSerial[1].nbit == 12);
+    start(1200, 9600);
+    CHECK(SwSerial[0].nbit == 24 && SwSerial[1].nbit == 3);
+}
+
+static void test_receive(void)
+{
+    static const double err[] = { -0.025, -0.015, 0.0, 0.015, 0.025 };
+    u8 data[40];
+    u8 k, i;
+
+    // 9600 bauds, the sender off by up to 2.5%, random phases
+    for (k = 0; k < sizeof(err) / sizeof(err[0]); k++)
+        for (i = 0; i < 50; i++)
+        {
+            start(9600, 9600);
+            randomize(data, 30);
+            run(0.001 + bench_rand() % 100 * 1e-6);
+            receive(SWSERIAL1, data, 30, 9600, err[k]);
+            run(wave_end(&rx[0]) + 0.002);
+            CHECK(received(SWSERIAL1, data, 30));
+            CHECK(SwSerial_errors(SWSERIAL1) == 0);
+        }
+
+    // nothing left
+    CHECK(SwSerial_available(SWSERIAL1) == 0);
+    CHECK(SwSerial_readChar(SWSERIAL1) == (u8)-1);
+}
+
+static void test_twochannels(void)
+{
+    u8 a[24], b[12];
+    u16 i;
+
+    // 9600 and 2400 bauds at the same time, both a bit off
+    for (i = 0; i < 50; i++)
+    {
+        start(9600, 2400);
+        randomize(a, 24);
+        randomize(b, 12);
+        receive(SWSERIAL2, b, 12, 2400, -0.02);
+        run(0.003);
+        receive(SWSERIAL1, a, 24, 9600, 0.02);
+        run(wave_end(&rx[1]) + 0.005);
+        CHECK(received(SWSERIAL1, a, 24) && received(SWSERIAL2, b, 12));
+        CHECK(SwSerial_errors(SWSERIAL1) == 0 && SwSerial_errors(SWSERIAL2) == 0);
+    }
+}
+
+static void test_errors(void)
+{
+    u8 data[SWSERIAL_RXBUFFER + 3];
+    double t;
+
+    // a low spike shorter than 1/6 bit : no frame
+    start(9600, 9600);
+    for (t = 0.001; t < 0.01; t += 0.0011)
+    {
+        glitch0 = t;
+        glitch1 = t + 1.0 / 9600 / 7;
+        run(t + 0.001);
+    }
+    CHECK(SwSerial_available(SWSERIAL1) == 0);
+    CHECK(SwSerial_errors(SWSERIAL1) == 0);
+
+    // a frame with a low stop bit, the next ones still received
+    start(9600, 9600);
+    randomize(data, 10);
+    data[4] = 0xFF;                 // the low stop bit is followed by a start
+    data[5] = 0xFF;                 // the next frame starts clean
+    receive(SWSERIAL1, data, 10, 9600, 0.0);
+    rx[0].badstop = 3;
+    run(wave_end(&rx[0]) + 0.002);
+    CHECK(SwSerial_errors(SWSERIAL1) >= 1);
+    CHECK(SwSerial_readChar(SWSERIAL1) == data[0]);
+    CHECK(SwSerial_readChar(SWSERIAL1) == data[1]);
+    CHECK(SwSerial_readChar(SWSERIAL1) == data[2]);
+    while (SwSerial_available(SWSERIAL1) > 4)
+        SwSerial_readChar(SWSERIAL1);
+    CHECK(received(SWSERIAL1, &data[6], 4));
+
+    // nobody reads : the oldest ones kept, the others counted
+    start(9600, 9600);
+    randomize(data, sizeof(data));
+    receive(SWSERIAL1, data, sizeof(data), 9600, 0.0);
+    run(wave_end(&rx[0]) + 0.002);
+    CHECK(SwSerial_errors(SWSERIAL1) == 3);
+    CHECK(received(SWSERIAL1, data, SWSERIAL_RXBUFFER));
+}
+
+static void test_transmit(void)
+{
+    u8 data[SWSERIAL_TXBUFFER], got[SWSERIAL_TXBUFFER + 1];
+    u32 at[SWSERIAL_TXBUFFER + 1], k, end;
+
+    // both channels, the TX buffers full
+    start(9600, 4800);
+    randomize(data, SWSERIAL_TXBUFFER);
+    for (k = 0; k < SWSERIAL_TXBUFFER; k++)
+    {
+        SwSerial_printChar(SWSERIAL1, data[k]);
+        SwSerial_printChar(SWSERIAL2, data[SWSERIAL_TXBUFFER - 1 - k]);
+    }
+    CHECK(SwSerial_pending(SWSERIAL1) == SWSERIAL_TXBUFFER);
+    run(0.05);
+    CHECK(SwSerial_pending(SWSERIAL1) == 0 && SwSerial_pending(SWSERIAL2) == 0);
+    CHECK(decode(1, 4800, got, at, sizeof(got)) == SWSERIAL_TXBUFFER);
+    for (k = 0; k < SWSERIAL_TXBUFFER; k++)
+        CHECK(got[k] == data[SWSERIAL_TXBUFFER - 1 - k]);
+    CHECK(decode(0, 9600, got, at, sizeof(got)) == SWSERIAL_TXBUFFER);
+    CHECK(memcmp(got, data, SWSERIAL_TXBUFFER) == 0);
+
+    // back to back : 10 bits from one start bit to the next
+    for (k = 1; k < SWSERIAL_TXBUFFER; k++)
+        CHECK(at[k] - at[k - 1] == 10 * SwSerial[0].nbit);
+
+    // the driver enable pin, up to the end of the last stop bit
+    end = at[SWSERIAL_TXBUFFER - 1] + 10 * SwSerial[0].nbit;
+    for (k = 0; k < nticks; k++)
+        if (derec[k] != (k >= at[0] && k < end))
+            break;
+    CHECK(k == nticks);
+}
+
+int main(void)
+{
+    test_tick();
+    test_receive();
+    test_twochannels();
+    test_errors();
+    test_transmit();
+
+    printf("swserial_bits: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
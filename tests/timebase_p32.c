@@ -0,0 +1,220 @@
+/*  --------------------------------------------------------------------
+    timebase_p32.c - host test of the P32 64-bit timebase
+    --------------------------------------------------------------------
+    timebase.c runs on a simulated CP0 Count : TIMEBASE_COUNT() gives
+    the low 32 bits of a 64-bit tick count, moves it on by a step and
+    can run timebase_update() first, as the Timer1 interrupt would if
+    it came while the reader is between its reads.
+
+    Checked : the count across CP0 wraps with timebase_update() called
+    once per wrap or more, a wrap not seen by timebase_update() yet,
+    the reader interrupted by one and by two updates (the second one
+    writes the slot the reader has taken) and reading again. The hook
+    is in TIMEBASE_COUNT(), after the slot is read : an update between
+    the reads of high and last can't be placed. The ms and us
+    conversions against a 128-bit division at 40 MHz, 24 MHz and
+    12 MHz, and a long run which never goes backwards.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>
+#include <bench.h>
+
+/*  --------------------------------------------------------------------
+    simulated CP0 Count
+    ------------------------------------------------------------------*/
+
+static u64 cp0;                     // true tick count
+static u32 cp0step;                 // ticks between two reads
+static u32 cp0fire;                 // read which runs the interrupt
+static u32 cp0updates;              // updates it runs then
+static u32 cp0reads;
+static u8 cp0isr;
+
+static void cp0_isr(void);
+
+static u32 cp0_read(void)
+{
+    if (!cp0isr && cp0fire && ++cp0reads == cp0fire)
+        cp0_isr();
+    cp0 += cp0step;
+    return (u32)cp0;
+}
+
+#define TIMEBASE_COUNT()        cp0_read()
+
+#include <timebase.c>
+
+static void cp0_isr(void)
+{
+    u32 k;
+
+    cp0isr = 1;
+    for (k = 0; k < cp0updates; k++)
+        timebase_update();
+    cp0isr = 0;
+}
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    helpers
+    ------------------------------------------------------------------*/
+
+static u64 origin;                  // true count at timebase_init()
+
+static void start(u32 freq, u32 count)
+{
+    cp0 = count;
+    cp0step = 0;
+    cp0fire = 0;
+    cp0reads = 0;
+    timebase_init(freq);
+    origin = cp0 & 0xFFFFFFFF00000000ULL;
+}
+
+// the ticks must be the true count of the last CP0 read
+static u8 exact(void)
+{
+    u64 t = timebase_ticks();
+
+    return t == cp0 - origin;
+}
+
+/*  --------------------------------------------------------------------
+    tests
+    ------------------------------------------------------------------*/
+
+static void test_wrap(void)
+{
+    u32 k;
+
+    // just before a wrap, updates every quarter of a wrap
+    start(40000000UL, 0xFFFFFF00UL);
+    CHECK(exact());
+    for (k = 0; k < 40; k++)
+    {
+        cp0 += 0x40000000UL;
+        CHECK(exact());
+        timebase_update();
+        CHECK(exact());
+    }
+    CHECK(timebase_ticks() >> 32 == 10);
+
+    // wrapped, the update hasn't run yet
+    cp0 += 0xFFFFFF00UL - (u32)cp0 + 0x200;
+    CHECK((u32)cp0 < _timebase_slot[_timebase_seq & 1].last);
+    CHECK(exact());
+    timebase_update();
+    CHECK(exact());
+
+    // once per wrap, just under, for a long time
+    for (k = 0; k < 1000; k++)
+    {
+        cp0 += 0xFFFF0000UL;
+        timebase_update();
+        CHECK(exact());
+    }
+}
+
+static void test_interrupted(void)
+{
+    u32 k;
+
+    // the update comes after the reader has taken the slot, once or
+    // twice, close to a wrap or not
+    start(40000000UL, 0x80000000UL);
+    for (k = 0; k < 20000; k++)
+    {
+        cp0 += (k & 1) ? 0x20000000UL + bench_rand() % 0x1000 :
+                         0x100000000ULL - (u32)cp0 - bench_rand() % 0x100;
+        cp0step = bench_rand() % 0x400;
+        cp0updates = 1 + (k & 2) / 2;
+        cp0reads = 0;
+        cp0fire = 1;
+        CHECK(exact());
+        CHECK(cp0reads == 2);       // read again
+        cp0fire = 0;
+    }
+}
+
+static void test_convert(void)
+{
+    static const u32 f[3] = { 40000000UL, 24000000UL, 12000000UL };
+    unsigned __int128 t;
+    u64 ticks, us, ms;
+    u32 k, i;
+
+    for (k = 0; k < 3; k++)
+    {
+        start(f[k], 0);
+        for (i = 0; i < 100000; i++)
+        {
+            ticks = ((u64)bench_rand() << 32 | bench_rand()) >> (bench_rand() % 40);
+            t = ticks;
+            us = t * 1000000UL / f[k];
+            ms = t * 1000UL / f[k];
+
+            // 2^64 / freq rounded down : at most 1 below
+            CHECK(timebase_us(ticks) == us || timebase_us(ticks) + 1 == us);
+            CHECK(timebase_ms(ticks) == ms || timebase_ms(ticks) + 1 == ms);
+        }
+
+        // an hour, a day
+        CHECK(timebase_ms((u64)f[k] * 3600) + 1 >= 3600000ULL);
+        CHECK(timebase_us((u64)f[k] * 86400) + 1 >= 86400000000ULL);
+    }
+}
+
+static void test_monotonic(void)
+{
+    u64 t, last = 0;
+    u32 k, back = 0, sinceupdate = 0;
+
+    // months of CP0 at 40 MHz in random steps, updates now and then
+    // but once per wrap at least, the interrupt in the middle of reads
+    start(40000000UL, 0x12345678UL);
+    for (k = 0; k < 2000000; k++)
+    {
+        u32 dt = bench_rand() % 0x20000000UL;
+
+        cp0 += dt;
+        sinceupdate += dt;
+        if (sinceupdate > 0xC0000000UL || (bench_rand() % 4) == 0)
+        {
+            timebase_update();
+            sinceupdate = 0;
+        }
+        cp0updates = 1;
+        cp0reads = 0;
+        cp0fire = (bench_rand() % 8) == 0;
+        cp0step = bench_rand() % 64;
+        t = timebase_ticks();
+        if (cp0fire)
+            sinceupdate = 0;
+        cp0fire = 0;
+        if (t < last || t != cp0 - origin)
+            back++;
+        last = t;
+    }
+    CHECK(back == 0);
+    CHECK(timebase_ms(last) / 1000 / 3600 / 24 > 100);
+}
+
+int main(void)
+{
+    test_wrap();
+    test_interrupted();
+    test_convert();
+    test_monotonic();
+
+    printf("timebase_p32: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
@@ -0,0 +1,309 @@
+/*  --------------------------------------------------------------------
+    timebase_p8.c - host test of the P8 drift-free timebase
+    --------------------------------------------------------------------
+    timebase.c runs on a simulated 16-bit timer : TIMEBASE_READ() reads
+    the low byte, which latches the high one as on the 18F, the timer
+    moves on with each read and raises its flag (tmrif) when it wraps.
+    The interrupt is served when the test decides, so it can be late
+    (the reader in another interrupt, half a period at most) or come
+    in the middle of a read.
+
+    Checked : ms and ticks against the true tick count at 12 MHz, 3
+    MHz and 32.768 kHz (divider, remainder, overflows not a whole
+    number of ms), the pending overflow not served yet, the reader
+    interrupted by the overflow interrupt, timebase_us(), a frequency
+    change while running (the ticks of the current period used to be
+    counted at the new rate, time went back), and a long run which
+    never goes backwards.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>
+#include <bench.h>
+
+/*  --------------------------------------------------------------------
+    simulated timer
+    ------------------------------------------------------------------*/
+
+static u64 tcy;                     // true tick count since the start
+static u64 offset;                  // ticks when the timer was last cleared
+static u64 sample;                  // ticks at the last low byte read
+static u8 latch;                    // TMR0H
+static u8 tmrif;                    // TMR0IF, overflow pending
+static u32 served;                  // overflows served
+static u32 step;                    // ticks between two reads
+static u32 fireat;                  // read which triggers the interrupt
+static u32 reads;
+
+static void timer_isr(void);
+
+static u16 timer(void)
+{
+    return (u16)(tcy - offset);
+}
+
+static void timer_run(u32 n)
+{
+    u16 t = timer();
+
+    tcy += n;
+    if ((u32)t + n > 0xFFFF)
+        tmrif = 1;
+}
+
+// one access of the reader, the interrupt may come before it
+static u8 timer_byte(u8 high)
+{
+    if (fireat && ++reads == fireat)
+        timer_isr();
+    timer_run(step);
+    if (high)
+        return latch;
+    sample = tcy;
+    latch = timer() >> 8;
+    return timer() & 0xFF;
+}
+
+#define TIMEBASE_READ(t)        do { (t).l8 = timer_byte(0); (t).h8 = timer_byte(1); } while (0)
+#define TIMEBASE_PENDING()      (tmrif)
+#define TIMEBASE_CLEAR()        (tmrif = 0)
+#define TIMEBASE_START()        do { offset = tcy; tmrif = 0; } while (0)
+#define TIMEBASE_RESET()        do { offset = tcy; tmrif = 0; } while (0)
+
+#include <timebase.c>
+
+static void timer_isr(void)
+{
+    if (tmrif)
+        served++;
+    timebase_interrupt();
+}
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    helpers
+    ------------------------------------------------------------------*/
+
+static u32 freq;
+static u64 base;                    // ticks at the last frequency change
+static u64 basems;                  // ms at the last frequency change
+
+// what the timebase should give, in ticks at freq since basems
+static u64 truth(void)
+{
+    return sample - base;
+}
+
+// n ticks, the overflows served before the next one
+static void run(u64 n)
+{
+    u32 k;
+
+    while (n)
+    {
+        k = n > 0x8000 ? 0x8000 : n;
+        timer_run(k);
+        n -= k;
+        if (tmrif && (timer() >= 0x8000 || (bench_rand() & 1)))
+            timer_isr();
+    }
+}
+
+static void start(u32 f)
+{
+    tcy = 1234567;
+    step = 0;
+    fireat = 0;
+    reads = 0;
+    served = 0;
+    freq = f;
+    base = tcy;
+    basems = 0;
+    timebase_init(f);
+}
+
+// ms and ticks must be the true count when the timer was sampled
+static u8 exact(void)
+{
+    u32 ms;
+    u16 t;
+    u64 n, d = freq / 1000;
+
+    timebase_read(&ms, &t);
+    n = truth();
+    return ms == basems + n / d && t == n % d;
+}
+
+/*  --------------------------------------------------------------------
+    tests
+    ------------------------------------------------------------------*/
+
+static void test_exact(void)
+{
+    static const u32 f[3] = { 12000000UL, 3000000UL, 32768UL };
+    u32 k, i;
+
+    for (k = 0; k < 3; k++)
+    {
+        start(f[k]);
+        CHECK(exact());
+
+        // overflows served on time, and a few ticks late
+        for (i = 0; i < 300; i++)
+        {
+            run(bench_rand() % 0x8000);
+            CHECK(exact());
+        }
+        CHECK(served > 50);
+    }
+}
+
+static void test_pending(void)
+{
+    u32 ms0, ms1;
+    u16 t0, t1;
+
+    // overflow not served : the timer reads low, the flag is set
+    start(12000000UL);
+    timer_run(0xFFF0);
+    CHECK(exact() && !tmrif);
+    timer_run(0x20);
+    CHECK(tmrif);
+    CHECK(exact());
+
+    // the reader sees the flag set with a timer read just before the
+    // wrap (high bit set) : the overflow isn't counted twice
+    start(12000000UL);
+    timer_run(0xFFFF - 2);
+    step = 1;
+    CHECK(exact());                 // low byte at 0xFFFE, high at 0xFFFF
+    step = 2;
+    CHECK(exact());                 // read across the wrap
+    CHECK(tmrif);
+
+    // served afterwards : the same time
+    step = 0;
+    timebase_read(&ms0, &t0);
+    timer_isr();
+    timebase_read(&ms1, &t1);
+    CHECK(ms0 == ms1 && t0 == t1 && !tmrif);
+}
+
+static void test_interrupted(void)
+{
+    u32 k;
+
+    // the timer has wrapped, the interrupt comes once the reader has
+    // taken the count : the sequence number has changed, it reads again
+    // (else the count without the overflow and the flag already clear)
+    start(3000000UL);
+    for (k = 0; k < 2000; k++)
+    {
+        timer_run(0x10000 - timer() + bench_rand() % 50);
+        CHECK(tmrif);
+        step = bench_rand() % 3;
+        reads = 0;
+        fireat = 1 + bench_rand() % 2;
+        CHECK(exact());
+        CHECK(reads > 2 || fireat == 2);
+        fireat = 0;
+        step = 0;
+    }
+    CHECK(served == 2000);
+}
+
+static void test_us(void)
+{
+    u16 t;
+
+    start(12000000UL);
+    for (t = 0; t < 12000; t += 7)
+        CHECK(timebase_us(t) == (u16)((u32)t * 1000 / 12000) ||
+              timebase_us(t) + 1 == (u16)((u32)t * 1000 / 12000));
+}
+
+static void test_setfreq(void)
+{
+    u32 ms0, ms1, k;
+    u16 t0, t1;
+
+    // 48 MHz to 16 MHz (12 MHz to 4 MHz timer) late in a period
+    start(12000000UL);
+    run(3 * 0x10000 + 60000);
+    timebase_read(&ms0, &t0);
+    CHECK(exact());
+
+    timebase_setfreq(4000000UL);
+    timebase_read(&ms1, &t1);
+    CHECK(ms1 == ms0 && t1 == t0 / 3);
+
+    // from there on, at the new rate
+    freq = 4000000UL;
+    base = sample - t1;
+    basems = ms1;
+    for (k = 0; k < 300; k++)
+    {
+        run(bench_rand() % 0x8000);
+        CHECK(exact());
+    }
+
+    // and back up, 4 MHz to 12 MHz, an overflow pending
+    timer_run(0x10000 - timer() + 10);
+    timebase_read(&ms0, &t0);
+    timebase_setfreq(12000000UL);
+    timebase_read(&ms1, &t1);
+    CHECK(ms1 == ms0 && t1 == t0 * 3 && !tmrif);
+    freq = 12000000UL;
+    base = sample - t1;
+    basems = ms1;
+    run(5 * 0x10000 + 333);
+    CHECK(exact());
+}
+
+static void test_monotonic(void)
+{
+    u32 ms, last = 0, k, back = 0;
+    u16 t, lastt = 0;
+
+    // minutes of reads, interrupts late, the rate changed now and then
+    start(12000000UL);
+    for (k = 0; k < 2000000; k++)
+    {
+        timer_run(bench_rand() % 4000);
+        if (tmrif && (timer() >= 0x8000 || (bench_rand() % 8) == 0))
+            timer_isr();
+        if ((k % 200000) == 199999)
+        {
+            timebase_setfreq((k / 200000) & 1 ? 12000000UL : 3000000UL);
+            lastt = 0;              // other ticks
+        }
+        timebase_read(&ms, &t);
+        if (ms < last || (ms == last && t < lastt))
+            back++;
+        last = ms;
+        lastt = t;
+    }
+    CHECK(back == 0);
+    CHECK(last > 60000);
+}
+
+int main(void)
+{
+    test_exact();
+    test_pending();
+    test_interrupted();
+    test_us();
+    test_setfreq();
+    test_monotonic();
+
+    printf("timebase_p8: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
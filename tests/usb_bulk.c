@@ -0,0 +1,374 @@
+/*  --------------------------------------------------------------------
+    usb_bulk.c - host test of the PIC32 USB bulk streaming engine
+    --------------------------------------------------------------------
+    usb_function_bulk.c runs against the real BDT layout of
+    usb_hal_pic32.h. usb_transfer_one_packet() is replaced by the one
+    of the test : it arms the even and odd BDs of EP1 in turn, as the
+    stack does, and tells when it is given a BD the SIE still owns.
+    The host side takes the IN BDs in the same order, fills the OUT
+    ones while they are armed (else it is NAKed) and raises the
+    transaction complete interrupt as the USB module does.
+
+    Checked : the packet sizes of buffers shorter than, equal to and
+    longer than 64 bytes, the zero length packet ending a multiple of
+    64 with BULKsend() and not with BULKstream(), the data on the bus
+    and its order across buffers, the callbacks called once, in order,
+    after the last packet only (a buffer ending with a ZLP used to be
+    called back before it, the ZLP then counted for the next buffer),
+    a full TX queue, BULKputs() while the previous string is on the
+    bus, the OUT packets kept in order, the host NAKed when every
+    buffer is filled and the BDs re-armed after BULKrelease(), nothing
+    sent before the device is configured.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>
+
+#pragma GCC diagnostic ignored "-Wpointer-to-int-cast"
+#define __USBBULK__
+#include <usb/usb_device.h>
+#include <usb/usb_function_bulk.c>
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    fake USB module
+    ------------------------------------------------------------------*/
+
+u8 usb_device_state;
+
+// EP1 BDs [OUT even, OUT odd, IN even, IN odd], as in the BDT
+static BDT_ENTRY bd[4];
+static u8 *bdaddr[4];               // ADR is a 32-bit physical address
+static u8 armpp[2];                 // next BD the stack arms [dir]
+static u8 hostpp[2];                // next BD the host uses [dir]
+static u32 overrun;                 // BD armed while owned by the SIE
+static u8 enabled;
+
+volatile USB_HANDLE usb_transfer_one_packet(u8 ep, u8 dir, u8 *data, u8 len)
+{
+    u8 i = dir * 2 + armpp[dir];
+
+    if (ep != USB_BULK_DATA_EP)
+        return 0;
+    if (bd[i].STAT.UOWN)
+        overrun++;
+    bdaddr[i] = data;
+    bd[i].CNT = len;
+    bd[i].STAT.Val = _USIE | _DTSEN;
+    armpp[dir] ^= 1;
+    return &bd[i];
+}
+
+void usb_enable_endpoint(u8 ep, u8 options)
+{
+    enabled = (ep == USB_BULK_DATA_EP) && (options & USB_IN_ENABLED) &&
+              (options & USB_OUT_ENABLED);
+}
+
+// U1STAT : endpoint, direction, ping-pong bit
+static void complete(u8 dir, u8 pp)
+{
+    usb_bulk_transfer_complete((USB_BULK_DATA_EP << 4) | (dir << 3) | (pp << 2));
+}
+
+/*  --------------------------------------------------------------------
+    host side
+    ------------------------------------------------------------------*/
+
+static u8 wire[0x10000];            // IN data received by the host
+static u32 wired;
+static u8 plen[256];                // sizes of the IN packets
+static u32 npackets;
+
+// one IN token, returns the packet size or -1 if NAKed
+static int host_in(void)
+{
+    u8 pp = hostpp[1], i = 2 + pp;
+    u8 n;
+
+    if (!bd[i].STAT.UOWN)
+        return -1;
+    n = bd[i].CNT;
+    memcpy(&wire[wired], bdaddr[i], n);
+    wired += n;
+    plen[npackets++ & 0xFF] = n;
+    bd[i].STAT.UOWN = 0;
+    hostpp[1] ^= 1;
+    complete(1, pp);
+    return n;
+}
+
+// IN tokens until NAKed, returns the number of packets
+static int host_drain(void)
+{
+    int n = 0;
+
+    while (host_in() >= 0)
+        n++;
+    return n;
+}
+
+// one OUT transaction, returns 0 if NAKed
+static u8 host_out(const u8 *data, u8 n)
+{
+    u8 pp = hostpp[0], i = pp;
+
+    if (!bd[i].STAT.UOWN)
+        return 0;
+    memcpy(bdaddr[i], data, n);
+    bd[i].CNT = n;
+    bd[i].STAT.UOWN = 0;
+    hostpp[0] ^= 1;
+    complete(0, pp);
+    return 1;
+}
+
+/*  --------------------------------------------------------------------
+    callbacks
+    ------------------------------------------------------------------*/
+
+static u8 *done[16];                // buffers called back, in order
+static u32 donelen[16];
+static u32 ndone;
+static u32 packetsAtDone[16];
+
+static void sent(u8 *buffer, u32 length)
+{
+    packetsAtDone[ndone & 15] = npackets;
+    donelen[ndone & 15] = length;
+    done[ndone++ & 15] = buffer;
+}
+
+static void start(void)
+{
+    memset(bd, 0, sizeof(bd));
+    armpp[0] = armpp[1] = hostpp[0] = hostpp[1] = 0;
+    overrun = wired = npackets = ndone = 0;
+    usb_device_state = CONFIGURED_STATE;
+    usb_bulk_init_endpoint();
+}
+
+static void fill(u8 *b, u32 n, u8 seed)
+{
+    u32 i;
+
+    for (i = 0; i < n; i++)
+        b[i] = seed + i * 7;
+}
+
+/*  --------------------------------------------------------------------
+    tests
+    ------------------------------------------------------------------*/
+
+static void test_sizes(void)
+{
+    static const u32 size[] = { 1, 63, 64, 65, 128, 200, 1000 };
+    static u8 buf[1024];
+    u32 k, n, zlp, i;
+    int p;
+
+    for (k = 0; k < sizeof(size) / sizeof(size[0]); k++)
+    {
+        for (zlp = 0; zlp < 2; zlp++)
+        {
+            start();
+            n = size[k];
+            fill(buf, n, k);
+            CHECK(zlp ? BULKsend(buf, n, sent) : BULKstream(buf, n, sent));
+            p = host_drain();
+
+            // full packets, a short one or a ZLP after a multiple of 64
+            CHECK(p == (int)(n / 64 + ((n % 64) || zlp)));
+            for (i = 0; i < n / 64; i++)
+                CHECK(plen[i] == 64);
+            if (n % 64)
+                CHECK(plen[n / 64] == n % 64);
+            else if (zlp)
+                CHECK(plen[n / 64] == 0);
+
+            CHECK(wired == n && memcmp(wire, buf, n) == 0);
+            CHECK(ndone == 1 && done[0] == buf && donelen[0] == n);
+            CHECK(packetsAtDone[0] == (u32)p);
+            CHECK(BULKpending() == 0 && overrun == 0);
+        }
+    }
+
+    // a ZLP on its own
+    start();
+    CHECK(BULKsend(buf, 0, sent) && host_drain() == 1 && plen[0] == 0);
+    CHECK(ndone == 1);
+    CHECK(!BULKstream(buf, 0, sent));
+}
+
+static void test_queue(void)
+{
+    static u8 a[100], b[64], c[30], d[200], e[10];
+
+    start();
+    CHECK(enabled);
+    fill(a, sizeof(a), 1);
+    fill(b, sizeof(b), 2);
+    fill(c, sizeof(c), 3);
+    fill(d, sizeof(d), 4);
+
+    CHECK(BULKsend(a, sizeof(a), sent));
+    CHECK(BULKsend(b, sizeof(b), sent));
+    CHECK(BULKstream(c, sizeof(c), sent));
+    CHECK(BULKsend(d, sizeof(d), NULL));
+    CHECK(BULKpending() == BULK_TXQUEUE);
+    CHECK(!BULKsend(e, sizeof(e), sent));       // full
+
+    // both BDs busy from the start, a's 2 packets
+    CHECK(bd[2].STAT.UOWN && bd[3].STAT.UOWN);
+
+    // a's first packet : no callback yet, the free BD takes b
+    CHECK(host_in() == 64 && ndone == 0);
+    CHECK(bd[2].STAT.UOWN && bdaddr[2] == b);
+    CHECK(host_in() == 36 && ndone == 1 && done[0] == a);
+    CHECK(BULKpending() == BULK_TXQUEUE - 1);
+
+    // a slot is free again
+    CHECK(BULKsend(e, sizeof(e), sent));
+    CHECK(!BULKsend(e, sizeof(e), sent));
+
+    host_drain();
+    CHECK(ndone == 4);              // d has no callback
+    CHECK(done[1] == b && done[2] == c && done[3] == e);
+    CHECK(donelen[1] == 64 && packetsAtDone[1] == 4);  // 64 then ZLP
+    CHECK(wired == sizeof(a) + sizeof(b) + sizeof(c) + sizeof(d) + sizeof(e));
+    CHECK(memcmp(wire, a, 100) == 0 && memcmp(wire + 100, b, 64) == 0);
+    CHECK(memcmp(wire + 164, c, 30) == 0 && memcmp(wire + 194, d, 200) == 0);
+    CHECK(overrun == 0 && BULKpending() == 0);
+
+    // a long run, the host reading slower than the sketch queues
+    {
+        static u8 big[4][150];
+        u32 k, queued = 0;
+
+        start();
+        for (k = 0; k < 400; k++)
+        {
+            // the slot of the transfer queued 4 times ago is free
+            if (BULKpending() < BULK_TXQUEUE)
+            {
+                fill(big[queued & 3], 150, queued);
+                CHECK(BULKstream(big[queued & 3], 150, sent));
+                queued++;
+            }
+            if (k % 3 == 0)
+                host_in();
+        }
+        host_drain();
+        CHECK(queued >= 400 / 3 / 3 && ndone == queued && overrun == 0);
+        CHECK(wired == 150 * queued && npackets == 3 * queued);
+        for (k = 0; k < queued; k++)
+            CHECK(wire[150 * k] == (u8)k && wire[150 * k + 149] == (u8)(k + 149 * 7));
+    }
+}
+
+static void test_puts(void)
+{
+    char s[80];
+
+    start();
+    CHECK(BULKputs("pinguino", 8) == 8);
+    CHECK(BULKputs("busy", 4) == 0);            // bulk_data_tx on the bus
+    CHECK(host_in() == 8 && memcmp(wire, "pinguino", 8) == 0);
+    CHECK(BULKputs("again", 5) == 5);
+
+    // longer than a packet : cut to 64
+    host_drain();
+    memset(s, 'x', sizeof(s));
+    CHECK(BULKputs(s, sizeof(s)) == 64);
+    CHECK(host_drain() == 2 && plen[2] == 64 && plen[3] == 0);
+}
+
+static void test_receive(void)
+{
+    u8 out[64], *p, n = 0, i, k;
+    char s[65];
+
+    start();
+    CHECK(BULKreceive(&n) == NULL && BULKgets(s) == 0);
+
+    // both OUT BDs armed
+    CHECK(bd[0].STAT.UOWN && bd[1].STAT.UOWN);
+
+    // BULK_RXQUEUE packets, then NAK
+    for (k = 0; k < BULK_RXQUEUE; k++)
+    {
+        fill(out, 64, k);
+        CHECK(host_out(out, 10 + k));
+    }
+    CHECK(!host_out(out, 1));
+    CHECK(!bd[0].STAT.UOWN && !bd[1].STAT.UOWN);
+
+    // oldest first, still there until released
+    p = BULKreceive(&n);
+    CHECK(p != NULL && n == 10 && p[1] == 7);
+    CHECK(BULKreceive(&n) == p);
+
+    // released : one BD armed again, the host gets through
+    BULKrelease();
+    CHECK(bd[0].STAT.UOWN && !bd[1].STAT.UOWN);
+    fill(out, 64, 9);
+    CHECK(host_out(out, 64));
+    CHECK(!host_out(out, 1));
+
+    for (k = 1; k < BULK_RXQUEUE; k++)
+    {
+        p = BULKreceive(&n);
+        CHECK(n == 10 + k && p[0] == k);
+        BULKrelease();
+    }
+    CHECK(bd[1].STAT.UOWN && bd[0].STAT.UOWN);  // 2 armed, not more
+    CHECK(BULKgets(s) == 64 && (u8)s[63] == (u8)(9 + 63 * 7));
+    CHECK(BULKreceive(&n) == NULL);
+    BULKrelease();                              // nothing to release
+
+    // a long exchange, the sketch reading every other packet
+    for (k = 0, i = 0; k < 200; k++)
+    {
+        out[0] = k;
+        if (host_out(out, 1 + k % 64))
+            i++;
+        if (k & 1)
+            while (BULKgets(s))
+                ;
+    }
+    while (BULKgets(s))
+        ;
+    CHECK(i > 100 && overrun == 0);
+}
+
+static void test_state(void)
+{
+    static u8 buf[10];
+
+    start();
+    usb_device_state = 0;
+    CHECK(!BULKsend(buf, sizeof(buf), sent));
+    CHECK(!bd[2].STAT.UOWN && !bd[3].STAT.UOWN);
+    usb_device_state = CONFIGURED_STATE;
+    CHECK(BULKsend(buf, sizeof(buf), sent));
+}
+
+int main(void)
+{
+    test_sizes();
+    test_queue();
+    test_puts();
+    test_receive();
+    test_state();
+
+    printf("usb_bulk: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}
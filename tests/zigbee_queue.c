@@ -0,0 +1,267 @@
+/*  --------------------------------------------------------------------
+    zigbee_queue.c - host test of the MRF24J40 packet queues
+    --------------------------------------------------------------------
+    zigbee.c and zigbee/mrf24j40_queue.c run against the fake radio of
+    p32/zigbee/mrf24j40.c : frames are written to its RX FIFO and RXIF
+    raised, the frames the library hands to it are read back from its
+    TX FIFO, TXNIF is raised with the status of the transmission. The
+    radio is polled (no INTZIG), ZIGinterrupt() is called by the test.
+
+    Checked : the queue indexes wrapping past 255, a full and an empty
+    queue, frames received with and without PAN ID compression, LQI
+    and RSSI, a full RX queue (the frame is dropped and counted, the
+    older ones kept), malformed and too long frames, frames sent one
+    after the other on TXNIF, a full TX queue, failures counted, a TX
+    interrupt with nothing queued (it used to pop the empty queue, the
+    count read 255 and ZIGputs never found a free slot again) and an
+    interrupt deferred while the main loop holds the SPI bus.
+    ------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <typedef.h>
+#include <const.h>
+
+#include <zigbee.c>
+
+#define PAN         0x1234
+#define ME          0x0001
+#define PEER        0x0002
+
+static int failed;
+
+#define CHECK(c)    do { if (!(c)) { failed++;                          \
+                         printf("%s:%d: %s\n", __FILE__, __LINE__, #c); \
+                    } } while (0)
+
+/*  --------------------------------------------------------------------
+    fake radio
+    ------------------------------------------------------------------*/
+
+// a data frame from PEER in the RX FIFO, RXIF raised
+static void receive(const char *payload, u8 compress, u8 lqi, u8 rssi)
+{
+    u8 *f = &mrf24j40_long[MRF24J40_RXFIFO];
+    u8 len = strlen(payload), h = compress ? 9 : 11, i = 1;
+
+    f[i++] = FTDATA | (compress ? 0x40 : 0);
+    f[i++] = 0x88;                  // short dest and src addresses
+    f[i++] = 0x55;                  // sequence number
+    f[i++] = PAN & 0xFF;
+    f[i++] = PAN >> 8;
+    f[i++] = ME & 0xFF;
+    f[i++] = ME >> 8;
+    if (!compress)
+    {
+        f[i++] = (PAN + 1) & 0xFF;
+        f[i++] = (PAN + 1) >> 8;
+    }
+    f[i++] = PEER & 0xFF;
+    f[i++] = PEER >> 8;
+    memcpy(&f[i], payload, len);
+    i += len;
+    f[i++] = 0xAA;                  // FCS
+    f[i++] = 0xBB;
+    f[i++] = lqi;
+    f[i++] = rssi;
+    f[0] = h + len + 2;
+
+    mrf24j40_short[INTSTAT] |= 1 << INTSTAT_RXIF;
+}
+
+// the frame on air is over, status 0 = acknowledged
+static void transmitted(u8 status, u8 retries)
+{
+    mrf24j40_short[TXSTAT] = status | (retries << 6);
+    mrf24j40_short[INTSTAT] |= 1 << INTSTAT_TXNIF;
+}
+
+static u8 sent(const char *payload)
+{
+    u8 len = strlen(payload);
+
+    return mrf24j40_air[0] == MRF24J40_SHORTHEADER &&
+           mrf24j40_air[1] == MRF24J40_SHORTHEADER + len &&
+           mrf24j40_air[2] == (FTDATA | 0x20) && mrf24j40_air[3] == 0x88 &&
+           mrf24j40_air[5] == (PAN & 0xFF) && mrf24j40_air[6] == (PAN >> 8) &&
+           mrf24j40_air[7] == (PEER & 0xFF) && mrf24j40_air[8] == (PEER >> 8) &&
+           mrf24j40_air[11] == (ME & 0xFF) && mrf24j40_air[12] == (ME >> 8) &&
+           memcmp(&mrf24j40_air[13], payload, len) == 0 && mrf24j40_ackreq;
+}
+
+static void start(void)
+{
+    memset(mrf24j40_short, 0, sizeof(mrf24j40_short));
+    memset(mrf24j40_long, 0, sizeof(mrf24j40_long));
+    mrf24j40_sent = 0;
+    init_zigbee(11, PAN, ME);
+}
+
+/*  --------------------------------------------------------------------
+    tests
+    ------------------------------------------------------------------*/
+
+static void test_queue(void)
+{
+    mrf24j40_packet_t slot[4], *p;
+    mrf24j40_queue_t q;
+    int k;
+    u8 n = 0, m = 0;
+
+    mrf24j40_queue_init(&q, slot, 4);
+    CHECK(mrf24j40_queue_front(&q) == NULL);
+
+    // 1000 packets through, 1 to 4 at a time : head and tail wrap
+    for (k = 0; k < 1000; k++)
+    {
+        while (mrf24j40_queue_count(&q) < 1 + k % 4)
+        {
+            p = mrf24j40_queue_back(&q);
+            CHECK(p != NULL);
+            p->seq = n++;
+            mrf24j40_queue_push(&q);
+        }
+        if (k % 4 == 3)
+        {
+            CHECK(mrf24j40_queue_back(&q) == NULL);     // full
+            CHECK(mrf24j40_queue_count(&q) == 4);
+        }
+        while ((p = mrf24j40_queue_front(&q)) != NULL)
+        {
+            CHECK(p->seq == m);
+            m++;
+            mrf24j40_queue_pop(&q);
+        }
+        CHECK(mrf24j40_queue_count(&q) == 0);
+    }
+    CHECK(n == m && q.head == q.tail && q.head != 0);
+}
+
+static void test_receive(void)
+{
+    u8 s[MRF24J40_MAXPAYLOAD + 1];
+    int i;
+
+    start();
+    CHECK(ZIGavailable() == 0);
+
+    receive("hello", 0, 200, 90);
+    CHECK(ZIGavailable() == 1);
+    CHECK(!mrf24j40_rxoff);                             // RX back on
+    receive("pinguino", 1, 180, 70);                    // PAN ID compression
+    CHECK(ZIGavailable() == 2);
+
+    CHECK(ZIGgets(s) == 5 && strcmp((char *)s, "hello") == 0);
+    CHECK(ZIGsrcadd == PEER && ZIGdestadd == ME);
+    CHECK(ZIGdestpan == PAN && ZIGsrcpan == PAN + 1);
+    CHECK(ZIGlqi() == 200 && ZIGrssi() == 90);
+    CHECK(ZIGgets(s) == 8 && strcmp((char *)s, "pinguino") == 0);
+    CHECK(ZIGsrcpan == PAN && ZIGlqi() == 180 && ZIGrssi() == 70);
+    CHECK(ZIGgets(s) == 0 && ZIGavailable() == 0);
+
+    // nobody reads : the queue keeps the oldest ones
+    for (i = 0; i < ZIG_RXQUEUE + 2; i++)
+    {
+        s[0] = 'a' + i;
+        s[1] = 0;
+        receive((char *)s, 0, 0, 0);
+        ZIGpoll();
+    }
+    CHECK(ZIGdropped == 2);
+    CHECK(ZIGavailable() == ZIG_RXQUEUE);
+    for (i = 0; i < ZIG_RXQUEUE; i++)
+        CHECK(ZIGgets(s) == 1 && s[0] == 'a' + i);
+
+    // reserved addressing mode, then a length past the payload size
+    receive("x", 0, 0, 0);
+    mrf24j40_long[MRF24J40_RXFIFO + 2] = 0x44;
+    ZIGpoll();
+    receive("x", 0, 0, 0);
+    mrf24j40_long[MRF24J40_RXFIFO] = 11 + MRF24J40_MAXPAYLOAD + 3;
+    ZIGpoll();
+    CHECK(ZIGdropped == 4 && ZIGavailable() == 0);
+}
+
+static void test_transmit(void)
+{
+    start();
+
+    // the first one goes on air at once, the second one waits
+    CHECK(ZIGputs(PEER, (u8 *)"one", 3) == 1);
+    CHECK(mrf24j40_sent == 1 && sent("one"));
+    CHECK(ZIGputs(PEER, (u8 *)"two", 3) == 1);
+    CHECK(mrf24j40_sent == 1 && ZIGpending() == 2);
+
+    // full, the radio is polled once but nothing is over
+    CHECK(ZIGputs(PEER, (u8 *)"three", 5) == 0);
+    CHECK(ZIGpending() == 2);
+
+    // "one" acknowledged : "two" is loaded
+    transmitted(0, 1);
+    CHECK(ZIGpending() == 1);
+    CHECK(mrf24j40_sent == 2 && sent("two") && ZIGretries == 1);
+    CHECK(mrf24j40_air[4] == data_sequence_number);
+
+    // "three" finds a slot, "two" fails after its retries
+    CHECK(ZIGputs(PEER, (u8 *)"three", 5) == 1);
+    transmitted(1, 3);
+    CHECK(ZIGpending() == 1 && ZIGfailures == 1);
+    CHECK(mrf24j40_sent == 3 && sent("three"));
+    transmitted(0, 0);
+    CHECK(ZIGpending() == 0 && mrf24j40_sent == 3);
+}
+
+static void test_spurious(void)
+{
+    start();
+
+    // TX status with nothing queued : ignored
+    transmitted(1, 3);
+    CHECK(ZIGpending() == 0);
+    CHECK(mrf24j40_queue_count(&ZIGtxqueue) == 0 && ZIGfailures == 0);
+
+    // the queue is still usable
+    CHECK(ZIGputs(PEER, (u8 *)"a", 1) == 1);
+    CHECK(mrf24j40_sent == 1 && sent("a"));
+    CHECK(ZIGputs(PEER, (u8 *)"b", 1) == 1);
+    CHECK(ZIGpending() == 2);
+    transmitted(0, 0);
+    CHECK(ZIGpending() == 1 && sent("b"));
+    transmitted(0, 0);
+    CHECK(ZIGpending() == 0);
+    transmitted(0, 0);              // once more, nothing on air
+    CHECK(ZIGpending() == 0 && ZIGfailures == 0);
+    CHECK(ZIGputs(PEER, (u8 *)"c", 1) == 1);
+    CHECK(mrf24j40_sent == 3 && sent("c"));
+}
+
+static void test_deferred(void)
+{
+    start();
+
+    // the interrupt comes while the main loop has the bus
+    ZIGlock = 1;
+    receive("late", 0, 0, 0);
+    ZIGinterrupt();
+    CHECK(ZIGdeferred && mrf24j40_queue_count(&ZIGrxqueue) == 0);
+    ZIGunlock();
+    CHECK(!ZIGdeferred && !ZIGlock && mrf24j40_queue_count(&ZIGrxqueue) == 1);
+
+    // and when it doesn't
+    receive("now", 0, 0, 0);
+    ZIGinterrupt();
+    CHECK(mrf24j40_queue_count(&ZIGrxqueue) == 2);
+}
+
+int main(void)
+{
+    test_queue();
+    test_receive();
+    test_transmit();
+    test_spurious();
+    test_deferred();
+
+    printf("zigbee_queue: %s\n", failed ? "FAILED" : "ok");
+    return failed != 0;
+}